@@ -81,6 +81,11 @@ struct cg_execution_group_t;
 struct cg_cpu_partition_t;
 struct cg_cpu_info_t;
 struct cg_heap_info_t;
+struct cg_residency_stats_t;
+struct cg_scratch_stats_t;
+struct cg_allocation_stats_t;
+struct cg_object_stats_t;
+struct cg_kernel_cache_stats_t;
 struct cg_command_t;
 struct cg_kernel_code_t;
 struct cg_blend_state_t;
@@ -103,6 +108,15 @@ struct cg_vertex_attribute_t;
 /// @summary A special value meaning that CGFX will determine the best heap placement.
 #define CG_IDEAL_HEAP       (~size_t(0))
 
+/// @summary A special value meaning that a device or heap is not bound to a single NUMA node.
+#define CG_NUMA_NODE_ANY    (~uint32_t(0))
+
+/// @summary The number of entries returned for CG_CONTEXT_ALLOCATION_STATS, indexed by cg_allocation_type_e. Entry 0 is unused.
+#define CG_MAX_ALLOCATION_TYPES  (6)
+
+/// @summary The number of entries returned for CG_CONTEXT_OBJECT_STATS, one for each cg_object_e value other than CG_OBJECT_NONE.
+#define CG_MAX_OBJECT_TYPES      (13)
+
 /*////////////////////////////
 //  Function Pointer Types  //
 ////////////////////////////*/
@@ -117,6 +131,7 @@ typedef int          (CG_API *cgEnumerateDevices_fn            )(cg_application_
 typedef int          (CG_API *cgGetContextInfo_fn              )(uintptr_t, int, void *, size_t, size_t *);
 typedef size_t       (CG_API *cgGetHeapCount_fn                )(uintptr_t);
 typedef int          (CG_API *cgGetHeapProperties_fn           )(uintptr_t, size_t, cg_heap_info_t &);
+typedef int          (CG_API *cgSetHeapResidencyBudget_fn      )(uintptr_t, size_t, uint64_t);
 typedef size_t       (CG_API *cgGetDeviceCount_fn              )(uintptr_t);
 typedef int          (CG_API *cgGetDeviceInfo_fn               )(uintptr_t, cg_handle_t, int, void *, size_t, size_t *);
 typedef size_t       (CG_API *cgGetDisplayCount_fn             )(uintptr_t);
@@ -143,6 +158,7 @@ typedef int          (CG_API *cgCommandBufferUnmapAppend_fn    )(uintptr_t, cg_h
 typedef int          (CG_API *cgEndCommandBuffer_fn            )(uintptr_t, cg_handle_t);
 typedef int          (CG_API *cgCommandBufferCanRead_fn        )(uintptr_t, cg_handle_t, size_t &);
 typedef cg_command_t*(CG_API *cgCommandBufferCommandAt_fn      )(uintptr_t, cg_handle_t, size_t &, int &);
+typedef int          (CG_API *cgCommandBufferSetSortKey_fn     )(uintptr_t, cg_handle_t, uint64_t);
 typedef cg_handle_t  (CG_API *cgCreateFence_fn                 )(uintptr_t, cg_handle_t, int, int &);
 typedef cg_handle_t  (CG_API *cgCreateFenceForEvent_fn         )(uintptr_t, cg_handle_t, cg_handle_t, int &);
 typedef cg_handle_t  (CG_API *cgCreateEvent_fn                 )(uintptr_t, cg_handle_t, int &);
@@ -150,13 +166,21 @@ typedef int          (CG_API *cgHostWaitForEvent_fn            )(uintptr_t, cg_h
 typedef int          (CG_API *cgDeviceFence_fn                 )(uintptr_t, cg_handle_t, cg_handle_t, cg_handle_t);
 typedef int          (CG_API *cgDeviceFenceWithWaitList_fn     )(uintptr_t, cg_handle_t, cg_handle_t, size_t, cg_handle_t const *, cg_handle_t);
 typedef cg_handle_t  (CG_API *cgCreateVertexDataSource_fn      )(uintptr_t, cg_handle_t, size_t, cg_handle_t *, cg_handle_t, size_t const *, cg_vertex_attribute_t const **, int &);
+typedef cg_handle_t  (CG_API *cgCreateVertexDataSourceWithOffsets_fn)(uintptr_t, cg_handle_t, size_t, cg_handle_t *, size_t const *, cg_handle_t, size_t, size_t const *, cg_vertex_attribute_t const **, int &);
+typedef int          (CG_API *cgSetKernelCacheDirectory_fn     )(uintptr_t, char const*);
 typedef cg_handle_t  (CG_API *cgCreateKernel_fn                )(uintptr_t, cg_handle_t, cg_kernel_code_t const *, int &);
 typedef cg_handle_t  (CG_API *cgCreateComputePipeline_fn       )(uintptr_t, cg_handle_t, cg_compute_pipeline_t const *, void *, cgPipelineTeardown_fn, int &);
 typedef cg_handle_t  (CG_API *cgCreateGraphicsPipeline_fn      )(uintptr_t, cg_handle_t, cg_graphics_pipeline_t const *, void *, cgPipelineTeardown_fn, int &);
+typedef cg_handle_t  (CG_API *cgCreateKernelAsync_fn           )(uintptr_t, cg_handle_t, cg_kernel_code_t const *, cg_handle_t, int &);
+typedef cg_handle_t  (CG_API *cgCreateComputePipelineAsync_fn  )(uintptr_t, cg_handle_t, cg_compute_pipeline_t const *, void *, cgPipelineTeardown_fn, cg_handle_t, int &);
+typedef int          (CG_API *cgGetBuildStatus_fn              )(uintptr_t, cg_handle_t);
+typedef int          (CG_API *cgSetComputePipelineAutotune_fn  )(uintptr_t, cg_handle_t, bool);
 typedef cg_handle_t  (CG_API *cgCreateDataBuffer_fn            )(uintptr_t, cg_handle_t, size_t, uint32_t, uint32_t, uint32_t, int, int, int &);
 typedef int          (CG_API *cgGetDataBufferInfo_fn           )(uintptr_t, cg_handle_t, int, void *, size_t, size_t *);
 typedef void*        (CG_API *cgMapDataBuffer_fn               )(uintptr_t, cg_handle_t, cg_handle_t, cg_handle_t, size_t, size_t, uint32_t, int);
 typedef int          (CG_API *cgUnmapDataBuffer_fn             )(uintptr_t, cg_handle_t, cg_handle_t, void *, cg_handle_t *);
+typedef cg_handle_t  (CG_API *cgAcquireStagingBuffer_fn        )(uintptr_t, cg_handle_t, size_t, size_t, void **, int &);
+typedef int          (CG_API *cgReleaseStagingBuffer_fn        )(uintptr_t, cg_handle_t, cg_handle_t);
 typedef cg_handle_t  (CG_API *cgCreateImage_fn                 )(uintptr_t, cg_handle_t, size_t, size_t, size_t, size_t, size_t, uint32_t, uint32_t, uint32_t, uint32_t, int, int, int &);
 typedef int          (CG_API *cgGetImageInfo_fn                )(uintptr_t, cg_handle_t, int, void *, size_t, size_t *);
 typedef void*        (CG_API *cgMapImageRegion_fn              )(uintptr_t, cg_handle_t, cg_handle_t, cg_handle_t, size_t[3], size_t[3], uint32_t, size_t &, size_t &, int &);
@@ -183,6 +207,8 @@ typedef size_t       (CG_API *cgImageDimension_fn              )(uint32_t, size_
 typedef size_t       (CG_API *cgImageLevelDimension_fn         )(uint32_t, size_t, size_t);
 typedef size_t       (CG_API *cgImageRowPitch_fn               )(uint32_t, size_t);
 typedef size_t       (CG_API *cgImageSlicePitch_fn             )(uint32_t, size_t, size_t);
+typedef int          (CG_API *cgGenerateHostMipmaps_fn         )(void *, size_t, uint32_t, size_t, size_t, size_t, size_t, size_t, uint32_t);
+typedef int          (CG_API *cgCompressHostImage_fn           )(void *, size_t, size_t, uint32_t, void const *, size_t, size_t, size_t, int, size_t, uint64_t *);
 typedef bool         (CG_API *cgIsCubemapImageDDS_fn           )(dds_header_t const *, dds_header_dxt10_t const *);
 typedef bool         (CG_API *cgIsVolumeImageDDS_fn            )(dds_header_t const *, dds_header_dxt10_t const *);
 typedef bool         (CG_API *cgIsArrayImageDDS_fn             )(dds_header_t const *, dds_header_dxt10_t const *);
@@ -525,6 +551,11 @@ enum cg_context_info_param_e : int
     CG_CONTEXT_CPU_COUNTS              =  0,           /// Retrieve the number of CPU resources in the system. Data is cg_cpu_counts_t.
     CG_CONTEXT_DEVICE_COUNT            =  1,           /// Retrieve the number of capable compute devices in the system. Data is size_t.
     CG_CONTEXT_DISPLAY_COUNT           =  2,           /// Retrieve the number of capable display devices attached to the system. Data is size_t. 
+    CG_CONTEXT_RESIDENCY_STATS         =  3,           /// Retrieve counters maintained by the device memory residency manager. Data is cg_residency_stats_t.
+    CG_CONTEXT_SCRATCH_STATS           =  4,           /// Retrieve usage information for the per-thread scratch arenas serving TEMP and KERNEL allocations. Data is cg_scratch_stats_t.
+    CG_CONTEXT_ALLOCATION_STATS        =  5,           /// Retrieve host memory allocation counters for each allocation type. Data is cg_allocation_stats_t[CG_MAX_ALLOCATION_TYPES], indexed by cg_allocation_type_e.
+    CG_CONTEXT_OBJECT_STATS            =  6,           /// Retrieve object counters for each object type. Data is cg_object_stats_t[CG_MAX_OBJECT_TYPES].
+    CG_CONTEXT_KERNEL_CACHE_STATS      =  7,           /// Retrieve hit counts and build times for the on-disk kernel binary cache. Data is cg_kernel_cache_stats_t.
 };
 
 /// @summary Define the queryable data on a CGFX device object.
@@ -537,6 +568,7 @@ enum cg_device_info_param_e : int
     CG_DEVICE_DISPLAY_COUNT            =  4,           /// Retrieve the number of displays attached to the device. Data is size_t.
     CG_DEVICE_ATTACHED_DISPLAYS        =  5,           /// Retrieve the object handles of the attached displays. Data is cg_handle_t[CG_DEVICE_DISPLAY_COUNT].
     CG_DEVICE_PRIMARY_DISPLAY          =  6,           /// Retrieve the primary display attached to the device. Data is cg_handle_t.
+    CG_DEVICE_NUMA_NODE                =  7,           /// Retrieve the NUMA node the device executes on, or CG_NUMA_NODE_ANY. Data is uint32_t.
 };
 
 /// @summary Define the queryable data on a CGFX display object.
@@ -551,6 +583,8 @@ enum cg_display_info_param_e : int
     CG_DISPLAY_SIZE                    =  6,           /// Retrieve the width and height of the display, in pixels. Data is size_t[2].
     CG_DISPLAY_ORIENTATION             =  7,           /// Retrieve the current orientation of the display. Data is cg_display_orientation_e.
     CG_DISPLAY_REFRESH_RATE            =  8,           /// Retrieve the vertical refresh rate of the display, in hertz. Data is float.
+    CG_DISPLAY_GL_STATE_STATS          =  9,           /// Retrieve the counters maintained by the OpenGL state cache of the display. Data is cg_gl_state_stats_t.
+    CG_DISPLAY_HEADLESS                = 10,           /// Retrieve whether the display is a headless display created for CG_EXECUTION_GROUP_OFFSCREEN, with no attached monitor. Data is bool.
 };
 
 /// @summary Define the queryable data on a CGFX execution group object.
@@ -809,6 +843,14 @@ enum cg_execution_group_flags_e : uint32_t
     CG_EXECUTION_GROUP_GPUS            = (1 << 1),     /// Include all GPUs in the sharegroup of the master device.
     CG_EXECUTION_GROUP_ACCELERATORS    = (1 << 2),     /// Include all accelerators in the sharegroup of the master device.
     CG_EXECUTION_GROUP_DISPLAY_OUTPUT  = (1 << 3),     /// The execution group will use OpenGL for display output. The RootDevice must specify the GPU attached to the output display(s).
+    CG_EXECUTION_GROUP_OFFSCREEN       = (1 << 4),     /// The execution group will use OpenGL to render into images. If the RootDevice drives no display, a headless display with a hidden rendering context is created for it.
+};
+
+/// @summary Define flags that can be specified when recording a command buffer.
+enum cg_command_buffer_flags_e : uint32_t
+{
+    CG_COMMAND_BUFFER_FLAGS_NONE       = (0 << 0),     /// Commands are executed in the order they were recorded.
+    CG_COMMAND_BUFFER_FLAG_SORT_BY_KEY = (1 << 0),     /// Graphics only. Commands between fences are executed in ascending sort key order. See cgCommandBufferSetSortKey.
 };
 
 /// @summary Define flags that can be specified with kernel code.
@@ -857,10 +899,28 @@ enum cg_image_sampler_flags_e : uint32_t
     CG_IMAGE_SAMPLER_FLAG_DEPTH_VALUES = (1 << 3),     /// The sampler expects an depth image.
 };
 
+/// @summary Define flags controlling host-side mipmap generation.
+enum cg_host_mipmap_flags_e : uint32_t
+{
+    CG_HOST_MIPMAP_FLAGS_NONE          = (0 << 0),     /// Use the fastest row kernels supported by the host CPU.
+    CG_HOST_MIPMAP_FLAG_SCALAR         = (1 << 0),     /// Use the portable scalar row kernels. Intended for validation and benchmarking.
+};
+
+/// @summary Define the quality levels supported by the host block compressor. Higher levels spend more time searching for block endpoints.
+enum cg_block_compression_quality_e : int
+{
+    CG_BLOCK_COMPRESSION_QUALITY_FAST   = 0,           /// Use the principal axis endpoints of each block without refinement.
+    CG_BLOCK_COMPRESSION_QUALITY_NORMAL = 1,           /// Refine the endpoints of each block with least squares.
+    CG_BLOCK_COMPRESSION_QUALITY_HIGH   = 2,           /// Refine the endpoints, then search the neighborhood of the quantized endpoints.
+};
+
 /// @summary The pre-defined compute pipeline identifiers. These pipelines are provided by the CGFX implementation.
 enum cg_compute_pipeline_id_e : uint16_t
 {
     CG_COMPUTE_PIPELINE_TEST01         =       0 ,     /// See cgfx_kernel_compute.h
+    CG_COMPUTE_PIPELINE_GENERIC        =       1 ,     /// See cgfx_kernel_compute.h
+    CG_COMPUTE_PIPELINE_PRIMITIVES     =       2 ,     /// See cgfx_kernel_compute.h
+    CG_COMPUTE_PIPELINE_IMAGE          =       3 ,     /// See cgfx_kernel_compute.h
     CG_COMPUTE_PIPELINE_COUNT
 };
 
@@ -868,6 +928,7 @@ enum cg_compute_pipeline_id_e : uint16_t
 enum cg_graphics_pipeline_id_e : uint16_t
 {
     CG_GRAPHICS_PIPELINE_TEST01        =       0 ,     /// See cgfx_kernel_graphics.h
+    CG_GRAPHICS_PIPELINE_GENERIC       =       1 ,     /// See cgfx_kernel_graphics.h
     CG_GRAPHICS_PIPELINE_COUNT
 };
 
@@ -985,6 +1046,7 @@ struct cg_execution_group_t
     char const                  **ExtensionNames;      /// An array of ExtensionCount NULL-terminated ASCII strings naming the extensions to enable.
     uint32_t                      CreateFlags;         /// A combination of cg_extension_group_flags_e specifying group creation flags.
     int                           ValidationLevel;     /// One of cg_validation_level_e specifying the validation level to enable.
+    size_t                        StagingArenaSize;    /// The number of bytes of pinned memory to reserve on each device heap for staging transfers, or 0 to disable the staging pool. Each execution group reserves its own arena, clamped to the pinnable memory remaining on the heap; group creation fails with CG_OUT_OF_MEMORY if none remains.
 };
 
 /// @summary Define the data associated with a reference to a memory object. 
@@ -1020,6 +1082,83 @@ struct cg_heap_info_t
     size_t                        DeviceAlignment;     /// The address alignment of any buffer allocated on the heap.
     size_t                        UserAlignment;       /// The address alignment of any user-allocated memory shared with the heap.
     size_t                        UserSizeAlign;       /// The allocation size multiple for user-allocated memory.
+    uint64_t                      PinnableUsed;        /// An estimate of the number of bytes of pinnable heap memory currently pinned.
+    uint64_t                      StagingSize;         /// The number of bytes of pinned memory reserved for the staging pools of all execution groups.
+    uint64_t                      StagingUsed;         /// The number of bytes of the staging pools currently handed out or awaiting retirement.
+    uint64_t                      HeapUsed;            /// An estimate of the number of bytes of device-resident objects allocated from the heap.
+    uint64_t                      ResidencyBudget;     /// The number of device-resident bytes above which objects are evicted, or 0 if eviction is disabled.
+    uint32_t                      NUMANode;            /// The NUMA node on which heap memory is committed, or CG_NUMA_NODE_ANY.
+};
+
+/// @summary Define the counters maintained by the device memory residency manager.
+struct cg_residency_stats_t
+{
+    uint64_t                      FrameIndex;          /// The current residency frame index. The frame index advances once per command buffer submission.
+    uint64_t                      EvictionCount;       /// The number of memory objects moved from device memory to host-backed memory.
+    uint64_t                      EvictedBytes;        /// The total number of bytes moved from device memory to host-backed memory.
+    uint64_t                      UploadCount;         /// The number of evicted memory objects restored to device memory on their next use.
+    uint64_t                      UploadedBytes;       /// The total number of bytes restored to device memory.
+    uint64_t                      NonResidentBytes;    /// The number of bytes currently evicted to host-backed memory.
+};
+
+/// @summary Define the counters maintained by the OpenGL state cache of a display. Displays driven by the same device share a rendering context and report the same counters.
+struct cg_gl_state_stats_t
+{
+    uint64_t                      CallsIssued;         /// The total number of state-changing OpenGL calls made by graphics pipelines.
+    uint64_t                      CallsElided;         /// The total number of state-changing OpenGL calls skipped because the state was already current.
+    uint64_t                      FrameCallsIssued;    /// The number of calls issued between the two most recent graphics command buffer submissions.
+    uint64_t                      FrameCallsElided;    /// The number of calls elided between the two most recent graphics command buffer submissions.
+    uint64_t                      UniformBytesWritten; /// The total number of bytes of uniform block data streamed through the uniform ring.
+    uint64_t                      UniformRingWaits;    /// The number of times the host waited for the device to release uniform ring space.
+};
+
+/// @summary Define usage information for the per-thread scratch arenas used for CG_ALLOCATION_TYPE_TEMP and CG_ALLOCATION_TYPE_KERNEL host allocations.
+struct cg_scratch_stats_t
+{
+    size_t                        ArenaSize;           /// The size of each per-thread scratch arena, in bytes.
+    size_t                        ArenaCount;          /// The number of threads that currently own a scratch arena. Arenas are released when their owning thread exits.
+    size_t                        HighWaterMark;       /// The largest number of bytes simultaneously in use within any single arena.
+    uint64_t                      AllocationCount;     /// The number of allocations satisfied from scratch arenas.
+    uint64_t                      OverflowCount;       /// The number of allocations that did not fit in a scratch arena and were passed to the host allocator.
+};
+
+/// @summary Define the host memory allocation counters maintained for a single cg_allocation_type_e.
+struct cg_allocation_stats_t
+{
+    uint64_t                      LiveBytes;           /// The number of bytes currently allocated.
+    uint64_t                      PeakBytes;           /// The largest value LiveBytes has reached.
+    uint64_t                      LiveCount;           /// The number of allocations not yet released.
+    uint64_t                      AllocationCount;     /// The total number of allocations made over the lifetime of the context.
+    uint64_t                      AllocatedBytes;      /// The total number of bytes allocated over the lifetime of the context.
+    uint64_t                      FrameAllocations;    /// The number of allocations made between the two most recent calls to cgExecuteCommandBuffer.
+};
+
+/// @summary Define the counters maintained for a single type of CGFX object. Host memory allocated on behalf of objects is reported by allocation type through CG_CONTEXT_ALLOCATION_STATS.
+struct cg_object_stats_t
+{
+    uint32_t                      ObjectType;          /// One of cg_object_e identifying the object type.
+    size_t                        LiveCount;           /// The number of objects of this type currently alive.
+    size_t                        PeakCount;           /// The largest value LiveCount has reached.
+    uint64_t                      CreateCount;         /// The total number of objects of this type created over the lifetime of the context.
+    uint64_t                      DeleteCount;         /// The total number of objects of this type deleted over the lifetime of the context.
+    size_t                        RecordSize;          /// The number of bytes of host memory used to store the internal record for one object of this type.
+    uint64_t                      TableBytes;          /// The number of bytes of host memory reserved by the context for object records of this type.
+    uint64_t                      LiveBytes;           /// The number of bytes of device memory allocated by live objects of this type. Non-zero only for buffers and images.
+};
+
+/// @summary Define the counters maintained by the on-disk kernel binary cache. The cache hit rate is HitCount / LookupCount.
+struct cg_kernel_cache_stats_t
+{
+    uint64_t                      LookupCount;         /// The number of compute programs for which the cache was searched.
+    uint64_t                      HitCount;            /// The number of lookups satisfied by cached binaries for every device in the execution group.
+    uint64_t                      StoreCount;          /// The number of device binaries written to the cache.
+    uint64_t                      BuildNanos;          /// The total time spent building compute programs from source, in nanoseconds.
+    uint64_t                      LoadNanos;           /// The total time spent loading compute programs from cached or application-supplied binaries, in nanoseconds.
+    uint64_t                      PipelineLookupCount; /// The number of graphics pipeline programs for which the cache was searched.
+    uint64_t                      PipelineHitCount;    /// The number of graphics pipeline programs restored from the cache without linking or reflection.
+    uint64_t                      PipelineStoreCount;  /// The number of graphics pipeline programs written to the cache.
+    uint64_t                      PipelineBuildNanos;  /// The total time spent linking and reflecting graphics pipeline programs, in nanoseconds.
+    uint64_t                      PipelineLoadNanos;   /// The total time spent restoring graphics pipeline programs from the cache, in nanoseconds.
 };
 
 /// @summary Define the basic in-memory format of a single command in a command buffer.
@@ -1046,6 +1185,7 @@ struct cg_kernel_code_t
     uint32_t                      Flags;               /// A combination of cg_kernel_flags_e.
     void const                   *Code;                /// The buffer specifying the kernel code.
     size_t                        CodeSize;            /// The size of the code buffer, in bytes.
+    char const                   *Options;             /// The NULL-terminated OpenCL build options, such as -D defines, or NULL. Options are part of the kernel cache key. Ignored for graphics kernels.
 };
 
 /// @summary Describes fixed-function state configuration for the blending unit.
@@ -1129,6 +1269,7 @@ struct cg_vertex_attribute_t
     size_t                       ComponentCount;       /// The number of components in the attribute.
     size_t                       ByteOffset;           /// The byte offset of the start of the component from the start of the vertex.
     bool                         Normalized;           /// If true, components are normalized to floats prior to access in the shader.
+    uint32_t                     InstanceDivisor;      /// The number of instances drawn per attribute value, or 0 if the attribute advances per-vertex.
 };
 
 /// @summary Defines the basic data passed with a custom pipeline command in a command buffer.
@@ -1285,6 +1426,14 @@ cgGetHeapProperties                                 /// Query the attributes of
     cg_heap_info_t               &heap_info         /// On return, stores attributes of the specified heap.
 );
 
+int
+cgSetHeapResidencyBudget                            /// Set the number of bytes of device-resident memory objects a heap may hold before least-recently-used objects are evicted to host memory.
+(
+    uintptr_t                     context,          /// A CGFX context returned by cgEnumerateDevices.
+    size_t                        ordinal,          /// The ordinal number of the heap to update, in [0, cgGetHeapCount(context)).
+    uint64_t                      budget            /// The residency budget for the heap, in bytes, or 0 to disable eviction.
+);
+
 size_t
 cgGetDeviceCount                                    /// Retrieve the number of available compute devices.
 (
@@ -1504,6 +1653,14 @@ cgCommandBufferCommandAt                            /// Read a command buffer at
     int                          &result            /// On return, set to CG_SUCCESS or another result code.
 );
 
+int
+cgCommandBufferSetSortKey                           /// Set the sort key assigned to commands subsequently appended to a command buffer recorded with CG_COMMAND_BUFFER_FLAG_SORT_BY_KEY.
+(
+    uintptr_t                     context,          /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t                   cmd_buffer,       /// The command buffer handle.
+    uint64_t                      sort_key          /// The 64-bit sort key. Commands with equal keys execute in the order they were recorded.
+);
+
 cg_handle_t
 cgCreateFence                                       /// Create a new fence object in the unsignaled state.
 (
@@ -1570,6 +1727,28 @@ cgCreateVertexDataSource                            /// Create a new vertex data
     int                          &result            /// On return, set to CG_SUCCESS or another result code.
 );
 
+cg_handle_t
+cgCreateVertexDataSourceWithOffsets                 /// Create a vertex data source whose data starts at offsets within shared data buffers.
+(
+    uintptr_t                     context,          /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t                   exec_group,       /// The handle of the execution group where the vertex layout will be used.
+    size_t                        num_buffers,      /// The number of data buffers defining vertex components.
+    cg_handle_t                  *buffer_list,      /// An array of num_buffers handles of data buffers containing the vertex data.
+    size_t const                 *buffer_offsets,   /// An array of num_buffers byte offsets of the first vertex in each data buffer, or NULL.
+    cg_handle_t                   index_buffer,     /// The handle of the data buffer to use for specifying primitive index data, or CG_INVALID_HANDLE.
+    size_t                        index_offset,     /// The byte offset of the first index in index_buffer.
+    size_t const                 *attrib_counts,    /// An array of num_buffers values defining the number of vertex attributes in each data buffer.
+    cg_vertex_attribute_t const **attrib_data,      /// An array of num_buffers arrays defining the vertex attributes in each data buffer.
+    int                          &result            /// On return, set to CG_SUCCESS or another result code.
+);
+
+int
+cgSetKernelCacheDirectory                           /// Enable or disable the on-disk cache of compiled compute and graphics program binaries.
+(
+    uintptr_t                     context,          /// A CGFX context returned by cgEnumerateDevices.
+    char const                   *path              /// The path of an existing directory in which to store program binaries, or NULL to disable the cache.
+);
+
 cg_handle_t
 cgCreateKernel                                      /// Create a new kernel object from some device-executable code.
 (
@@ -1601,6 +1780,43 @@ cgCreateGraphicsPipeline                            /// Create a new graphics pi
     int                          &result            /// On return, set to CG_SUCCESS, CG_UNSUPPORTED or another value.
 );
 
+cg_handle_t
+cgCreateKernelAsync                                 /// Create a new kernel object, building compute programs on a worker thread.
+(
+    uintptr_t                     context,          /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t                   exec_group,       /// The handle of the execution group for which the kernel will be compiled.
+    cg_kernel_code_t const       *create_info,      /// An object specifying source code and behavior.
+    cg_handle_t                   done_event,       /// The handle of an event to signal when the kernel is ready, or CG_INVALID_HANDLE.
+    int                          &result            /// On return, set to CG_SUCCESS, CG_NOT_READY if the build is still in progress, or another result code.
+);
+
+cg_handle_t
+cgCreateComputePipelineAsync                        /// Create a new compute pipeline object from a kernel that may still be building.
+(
+    uintptr_t                     context,          /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t                   exec_group,       /// The handle of the execution group that will execute the pipeline.
+    cg_compute_pipeline_t const  *create_info,      /// A description of the compute pipeline to create.
+    void                         *opaque_state,     /// Opaque state internal to the pipeline implementation.
+    cgPipelineTeardown_fn         teardown_func,    /// A callback to invoke when the pipeline is being disposed of.
+    cg_handle_t                   done_event,       /// The handle of an event to signal when the pipeline is ready, or CG_INVALID_HANDLE.
+    int                          &result            /// On return, set to CG_SUCCESS, CG_NOT_READY if the kernel is still building, or another value.
+);
+
+int
+cgGetBuildStatus                                    /// Determine whether an asynchronously created kernel or pipeline is ready for use.
+(
+    uintptr_t                     context,          /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t                   object            /// The handle of a kernel or pipeline object.
+);
+
+int
+cgSetComputePipelineAutotune                        /// Enable or disable work group size autotuning for dispatches of a compute pipeline that do not specify a local size.
+(
+    uintptr_t                     context,          /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t                   pipeline,         /// The handle of a compute pipeline object.
+    bool                          enable            /// Specify true to time candidate local sizes on the first dispatches of each problem size and use the fastest afterwards.
+);
+
 cg_handle_t
 cgCreateDataBuffer                                  /// Create a new data buffer object.
 (
@@ -1649,6 +1865,25 @@ cgUnmapDataBuffer                                   /// Unmap a portion of a dat
     cg_handle_t                  *event_handle      /// On return, if not NULL, stores the handle to an event signaled when the transfer is complete.
 );
 
+cg_handle_t
+cgAcquireStagingBuffer                              /// Sub-allocate a transient data buffer from the pinned staging pool of a heap. The buffer is persistently mapped into the host address space.
+(
+    uintptr_t                     context,          /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t                   exec_group,       /// The handle of the execution group that owns the staging pool.
+    size_t                        heap_ordinal,     /// The ordinal of the heap to stage through, or CG_IDEAL_HEAP.
+    size_t                        buffer_size,      /// The desired size of the staging buffer, in bytes.
+    void                        **host_address,     /// On return, stores the host-visible address of the start of the staging buffer.
+    int                          &result            /// On return, set to CG_SUCCESS, CG_NOT_READY if the pool is full of in-flight transfers, or another result code.
+);
+
+int
+cgReleaseStagingBuffer                              /// Return a staging buffer to its pool. The memory is recycled once the device has finished accessing it.
+(
+    uintptr_t                     context,          /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t                   buffer,           /// The handle of the staging buffer returned by cgAcquireStagingBuffer.
+    cg_handle_t                   retire_handle     /// The handle of an event or compute fence signaled when the device is done with the buffer, or CG_INVALID_HANDLE.
+);
+
 cg_handle_t
 cgCreateImage                                       /// Create a new image object.
 (
@@ -1891,6 +2126,36 @@ cgImageSlicePitch                                   /// Calculate the number of
     size_t                        pixel_height      /// The unpadded height of the image or mipmap level, in pixels.
 );
 
+int
+cgGenerateHostMipmaps                               /// Generate the mipmap levels of an image stored in host memory.
+(
+    void                         *image_data,       /// The image data in DDS layout, with level 0 of each item populated.
+    size_t                        data_size,        /// The number of bytes of image data.
+    uint32_t                      format,           /// One of dxgi_format_e or DXGI_FORMAT.
+    size_t                        width,            /// The width of level 0, in pixels.
+    size_t                        height,           /// The height of level 0, in pixels.
+    size_t                        item_count,       /// The number of array items, or six times the number of cubes.
+    size_t                        level_count,      /// The number of levels in each item, including level 0.
+    size_t                        thread_count,     /// The maximum number of threads to use, or 0 to use every logical processor.
+    uint32_t                      flags             /// A combination of cg_host_mipmap_flags_e.
+);
+
+int
+cgCompressHostImage                                 /// Encode an R8G8B8A8 image stored in host memory into a block-compressed format.
+(
+    void                         *dst,              /// The first block of the destination, for example a region returned by cgMapImageRegion.
+    size_t                        dst_size,         /// The number of bytes available at dst.
+    size_t                        dst_row_pitch,    /// The number of bytes between rows of blocks, or 0 to use cgImageRowPitch.
+    uint32_t                      dst_format,       /// One of BC1_UNORM[_SRGB], BC3_UNORM[_SRGB], BC4_UNORM, BC5_UNORM or BC7_UNORM[_SRGB].
+    void const                   *src,              /// The first pixel of the R8G8B8A8 source image.
+    size_t                        src_row_pitch,    /// The number of bytes per-row in the source image, or 0 if rows are tightly packed.
+    size_t                        width,            /// The width of the image, in pixels.
+    size_t                        height,           /// The height of the image, in pixels.
+    int                           quality,          /// One of cg_block_compression_quality_e.
+    size_t                        thread_count,     /// The maximum number of threads to use, or 0 to use every logical processor.
+    uint64_t                     *squared_error     /// If non-NULL, on return stores the sum of squared errors over the channels stored by the format.
+);
+
 bool
 cgIsCubemapImageDDS                                 /// Determine whether DDS header data specifies a cubemap image.
 (
@@ -40,6 +40,23 @@ enum cg_result_ext_e : int
     CG_WINDOW_RECREATED_EXT      = CG_RESULT_NON_FAILURE_EXT+0, /// The window was destroyed and re-created successfully.
 };
 
+/// @summary Define the frame pacing and latency statistics for a display. Percentiles are computed over the most recent 
+/// frames the device has finished, and all durations are specified in nanoseconds. See cgGetFrameStatsEXT.
+struct cg_frame_stats_ext_t
+{
+    uint64_t     FrameCount;     /// The total number of frames presented with cgPresentDisplayEXT.
+    uint64_t     PacingWaits;    /// The number of times presentation blocked to honor the in-flight frame limit.
+    size_t       FramesInFlight; /// The number of presented frames the device had not finished when the most recent present returned.
+    size_t       SampleCount;    /// The number of finished frames included in the frame time and device latency percentiles.
+    size_t       InputSamples;   /// The number of sampled frames that consumed an input mark, included in the input latency percentiles.
+    uint64_t     FrameTimeP50;   /// The median time between consecutive presents.
+    uint64_t     FrameTimeP99;   /// The 99th percentile time between consecutive presents.
+    uint64_t     DeviceTimeP50;  /// The median time from the present request until the device finished rendering the frame.
+    uint64_t     DeviceTimeP99;  /// The 99th percentile time from the present request until the device finished rendering the frame.
+    uint64_t     InputTimeP50;   /// The median time from the oldest input mark consumed by a frame until the swap call returned.
+    uint64_t     InputTimeP99;   /// The 99th percentile time from the oldest input mark consumed by a frame until the swap call returned.
+};
+
 /*/////////////////
 //   Functions   //
 /////////////////*/
@@ -110,6 +127,37 @@ cgPresentDrawableEXT             /// Queue presentation of a drawable to the scr
     HDC          drawable        /// The device context of the window representing the drawable.
 );
 
+int
+cgPresentDisplayEXT              /// Queue presentation of a drawable and record frame timing for the display. Call from the thread with the display rendering context current.
+(
+    uintptr_t    context,        /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t  display,        /// The display whose rendering context rendered the frame.
+    HDC          drawable        /// The device context of the window representing the drawable, or NULL to use the primary display window. Ignored for headless displays.
+);
+
+int
+cgSetFramePacingEXT              /// Limit the number of presented frames the device may still be rendering when cgPresentDisplayEXT returns. Call from the thread with the display rendering context current.
+(
+    uintptr_t    context,        /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t  display,        /// The display whose presentation is paced.
+    size_t       max_in_flight   /// The maximum number of unfinished frames, or 0 to only limit by the internal tracking capacity.
+);
+
+int
+cgMarkFrameInputEXT              /// Record that input was sampled for the next frame presented on a display. May be called from any thread.
+(
+    uintptr_t    context,        /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t  display         /// The display that will present the frame reflecting the input.
+);
+
+int
+cgGetFrameStatsEXT               /// Compute frame time and latency percentiles for a display. May be called from any thread.
+(
+    uintptr_t    context,        /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t  display,        /// The display to query.
+    cg_frame_stats_ext_t *stats  /// On return, stores the frame pacing and latency statistics.
+);
+
 #ifdef __cplusplus
 };     /* extern "C"  */
 #endif /* __cplusplus */
@@ -30,6 +30,153 @@
 /*//////////////////
 //   Data Types   //
 //////////////////*/
+/// @summary Define the GENERIC compute pipeline command identifiers.
+enum cg_compute_pipeline_generic_command_id_e : uint16_t
+{
+    CG_COMPUTE_GENERIC_CMD_DISPATCH       = 0, /// Bind named arguments and invoke the pipeline kernel.
+    CG_COMPUTE_GENERIC_CMD_DISPATCH_SPLIT = 1, /// Bind named arguments and invoke the pipeline kernel across every device of the execution group.
+};
+
+/// @summary Define the types of values that can be bound to a kernel argument through the GENERIC compute pipeline.
+enum cg_compute_argument_type_e : uint16_t
+{
+    CG_COMPUTE_ARGUMENT_VALUE          = 0,    /// The argument is passed by value (scalar, vector or struct). Value and DataSize specify the bytes to copy.
+    CG_COMPUTE_ARGUMENT_BUFFER         = 1,    /// The argument is a __global or __constant pointer. Object specifies the handle of a data buffer.
+    CG_COMPUTE_ARGUMENT_IMAGE          = 2,    /// The argument is an image. Object specifies the handle of an image object.
+    CG_COMPUTE_ARGUMENT_SAMPLER        = 3,    /// The argument is a sampler_t. Object specifies the handle of an image sampler object.
+    CG_COMPUTE_ARGUMENT_LOCAL          = 4,    /// The argument is a __local pointer. DataSize specifies the number of bytes of local memory to allocate.
+};
+
+/// @summary Describes a single named argument binding for the GENERIC compute pipeline.
+struct cg_compute_argument_t
+{
+    uint32_t    Name;                 /// The argument name hash, returned by cgComputeArgumentName. Compute this once at startup.
+    uint16_t    Type;                 /// One of cg_compute_argument_type_e specifying how to interpret the argument data.
+    uint16_t    DataSize;             /// For VALUE arguments, the number of bytes at Value; for LOCAL arguments, the local memory size in bytes.
+    cg_handle_t Object;               /// For BUFFER, IMAGE and SAMPLER arguments, the handle of the object to bind.
+    void const *Value;                /// For VALUE arguments, a pointer to the data. The data is copied into the command buffer.
+};
+
+/// @summary Define the fixed-size portion of a GENERIC compute pipeline dispatch. ArgumentCount packed argument records follow.
+struct cg_compute_pipeline_generic_dispatch_t
+{
+    uint32_t    WorkDimension;        /// The number of work dimensions, in [1, 3].
+    uint32_t    ArgumentCount;        /// The number of packed argument records following this structure.
+    size_t      GlobalSize[3];        /// The number of global work items in each dimension.
+    size_t      LocalSize[3];         /// The number of work items in a work group in each dimension. All zero selects the size at execution time.
+};
+
+/// @summary Define the PRIMITIVES compute pipeline command identifiers.
+enum cg_compute_pipeline_primitives_command_id_e : uint16_t
+{
+    CG_COMPUTE_PRIMITIVES_CMD_SCAN        = 0, /// Compute the exclusive or inclusive prefix sum of a buffer of 32-bit integers.
+    CG_COMPUTE_PRIMITIVES_CMD_REDUCE      = 1, /// Reduce a buffer of 32-bit values to a single value.
+    CG_COMPUTE_PRIMITIVES_CMD_COMPACT     = 2, /// Copy the 32-bit values whose flag is non-zero to a densely packed output buffer.
+    CG_COMPUTE_PRIMITIVES_CMD_SORT        = 3, /// Sort a buffer of 32-bit unsigned integer keys, and optionally an associated buffer of 32-bit values.
+};
+
+/// @summary Define the element types supported by the PRIMITIVES compute pipeline REDUCE command.
+enum cg_compute_primitive_type_e : uint32_t
+{
+    CG_COMPUTE_PRIMITIVE_UINT32        = 0,    /// Elements are 32-bit unsigned integers.
+    CG_COMPUTE_PRIMITIVE_INT32         = 1,    /// Elements are 32-bit signed integers.
+    CG_COMPUTE_PRIMITIVE_FLOAT32       = 2,    /// Elements are 32-bit IEEE-754 floating point values.
+    CG_COMPUTE_PRIMITIVE_TYPE_COUNT
+};
+
+/// @summary Define the operators supported by the PRIMITIVES compute pipeline REDUCE command.
+enum cg_compute_primitive_op_e : uint32_t
+{
+    CG_COMPUTE_PRIMITIVE_SUM           = 0,    /// Compute the sum of all elements. Integer sums wrap on overflow.
+    CG_COMPUTE_PRIMITIVE_MIN           = 1,    /// Compute the minimum element value.
+    CG_COMPUTE_PRIMITIVE_MAX           = 2,    /// Compute the maximum element value.
+    CG_COMPUTE_PRIMITIVE_OP_COUNT
+};
+
+/// @summary Define the arguments for the PRIMITIVES compute pipeline SCAN command.
+struct cg_compute_pipeline_primitives_scan_t
+{
+    cg_handle_t InputBuffer;          /// The handle of the buffer containing Count 32-bit integers to scan.
+    cg_handle_t OutputBuffer;         /// The handle of the buffer receiving Count 32-bit prefix sums. May be the same as InputBuffer.
+    uint32_t    Count;                /// The number of elements to scan.
+    uint32_t    Inclusive;            /// Non-zero to compute an inclusive scan, or zero to compute an exclusive scan.
+};
+
+/// @summary Define the arguments for the PRIMITIVES compute pipeline REDUCE command.
+struct cg_compute_pipeline_primitives_reduce_t
+{
+    cg_handle_t InputBuffer;          /// The handle of the buffer containing Count 32-bit values to reduce.
+    cg_handle_t OutputBuffer;         /// The handle of the buffer receiving the 32-bit result.
+    uint32_t    Count;                /// The number of elements to reduce.
+    uint32_t    OutputIndex;          /// The zero-based index of the 32-bit element in OutputBuffer to write the result to.
+    uint32_t    DataType;             /// One of cg_compute_primitive_type_e specifying the element type.
+    uint32_t    Operation;            /// One of cg_compute_primitive_op_e specifying the reduction operator.
+};
+
+/// @summary Define the arguments for the PRIMITIVES compute pipeline COMPACT command.
+struct cg_compute_pipeline_primitives_compact_t
+{
+    cg_handle_t InputBuffer;          /// The handle of the buffer containing Count 32-bit values.
+    cg_handle_t FlagBuffer;           /// The handle of the buffer containing Count 32-bit flags. Values with a non-zero flag are kept.
+    cg_handle_t OutputBuffer;         /// The handle of the buffer receiving the kept values, in their original order. Must hold Count values.
+    cg_handle_t CountBuffer;          /// The handle of the buffer receiving the number of kept values as a 32-bit unsigned integer at offset zero.
+    uint32_t    Count;                /// The number of elements in InputBuffer and FlagBuffer.
+    uint32_t    Reserved;             /// Reserved for future use. Set to zero.
+};
+
+/// @summary Define the arguments for the PRIMITIVES compute pipeline SORT command.
+struct cg_compute_pipeline_primitives_sort_t
+{
+    cg_handle_t KeyBuffer;            /// The handle of the buffer containing Count 32-bit unsigned integer keys, sorted in-place into ascending order.
+    cg_handle_t ValueBuffer;          /// The handle of the buffer containing Count 32-bit values permuted along with the keys, or CG_INVALID_HANDLE.
+    uint32_t    Count;                /// The number of keys to sort.
+    uint32_t    KeyBits;              /// The number of low-order key bits to sort on, in [1, 32], rounded up to a multiple of 4. Fewer bits require fewer passes.
+};
+
+/// @summary Define the IMAGE compute pipeline command identifiers.
+enum cg_compute_pipeline_image_command_id_e : uint16_t
+{
+    CG_COMPUTE_IMAGE_CMD_GENERATE_MIPS    = 0, /// Generate every mipmap level of an image from level 0.
+    CG_COMPUTE_IMAGE_CMD_BLUR             = 1, /// Apply a separable Gaussian blur to level 0 of an image.
+    CG_COMPUTE_IMAGE_CMD_RESIZE           = 2, /// Resample level 0 of an image into level 0 of another image.
+};
+
+/// @summary Define the resampling filters supported by the IMAGE compute pipeline.
+enum cg_compute_image_filter_e : uint32_t
+{
+    CG_COMPUTE_IMAGE_FILTER_BOX        = 0,    /// Average the source pixels covered by each destination pixel.
+    CG_COMPUTE_IMAGE_FILTER_BILINEAR   = 1,    /// Tent filter; bilinear interpolation when magnifying.
+    CG_COMPUTE_IMAGE_FILTER_LANCZOS    = 2,    /// Three-lobe Lanczos windowed sinc.
+    CG_COMPUTE_IMAGE_FILTER_KAISER     = 3,    /// Kaiser windowed sinc (width 3, alpha 4). Sharper than box for mipmaps, with little ringing.
+    CG_COMPUTE_IMAGE_FILTER_COUNT
+};
+
+/// @summary Define the arguments for the IMAGE compute pipeline GENERATE_MIPS command.
+struct cg_compute_pipeline_image_mips_t
+{
+    cg_handle_t Image;                /// The handle of the image. Levels 1 through LevelCount-1 are overwritten.
+    uint32_t    Filter;               /// One of cg_compute_image_filter_e specifying the downsampling filter.
+    uint32_t    Reserved;             /// Reserved for future use. Set to zero.
+};
+
+/// @summary Define the arguments for the IMAGE compute pipeline BLUR command.
+struct cg_compute_pipeline_image_blur_t
+{
+    cg_handle_t SourceImage;          /// The handle of the image to blur.
+    cg_handle_t TargetImage;          /// The handle of the image receiving the result. May be the same as SourceImage.
+    float       Sigma;                /// The standard deviation of the Gaussian, in pixels.
+    uint32_t    Reserved;             /// Reserved for future use. Set to zero.
+};
+
+/// @summary Define the arguments for the IMAGE compute pipeline RESIZE command.
+struct cg_compute_pipeline_image_resize_t
+{
+    cg_handle_t SourceImage;          /// The handle of the image to resample.
+    cg_handle_t TargetImage;          /// The handle of the image receiving the result. Its dimensions specify the output size.
+    uint32_t    Filter;               /// One of cg_compute_image_filter_e specifying the resampling filter.
+    uint32_t    Reserved;             /// Reserved for future use. Set to zero.
+};
+
 /// @summary Define the TEST01 compute pipeline command identifiers.
 enum cg_compute_pipeline_test01_command_id_e : uint16_t
 {
@@ -68,6 +215,155 @@ cgComputeDispatchTest01               /// Enqueue a dispatch command for compute
     cg_handle_t wait_event            /// The handle of the event to wait on before executing the pipeline.
 );
 
+uint32_t
+cgComputeArgumentName                 /// Compute the name hash used to bind a kernel argument by name through the GENERIC compute pipeline.
+(
+    char const *name                  /// A NULL-terminated ASCII string specifying the kernel argument name, as declared in the kernel source.
+);
+
+int
+cgComputeDispatch                     /// Enqueue a dispatch command for any compute pipeline, binding arguments by name.
+(
+    uintptr_t                    context,      /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t                  cmd_buffer,   /// The handle of the command buffer to write to.
+    cg_handle_t                  pipeline,     /// The handle of the pipeline to execute, returned by cgCreateComputePipeline or cgCreateComputePipelineAsync.
+    size_t                       work_dim,     /// The number of work dimensions, in [1, 3].
+    size_t const                *global_size,  /// An array of work_dim values specifying the number of global work items in each dimension.
+    size_t const                *local_size,   /// An array of work_dim values specifying the work group size in each dimension, or NULL to use the required, autotuned or runtime-selected size.
+    size_t                       num_args,     /// The number of items in the args array.
+    cg_compute_argument_t const *args,         /// The set of argument bindings. Arguments not specified keep their previous value.
+    cg_handle_t                  done_event,   /// The handle of the event to signal when the pipeline has finished executing.
+    cg_handle_t                  wait_event    /// The handle of the event to wait on before executing the pipeline.
+);
+
+int
+cgComputeDispatchSplit                /// Enqueue a dispatch command for any compute pipeline that splits the work across every device of its execution group.
+(
+    uintptr_t                    context,      /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t                  cmd_buffer,   /// The handle of the command buffer to write to.
+    cg_handle_t                  pipeline,     /// The handle of the pipeline to execute, returned by cgCreateComputePipeline or cgCreateComputePipelineAsync.
+    size_t                       work_dim,     /// The number of work dimensions, in [1, 3].
+    size_t const                *global_size,  /// An array of work_dim values specifying the number of global work items in each dimension.
+    size_t const                *local_size,   /// An array of work_dim values specifying the work group size in each dimension, or NULL to use the required or runtime-selected size. Each global size must be a multiple of the work group size.
+    size_t                       num_args,     /// The number of items in the args array.
+    cg_compute_argument_t const *args,         /// The set of argument bindings. Arguments not specified keep their previous value.
+    cg_handle_t                  done_event,   /// The handle of the event to signal when every part has finished executing.
+    cg_handle_t                  wait_event    /// The handle of the event to wait on before executing the pipeline.
+);
+
+cg_handle_t
+cgCreateComputePipelinePrimitives     /// Compile the kernels and generate the pipeline object for the parallel primitives library.
+(
+    uintptr_t   context,              /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t exec_group,           /// The handle of the execution group used to execute the pipeline.
+    int        &result                /// On return, set to CG_SUCCESS or another value.
+);
+
+int
+cgComputeScan                         /// Enqueue a command to compute the prefix sum of a buffer of 32-bit integers.
+(
+    uintptr_t   context,              /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t cmd_buffer,           /// The handle of the command buffer to write to.
+    cg_handle_t pipeline,             /// The handle of the pipeline to execute, returned by cgCreateComputePipelinePrimitives.
+    cg_handle_t in_buffer,            /// The handle of the buffer containing the values to scan.
+    cg_handle_t out_buffer,           /// The handle of the buffer to write the prefix sums to. May be the same as in_buffer.
+    size_t      count,                /// The number of 32-bit values to scan.
+    bool        inclusive,            /// true to compute an inclusive scan, or false to compute an exclusive scan.
+    cg_handle_t done_event,           /// The handle of the event to signal when the pipeline has finished executing.
+    cg_handle_t wait_event            /// The handle of the event to wait on before executing the pipeline.
+);
+
+int
+cgComputeReduce                       /// Enqueue a command to reduce a buffer of 32-bit values to a single value.
+(
+    uintptr_t   context,              /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t cmd_buffer,           /// The handle of the command buffer to write to.
+    cg_handle_t pipeline,             /// The handle of the pipeline to execute, returned by cgCreateComputePipelinePrimitives.
+    cg_handle_t in_buffer,            /// The handle of the buffer containing the values to reduce.
+    size_t      count,                /// The number of 32-bit values to reduce.
+    int         data_type,            /// One of cg_compute_primitive_type_e specifying the element type.
+    int         operation,            /// One of cg_compute_primitive_op_e specifying the reduction operator.
+    cg_handle_t out_buffer,           /// The handle of the buffer to write the result to.
+    size_t      out_index,            /// The zero-based index of the 32-bit element in out_buffer to write the result to.
+    cg_handle_t done_event,           /// The handle of the event to signal when the pipeline has finished executing.
+    cg_handle_t wait_event            /// The handle of the event to wait on before executing the pipeline.
+);
+
+int
+cgComputeCompact                      /// Enqueue a command to copy the flagged values of a buffer to a densely packed output buffer.
+(
+    uintptr_t   context,              /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t cmd_buffer,           /// The handle of the command buffer to write to.
+    cg_handle_t pipeline,             /// The handle of the pipeline to execute, returned by cgCreateComputePipelinePrimitives.
+    cg_handle_t in_buffer,            /// The handle of the buffer containing the 32-bit values to compact.
+    cg_handle_t flag_buffer,          /// The handle of the buffer containing one 32-bit flag per value. Values with a non-zero flag are kept.
+    size_t      count,                /// The number of values in in_buffer and flag_buffer.
+    cg_handle_t out_buffer,           /// The handle of the buffer to write the kept values to. Must be large enough to hold count values.
+    cg_handle_t count_buffer,         /// The handle of the buffer to write the number of kept values to, as a 32-bit unsigned integer.
+    cg_handle_t done_event,           /// The handle of the event to signal when the pipeline has finished executing.
+    cg_handle_t wait_event            /// The handle of the event to wait on before executing the pipeline.
+);
+
+int
+cgComputeSort                         /// Enqueue a command to radix sort a buffer of 32-bit unsigned integer keys and optional values.
+(
+    uintptr_t   context,              /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t cmd_buffer,           /// The handle of the command buffer to write to.
+    cg_handle_t pipeline,             /// The handle of the pipeline to execute, returned by cgCreateComputePipelinePrimitives.
+    cg_handle_t key_buffer,           /// The handle of the buffer containing the keys, which are sorted in-place.
+    cg_handle_t value_buffer,         /// The handle of the buffer containing the 32-bit values to permute with the keys, or CG_INVALID_HANDLE.
+    size_t      count,                /// The number of keys to sort.
+    size_t      key_bits,             /// The number of low-order key bits to sort on, in [1, 32], rounded up to a multiple of 4.
+    cg_handle_t done_event,           /// The handle of the event to signal when the pipeline has finished executing.
+    cg_handle_t wait_event            /// The handle of the event to wait on before executing the pipeline.
+);
+
+cg_handle_t
+cgCreateComputePipelineImage          /// Compile the kernels and generate the pipeline object for image mipmap generation, blur and resize.
+(
+    uintptr_t   context,              /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t exec_group,           /// The handle of the execution group used to execute the pipeline.
+    int        &result                /// On return, set to CG_SUCCESS or another value.
+);
+
+int
+cgComputeGenerateMips                 /// Enqueue a command to generate every mipmap level of an image from level 0.
+(
+    uintptr_t   context,              /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t cmd_buffer,           /// The handle of the command buffer to write to.
+    cg_handle_t pipeline,             /// The handle of the pipeline to execute, returned by cgCreateComputePipelineImage.
+    cg_handle_t image,                /// The handle of the image. Images with more than one level must be shared with OpenGL.
+    int         filter,               /// One of cg_compute_image_filter_e, typically CG_COMPUTE_IMAGE_FILTER_BOX or CG_COMPUTE_IMAGE_FILTER_KAISER.
+    cg_handle_t done_event,           /// The handle of the event to signal when the pipeline has finished executing.
+    cg_handle_t wait_event            /// The handle of the event to wait on before executing the pipeline.
+);
+
+int
+cgComputeBlur                         /// Enqueue a command to apply a separable Gaussian blur to an image.
+(
+    uintptr_t   context,              /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t cmd_buffer,           /// The handle of the command buffer to write to.
+    cg_handle_t pipeline,             /// The handle of the pipeline to execute, returned by cgCreateComputePipelineImage.
+    cg_handle_t src_image,            /// The handle of the image to blur.
+    cg_handle_t dst_image,            /// The handle of the image to write. Must have the same dimensions as src_image, and may be the same image.
+    float       sigma,                /// The standard deviation of the Gaussian, in pixels. Must be greater than zero.
+    cg_handle_t done_event,           /// The handle of the event to signal when the pipeline has finished executing.
+    cg_handle_t wait_event            /// The handle of the event to wait on before executing the pipeline.
+);
+
+int
+cgComputeResize                       /// Enqueue a command to resample an image to the dimensions of another image.
+(
+    uintptr_t   context,              /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t cmd_buffer,           /// The handle of the command buffer to write to.
+    cg_handle_t pipeline,             /// The handle of the pipeline to execute, returned by cgCreateComputePipelineImage.
+    cg_handle_t src_image,            /// The handle of the image to resample.
+    cg_handle_t dst_image,            /// The handle of the image to write. Must not be the same as src_image.
+    int         filter,               /// One of cg_compute_image_filter_e, typically CG_COMPUTE_IMAGE_FILTER_BILINEAR or CG_COMPUTE_IMAGE_FILTER_LANCZOS.
+    cg_handle_t done_event,           /// The handle of the event to signal when the pipeline has finished executing.
+    cg_handle_t wait_event            /// The handle of the event to wait on before executing the pipeline.
+);
+
 #ifdef __cplusplus
 };     /* extern "C"  */
 #endif /* __cplusplus */
@@ -30,6 +30,47 @@
 /*//////////////////
 //   Data Types   //
 //////////////////*/
+/// @summary Define the GENERIC graphics pipeline command identifiers.
+enum cg_graphics_pipeline_generic_command_id_e : uint16_t
+{
+    CG_GRAPHICS_GENERIC_CMD_SET_VIEWPORT  = 0,  /// Set the viewport rectangle of the rendering context.
+    CG_GRAPHICS_GENERIC_CMD_DRAW          = 1,  /// Draw one or more instances of a range of vertices or indices.
+    CG_GRAPHICS_GENERIC_CMD_DRAW_INDIRECT = 2,  /// Draw a list of ranges whose parameters are read from a data buffer.
+    CG_GRAPHICS_GENERIC_CMD_SET_UNIFORM_BLOCK = 3, /// Stream constant data into a uniform buffer range bound to a uniform block.
+    CG_GRAPHICS_GENERIC_CMD_SET_RENDER_TARGET = 4, /// Select the images, or the default framebuffer, that subsequent draws render into.
+    CG_GRAPHICS_GENERIC_CMD_READ_PIXELS       = 5, /// Copy a region of the framebuffer or of an image into a data buffer without stalling.
+    CG_GRAPHICS_GENERIC_CMD_UPLOAD_IMAGE      = 6, /// Copy pixel data from a data buffer into a region of an image level without stalling.
+};
+
+/// @summary Define the types of index data that can be read by GENERIC graphics pipeline draw commands.
+enum cg_graphics_index_type_e : int
+{
+    CG_GRAPHICS_INDEX_NONE                = 0,  /// Vertices are read sequentially; the index buffer of the vertex data source is not used.
+    CG_GRAPHICS_INDEX_UINT16              = 1,  /// Indices are 16-bit unsigned integer values.
+    CG_GRAPHICS_INDEX_UINT32              = 2,  /// Indices are 32-bit unsigned integer values.
+};
+
+/// @summary Define the layout of a single non-indexed draw record read by cgGraphicsDrawIndirect. The layout matches 
+/// the OpenGL DrawArraysIndirectCommand structure, so compute kernels can write the records directly.
+struct cg_draw_indirect_command_t
+{
+    uint32_t         VertexCount;               /// The number of vertices to draw.
+    uint32_t         InstanceCount;             /// The number of instances to draw. Zero skips the record.
+    uint32_t         FirstVertex;               /// The zero-based index of the first vertex to read.
+    uint32_t         BaseInstance;              /// The value added to the instance index when reading per-instance attributes. Must be zero prior to OpenGL 4.2.
+};
+
+/// @summary Define the layout of a single indexed draw record read by cgGraphicsDrawIndirect. The layout matches 
+/// the OpenGL DrawElementsIndirectCommand structure, so compute kernels can write the records directly.
+struct cg_draw_indexed_indirect_command_t
+{
+    uint32_t         IndexCount;                /// The number of indices to read from the index buffer.
+    uint32_t         InstanceCount;             /// The number of instances to draw. Zero skips the record.
+    uint32_t         FirstIndex;                /// The zero-based index of the first index to read from the index buffer.
+    int32_t          BaseVertex;                /// The offset value added to each index read from the index buffer.
+    uint32_t         BaseInstance;              /// The value added to the instance index when reading per-instance attributes. Must be zero prior to OpenGL 4.2.
+};
+
 /// @summary A structure used to read or write vertex data in the TEST01 pipeline vertex buffer.
 struct CG_GFX_TEST01_VERTEX
 {
@@ -92,6 +133,117 @@ cgGraphicsTest01DrawTriangles                   /// Enqueue an explicit draw com
     cg_handle_t wait_event                      /// The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
 );
 
+int
+cgGraphicsSetViewport                           /// Enqueue a viewport change command for any graphics pipeline.
+(
+    uintptr_t   context,                        /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t cmd_buffer,                     /// The handle of the command buffer to write to.
+    cg_handle_t pipeline,                       /// The handle of the graphics pipeline, returned by cgCreateGraphicsPipeline.
+    int         x,                              /// The x-coordinate of the upper-left corner of the viewport.
+    int         y,                              /// The y-coordinate of the upper-left corner of the viewport.
+    int         width,                          /// The width of the viewport, in pixels.
+    int         height,                         /// The height of the viewport, in pixels.
+    cg_handle_t done_event,                     /// The handle of the event to signal when the command has been executed, or CG_INVALID_HANDLE.
+    cg_handle_t wait_event                      /// The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+);
+
+int
+cgGraphicsDrawInstanced                         /// Enqueue an instanced draw command for any graphics pipeline.
+(
+    uintptr_t   context,                        /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t cmd_buffer,                     /// The handle of the command buffer to write to.
+    cg_handle_t pipeline,                       /// The handle of the graphics pipeline, returned by cgCreateGraphicsPipeline.
+    cg_handle_t data_source,                    /// The handle of the vertex data source buffers.
+    int         index_type,                     /// One of cg_graphics_index_type_e specifying the index data type.
+    uint32_t    first,                          /// The zero-based index of the first index, or of the first vertex if index_type is CG_GRAPHICS_INDEX_NONE.
+    uint32_t    count,                          /// The number of indices, or vertices if index_type is CG_GRAPHICS_INDEX_NONE, to draw for each instance.
+    int32_t     base_vertex,                    /// The offset added to each index value read from the index buffer.
+    uint32_t    instance_count,                 /// The number of instances to draw.
+    uint32_t    base_instance,                  /// The value added to the instance index when reading per-instance attributes.
+    cg_handle_t done_event,                     /// The handle of the event to signal when the command has been executed, or CG_INVALID_HANDLE.
+    cg_handle_t wait_event                      /// The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+);
+
+int
+cgGraphicsDrawIndirect                          /// Enqueue a multi-draw command for any graphics pipeline whose draw records are read from a data buffer.
+(
+    uintptr_t   context,                        /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t cmd_buffer,                     /// The handle of the command buffer to write to.
+    cg_handle_t pipeline,                       /// The handle of the graphics pipeline, returned by cgCreateGraphicsPipeline.
+    cg_handle_t data_source,                    /// The handle of the vertex data source buffers.
+    int         index_type,                     /// One of cg_graphics_index_type_e specifying the index data type and draw record layout.
+    cg_handle_t draw_buffer,                    /// The handle of the data buffer containing the draw records.
+    size_t      draw_offset,                    /// The byte offset of the first draw record in draw_buffer. Must be a multiple of 4.
+    uint32_t    max_draw_count,                 /// The maximum number of draw records to read.
+    uint32_t    draw_stride,                    /// The number of bytes between draw records, or 0 if records are tightly packed.
+    cg_handle_t count_buffer,                   /// The handle of a data buffer containing a 32-bit draw count, or CG_INVALID_HANDLE to draw max_draw_count records.
+    size_t      count_offset,                   /// The byte offset of the draw count in count_buffer. Must be a multiple of 4.
+    cg_handle_t done_event,                     /// The handle of the event to signal when the command has been executed, or CG_INVALID_HANDLE.
+    cg_handle_t wait_event                      /// The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+);
+
+int
+cgGraphicsSetUniformBlock                       /// Enqueue an update of the constant data read by a uniform block of any graphics pipeline.
+(
+    uintptr_t   context,                        /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t cmd_buffer,                     /// The handle of the command buffer to write to.
+    cg_handle_t pipeline,                       /// The handle of the graphics pipeline, returned by cgCreateGraphicsPipeline.
+    char const *block_name,                     /// The name of the uniform block declared by the pipeline's shaders.
+    void const *data,                           /// The block data, laid out as declared in the shader (std140 is recommended.)
+    size_t      data_size,                      /// The number of bytes of block data. Must be at least the size of the block.
+    cg_handle_t done_event,                     /// The handle of the event to signal when the command has been executed, or CG_INVALID_HANDLE.
+    cg_handle_t wait_event                      /// The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+);
+
+int
+cgGraphicsSetRenderTarget                       /// Enqueue a change of the images rendered into by subsequent commands of any graphics pipeline.
+(
+    uintptr_t   context,                        /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t cmd_buffer,                     /// The handle of the command buffer to write to.
+    cg_handle_t pipeline,                       /// The handle of the graphics pipeline, returned by cgCreateGraphicsPipeline.
+    cg_handle_t color_image,                    /// The handle of the 2D color image to render into, or CG_INVALID_HANDLE for the default framebuffer.
+    cg_handle_t depth_image,                    /// The handle of the 2D depth image to render into, or CG_INVALID_HANDLE.
+    size_t      level,                          /// The mipmap level of the images to render into.
+    float const*clear_rgba,                     /// The RGBA color to clear the target to, or NULL to preserve the existing contents.
+    cg_handle_t done_event,                     /// The handle of the event to signal when the command has been executed, or CG_INVALID_HANDLE.
+    cg_handle_t wait_event                      /// The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+);
+
+int
+cgGraphicsReadPixels                            /// Enqueue an asynchronous copy of a framebuffer or image region into a data buffer for any graphics pipeline.
+(
+    uintptr_t   context,                        /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t cmd_buffer,                     /// The handle of the command buffer to write to.
+    cg_handle_t pipeline,                       /// The handle of the graphics pipeline, returned by cgCreateGraphicsPipeline.
+    cg_handle_t source_image,                   /// The handle of the 2D image to read, or CG_INVALID_HANDLE to read the current render target.
+    size_t      level,                          /// The mipmap level of the source image. Must be zero when reading the render target.
+    size_t      x,                              /// The x-coordinate of the lower-left corner of the region to read.
+    size_t      y,                              /// The y-coordinate of the lower-left corner of the region to read.
+    size_t      width,                          /// The width of the region to read, in pixels.
+    size_t      height,                         /// The height of the region to read, in pixels.
+    cg_handle_t target_buffer,                  /// The handle of the data buffer, created with CG_MEMORY_OBJECT_KERNEL_GRAPHICS, that receives the pixels.
+    size_t      target_offset,                  /// The byte offset in target_buffer of the first row.
+    cg_handle_t done_event,                     /// The handle of the event to signal when the command has been executed, or CG_INVALID_HANDLE.
+    cg_handle_t wait_event                      /// The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+);
+
+int
+cgGraphicsUploadImage                           /// Enqueue an asynchronous copy of pixel data from a data buffer into an image region for any graphics pipeline.
+(
+    uintptr_t   context,                        /// A CGFX context returned by cgEnumerateDevices.
+    cg_handle_t cmd_buffer,                     /// The handle of the command buffer to write to.
+    cg_handle_t pipeline,                       /// The handle of the graphics pipeline, returned by cgCreateGraphicsPipeline.
+    cg_handle_t source_buffer,                  /// The handle of the data buffer, created with CG_MEMORY_OBJECT_KERNEL_GRAPHICS, containing the pixel data.
+    size_t      source_offset,                  /// The byte offset in source_buffer of the first row.
+    size_t      source_row_pitch,               /// The number of bytes between rows in source_buffer, or 0 if rows are tightly packed. Compressed rows are always tightly packed.
+    cg_handle_t target_image,                   /// The handle of the image to write, created with CG_MEMORY_OBJECT_KERNEL_GRAPHICS.
+    size_t      level,                          /// The mipmap level of the image to write.
+    size_t      xyz[3],                         /// The x-coordinate, y-coordinate and slice or array index of the upper-left corner of the region to write.
+    size_t      whd[3],                         /// The width (in pixels), height (in pixels) and depth (in slices) of the region to write.
+    cg_handle_t done_event,                     /// The handle of the event to signal when the command has been executed, or CG_INVALID_HANDLE.
+    cg_handle_t wait_event                      /// The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+);
+
 #ifdef __cplusplus
 };     /* extern "C"  */
 #endif /* __cplusplus */
@@ -65,6 +65,7 @@
 #include <stdlib.h>
 #include <malloc.h> // _msize
 #include <float.h>
+#include <math.h>
 
 #include <atomic>
 #include <thread>
@@ -85,8 +86,11 @@
 //   Forward Declarations   //
 ////////////////////////////*/
 struct CG_QUEUE;
+struct CG_HEAP;
+struct CG_HOST_ALLOCATOR;
 struct CG_DEVICE;
 struct CG_KERNEL;
+struct CG_KERNEL_BUILD;
 struct CG_DISPLAY;
 struct CG_CONTEXT;
 struct CG_PIPELINE;
@@ -148,6 +152,42 @@ struct CG_EXEC_GROUP;
 #define CG_MAX_VERTEX_DATA_SOURCES               (16384)
 #define CG_MAX_MEM_REFS                          (2048)
 
+/// @summary Define the maximum number of outstanding slices in a single staging pool. When all slices are in-flight, acquire requests return CG_NOT_READY.
+#define CG_MAX_STAGING_SLICES                    (256)
+
+/// @summary Define the maximum number of threads that can own a scratch arena within a single context. Threads beyond this limit allocate TEMP and KERNEL memory from the host allocator.
+#define CG_MAX_SCRATCH_ARENAS                    (64)
+
+/// @summary Define the size of each per-thread scratch arena, in bytes. Requests that do not fit are satisfied by the host allocator.
+#define CG_SCRATCH_ARENA_SIZE                    (256 * 1024)
+
+/// @summary Define the default alignment of scratch arena allocations, in bytes.
+#define CG_SCRATCH_ARENA_ALIGNMENT               (16)
+
+/// @summary Define the value of CG_SCRATCH_ARENA::TopBlock when the arena holds no blocks.
+#define CG_SCRATCH_NO_BLOCK                      (~size_t(0))
+
+/// @summary Define the initial value of a 64-bit FNV-1a hash.
+#define CG_FNV1A_64_SEED                         (0xCBF29CE484222325ULL)
+
+/// @summary Define the four-character code stored at the start of every on-disk kernel cache file ('CGKB').
+#define CG_KERNEL_CACHE_MAGIC                    (0x424B4743UL)
+
+/// @summary Define the version of the on-disk kernel cache file format. Files with a different version are ignored and overwritten.
+#define CG_KERNEL_CACHE_VERSION                  (1)
+
+/// @summary Define the maximum number of local work sizes timed when autotuning a compute pipeline for one problem-size class.
+#define CG_MAX_WORKGROUP_CANDIDATES              (12)
+
+/// @summary Define CG_LEAK_REPORT to 1 to write a list of objects and host allocations still alive to the debugger output when a context is destroyed.
+#ifndef CG_LEAK_REPORT
+#   ifdef _DEBUG
+#       define CG_LEAK_REPORT                    1
+#   else
+#       define CG_LEAK_REPORT                    0
+#   endif
+#endif
+
 /// @summary Define a helper macro to specify the correct value for the event wait list to OpenCL commands.
 /// OpenCL requires that if n == 0, the supplied cl_event* is NULL.
 #define CG_OPENCL_WAIT_LIST(n, arr)              (((n) > 0) ? (arr) : NULL)
@@ -158,6 +198,36 @@ struct CG_EXEC_GROUP;
 /// @summary Define the maximum number of displays that can be driven by a single GPU.
 #define CG_OPENGL_MAX_ATTACHED_DISPLAYS          (16)
 
+/// @summary Define the value of CG_DISPLAY::Ordinal for headless displays, which are not returned by EnumDisplayDevices.
+#define CG_OPENGL_HEADLESS_ORDINAL               (~DWORD(0))
+
+/// @summary Define the number of texture units whose bindings are tracked by the OpenGL state cache. Bindings on higher units are always issued.
+#define CG_OPENGL_MAX_CACHED_TEXTURE_UNITS       (32)
+
+/// @summary Define the number of uniform buffer binding points whose ranges are tracked by the OpenGL state cache. Bindings on higher points are always issued.
+#define CG_OPENGL_MAX_CACHED_UNIFORM_BUFFERS     (16)
+
+/// @summary Define the value stored in the OpenGL state cache for an object binding whose current value is not known.
+#define CG_OPENGL_STATE_UNKNOWN                  (0xFFFFFFFFU)
+
+/// @summary Define the size of the ring buffer used to stream uniform block data for a rendering context, in bytes.
+#define CG_OPENGL_UNIFORM_RING_SIZE              (4U * 1024U * 1024U)
+
+/// @summary Define the maximum number of graphics submissions whose uniform block data may be in flight. Writers wait for the oldest submission once the limit is reached.
+#define CG_OPENGL_UNIFORM_RING_MAX_FRAMES        (4)
+
+/// @summary Define the number of presented frames whose device completion can be tracked by a frame timer. Presentation waits for the oldest frame once the limit is reached.
+#define CG_OPENGL_FRAME_MAX_IN_FLIGHT            (8)
+
+/// @summary Define the number of completed frames retained by a frame timer for percentile queries. Must be a power of two.
+#define CG_OPENGL_FRAME_HISTORY_SIZE             (256)
+
+/// @summary Define the number of frames between re-synchronizations of the OpenGL timestamp clock with the host high-resolution timer.
+#define CG_OPENGL_FRAME_CLOCK_RESYNC             (256)
+
+/// @summary Define the version of the reflection data layout stored with cached program binaries. Increment when CG_GLSL_PROGRAM changes.
+#define CG_GLSL_BINARY_VERSION                   (2U)
+
 /// @summary Defines the maximum number of shader stages. OpenGL 3.2+ has
 /// stages GL_VERTEX_SHADER, GL_GEOMETRY_SHADER and GL_FRAGMENT_SHADER.
 #define CG_OPENGL_MAX_SHADER_STAGES_32           (3U)
@@ -244,6 +314,45 @@ typedef int  (CG_API *cgPipelineExecute_fn)(CG_CONTEXT *, CG_QUEUE *, CG_CMD_BUF
 /*//////////////////
 //   Data Types   //
 //////////////////*/
+/// @summary Defines the header stored immediately before each block allocated from a scratch arena.
+/// The headers form a stack through the arena, so blocks freed out of order are reclaimed once every block above them has been freed.
+struct CG_SCRATCH_HEADER
+{
+    size_t                       PrevOffset;           /// The value of CG_SCRATCH_ARENA::NextOffset before the block was allocated.
+    size_t                       PrevBlock;            /// The offset of the block below this one, or CG_SCRATCH_NO_BLOCK.
+    LONG volatile                Freed;                /// Non-zero if the block has been released. Other threads set this with an interlocked store.
+};
+
+/// @summary Defines the state associated with a linear scratch memory arena owned by a single thread.
+/// TEMP and KERNEL allocations are carved off the front of the arena. A freed block is reclaimed as soon as it and every block above it have been freed, 
+/// and any blocks remaining at the end of a scratch scope are reclaimed in bulk. The only scratch scope is the one around each command buffer submission 
+/// in cgExecuteCommandBuffer, so a TEMP or KERNEL allocation made during a submission must be freed before the submission returns; debug builds assert this.
+/// The arena is released when its owning thread exits.
+struct CG_SCRATCH_ARENA
+{
+    LONG volatile                OwnerThread;          /// The operating system identifier of the thread that owns the arena, or 0 if the arena is unclaimed.
+    CG_HOST_ALLOCATOR           *Host;                 /// The host allocator that supplied BaseAddress, used to release the arena when the owning thread exits.
+    uint8_t                     *BaseAddress;          /// The base address of the arena memory block, or NULL if the block could not be allocated.
+    size_t                       ArenaSize;            /// The size of the arena memory block, in bytes.
+    size_t                       NextOffset;           /// The byte offset of the next allocation from the start of the arena.
+    size_t                       TopBlock;             /// The byte offset of the most recently allocated block still in the arena, or CG_SCRATCH_NO_BLOCK.
+    size_t                       HighWaterMark;        /// The largest value NextOffset has reached.
+    uint64_t                     AllocationCount;      /// The number of allocations satisfied from the arena.
+    uint64_t                     OverflowCount;        /// The number of allocations that did not fit and were satisfied by the host allocator.
+};
+
+/// @summary Defines the host memory allocation counters maintained for a single allocation type. Counters are updated with interlocked operations.
+struct CG_ALLOCATION_COUNTERS
+{
+    LONGLONG volatile            LiveBytes;            /// The number of bytes currently allocated.
+    LONGLONG volatile            PeakBytes;            /// The largest value LiveBytes has reached.
+    LONGLONG volatile            LiveCount;            /// The number of allocations not yet released.
+    LONGLONG volatile            AllocationCount;      /// The total number of allocations.
+    LONGLONG volatile            AllocatedBytes;       /// The total number of bytes allocated.
+    LONGLONG                     FrameBase;            /// The value of AllocationCount at the start of the most recent submission.
+    LONGLONG                     FrameAllocations;     /// The number of allocations made between the two most recent submissions.
+};
+
 /// @summary Defines the state data associated with a host memory allocator implementation.
 struct CG_HOST_ALLOCATOR
 {
@@ -251,8 +360,11 @@ struct CG_HOST_ALLOCATOR
     cgMemoryFree_fn              Release;              /// The host memory free callback.
     uintptr_t                    UserData;             /// Opaque user data to pass through to Allocate and Release.
     bool                         Initialized;          /// true if the allocator has been initialized.
+    CG_SCRATCH_ARENA            *ScratchArenas;        /// The set of CG_MAX_SCRATCH_ARENAS per-thread arenas used for TEMP and KERNEL allocations, or NULL.
+    CG_ALLOCATION_COUNTERS      *Counters;             /// The set of CG_MAX_ALLOCATION_TYPES counters indexed by allocation type, or NULL.
+    DWORD                        ScratchFlsIndex;      /// The fiber-local storage index whose destructor releases a thread's scratch arena, or FLS_OUT_OF_INDEXES.
 };
-#define CG_HOST_ALLOCATOR_STATIC_INIT    {NULL, NULL, 0, false}
+#define CG_HOST_ALLOCATOR_STATIC_INIT    {NULL, NULL, 0, false, NULL, NULL, FLS_OUT_OF_INDEXES}
 
 /// @summary Describes the location of an object within an object table.
 struct CG_OBJECT_INDEX
@@ -275,6 +387,9 @@ struct CG_OBJECT_TABLE
     static uint32_t const        NEW_OBJECT_ID_ADD       = N;
 
     size_t                       ObjectCount;          /// The number of live objects in the table.
+    size_t                       PeakCount;            /// The largest value ObjectCount has reached.
+    uint64_t                     CreateCount;          /// The total number of objects added to the table.
+    uint64_t                     DeleteCount;          /// The total number of objects removed from the table.
     uint16_t                     FreeListTail;         /// The index of the most recently freed item.
     uint16_t                     FreeListHead;         /// The index of the next available item.
     uint32_t                     ObjectType;           /// One of cg_object_e specifying the type of object in this table.
@@ -352,6 +467,7 @@ struct CG_DEVICE
     cl_device_id                 DeviceId;             /// The OpenCL device identifier, which may or may not be the same as the MasterDeviceId.
     cl_device_id                 MasterDeviceId;       /// The OpenCL device identifier of the parent device.
     cl_device_type               Type;                 /// The OpenCL device type (CPU, GPU, ACCELERATOR or CUSTOM.)
+    uint32_t                     NUMANode;             /// The NUMA node the device's compute units are restricted to, or CG_NUMA_NODE_ANY.
 
     char                        *Name;                 /// The friendly name of the device.
     char                        *Platform;             /// The friendly name of the platform.
@@ -368,6 +484,173 @@ struct CG_DEVICE
     #undef  AD
 };
 
+/// @summary Describes fixed-function state configuration for the blending unit.
+struct CG_BLEND_STATE
+{
+    GLboolean                    BlendEnabled;         /// GL_TRUE if alpha blending is enabled.
+    GLenum                       SrcBlendColor;        /// The source component of the blending equation for color channels.
+    GLenum                       DstBlendColor;        /// The destination component of the blending equation for color channels.
+    GLenum                       ColorBlendFunction;   /// The blending function to use for the color channels.
+    GLenum                       SrcBlendAlpha;        /// The source component of the blending equation for alpha.
+    GLenum                       DstBlendAlpha;        /// The destination component of the blending equation for alpha.
+    GLenum                       AlphaBlendFunction;   /// The blending function to use for the alpha channel.
+    GLfloat                      ConstantRGBA[4];      /// RGBA values in [0, 1] specifying a constant blend color.
+};
+
+/// @summary Describes fixed-function state configuration for the rasterizer.
+struct CG_RASTER_STATE
+{
+    GLenum                       FillMode;             /// The primitive fill mode.
+    GLenum                       CullMode;             /// The primitive culling mode.
+    GLenum                       FrontFace;            /// The winding order used to determine front-facing primitives.
+    GLint                        DepthBias;            /// The depth bias value added to fragment depth.
+    GLfloat                      SlopeScaledDepthBias; /// The scale of the slope-based value added to fragment depth.
+};
+
+/// @summary Describes fixed-function state configuration for depth and stencil testing.
+struct CG_DEPTH_STENCIL_STATE
+{
+    GLboolean                    DepthTestEnable;      /// GL_TRUE if depth testing is enabled.
+    GLboolean                    DepthWriteEnable;     /// GL_TRUE if depth buffer writes are enabled.
+    GLboolean                    DepthBoundsEnable;    /// GL_TRUE if the depth buffer range is enabled.
+    GLenum                       DepthTestFunction;    /// The depth value comparison function.
+    GLfloat                      DepthMin;             /// The minimum depth buffer value.
+    GLfloat                      DepthMax;             /// The maximum depth buffer value.
+    GLboolean                    StencilTestEnable;    /// GL_TRUE if stencil testing is enabled.
+    GLenum                       StencilTestFunction;  /// The stencil value comparison function.
+    GLenum                       StencilFailOp;        /// The stencil operation to apply when the stencil test fails.
+    GLenum                       StencilPassZPassOp;   /// The stencil operation to apply when both the stencil and depth tests pass.
+    GLenum                       StencilPassZFailOp;   /// The stencil operation to apply when the stencil test passes and the depth test fails.
+    GLubyte                      StencilReadMask;      /// The bitmask to apply to stencil reads.
+    GLubyte                      StencilWriteMask;     /// The bitmask to apply to stencil writes.
+    GLubyte                      StencilReference;     /// The stencil reference value.
+};
+
+/// @summary Define the shadow copy of the OpenGL binding and fixed-function state of a rendering context. Graphics 
+/// pipeline callbacks change state through the cgGl* state functions, which skip calls that would not change the 
+/// current value. Displays driven by the same device share a rendering context, and so share a state cache.
+struct CG_GL_STATE_CACHE
+{
+    #define TU                   CG_OPENGL_MAX_CACHED_TEXTURE_UNITS
+    #define UB                   CG_OPENGL_MAX_CACHED_UNIFORM_BUFFERS
+    GLuint                       Program;              /// The current program object, or CG_OPENGL_STATE_UNKNOWN.
+    GLuint                       VertexArray;          /// The current vertex array object, or CG_OPENGL_STATE_UNKNOWN.
+    GLuint                       ActiveTexture;        /// The zero-based index of the active texture unit, or CG_OPENGL_STATE_UNKNOWN.
+    GLenum                       TextureTargets[TU];   /// The target of the most recent texture binding on each texture unit.
+    GLuint                       Textures[TU];         /// The texture most recently bound on each texture unit, or CG_OPENGL_STATE_UNKNOWN.
+    GLuint                       Samplers[TU];         /// The sampler object bound to each texture unit, or CG_OPENGL_STATE_UNKNOWN.
+    GLuint                       DrawIndirectBuffer;   /// The buffer bound to GL_DRAW_INDIRECT_BUFFER, or CG_OPENGL_STATE_UNKNOWN.
+    GLuint                       ParameterBuffer;      /// The buffer bound to GL_PARAMETER_BUFFER_ARB, or CG_OPENGL_STATE_UNKNOWN.
+    GLuint                       DrawFramebuffer;      /// The framebuffer bound to GL_DRAW_FRAMEBUFFER, or CG_OPENGL_STATE_UNKNOWN.
+    GLuint                       TargetFramebuffer;    /// The framebuffer object used to render into images, created on first use, or 0.
+    GLuint                       ColorAttachment;      /// The texture attached to GL_COLOR_ATTACHMENT0 of TargetFramebuffer, or 0.
+    GLuint                       DepthAttachment;      /// The texture attached to the depth or depth-stencil attachment of TargetFramebuffer, or 0.
+    GLenum                       DepthAttachPoint;     /// The attachment point of DepthAttachment, GL_DEPTH_ATTACHMENT or GL_DEPTH_STENCIL_ATTACHMENT.
+    GLint                        AttachmentLevel;      /// The mipmap level of the attached textures.
+    GLuint                       ReadFramebuffer;      /// The framebuffer bound to GL_READ_FRAMEBUFFER, or CG_OPENGL_STATE_UNKNOWN.
+    GLuint                       SourceFramebuffer;    /// The framebuffer object used to read from images, created on first use, or 0.
+    GLuint                       SourceAttachment;     /// The texture attached to GL_COLOR_ATTACHMENT0 of SourceFramebuffer, or 0.
+    GLint                        SourceLevel;          /// The mipmap level of SourceAttachment.
+    GLuint                       UniformBuffers[UB];   /// The buffer bound to each uniform buffer binding point, or CG_OPENGL_STATE_UNKNOWN.
+    GLintptr                     UniformOffsets[UB];   /// The byte offset of the range bound to each uniform buffer binding point.
+    GLsizeiptr                   UniformSizes[UB];     /// The size of the range bound to each uniform buffer binding point, in bytes.
+    GLint                        Viewport[4];          /// The current viewport rectangle, valid if ViewportValid is true.
+    GLenum                       CullFace;             /// The face selected by glCullFace, or GL_NONE if not known.
+    bool                         ViewportValid;        /// true if Viewport matches the rendering context.
+    bool                         BlendValid;           /// true if BlendState matches the rendering context.
+    bool                         RasterValid;          /// true if RasterState matches the rendering context.
+    bool                         DepthStencilValid;    /// true if DepthStencilState matches the rendering context.
+    CG_BLEND_STATE               BlendState;           /// The current blending unit state.
+    CG_RASTER_STATE              RasterState;          /// The current rasterizer state.
+    CG_DEPTH_STENCIL_STATE       DepthStencilState;    /// The current depth and stencil testing state.
+    uint64_t                     CallsIssued;          /// The number of state-changing OpenGL calls made through the cache.
+    uint64_t                     CallsElided;          /// The number of state-changing OpenGL calls skipped because the state was already current.
+    uint64_t                     FrameBaseIssued;      /// The value of CallsIssued at the start of the most recent graphics submission.
+    uint64_t                     FrameBaseElided;      /// The value of CallsElided at the start of the most recent graphics submission.
+    uint64_t                     FrameCallsIssued;     /// The number of calls issued between the two most recent graphics submissions.
+    uint64_t                     FrameCallsElided;     /// The number of calls elided between the two most recent graphics submissions.
+    #undef  UB
+    #undef  TU
+};
+
+/// @summary Define the bookkeeping for one graphics submission whose uniform block data may still be read by the device.
+struct CG_GL_UNIFORM_RING_FRAME
+{
+    GLsync                       Fence;                /// The fence inserted after the last command of the submission.
+    size_t                       Bytes;                /// The number of bytes, including wrap padding, allocated during the submission.
+};
+
+/// @summary Define the state of the ring buffer used to stream uniform block data for a rendering context. Data is written 
+/// once per draw into the ring and bound with glBindBufferRange. Space is recycled once the fence of the submission that 
+/// wrote it has signaled, so an allocation is only valid for the submission in which it was made.
+struct CG_GL_UNIFORM_RING
+{
+    #define MF                   CG_OPENGL_UNIFORM_RING_MAX_FRAMES
+    GLuint                       Buffer;               /// The OpenGL buffer object, or 0 if the ring has not been created.
+    uint8_t                     *HostAddress;          /// The persistently mapped buffer address, or NULL if data is written with glBufferSubData.
+    size_t                       Size;                 /// The size of the ring, in bytes.
+    size_t                       Alignment;            /// The value of GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.
+    size_t                       Head;                 /// The byte offset at which the next allocation starts.
+    size_t                       Used;                 /// The number of bytes, including wrap padding, that may still be read by the device.
+    size_t                       FrameBytes;           /// The number of bytes allocated since the most recent submission boundary.
+    size_t                       FrameFirst;           /// The index in Frames of the oldest submission in flight.
+    size_t                       FrameCount;           /// The number of submissions in flight.
+    uint64_t                     FrameIndex;           /// The number of submission boundaries seen, used to detect stale allocations.
+    uint64_t                     BytesWritten;         /// The total number of bytes of uniform data written to the ring.
+    uint64_t                     WaitCount;            /// The number of times a writer had to wait for the device to release ring space.
+    CG_GL_UNIFORM_RING_FRAME     Frames[MF];           /// The submissions in flight, stored as a circular queue.
+    #undef  MF
+};
+
+/// @summary Define the timing information recorded for a single presented frame. All times are host high-resolution timer values, in ticks.
+struct CG_GL_FRAME_RECORD
+{
+    uint64_t                     FrameIndex;           /// The zero-based index of the frame among all frames presented through the timer.
+    int64_t                      InputTime;            /// The time of the oldest input sample consumed by the frame, or 0 if no input was marked.
+    int64_t                      SubmitTime;           /// The time at which the host finished submitting the frame and requested presentation.
+    int64_t                      PresentTime;          /// The time at which the swap call returned.
+    int64_t                      CompleteTime;         /// The time at which the device finished rendering the frame.
+    int64_t                      FrameTicks;           /// The time between the present of the previous frame and the present of this frame, or 0 for the first frame.
+};
+
+/// @summary Define one entry in the frame history ring. Sequence is set to ~0 while Record is being written and to the 
+/// index of the record once it is complete, so readers on other threads can detect and skip torn entries.
+struct CG_GL_FRAME_SLOT
+{
+    std::atomic<uint64_t>        Sequence;             /// The history index of the record stored in the slot, or ~0 while the slot is being written.
+    CG_GL_FRAME_RECORD           Record;               /// The timing information for the frame.
+};
+
+/// @summary Define the frame pacing and latency state for a display. Frames are tracked by cgPresentDisplayEXT until 
+/// the device finishes them, then published to a history ring that cgGetFrameStatsEXT reads without taking a lock. 
+/// The pending frames and the OpenGL objects are accessed only by the thread that owns the rendering context.
+struct CG_GL_FRAME_TIMER
+{
+    #define MF                   CG_OPENGL_FRAME_MAX_IN_FLIGHT
+    #define HS                   CG_OPENGL_FRAME_HISTORY_SIZE
+    int64_t                      Frequency;            /// The frequency of the host high-resolution timer, in ticks-per-second.
+    size_t                       MaxFramesInFlight;    /// The maximum number of unfinished frames when cgPresentDisplayEXT returns, or 0 for no limit.
+    bool                         TimerQuery;           /// true if device completion times come from GL_TIMESTAMP queries rather than fence polling.
+    int64_t                      ClockBaseGPU;         /// The OpenGL timestamp, in nanoseconds, sampled at the most recent clock synchronization.
+    int64_t                      ClockBaseCPU;         /// The host timer value, in ticks, sampled at the most recent clock synchronization.
+    int64_t                      LastPresent;          /// The present time of the most recent frame, or 0 if no frame has been presented.
+    uint64_t                     FrameIndex;           /// The number of frames presented through the timer.
+    size_t                       PendingFirst;         /// The index in Pending of the oldest frame in flight.
+    size_t                       PendingCount;         /// The number of frames in flight.
+    GLsync                       PendingFence[MF];     /// The fence inserted after the last command of each frame in flight.
+    GLuint                       PendingQuery[MF];     /// The GL_TIMESTAMP query object used for each pending slot, or 0 if not yet created.
+    CG_GL_FRAME_RECORD           Pending[MF];          /// The frames in flight, stored as a circular queue.
+    std::atomic<int64_t>         InputTime;            /// The time of the oldest input sample not yet consumed by a frame, or 0.
+    std::atomic<uint64_t>        PresentCount;         /// The number of frames presented, readable from any thread.
+    std::atomic<uint64_t>        WaitCount;            /// The number of times presentation waited for the device to honor the in-flight limit.
+    std::atomic<size_t>          InFlight;             /// The number of frames in flight when the most recent present returned.
+    cacheline_t                  Pad0;                 /// Padding separating the writer-only data from the history ring.
+    std::atomic<uint64_t>        HistoryCount;         /// The number of records published to the history ring.
+    CG_GL_FRAME_SLOT             History[HS];          /// The most recently completed frames, indexed by history index modulo CG_OPENGL_FRAME_HISTORY_SIZE.
+    #undef  HS
+    #undef  MF
+};
+
 /// @summary Define the state associated with an OpenGL 3.2 compatible display.
 struct CG_DISPLAY
 {
@@ -377,6 +660,7 @@ struct CG_DISPLAY
     HWND                         DisplayHWND;          /// The hidden fullscreen window used to retrieve the display device context.
     HDC                          DisplayDC;            /// The Windows GDI device context for the hidden fullscreen window.
     HGLRC                        DisplayRC;            /// The OpenGL rendering context for the device driving the display.
+    bool                         Headless;             /// true if the display has no monitor and renders only into images. See CG_EXECUTION_GROUP_OFFSCREEN.
     int                          DisplayX;             /// The x-coordinate of the upper-left corner of the display.
     int                          DisplayY;             /// The y-coordinate of the upper-left corner of the display.
     size_t                       DisplayWidth;         /// The width of the display, in pixels.
@@ -385,6 +669,53 @@ struct CG_DISPLAY
     DEVMODE                      DisplayMode;          /// Information about the current display mode, orientation and geometry.
     GLEWContext                  GLEW;                 /// OpenGL extension function pointers for the attached displays.
     WGLEWContext                 WGLEW;                /// OpenGL windowing extension function pointers for the attached displays.
+    CG_GL_STATE_CACHE           *GLState;              /// The state cache for the rendering context, which may be owned by another display on the same device.
+    CG_GL_STATE_CACHE            GLStateStorage;       /// The state cache storage used when this display created the rendering context.
+    CG_GL_UNIFORM_RING          *UniformRing;          /// The uniform streaming ring for the rendering context, which may be owned by another display on the same device.
+    CG_GL_UNIFORM_RING           UniformRingStorage;   /// The uniform ring storage used when this display created the rendering context.
+    CG_GL_FRAME_TIMER           *FrameTimer;           /// The frame pacing and latency state, created on first use by the display extension, or NULL.
+};
+
+/// @summary Define the state associated with a single sub-allocation from a staging pool.
+struct CG_STAGING_SLICE
+{
+    enum state_e : uint32_t
+    {
+        ACTIVE                   = 0,                  /// The slice is held by the application.
+        RELEASED                 = 1,                  /// The slice has been released and can be recycled once RetireEvent is signaled.
+    };
+
+    uint32_t                     State;                /// One of CG_STAGING_SLICE::state_e.
+    size_t                       Offset;               /// The byte offset of the start of the slice within the staging arena.
+    size_t                       Size;                 /// The size of the slice, in bytes, including alignment padding.
+    cl_event                     RetireEvent;          /// The OpenCL event signaled when the device is done with the slice, or NULL.
+};
+
+/// @summary Define the state associated with a pinned staging arena. The arena is allocated once and 
+/// persistently mapped; transient data buffers are sub-allocated from it in FIFO order and recycled as 
+/// the transfers that reference them retire. Each execution group has its own pool on a heap, since a 
+/// sub-buffer must belong to the same OpenCL context as its parent. The slice ring, the cursors and the 
+/// buffer count may be accessed from any thread and are protected by Lock. When the owning execution 
+/// group is deleted the pool is detached from its heap, and freed once the last staging buffer is deleted.
+struct CG_STAGING_POOL
+{
+    SRWLOCK                      Lock;                 /// Protects all fields below ArenaSize.
+    CG_HEAP                     *Heap;                 /// The heap whose pinnable memory holds the arena.
+    CG_STAGING_POOL             *Next;                 /// The next pool on the same heap, owned by another execution group, or NULL.
+    cl_context                   ComputeContext;       /// The OpenCL context of the execution group that owns the arena.
+    cl_command_queue             MapQueue;             /// The command queue used to map and unmap the arena. A reference is held by the pool.
+    cl_mem                       ArenaBuffer;          /// The OpenCL buffer object allocated with CL_MEM_ALLOC_HOST_PTR.
+    uint8_t                     *HostAddress;          /// The host-visible address of the start of the mapped arena.
+    size_t                       ArenaSize;            /// The total size of the arena, in bytes.
+    size_t                       Alignment;            /// The required alignment of each sub-buffer origin, in bytes.
+    size_t                       ReadOffset;           /// The byte offset of the oldest outstanding slice.
+    size_t                       WriteOffset;          /// The byte offset at which the next slice will be allocated.
+    size_t                       BytesUsed;            /// The number of bytes held by outstanding slices.
+    size_t                       SliceHead;            /// The index of the oldest outstanding slice.
+    size_t                       SliceCount;           /// The number of outstanding slices.
+    size_t                       LiveBuffers;          /// The number of staging buffer objects that reference the pool.
+    bool                         Detached;             /// true once the owning execution group has been deleted.
+    CG_STAGING_SLICE             Slices[CG_MAX_STAGING_SLICES]; /// The ring of outstanding slice descriptors.
 };
 
 /// @summary Define the state associated with a device memory heap.
@@ -398,10 +729,14 @@ struct CG_HEAP
     cl_ulong                     HeapSizeTotal;        /// The total size of the heap, in bytes.
     cl_ulong                     HeapSizeUsed;         /// An estimate of the number of bytes allocated from the heap.
     cl_ulong                     PinnableTotal;        /// The number of bytes of pinnable memory.
-    cl_ulong                     PinnableUsed;         /// An estimate of the number of bytes of pinnable memory allocated from the heap.
+    cl_ulong                     PinnableUsed;         /// An estimate of the number of bytes of pinnable memory allocated from the heap. Guarded by PinnableLock.
+    SRWLOCK                      PinnableLock;         /// Guards PinnableUsed, which is also updated when a staging pool is freed by the thread releasing its last staging buffer.
     size_t                       DeviceAlignment;      /// The allocation alignment for device-allocated memory.
     size_t                       UserAlignment;        /// The allocation alignment for user-allocated memory.
     size_t                       UserSizeAlign;        /// The allocation size multiple for user-allocated memory.
+    CG_STAGING_POOL             *StagingPool;          /// The list of pinned staging pools on the heap, one per execution group, or NULL.
+    cl_ulong                     ResidencyBudget;      /// The maximum number of bytes of device-resident objects before eviction begins, or 0 if eviction is disabled.
+    uint32_t                     NUMANode;             /// The NUMA node on which host memory for the heap is committed, or CG_NUMA_NODE_ANY.
 };
 
 /// @summary Define the data used to identify a device queue. The queue may be used for compute, graphics, or data transfer.
@@ -418,6 +753,13 @@ struct CG_QUEUE
     HGLRC                        DisplayRC;            /// The Windows OpenGL rendering context for GRAPHICS queues. NULL for COMPUTE and TRANSFER queues.
 };
 
+/// @summary Associates a sort key with the location of a single command in a command buffer.
+struct CG_CMD_SORT_ENTRY
+{
+    uint64_t                     SortKey;              /// The sort key assigned to the command when it was recorded.
+    size_t                       Offset;               /// The byte offset of the command from the start of the command data.
+};
+
 /// @summary Define the data representing a command buffer, which is a set of commands and associated data that can be submitted to a queue.
 /// Command buffers can be cached and re-used or re-submitted.
 struct CG_CMD_BUFFER
@@ -426,6 +768,7 @@ struct CG_CMD_BUFFER
     static size_t   const        CMD_HEADER_SIZE         = sizeof(uint32_t); // 4 bytes
     static size_t   const        MAX_CMD_SIZE            = 64 * 1024;        // 64KB
     static size_t   const        MAX_SIZE                = 16 * 1024 * 1024; // 16MB
+    static size_t   const        MAX_SORT_SIZE           = (MAX_SIZE / CMD_HEADER_SIZE) * sizeof(CG_CMD_SORT_ENTRY);
     static uint32_t const        STATE_MASK_P            = 0x00FFFFFF;
     static uint32_t const        STATE_MASK_U            = 0x00FFFFFF;
     static uint32_t const        STATE_SHIFT             = 0;
@@ -448,6 +791,10 @@ struct CG_CMD_BUFFER
     size_t                       BytesUsed;            /// The number of bytes actually used for command data.
     size_t                       CommandCount;         /// The number of buffered commands.
     uint8_t                     *CommandData;          /// The start of the command data buffer.
+    uint32_t                     Flags;                /// One or more of cg_command_buffer_flags_e specified when recording began.
+    uint64_t                     SortKey;              /// The sort key assigned to each appended command, if CG_COMMAND_BUFFER_FLAG_SORT_BY_KEY is set.
+    size_t                       SortBytesTotal;       /// The number of bytes committed for the sort entry list.
+    CG_CMD_SORT_ENTRY           *SortEntries;          /// CommandCount sort entries, or NULL if sorting has never been enabled for the buffer.
 };
 
 // the command buffer maintains a list of memory object references and increments reference counts. 
@@ -489,48 +836,9 @@ struct CG_KERNEL
     CG_DISPLAY                  *AttachedDisplay;      /// The display associated with the OpenGL rendering context.
     HGLRC                        RenderingContext;     /// The OpenGL rendering context for graphics kernels, or NULL.
     GLuint                       GraphicsShader;       /// The OpenGL shader object name for graphics kernels, or 0.
-};
-
-/// @summary Describes fixed-function state configuration for the blending unit.
-struct CG_BLEND_STATE
-{
-    GLboolean                    BlendEnabled;         /// GL_TRUE if alpha blending is enabled.
-    GLenum                       SrcBlendColor;        /// The source component of the blending equation for color channels.
-    GLenum                       DstBlendColor;        /// The destination component of the blending equation for color channels.
-    GLenum                       ColorBlendFunction;   /// The blending function to use for the color channels.
-    GLenum                       SrcBlendAlpha;        /// The source component of the blending equation for alpha.
-    GLenum                       DstBlendAlpha;        /// The destination component of the blending equation for alpha.
-    GLenum                       AlphaBlendFunction;   /// The blending function to use for the alpha channel.
-    GLfloat                      ConstantRGBA[4];      /// RGBA values in [0, 1] specifying a constant blend color.
-};
-
-/// @summary Describes fixed-function state configuration for the rasterizer.
-struct CG_RASTER_STATE
-{
-    GLenum                       FillMode;             /// The primitive fill mode.
-    GLenum                       CullMode;             /// The primitive culling mode.
-    GLenum                       FrontFace;            /// The winding order used to determine front-facing primitives.
-    GLint                        DepthBias;            /// The depth bias value added to fragment depth.
-    GLfloat                      SlopeScaledDepthBias; /// The scale of the slope-based value added to fragment depth.
-};
-
-/// @summary Describes fixed-function state configuration for depth and stencil testing.
-struct CG_DEPTH_STENCIL_STATE
-{
-    GLboolean                    DepthTestEnable;      /// GL_TRUE if depth testing is enabled.
-    GLboolean                    DepthWriteEnable;     /// GL_TRUE if depth buffer writes are enabled.
-    GLboolean                    DepthBoundsEnable;    /// GL_TRUE if the depth buffer range is enabled.
-    GLenum                       DepthTestFunction;    /// The depth value comparison function.
-    GLfloat                      DepthMin;             /// The minimum depth buffer value.
-    GLfloat                      DepthMax;             /// The maximum depth buffer value.
-    GLboolean                    StencilTestEnable;    /// GL_TRUE if stencil testing is enabled.
-    GLenum                       StencilTestFunction;  /// The stencil value comparison function.
-    GLenum                       StencilFailOp;        /// The stencil operation to apply when the stencil test fails.
-    GLenum                       StencilPassZPassOp;   /// The stencil operation to apply when both the stencil and depth tests pass.
-    GLenum                       StencilPassZFailOp;   /// The stencil operation to apply when the stencil test passes and the depth test fails.
-    GLubyte                      StencilReadMask;      /// The bitmask to apply to stencil reads.
-    GLubyte                      StencilWriteMask;     /// The bitmask to apply to stencil writes.
-    GLubyte                      StencilReference;     /// The stencil reference value.
+    uint64_t                     SourceHash;           /// A hash of the code the kernel was created from, used to key cached pipeline programs.
+    int                          BuildStatus;          /// CG_SUCCESS, CG_NOT_READY while an asynchronous build is in progress, or the reason the build failed.
+    CG_KERNEL_BUILD             *AsyncBuild;           /// State shared with the thread pool while an asynchronous build is in progress, or NULL.
 };
 
 /// @summary Describes a GLSL vertex attribute value within a pipeline.
@@ -552,22 +860,35 @@ struct CG_GLSL_SAMPLER
     GLint                        ImageUnit;            /// The assigned texture image unit.
 };
 
-/// @summary Describes a GLSL uniform value within a pipeline.
+/// @summary Describes a GLSL uniform value within a pipeline. Members of a uniform block have no location; their 
+/// values are supplied through a buffer bound to the block, at DataOffset bytes from the start of the block.
 struct CG_GLSL_UNIFORM
 {
     GLenum                       DataType;             /// The data type, for example, GL_FLOAT.
-    GLint                        Location;             /// The assigned location within the program.
+    GLint                        Location;             /// The assigned location within the program, or -1 for uniform block members.
+    GLint                        BlockIndex;           /// The index of the containing uniform block, or -1 for the default block.
     size_t                       DataSize;             /// The size of the attribute data, in bytes.
-    size_t                       DataOffset;           /// The byte offset of the attribute data.
+    size_t                       DataOffset;           /// The byte offset of the attribute data. For block members, the offset within the block.
     GLsizei                      Dimension;            /// The data dimension for array types.
 };
 
+/// @summary Describes a GLSL uniform block within a pipeline. The index of the block in CG_GLSL_PROGRAM::UniformBlocks 
+/// is the uniform block index assigned by the linker.
+struct CG_GLSL_UNIFORM_BLOCK
+{
+    GLuint                       Binding;              /// The uniform buffer binding point assigned to the block.
+    size_t                       DataSize;             /// The minimum size of the buffer range bound to the block, in bytes.
+};
+
 /// @summary Represents a GLSL program object post-linking, including reflection data.
 struct CG_GLSL_PROGRAM
 {
     size_t                       UniformCount;         /// The number of active GLSL uniforms.
     uint32_t                    *UniformNames;         /// Hashed names of the active GLSL uniforms.
     CG_GLSL_UNIFORM             *Uniforms;             /// Information about active GLSL uniforms.
+    size_t                       UniformBlockCount;    /// The number of active GLSL uniform blocks.
+    uint32_t                    *UniformBlockNames;    /// Hashed names of the active GLSL uniform blocks.
+    CG_GLSL_UNIFORM_BLOCK       *UniformBlocks;        /// Information about active GLSL uniform blocks.
     size_t                       AttributeCount;       /// The number of active vertex attributes.
     uint32_t                    *AttributeNames;       /// Hashed names of the active vertex attributes.
     CG_GLSL_ATTRIBUTE           *Attributes;           /// Information about active vertex attributes.
@@ -609,6 +930,41 @@ struct CG_COMPUTE_PIPELINE
     size_t                       ArgumentCount;        /// The number of kernel arguments.
     uint32_t                    *ArgumentNames;        /// Hashed names of kernel arguments. Local.
     CG_CL_KERNEL_ARG            *Arguments;            /// Information about kernel arguments. Local.
+
+    int                          BuildStatus;          /// CG_SUCCESS, CG_NOT_READY while the kernel program is still building, or the reason creation failed.
+    cg_handle_t                  KernelProgram;        /// The handle of the kernel object the pipeline was created from.
+    char                        *KernelName;           /// The kernel function name, used to build the kernel once the program is ready and to match identical create calls. Local.
+    size_t                       KernelNameSize;       /// The number of bytes allocated for KernelName, including the terminator.
+
+    bool                         AutoTune;             /// true if dispatches without an explicit local size should autotune the work group size.
+    uint64_t                     TuningKey;            /// A hash of the kernel source and function name, used to persist tuning results.
+    size_t                       TuningCount;          /// The number of valid entries in Tuning.
+    size_t                       TuningCapacity;       /// The number of entries allocated for Tuning.
+    CG_CL_WORKGROUP_TUNING      *Tuning;               /// Work group size tuning state for each device and problem-size class. Local.
+    CG_CL_DEVICE_THROUGHPUT     *Throughput;           /// The measured throughput on each device for split dispatches, or NULL. Local.
+};
+
+/// @summary Describes the state of work group size autotuning for one device and problem-size class of a compute pipeline.
+/// Each candidate local size is timed on a real dispatch using the profiling event of the kernel command.
+struct CG_CL_WORKGROUP_TUNING
+{
+    uint32_t                     SizeClass;            /// The problem-size class; see cgWorkGroupSizeClass.
+    uint32_t                     DeviceIndex;          /// The zero-based index of the device within the pipeline's device list.
+    bool                         Tuned;                /// true once BestSize has been selected.
+    uint32_t                     CandidateCount;       /// The number of valid entries in Candidates.
+    uint32_t                     CandidateIndex;       /// The index of the next candidate to time.
+    cl_event                     PendingEvent;         /// The profiling event of the dispatch timing Candidates[CandidateIndex], or NULL.
+    size_t                       BestSize[3];          /// The selected local work size, valid when Tuned is true. 0, 0, 0 lets the runtime choose.
+    size_t                       Candidates[CG_MAX_WORKGROUP_CANDIDATES][3]; /// The candidate local work sizes.
+    cl_ulong                     Timings[CG_MAX_WORKGROUP_CANDIDATES];       /// The measured execution time of each candidate, in nanoseconds.
+};
+
+/// @summary Tracks the measured throughput of a compute pipeline on one device, used to balance dispatches split across an execution group.
+struct CG_CL_DEVICE_THROUGHPUT
+{
+    double                       ItemsPerNano;         /// The smoothed number of work items completed per nanosecond, or 0.0 if not yet measured.
+    cl_event                     PendingEvent;         /// The profiling event of the most recently sampled part, or NULL.
+    size_t                       PendingItems;         /// The number of work items in the part associated with PendingEvent.
 };
 
 /// @summary Defines the data associated with an execution-read graphics pipeline.
@@ -620,6 +976,9 @@ struct CG_GRAPHICS_PIPELINE
     GLenum                       Topology;             /// The primitive topology, for example, GL_TRIANGLES.
     CG_GLSL_PROGRAM              ShaderProgram;        /// The OpenGL program handle and reflection data.
     CG_DISPLAY                  *AttachedDisplay;      /// The display object associated with the OpenGL rendering context.
+    cg_handle_t                  VertexShader;         /// The handle of the vertex shader kernel the program was linked from.
+    cg_handle_t                  GeometryShader;       /// The handle of the geometry shader kernel the program was linked from, or CG_INVALID_HANDLE.
+    cg_handle_t                  FragmentShader;       /// The handle of the fragment shader kernel the program was linked from.
 
     size_t                       DeviceCount;          /// The number of devices the pipeline can execute on.
     CG_DEVICE                  **DeviceList;           /// The set of devices the pipeline can execute on. Reference to CG_EXEC_GROUP.
@@ -634,6 +993,10 @@ struct CG_PIPELINE
 {
     uint32_t                     ObjectId;             /// The CGFX internal object identifier.
     int                          PipelineType;         /// One of cg_pipeline_type_e specifying the type of pipeline data.
+    uint64_t                     ContentHash;          /// A hash of the pipeline description, used to return existing pipelines for identical descriptions.
+    cg_handle_t                  ExecGroup;            /// The handle of the execution group the pipeline was created for.
+    bool                         Shareable;            /// false once per-pipeline state such as autotuning has been changed, so later create calls get a new pipeline.
+    size_t                       ReferenceCount;       /// The number of outstanding create calls returning this pipeline; deleted when this reaches zero.
     void                        *PrivateState;         /// Opaque storage for data internal to the pipeline implementation.
     union
     {
@@ -660,6 +1023,11 @@ struct CG_BUFFER
     cg_handle_t                  ExecutionGroup;       /// The handle of the execution group that owns the buffer.
     GLuint                       GraphicsBuffer;       /// The handle of the OpenGL buffer object, or 0.
     GLenum                       GraphicsUsage;        /// The OpenGL buffer usage hints.
+    CG_STAGING_POOL             *StagingPool;          /// The staging pool the buffer was sub-allocated from, or NULL.
+    size_t                       StagingSlice;         /// The index of the slice within the staging pool, if StagingPool is not NULL.
+    uint64_t                     LastUseFrame;         /// The value of CG_CONTEXT::FrameIndex when the buffer was last referenced by a command or mapped.
+    LONG volatile                MapCount;             /// The number of host mappings not yet unmapped. A mapped buffer is never evicted or restored.
+    bool                         Evicted;              /// true if the buffer contents currently live in host-backed memory instead of device memory.
 };
 
 /// @summary Defines the data associated with an image object.
@@ -690,6 +1058,10 @@ struct CG_IMAGE
     GLenum                       BaseFormat;           /// The OpenGL base format identifier.
     GLenum                       DataType;             /// The OpenGL data type identifier.
     uint32_t                     DxgiFormat;           /// The DXGI pixel format identifier.
+    size_t                       AllocatedSize;        /// An estimate of the number of bytes allocated for the image.
+    uint64_t                     LastUseFrame;         /// The value of CG_CONTEXT::FrameIndex when the image was last referenced by a command or mapped.
+    LONG volatile                MapCount;             /// The number of host mappings not yet unmapped. A mapped image is never evicted or restored.
+    bool                         Evicted;              /// true if the image contents currently live in host-backed memory instead of device memory.
 };
 
 /// @summary Defines the data associated with an image sampler object.
@@ -733,15 +1105,34 @@ struct CG_VERTEX_ATTRIBUTE
     GLsizei                      Dimension;            /// The number of components in the vertex attribute, between 1 and 4.
     size_t                       ByteOffset;           /// The byte offset of the start of the first component from the start of the vertex.
     GLboolean                    Normalized;           /// GL_TRUE if the data is normalized; otherwise, GL_FALSE.
+    GLuint                       Divisor;              /// The number of instances drawn per attribute value, or 0 if the attribute advances per-vertex.
+};
+
+/// @summary Defines a vertex array object shared by all vertex data sources with the same vertex format on a rendering 
+/// context. The vertex array object stores only the attribute formats; each data source attaches its own buffers and 
+/// offsets with glBindVertexBuffer when it is bound. Requires OpenGL 4.3 or GL_ARB_vertex_attrib_binding.
+struct CG_VERTEX_LAYOUT
+{
+    CG_VERTEX_LAYOUT            *Next;                 /// The next shared layout in the list owned by the context.
+    uint64_t                     LayoutHash;           /// The hash of the attribute formats, buffer assignments and instance divisors.
+    HGLRC                        RenderingContext;     /// The OpenGL rendering context that owns the vertex array object.
+    GLuint                       VertexArray;          /// The OpenGL vertex array object storing the vertex format.
+    size_t                       ReferenceCount;       /// The number of vertex data sources using the layout.
+    uint32_t                     BoundSource;          /// The ObjectId of the data source whose buffers are attached to VertexArray, or 0.
 };
 
 /// @summary Defines the data used to specify an input assembler stage configuration.
 struct CG_VERTEX_DATA_SOURCE
 {
     uint32_t                     ObjectId;             /// The CGFX internal object identifier.
-    GLuint                       VertexArray;          /// The OpenGL vertex array object.
+    GLuint                       VertexArray;          /// The OpenGL vertex array object. Owned by SharedLayout if it is not NULL.
+    CG_VERTEX_LAYOUT            *SharedLayout;         /// The shared vertex format, or NULL if VertexArray captures the buffer bindings itself.
     size_t                       BufferCount;          /// The number of data buffers used for specifying vertex data.
     size_t                       AttributeCount;       /// The number of vertex attributes defining the vertex layout.
+    GLuint                      *BufferNames;          /// An array of BufferCount OpenGL buffer objects supplying vertex data.
+    size_t                      *BufferOffsets;        /// An array of BufferCount byte offsets of the first vertex in each buffer.
+    GLuint                       IndexBuffer;          /// The OpenGL buffer object supplying index data, or 0.
+    size_t                       IndexOffset;          /// The byte offset of the first index in IndexBuffer, added to the first index of every non-indirect draw.
     size_t                      *BufferStrides;        /// An array of BufferCount items specifying the number of bytes between adjacent vertices in each buffer.
     size_t                      *BufferIndices;        /// An array of AttributeCount buffer indices for each vertex attribute.
     GLuint                      *ShaderLocations;      /// An array of AttributeCount shader bindings for each vertex attribute.
@@ -772,6 +1163,67 @@ typedef CG_OBJECT_TABLE<CG_IMAGE             , CG_MAX_IMAGES             > CG_IM
 typedef CG_OBJECT_TABLE<CG_SAMPLER           , CG_MAX_SAMPLERS           > CG_SAMPLER_TABLE;
 typedef CG_OBJECT_TABLE<CG_VERTEX_DATA_SOURCE, CG_MAX_VERTEX_DATA_SOURCES> CG_VERTEX_DATA_SOURCE_TABLE;
 
+/// @summary Define the header written at the start of each file in the on-disk kernel cache. The program binary immediately follows the header.
+struct CG_KERNEL_CACHE_HEADER
+{
+    uint32_t                     Magic;                /// The file identifier, CG_KERNEL_CACHE_MAGIC.
+    uint32_t                     Version;              /// The file format version, CG_KERNEL_CACHE_VERSION.
+    uint64_t                     Key;                  /// The cache key the file was written for. Guards against hash-named files being renamed.
+    uint64_t                     DataSize;             /// The number of bytes of data following the header.
+};
+
+/// @summary Define the state shared between the thread that requested an asynchronous compute program build and the 
+/// thread pool worker performing it. The record is allocated and freed only by the thread that owns the kernel object.
+struct CG_KERNEL_BUILD
+{
+    cl_program                   ComputeProgram;       /// The program being built. Reference to CG_KERNEL.
+    cl_uint                      DeviceCount;          /// The number of devices the program is being built for.
+    cl_device_id                *DeviceIds;            /// The devices the program is being built for. Reference to CG_EXEC_GROUP.
+    uint64_t                    *CacheKeys;            /// The kernel cache key for each device, or NULL if the cache is disabled. Local.
+    char                        *Options;              /// A copy of the NULL-terminated build options passed to clBuildProgram, or NULL. Local.
+    size_t                       OptionsSize;          /// The number of bytes allocated for Options, including the terminator.
+    cl_event                     ReadyEvent;           /// A user event set to CL_COMPLETE when the build succeeds, or a negative value if it fails.
+    LONG volatile                Finishing;            /// Set to 1 by the first thread to observe build completion.
+    LONG volatile                BuildStatus;          /// CG_NOT_READY until the build completes, then CG_SUCCESS or CG_COMPILE_FAILED.
+    LONG volatile                WorkerActive;         /// Non-zero until the thread pool worker no longer references the record.
+};
+
+/// @summary Define the header of a linked OpenGL program stored in the on-disk kernel cache. The header is followed by the 
+/// AttributeNames, Attributes, SamplerNames, Samplers, UniformNames and Uniforms reflection arrays, and then the program binary.
+struct CG_GLSL_BINARY_HEADER
+{
+    uint32_t                     BinaryFormat;         /// The GLenum binary format returned by glGetProgramBinary.
+    uint32_t                     BinarySize;           /// The size of the program binary, in bytes.
+    uint32_t                     AttributeCount;       /// The number of active vertex attributes.
+    uint32_t                     SamplerCount;         /// The number of active texture samplers.
+    uint32_t                     UniformCount;         /// The number of active uniforms.
+    uint32_t                     UniformBlockCount;    /// The number of active uniform blocks.
+};
+
+/// @summary Define the counters maintained by the kernel cache. Kernels may be created from several threads, and stores 
+/// happen on thread pool workers, so counters are updated with interlocked operations. The fields mirror cg_kernel_cache_stats_t.
+struct CG_KERNEL_CACHE_COUNTERS
+{
+    LONGLONG volatile            LookupCount;          /// The number of compute programs for which the cache was searched.
+    LONGLONG volatile            HitCount;             /// The number of lookups satisfied by cached binaries for every device in the execution group.
+    LONGLONG volatile            StoreCount;           /// The number of device binaries written to the cache.
+    LONGLONG volatile            BuildNanos;           /// The total time spent building compute programs from source, in nanoseconds.
+    LONGLONG volatile            LoadNanos;            /// The total time spent loading compute programs from cached or application-supplied binaries, in nanoseconds.
+    LONGLONG volatile            PipelineLookupCount;  /// The number of graphics pipeline programs for which the cache was searched.
+    LONGLONG volatile            PipelineHitCount;     /// The number of graphics pipeline programs restored from the cache.
+    LONGLONG volatile            PipelineStoreCount;   /// The number of graphics pipeline programs written to the cache.
+    LONGLONG volatile            PipelineBuildNanos;   /// The total time spent linking and reflecting graphics pipeline programs, in nanoseconds.
+    LONGLONG volatile            PipelineLoadNanos;    /// The total time spent restoring graphics pipeline programs from the cache, in nanoseconds.
+};
+
+/// @summary Define the state associated with the on-disk kernel binary cache.
+struct CG_KERNEL_CACHE
+{
+    char                        *Directory;            /// The NULL-terminated path of the cache directory, or NULL if caching is disabled.
+    size_t                       DirectorySize;        /// The number of bytes allocated for Directory, including the terminator.
+    CG_KERNEL_CACHE_COUNTERS     Stats;                /// Hit counts and timing for kernel creation.
+};
+
 /// @summary Define the state associated with a CGFX instance, created when devices are enumerated.
 struct CG_CONTEXT
 {
@@ -795,11 +1247,252 @@ struct CG_CONTEXT
     CG_IMAGE_TABLE               ImageTable;           /// The object table of all image objects.
     CG_SAMPLER_TABLE             SamplerTable;         /// The object table of all image sampler objects.
     CG_VERTEX_DATA_SOURCE_TABLE  VertexSourceTable;    /// The object table of all input assembler configuration objects.
+    CG_VERTEX_LAYOUT            *VertexLayouts;        /// The list of vertex array objects shared by data sources with the same vertex format.
+
+    CG_SCRATCH_ARENA             ScratchArenas[CG_MAX_SCRATCH_ARENAS]; /// The per-thread scratch arenas referenced by HostAllocator.
+    CG_ALLOCATION_COUNTERS       AllocationStats[CG_MAX_ALLOCATION_TYPES]; /// The host memory allocation counters referenced by HostAllocator.
+
+    LONGLONG volatile            FrameIndex;           /// The residency frame counter, incremented atomically once per command buffer submission by any submitting thread.
+    cg_residency_stats_t         ResidencyStats;       /// Counters maintained by the residency manager.
+    SRWLOCK                      ResidencyLock;        /// Held shared while command buffers execute or objects are mapped, and exclusive while objects are evicted.
+    SRWLOCK                      RestoreLock;          /// Serializes restoring evicted objects and counting mappings between threads holding ResidencyLock shared.
+
+    CG_KERNEL_CACHE              KernelCache;          /// The on-disk cache of compiled program binaries.
 };
 
 /*/////////////////
 //   Functions   //
 /////////////////*/
+/// @summary Retrieve the scratch arena owned by the calling thread, optionally claiming and initializing a free arena.
+/// @param host The host allocator, initialized with cgUserSetupHostAllocator.
+/// @param create Specify true to claim a free arena if the calling thread does not own one.
+/// @return The scratch arena owned by the calling thread, or NULL.
+public_function inline CG_SCRATCH_ARENA*
+cgScratchArenaForThread
+(
+    CG_HOST_ALLOCATOR *host, 
+    bool               create
+)
+{
+    CG_SCRATCH_ARENA *list = host->ScratchArenas;
+    LONG              tid  =(LONG) GetCurrentThreadId();
+    if (list == NULL)
+        return NULL;
+
+    for (size_t i = 0; i < CG_MAX_SCRATCH_ARENAS; ++i)
+    {
+        if (list[i].OwnerThread == tid)
+            return list[i].BaseAddress != NULL ? &list[i] : NULL;
+    }
+    if (create == false)
+        return NULL;
+
+    for (size_t i = 0; i < CG_MAX_SCRATCH_ARENAS; ++i)
+    {
+        if (list[i].OwnerThread == 0 && InterlockedCompareExchange(&list[i].OwnerThread, tid, 0) == 0)
+        {   // the arena has been claimed by this thread. allocate the backing memory.
+            // if the allocation fails, the slot stays claimed until the thread exits so the attempt is not repeated.
+            list[i].Host        = host;
+            list[i].BaseAddress = (uint8_t*) host->Allocate(CG_SCRATCH_ARENA_SIZE, CG_SCRATCH_ARENA_ALIGNMENT, CG_ALLOCATION_TYPE_INTERNAL, host->UserData);
+            list[i].ArenaSize   = list[i].BaseAddress != NULL ? CG_SCRATCH_ARENA_SIZE : 0;
+            list[i].NextOffset  = 0;
+            list[i].TopBlock    = CG_SCRATCH_NO_BLOCK;
+            if (host->ScratchFlsIndex != FLS_OUT_OF_INDEXES)
+            {   // release the slot when the thread exits, so the thread identifier and slot can be reused.
+                FlsSetValue(host->ScratchFlsIndex, &list[i]);
+            }
+            return list[i].BaseAddress != NULL ? &list[i] : NULL;
+        }
+    }
+    return NULL;
+}
+
+/// @summary Pop freed blocks off the top of a scratch arena until the top block is live or the arena is empty.
+/// @param arena The scratch arena owned by the calling thread.
+public_function inline void
+cgScratchPopFreed
+(
+    CG_SCRATCH_ARENA *arena
+)
+{
+    while (arena->TopBlock != CG_SCRATCH_NO_BLOCK)
+    {
+        CG_SCRATCH_HEADER *header = (CG_SCRATCH_HEADER*)(arena->BaseAddress + arena->TopBlock - sizeof(CG_SCRATCH_HEADER));
+        if (header->Freed == 0)
+            break;
+        arena->NextOffset = header->PrevOffset;
+        arena->TopBlock   = header->PrevBlock;
+    }
+}
+
+/// @summary Attempt to allocate memory from the scratch arena owned by the calling thread.
+/// @param host The host allocator, initialized with cgUserSetupHostAllocator.
+/// @param size The desired allocation size, in bytes.
+/// @param alignment The required alignment of the returned address, in bytes. Must be zero or a power of two.
+/// @return A pointer to the scratch memory block, or NULL if the request should be satisfied by the host allocator.
+public_function inline void*
+cgScratchAllocate
+(
+    CG_HOST_ALLOCATOR *host, 
+    size_t             size, 
+    size_t             alignment
+)
+{
+    CG_SCRATCH_ARENA *arena = cgScratchArenaForThread(host, true);
+    if (arena == NULL)
+        return NULL;
+
+    // reclaim any blocks at the top of the arena that were freed by other threads.
+    cgScratchPopFreed(arena);
+    if (alignment < CG_SCRATCH_ARENA_ALIGNMENT)
+        alignment = CG_SCRATCH_ARENA_ALIGNMENT;
+
+    size_t offset = align_up(arena->NextOffset + sizeof(CG_SCRATCH_HEADER), alignment);
+    if (offset + size > arena->ArenaSize || offset + size < offset)
+    {   // the request does not fit in the remaining space.
+        arena->OverflowCount++;
+        return NULL;
+    }
+    CG_SCRATCH_HEADER *header = (CG_SCRATCH_HEADER*)(arena->BaseAddress + offset - sizeof(CG_SCRATCH_HEADER));
+    header->PrevOffset = arena->NextOffset;
+    header->PrevBlock  = arena->TopBlock;
+    header->Freed      = 0;
+    arena->TopBlock    = offset;
+    arena->NextOffset  = offset + size;
+    if (arena->NextOffset > arena->HighWaterMark)
+        arena->HighWaterMark = arena->NextOffset;
+    arena->AllocationCount++;
+    return arena->BaseAddress + offset;
+}
+
+/// @summary Release a block of memory allocated from a scratch arena. The space is reclaimed as soon as the block and all blocks allocated after it have been freed, 
+/// in any order. A block freed by a thread other than the owner is marked free with an interlocked store, and is reclaimed by the owner's next scratch 
+/// allocation, release or scope end.
+/// @param host The host allocator, initialized with cgUserSetupHostAllocator.
+/// @param address The address of the memory block to free.
+/// @param size The requested size of the allocated block, in bytes.
+/// @return true if @a address was allocated from a scratch arena, or false if it should be returned to the host allocator.
+public_function inline bool
+cgScratchRelease
+(
+    CG_HOST_ALLOCATOR *host, 
+    void              *address, 
+    size_t             size
+)
+{
+    CG_SCRATCH_ARENA *list = host->ScratchArenas;
+    uint8_t          *addr =(uint8_t*) address;
+    if (list == NULL || address == NULL)
+        return false;
+
+    for (size_t i = 0; i < CG_MAX_SCRATCH_ARENAS; ++i)
+    {
+        CG_SCRATCH_ARENA *arena = &list[i];
+        if (arena->BaseAddress != NULL && addr >= arena->BaseAddress && addr < arena->BaseAddress + arena->ArenaSize)
+        {   // mark the block free and pop it, along with any freed blocks below it, once it reaches the top.
+            CG_SCRATCH_HEADER *header = (CG_SCRATCH_HEADER*)(addr - sizeof(CG_SCRATCH_HEADER));
+            if (arena->OwnerThread == (LONG) GetCurrentThreadId())
+            {   // a block above NextOffset was reclaimed by the end of its scratch scope and has escaped.
+                assert(addr + size <= arena->BaseAddress + arena->NextOffset && "scratch allocation outlived its scratch scope");
+                header->Freed = 1;
+                cgScratchPopFreed(arena);
+            }
+            else
+            {   // only the owner may modify the arena. publish the release for the owner to pop.
+                InterlockedExchange(&header->Freed, 1);
+            }
+            UNREFERENCED_PARAMETER(size);
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @summary Begin a scratch scope on the calling thread. All scratch memory allocated by the thread after this call is reclaimed by the matching call to cgScratchScopeEnd.
+/// @param host The host allocator, initialized with cgUserSetupHostAllocator.
+/// @return A marker value to pass to cgScratchScopeEnd.
+public_function inline size_t
+cgScratchScopeBegin
+(
+    CG_HOST_ALLOCATOR *host
+)
+{
+    CG_SCRATCH_ARENA *arena = cgScratchArenaForThread(host, false);
+    return arena != NULL ? arena->NextOffset : 0;
+}
+
+/// @summary End a scratch scope on the calling thread, reclaiming all scratch memory allocated since the matching call to cgScratchScopeBegin.
+/// Every block allocated within the scope should already have been freed, by the calling thread or another thread; debug builds assert this.
+/// @param host The host allocator, initialized with cgUserSetupHostAllocator.
+/// @param marker The marker value returned by cgScratchScopeBegin.
+public_function inline void
+cgScratchScopeEnd
+(
+    CG_HOST_ALLOCATOR *host, 
+    size_t             marker
+)
+{
+    CG_SCRATCH_ARENA *arena = cgScratchArenaForThread(host, false);
+    if (arena == NULL)
+        return;
+    while (arena->TopBlock != CG_SCRATCH_NO_BLOCK && arena->TopBlock > marker)
+    {   // discard the blocks allocated within the scope.
+        CG_SCRATCH_HEADER *header = (CG_SCRATCH_HEADER*)(arena->BaseAddress + arena->TopBlock - sizeof(CG_SCRATCH_HEADER));
+        assert(header->Freed != 0 && "scratch allocation outlives its scratch scope");
+        arena->NextOffset = header->PrevOffset;
+        arena->TopBlock   = header->PrevBlock;
+    }
+}
+
+/// @summary Update the allocation counters after a successful host memory allocation.
+/// @param host The host allocator, initialized with cgUserSetupHostAllocator.
+/// @param size The allocation size, in bytes.
+/// @param type One of cg_allocation_type_e.
+public_function inline void
+cgHostAllocatorRecordAllocate
+(
+    CG_HOST_ALLOCATOR *host, 
+    size_t             size, 
+    int                type
+)
+{
+    if (host->Counters == NULL || type < 0 || type >= CG_MAX_ALLOCATION_TYPES)
+        return;
+
+    CG_ALLOCATION_COUNTERS *c = &host->Counters[type];
+    LONGLONG  live = InterlockedExchangeAdd64(&c->LiveBytes, LONGLONG(size)) + LONGLONG(size);
+    LONGLONG  peak = c->PeakBytes;
+    while (live > peak)
+    {   // another thread may be updating the peak concurrently.
+        LONGLONG prev = InterlockedCompareExchange64(&c->PeakBytes, live, peak);
+        if (prev == peak) break;
+        peak = prev;
+    }
+    InterlockedIncrement64(&c->LiveCount);
+    InterlockedIncrement64(&c->AllocationCount);
+    InterlockedExchangeAdd64(&c->AllocatedBytes, LONGLONG(size));
+}
+
+/// @summary Update the allocation counters when a host memory block is released.
+/// @param host The host allocator, initialized with cgUserSetupHostAllocator.
+/// @param size The requested size of the allocated block, in bytes.
+/// @param type One of cg_allocation_type_e.
+public_function inline void
+cgHostAllocatorRecordRelease
+(
+    CG_HOST_ALLOCATOR *host, 
+    size_t             size, 
+    int                type
+)
+{
+    if (host->Counters == NULL || type < 0 || type >= CG_MAX_ALLOCATION_TYPES)
+        return;
+
+    CG_ALLOCATION_COUNTERS *c = &host->Counters[type];
+    InterlockedExchangeAdd64(&c->LiveBytes, -LONGLONG(size));
+    InterlockedDecrement64(&c->LiveCount);
+}
+
 /// @summary Allocate host memory from the context-specific heap.
 /// @param host The host allocator, initialized with cgUserSetupHostAllocator.
 /// @param size The desired allocation size, in bytes.
@@ -815,7 +1508,20 @@ cgAllocateHostMemory
     int                type 
 )
 {
-    return host->Allocate(size, alignment, type, host->UserData);
+    void *p  = NULL;
+    if (type == CG_ALLOCATION_TYPE_TEMP || type == CG_ALLOCATION_TYPE_KERNEL)
+    {   // short-lived allocations are served from the per-thread scratch arena when possible.
+        p = cgScratchAllocate(host, size, alignment);
+    }
+    if (p == NULL)
+    {   // fall back to the host allocator.
+        p = host->Allocate(size, alignment, type, host->UserData);
+    }
+    if (p != NULL)
+    {
+        cgHostAllocatorRecordAllocate(host, size, type);
+    }
+    return p;
 }
 
 /// @summary Free host memory allocated from a context-specific heap.
@@ -834,6 +1540,14 @@ cgFreeHostMemory
     int                type
 )
 {
+    if (address != NULL)
+    {
+        cgHostAllocatorRecordRelease(host, size, type);
+    }
+    if ((type == CG_ALLOCATION_TYPE_TEMP || type == CG_ALLOCATION_TYPE_KERNEL) && cgScratchRelease(host, address, size))
+    {   // the memory block belongs to a scratch arena.
+        return;
+    }
     host->Release(address, size, alignment, type, host->UserData);
 }
 
@@ -969,6 +1683,9 @@ cgObjectTableInit
 )
 {
     table->ObjectCount   = 0;
+    table->PeakCount     = 0;
+    table->CreateCount   = 0;
+    table->DeleteCount   = 0;
     table->FreeListTail  = CG_OBJECT_TABLE<T,N>::MAX_OBJECTS - 1;
     table->FreeListHead  = 0;
     table->ObjectType    = object_type;
@@ -1042,6 +1759,9 @@ cgObjectTableAdd
         object                 = data;                                    // copy data into the newly allocated slot
         object.ObjectId        = index.Id;                                // and then store the new object ID in the data
         table->ObjectCount++;                                             // update the number of valid items in the table
+        table->CreateCount++;
+        if (table->ObjectCount > table->PeakCount)
+            table->PeakCount = table->ObjectCount;
         return cgMakeHandle(index.Id, type, tidx);
     }
     else return CG_INVALID_HANDLE;
@@ -1073,6 +1793,7 @@ cgObjectTableRemove
         object    = table->Objects[table->ObjectCount-1];
         table->Indices[object.ObjectId & CG_OBJECT_TABLE<T,N>::INDEX_MASK].Index = index.Index;
         table->ObjectCount--;
+        table->DeleteCount++;
         // mark the deleted object as being invalid.
         // return the object index to the free list.
         index.Index = CG_OBJECT_TABLE<T,N>::INDEX_INVALID;
@@ -1130,6 +1851,43 @@ cgHashName
     return hash;
 }
 
+/// @summary Accumulate a block of data into a 64-bit FNV-1a hash. Used to build cache keys from source code and device attributes.
+/// @param hash The running hash value. Pass CG_FNV1A_64_SEED to start a new hash.
+/// @param data The data to hash.
+/// @param size The number of bytes to read from @a data.
+/// @return The updated hash value.
+internal_function inline uint64_t
+cgHashData
+(
+    uint64_t    hash, 
+    void const *data, 
+    size_t      size
+)
+{
+    uint8_t const *bytes = (uint8_t const*) data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x00000100000001B3ULL;
+    }
+    return hash;
+}
+
+/// @summary Accumulate a NULL-terminated string, including the terminator, into a 64-bit FNV-1a hash. NULL hashes the same as an empty string.
+/// @param hash The running hash value.
+/// @param str The NULL-terminated string to hash, or NULL.
+/// @return The updated hash value.
+internal_function inline uint64_t
+cgHashString
+(
+    uint64_t    hash, 
+    char const *str
+)
+{
+    if (str == NULL) str = "";
+    return cgHashData(hash, str, strlen(str) + 1);
+}
+
 /// @summary Search a fixed list of name hashes for a given item.
 /// @param name_str The NULL-terminated ASCII string to search for.
 /// @param name_list The list of string hash values to search.
@@ -1210,6 +1968,43 @@ cgCmdBufferSetTypeAndState
         ((uint32_t(state     ) & CG_CMD_BUFFER::STATE_MASK_U) << CG_CMD_BUFFER::STATE_SHIFT);
 }
 
+/// @summary Ensure that space is committed for the sort entry of the next command appended to a command buffer.
+/// @param cmdbuf The command buffer being written.
+/// @return CG_SUCCESS or CG_OUT_OF_MEMORY.
+internal_function inline int
+cgCmdBufferReserveSortEntry
+(
+    CG_CMD_BUFFER *cmdbuf
+)
+{
+    if ((cmdbuf->Flags & CG_COMMAND_BUFFER_FLAG_SORT_BY_KEY) == 0)
+        return CG_SUCCESS;
+    size_t required = (cmdbuf->CommandCount + 1) * sizeof(CG_CMD_SORT_ENTRY);
+    if (required > cmdbuf->SortBytesTotal)
+    {   // commit additional address space.
+        size_t cs = align_up(required, CG_CMD_BUFFER::ALLOCATION_GRANULARITY);
+        if (cs > CG_CMD_BUFFER::MAX_SORT_SIZE || VirtualAlloc(cmdbuf->SortEntries, cs, MEM_COMMIT, PAGE_READWRITE) == NULL)
+            return CG_OUT_OF_MEMORY;
+        cmdbuf->SortBytesTotal = cs;
+    }
+    return CG_SUCCESS;
+}
+
+/// @summary Record the current sort key for the command being appended to a command buffer. Call before updating BytesUsed and CommandCount.
+/// @param cmdbuf The command buffer being written. Space must have been reserved with cgCmdBufferReserveSortEntry.
+internal_function inline void
+cgCmdBufferAddSortEntry
+(
+    CG_CMD_BUFFER *cmdbuf
+)
+{
+    if ((cmdbuf->Flags & CG_COMMAND_BUFFER_FLAG_SORT_BY_KEY) != 0)
+    {
+        cmdbuf->SortEntries[cmdbuf->CommandCount].SortKey = cmdbuf->SortKey;
+        cmdbuf->SortEntries[cmdbuf->CommandCount].Offset  = cmdbuf->BytesUsed;
+    }
+}
+
 /// @summary Determine whether a command buffer is in a readable state.
 /// @param cmdbuf The handle of the command buffer to query.
 /// @param bytes_total On return, set to the number of bytes used in the command buffer.
@@ -1349,6 +2144,153 @@ cgSetupNewCompleteEvent                             /// Creates a new CGFX event
     int                  result                     /// The CGFX result code to return.
 );
 
+extern void
+cgGlStateReset                                      /// Mark all state in the OpenGL state cache of a display as unknown.
+(
+    CG_DISPLAY          *display                    /// The display object attached to the OpenGL rendering context.
+);
+
+extern void
+cgGlStateBeginFrame                                 /// Capture the OpenGL state cache call counters at the start of a graphics submission.
+(
+    CG_DISPLAY          *display                    /// The display object attached to the OpenGL rendering context.
+);
+
+extern void
+cgGlUniformRingBeginFrame                           /// Fence the uniform data written by the previous graphics submission and recycle retired ring space.
+(
+    CG_DISPLAY          *display                    /// The display object attached to the OpenGL rendering context.
+);
+
+extern int
+cgGlUniformRingWrite                                /// Copy uniform block data into the uniform ring of a rendering context.
+(
+    CG_DISPLAY          *display,                   /// The display object attached to the OpenGL rendering context.
+    void const          *data,                      /// The uniform block data to copy.
+    size_t               size,                      /// The number of bytes to copy.
+    GLintptr            &out_offset                 /// On return, the byte offset of the data within the ring buffer.
+);
+
+extern void
+cgGlStateObjectDeleted                              /// Update the OpenGL state cache after an object is deleted.
+(
+    CG_DISPLAY          *display,                   /// The display object attached to the OpenGL rendering context.
+    GLenum               type,                      /// The type of object, one of GL_PROGRAM, GL_VERTEX_ARRAY, GL_BUFFER, GL_TEXTURE or GL_SAMPLER.
+    GLuint               name                       /// The name of the deleted object.
+);
+
+extern void
+cgGlUseProgram                                      /// Make a program object current, unless it is already current.
+(
+    CG_DISPLAY          *display,                   /// The display object attached to the OpenGL rendering context.
+    GLuint               program                    /// The name of the program object, or 0.
+);
+
+extern void
+cgGlBindVertexArray                                 /// Bind a vertex array object, unless it is already bound.
+(
+    CG_DISPLAY          *display,                   /// The display object attached to the OpenGL rendering context.
+    GLuint               vao                        /// The name of the vertex array object, or 0.
+);
+
+extern void
+cgGlBindVertexDataSource                            /// Bind the vertex array object and, for shared layouts, the vertex and index buffers of a data source.
+(
+    CG_DISPLAY          *display,                   /// The display object attached to the OpenGL rendering context.
+    CG_VERTEX_DATA_SOURCE const *source             /// The vertex data source to bind.
+);
+
+extern void
+cgGlBindBuffer                                      /// Bind a buffer object to an indirect command target, unless it is already bound.
+(
+    CG_DISPLAY          *display,                   /// The display object attached to the OpenGL rendering context.
+    GLenum               target,                    /// The buffer target, GL_DRAW_INDIRECT_BUFFER or GL_PARAMETER_BUFFER_ARB.
+    GLuint               buffer                     /// The name of the buffer object, or 0.
+);
+
+extern void
+cgGlBindBufferRange                                 /// Bind a range of a buffer object to an indexed binding point, unless it is already bound.
+(
+    CG_DISPLAY          *display,                   /// The display object attached to the OpenGL rendering context.
+    GLenum               target,                    /// The indexed buffer target, for example GL_UNIFORM_BUFFER.
+    GLuint               index,                     /// The zero-based index of the binding point.
+    GLuint               buffer,                    /// The name of the buffer object, or 0.
+    GLintptr             offset,                    /// The byte offset of the start of the range.
+    GLsizeiptr           size                       /// The size of the range, in bytes.
+);
+
+extern void
+cgGlBindTexture                                     /// Bind a texture to a texture unit, unless it is already bound.
+(
+    CG_DISPLAY          *display,                   /// The display object attached to the OpenGL rendering context.
+    GLuint               unit,                      /// The zero-based index of the texture unit.
+    GLenum               target,                    /// The texture target, for example GL_TEXTURE_2D.
+    GLuint               texture                    /// The name of the texture object, or 0.
+);
+
+extern void
+cgGlBindSampler                                     /// Bind a sampler object to a texture unit, unless it is already bound.
+(
+    CG_DISPLAY          *display,                   /// The display object attached to the OpenGL rendering context.
+    GLuint               unit,                      /// The zero-based index of the texture unit.
+    GLuint               sampler                    /// The name of the sampler object, or 0.
+);
+
+extern int
+cgGlBindRenderTarget                                /// Bind the default framebuffer, or attach images to the offscreen framebuffer of the rendering context and bind it.
+(
+    CG_DISPLAY          *display,                   /// The display object attached to the OpenGL rendering context.
+    CG_IMAGE            *color,                     /// The color image to render into, or NULL to bind the default framebuffer.
+    CG_IMAGE            *depth,                     /// The depth or depth-stencil image, or NULL.
+    GLint                level                      /// The mipmap level of the images to render into.
+);
+
+extern int
+cgGlBindReadSource                                  /// Bind the framebuffer that pixel reads are sourced from: the current draw framebuffer, or a level of an image.
+(
+    CG_DISPLAY          *display,                   /// The display object attached to the OpenGL rendering context.
+    CG_IMAGE            *image,                     /// The 2D image to read from, or NULL to read from the current draw framebuffer.
+    GLint                level                      /// The mipmap level of the image to read from.
+);
+
+extern void
+cgGlViewport                                        /// Set the viewport rectangle, unless it is already current.
+(
+    CG_DISPLAY          *display,                   /// The display object attached to the OpenGL rendering context.
+    GLint                x,                         /// The x-coordinate of the lower-left corner of the viewport.
+    GLint                y,                         /// The y-coordinate of the lower-left corner of the viewport.
+    GLsizei              width,                     /// The width of the viewport, in pixels.
+    GLsizei              height                     /// The height of the viewport, in pixels.
+);
+
+extern void
+cgGlApplyBlendState                                 /// Apply the parts of a blend state that differ from the current state.
+(
+    CG_DISPLAY          *display,                   /// The display object attached to the OpenGL rendering context.
+    CG_BLEND_STATE const*state                      /// The blend state to apply.
+);
+
+extern void
+cgGlApplyRasterState                                /// Apply the parts of a rasterizer state that differ from the current state.
+(
+    CG_DISPLAY          *display,                   /// The display object attached to the OpenGL rendering context.
+    CG_RASTER_STATE const *state                    /// The rasterizer state to apply.
+);
+
+extern void
+cgGlApplyDepthStencilState                          /// Apply the parts of a depth-stencil state that differ from the current state.
+(
+    CG_DISPLAY          *display,                   /// The display object attached to the OpenGL rendering context.
+    CG_DEPTH_STENCIL_STATE const *state             /// The depth-stencil state to apply.
+);
+
+extern void
+cgGlApplyGraphicsPipeline                           /// Apply the program and fixed-function state of a graphics pipeline through the state cache.
+(
+    CG_DISPLAY          *display,                   /// The display object attached to the OpenGL rendering context.
+    CG_GRAPHICS_PIPELINE const *pipeline            /// The graphics pipeline whose state is applied.
+);
+
 extern void
 cgMemRefListAddMem                                  /// Adds an item to a memory object reference list.
 (
@@ -1404,6 +2346,55 @@ cgReleaseMemoryObjects                              /// Indicates that compute i
     cg_handle_t          done_event                 /// The handle of an existing CGFX event that will become signaled when OpenGL can access the memory objects again.
 );
 
+extern int
+cgMakeBufferResident                                /// Marks a buffer as referenced in the current frame, restoring it to device memory if it was evicted.
+(
+    CG_CONTEXT          *ctx,                       /// The CGFX context that owns the buffer.
+    CG_QUEUE            *queue,                     /// The CGFX compute or transfer command queue that will reference the buffer.
+    CG_BUFFER           *buffer                     /// The CGFX buffer object being referenced.
+);
+
+extern int
+cgMakeImageResident                                 /// Marks an image as referenced in the current frame, restoring it to device memory if it was evicted.
+(
+    CG_CONTEXT          *ctx,                       /// The CGFX context that owns the image.
+    CG_QUEUE            *queue,                     /// The CGFX compute or transfer command queue that will reference the image.
+    CG_IMAGE            *image                      /// The CGFX image object being referenced.
+);
+
+extern int
+cgEnforceResidencyBudget                            /// Evicts least-recently-used device memory objects from any heap whose usage exceeds its residency budget.
+(
+    CG_CONTEXT          *ctx                        /// The CGFX context to update.
+);
+
+extern bool
+cgGlPixelTransferFormat                             /// Determine the client pixel format and data type used to transfer pixels of a DXGI format between OpenGL and a buffer object.
+(
+    uint32_t                dxgi,                   /// A value of the DXGI_FORMAT or dxgi_format_e enumeration.
+    GLenum                 &out_format,             /// On return, stores the OpenGL client pixel format (layout).
+    GLenum                 &out_datatype            /// On return, stores the OpenGL client data type.
+);
+
+extern bool
+cgSelectWorkGroupSize                               /// Select the local work size for a compute dispatch, autotuning the work group size if enabled for the pipeline.
+(
+    CG_CONTEXT             *ctx,                    /// The CGFX context that owns the pipeline.
+    CG_QUEUE               *queue,                  /// The CGFX compute queue the kernel will be enqueued on.
+    CG_COMPUTE_PIPELINE    *pipeline,               /// The compute pipeline being dispatched.
+    size_t                  work_dim,               /// The number of work dimensions, in [1, 3].
+    size_t const           *global_size,            /// The global work size in each dimension.
+    size_t                 *local_size,             /// On return, set to the local work size in each dimension if the function returns true.
+    CG_CL_WORKGROUP_TUNING **timing                 /// On return, set to the tuning record to pass to cgRecordWorkGroupTiming, or NULL if the dispatch is not being timed.
+);
+
+extern void
+cgRecordWorkGroupTiming                             /// Retain the profiling event of a dispatch enqueued with a candidate local work size returned by cgSelectWorkGroupSize.
+(
+    CG_CL_WORKGROUP_TUNING *timing,                 /// The tuning record returned by cgSelectWorkGroupSize.
+    cl_event                kernel_done             /// The event returned by clEnqueueNDRangeKernel.
+);
+
 #undef  CGFX_WIN32_INTERNALS_DEFINED
 #define CGFX_WIN32_INTERNALS_DEFINED
 #endif /* !defined(LIB_CGFX_W32_PRIVATE_H) */
@@ -32,6 +32,12 @@
 #include "cgfx_ext_win.h"
 #include "cgfx_w32_private.h"
 
+#undef    glewGetContext
+#define   glewGetContext()    (&display->GLEW)
+
+#undef    wglewGetContext
+#define   wglewGetContext()   (&display->WGLEW)
+
 /*////////////////////////////
 //   Forward Declarations   //
 ////////////////////////////*/
@@ -59,6 +65,213 @@ EXTERN_C IMAGE_DOS_HEADER __ImageBase;
 /*///////////////////////
 //   Local Functions   //
 ///////////////////////*/
+/// @summary Retrieve the current value of the high-resolution timer.
+/// @return The current timer value, in ticks.
+internal_function inline int64_t
+cgFrameTimestamp
+(
+    void
+)
+{
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart;
+}
+
+/// @summary Convert a duration in high-resolution timer ticks to nanoseconds without overflowing for long durations.
+/// @param ticks The duration, in ticks.
+/// @param frequency The frequency of the high-resolution timer, in ticks-per-second.
+/// @return The duration, in nanoseconds.
+internal_function inline int64_t
+cgFrameTicksToNanos
+(
+    int64_t ticks, 
+    int64_t frequency
+)
+{
+    return ((ticks / frequency) * 1000000000LL) + (((ticks % frequency) * 1000000000LL) / frequency);
+}
+
+/// @summary Convert a duration in nanoseconds to high-resolution timer ticks without overflowing for long durations.
+/// @param nanos The duration, in nanoseconds.
+/// @param frequency The frequency of the high-resolution timer, in ticks-per-second.
+/// @return The duration, in ticks.
+internal_function inline int64_t
+cgFrameNanosToTicks
+(
+    int64_t nanos, 
+    int64_t frequency
+)
+{
+    return ((nanos / 1000000000LL) * frequency) + (((nanos % 1000000000LL) * frequency) / 1000000000LL);
+}
+
+/// @summary Compare two signed 64-bit durations for qsort.
+/// @param a Pointer to the first int64_t value.
+/// @param b Pointer to the second int64_t value.
+/// @return A negative value if a < b, zero if a == b, or a positive value if a > b.
+internal_function int
+cgFrameCompareDuration
+(
+    void const *a, 
+    void const *b
+)
+{
+    int64_t const x = *(int64_t const*) a;
+    int64_t const y = *(int64_t const*) b;
+    return (x < y) ? -1 : ((x > y) ? +1 : 0);
+}
+
+/// @summary Select a nearest-rank percentile from a set of durations, sorting the set in place.
+/// @param values The durations, in ticks. The array is sorted on return.
+/// @param count The number of durations in @a values.
+/// @param percent The percentile to select, in [1, 100].
+/// @param frequency The frequency of the high-resolution timer, in ticks-per-second.
+/// @return The selected duration, in nanoseconds, or 0 if @a count is zero.
+internal_function uint64_t
+cgFramePercentile
+(
+    int64_t *values, 
+    size_t   count, 
+    size_t   percent, 
+    int64_t  frequency
+)
+{
+    if (count == 0)
+        return 0;
+    size_t rank = ((percent * count) + 99) / 100;
+    if (rank == 0) rank = 1;
+    return uint64_t(cgFrameTicksToNanos(values[rank-1], frequency));
+}
+
+/// @summary Retrieve the frame timer for a display, creating it on first use. Creation may race between threads; the 
+/// losing thread frees its copy and uses the timer installed by the winner.
+/// @param ctx The CGFX context that owns the display.
+/// @param display The display object.
+/// @return The frame timer, or NULL if host memory could not be allocated.
+internal_function CG_GL_FRAME_TIMER*
+cgFrameTimerAcquire
+(
+    CG_CONTEXT *ctx, 
+    CG_DISPLAY *display
+)
+{
+    CG_GL_FRAME_TIMER *timer = (CG_GL_FRAME_TIMER*) InterlockedCompareExchangePointer((PVOID volatile*) &display->FrameTimer, NULL, NULL);
+    if (timer != NULL)
+        return timer;
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    if ((timer = (CG_GL_FRAME_TIMER*) cgAllocateHostMemory(&ctx->HostAllocator, sizeof(CG_GL_FRAME_TIMER), CACHELINE_SIZE, CG_ALLOCATION_TYPE_INTERNAL)) == NULL)
+        return NULL;
+
+    memset(timer, 0, sizeof(CG_GL_FRAME_TIMER));
+    timer->Frequency         = frequency.QuadPart;
+    timer->MaxFramesInFlight = 0;
+    timer->TimerQuery        = false;
+    timer->InputTime.store(0, std::memory_order_relaxed);
+    timer->PresentCount.store(0, std::memory_order_relaxed);
+    timer->WaitCount.store(0, std::memory_order_relaxed);
+    timer->InFlight.store(0, std::memory_order_relaxed);
+    timer->HistoryCount.store(0, std::memory_order_relaxed);
+    for (size_t i = 0; i < CG_OPENGL_FRAME_HISTORY_SIZE; ++i)
+    {   // no slot holds a valid record yet.
+        timer->History[i].Sequence.store(~uint64_t(0), std::memory_order_relaxed);
+    }
+
+    CG_GL_FRAME_TIMER *existing = (CG_GL_FRAME_TIMER*) InterlockedCompareExchangePointer((PVOID volatile*) &display->FrameTimer, timer, NULL);
+    if (existing != NULL)
+    {   // another thread installed a timer first.
+        cgFreeHostMemory(&ctx->HostAllocator, timer, sizeof(CG_GL_FRAME_TIMER), CACHELINE_SIZE, CG_ALLOCATION_TYPE_INTERNAL);
+        return existing;
+    }
+    return timer;
+}
+
+/// @summary Sample the OpenGL timestamp clock and the host high-resolution timer together, so that query results can 
+/// be converted to host time. The two clocks drift apart slowly, so this is repeated every CG_OPENGL_FRAME_CLOCK_RESYNC frames.
+/// @param display The display object attached to the current OpenGL rendering context.
+/// @param timer The frame timer to update.
+internal_function void
+cgGlFrameTimerSyncClock
+(
+    CG_DISPLAY        *display, 
+    CG_GL_FRAME_TIMER *timer
+)
+{
+    GLint64 gpu_nanos = 0;
+    timer->TimerQuery = GLEW_ARB_timer_query ? true : false;
+    if (timer->TimerQuery)
+    {
+        glGetInteger64v(GL_TIMESTAMP, &gpu_nanos);
+        timer->ClockBaseCPU = cgFrameTimestamp();
+        timer->ClockBaseGPU = int64_t(gpu_nanos);
+    }
+}
+
+/// @summary Publish the timing record for a finished frame to the history ring. Only the thread that presents frames calls this.
+/// @param timer The frame timer to update.
+/// @param record The timing information for the finished frame.
+internal_function void
+cgFrameTimerPublish
+(
+    CG_GL_FRAME_TIMER        *timer, 
+    CG_GL_FRAME_RECORD const &record
+)
+{
+    uint64_t          index = timer->HistoryCount.load(std::memory_order_relaxed);
+    CG_GL_FRAME_SLOT &slot  = timer->History[index & (CG_OPENGL_FRAME_HISTORY_SIZE - 1)];
+    slot.Sequence.store(~uint64_t(0), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.Record = record;
+    slot.Sequence.store(index, std::memory_order_release);
+    timer->HistoryCount.store(index + 1, std::memory_order_release);
+}
+
+/// @summary Retire the oldest frame in flight if the device has finished it, resolving its completion time and publishing its record.
+/// @param display The display object attached to the current OpenGL rendering context.
+/// @param timer The frame timer to update. PendingCount must be greater than zero.
+/// @param wait Specify true to block until the device has finished the frame.
+/// @return true if the frame was retired.
+internal_function bool
+cgGlFrameTimerRetire
+(
+    CG_DISPLAY        *display, 
+    CG_GL_FRAME_TIMER *timer, 
+    bool               wait
+)
+{
+    size_t     const slot  = timer->PendingFirst;
+    GLbitfield const flags = wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0;
+    GLuint64   const nanos = wait ? GLuint64(1000000000) : 0;
+    GLenum           state = GL_TIMEOUT_EXPIRED;
+
+    do
+    {   // a failed wait means the fence can never signal; treat it the same as a signaled fence.
+        state = glClientWaitSync(timer->PendingFence[slot], flags, nanos);
+    } while (wait && state == GL_TIMEOUT_EXPIRED);
+
+    if (state == GL_TIMEOUT_EXPIRED)
+        return false;
+
+    CG_GL_FRAME_RECORD &record = timer->Pending[slot];
+    if (timer->TimerQuery && timer->PendingQuery[slot] != 0)
+    {   // the timestamp was written when the device reached the end of the frame.
+        GLuint64 gpu_nanos = 0;
+        glGetQueryObjectui64v(timer->PendingQuery[slot], GL_QUERY_RESULT, &gpu_nanos);
+        record.CompleteTime = timer->ClockBaseCPU + cgFrameNanosToTicks(int64_t(gpu_nanos) - timer->ClockBaseGPU, timer->Frequency);
+    }
+    else
+    {   // without timer queries, the best available estimate is when the fence was observed.
+        record.CompleteTime = cgFrameTimestamp();
+    }
+    glDeleteSync(timer->PendingFence[slot]);
+    timer->PendingFence[slot] = NULL;
+    cgFrameTimerPublish(timer, record);
+    timer->PendingFirst = (timer->PendingFirst + 1) % CG_OPENGL_FRAME_MAX_IN_FLIGHT;
+    timer->PendingCount--;
+    return true;
+}
 
 /*////////////////////////
 //   Public Functions   //
@@ -418,3 +631,235 @@ cgPresentDrawableEXT
     SwapBuffers(drawable);
     return CG_SUCCESS;
 }
+
+/// @summary Directly queues presentation of a drawable and records the timing of the frame for the display. The frame 
+/// is tracked with a fence, and a timestamp query where supported, until the device finishes it. If a frame limit was 
+/// set with cgSetFramePacingEXT, the call blocks until no more than that many presented frames are unfinished. If the 
+/// fence cannot be created, the drawable is still presented, but the frame is not recorded.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param display_handle The display whose rendering context rendered the frame. The rendering context must be current.
+/// @param drawable The device context of the window representing the drawable, or NULL to use the primary display window. Ignored for headless displays.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_NO_GLCONTEXT or CG_OUT_OF_MEMORY.
+library_function int
+cgPresentDisplayEXT
+(
+    uintptr_t   context, 
+    cg_handle_t display_handle, 
+    HDC         drawable
+)
+{
+    CG_CONTEXT        *ctx     = (CG_CONTEXT*) context;
+    CG_DISPLAY        *display =  cgObjectTableGet(&ctx->DisplayTable, display_handle);
+    CG_GL_FRAME_TIMER *timer   =  NULL;
+    if (display == NULL)
+    {   // the display handle is invalid.
+        return CG_INVALID_VALUE;
+    }
+    if (display->DisplayRC == NULL)
+    {   // this display has no rendering context.
+        return CG_NO_GLCONTEXT;
+    }
+    if ((timer = cgFrameTimerAcquire(ctx, display)) == NULL)
+    {   // unable to allocate the frame timer.
+        return CG_OUT_OF_MEMORY;
+    }
+
+    // the host has finished submitting work for the frame.
+    int64_t submit_time = cgFrameTimestamp();
+    int64_t input_time  = timer->InputTime.exchange(0, std::memory_order_acq_rel);
+    if ((timer->FrameIndex % CG_OPENGL_FRAME_CLOCK_RESYNC) == 0)
+    {   // periodically re-align the device clock with the host clock.
+        cgGlFrameTimerSyncClock(display, timer);
+    }
+
+    // release any frames the device has finished, and make room for this frame.
+    while (timer->PendingCount > 0 && cgGlFrameTimerRetire(display, timer, false))
+    {   /* publish all frames that have completed */ }
+    if (timer->PendingCount == CG_OPENGL_FRAME_MAX_IN_FLIGHT)
+    {   // too many frames in flight; wait for the oldest.
+        cgGlFrameTimerRetire(display, timer, true);
+        timer->WaitCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // mark the end of the frame in the device command stream.
+    size_t slot = (timer->PendingFirst + timer->PendingCount) % CG_OPENGL_FRAME_MAX_IN_FLIGHT;
+    if (timer->TimerQuery)
+    {
+        if (timer->PendingQuery[slot] == 0)
+            glGenQueries(1, &timer->PendingQuery[slot]);
+        glQueryCounter(timer->PendingQuery[slot], GL_TIMESTAMP);
+    }
+    timer->PendingFence[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    if (display->Headless)
+    {   // there's nothing to swap, but the fence must reach the device to signal.
+        glFlush();
+    }
+    else
+    {   // swapping flushes the command stream.
+        SwapBuffers(drawable != NULL ? drawable : display->DisplayDC);
+    }
+    int64_t present_time = cgFrameTimestamp();
+    if (timer->PendingFence[slot] == NULL)
+    {   // the frame was presented, but its completion cannot be tracked, so it is not recorded.
+        // the slot, and its timestamp query, are reused by the next frame.
+        int64_t expected = 0;
+        if (input_time != 0)
+            timer->InputTime.compare_exchange_strong(expected, input_time, std::memory_order_acq_rel);
+        return CG_SUCCESS;
+    }
+
+    CG_GL_FRAME_RECORD &record = timer->Pending[slot];
+    record.FrameIndex   = timer->FrameIndex++;
+    record.InputTime    = input_time;
+    record.SubmitTime   = submit_time;
+    record.PresentTime  = present_time;
+    record.CompleteTime = 0;
+    record.FrameTicks   = timer->LastPresent != 0 ? present_time - timer->LastPresent : 0;
+    timer->LastPresent  = present_time;
+    timer->PendingCount++;
+
+    // bound latency by waiting for the device to catch up to the frame limit.
+    size_t limit = CG_OPENGL_FRAME_MAX_IN_FLIGHT - 1;
+    if (timer->MaxFramesInFlight > 0 && timer->MaxFramesInFlight < limit)
+        limit = timer->MaxFramesInFlight;
+    while (timer->PendingCount > limit)
+    {
+        if (!cgGlFrameTimerRetire(display, timer, false))
+        {   // the oldest frame is still being rendered.
+            cgGlFrameTimerRetire(display, timer, true);
+            timer->WaitCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    timer->InFlight.store(timer->PendingCount, std::memory_order_relaxed);
+    timer->PresentCount.store(timer->FrameIndex, std::memory_order_release);
+    return CG_SUCCESS;
+}
+
+/// @summary Limit the number of presented frames the device may still be rendering when cgPresentDisplayEXT returns. 
+/// Lower limits reduce the delay between sampling input and displaying its result, at the cost of overlap between host and device work.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param display_handle The display whose presentation is paced.
+/// @param max_in_flight The maximum number of unfinished frames, or 0 to only limit by the internal tracking capacity.
+/// @return CG_SUCCESS, CG_INVALID_VALUE or CG_OUT_OF_MEMORY.
+library_function int
+cgSetFramePacingEXT
+(
+    uintptr_t   context, 
+    cg_handle_t display_handle, 
+    size_t      max_in_flight
+)
+{
+    CG_CONTEXT        *ctx     = (CG_CONTEXT*) context;
+    CG_DISPLAY        *display =  cgObjectTableGet(&ctx->DisplayTable, display_handle);
+    CG_GL_FRAME_TIMER *timer   =  NULL;
+    if (display == NULL)
+    {   // the display handle is invalid.
+        return CG_INVALID_VALUE;
+    }
+    if ((timer = cgFrameTimerAcquire(ctx, display)) == NULL)
+    {   // unable to allocate the frame timer.
+        return CG_OUT_OF_MEMORY;
+    }
+    timer->MaxFramesInFlight = max_in_flight;
+    return CG_SUCCESS;
+}
+
+/// @summary Record that input was sampled for the next frame presented on a display. If several marks are made before 
+/// the frame is presented, the oldest is kept, so the reported latency covers the input that waited longest.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param display_handle The display that will present the frame reflecting the input.
+/// @return CG_SUCCESS, CG_INVALID_VALUE or CG_OUT_OF_MEMORY.
+library_function int
+cgMarkFrameInputEXT
+(
+    uintptr_t   context, 
+    cg_handle_t display_handle
+)
+{
+    CG_CONTEXT        *ctx     = (CG_CONTEXT*) context;
+    CG_DISPLAY        *display =  cgObjectTableGet(&ctx->DisplayTable, display_handle);
+    CG_GL_FRAME_TIMER *timer   =  NULL;
+    if (display == NULL)
+    {   // the display handle is invalid.
+        return CG_INVALID_VALUE;
+    }
+    if ((timer = cgFrameTimerAcquire(ctx, display)) == NULL)
+    {   // unable to allocate the frame timer.
+        return CG_OUT_OF_MEMORY;
+    }
+    int64_t expected = 0;
+    timer->InputTime.compare_exchange_strong(expected, cgFrameTimestamp(), std::memory_order_acq_rel);
+    return CG_SUCCESS;
+}
+
+/// @summary Compute frame time and latency percentiles for a display over the most recent finished frames. The history 
+/// ring is read without blocking the presenting thread; records overwritten during the read are skipped.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param display_handle The display to query.
+/// @param stats On return, stores the frame pacing and latency statistics. All fields are zero if no frame has been presented.
+/// @return CG_SUCCESS or CG_INVALID_VALUE.
+library_function int
+cgGetFrameStatsEXT
+(
+    uintptr_t             context, 
+    cg_handle_t           display_handle, 
+    cg_frame_stats_ext_t *stats
+)
+{
+    CG_CONTEXT        *ctx     = (CG_CONTEXT*) context;
+    CG_DISPLAY        *display =  cgObjectTableGet(&ctx->DisplayTable, display_handle);
+    CG_GL_FRAME_TIMER *timer   =  NULL;
+    if (display == NULL || stats == NULL)
+    {   // the display handle is invalid, or there's nowhere to store the result.
+        return CG_INVALID_VALUE;
+    }
+    memset(stats, 0, sizeof(cg_frame_stats_ext_t));
+    if ((timer = (CG_GL_FRAME_TIMER*) InterlockedCompareExchangePointer((PVOID volatile*) &display->FrameTimer, NULL, NULL)) == NULL)
+    {   // no frame has been presented or paced on this display.
+        return CG_SUCCESS;
+    }
+
+    int64_t  frame_ticks [CG_OPENGL_FRAME_HISTORY_SIZE];
+    int64_t  device_ticks[CG_OPENGL_FRAME_HISTORY_SIZE];
+    int64_t  input_ticks [CG_OPENGL_FRAME_HISTORY_SIZE];
+    size_t   frame_count  = 0;
+    size_t   device_count = 0;
+    size_t   input_count  = 0;
+    uint64_t history_end  = timer->HistoryCount.load(std::memory_order_acquire);
+    uint64_t history_beg  = history_end > CG_OPENGL_FRAME_HISTORY_SIZE ? history_end - CG_OPENGL_FRAME_HISTORY_SIZE : 0;
+    for (uint64_t i = history_beg; i < history_end; ++i)
+    {
+        CG_GL_FRAME_SLOT  &slot = timer->History[i & (CG_OPENGL_FRAME_HISTORY_SIZE - 1)];
+        CG_GL_FRAME_RECORD record;
+        if (slot.Sequence.load(std::memory_order_acquire) != i)
+            continue; // the slot is being overwritten by a newer frame.
+        record = slot.Record;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.Sequence.load(std::memory_order_relaxed) != i)
+            continue; // the slot was overwritten while it was being copied.
+
+        if (record.FrameTicks > 0)
+            frame_ticks[frame_count++] = record.FrameTicks;
+        if (record.CompleteTime >= record.SubmitTime)
+            device_ticks[device_count++] = record.CompleteTime - record.SubmitTime;
+        if (record.InputTime != 0 && record.PresentTime >= record.InputTime)
+            input_ticks[input_count++] = record.PresentTime - record.InputTime;
+    }
+    qsort(frame_ticks , frame_count , sizeof(int64_t), cgFrameCompareDuration);
+    qsort(device_ticks, device_count, sizeof(int64_t), cgFrameCompareDuration);
+    qsort(input_ticks , input_count , sizeof(int64_t), cgFrameCompareDuration);
+
+    stats->FrameCount     = timer->PresentCount.load(std::memory_order_acquire);
+    stats->PacingWaits    = timer->WaitCount.load(std::memory_order_relaxed);
+    stats->FramesInFlight = timer->InFlight.load(std::memory_order_relaxed);
+    stats->SampleCount    = device_count;
+    stats->InputSamples   = input_count;
+    stats->FrameTimeP50   = cgFramePercentile(frame_ticks , frame_count , 50, timer->Frequency);
+    stats->FrameTimeP99   = cgFramePercentile(frame_ticks , frame_count , 99, timer->Frequency);
+    stats->DeviceTimeP50  = cgFramePercentile(device_ticks, device_count, 50, timer->Frequency);
+    stats->DeviceTimeP99  = cgFramePercentile(device_ticks, device_count, 99, timer->Frequency);
+    stats->InputTimeP50   = cgFramePercentile(input_ticks , input_count , 50, timer->Frequency);
+    stats->InputTimeP99   = cgFramePercentile(input_ticks , input_count , 99, timer->Frequency);
+    return CG_SUCCESS;
+}
@@ -1,5 +1,7 @@
 /*/////////////////////////////////////////////////////////////////////////////
-/// @summary Implements the test compute kernels.
+/// @summary Implements the test compute kernels, the generic compute pipeline,
+/// which binds kernel arguments by name, the parallel primitives pipeline and
+/// the image processing pipeline.
 ///////////////////////////////////////////////////////////////////////////80*/
 
 /*////////////////////
@@ -19,18 +21,1980 @@
 /*/////////////////
 //   Constants   //
 /////////////////*/
+/// @summary Define the maximum number of mipmap levels the IMAGE pipeline can generate, enough for a 32768x32768 image.
+#define CG_IMAGE_PIPELINE_MAX_LEVELS    (16)
 
 /*///////////////////
 //   Local Types   //
 ///////////////////*/
+/// @summary Defines the packed representation of a single argument binding within a GENERIC dispatch command.
+/// For VALUE arguments, DataSize bytes of argument data immediately follow the record, padded to an 8-byte boundary.
+struct CG_COMPUTE_GENERIC_ARG
+{
+    uint32_t                     Name;                 /// The argument name hash, as computed by cgHashName.
+    uint16_t                     Type;                 /// One of cg_compute_argument_type_e.
+    uint16_t                     DataSize;             /// The number of value bytes following the record, or the local memory size.
+    cg_handle_t                  Object;               /// The handle of the buffer, image or sampler object, or CG_INVALID_HANDLE.
+};
+
+/// @summary Defines the work group configuration used by the PRIMITIVES pipeline on a single device.
+/// Each work group processes a tile of GroupSize * ItemsPerThread elements.
+struct CG_PRIMITIVES_DEVICE
+{
+    size_t                       GroupSize;            /// The number of work items in each work group. A power of two, at least 16.
+    size_t                       ItemsPerThread;       /// The number of elements processed serially by each work item.
+};
+
+/// @summary Defines the private state of the PRIMITIVES compute pipeline. All kernels are created from the same program.
+struct CG_PRIMITIVES_STATE
+{
+    size_t                       AllocSize;            /// The number of bytes allocated for the state, including the device list.
+    cl_kernel                    Reduce[CG_COMPUTE_PRIMITIVE_TYPE_COUNT][CG_COMPUTE_PRIMITIVE_OP_COUNT]; /// Reduction kernels indexed by element type and operator.
+    cl_kernel                    CountNonZero;         /// Counts the non-zero flags in each tile.
+    cl_kernel                    ScanTiles;            /// Scans each tile, adding an optional per-tile offset.
+    cl_kernel                    CompactTiles;         /// Scatters the flagged values of each tile and writes the total count.
+    cl_kernel                    RadixCount;           /// Computes the 16-bin digit histogram of each tile.
+    cl_kernel                    RadixScatter;         /// Performs a stable scatter of each tile by digit.
+    cl_mem                       Scratch;              /// Intermediate storage for tile sums, histograms and sort ping-pong buffers.
+    size_t                       ScratchSize;          /// The size of the scratch buffer, in bytes.
+    cl_event                     ScratchBusy;          /// Signaled when the most recent command using the scratch buffer completes, or NULL.
+    size_t                       DeviceCount;          /// The number of devices in the pipeline execution group.
+    CG_PRIMITIVES_DEVICE        *Devices;              /// The work group configuration for each device, stored immediately after the state.
+};
+
+/// @summary Tracks the state of a single PRIMITIVES command while its kernels are being enqueued.
+/// Each kernel waits on the previous one through the Chain event, so the commands work on in-order and out-of-order queues.
+struct CG_PRIMITIVES_CHAIN
+{
+    CG_PRIMITIVES_STATE         *State;                /// The pipeline private state.
+    cl_command_queue             Queue;                /// The OpenCL command queue kernels are submitted to.
+    size_t                       GroupSize;            /// The work group size on the target device.
+    size_t                       ItemsPerThread;       /// The number of elements per work item on the target device.
+    cl_event                     Chain;                /// The event signaled by the most recently enqueued command.
+    size_t                       MemRefCount;          /// The number of valid entries in MemRefs.
+    cl_mem                       MemRefs[4];           /// The memory objects acquired for the command.
+};
+
+/// @summary Define the ways the IMAGE pipeline kernels read and write texels, based on the image channel data type.
+enum CG_IMAGE_TEXEL_KIND
+{
+    CG_IMAGE_TEXEL_FLOAT             = 0,              /// Normalized or floating-point data, accessed with read_imagef and write_imagef.
+    CG_IMAGE_TEXEL_UINT              = 1,              /// Unsigned integer data, accessed with read_imageui and write_imageui.
+    CG_IMAGE_TEXEL_SINT              = 2,              /// Signed integer data, accessed with read_imagei and write_imagei.
+    CG_IMAGE_TEXEL_KIND_COUNT
+};
+
+/// @summary Defines the private state of the IMAGE compute pipeline.
+struct CG_IMAGE_PIPELINE_STATE
+{
+    cl_kernel                    ResampleH[CG_IMAGE_TEXEL_KIND_COUNT]; /// Horizontal pass kernels, reading the source image, indexed by texel kind.
+    cl_kernel                    ResampleV[CG_IMAGE_TEXEL_KIND_COUNT]; /// Vertical pass kernels, writing the target image, indexed by texel kind.
+    cl_mem                       Temp;                 /// A linear RGBA float image holding the output of the horizontal pass, or NULL.
+    size_t                       TempWidth;            /// The width of the temporary image, in pixels.
+    size_t                       TempHeight;           /// The height of the temporary image, in pixels.
+    cl_event                     TempBusy;             /// Signaled when the most recent command using the temporary image completes, or NULL.
+};
+
+/// @summary Describes a single level of an image being read or written by the IMAGE pipeline.
+struct CG_IMAGE_LEVEL
+{
+    cl_mem                       Memory;               /// The OpenCL image object for the level.
+    size_t                       Width;                /// The width of the level, in pixels.
+    size_t                       Height;               /// The height of the level, in pixels.
+    int                          Kind;                 /// One of CG_IMAGE_TEXEL_KIND.
+    cl_uint                      SRGB;                 /// Non-zero if the kernel must convert between sRGB and linear itself.
+};
+
+/// @summary Tracks the state of a single IMAGE pipeline command while its kernels are being enqueued.
+struct CG_IMAGE_CHAIN
+{
+    CG_IMAGE_PIPELINE_STATE     *State;                /// The pipeline private state.
+    cl_command_queue             Queue;                /// The OpenCL command queue kernels are submitted to.
+    cl_event                     Chain;                /// The event signaled by the most recently enqueued command.
+    size_t                       MemRefCount;          /// The number of valid entries in MemRefs.
+    cl_mem                       MemRefs[CG_IMAGE_PIPELINE_MAX_LEVELS]; /// The shared memory objects acquired for the command.
+};
+
+/*///////////////
+//   Globals   //
+///////////////*/
+
+/*///////////////////////
+//   Local Functions   //
+///////////////////////*/
+/// @summary Calculate the number of bytes required to store a packed argument record in a GENERIC dispatch command.
+/// @param type One of cg_compute_argument_type_e.
+/// @param data_size The DataSize value of the argument.
+/// @return The size of the packed record, in bytes.
+internal_function inline size_t
+cgComputeGenericArgSize
+(
+    uint16_t type, 
+    uint16_t data_size
+)
+{
+    if (type == CG_COMPUTE_ARGUMENT_VALUE)
+        return sizeof(CG_COMPUTE_GENERIC_ARG) + ((size_t(data_size) + 7) & ~size_t(7));
+    else
+        return sizeof(CG_COMPUTE_GENERIC_ARG);
+}
+
+/// @summary Search the reflected argument table of a compute pipeline for a named argument.
+/// @param pipeline The compute pipeline to search.
+/// @param name The argument name hash, as computed by cgHashName.
+/// @return The reflected argument information, or NULL if the kernel has no argument with the specified name.
+internal_function inline CG_CL_KERNEL_ARG*
+cgComputeFindArgument
+(
+    CG_COMPUTE_PIPELINE *pipeline, 
+    uint32_t             name
+)
+{
+    uint32_t const *names = pipeline->ArgumentNames;
+    for (size_t i = 0, n = pipeline->ArgumentCount; i < n; ++i)
+    {
+        if (names[i] == name)
+            return &pipeline->Arguments[i];
+    }
+    return NULL;
+}
+
+/// @summary Convert the result of clEnqueueNDRangeKernel into a CGFX result code.
+/// @param cl_res The OpenCL result code.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_COMPILE_FAILED, CG_BAD_CLCONTEXT, CG_OUT_OF_MEMORY or CG_ERROR.
+internal_function int
+cgComputeEnqueueResult
+(
+    cl_int cl_res
+)
+{
+    switch (cl_res)
+    {
+    case CL_SUCCESS                      : return CG_SUCCESS;
+    case CL_INVALID_PROGRAM_EXECUTABLE   : return CG_COMPILE_FAILED;
+    case CL_INVALID_COMMAND_QUEUE        : return CG_BAD_CLCONTEXT;
+    case CL_INVALID_KERNEL               : return CG_INVALID_VALUE;
+    case CL_INVALID_CONTEXT              : return CG_BAD_CLCONTEXT;
+    case CL_INVALID_KERNEL_ARGS          : return CG_INVALID_VALUE;
+    case CL_INVALID_WORK_DIMENSION       : return CG_INVALID_VALUE;
+    case CL_INVALID_WORK_GROUP_SIZE      : return CG_INVALID_VALUE;
+    case CL_INVALID_WORK_ITEM_SIZE       : return CG_INVALID_VALUE;
+    case CL_INVALID_GLOBAL_OFFSET        : return CG_INVALID_VALUE;
+    case CL_INVALID_EVENT_WAIT_LIST      : return CG_INVALID_VALUE;
+    case CL_OUT_OF_RESOURCES             : return CG_OUT_OF_MEMORY;
+    case CL_MEM_OBJECT_ALLOCATION_FAILURE: return CG_OUT_OF_MEMORY;
+    case CL_OUT_OF_HOST_MEMORY           : return CG_OUT_OF_MEMORY;
+    default                              : return CG_ERROR;
+    }
+}
+
+/// @summary Set an argument of an OpenCL kernel unless setting an earlier argument failed, so that a sequence of arguments can be checked once.
+/// @param arg_res The accumulated result. If CL_SUCCESS on entry, it is set to the value returned by clSetKernelArg.
+/// @param kernel The OpenCL kernel object.
+/// @param index The zero-based index of the argument.
+/// @param size The size of the argument value, in bytes, or the size of a __local argument.
+/// @param value A pointer to the argument value, or NULL for a __local argument.
+internal_function inline void
+cgComputeSetArg
+(
+    cl_int     &arg_res, 
+    cl_kernel   kernel, 
+    cl_uint     index, 
+    size_t      size, 
+    void const *value
+)
+{
+    if (arg_res == CL_SUCCESS)
+        arg_res  = clSetKernelArg(kernel, index, size, value);
+}
+
+/// @summary Compute the greatest common divisor of two non-zero values.
+/// @param a The first value.
+/// @param b The second value.
+/// @return The greatest common divisor of @a a and @a b.
+internal_function inline size_t
+cgComputeGcd
+(
+    size_t a, 
+    size_t b
+)
+{
+    while (b != 0)
+    {
+        size_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/// @summary Update the measured throughput of each device from the profiling events of earlier split dispatches. 
+/// Events that have not yet completed are left pending, so this never blocks.
+/// @param pipeline The compute pipeline being dispatched. The Throughput array must be allocated.
+/// @return true if every device of the pipeline has a throughput measurement.
+internal_function bool
+cgComputeUpdateThroughput
+(
+    CG_COMPUTE_PIPELINE *pipeline
+)
+{
+    bool measured = true;
+    for (size_t i = 0, n = pipeline->DeviceCount; i < n; ++i)
+    {
+        CG_CL_DEVICE_THROUGHPUT &tp = pipeline->Throughput[i];
+        if (tp.PendingEvent != NULL)
+        {
+            cl_int   status = CL_QUEUED;
+            cl_ulong t0     = 0;
+            cl_ulong t1     = 0;
+            clGetEventInfo(tp.PendingEvent, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(cl_int), &status, NULL);
+            if (status <= CL_COMPLETE)
+            {   // the part has finished executing (or failed); sample it and retire the event.
+                if (status == CL_COMPLETE && 
+                    clGetEventProfilingInfo(tp.PendingEvent, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &t0, NULL) == CL_SUCCESS && 
+                    clGetEventProfilingInfo(tp.PendingEvent, CL_PROFILING_COMMAND_END  , sizeof(cl_ulong), &t1, NULL) == CL_SUCCESS && t1 > t0)
+                {   // smooth the measurement so one noisy dispatch doesn't skew the split.
+                    double rate = double(tp.PendingItems) / double(t1 - t0);
+                    tp.ItemsPerNano = (tp.ItemsPerNano > 0.0) ? (tp.ItemsPerNano * 0.75 + rate * 0.25) : rate;
+                }
+                clReleaseEvent(tp.PendingEvent);
+                tp.PendingEvent = NULL;
+                tp.PendingItems = 0;
+            }
+        }
+        if (tp.ItemsPerNano <= 0.0)
+            measured = false;
+    }
+    return measured;
+}
+
+/// @summary Retrieve the relative weight of a device when splitting a dispatch across an execution group.
+/// @param pipeline The compute pipeline being dispatched.
+/// @param device_index The zero-based index of the device within the pipeline's device list.
+/// @param measured Specify true to use measured throughput, or false to estimate it from the device capabilities.
+/// @return The relative weight of the device.
+internal_function inline double
+cgComputeDeviceWeight
+(
+    CG_COMPUTE_PIPELINE *pipeline, 
+    size_t               device_index, 
+    bool                 measured
+)
+{
+    if (measured)
+    {   // measured throughput accounts for architecture differences between CPUs and GPUs.
+        return pipeline->Throughput[device_index].ItemsPerNano;
+    }
+    CL_DEVICE_CAPS const &caps = pipeline->DeviceList[device_index]->Capabilities;
+    double units = caps.ComputeUnits   > 0 ? double(caps.ComputeUnits)   : 1.0;
+    double clock = caps.ClockFrequency > 0 ? double(caps.ClockFrequency) : 1.0;
+    return units * clock;
+}
+
+/// @summary Enqueue a GENERIC dispatch split across every device of the pipeline's execution group. The global range is 
+/// partitioned along one dimension in proportion to each device's weight, and each part is enqueued on the compute queue 
+/// of its device with a global offset, so kernels observe the same global IDs as an unsplit dispatch.
+/// @param ctx The CGFX context that owns the pipeline.
+/// @param pipeline The compute pipeline being dispatched. Kernel arguments must already be set.
+/// @param ddp The dispatch parameters.
+/// @param wait_count The number of events in @a wait_list.
+/// @param wait_list The OpenCL events each part must wait on, or NULL.
+/// @param part_done An array of pipeline->DeviceCount events. On return, stores the completion event of each enqueued part.
+/// @param part_count On return, set to the number of events written to @a part_done.
+/// @return CG_SUCCESS, CG_OUT_OF_MEMORY, CG_INVALID_VALUE if the global range is not a whole number of work groups in every dimension, or the reason a part could not be enqueued. Parts enqueued before a failure are still returned in @a part_done.
+internal_function int
+cgComputeEnqueueSplit
+(
+    CG_CONTEXT                             *ctx, 
+    CG_COMPUTE_PIPELINE                    *pipeline, 
+    cg_compute_pipeline_generic_dispatch_t *ddp, 
+    cl_uint                                 wait_count, 
+    cl_event                               *wait_list, 
+    cl_event                               *part_done, 
+    size_t                                 &part_count
+)
+{
+    size_t const dim_count    = ddp->WorkDimension;
+    size_t const device_count = pipeline->DeviceCount;
+    size_t       grain[3]     = { 1, 1, 1 };
+    size_t       units        = 0;
+    size_t       split_dim    = 0;
+    size_t       work_items   = 1;
+    double       total_weight = 0.0;
+    bool         measured     = false;
+
+    part_count = 0;
+    if (pipeline->Throughput == NULL)
+    {   // allocate throughput tracking on the first split dispatch.
+        if ((pipeline->Throughput = (CG_CL_DEVICE_THROUGHPUT*) cgAllocateHostMemory(&ctx->HostAllocator, device_count * sizeof(CG_CL_DEVICE_THROUGHPUT), 0, CG_ALLOCATION_TYPE_OBJECT)) == NULL)
+            return CG_OUT_OF_MEMORY;
+        memset(pipeline->Throughput, 0, device_count * sizeof(CG_CL_DEVICE_THROUGHPUT));
+    }
+    measured = cgComputeUpdateThroughput(pipeline);
+
+    // each part must be a whole number of work groups on every device.
+    for (size_t d = 0; d < dim_count; ++d)
+    {
+        if (ddp->LocalSize[0] != 0)
+        {
+            grain[d] = ddp->LocalSize[d];
+        }
+        else for (size_t i = 0; i < device_count; ++i)
+        {
+            size_t fixed = pipeline->DeviceKernelInfo[i].FixedGroupSize[d];
+            if (fixed != 0) grain[d] = (grain[d] / cgComputeGcd(grain[d], fixed)) * fixed;
+        }
+        if (ddp->GlobalSize[d] % grain[d] != 0)
+        {   // reject uneven ranges before any part is enqueued; the last part could not be a whole number of work groups.
+            return CG_INVALID_VALUE;
+        }
+        work_items *= ddp->GlobalSize[d];
+    }
+    // split along the slowest-varying dimension that has enough work groups for every device.
+    for (size_t d = dim_count; d > 0; --d)
+    {
+        size_t n = ddp->GlobalSize[d-1] / grain[d-1];
+        if (n > units || units < device_count)
+        {
+            split_dim = d - 1;
+            units     = n;
+        }
+        if (units >= device_count)
+            break;
+    }
+    for (size_t i = 0; i < device_count; ++i)
+    {
+        total_weight += cgComputeDeviceWeight(pipeline, i, measured);
+    }
+
+    double cumulative = 0.0;
+    size_t first_unit = 0;
+    for (size_t i = 0; i < device_count; ++i)
+    {
+        CG_QUEUE *queue = pipeline->ComputeQueues[i];
+        size_t    offset[3] = { 0, 0, 0 };
+        size_t    gsz[3];
+        size_t    lsz[3];
+        size_t   *lszp = NULL;
+        size_t    last_unit;
+        cl_event  cl_done = NULL;
+        cl_int    cl_res  = CL_SUCCESS;
+
+        cumulative += cgComputeDeviceWeight(pipeline, i, measured);
+        last_unit   = (i == device_count - 1) ? units : size_t(double(units) * (cumulative / total_weight) + 0.5);
+        if (last_unit < first_unit)
+            last_unit = first_unit;
+
+        for (size_t d = 0; d < 3; ++d)
+        {
+            gsz[d] = (d < dim_count) ? ddp->GlobalSize[d] : 1;
+            lsz[d] = (ddp->LocalSize[0] != 0) ? ddp->LocalSize[d] : pipeline->DeviceKernelInfo[i].FixedGroupSize[d];
+        }
+        if (lsz[0] != 0)
+        {   // otherwise, let the runtime select the work group size.
+            lszp = lsz;
+        }
+        offset[split_dim] = first_unit * grain[split_dim];
+        gsz   [split_dim] =(last_unit  - first_unit) * grain[split_dim];
+        if (i == device_count - 1)
+        {   // the last part covers the remaining work groups.
+            gsz[split_dim] = ddp->GlobalSize[split_dim] - offset[split_dim];
+        }
+        first_unit = last_unit;
+        if (gsz[split_dim] == 0)
+            continue;
+
+        if ((cl_res = clEnqueueNDRangeKernel(queue->CommandQueue, pipeline->ComputeKernel, cl_uint(dim_count), offset, gsz, lszp, wait_count, wait_list, &cl_done)) != CL_SUCCESS)
+            return cgComputeEnqueueResult(cl_res);
+        part_done[part_count++] = cl_done;
+
+        if (pipeline->Throughput[i].PendingEvent == NULL)
+        {   // sample the throughput of this part once it completes.
+            clRetainEvent(cl_done);
+            pipeline->Throughput[i].PendingEvent = cl_done;
+            pipeline->Throughput[i].PendingItems =(work_items / ddp->GlobalSize[split_dim]) * gsz[split_dim];
+        }
+        clFlush(queue->CommandQueue);
+    }
+    return CG_SUCCESS;
+}
+
+/// @summary Implements the dispatch command for the GENERIC compute pipeline. Each packed argument is matched against the reflected kernel argument table by name hash, shared memory objects are acquired, and the kernel is enqueued.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX compute command queue.
+/// @param pipeline The CGFX pipeline object being executed.
+/// @param bdp The compute pipeline dispatch command data.
+/// @param split Specify true to split the dispatch across every device of the pipeline's execution group.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_COMPILE_FAILED, CG_BAD_CLCONTEXT, CG_OUT_OF_MEMORY, CG_ERROR or another result code.
+internal_function int
+cgExecuteComputeGenericDispatch
+(
+    CG_CONTEXT             *ctx, 
+    CG_QUEUE               *queue, 
+    CG_COMPUTE_PIPELINE    *pipeline, 
+    cg_pipeline_cmd_data_t *bdp, 
+    bool                    split
+)
+{
+    cg_compute_pipeline_generic_dispatch_t *ddp = (cg_compute_pipeline_generic_dispatch_t*) bdp->ArgsData;
+    uint8_t                     *argp = (uint8_t*) bdp->ArgsData + sizeof(cg_compute_pipeline_generic_dispatch_t);
+    uint8_t                     *arge = (uint8_t*) bdp->ArgsData + bdp->ArgsDataSize;
+    size_t   const        max_memrefs =  ddp->ArgumentCount;
+    size_t                   nmemrefs =  0;
+    cl_uint                  nwaitevt =  0;
+    cl_event                  acquire =  NULL;
+    cl_mem                   *memrefs =  NULL;
+    cl_event                   *parts =  NULL;
+    size_t                     nparts =  0;
+    size_t                       *lsz =  NULL;
+    CG_CL_WORKGROUP_TUNING    *timing =  NULL;
+    size_t                  tuned_lsz[3];
+    int                        result =  CG_SUCCESS;
+
+    if (max_memrefs > 0 && (memrefs = (cl_mem*) cgAllocateHostMemory(&ctx->HostAllocator, max_memrefs * sizeof(cl_mem), 0, CG_ALLOCATION_TYPE_TEMP)) == NULL)
+    {   // unable to allocate the memory object reference list.
+        return CG_OUT_OF_MEMORY;
+    }
+    if (split && (parts = (cl_event*) cgAllocateHostMemory(&ctx->HostAllocator, pipeline->DeviceCount * sizeof(cl_event), 0, CG_ALLOCATION_TYPE_TEMP)) == NULL)
+    {   // unable to allocate the part completion event list.
+        result = CG_OUT_OF_MEMORY;
+        goto cleanup;
+    }
+    for (uint32_t i = 0, n = ddp->ArgumentCount; i < n; ++i)
+    {
+        CG_COMPUTE_GENERIC_ARG *arg = (CG_COMPUTE_GENERIC_ARG*) argp;
+        CG_CL_KERNEL_ARG       *ref =  NULL;
+        cl_int               cl_res =  CL_SUCCESS;
+
+        if (argp + sizeof(CG_COMPUTE_GENERIC_ARG) > arge || (ref = cgComputeFindArgument(pipeline, arg->Name)) == NULL)
+        {   // the command data is malformed, or the kernel has no argument with this name.
+            result = CG_INVALID_VALUE;
+            goto cleanup;
+        }
+        switch (arg->Type)
+        {
+        case CG_COMPUTE_ARGUMENT_VALUE:
+            {
+                cl_res = clSetKernelArg(pipeline->ComputeKernel, ref->Index, size_t(arg->DataSize), argp + sizeof(CG_COMPUTE_GENERIC_ARG));
+            } break;
+        case CG_COMPUTE_ARGUMENT_BUFFER:
+            {
+                CG_BUFFER *buffer = cgObjectTableGet(&ctx->BufferTable, arg->Object);
+                if (buffer == NULL)
+                {
+                    result = CG_INVALID_VALUE;
+                    goto cleanup;
+                }
+                if ((result = cgMakeBufferResident(ctx, queue, buffer)) != CG_SUCCESS)
+                    goto cleanup;
+                cgMemRefListAddBuffer(buffer, memrefs, nmemrefs, max_memrefs, true);
+                cl_res = clSetKernelArg(pipeline->ComputeKernel, ref->Index, sizeof(cl_mem), &buffer->ComputeBuffer);
+            } break;
+        case CG_COMPUTE_ARGUMENT_IMAGE:
+            {
+                CG_IMAGE *image = cgObjectTableGet(&ctx->ImageTable, arg->Object);
+                if (image == NULL)
+                {
+                    result = CG_INVALID_VALUE;
+                    goto cleanup;
+                }
+                if ((result = cgMakeImageResident(ctx, queue, image)) != CG_SUCCESS)
+                    goto cleanup;
+                cgMemRefListAddImage(image, memrefs, nmemrefs, max_memrefs, true);
+                cl_res = clSetKernelArg(pipeline->ComputeKernel, ref->Index, sizeof(cl_mem), &image->ComputeImage);
+            } break;
+        case CG_COMPUTE_ARGUMENT_SAMPLER:
+            {
+                CG_SAMPLER *sampler = cgObjectTableGet(&ctx->SamplerTable, arg->Object);
+                if (sampler == NULL || sampler->ComputeSampler == NULL)
+                {
+                    result = CG_INVALID_VALUE;
+                    goto cleanup;
+                }
+                cl_res = clSetKernelArg(pipeline->ComputeKernel, ref->Index, sizeof(cl_sampler), &sampler->ComputeSampler);
+            } break;
+        case CG_COMPUTE_ARGUMENT_LOCAL:
+            {
+                if (ref->MemoryType != CL_KERNEL_ARG_ADDRESS_LOCAL)
+                {   // the reflected argument is not a __local pointer.
+                    result = CG_INVALID_VALUE;
+                    goto cleanup;
+                }
+                cl_res = clSetKernelArg(pipeline->ComputeKernel, ref->Index, size_t(arg->DataSize), NULL);
+            } break;
+        default:
+            result = CG_INVALID_VALUE;
+            goto cleanup;
+        }
+        if (cl_res != CL_SUCCESS)
+        {   // the argument value does not match the kernel signature.
+            switch (cl_res)
+            {
+            case CL_INVALID_KERNEL       : result = CG_INVALID_VALUE;  break;
+            case CL_INVALID_ARG_INDEX    : result = CG_INVALID_VALUE;  break;
+            case CL_INVALID_ARG_VALUE    : result = CG_INVALID_VALUE;  break;
+            case CL_INVALID_MEM_OBJECT   : result = CG_INVALID_VALUE;  break;
+            case CL_INVALID_SAMPLER      : result = CG_INVALID_VALUE;  break;
+            case CL_INVALID_ARG_SIZE     : result = CG_INVALID_VALUE;  break;
+            case CL_OUT_OF_RESOURCES     : result = CG_OUT_OF_MEMORY;  break;
+            case CL_OUT_OF_HOST_MEMORY   : result = CG_OUT_OF_MEMORY;  break;
+            default                      : result = CG_ERROR;          break;
+            }
+            goto cleanup;
+        }
+        argp += cgComputeGenericArgSize(arg->Type, arg->DataSize);
+    }
+    if (split)
+    {   // acquire shared objects on the submitting queue; every part waits on the acquire.
+        if ((result = cgAcquireMemoryObjects(ctx, queue, memrefs, nmemrefs, bdp->WaitEvent, &acquire, nwaitevt, 1)) == CG_SUCCESS)
+        {
+            if ((result = cgComputeEnqueueSplit(ctx, pipeline, ddp, nwaitevt, CG_OPENCL_WAIT_LIST(nwaitevt, &acquire), parts, nparts)) != CG_SUCCESS)
+            {   // join and discard the parts that were enqueued.
+                cgReleaseMemoryObjects(ctx, queue, memrefs, nmemrefs, parts, nparts, CG_INVALID_HANDLE);
+                goto cleanup;
+            }
+            // one completion event joins all of the parts.
+            result = cgReleaseMemoryObjects(ctx, queue, memrefs, nmemrefs, parts, nparts, bdp->CompleteEvent);
+        }
+        goto cleanup;
+    }
+    if (ddp->LocalSize[0] != 0)
+    {   // the caller specified the work group size.
+        lsz = ddp->LocalSize;
+    }
+    else if (cgSelectWorkGroupSize(ctx, queue, pipeline, ddp->WorkDimension, ddp->GlobalSize, tuned_lsz, &timing))
+    {   // use the required or autotuned work group size; otherwise, let the runtime select it.
+        lsz = tuned_lsz;
+    }
+    if ((result = cgAcquireMemoryObjects(ctx, queue, memrefs, nmemrefs, bdp->WaitEvent, &acquire, nwaitevt, 1)) == CL_SUCCESS)
+    {
+        cl_event cl_done = NULL;
+        cl_int   cl_res  = CL_SUCCESS;
+        cl_res = clEnqueueNDRangeKernel(queue->CommandQueue , pipeline->ComputeKernel, cl_uint(ddp->WorkDimension), NULL, ddp->GlobalSize, lsz, nwaitevt, CG_OPENCL_WAIT_LIST(nwaitevt, &acquire), &cl_done);
+        if (timing != NULL)
+        {   // an autotuning candidate was used; if it was rejected, retire it and fall back to the runtime's choice.
+            cgRecordWorkGroupTiming(timing, cl_res == CL_SUCCESS ? cl_done : NULL);
+            if (cl_res == CL_INVALID_WORK_GROUP_SIZE || cl_res == CL_OUT_OF_RESOURCES)
+                cl_res  = clEnqueueNDRangeKernel(queue->CommandQueue , pipeline->ComputeKernel, cl_uint(ddp->WorkDimension), NULL, ddp->GlobalSize, NULL, nwaitevt, CG_OPENCL_WAIT_LIST(nwaitevt, &acquire), &cl_done);
+        }
+        if (cl_res != CL_SUCCESS)
+        {   // the kernel could not be enqueued.
+            result = cgComputeEnqueueResult(cl_res);
+            cgReleaseMemoryObjects(ctx, queue, memrefs, nmemrefs, NULL, 0, CG_INVALID_HANDLE);
+            goto cleanup;
+        }
+        result = cgReleaseMemoryObjects(ctx, queue, memrefs, nmemrefs, &cl_done, 1, bdp->CompleteEvent);
+    }
+
+cleanup:
+    cgFreeHostMemory(&ctx->HostAllocator, parts  , pipeline->DeviceCount * sizeof(cl_event), 0, CG_ALLOCATION_TYPE_TEMP);
+    cgFreeHostMemory(&ctx->HostAllocator, memrefs, max_memrefs * sizeof(cl_mem), 0, CG_ALLOCATION_TYPE_TEMP);
+    return result;
+}
+
+/// @summary Primary command dispatch function for the GENERIC compute pipeline.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX compute command queue.
+/// @param cmdbuf The CGFX command buffer being submitted to the command queue.
+/// @param pipeline The CGFX pipeline object being executed.
+/// @param cmd The compute pipeline dispatch command data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_COMPILE_FAILED, CG_BAD_CLCONTEXT, CG_OUT_OF_MEMORY, CG_ERROR or another result code.
+internal_function int
+cgExecuteComputePipelineGeneric
+(
+    CG_CONTEXT    *ctx, 
+    CG_QUEUE      *queue, 
+    CG_CMD_BUFFER *cmdbuf,
+    CG_PIPELINE   *pipeline, 
+    cg_command_t  *cmd
+)
+{
+    int                     res =  CG_SUCCESS;
+    cg_pipeline_cmd_data_t *bdp = (cg_pipeline_cmd_data_t*) cmd->Data;
+    if (pipeline->PipelineType != CG_PIPELINE_TYPE_COMPUTE)
+    {   // the generic pipeline can only execute compute kernels.
+        return CG_INVALID_VALUE;
+    }
+    switch (bdp->PipelineCmd)
+    {
+    case CG_COMPUTE_GENERIC_CMD_DISPATCH:
+        res = cgExecuteComputeGenericDispatch(ctx, queue, &pipeline->Compute, bdp, false);
+        break;
+    case CG_COMPUTE_GENERIC_CMD_DISPATCH_SPLIT:
+        res = cgExecuteComputeGenericDispatch(ctx, queue, &pipeline->Compute, bdp, true);
+        break;
+    default:
+        res = CG_COMMAND_NOT_IMPLEMENTED;
+        break;
+    }
+    UNREFERENCED_PARAMETER(cmdbuf);
+    return res;
+}
+
+/// @summary Write a GENERIC compute pipeline dispatch command to a command buffer.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param cmd_buffer The handle of the command buffer to update.
+/// @param pipeline The handle of a compute pipeline object.
+/// @param command_id One of cg_compute_pipeline_generic_command_id_e.
+/// @param work_dim The number of work dimensions, in [1, 3].
+/// @param global_size An array of work_dim values specifying the global number of work items in each dimension.
+/// @param local_size An array of work_dim values specifying the work group size in each dimension, or NULL.
+/// @param num_args The number of argument bindings in @a args.
+/// @param args The set of argument bindings. VALUE argument data is copied into the command buffer.
+/// @param done_event The handle of the event to signal when the pipeline has finished executing, or CG_INVALID_HANDLE.
+/// @param wait_event The handle of the event to wait on before executing the kernel, or CG_INVALID_HANDLE.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_BUFFER_TOO_SMALL or another result code.
+internal_function int
+cgComputeGenericRecord
+(
+    uintptr_t                    context, 
+    cg_handle_t                  cmd_buffer, 
+    cg_handle_t                  pipeline,
+    uint16_t                     command_id, 
+    size_t                       work_dim, 
+    size_t const                *global_size, 
+    size_t const                *local_size, 
+    size_t                       num_args, 
+    cg_compute_argument_t const *args, 
+    cg_handle_t                  done_event, 
+    cg_handle_t                  wait_event
+)
+{
+    int           result    = CG_SUCCESS;
+    cg_command_t *cmd       = NULL;
+    size_t        args_size = sizeof(cg_compute_pipeline_generic_dispatch_t);
+    size_t        cmd_size  = 0;
+
+    if (work_dim < 1 || work_dim > 3 || global_size == NULL || (num_args > 0 && args == NULL))
+        return CG_INVALID_VALUE;
+    for (size_t i = 0; command_id == CG_COMPUTE_GENERIC_CMD_DISPATCH_SPLIT && i < work_dim; ++i)
+    {   // every part of a split dispatch must be a whole number of work groups.
+        if (global_size[i] == 0 || (local_size != NULL && (local_size[i] == 0 || global_size[i] % local_size[i] != 0)))
+            return CG_INVALID_VALUE;
+    }
+    for (size_t i = 0; i < num_args; ++i)
+    {
+        if (args[i].Type == CG_COMPUTE_ARGUMENT_VALUE && (args[i].Value == NULL || args[i].DataSize == 0))
+            return CG_INVALID_VALUE;
+        args_size += cgComputeGenericArgSize(args[i].Type, args[i].DataSize);
+    }
+    if ((cmd_size = sizeof(cg_pipeline_cmd_base_t) + args_size) > 0xFFFFU)
+    {   // command data sizes are limited to 16 bits.
+        return CG_INVALID_VALUE;
+    }
+    if ((result = cgCommandBufferMapAppend(context, cmd_buffer, cmd_size, &cmd)) != CG_SUCCESS)
+        return result;
+
+    cg_pipeline_cmd_data_t                 *bdp = (cg_pipeline_cmd_data_t                *) cmd->Data;
+    cg_compute_pipeline_generic_dispatch_t *ddp = (cg_compute_pipeline_generic_dispatch_t*) bdp->ArgsData;
+    uint8_t                               *argp = (uint8_t*) bdp->ArgsData + sizeof(cg_compute_pipeline_generic_dispatch_t);
+    cmd->CommandId         = CG_COMMAND_PIPELINE_DISPATCH;
+    cmd->DataSize          = uint16_t(cmd_size);
+    bdp->PipelineId        = CG_COMPUTE_PIPELINE_GENERIC;
+    bdp->PipelineCmd       = command_id;
+    bdp->ArgsDataSize      = uint16_t(args_size);
+    bdp->ReservedU16       = 0; // unused
+    bdp->WaitEvent         = wait_event;
+    bdp->CompleteEvent     = done_event;
+    bdp->Pipeline          = pipeline;
+    ddp->WorkDimension     = uint32_t(work_dim);
+    ddp->ArgumentCount     = uint32_t(num_args);
+    for (size_t i = 0; i < 3; ++i)
+    {
+        ddp->GlobalSize[i] = i < work_dim ? global_size[i] : 1;
+        ddp->LocalSize [i] = local_size != NULL ? (i < work_dim ? local_size[i] : 1) : 0;
+    }
+    for (size_t i = 0; i < num_args; ++i)
+    {
+        CG_COMPUTE_GENERIC_ARG *arg = (CG_COMPUTE_GENERIC_ARG*) argp;
+        arg->Name     = args[i].Name;
+        arg->Type     = args[i].Type;
+        arg->DataSize = args[i].DataSize;
+        arg->Object   = args[i].Object;
+        if (args[i].Type == CG_COMPUTE_ARGUMENT_VALUE)
+            memcpy(argp + sizeof(CG_COMPUTE_GENERIC_ARG), args[i].Value, args[i].DataSize);
+        argp += cgComputeGenericArgSize(args[i].Type, args[i].DataSize);
+    }
+    // any compute pipeline can be dispatched generically, so register on first use.
+    cgSetComputePipelineCallback(CG_COMPUTE_PIPELINE_GENERIC, cgExecuteComputePipelineGeneric);
+    return cgCommandBufferUnmapAppend(context, cmd_buffer, cmd_size);
+}
+
+/// @summary Calculate the number of tiles required to cover a range of elements for a PRIMITIVES command.
+/// @param chain The command state, specifying the work group configuration of the target device.
+/// @param count The number of elements.
+/// @return The number of tiles (work groups) required to process @a count elements.
+internal_function inline size_t
+cgPrimitivesTileCount
+(
+    CG_PRIMITIVES_CHAIN const &chain, 
+    size_t                     count
+)
+{
+    size_t tile = chain.GroupSize * chain.ItemsPerThread;
+    return (count + tile - 1) / tile;
+}
+
+/// @summary Calculate the number of 32-bit scratch elements required to scan a range of elements.
+/// The tile sums of each level of the scan are stored one after the other.
+/// @param chain The command state, specifying the work group configuration of the target device.
+/// @param count The number of elements to scan.
+/// @return The number of 32-bit scratch elements required.
+internal_function size_t
+cgPrimitivesScanScratch
+(
+    CG_PRIMITIVES_CHAIN const &chain, 
+    size_t                     count
+)
+{
+    size_t total = 0;
+    size_t tiles = cgPrimitivesTileCount(chain, count);
+    while (tiles > 1)
+    {
+        total += tiles;
+        tiles  = cgPrimitivesTileCount(chain, tiles);
+    }
+    return total;
+}
+
+/// @summary Enqueue a one-dimensional PRIMITIVES kernel that waits on the previous command in the chain.
+/// @param chain The command state. On success, the Chain event is replaced with the completion event of the kernel.
+/// @param kernel The OpenCL kernel to enqueue. All arguments must have been set.
+/// @param groups The number of work groups to launch.
+/// @return CG_SUCCESS or another result code.
+internal_function int
+cgPrimitivesEnqueue
+(
+    CG_PRIMITIVES_CHAIN &chain, 
+    cl_kernel            kernel, 
+    size_t               groups
+)
+{
+    cl_event cl_done = NULL;
+    cl_int   cl_res  = CL_SUCCESS;
+    size_t   gsz     = groups * chain.GroupSize;
+    size_t   lsz     = chain.GroupSize;
+    if ((cl_res = clEnqueueNDRangeKernel(chain.Queue, kernel, 1, NULL, &gsz, &lsz, 1, &chain.Chain, &cl_done)) != CL_SUCCESS)
+        return cgComputeEnqueueResult(cl_res);
+    clReleaseEvent(chain.Chain);
+    chain.Chain = cl_done;
+    return CG_SUCCESS;
+}
+
+/// @summary Enqueue a reduction kernel that writes one partial result per tile.
+/// @param chain The command state.
+/// @param kernel One of the Reduce kernels, or the CountNonZero kernel.
+/// @param src The buffer containing the input elements.
+/// @param src_offset The index of the first input element in @a src.
+/// @param count The number of input elements.
+/// @param dst The buffer receiving the per-tile results.
+/// @param dst_offset The index of the first output element in @a dst.
+/// @return CG_SUCCESS or another result code.
+internal_function int
+cgPrimitivesReduceTiles
+(
+    CG_PRIMITIVES_CHAIN &chain, 
+    cl_kernel            kernel, 
+    cl_mem               src, 
+    size_t               src_offset, 
+    size_t               count, 
+    cl_mem               dst, 
+    size_t               dst_offset
+)
+{
+    cl_uint in_off  = cl_uint(src_offset);
+    cl_uint n       = cl_uint(count);
+    cl_uint out_off = cl_uint(dst_offset);
+    cl_uint ipt     = cl_uint(chain.ItemsPerThread);
+    cl_int  arg_res = CL_SUCCESS;
+    cgComputeSetArg(arg_res, kernel, 0, sizeof(cl_mem) , &src);
+    cgComputeSetArg(arg_res, kernel, 1, sizeof(cl_uint), &in_off);
+    cgComputeSetArg(arg_res, kernel, 2, sizeof(cl_uint), &n);
+    cgComputeSetArg(arg_res, kernel, 3, sizeof(cl_mem) , &dst);
+    cgComputeSetArg(arg_res, kernel, 4, sizeof(cl_uint), &out_off);
+    cgComputeSetArg(arg_res, kernel, 5, sizeof(cl_uint), &ipt);
+    cgComputeSetArg(arg_res, kernel, 6, chain.GroupSize * sizeof(cl_uint), NULL);
+    if (arg_res != CL_SUCCESS)
+        return CG_INVALID_VALUE;
+    return cgPrimitivesEnqueue(chain, kernel, cgPrimitivesTileCount(chain, count));
+}
+
+/// @summary Enqueue the kernels to compute the prefix sum of a range of 32-bit integers. Ranges spanning more than 
+/// one tile are scanned in three steps: the sum of each tile is computed, the tile sums are scanned recursively, 
+/// and each tile is then scanned starting from its offset.
+/// @param chain The command state.
+/// @param src The buffer containing the input elements.
+/// @param src_offset The index of the first input element in @a src.
+/// @param dst The buffer receiving the prefix sums. May be the same as @a src.
+/// @param dst_offset The index of the first output element in @a dst.
+/// @param count The number of elements to scan.
+/// @param inclusive true to compute an inclusive scan, or false for an exclusive scan.
+/// @param scratch_offset The index of the first free 32-bit element in the scratch buffer.
+/// @return CG_SUCCESS or another result code.
+internal_function int
+cgPrimitivesScan
+(
+    CG_PRIMITIVES_CHAIN &chain, 
+    cl_mem               src, 
+    size_t               src_offset, 
+    cl_mem               dst, 
+    size_t               dst_offset, 
+    size_t               count, 
+    bool                 inclusive, 
+    size_t               scratch_offset
+)
+{
+    CG_PRIMITIVES_STATE *state  = chain.State;
+    cl_kernel            kernel = state->ScanTiles;
+    size_t               tiles  = cgPrimitivesTileCount(chain, count);
+    cl_uint              has_offsets = 0;
+    int                  result = CG_SUCCESS;
+    if (tiles > 1)
+    {   // compute the tile sums into scratch, then convert them into tile offsets.
+        if ((result = cgPrimitivesReduceTiles(chain, state->Reduce[CG_COMPUTE_PRIMITIVE_UINT32][CG_COMPUTE_PRIMITIVE_SUM], src, src_offset, count, state->Scratch, scratch_offset)) != CG_SUCCESS)
+            return result;
+        if ((result = cgPrimitivesScan(chain, state->Scratch, scratch_offset, state->Scratch, scratch_offset, tiles, false, scratch_offset + tiles)) != CG_SUCCESS)
+            return result;
+        has_offsets = 1;
+    }
+    cl_uint in_off  = cl_uint(src_offset);
+    cl_uint out_off = cl_uint(dst_offset);
+    cl_uint n       = cl_uint(count);
+    cl_uint tbl_off = cl_uint(scratch_offset);
+    cl_uint ipt     = cl_uint(chain.ItemsPerThread);
+    cl_uint incl    = inclusive ? 1 : 0;
+    cl_int  arg_res = CL_SUCCESS;
+    cgComputeSetArg(arg_res, kernel, 0, sizeof(cl_mem) , &src);
+    cgComputeSetArg(arg_res, kernel, 1, sizeof(cl_uint), &in_off);
+    cgComputeSetArg(arg_res, kernel, 2, sizeof(cl_mem) , &dst);
+    cgComputeSetArg(arg_res, kernel, 3, sizeof(cl_uint), &out_off);
+    cgComputeSetArg(arg_res, kernel, 4, sizeof(cl_uint), &n);
+    cgComputeSetArg(arg_res, kernel, 5, sizeof(cl_mem) , &state->Scratch);
+    cgComputeSetArg(arg_res, kernel, 6, sizeof(cl_uint), &tbl_off);
+    cgComputeSetArg(arg_res, kernel, 7, sizeof(cl_uint), &has_offsets);
+    cgComputeSetArg(arg_res, kernel, 8, sizeof(cl_uint), &ipt);
+    cgComputeSetArg(arg_res, kernel, 9, sizeof(cl_uint), &incl);
+    cgComputeSetArg(arg_res, kernel, 10, chain.GroupSize * chain.ItemsPerThread * sizeof(cl_uint), NULL);
+    cgComputeSetArg(arg_res, kernel, 11, chain.GroupSize * sizeof(cl_uint), NULL);
+    if (arg_res != CL_SUCCESS)
+        return CG_INVALID_VALUE;
+    return cgPrimitivesEnqueue(chain, kernel, tiles);
+}
+
+/// @summary Select the work group configuration for the device a PRIMITIVES command is executing on.
+/// @param queue The CGFX compute command queue.
+/// @param pipeline The CGFX pipeline object being executed.
+/// @param chain The command state to initialize.
+/// @return CG_SUCCESS, or CG_INVALID_VALUE if the queue does not belong to the pipeline's execution group.
+internal_function int
+cgPrimitivesSelectDevice
+(
+    CG_QUEUE            *queue, 
+    CG_PIPELINE         *pipeline, 
+    CG_PRIMITIVES_CHAIN &chain
+)
+{
+    CG_COMPUTE_PIPELINE *cp    = &pipeline->Compute;
+    CG_PRIMITIVES_STATE *state = (CG_PRIMITIVES_STATE*) pipeline->PrivateState;
+    if (state == NULL || pipeline->PipelineType != CG_PIPELINE_TYPE_COMPUTE)
+        return CG_INVALID_VALUE;
+    for (size_t i = 0; i < cp->DeviceCount; ++i)
+    {
+        if (cp->ComputeQueues[i] == queue)
+        {
+            chain.State          = state;
+            chain.Queue          = queue->CommandQueue;
+            chain.GroupSize      = state->Devices[i].GroupSize;
+            chain.ItemsPerThread = state->Devices[i].ItemsPerThread;
+            chain.Chain          = NULL;
+            chain.MemRefCount    = 0;
+            return CG_SUCCESS;
+        }
+    }
+    return CG_INVALID_VALUE;
+}
+
+/// @summary Prepare to enqueue the kernels for a PRIMITIVES command. Grows the scratch buffer if necessary, 
+/// acquires shared buffers and starts the event chain.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX compute command queue.
+/// @param pipeline The CGFX compute pipeline being executed.
+/// @param bdp The compute pipeline dispatch command data.
+/// @param buffers The set of buffers referenced by the command. NULL entries are ignored.
+/// @param buffer_count The number of entries in @a buffers, at most four.
+/// @param scratch_elements The number of 32-bit scratch elements required by the command.
+/// @param chain The command state, initialized by cgPrimitivesSelectDevice.
+/// @return CG_SUCCESS or another result code. On failure, no event chain is started.
+internal_function int
+cgPrimitivesBegin
+(
+    CG_CONTEXT             *ctx, 
+    CG_QUEUE               *queue, 
+    CG_COMPUTE_PIPELINE    *cp, 
+    cg_pipeline_cmd_data_t *bdp, 
+    CG_BUFFER             **buffers, 
+    size_t                  buffer_count, 
+    size_t                  scratch_elements, 
+    CG_PRIMITIVES_CHAIN    &chain
+)
+{
+    CG_PRIMITIVES_STATE *state    = chain.State;
+    cl_event             waits[2];
+    cl_event             acquire  = NULL;
+    cl_uint              nwaitevt = 0;
+    cl_int               cl_res   = CL_SUCCESS;
+    int                  result   = CG_SUCCESS;
+
+    if (scratch_elements * sizeof(cl_uint) > state->ScratchSize)
+    {   // grow the scratch buffer. OpenCL defers freeing the old buffer until commands using it complete.
+        size_t const granularity = 1024 * 1024;
+        size_t       nbytes = ((scratch_elements * sizeof(cl_uint)) + (granularity - 1)) & ~(granularity - 1);
+        cl_mem       mem    = clCreateBuffer(cp->ComputeContext, CL_MEM_READ_WRITE, nbytes, NULL, &cl_res);
+        if (mem == NULL)
+            return CG_OUT_OF_MEMORY;
+        if (state->Scratch != NULL)
+            clReleaseMemObject(state->Scratch);
+        if (state->ScratchBusy != NULL)
+            clReleaseEvent(state->ScratchBusy);
+        state->Scratch     = mem;
+        state->ScratchSize = nbytes;
+        state->ScratchBusy = NULL;
+    }
+    for (size_t i = 0; i < buffer_count; ++i)
+    {
+        if (buffers[i] == NULL)
+            continue;
+        if ((result = cgMakeBufferResident(ctx, queue, buffers[i])) != CG_SUCCESS)
+            return result;
+        cgMemRefListAddBuffer(buffers[i], chain.MemRefs, chain.MemRefCount, 4, true);
+    }
+    if ((result = cgAcquireMemoryObjects(ctx, queue, chain.MemRefs, chain.MemRefCount, bdp->WaitEvent, &acquire, nwaitevt, 1)) != CG_SUCCESS)
+        return result;
+
+    // every kernel of the command waits on the previous one. the chain starts with a marker that waits on 
+    // the acquire, or the wait event if no buffers are shared, and on the previous command that used scratch.
+    if (acquire != NULL)
+    {
+        waits[0] = acquire;
+    }
+    else if (bdp->WaitEvent != CG_INVALID_HANDLE)
+    {
+        CG_EVENT *ev = cgObjectTableGet(&ctx->EventTable, bdp->WaitEvent);
+        if (ev != NULL && ev->ComputeEvent != NULL)
+            waits[nwaitevt++] = ev->ComputeEvent;
+    }
+    if (state->ScratchBusy != NULL)
+        waits[nwaitevt++] = state->ScratchBusy;
+    cl_res = clEnqueueMarkerWithWaitList(chain.Queue, nwaitevt, CG_OPENCL_WAIT_LIST(nwaitevt, waits), &chain.Chain);
+    if (acquire != NULL)
+        clReleaseEvent(acquire);
+    if (cl_res != CL_SUCCESS)
+    {
+        cgReleaseMemoryObjects(ctx, queue, chain.MemRefs, chain.MemRefCount, NULL, 0, CG_INVALID_HANDLE);
+        return cgComputeEnqueueResult(cl_res);
+    }
+    return CG_SUCCESS;
+}
+
+/// @summary Complete a PRIMITIVES command. Releases shared buffers and signals the completion event when the last kernel finishes.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX compute command queue.
+/// @param bdp The compute pipeline dispatch command data.
+/// @param chain The command state initialized by cgPrimitivesBegin.
+/// @param result The result of enqueueing the command kernels.
+/// @return The value @a result, or another result code if the completion event could not be set up.
+internal_function int
+cgPrimitivesEnd
+(
+    CG_CONTEXT             *ctx, 
+    CG_QUEUE               *queue, 
+    cg_pipeline_cmd_data_t *bdp, 
+    CG_PRIMITIVES_CHAIN    &chain, 
+    int                     result
+)
+{
+    CG_PRIMITIVES_STATE *state = chain.State;
+    size_t const         nwait = chain.Chain != NULL ? 1 : 0;
+    if (result != CG_SUCCESS)
+    {   // wait for the kernels that were enqueued before releasing the shared buffers.
+        cgReleaseMemoryObjects(ctx, queue, chain.MemRefs, chain.MemRefCount, CG_OPENCL_WAIT_LIST(nwait, &chain.Chain), nwait, CG_INVALID_HANDLE);
+        if (chain.MemRefCount > 0 && chain.Chain != NULL)
+        {   // releasing shared buffers waits on the chain without consuming it.
+            clReleaseEvent(chain.Chain);
+        }
+        chain.Chain = NULL;
+        return result;
+    }
+    // the next command to use the scratch buffer must wait for this one.
+    if (state->ScratchBusy != NULL)
+        clReleaseEvent(state->ScratchBusy);
+    clRetainEvent(chain.Chain);
+    state->ScratchBusy = chain.Chain;
+    result = cgReleaseMemoryObjects(ctx, queue, chain.MemRefs, chain.MemRefCount, &chain.Chain, 1, bdp->CompleteEvent);
+    if (chain.MemRefCount > 0)
+    {   // the completion event is the release command, so the chain is no longer referenced.
+        clReleaseEvent(chain.Chain);
+    }
+    chain.Chain = NULL;
+    return result;
+}
+
+/// @summary Look up a buffer referenced by a PRIMITIVES command and verify that it can hold a number of 32-bit elements.
+/// @param ctx The CGFX context that owns the buffer.
+/// @param handle The handle of the buffer object.
+/// @param count The number of 32-bit elements the buffer must hold.
+/// @return The buffer object, or NULL if the handle is invalid or the buffer is too small.
+internal_function inline CG_BUFFER*
+cgPrimitivesGetBuffer
+(
+    CG_CONTEXT  *ctx, 
+    cg_handle_t  handle, 
+    size_t       count
+)
+{
+    CG_BUFFER *buffer = cgObjectTableGet(&ctx->BufferTable, handle);
+    if (buffer == NULL || buffer->ComputeBuffer == NULL || buffer->RequestedSize < count * sizeof(cl_uint))
+        return NULL;
+    return buffer;
+}
+
+/// @summary Enqueue the kernels for a PRIMITIVES SCAN command.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX compute command queue.
+/// @param pipeline The CGFX pipeline object being executed.
+/// @param bdp The compute pipeline dispatch command data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_BAD_CLCONTEXT, CG_OUT_OF_MEMORY, CG_ERROR or another result code.
+internal_function int
+cgExecuteComputePrimitivesScan
+(
+    CG_CONTEXT             *ctx, 
+    CG_QUEUE               *queue, 
+    CG_PIPELINE            *pipeline, 
+    cg_pipeline_cmd_data_t *bdp
+)
+{
+    cg_compute_pipeline_primitives_scan_t *ddp = (cg_compute_pipeline_primitives_scan_t*) bdp->ArgsData;
+    CG_PRIMITIVES_CHAIN chain;
+    CG_BUFFER          *buffers[2];
+    int                 result = CG_SUCCESS;
+
+    buffers[0] = cgPrimitivesGetBuffer(ctx, ddp->InputBuffer , ddp->Count);
+    buffers[1] = cgPrimitivesGetBuffer(ctx, ddp->OutputBuffer, ddp->Count);
+    if (buffers[0] == NULL || buffers[1] == NULL)
+        return CG_INVALID_VALUE;
+    if (buffers[1] == buffers[0])
+        buffers[1] =  NULL;
+
+    if ((result = cgPrimitivesSelectDevice(queue, pipeline, chain)) != CG_SUCCESS)
+        return result;
+    if ((result = cgPrimitivesBegin(ctx, queue, &pipeline->Compute, bdp, buffers, 2, cgPrimitivesScanScratch(chain, ddp->Count), chain)) != CG_SUCCESS)
+        return result;
+    if (ddp->Count > 0)
+        result = cgPrimitivesScan(chain, buffers[0]->ComputeBuffer, 0, (buffers[1] != NULL ? buffers[1] : buffers[0])->ComputeBuffer, 0, ddp->Count, ddp->Inclusive != 0, 0);
+    return cgPrimitivesEnd(ctx, queue, bdp, chain, result);
+}
+
+/// @summary Enqueue the kernels for a PRIMITIVES REDUCE command. Each pass reduces every tile to a single value 
+/// until one value remains, which is written directly to the output buffer.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX compute command queue.
+/// @param pipeline The CGFX pipeline object being executed.
+/// @param bdp The compute pipeline dispatch command data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_BAD_CLCONTEXT, CG_OUT_OF_MEMORY, CG_ERROR or another result code.
+internal_function int
+cgExecuteComputePrimitivesReduce
+(
+    CG_CONTEXT             *ctx, 
+    CG_QUEUE               *queue, 
+    CG_PIPELINE            *pipeline, 
+    cg_pipeline_cmd_data_t *bdp
+)
+{
+    cg_compute_pipeline_primitives_reduce_t *ddp = (cg_compute_pipeline_primitives_reduce_t*) bdp->ArgsData;
+    CG_PRIMITIVES_CHAIN chain;
+    CG_BUFFER          *buffers[2];
+    int                 result = CG_SUCCESS;
+
+    if (ddp->DataType >= CG_COMPUTE_PRIMITIVE_TYPE_COUNT || ddp->Operation >= CG_COMPUTE_PRIMITIVE_OP_COUNT)
+        return CG_INVALID_VALUE;
+    buffers[0] = cgPrimitivesGetBuffer(ctx, ddp->InputBuffer , ddp->Count);
+    buffers[1] = cgPrimitivesGetBuffer(ctx, ddp->OutputBuffer, size_t(ddp->OutputIndex) + 1);
+    if (buffers[0] == NULL || buffers[1] == NULL)
+        return CG_INVALID_VALUE;
+    if (buffers[1] == buffers[0])
+        buffers[1] =  NULL;
+    if ((result = cgPrimitivesSelectDevice(queue, pipeline, chain)) != CG_SUCCESS)
+        return result;
+    if ((result = cgPrimitivesBegin(ctx, queue, &pipeline->Compute, bdp, buffers, 2, cgPrimitivesScanScratch(chain, ddp->Count), chain)) != CG_SUCCESS)
+        return result;
+
+    cl_kernel kernel  = chain.State->Reduce[ddp->DataType][ddp->Operation];
+    cl_mem    src     = buffers[0]->ComputeBuffer;
+    cl_mem    dst     =(buffers[1] != NULL ? buffers[1] : buffers[0])->ComputeBuffer;
+    size_t    src_off = 0;
+    size_t    tmp_off = 0;
+    size_t    count   = ddp->Count;
+    while (count > 0 && result == CG_SUCCESS)
+    {
+        size_t tiles  = cgPrimitivesTileCount(chain, count);
+        if (tiles == 1)
+        {   // the final pass writes the result to the output buffer.
+            result = cgPrimitivesReduceTiles(chain, kernel, src, src_off, count, dst, ddp->OutputIndex);
+            break;
+        }
+        result  = cgPrimitivesReduceTiles(chain, kernel, src, src_off, count, chain.State->Scratch, tmp_off);
+        src     = chain.State->Scratch;
+        src_off = tmp_off;
+        tmp_off+= tiles;
+        count   = tiles;
+    }
+    return cgPrimitivesEnd(ctx, queue, bdp, chain, result);
+}
+
+/// @summary Enqueue the kernels for a PRIMITIVES COMPACT command. The flags of each tile are counted, the counts are 
+/// scanned to produce the output offset of each tile, and each tile then scatters its flagged values. The last tile 
+/// also writes the total number of kept values.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX compute command queue.
+/// @param pipeline The CGFX pipeline object being executed.
+/// @param bdp The compute pipeline dispatch command data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_BAD_CLCONTEXT, CG_OUT_OF_MEMORY, CG_ERROR or another result code.
+internal_function int
+cgExecuteComputePrimitivesCompact
+(
+    CG_CONTEXT             *ctx, 
+    CG_QUEUE               *queue, 
+    CG_PIPELINE            *pipeline, 
+    cg_pipeline_cmd_data_t *bdp
+)
+{
+    cg_compute_pipeline_primitives_compact_t *ddp = (cg_compute_pipeline_primitives_compact_t*) bdp->ArgsData;
+    CG_PRIMITIVES_CHAIN chain;
+    CG_BUFFER          *buffers[4];
+    int                 result = CG_SUCCESS;
+
+    buffers[0] = cgPrimitivesGetBuffer(ctx, ddp->InputBuffer , ddp->Count);
+    buffers[1] = cgPrimitivesGetBuffer(ctx, ddp->FlagBuffer  , ddp->Count);
+    buffers[2] = cgPrimitivesGetBuffer(ctx, ddp->OutputBuffer, ddp->Count);
+    buffers[3] = cgPrimitivesGetBuffer(ctx, ddp->CountBuffer , 1);
+    if (buffers[0] == NULL || buffers[1] == NULL || buffers[2] == NULL || buffers[3] == NULL)
+        return CG_INVALID_VALUE;
+    if (buffers[2] == buffers[0] || buffers[2] == buffers[1])
+    {   // the output is written in a single pass, so it cannot alias the input.
+        return CG_INVALID_VALUE;
+    }
+    if ((result = cgPrimitivesSelectDevice(queue, pipeline, chain)) != CG_SUCCESS)
+        return result;
+    if ((result = cgPrimitivesBegin(ctx, queue, &pipeline->Compute, bdp, buffers, 4, cgPrimitivesScanScratch(chain, ddp->Count), chain)) != CG_SUCCESS)
+        return result;
+
+    CG_PRIMITIVES_STATE *state  = chain.State;
+    cl_kernel            kernel = state->CompactTiles;
+    size_t               tiles  = cgPrimitivesTileCount(chain, ddp->Count);
+    cl_uint              has_offsets = 0;
+    if (tiles > 1)
+    {   // count the kept values in each tile, and convert the counts into output offsets.
+        if ((result = cgPrimitivesReduceTiles(chain, state->CountNonZero, buffers[1]->ComputeBuffer, 0, ddp->Count, state->Scratch, 0)) == CG_SUCCESS)
+            result  = cgPrimitivesScan(chain, state->Scratch, 0, state->Scratch, 0, tiles, false, tiles);
+        has_offsets = 1;
+    }
+    if (result == CG_SUCCESS)
+    {
+        cl_uint n       = cl_uint(ddp->Count);
+        cl_uint tbl_off = 0;
+        cl_uint ipt     = cl_uint(chain.ItemsPerThread);
+        cl_int  arg_res = CL_SUCCESS;
+        cgComputeSetArg(arg_res, kernel, 0, sizeof(cl_mem) , &buffers[0]->ComputeBuffer);
+        cgComputeSetArg(arg_res, kernel, 1, sizeof(cl_mem) , &buffers[1]->ComputeBuffer);
+        cgComputeSetArg(arg_res, kernel, 2, sizeof(cl_mem) , &buffers[2]->ComputeBuffer);
+        cgComputeSetArg(arg_res, kernel, 3, sizeof(cl_mem) , &buffers[3]->ComputeBuffer);
+        cgComputeSetArg(arg_res, kernel, 4, sizeof(cl_uint), &n);
+        cgComputeSetArg(arg_res, kernel, 5, sizeof(cl_mem) , &state->Scratch);
+        cgComputeSetArg(arg_res, kernel, 6, sizeof(cl_uint), &tbl_off);
+        cgComputeSetArg(arg_res, kernel, 7, sizeof(cl_uint), &has_offsets);
+        cgComputeSetArg(arg_res, kernel, 8, sizeof(cl_uint), &ipt);
+        cgComputeSetArg(arg_res, kernel, 9, chain.GroupSize * chain.ItemsPerThread * sizeof(cl_uint), NULL);
+        cgComputeSetArg(arg_res, kernel, 10, chain.GroupSize * sizeof(cl_uint), NULL);
+        // a zero count still runs one group so that the count buffer is written.
+        if (arg_res != CL_SUCCESS)
+            result = CG_INVALID_VALUE;
+        else
+            result = cgPrimitivesEnqueue(chain, kernel, tiles > 0 ? tiles : 1);
+    }
+    return cgPrimitivesEnd(ctx, queue, bdp, chain, result);
+}
+
+/// @summary Enqueue the kernels for a PRIMITIVES SORT command. Implements a least-significant-digit radix sort 
+/// using 4-bit digits. Each pass builds a per-tile digit histogram, scans the histograms in digit-major order to 
+/// produce the output offset of each digit in each tile, and performs a stable scatter. Passes alternate between 
+/// the caller's buffers and the scratch buffer; after an odd number of passes the result is copied back.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX compute command queue.
+/// @param pipeline The CGFX pipeline object being executed.
+/// @param bdp The compute pipeline dispatch command data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_BAD_CLCONTEXT, CG_OUT_OF_MEMORY, CG_ERROR or another result code.
+internal_function int
+cgExecuteComputePrimitivesSort
+(
+    CG_CONTEXT             *ctx, 
+    CG_QUEUE               *queue, 
+    CG_PIPELINE            *pipeline, 
+    cg_pipeline_cmd_data_t *bdp
+)
+{
+    cg_compute_pipeline_primitives_sort_t *ddp = (cg_compute_pipeline_primitives_sort_t*) bdp->ArgsData;
+    CG_PRIMITIVES_CHAIN chain;
+    CG_BUFFER          *buffers[2];
+    int                 result = CG_SUCCESS;
+
+    if (ddp->KeyBits == 0 || ddp->KeyBits > 32)
+        return CG_INVALID_VALUE;
+    buffers[0] = cgPrimitivesGetBuffer(ctx, ddp->KeyBuffer, ddp->Count);
+    buffers[1] = NULL;
+    if (buffers[0] == NULL)
+        return CG_INVALID_VALUE;
+    if (ddp->ValueBuffer != CG_INVALID_HANDLE)
+    {
+        if ((buffers[1] = cgPrimitivesGetBuffer(ctx, ddp->ValueBuffer, ddp->Count)) == NULL)
+            return CG_INVALID_VALUE;
+        if (buffers[1] == buffers[0])
+            return CG_INVALID_VALUE;
+    }
+    if ((result = cgPrimitivesSelectDevice(queue, pipeline, chain)) != CG_SUCCESS)
+        return result;
+
+    // scratch layout: [keys][values][digit counts][scan tile sums].
+    size_t  const  count      = ddp->Count;
+    size_t  const  tiles      = cgPrimitivesTileCount(chain, count);
+    size_t  const  val_off    = count;
+    size_t  const  counts_off = buffers[1] != NULL ? count * 2 : count;
+    size_t  const  scan_off   = counts_off + tiles * 16;
+    size_t  const  passes     = (ddp->KeyBits + 3) / 4;
+    if ((result = cgPrimitivesBegin(ctx, queue, &pipeline->Compute, bdp, buffers, 2, scan_off + cgPrimitivesScanScratch(chain, tiles * 16), chain)) != CG_SUCCESS)
+        return result;
+    if (count < 2)
+        return cgPrimitivesEnd(ctx, queue, bdp, chain, result);
+
+    CG_PRIMITIVES_STATE *state  = chain.State;
+    cl_mem               keys[2]={ buffers[0]->ComputeBuffer, state->Scratch };
+    cl_mem               vals[2]={ buffers[1] != NULL ? buffers[1]->ComputeBuffer : buffers[0]->ComputeBuffer, state->Scratch };
+    cl_uint              koff[2]={ 0, 0 };
+    cl_uint              voff[2]={ 0, cl_uint(val_off) };
+    cl_uint              n      = cl_uint(count);
+    cl_uint              ipt    = cl_uint(chain.ItemsPerThread);
+    cl_uint              c_off  = cl_uint(counts_off);
+    cl_uint              has_values = buffers[1] != NULL ? 1 : 0;
+    for (size_t pass = 0; pass < passes && result == CG_SUCCESS; ++pass)
+    {
+        size_t  src   = pass & 1;
+        size_t  dst   = src ^ 1;
+        cl_uint shift = cl_uint(pass * 4);
+        cl_int  arg_res = CL_SUCCESS;
+
+        cgComputeSetArg(arg_res, state->RadixCount, 0, sizeof(cl_mem) , &keys[src]);
+        cgComputeSetArg(arg_res, state->RadixCount, 1, sizeof(cl_uint), &koff[src]);
+        cgComputeSetArg(arg_res, state->RadixCount, 2, sizeof(cl_uint), &n);
+        cgComputeSetArg(arg_res, state->RadixCount, 3, sizeof(cl_uint), &shift);
+        cgComputeSetArg(arg_res, state->RadixCount, 4, sizeof(cl_mem) , &state->Scratch);
+        cgComputeSetArg(arg_res, state->RadixCount, 5, sizeof(cl_uint), &c_off);
+        cgComputeSetArg(arg_res, state->RadixCount, 6, sizeof(cl_uint), &ipt);
+        cgComputeSetArg(arg_res, state->RadixCount, 7, 16 * sizeof(cl_uint), NULL);
+        if (arg_res != CL_SUCCESS)
+        {
+            result = CG_INVALID_VALUE;
+            break;
+        }
+        if ((result = cgPrimitivesEnqueue(chain, state->RadixCount, tiles)) != CG_SUCCESS)
+            break;
+        if ((result = cgPrimitivesScan(chain, state->Scratch, counts_off, state->Scratch, counts_off, tiles * 16, false, scan_off)) != CG_SUCCESS)
+            break;
+
+        cgComputeSetArg(arg_res, state->RadixScatter, 0, sizeof(cl_mem) , &keys[src]);
+        cgComputeSetArg(arg_res, state->RadixScatter, 1, sizeof(cl_uint), &koff[src]);
+        cgComputeSetArg(arg_res, state->RadixScatter, 2, sizeof(cl_mem) , &vals[src]);
+        cgComputeSetArg(arg_res, state->RadixScatter, 3, sizeof(cl_uint), &voff[src]);
+        cgComputeSetArg(arg_res, state->RadixScatter, 4, sizeof(cl_mem) , &keys[dst]);
+        cgComputeSetArg(arg_res, state->RadixScatter, 5, sizeof(cl_uint), &koff[dst]);
+        cgComputeSetArg(arg_res, state->RadixScatter, 6, sizeof(cl_mem) , &vals[dst]);
+        cgComputeSetArg(arg_res, state->RadixScatter, 7, sizeof(cl_uint), &voff[dst]);
+        cgComputeSetArg(arg_res, state->RadixScatter, 8, sizeof(cl_uint), &n);
+        cgComputeSetArg(arg_res, state->RadixScatter, 9, sizeof(cl_uint), &shift);
+        cgComputeSetArg(arg_res, state->RadixScatter, 10, sizeof(cl_mem) , &state->Scratch);
+        cgComputeSetArg(arg_res, state->RadixScatter, 11, sizeof(cl_uint), &c_off);
+        cgComputeSetArg(arg_res, state->RadixScatter, 12, sizeof(cl_uint), &ipt);
+        cgComputeSetArg(arg_res, state->RadixScatter, 13, sizeof(cl_uint), &has_values);
+        cgComputeSetArg(arg_res, state->RadixScatter, 14, chain.GroupSize * sizeof(cl_uint), NULL);
+        cgComputeSetArg(arg_res, state->RadixScatter, 15, chain.GroupSize * sizeof(cl_uint), NULL);
+        cgComputeSetArg(arg_res, state->RadixScatter, 16, chain.GroupSize * sizeof(cl_uint), NULL);
+        cgComputeSetArg(arg_res, state->RadixScatter, 17, 48 * sizeof(cl_uint), NULL);
+        if (arg_res != CL_SUCCESS)
+        {
+            result = CG_INVALID_VALUE;
+            break;
+        }
+        result = cgPrimitivesEnqueue(chain, state->RadixScatter, tiles);
+    }
+    if (result == CG_SUCCESS && (passes & 1) != 0)
+    {   // the sorted data is in the scratch buffer; copy it back to the caller's buffers.
+        cl_event copy_done[2] = { NULL, NULL };
+        cl_uint  copy_count   = 0;
+        cl_int   cl_res       = CL_SUCCESS;
+        if ((cl_res = clEnqueueCopyBuffer(chain.Queue, state->Scratch, keys[0], 0, 0, count * sizeof(cl_uint), 1, &chain.Chain, &copy_done[copy_count++])) == CL_SUCCESS && has_values)
+             cl_res = clEnqueueCopyBuffer(chain.Queue, state->Scratch, vals[0], val_off * sizeof(cl_uint), 0, count * sizeof(cl_uint), 1, &chain.Chain, &copy_done[copy_count++]);
+        if (cl_res == CL_SUCCESS)
+        {   // join the copies so the chain ends with a single event.
+            clReleaseEvent(chain.Chain); chain.Chain = NULL;
+            if (copy_count == 1)
+            {
+                chain.Chain  = copy_done[0];
+            }
+            else
+            {
+                cl_res = clEnqueueMarkerWithWaitList(chain.Queue, copy_count, copy_done, &chain.Chain);
+                clReleaseEvent(copy_done[0]);
+                clReleaseEvent(copy_done[1]);
+            }
+        }
+        else
+        {
+            for (cl_uint i = 0; i < copy_count; ++i)
+            {
+                if (copy_done[i] != NULL)
+                    clReleaseEvent(copy_done[i]);
+            }
+        }
+        if (cl_res != CL_SUCCESS)
+            result  = cgComputeEnqueueResult(cl_res);
+    }
+    return cgPrimitivesEnd(ctx, queue, bdp, chain, result);
+}
+
+/// @summary Primary command dispatch function for the PRIMITIVES compute pipeline.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX compute command queue.
+/// @param cmdbuf The CGFX command buffer being submitted to the command queue.
+/// @param pipeline The CGFX pipeline object being executed.
+/// @param cmd The compute pipeline dispatch command data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_BAD_CLCONTEXT, CG_OUT_OF_MEMORY, CG_ERROR or another result code.
+internal_function int
+cgExecuteComputePipelinePrimitives
+(
+    CG_CONTEXT    *ctx, 
+    CG_QUEUE      *queue, 
+    CG_CMD_BUFFER *cmdbuf,
+    CG_PIPELINE   *pipeline, 
+    cg_command_t  *cmd
+)
+{
+    int                     res =  CG_SUCCESS;
+    cg_pipeline_cmd_data_t *bdp = (cg_pipeline_cmd_data_t*) cmd->Data;
+    switch (bdp->PipelineCmd)
+    {
+    case CG_COMPUTE_PRIMITIVES_CMD_SCAN:
+        res = cgExecuteComputePrimitivesScan(ctx, queue, pipeline, bdp);
+        break;
+    case CG_COMPUTE_PRIMITIVES_CMD_REDUCE:
+        res = cgExecuteComputePrimitivesReduce(ctx, queue, pipeline, bdp);
+        break;
+    case CG_COMPUTE_PRIMITIVES_CMD_COMPACT:
+        res = cgExecuteComputePrimitivesCompact(ctx, queue, pipeline, bdp);
+        break;
+    case CG_COMPUTE_PRIMITIVES_CMD_SORT:
+        res = cgExecuteComputePrimitivesSort(ctx, queue, pipeline, bdp);
+        break;
+    default:
+        res = CG_COMMAND_NOT_IMPLEMENTED;
+        break;
+    }
+    UNREFERENCED_PARAMETER(cmdbuf);
+    return res;
+}
+
+/// @summary Frees all internal state associated with the PRIMITIVES compute pipeline.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param pipeline A pointer to the CG_PIPELINE object.
+/// @param opaque The opaque state data supplied when the pipeline was created.
+internal_function void
+cgTeardownComputePipelinePrimitives
+(
+    uintptr_t context, 
+    uintptr_t pipeline, 
+    void     *opaque
+)
+{
+    CG_CONTEXT          *ctx   = (CG_CONTEXT *) context;
+    CG_PIPELINE         *pipe  = (CG_PIPELINE*) pipeline;
+    CG_PRIMITIVES_STATE *state = (CG_PRIMITIVES_STATE*) opaque;
+    cl_kernel            kernels[5] =
+    {
+        state->CountNonZero, 
+        state->ScanTiles, 
+        state->CompactTiles, 
+        state->RadixCount, 
+        state->RadixScatter
+    };
+    for (size_t i = 0; i < CG_COMPUTE_PRIMITIVE_TYPE_COUNT; ++i)
+    {
+        for (size_t j = 0; j < CG_COMPUTE_PRIMITIVE_OP_COUNT; ++j)
+        {
+            if (state->Reduce[i][j] != NULL)
+                clReleaseKernel(state->Reduce[i][j]);
+        }
+    }
+    for (size_t i = 0; i < 5; ++i)
+    {
+        if (kernels[i] != NULL)
+            clReleaseKernel(kernels[i]);
+    }
+    if (state->ScratchBusy != NULL)
+        clReleaseEvent(state->ScratchBusy);
+    if (state->Scratch != NULL)
+        clReleaseMemObject(state->Scratch);
+    cgFreeHostMemory(&ctx->HostAllocator, state, state->AllocSize, 0, CG_ALLOCATION_TYPE_OBJECT);
+    UNREFERENCED_PARAMETER(pipe);
+}
+
+/// @summary Write a pipeline dispatch command with fixed-size arguments into a command buffer.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param cmd_buffer The handle of the command buffer to update.
+/// @param pipeline The handle of the compute pipeline object.
+/// @param pipeline_id One of cg_compute_pipeline_id_e identifying the pipeline implementation.
+/// @param command_id The pipeline-specific command identifier.
+/// @param args The command arguments.
+/// @param args_size The size of the command arguments, in bytes.
+/// @param done_event The handle of the event to signal when the command has finished executing, or CG_INVALID_HANDLE.
+/// @param wait_event The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+/// @return CG_SUCCESS or another result code.
+internal_function int
+cgComputePipelineRecord
+(
+    uintptr_t   context, 
+    cg_handle_t cmd_buffer, 
+    cg_handle_t pipeline, 
+    uint16_t    pipeline_id, 
+    uint16_t    command_id, 
+    void const *args, 
+    size_t      args_size, 
+    cg_handle_t done_event, 
+    cg_handle_t wait_event
+)
+{
+    int           result   = CG_SUCCESS;
+    cg_command_t *cmd      = NULL;
+    size_t const  cmd_size = sizeof(cg_pipeline_cmd_base_t) + args_size;
+    if ((result = cgCommandBufferMapAppend(context, cmd_buffer, cmd_size, &cmd)) != CG_SUCCESS)
+        return result;
+
+    cg_pipeline_cmd_data_t *bdp = (cg_pipeline_cmd_data_t*) cmd->Data;
+    cmd->CommandId         = CG_COMMAND_PIPELINE_DISPATCH;
+    cmd->DataSize          = uint16_t(cmd_size);
+    bdp->PipelineId        = pipeline_id;
+    bdp->PipelineCmd       = command_id;
+    bdp->ArgsDataSize      = uint16_t(args_size);
+    bdp->ReservedU16       = 0; // unused
+    bdp->WaitEvent         = wait_event;
+    bdp->CompleteEvent     = done_event;
+    bdp->Pipeline          = pipeline;
+    memcpy(bdp->ArgsData, args, args_size);
+    return cgCommandBufferUnmapAppend(context, cmd_buffer, cmd_size);
+}
+
+/// @summary Determine whether a DXGI format stores sRGB-encoded color data.
+/// @param dxgi_format One of dxgi_format_e or DXGI_FORMAT.
+/// @return true if the format is one of the sRGB formats.
+internal_function inline bool
+cgImageIsSRGBFormat
+(
+    uint32_t dxgi_format
+)
+{
+    switch (dxgi_format)
+    {
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        return true;
+    default:
+        break;
+    }
+    return false;
+}
+
+/// @summary Query the attributes of an OpenCL image object used by the IMAGE pipeline.
+/// @param image The CGFX image object the memory object belongs to.
+/// @param mem The OpenCL image object representing one level of @a image.
+/// @param level On return, describes the dimensions, texel kind and sRGB handling for the level.
+/// @return CG_SUCCESS, CG_INVALID_VALUE or CG_UNSUPPORTED if the image is not a 2D image.
+internal_function int
+cgImageDescribeLevel
+(
+    CG_IMAGE       *image, 
+    cl_mem          mem, 
+    CG_IMAGE_LEVEL &level
+)
+{
+    cl_mem_object_type type = 0;
+    cl_image_format    fmt;
+    if (clGetMemObjectInfo(mem, CL_MEM_TYPE, sizeof(type), &type, NULL) != CL_SUCCESS)
+        return CG_INVALID_VALUE;
+    if (type != CL_MEM_OBJECT_IMAGE2D)
+        return CG_UNSUPPORTED;
+    if (clGetImageInfo(mem, CL_IMAGE_FORMAT, sizeof(fmt)         , &fmt         , NULL) != CL_SUCCESS ||
+        clGetImageInfo(mem, CL_IMAGE_WIDTH , sizeof(level.Width) , &level.Width , NULL) != CL_SUCCESS ||
+        clGetImageInfo(mem, CL_IMAGE_HEIGHT, sizeof(level.Height), &level.Height, NULL) != CL_SUCCESS)
+        return CG_INVALID_VALUE;
+
+    switch (fmt.image_channel_data_type)
+    {
+    case CL_UNSIGNED_INT8 :
+    case CL_UNSIGNED_INT16:
+    case CL_UNSIGNED_INT32:
+        level.Kind = CG_IMAGE_TEXEL_UINT;
+        break;
+    case CL_SIGNED_INT8 :
+    case CL_SIGNED_INT16:
+    case CL_SIGNED_INT32:
+        level.Kind = CG_IMAGE_TEXEL_SINT;
+        break;
+    default:
+        level.Kind = CG_IMAGE_TEXEL_FLOAT;
+        break;
+    }
+    // filtering must happen on linear values. sRGB channel orders are converted by the runtime; 
+    // otherwise, sRGB data shared from OpenGL arrives as UNORM and the kernels convert it.
+    switch (fmt.image_channel_order)
+    {
+    case CL_sRGB :
+    case CL_sRGBx:
+    case CL_sRGBA:
+    case CL_sBGRA:
+        level.SRGB = 0;
+        break;
+    default:
+        level.SRGB = cgImageIsSRGBFormat(image->DxgiFormat) ? 1 : 0;
+        break;
+    }
+    level.Memory = mem;
+    return CG_SUCCESS;
+}
+
+/// @summary Ensure that the temporary image used between the horizontal and vertical passes is at least a given size.
+/// @param cl_ctx The OpenCL context of the pipeline.
+/// @param state The IMAGE pipeline private state.
+/// @param width The required width, in pixels.
+/// @param height The required height, in pixels.
+/// @return CG_SUCCESS, CG_OUT_OF_MEMORY or CG_UNSUPPORTED.
+internal_function int
+cgImageReserveTemp
+(
+    cl_context               cl_ctx, 
+    CG_IMAGE_PIPELINE_STATE *state, 
+    size_t                   width, 
+    size_t                   height
+)
+{
+    if (state->Temp != NULL && state->TempWidth >= width && state->TempHeight >= height)
+        return CG_SUCCESS;
+
+    cl_image_format fmt;
+    cl_image_desc   desc;
+    cl_mem          mem    = NULL;
+    cl_int          cl_res = CL_SUCCESS;
+    memset(&desc, 0, sizeof(desc));
+    fmt.image_channel_order     = CL_RGBA;
+    fmt.image_channel_data_type = CL_FLOAT;
+    desc.image_type             = CL_MEM_OBJECT_IMAGE2D;
+    desc.image_width            = width  > state->TempWidth  ? width  : state->TempWidth;
+    desc.image_height           = height > state->TempHeight ? height : state->TempHeight;
+    if ((mem = clCreateImage(cl_ctx, CL_MEM_READ_WRITE | CL_MEM_HOST_NO_ACCESS, &fmt, &desc, NULL, &cl_res)) == NULL)
+    {   // the image may exceed CL_DEVICE_IMAGE2D_MAX_WIDTH or HEIGHT.
+        return (cl_res == CL_INVALID_IMAGE_SIZE) ? CG_UNSUPPORTED : CG_OUT_OF_MEMORY;
+    }
+    // OpenCL defers freeing the old image until commands using it complete.
+    if (state->Temp != NULL)
+        clReleaseMemObject(state->Temp);
+    if (state->TempBusy != NULL)
+        clReleaseEvent(state->TempBusy);
+    state->Temp       = mem;
+    state->TempWidth  = desc.image_width;
+    state->TempHeight = desc.image_height;
+    state->TempBusy   = NULL;
+    return CG_SUCCESS;
+}
+
+/// @summary Acquire the shared images referenced by an IMAGE pipeline command and start the event chain. 
+/// The chain waits on the acquire, or the command wait event if no images are shared, and on the previous 
+/// command that used the temporary image.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX compute command queue.
+/// @param bdp The compute pipeline dispatch command data.
+/// @param chain The command state. State and MemRefs must have been initialized.
+/// @return CG_SUCCESS or another result code. On failure, no event chain is started.
+internal_function int
+cgImageBegin
+(
+    CG_CONTEXT             *ctx, 
+    CG_QUEUE               *queue, 
+    cg_pipeline_cmd_data_t *bdp, 
+    CG_IMAGE_CHAIN         &chain
+)
+{
+    CG_IMAGE_PIPELINE_STATE *state    = chain.State;
+    cl_event                 waits[2];
+    cl_event                 acquire  = NULL;
+    cl_uint                  nwaitevt = 0;
+    cl_int                   cl_res   = CL_SUCCESS;
+    int                      result   = CG_SUCCESS;
+
+    chain.Queue = queue->CommandQueue;
+    chain.Chain = NULL;
+    if ((result = cgAcquireMemoryObjects(ctx, queue, chain.MemRefs, chain.MemRefCount, bdp->WaitEvent, &acquire, nwaitevt, 1)) != CG_SUCCESS)
+        return result;
+    if (acquire != NULL)
+    {
+        waits[0] = acquire;
+    }
+    else if (bdp->WaitEvent != CG_INVALID_HANDLE)
+    {
+        CG_EVENT *ev = cgObjectTableGet(&ctx->EventTable, bdp->WaitEvent);
+        if (ev != NULL && ev->ComputeEvent != NULL)
+            waits[nwaitevt++] = ev->ComputeEvent;
+    }
+    if (state->TempBusy != NULL)
+        waits[nwaitevt++] = state->TempBusy;
+    cl_res = clEnqueueMarkerWithWaitList(chain.Queue, nwaitevt, CG_OPENCL_WAIT_LIST(nwaitevt, waits), &chain.Chain);
+    if (acquire != NULL)
+        clReleaseEvent(acquire);
+    if (cl_res != CL_SUCCESS)
+    {
+        cgReleaseMemoryObjects(ctx, queue, chain.MemRefs, chain.MemRefCount, NULL, 0, CG_INVALID_HANDLE);
+        return cgComputeEnqueueResult(cl_res);
+    }
+    return CG_SUCCESS;
+}
+
+/// @summary Complete an IMAGE pipeline command. Releases shared images and signals the completion event when the last kernel finishes.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX compute command queue.
+/// @param bdp The compute pipeline dispatch command data.
+/// @param chain The command state initialized by cgImageBegin.
+/// @param result The result of enqueueing the command kernels.
+/// @return The value @a result, or another result code if the completion event could not be set up.
+internal_function int
+cgImageEnd
+(
+    CG_CONTEXT             *ctx, 
+    CG_QUEUE               *queue, 
+    cg_pipeline_cmd_data_t *bdp, 
+    CG_IMAGE_CHAIN         &chain, 
+    int                     result
+)
+{
+    CG_IMAGE_PIPELINE_STATE *state = chain.State;
+    if (result != CG_SUCCESS)
+    {   // wait for the kernels that were enqueued before releasing the shared images.
+        cgReleaseMemoryObjects(ctx, queue, chain.MemRefs, chain.MemRefCount, &chain.Chain, 1, CG_INVALID_HANDLE);
+        if (chain.MemRefCount > 0)
+        {   // releasing shared images waits on the chain without consuming it.
+            clReleaseEvent(chain.Chain);
+        }
+        chain.Chain = NULL;
+        return result;
+    }
+    // the next command to use the temporary image must wait for this one.
+    if (state->TempBusy != NULL)
+        clReleaseEvent(state->TempBusy);
+    clRetainEvent(chain.Chain);
+    state->TempBusy = chain.Chain;
+    result = cgReleaseMemoryObjects(ctx, queue, chain.MemRefs, chain.MemRefCount, &chain.Chain, 1, bdp->CompleteEvent);
+    if (chain.MemRefCount > 0)
+    {   // the completion event is the release command, so the chain is no longer referenced.
+        clReleaseEvent(chain.Chain);
+    }
+    chain.Chain = NULL;
+    return result;
+}
+
+/// @summary Enqueue a two-dimensional IMAGE pipeline kernel that waits on the previous command in the chain.
+/// @param chain The command state. On success, the Chain event is replaced with the completion event of the kernel.
+/// @param kernel The OpenCL kernel to enqueue. All arguments must have been set.
+/// @param width The number of work items in the X dimension.
+/// @param height The number of work items in the Y dimension.
+/// @return CG_SUCCESS or another result code.
+internal_function int
+cgImageEnqueue
+(
+    CG_IMAGE_CHAIN &chain, 
+    cl_kernel       kernel, 
+    size_t          width, 
+    size_t          height
+)
+{
+    cl_event cl_done = NULL;
+    cl_int   cl_res  = CL_SUCCESS;
+    size_t   gsz[2]  = { width, height };
+    if ((cl_res = clEnqueueNDRangeKernel(chain.Queue, kernel, 2, NULL, gsz, NULL, 1, &chain.Chain, &cl_done)) != CL_SUCCESS)
+        return cgComputeEnqueueResult(cl_res);
+    clReleaseEvent(chain.Chain);
+    chain.Chain = cl_done;
+    return CG_SUCCESS;
+}
+
+/// @summary Enqueue the horizontal and vertical passes that resample one image level into another. The horizontal 
+/// pass converts the source to linear RGBA float in the temporary image, so filtering is sRGB-correct for every format.
+/// @param chain The command state.
+/// @param src The source level.
+/// @param dst The destination level.
+/// @param filter One of cg_compute_image_filter_e, or CG_COMPUTE_IMAGE_FILTER_COUNT for a Gaussian.
+/// @param sigma The standard deviation of the Gaussian, in pixels. Ignored by other filters.
+/// @return CG_SUCCESS or another result code.
+internal_function int
+cgImageResample
+(
+    CG_IMAGE_CHAIN       &chain, 
+    CG_IMAGE_LEVEL const &src, 
+    CG_IMAGE_LEVEL const &dst, 
+    cl_uint               filter, 
+    float                 sigma
+)
+{
+    CG_IMAGE_PIPELINE_STATE *state  = chain.State;
+    cl_kernel                hk     = state->ResampleH[src.Kind];
+    cl_kernel                vk     = state->ResampleV[dst.Kind];
+    cl_uint                  dst_w  = cl_uint(dst.Width);
+    cl_uint                  src_h  = cl_uint(src.Height);
+    int                      result = CG_SUCCESS;
+
+    clSetKernelArg(hk, 0, sizeof(cl_mem) , &src.Memory);
+    clSetKernelArg(hk, 1, sizeof(cl_mem) , &state->Temp);
+    clSetKernelArg(hk, 2, sizeof(cl_uint), &dst_w);
+    clSetKernelArg(hk, 3, sizeof(cl_uint), &filter);
+    clSetKernelArg(hk, 4, sizeof(float)  , &sigma);
+    clSetKernelArg(hk, 5, sizeof(cl_uint), &src.SRGB);
+    if ((result = cgImageEnqueue(chain, hk, dst.Width, src.Height)) != CG_SUCCESS)
+        return result;
+
+    clSetKernelArg(vk, 0, sizeof(cl_mem) , &state->Temp);
+    clSetKernelArg(vk, 1, sizeof(cl_mem) , &dst.Memory);
+    clSetKernelArg(vk, 2, sizeof(cl_uint), &src_h);
+    clSetKernelArg(vk, 3, sizeof(cl_uint), &filter);
+    clSetKernelArg(vk, 4, sizeof(float)  , &sigma);
+    clSetKernelArg(vk, 5, sizeof(cl_uint), &dst.SRGB);
+    return cgImageEnqueue(chain, vk, dst.Width, dst.Height);
+}
+
+/// @summary Enqueue the kernels for an IMAGE GENERATE_MIPS command. Each level is filtered from the previous one. 
+/// OpenCL image objects expose a single level, so an image object is created for each level of the OpenGL texture.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX compute command queue.
+/// @param pipeline The CGFX pipeline object being executed.
+/// @param bdp The compute pipeline dispatch command data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_UNSUPPORTED, CG_BAD_CLCONTEXT, CG_OUT_OF_MEMORY, CG_ERROR or another result code.
+internal_function int
+cgExecuteComputeImageMips
+(
+    CG_CONTEXT             *ctx, 
+    CG_QUEUE               *queue, 
+    CG_PIPELINE            *pipeline, 
+    cg_pipeline_cmd_data_t *bdp
+)
+{
+    cg_compute_pipeline_image_mips_t *ddp = (cg_compute_pipeline_image_mips_t*) bdp->ArgsData;
+    CG_IMAGE       *image  = cgObjectTableGet(&ctx->ImageTable, ddp->Image);
+    CG_IMAGE_CHAIN  chain;
+    CG_IMAGE_LEVEL  levels[CG_IMAGE_PIPELINE_MAX_LEVELS];
+    size_t          nlevels= 0;
+    int             result = CG_SUCCESS;
+
+    if (image == NULL || ddp->Filter >= CG_COMPUTE_IMAGE_FILTER_COUNT)
+        return CG_INVALID_VALUE;
+    if (image->LevelCount > CG_IMAGE_PIPELINE_MAX_LEVELS)
+        return CG_UNSUPPORTED;
+    if (image->LevelCount > 1 && (image->GraphicsImage == 0 || image->DefaultTarget != GL_TEXTURE_2D))
+    {   // only OpenGL 2D textures have storage for more than one level.
+        return CG_UNSUPPORTED;
+    }
+    if ((result = cgMakeImageResident(ctx, queue, image)) != CG_SUCCESS)
+        return result;
+
+    chain.State       = (CG_IMAGE_PIPELINE_STATE*) pipeline->PrivateState;
+    chain.MemRefCount = 0;
+    for (size_t i = 0; i < image->LevelCount && image->LevelCount > 1; ++i)
+    {
+        cl_int cl_res = CL_SUCCESS;
+        cl_mem mem    = clCreateFromGLTexture(pipeline->Compute.ComputeContext, CL_MEM_READ_WRITE, GL_TEXTURE_2D, GLint(i), image->GraphicsImage, &cl_res);
+        if (mem == NULL)
+        {
+            switch (cl_res)
+            {
+            case CL_INVALID_CONTEXT                : result = CG_BAD_CLCONTEXT; break;
+            case CL_INVALID_GL_OBJECT              : result = CG_BAD_GLCONTEXT; break;
+            case CL_INVALID_IMAGE_FORMAT_DESCRIPTOR: result = CG_UNSUPPORTED;   break;
+            case CL_OUT_OF_RESOURCES               : result = CG_OUT_OF_MEMORY; break;
+            case CL_OUT_OF_HOST_MEMORY             : result = CG_OUT_OF_MEMORY; break;
+            default                                : result = CG_INVALID_VALUE; break;
+            }
+            goto cleanup;
+        }
+        chain.MemRefs[chain.MemRefCount++] = mem;
+        if ((result = cgImageDescribeLevel(image, mem, levels[nlevels++])) != CG_SUCCESS)
+            goto cleanup;
+    }
+    if (nlevels > 1 && (result = cgImageReserveTemp(pipeline->Compute.ComputeContext, chain.State, levels[1].Width, levels[0].Height)) != CG_SUCCESS)
+        goto cleanup;
+    if ((result = cgImageBegin(ctx, queue, bdp, chain)) != CG_SUCCESS)
+        goto cleanup;
+    for (size_t i = 1; i < nlevels && result == CG_SUCCESS; ++i)
+    {
+        result = cgImageResample(chain, levels[i-1], levels[i], ddp->Filter, 0.0f);
+    }
+    result = cgImageEnd(ctx, queue, bdp, chain, result);
+
+cleanup:
+    // the level objects are freed once the commands referencing them complete.
+    for (size_t i = 0; i < chain.MemRefCount; ++i)
+        clReleaseMemObject(chain.MemRefs[i]);
+    return result;
+}
+
+/// @summary Enqueue the kernels for an IMAGE BLUR or RESIZE command, which read level 0 of one image and write level 0 of another.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX compute command queue.
+/// @param pipeline The CGFX pipeline object being executed.
+/// @param bdp The compute pipeline dispatch command data.
+/// @param src_handle The handle of the source image.
+/// @param dst_handle The handle of the target image.
+/// @param filter One of cg_compute_image_filter_e, or CG_COMPUTE_IMAGE_FILTER_COUNT for a Gaussian.
+/// @param sigma The standard deviation of the Gaussian, in pixels.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_UNSUPPORTED, CG_BAD_CLCONTEXT, CG_OUT_OF_MEMORY, CG_ERROR or another result code.
+internal_function int
+cgExecuteComputeImageFilter
+(
+    CG_CONTEXT             *ctx, 
+    CG_QUEUE               *queue, 
+    CG_PIPELINE            *pipeline, 
+    cg_pipeline_cmd_data_t *bdp, 
+    cg_handle_t             src_handle, 
+    cg_handle_t             dst_handle, 
+    cl_uint                 filter, 
+    float                   sigma
+)
+{
+    CG_IMAGE       *src    = cgObjectTableGet(&ctx->ImageTable, src_handle);
+    CG_IMAGE       *dst    = cgObjectTableGet(&ctx->ImageTable, dst_handle);
+    CG_IMAGE_CHAIN  chain;
+    CG_IMAGE_LEVEL  src_level;
+    CG_IMAGE_LEVEL  dst_level;
+    int             result = CG_SUCCESS;
+
+    if (src == NULL || dst == NULL || src->ComputeImage == NULL || dst->ComputeImage == NULL)
+        return CG_INVALID_VALUE;
+    if ((src->KernelAccess & CG_MEMORY_ACCESS_READ) == 0 || (dst->KernelAccess & CG_MEMORY_ACCESS_WRITE) == 0)
+        return CG_INVALID_VALUE;
+    if ((result = cgImageDescribeLevel(src, src->ComputeImage, src_level)) != CG_SUCCESS)
+        return result;
+    if ((result = cgImageDescribeLevel(dst, dst->ComputeImage, dst_level)) != CG_SUCCESS)
+        return result;
+    if (filter == CG_COMPUTE_IMAGE_FILTER_COUNT && (src_level.Width != dst_level.Width || src_level.Height != dst_level.Height))
+        return CG_INVALID_VALUE;
+    if ((result = cgMakeImageResident(ctx, queue, src)) != CG_SUCCESS)
+        return result;
+    if ((result = cgMakeImageResident(ctx, queue, dst)) != CG_SUCCESS)
+        return result;
+    if ((result = cgImageReserveTemp(pipeline->Compute.ComputeContext, (CG_IMAGE_PIPELINE_STATE*) pipeline->PrivateState, dst_level.Width, src_level.Height)) != CG_SUCCESS)
+        return result;
+
+    chain.State       = (CG_IMAGE_PIPELINE_STATE*) pipeline->PrivateState;
+    chain.MemRefCount = 0;
+    cgMemRefListAddImage(src, chain.MemRefs, chain.MemRefCount, CG_IMAGE_PIPELINE_MAX_LEVELS, true);
+    cgMemRefListAddImage(dst, chain.MemRefs, chain.MemRefCount, CG_IMAGE_PIPELINE_MAX_LEVELS, true);
+    if ((result = cgImageBegin(ctx, queue, bdp, chain)) != CG_SUCCESS)
+        return result;
+    result = cgImageResample(chain, src_level, dst_level, filter, sigma);
+    return cgImageEnd(ctx, queue, bdp, chain, result);
+}
+
+/// @summary Primary command dispatch function for the IMAGE compute pipeline.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX compute command queue.
+/// @param cmdbuf The CGFX command buffer being submitted to the command queue.
+/// @param pipeline The CGFX pipeline object being executed.
+/// @param cmd The compute pipeline dispatch command data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_UNSUPPORTED, CG_BAD_CLCONTEXT, CG_OUT_OF_MEMORY, CG_ERROR or another result code.
+internal_function int
+cgExecuteComputePipelineImage
+(
+    CG_CONTEXT    *ctx, 
+    CG_QUEUE      *queue, 
+    CG_CMD_BUFFER *cmdbuf,
+    CG_PIPELINE   *pipeline, 
+    cg_command_t  *cmd
+)
+{
+    int                     res =  CG_SUCCESS;
+    cg_pipeline_cmd_data_t *bdp = (cg_pipeline_cmd_data_t*) cmd->Data;
+    if (pipeline->PrivateState == NULL || pipeline->PipelineType != CG_PIPELINE_TYPE_COMPUTE)
+        return CG_INVALID_VALUE;
+    switch (bdp->PipelineCmd)
+    {
+    case CG_COMPUTE_IMAGE_CMD_GENERATE_MIPS:
+        res = cgExecuteComputeImageMips(ctx, queue, pipeline, bdp);
+        break;
+    case CG_COMPUTE_IMAGE_CMD_BLUR:
+        {
+            cg_compute_pipeline_image_blur_t *ddp = (cg_compute_pipeline_image_blur_t*) bdp->ArgsData;
+            res = cgExecuteComputeImageFilter(ctx, queue, pipeline, bdp, ddp->SourceImage, ddp->TargetImage, CG_COMPUTE_IMAGE_FILTER_COUNT, ddp->Sigma);
+        }
+        break;
+    case CG_COMPUTE_IMAGE_CMD_RESIZE:
+        {
+            cg_compute_pipeline_image_resize_t *ddp = (cg_compute_pipeline_image_resize_t*) bdp->ArgsData;
+            if (ddp->Filter >= CG_COMPUTE_IMAGE_FILTER_COUNT)
+                res = CG_INVALID_VALUE;
+            else
+                res = cgExecuteComputeImageFilter(ctx, queue, pipeline, bdp, ddp->SourceImage, ddp->TargetImage, ddp->Filter, 0.0f);
+        }
+        break;
+    default:
+        res = CG_COMMAND_NOT_IMPLEMENTED;
+        break;
+    }
+    UNREFERENCED_PARAMETER(cmdbuf);
+    return res;
+}
 
-/*///////////////
-//   Globals   //
-///////////////*/
+/// @summary Frees all internal state associated with the IMAGE compute pipeline.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param pipeline A pointer to the CG_PIPELINE object.
+/// @param opaque The opaque state data supplied when the pipeline was created.
+internal_function void
+cgTeardownComputePipelineImage
+(
+    uintptr_t context, 
+    uintptr_t pipeline, 
+    void     *opaque
+)
+{
+    CG_CONTEXT              *ctx   = (CG_CONTEXT *) context;
+    CG_PIPELINE             *pipe  = (CG_PIPELINE*) pipeline;
+    CG_IMAGE_PIPELINE_STATE *state = (CG_IMAGE_PIPELINE_STATE*) opaque;
+    for (size_t i = 0; i < CG_IMAGE_TEXEL_KIND_COUNT; ++i)
+    {
+        if (state->ResampleH[i] != NULL) clReleaseKernel(state->ResampleH[i]);
+        if (state->ResampleV[i] != NULL) clReleaseKernel(state->ResampleV[i]);
+    }
+    if (state->TempBusy != NULL)
+        clReleaseEvent(state->TempBusy);
+    if (state->Temp != NULL)
+        clReleaseMemObject(state->Temp);
+    cgFreeHostMemory(&ctx->HostAllocator, state, sizeof(CG_IMAGE_PIPELINE_STATE), 0, CG_ALLOCATION_TYPE_OBJECT);
+    UNREFERENCED_PARAMETER(pipe);
+}
 
-/*///////////////////////
-//   Local Functions   //
-///////////////////////*/
 /// @summary Implements the setup, teardown and command submission code for the TEST01 compute pipeline.
 /// @param ctx The CGFX context defining the command queue.
 /// @param queue The CGFX compute command queue.
@@ -54,6 +2018,8 @@ cgExecuteComputeTest01Dispatch
     cl_uint                    nwaitevt =  0;
     cl_event                    acquire =  NULL;
     cl_mem                      memrefs[2];
+    if ((result = cgMakeBufferResident(ctx, queue, output)) != CG_SUCCESS)
+        return result;
     cgMemRefListAddBuffer(output, memrefs, nmemrefs, 1, false);
     if ((result = cgAcquireMemoryObjects(ctx, queue, memrefs, nmemrefs, bdp->WaitEvent, &acquire, nwaitevt, 1)) == CL_SUCCESS)
     {
@@ -157,6 +2123,7 @@ cgCreateComputePipelineTest01
     code.CodeSize      = strlen(kernel_code)+1;
     code.Type          = CG_KERNEL_TYPE_COMPUTE;
     code.Flags         = CG_KERNEL_FLAGS_SOURCE;
+    code.Options       = NULL;
     cg_handle_t kernel = cgCreateKernel(context, exec_group, &code, result);
     if (kernel == CG_INVALID_HANDLE)
     {
@@ -216,3 +2183,901 @@ cgComputeDispatchTest01
     ddp->OutputBuffer      = out_buffer;
     return cgCommandBufferUnmapAppend(context, cmd_buffer, cmd_size);
 }
+
+/// @summary Compute the name hash used to identify a kernel argument in a GENERIC compute pipeline dispatch. Applications should compute argument name hashes once, at startup, and reuse them for each dispatch.
+/// @param name A NULL-terminated ASCII string specifying the argument name as declared in the kernel source.
+/// @return The 32-bit argument name hash.
+library_function uint32_t
+cgComputeArgumentName
+(
+    char const *name
+)
+{
+    return cgHashName(name);
+}
+
+/// @summary Enqueue a COMPUTE_DISPATCH command for the GENERIC pipeline in a command buffer. Any compute pipeline can be dispatched this way; arguments are matched against the kernel's reflected argument table by name hash at execution time.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param cmd_buffer The handle of the command buffer to update.
+/// @param pipeline The handle of a compute pipeline object.
+/// @param work_dim The number of work dimensions, in [1, 3].
+/// @param global_size An array of work_dim values specifying the global number of work items in each dimension.
+/// @param local_size An array of work_dim values specifying the work group size in each dimension, or NULL to use the kernel's required size, the autotuned size (see cgSetComputePipelineAutotune) or the runtime's choice.
+/// @param num_args The number of argument bindings in @a args.
+/// @param args The set of argument bindings. VALUE argument data is copied into the command buffer. Arguments not bound keep the value last set on the pipeline's kernel, which is shared by every create call that returned the pipeline, so each dispatch should bind every argument.
+/// @param done_event The handle of the event to signal when the pipeline has finished executing, or CG_INVALID_HANDLE.
+/// @param wait_event The handle of the event to wait on before executing the kernel, or CG_INVALID_HANDLE.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_BUFFER_TOO_SMALL or another result code.
+library_function int
+cgComputeDispatch
+(
+    uintptr_t                    context, 
+    cg_handle_t                  cmd_buffer, 
+    cg_handle_t                  pipeline,
+    size_t                       work_dim, 
+    size_t const                *global_size, 
+    size_t const                *local_size, 
+    size_t                       num_args, 
+    cg_compute_argument_t const *args, 
+    cg_handle_t                  done_event, 
+    cg_handle_t                  wait_event
+)
+{
+    return cgComputeGenericRecord(context, cmd_buffer, pipeline, CG_COMPUTE_GENERIC_CMD_DISPATCH, work_dim, global_size, local_size, num_args, args, done_event, wait_event);
+}
+
+/// @summary Enqueue a COMPUTE_DISPATCH command for the GENERIC pipeline that splits the global range across every device of 
+/// the pipeline's execution group. The range is partitioned along its slowest-varying dimension in proportion to each 
+/// device's measured throughput, or to ComputeUnits * ClockFrequency until every device has been measured. Each part runs 
+/// with a global offset, so kernels see the same global IDs as an unsplit dispatch, and @a done_event is signaled when all 
+/// parts have completed. The kernel must not depend on get_global_offset being zero.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param cmd_buffer The handle of the command buffer to update.
+/// @param pipeline The handle of a compute pipeline object.
+/// @param work_dim The number of work dimensions, in [1, 3].
+/// @param global_size An array of work_dim values specifying the global number of work items in each dimension.
+/// @param local_size An array of work_dim values specifying the work group size in each dimension, or NULL to use the kernel's required size or the runtime's choice on each device.
+/// Each value of @a global_size must be a multiple of the work group size; otherwise, recording fails, or execution fails with CG_INVALID_VALUE if the size is required by the kernel.
+/// @param num_args The number of argument bindings in @a args.
+/// @param args The set of argument bindings. VALUE argument data is copied into the command buffer. Arguments not bound keep the value last set on the pipeline's kernel; see cgComputeDispatch.
+/// @param done_event The handle of the event to signal when every part has finished executing, or CG_INVALID_HANDLE.
+/// @param wait_event The handle of the event to wait on before executing the kernel, or CG_INVALID_HANDLE.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_BUFFER_TOO_SMALL or another result code.
+library_function int
+cgComputeDispatchSplit
+(
+    uintptr_t                    context, 
+    cg_handle_t                  cmd_buffer, 
+    cg_handle_t                  pipeline,
+    size_t                       work_dim, 
+    size_t const                *global_size, 
+    size_t const                *local_size, 
+    size_t                       num_args, 
+    cg_compute_argument_t const *args, 
+    cg_handle_t                  done_event, 
+    cg_handle_t                  wait_event
+)
+{
+    return cgComputeGenericRecord(context, cmd_buffer, pipeline, CG_COMPUTE_GENERIC_CMD_DISPATCH_SPLIT, work_dim, global_size, local_size, num_args, args, done_event, wait_event);
+}
+
+/// @summary Compiles the kernels and allocates the state required to create the PRIMITIVES compute pipeline, which 
+/// implements scan, reduce, stream compaction and radix sort. The work group size and the number of elements processed 
+/// by each work item are selected per-device: GPUs use wide work groups with few elements per item to keep many groups 
+/// in flight, while CPUs use narrow groups with many elements per item, so most of the work is a serial loop.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param exec_group The CGFX execution group managing the set of devices the pipeline can execute on.
+/// @param result On return, set to CG_SUCCESS or another result code.
+/// @return The handle of the compute pipeline object, or CG_INVALID_HANDLE.
+library_function cg_handle_t
+cgCreateComputePipelinePrimitives
+(
+    uintptr_t   context, 
+    cg_handle_t exec_group, 
+    int        &result
+)
+{
+    static char const *kernel_code = 
+        "#define PRIM_SUM(a, b)  ((a) + (b))\n"
+        "#define PRIM_MIN(a, b)  min((a), (b))\n"
+        "#define PRIM_MAX(a, b)  max((a), (b))\n"
+        "#define PRIM_LOAD(x)    (x)\n"
+        "#define PRIM_NZ(x)      ((x) != 0 ? 1u : 0u)\n"
+        "\n"
+        "uint prim_wg_scan(uint v, __local uint *lds, uint *total)\n"
+        "{\n"
+        "    uint lid = get_local_id(0);\n"
+        "    uint lsz = get_local_size(0);\n"
+        "    lds[lid] = v;\n"
+        "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "    for (uint off = 1; off < lsz; off <<= 1)\n"
+        "    {\n"
+        "        uint t = (lid >= off) ? lds[lid - off] : 0;\n"
+        "        barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "        lds[lid] += t;\n"
+        "        barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "    }\n"
+        "    uint r = lds[lid] - v;\n"
+        "    *total = lds[lsz - 1];\n"
+        "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "    return r;\n"
+        "}\n"
+        "\n"
+        "#define PRIM_REDUCE(NAME, T, IDENT, OP, LOAD)                                                                  \\\n"
+        "__kernel void NAME(__global const T *in, uint in_off, uint n, __global T *out, uint out_off, uint ipt, __local T *lds) \\\n"
+        "{                                                                                                              \\\n"
+        "    uint lid  = get_local_id(0);                                                                               \\\n"
+        "    uint lsz  = get_local_size(0);                                                                             \\\n"
+        "    uint base = get_group_id(0) * lsz * ipt;                                                                   \\\n"
+        "    T    acc  = IDENT;                                                                                         \\\n"
+        "    for (uint k = 0; k < ipt; ++k)                                                                             \\\n"
+        "    {                                                                                                          \\\n"
+        "        uint i = base + k * lsz + lid;                                                                         \\\n"
+        "        if (i < n) acc = OP(acc, LOAD(in[in_off + i]));                                                        \\\n"
+        "    }                                                                                                          \\\n"
+        "    lds[lid] = acc;                                                                                            \\\n"
+        "    barrier(CLK_LOCAL_MEM_FENCE);                                                                              \\\n"
+        "    for (uint s = lsz >> 1; s > 0; s >>= 1)                                                                    \\\n"
+        "    {                                                                                                          \\\n"
+        "        if (lid < s) lds[lid] = OP(lds[lid], lds[lid + s]);                                                    \\\n"
+        "        barrier(CLK_LOCAL_MEM_FENCE);                                                                          \\\n"
+        "    }                                                                                                          \\\n"
+        "    if (lid == 0) out[out_off + get_group_id(0)] = lds[0];                                                     \\\n"
+        "}\n"
+        "\n"
+        "PRIM_REDUCE(prim_reduce_u32_sum, uint , 0u       , PRIM_SUM, PRIM_LOAD)\n"
+        "PRIM_REDUCE(prim_reduce_u32_min, uint , UINT_MAX , PRIM_MIN, PRIM_LOAD)\n"
+        "PRIM_REDUCE(prim_reduce_u32_max, uint , 0u       , PRIM_MAX, PRIM_LOAD)\n"
+        "PRIM_REDUCE(prim_reduce_i32_sum, int  , 0        , PRIM_SUM, PRIM_LOAD)\n"
+        "PRIM_REDUCE(prim_reduce_i32_min, int  , INT_MAX  , PRIM_MIN, PRIM_LOAD)\n"
+        "PRIM_REDUCE(prim_reduce_i32_max, int  , INT_MIN  , PRIM_MAX, PRIM_LOAD)\n"
+        "PRIM_REDUCE(prim_reduce_f32_sum, float, 0.0f     , PRIM_SUM, PRIM_LOAD)\n"
+        "PRIM_REDUCE(prim_reduce_f32_min, float, INFINITY , PRIM_MIN, PRIM_LOAD)\n"
+        "PRIM_REDUCE(prim_reduce_f32_max, float, -INFINITY, PRIM_MAX, PRIM_LOAD)\n"
+        "PRIM_REDUCE(prim_count_nonzero , uint , 0u       , PRIM_SUM, PRIM_NZ)\n"
+        "\n"
+        "__kernel void prim_scan_tiles(__global const uint *in, uint in_off, __global uint *out, uint out_off, uint n, __global const uint *offsets, uint offsets_off, uint has_offsets, uint ipt, uint inclusive, __local uint *tile, __local uint *lds)\n"
+        "{\n"
+        "    uint lid  = get_local_id(0);\n"
+        "    uint lsz  = get_local_size(0);\n"
+        "    uint base = get_group_id(0) * lsz * ipt;\n"
+        "    uint sum  = 0;\n"
+        "    uint total;\n"
+        "    for (uint k = 0; k < ipt; ++k)\n"
+        "    {\n"
+        "        uint i  = k * lsz + lid;\n"
+        "        tile[i] = (base + i < n) ? in[in_off + base + i] : 0;\n"
+        "    }\n"
+        "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "    for (uint k = 0; k < ipt; ++k)\n"
+        "        sum += tile[lid * ipt + k];\n"
+        "    uint run = prim_wg_scan(sum, lds, &total);\n"
+        "    if (has_offsets) run += offsets[offsets_off + get_group_id(0)];\n"
+        "    for (uint k = 0; k < ipt; ++k)\n"
+        "    {\n"
+        "        uint j  = lid * ipt + k;\n"
+        "        uint v  = tile[j];\n"
+        "        tile[j] = inclusive ? run + v : run;\n"
+        "        run    += v;\n"
+        "    }\n"
+        "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "    for (uint k = 0; k < ipt; ++k)\n"
+        "    {\n"
+        "        uint i = k * lsz + lid;\n"
+        "        if (base + i < n) out[out_off + base + i] = tile[i];\n"
+        "    }\n"
+        "}\n"
+        "\n"
+        "__kernel void prim_compact_tiles(__global const uint *in, __global const uint *flags, __global uint *out, __global uint *count, uint n, __global const uint *offsets, uint offsets_off, uint has_offsets, uint ipt, __local uint *tile, __local uint *lds)\n"
+        "{\n"
+        "    uint lid  = get_local_id(0);\n"
+        "    uint lsz  = get_local_size(0);\n"
+        "    uint base = get_group_id(0) * lsz * ipt;\n"
+        "    uint sum  = 0;\n"
+        "    uint total;\n"
+        "    for (uint k = 0; k < ipt; ++k)\n"
+        "    {\n"
+        "        uint i  = k * lsz + lid;\n"
+        "        tile[i] = (base + i < n && flags[base + i] != 0) ? 1 : 0;\n"
+        "    }\n"
+        "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "    for (uint k = 0; k < ipt; ++k)\n"
+        "        sum += tile[lid * ipt + k];\n"
+        "    uint tile_off = has_offsets ? offsets[offsets_off + get_group_id(0)] : 0;\n"
+        "    uint pos = prim_wg_scan(sum, lds, &total) + tile_off;\n"
+        "    for (uint k = 0; k < ipt; ++k)\n"
+        "    {\n"
+        "        uint j = lid * ipt + k;\n"
+        "        if (tile[j]) out[pos++] = in[base + j];\n"
+        "    }\n"
+        "    if (lid == 0 && get_group_id(0) == get_num_groups(0) - 1) count[0] = tile_off + total;\n"
+        "}\n"
+        "\n"
+        "__kernel void prim_radix_count(__global const uint *keys, uint keys_off, uint n, uint shift, __global uint *counts, uint counts_off, uint ipt, __local uint *hist)\n"
+        "{\n"
+        "    uint lid  = get_local_id(0);\n"
+        "    uint lsz  = get_local_size(0);\n"
+        "    uint grp  = get_group_id(0);\n"
+        "    uint base = grp * lsz * ipt;\n"
+        "    if (lid < 16) hist[lid] = 0;\n"
+        "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "    for (uint k = 0; k < ipt; ++k)\n"
+        "    {\n"
+        "        uint i = base + k * lsz + lid;\n"
+        "        if (i < n) atomic_inc(&hist[(keys[keys_off + i] >> shift) & 15]);\n"
+        "    }\n"
+        "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "    if (lid < 16) counts[counts_off + lid * get_num_groups(0) + grp] = hist[lid];\n"
+        "}\n"
+        "\n"
+        "__kernel void prim_radix_scatter(__global const uint *keys_in, uint keys_in_off, __global const uint *vals_in, uint vals_in_off, __global uint *keys_out, uint keys_out_off, __global uint *vals_out, uint vals_out_off, uint n, uint shift, __global const uint *offsets, uint offsets_off, uint ipt, uint has_values, __local uint *lds, __local uint *skey, __local uint *sval, __local uint *meta)\n"
+        "{\n"
+        "    uint lid  = get_local_id(0);\n"
+        "    uint lsz  = get_local_size(0);\n"
+        "    uint grp  = get_group_id(0);\n"
+        "    uint base = grp * lsz * ipt;\n"
+        "    /* meta[0..15] is the next output index for each digit, meta[16..31] and meta[32..47] the digit ranges within a chunk. */\n"
+        "    if (lid < 16) meta[lid] = offsets[offsets_off + lid * get_num_groups(0) + grp];\n"
+        "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "    for (uint k = 0; k < ipt; ++k)\n"
+        "    {\n"
+        "        uint first  = base + k * lsz;\n"
+        "        uint nvalid = first < n ? min(lsz, n - first) : 0;\n"
+        "        if (nvalid == 0) break;\n"
+        "        /* elements past the end get an all-ones key, so they sort after every valid element of the chunk. */\n"
+        "        uint key = (lid < nvalid) ? keys_in[keys_in_off + first + lid] : 0xFFFFFFFFu;\n"
+        "        uint val = (lid < nvalid && has_values) ? vals_in[vals_in_off + first + lid] : 0;\n"
+        "        for (uint b = 0; b < 4; ++b)\n"
+        "        {   /* stable split of the chunk on one bit of the digit. */\n"
+        "            uint total;\n"
+        "            uint bit  = (key >> (shift + b)) & 1;\n"
+        "            uint ones = prim_wg_scan(bit, lds, &total);\n"
+        "            uint dst  = bit ? (lsz - total) + ones : lid - ones;\n"
+        "            skey[dst] = key;\n"
+        "            sval[dst] = val;\n"
+        "            barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "            key = skey[lid];\n"
+        "            val = sval[lid];\n"
+        "            barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "        }\n"
+        "        uint digit = (key >> shift) & 15;\n"
+        "        if (lid < 16)\n"
+        "        {\n"
+        "            meta[16 + lid] = 0;\n"
+        "            meta[32 + lid] = 0;\n"
+        "        }\n"
+        "        barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "        if (lid < nvalid)\n"
+        "        {\n"
+        "            if (lid == 0 || ((skey[lid - 1] >> shift) & 15) != digit) meta[16 + digit] = lid;\n"
+        "            if (lid == nvalid - 1 || ((skey[lid + 1] >> shift) & 15) != digit) meta[32 + digit] = lid + 1;\n"
+        "        }\n"
+        "        barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "        if (lid < nvalid)\n"
+        "        {\n"
+        "            uint dst = meta[digit] + (lid - meta[16 + digit]);\n"
+        "            keys_out[keys_out_off + dst] = key;\n"
+        "            if (has_values) vals_out[vals_out_off + dst] = val;\n"
+        "        }\n"
+        "        barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "        if (lid < 16) meta[lid] += meta[32 + lid] - meta[16 + lid];\n"
+        "        barrier(CLK_LOCAL_MEM_FENCE);\n"
+        "    }\n"
+        "}\n";
+    static char const *reduce_names[CG_COMPUTE_PRIMITIVE_TYPE_COUNT][CG_COMPUTE_PRIMITIVE_OP_COUNT] = 
+    {
+        { "prim_reduce_u32_sum", "prim_reduce_u32_min", "prim_reduce_u32_max" }, 
+        { "prim_reduce_i32_sum", "prim_reduce_i32_min", "prim_reduce_i32_max" }, 
+        { "prim_reduce_f32_sum", "prim_reduce_f32_min", "prim_reduce_f32_max" }
+    };
+
+    CG_CONTEXT          *ctx      = (CG_CONTEXT*) context;
+    CG_EXEC_GROUP       *group    =  cgObjectTableGet(&ctx->ExecGroupTable, exec_group);
+    CG_KERNEL           *program  =  NULL;
+    CG_PRIMITIVES_STATE *state    =  NULL;
+    cg_handle_t          kernel   =  CG_INVALID_HANDLE;
+    cg_handle_t          pipeline =  CG_INVALID_HANDLE;
+    cl_int               cl_res   =  CL_SUCCESS;
+    size_t               nbytes   =  0;
+    cl_kernel            kernels[CG_COMPUTE_PRIMITIVE_TYPE_COUNT * CG_COMPUTE_PRIMITIVE_OP_COUNT + 5];
+    size_t               kernel_count = 0;
+
+    if (group == NULL)
+    {   // the execution group handle is not valid.
+        result = CG_INVALID_VALUE;
+        return CG_INVALID_HANDLE;
+    }
+
+    cg_kernel_code_t code;
+    code.Code          = kernel_code;
+    code.CodeSize      = strlen(kernel_code)+1;
+    code.Type          = CG_KERNEL_TYPE_COMPUTE;
+    code.Flags         = CG_KERNEL_FLAGS_SOURCE;
+    code.Options       = NULL;
+    if ((kernel = cgCreateKernel(context, exec_group, &code, result)) == CG_INVALID_HANDLE)
+    {
+        return CG_INVALID_HANDLE;
+    }
+
+    // allocate the state with the per-device configuration immediately following it.
+    nbytes = sizeof(CG_PRIMITIVES_STATE) + group->DeviceCount * sizeof(CG_PRIMITIVES_DEVICE);
+    if ((state = (CG_PRIMITIVES_STATE*) cgAllocateHostMemory(&ctx->HostAllocator, nbytes, 0, CG_ALLOCATION_TYPE_OBJECT)) == NULL)
+    {   // unable to allocate the required memory.
+        cgDeleteObject(context, kernel);
+        result = CG_OUT_OF_MEMORY;
+        return CG_INVALID_HANDLE;
+    }
+    memset(state, 0, nbytes);
+    state->AllocSize   = nbytes;
+    state->DeviceCount = group->DeviceCount;
+    state->Devices     =(CG_PRIMITIVES_DEVICE*) (((uint8_t*) state) + sizeof(CG_PRIMITIVES_STATE));
+
+    // create the kernels the pipeline uses in addition to its primary kernel.
+    program = cgObjectTableGet(&ctx->KernelTable, kernel);
+    for (size_t i = 0; i < CG_COMPUTE_PRIMITIVE_TYPE_COUNT; ++i)
+    {
+        for (size_t j = 0; j < CG_COMPUTE_PRIMITIVE_OP_COUNT; ++j)
+        {
+            if ((state->Reduce[i][j] = clCreateKernel(program->ComputeProgram, reduce_names[i][j], &cl_res)) == NULL)
+                goto error_cleanup;
+            kernels[kernel_count++] = state->Reduce[i][j];
+        }
+    }
+    if ((state->CountNonZero = clCreateKernel(program->ComputeProgram, "prim_count_nonzero", &cl_res)) == NULL)
+        goto error_cleanup;
+    kernels[kernel_count++] = state->CountNonZero;
+    if ((state->ScanTiles    = clCreateKernel(program->ComputeProgram, "prim_scan_tiles"   , &cl_res)) == NULL)
+        goto error_cleanup;
+    kernels[kernel_count++] = state->ScanTiles;
+    if ((state->CompactTiles = clCreateKernel(program->ComputeProgram, "prim_compact_tiles", &cl_res)) == NULL)
+        goto error_cleanup;
+    kernels[kernel_count++] = state->CompactTiles;
+    if ((state->RadixCount   = clCreateKernel(program->ComputeProgram, "prim_radix_count"  , &cl_res)) == NULL)
+        goto error_cleanup;
+    kernels[kernel_count++] = state->RadixCount;
+    if ((state->RadixScatter = clCreateKernel(program->ComputeProgram, "prim_radix_scatter", &cl_res)) == NULL)
+        goto error_cleanup;
+    kernels[kernel_count++] = state->RadixScatter;
+
+    // select the work group configuration for each device.
+    for (size_t i = 0; i < group->DeviceCount; ++i)
+    {
+        CG_DEVICE *device = group->DeviceList[i];
+        bool       is_cpu =(device->Type & CL_DEVICE_TYPE_CPU) != 0;
+        size_t     lsz    = is_cpu ?  64 : 256;
+        size_t     ipt    = is_cpu ?  32 :   8;
+        cl_ulong   lmem   = device->Capabilities.LocalMemorySize;
+
+        for (size_t j = 0; j < kernel_count; ++j)
+        {   // every kernel must be able to run with the same work group size.
+            size_t wgs = 0;
+            if (clGetKernelWorkGroupInfo(kernels[j], group->DeviceIds[i], CL_KERNEL_WORK_GROUP_SIZE, sizeof(size_t), &wgs, NULL) == CL_SUCCESS)
+            {
+                while (lsz > wgs && lsz > 1)
+                    lsz >>= 1;
+            }
+        }
+        while (ipt > 1 && (lsz * ipt + lsz) * sizeof(cl_uint) > lmem)
+            ipt >>= 1;
+        while (lsz > 16 && (lsz * ipt + lsz) * sizeof(cl_uint) > lmem)
+            lsz >>= 1;
+        if (lsz < 16)
+        {   // the histogram and digit range tables need at least 16 work items.
+            result = CG_UNSUPPORTED;
+            goto error_cleanup;
+        }
+        state->Devices[i].GroupSize      = lsz;
+        state->Devices[i].ItemsPerThread = ipt;
+    }
+
+    cg_compute_pipeline_t cp;
+    cp.KernelName    = "prim_scan_tiles";
+    cp.KernelProgram = kernel;
+    if ((pipeline = cgCreateComputePipeline(context, exec_group, &cp, state, cgTeardownComputePipelinePrimitives, result)) == CG_INVALID_HANDLE)
+    {   // the teardown callback is not invoked if the pipeline could not be created.
+        goto error_cleanup;
+    }
+    cgSetComputePipelineCallback(CG_COMPUTE_PIPELINE_PRIMITIVES, cgExecuteComputePipelinePrimitives);
+    result = CG_SUCCESS;
+    return pipeline;
+
+error_cleanup:
+    if (cl_res != CL_SUCCESS)
+        result  = CG_COMPILE_FAILED;
+    for (size_t i = 0; i < kernel_count; ++i)
+        clReleaseKernel(kernels[i]);
+    cgFreeHostMemory(&ctx->HostAllocator, state, nbytes, 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgDeleteObject(context, kernel);
+    return CG_INVALID_HANDLE;
+}
+
+/// @summary Enqueue a SCAN command for the PRIMITIVES pipeline in a command buffer. Computes the prefix sum of 32-bit 
+/// integers; signed integers can be scanned as well, since the sum wraps identically.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param cmd_buffer The handle of the command buffer to update.
+/// @param pipeline The handle of a PRIMITIVES compute pipeline object.
+/// @param in_buffer The handle of the buffer containing the values to scan.
+/// @param out_buffer The handle of the buffer to write the prefix sums to. May be the same as @a in_buffer.
+/// @param count The number of 32-bit values to scan.
+/// @param inclusive true to compute an inclusive scan, or false to compute an exclusive scan.
+/// @param done_event The handle of the event to signal when the command has finished executing, or CG_INVALID_HANDLE.
+/// @param wait_event The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+/// @return CG_SUCCESS, CG_INVALID_VALUE or another result code.
+library_function int
+cgComputeScan
+(
+    uintptr_t   context, 
+    cg_handle_t cmd_buffer, 
+    cg_handle_t pipeline, 
+    cg_handle_t in_buffer, 
+    cg_handle_t out_buffer, 
+    size_t      count, 
+    bool        inclusive, 
+    cg_handle_t done_event, 
+    cg_handle_t wait_event
+)
+{
+    cg_compute_pipeline_primitives_scan_t args;
+    if (count > 0xFFFFFFFFU)
+        return CG_INVALID_VALUE;
+    args.InputBuffer  = in_buffer;
+    args.OutputBuffer = out_buffer;
+    args.Count        = uint32_t(count);
+    args.Inclusive    = inclusive ? 1 : 0;
+    return cgComputePipelineRecord(context, cmd_buffer, pipeline, CG_COMPUTE_PIPELINE_PRIMITIVES, CG_COMPUTE_PRIMITIVES_CMD_SCAN, &args, sizeof(args), done_event, wait_event);
+}
+
+/// @summary Enqueue a REDUCE command for the PRIMITIVES pipeline in a command buffer. If @a count is zero, the output is not written.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param cmd_buffer The handle of the command buffer to update.
+/// @param pipeline The handle of a PRIMITIVES compute pipeline object.
+/// @param in_buffer The handle of the buffer containing the values to reduce.
+/// @param count The number of 32-bit values to reduce.
+/// @param data_type One of cg_compute_primitive_type_e specifying the element type.
+/// @param operation One of cg_compute_primitive_op_e specifying the reduction operator.
+/// @param out_buffer The handle of the buffer to write the result to.
+/// @param out_index The zero-based index of the 32-bit element in @a out_buffer to write the result to.
+/// @param done_event The handle of the event to signal when the command has finished executing, or CG_INVALID_HANDLE.
+/// @param wait_event The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+/// @return CG_SUCCESS, CG_INVALID_VALUE or another result code.
+library_function int
+cgComputeReduce
+(
+    uintptr_t   context, 
+    cg_handle_t cmd_buffer, 
+    cg_handle_t pipeline, 
+    cg_handle_t in_buffer, 
+    size_t      count, 
+    int         data_type, 
+    int         operation, 
+    cg_handle_t out_buffer, 
+    size_t      out_index, 
+    cg_handle_t done_event, 
+    cg_handle_t wait_event
+)
+{
+    cg_compute_pipeline_primitives_reduce_t args;
+    if (count > 0xFFFFFFFFU || out_index >= 0xFFFFFFFFU)
+        return CG_INVALID_VALUE;
+    if (data_type < 0 || uint32_t(data_type) >= CG_COMPUTE_PRIMITIVE_TYPE_COUNT || operation < 0 || uint32_t(operation) >= CG_COMPUTE_PRIMITIVE_OP_COUNT)
+        return CG_INVALID_VALUE;
+    args.InputBuffer  = in_buffer;
+    args.OutputBuffer = out_buffer;
+    args.Count        = uint32_t(count);
+    args.OutputIndex  = uint32_t(out_index);
+    args.DataType     = uint32_t(data_type);
+    args.Operation    = uint32_t(operation);
+    return cgComputePipelineRecord(context, cmd_buffer, pipeline, CG_COMPUTE_PIPELINE_PRIMITIVES, CG_COMPUTE_PRIMITIVES_CMD_REDUCE, &args, sizeof(args), done_event, wait_event);
+}
+
+/// @summary Enqueue a COMPACT command for the PRIMITIVES pipeline in a command buffer. The values whose flag is non-zero 
+/// are written to the output buffer in their original order, and the number of values written is stored in @a count_buffer.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param cmd_buffer The handle of the command buffer to update.
+/// @param pipeline The handle of a PRIMITIVES compute pipeline object.
+/// @param in_buffer The handle of the buffer containing the 32-bit values to compact.
+/// @param flag_buffer The handle of the buffer containing one 32-bit flag per value.
+/// @param count The number of values in @a in_buffer and @a flag_buffer.
+/// @param out_buffer The handle of the buffer to write the kept values to. Must not be the same as @a in_buffer or @a flag_buffer.
+/// @param count_buffer The handle of the buffer to write the number of kept values to.
+/// @param done_event The handle of the event to signal when the command has finished executing, or CG_INVALID_HANDLE.
+/// @param wait_event The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+/// @return CG_SUCCESS, CG_INVALID_VALUE or another result code.
+library_function int
+cgComputeCompact
+(
+    uintptr_t   context, 
+    cg_handle_t cmd_buffer, 
+    cg_handle_t pipeline, 
+    cg_handle_t in_buffer, 
+    cg_handle_t flag_buffer, 
+    size_t      count, 
+    cg_handle_t out_buffer, 
+    cg_handle_t count_buffer, 
+    cg_handle_t done_event, 
+    cg_handle_t wait_event
+)
+{
+    cg_compute_pipeline_primitives_compact_t args;
+    if (count > 0xFFFFFFFFU)
+        return CG_INVALID_VALUE;
+    args.InputBuffer  = in_buffer;
+    args.FlagBuffer   = flag_buffer;
+    args.OutputBuffer = out_buffer;
+    args.CountBuffer  = count_buffer;
+    args.Count        = uint32_t(count);
+    args.Reserved     = 0;
+    return cgComputePipelineRecord(context, cmd_buffer, pipeline, CG_COMPUTE_PIPELINE_PRIMITIVES, CG_COMPUTE_PRIMITIVES_CMD_COMPACT, &args, sizeof(args), done_event, wait_event);
+}
+
+/// @summary Enqueue a SORT command for the PRIMITIVES pipeline in a command buffer. The keys are sorted into ascending 
+/// order in-place using a stable radix sort with 4-bit digits, so the cost is proportional to @a key_bits. If a value 
+/// buffer is specified, its contents are permuted along with the keys.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param cmd_buffer The handle of the command buffer to update.
+/// @param pipeline The handle of a PRIMITIVES compute pipeline object.
+/// @param key_buffer The handle of the buffer containing the 32-bit unsigned integer keys.
+/// @param value_buffer The handle of the buffer containing the 32-bit values to permute with the keys, or CG_INVALID_HANDLE.
+/// @param count The number of keys to sort.
+/// @param key_bits The number of low-order key bits to sort on, in [1, 32]. The count is rounded up to a multiple of 4 (one digit), and bits above the rounded count do not affect the order.
+/// @param done_event The handle of the event to signal when the command has finished executing, or CG_INVALID_HANDLE.
+/// @param wait_event The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+/// @return CG_SUCCESS, CG_INVALID_VALUE or another result code.
+library_function int
+cgComputeSort
+(
+    uintptr_t   context, 
+    cg_handle_t cmd_buffer, 
+    cg_handle_t pipeline, 
+    cg_handle_t key_buffer, 
+    cg_handle_t value_buffer, 
+    size_t      count, 
+    size_t      key_bits, 
+    cg_handle_t done_event, 
+    cg_handle_t wait_event
+)
+{
+    cg_compute_pipeline_primitives_sort_t args;
+    if (count > 0xFFFFFFFFU || key_bits == 0 || key_bits > 32)
+        return CG_INVALID_VALUE;
+    args.KeyBuffer    = key_buffer;
+    args.ValueBuffer  = value_buffer;
+    args.Count        = uint32_t(count);
+    args.KeyBits      = uint32_t(key_bits);
+    return cgComputePipelineRecord(context, cmd_buffer, pipeline, CG_COMPUTE_PIPELINE_PRIMITIVES, CG_COMPUTE_PRIMITIVES_CMD_SORT, &args, sizeof(args), done_event, wait_event);
+}
+
+/// @summary Compiles the kernels and allocates the state required to create the IMAGE compute pipeline, which 
+/// implements mipmap generation, separable Gaussian blur and resizing of 2D images. Every operation is split into 
+/// a horizontal and a vertical pass through a linear RGBA float temporary image, so a filter with N taps costs 2N 
+/// samples per pixel rather than N*N, and sRGB data is always filtered in linear space.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param exec_group The CGFX execution group managing the set of devices the pipeline can execute on.
+/// @param result On return, set to CG_SUCCESS or another result code.
+/// @return The handle of the compute pipeline object, or CG_INVALID_HANDLE.
+library_function cg_handle_t
+cgCreateComputePipelineImage
+(
+    uintptr_t   context, 
+    cg_handle_t exec_group, 
+    int        &result
+)
+{
+    static char const *kernel_code = 
+        "#define IMG_BOX       0\n"
+        "#define IMG_TRIANGLE  1\n"
+        "#define IMG_LANCZOS3  2\n"
+        "#define IMG_KAISER    3\n"
+        "#define IMG_GAUSSIAN  4\n"
+        "\n"
+        "__constant sampler_t img_sampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP_TO_EDGE | CLK_FILTER_NEAREST;\n"
+        "\n"
+        "float img_sinc(float x)\n"
+        "{\n"
+        "    if (fabs(x) < 1.0e-5f)\n"
+        "        return 1.0f;\n"
+        "    x *= M_PI_F;\n"
+        "    return sin(x) / x;\n"
+        "}\n"
+        "\n"
+        "float img_bessel_i0(float x)\n"
+        "{\n"
+        "    float sum  = 1.0f;\n"
+        "    float term = 1.0f;\n"
+        "    float q    = x * x * 0.25f;\n"
+        "    for (int k = 1; k < 16; ++k)\n"
+        "    {\n"
+        "        term *= q / (float) (k * k);\n"
+        "        sum  += term;\n"
+        "    }\n"
+        "    return sum;\n"
+        "}\n"
+        "\n"
+        "float img_filter_radius(uint filter, float sigma)\n"
+        "{\n"
+        "    switch (filter)\n"
+        "    {\n"
+        "    case IMG_BOX     : return 0.5f;\n"
+        "    case IMG_TRIANGLE: return 1.0f;\n"
+        "    case IMG_GAUSSIAN: return ceil(3.0f * sigma);\n"
+        "    default          : return 3.0f;\n"
+        "    }\n"
+        "}\n"
+        "\n"
+        "float img_filter_weight(uint filter, float t, float sigma)\n"
+        "{\n"
+        "    float a = fabs(t);\n"
+        "    switch (filter)\n"
+        "    {\n"
+        "    case IMG_BOX     : return (t >= -0.5f && t < 0.5f) ? 1.0f : 0.0f;\n"
+        "    case IMG_TRIANGLE: return max(1.0f - a, 0.0f);\n"
+        "    case IMG_LANCZOS3: return (a < 3.0f) ? img_sinc(t) * img_sinc(t / 3.0f) : 0.0f;\n"
+        "    case IMG_KAISER  : return (a < 3.0f) ? img_sinc(t) * img_bessel_i0(4.0f * sqrt(1.0f - (t * t) / 9.0f)) / img_bessel_i0(4.0f) : 0.0f;\n"
+        "    default          : return exp(-(t * t) / (2.0f * sigma * sigma));\n"
+        "    }\n"
+        "}\n"
+        "\n"
+        "float4 img_to_linear(float4 c)\n"
+        "{\n"
+        "    float3 v  = clamp(c.xyz, 0.0f, 1.0f);\n"
+        "    float3 lo = v / 12.92f;\n"
+        "    float3 hi = pow((v + 0.055f) / 1.055f, (float3) (2.4f));\n"
+        "    return (float4) (select(hi, lo, isless(v, (float3) (0.04045f))), c.w);\n"
+        "}\n"
+        "\n"
+        "float4 img_to_srgb(float4 c)\n"
+        "{\n"
+        "    float3 v  = clamp(c.xyz, 0.0f, 1.0f);\n"
+        "    float3 lo = v * 12.92f;\n"
+        "    float3 hi = 1.055f * pow(v, (float3) (1.0f / 2.4f)) - 0.055f;\n"
+        "    return (float4) (select(hi, lo, isless(v, (float3) (0.0031308f))), c.w);\n"
+        "}\n"
+        "\n"
+        "#define IMG_LOAD_F(img, p)      read_imagef(img, img_sampler, p)\n"
+        "#define IMG_LOAD_U(img, p)      convert_float4(read_imageui(img, img_sampler, p))\n"
+        "#define IMG_LOAD_I(img, p)      convert_float4(read_imagei(img, img_sampler, p))\n"
+        "#define IMG_STORE_F(img, p, v)  write_imagef(img, p, v)\n"
+        "#define IMG_STORE_U(img, p, v)  write_imageui(img, p, convert_uint4_sat_rte(v))\n"
+        "#define IMG_STORE_I(img, p, v)  write_imagei(img, p, convert_int4_sat_rte(v))\n"
+        "\n"
+        "#define IMG_RESAMPLE_H(NAME, LOAD)                                                                             \\\n"
+        "__kernel void NAME(__read_only image2d_t src, __write_only image2d_t tmp, uint dst_w, uint filter, float sigma, uint srgb) \\\n"
+        "{                                                                                                              \\\n"
+        "    int    x     = get_global_id(0);                                                                           \\\n"
+        "    int    y     = get_global_id(1);                                                                           \\\n"
+        "    float  scale = (float) get_image_width(src) / (float) dst_w;                                               \\\n"
+        "    float  fs    = max(scale, 1.0f);                                                                           \\\n"
+        "    float  supp  = img_filter_radius(filter, sigma) * fs;                                                      \\\n"
+        "    float  c     = ((float) x + 0.5f) * scale;                                                                 \\\n"
+        "    int    i0    = (int) floor(c - supp);                                                                      \\\n"
+        "    int    i1    = (int) ceil (c + supp);                                                                      \\\n"
+        "    float4 acc   = (float4) (0.0f);                                                                            \\\n"
+        "    float  wsum  = 0.0f;                                                                                       \\\n"
+        "    for (int i = i0; i <= i1; ++i)                                                                             \\\n"
+        "    {                                                                                                          \\\n"
+        "        float w = img_filter_weight(filter, ((float) i + 0.5f - c) / fs, sigma);                               \\\n"
+        "        if (w != 0.0f)                                                                                         \\\n"
+        "        {                                                                                                      \\\n"
+        "            float4 v = LOAD(src, (int2) (i, y));                                                               \\\n"
+        "            if (srgb) v = img_to_linear(v);                                                                    \\\n"
+        "            acc  += w * v;                                                                                     \\\n"
+        "            wsum += w;                                                                                         \\\n"
+        "        }                                                                                                      \\\n"
+        "    }                                                                                                          \\\n"
+        "    write_imagef(tmp, (int2) (x, y), (wsum != 0.0f) ? acc / wsum : acc);                                       \\\n"
+        "}\n"
+        "\n"
+        "#define IMG_RESAMPLE_V(NAME, STORE)                                                                            \\\n"
+        "__kernel void NAME(__read_only image2d_t tmp, __write_only image2d_t dst, uint src_h, uint filter, float sigma, uint srgb) \\\n"
+        "{                                                                                                              \\\n"
+        "    int    x     = get_global_id(0);                                                                           \\\n"
+        "    int    y     = get_global_id(1);                                                                           \\\n"
+        "    float  scale = (float) src_h / (float) get_image_height(dst);                                              \\\n"
+        "    float  fs    = max(scale, 1.0f);                                                                           \\\n"
+        "    float  supp  = img_filter_radius(filter, sigma) * fs;                                                      \\\n"
+        "    float  c     = ((float) y + 0.5f) * scale;                                                                 \\\n"
+        "    int    j0    = (int) floor(c - supp);                                                                      \\\n"
+        "    int    j1    = (int) ceil (c + supp);                                                                      \\\n"
+        "    float4 acc   = (float4) (0.0f);                                                                            \\\n"
+        "    float  wsum  = 0.0f;                                                                                       \\\n"
+        "    for (int j = j0; j <= j1; ++j)                                                                             \\\n"
+        "    {                                                                                                          \\\n"
+        "        float w = img_filter_weight(filter, ((float) j + 0.5f - c) / fs, sigma);                               \\\n"
+        "        if (w != 0.0f)                                                                                         \\\n"
+        "        {   /* the temporary image may be larger than the source, so clamp explicitly. */                      \\\n"
+        "            int2 p = (int2) (x, clamp(j, 0, (int) src_h - 1));                                                 \\\n"
+        "            acc  += w * read_imagef(tmp, img_sampler, p);                                                      \\\n"
+        "            wsum += w;                                                                                         \\\n"
+        "        }                                                                                                      \\\n"
+        "    }                                                                                                          \\\n"
+        "    if (wsum != 0.0f) acc /= wsum;                                                                             \\\n"
+        "    if (srgb) acc = img_to_srgb(acc);                                                                          \\\n"
+        "    STORE(dst, (int2) (x, y), acc);                                                                            \\\n"
+        "}\n"
+        "\n"
+        "IMG_RESAMPLE_H(img_resample_h_f, IMG_LOAD_F)\n"
+        "IMG_RESAMPLE_H(img_resample_h_u, IMG_LOAD_U)\n"
+        "IMG_RESAMPLE_H(img_resample_h_i, IMG_LOAD_I)\n"
+        "IMG_RESAMPLE_V(img_resample_v_f, IMG_STORE_F)\n"
+        "IMG_RESAMPLE_V(img_resample_v_u, IMG_STORE_U)\n"
+        "IMG_RESAMPLE_V(img_resample_v_i, IMG_STORE_I)\n";
+    static char const *resample_names[2][CG_IMAGE_TEXEL_KIND_COUNT] = 
+    {
+        { "img_resample_h_f", "img_resample_h_u", "img_resample_h_i" }, 
+        { "img_resample_v_f", "img_resample_v_u", "img_resample_v_i" }
+    };
+
+    CG_CONTEXT              *ctx      = (CG_CONTEXT*) context;
+    CG_EXEC_GROUP           *group    =  cgObjectTableGet(&ctx->ExecGroupTable, exec_group);
+    CG_KERNEL               *program  =  NULL;
+    CG_IMAGE_PIPELINE_STATE *state    =  NULL;
+    cg_handle_t              kernel   =  CG_INVALID_HANDLE;
+    cg_handle_t              pipeline =  CG_INVALID_HANDLE;
+    cl_int                   cl_res   =  CL_SUCCESS;
+
+    if (group == NULL)
+    {   // the execution group handle is not valid.
+        result = CG_INVALID_VALUE;
+        return CG_INVALID_HANDLE;
+    }
+    for (size_t i = 0; i < group->DeviceCount; ++i)
+    {
+        if (group->DeviceList[i]->Capabilities.SupportImage == CL_FALSE)
+        {   // every device must be able to execute the image kernels.
+            result = CG_UNSUPPORTED;
+            return CG_INVALID_HANDLE;
+        }
+    }
+
+    cg_kernel_code_t code;
+    code.Code          = kernel_code;
+    code.CodeSize      = strlen(kernel_code)+1;
+    code.Type          = CG_KERNEL_TYPE_COMPUTE;
+    code.Flags         = CG_KERNEL_FLAGS_SOURCE;
+    code.Options       = NULL;
+    if ((kernel = cgCreateKernel(context, exec_group, &code, result)) == CG_INVALID_HANDLE)
+    {
+        return CG_INVALID_HANDLE;
+    }
+    if ((state = (CG_IMAGE_PIPELINE_STATE*) cgAllocateHostMemory(&ctx->HostAllocator, sizeof(CG_IMAGE_PIPELINE_STATE), 0, CG_ALLOCATION_TYPE_OBJECT)) == NULL)
+    {   // unable to allocate the required memory.
+        cgDeleteObject(context, kernel);
+        result = CG_OUT_OF_MEMORY;
+        return CG_INVALID_HANDLE;
+    }
+    memset(state, 0, sizeof(CG_IMAGE_PIPELINE_STATE));
+
+    // create one pair of kernels for each kind of texel data.
+    program = cgObjectTableGet(&ctx->KernelTable, kernel);
+    for (size_t i = 0; i < CG_IMAGE_TEXEL_KIND_COUNT; ++i)
+    {
+        if ((state->ResampleH[i] = clCreateKernel(program->ComputeProgram, resample_names[0][i], &cl_res)) == NULL)
+            goto error_cleanup;
+        if ((state->ResampleV[i] = clCreateKernel(program->ComputeProgram, resample_names[1][i], &cl_res)) == NULL)
+            goto error_cleanup;
+    }
+
+    cg_compute_pipeline_t cp;
+    cp.KernelName    = "img_resample_h_f";
+    cp.KernelProgram = kernel;
+    if ((pipeline = cgCreateComputePipeline(context, exec_group, &cp, state, cgTeardownComputePipelineImage, result)) == CG_INVALID_HANDLE)
+    {   // the teardown callback is not invoked if the pipeline could not be created.
+        goto error_cleanup;
+    }
+    cgSetComputePipelineCallback(CG_COMPUTE_PIPELINE_IMAGE, cgExecuteComputePipelineImage);
+    result = CG_SUCCESS;
+    return pipeline;
+
+error_cleanup:
+    if (cl_res != CL_SUCCESS)
+        result  = CG_COMPILE_FAILED;
+    for (size_t i = 0; i < CG_IMAGE_TEXEL_KIND_COUNT; ++i)
+    {
+        if (state->ResampleH[i] != NULL) clReleaseKernel(state->ResampleH[i]);
+        if (state->ResampleV[i] != NULL) clReleaseKernel(state->ResampleV[i]);
+    }
+    cgFreeHostMemory(&ctx->HostAllocator, state, sizeof(CG_IMAGE_PIPELINE_STATE), 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgDeleteObject(context, kernel);
+    return CG_INVALID_HANDLE;
+}
+
+/// @summary Enqueue a GENERATE_MIPS command for the IMAGE pipeline in a command buffer. Each level is downsampled 
+/// from the level above it. Images with more than one level must be shared with OpenGL, since an OpenCL image object 
+/// exposes only a single level; for images with one level, the command only signals @a done_event.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param cmd_buffer The handle of the command buffer to update.
+/// @param pipeline The handle of an IMAGE compute pipeline object.
+/// @param image The handle of the image. Levels 1 and above are overwritten.
+/// @param filter One of cg_compute_image_filter_e specifying the downsampling filter.
+/// @param done_event The handle of the event to signal when the command has finished executing, or CG_INVALID_HANDLE.
+/// @param wait_event The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+/// @return CG_SUCCESS, CG_INVALID_VALUE or another result code.
+library_function int
+cgComputeGenerateMips
+(
+    uintptr_t   context, 
+    cg_handle_t cmd_buffer, 
+    cg_handle_t pipeline, 
+    cg_handle_t image, 
+    int         filter, 
+    cg_handle_t done_event, 
+    cg_handle_t wait_event
+)
+{
+    cg_compute_pipeline_image_mips_t args;
+    if (filter < 0 || filter >= CG_COMPUTE_IMAGE_FILTER_COUNT)
+        return CG_INVALID_VALUE;
+    args.Image    = image;
+    args.Filter   = uint32_t(filter);
+    args.Reserved = 0;
+    return cgComputePipelineRecord(context, cmd_buffer, pipeline, CG_COMPUTE_PIPELINE_IMAGE, CG_COMPUTE_IMAGE_CMD_GENERATE_MIPS, &args, sizeof(args), done_event, wait_event);
+}
+
+/// @summary Enqueue a BLUR command for the IMAGE pipeline in a command buffer. Applies a separable Gaussian blur with 
+/// a radius of three standard deviations to level 0 of the source image.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param cmd_buffer The handle of the command buffer to update.
+/// @param pipeline The handle of an IMAGE compute pipeline object.
+/// @param src_image The handle of the image to blur.
+/// @param dst_image The handle of the image receiving the result. Must have the same dimensions as @a src_image, and may be the same image.
+/// @param sigma The standard deviation of the Gaussian, in pixels. Must be greater than zero.
+/// @param done_event The handle of the event to signal when the command has finished executing, or CG_INVALID_HANDLE.
+/// @param wait_event The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+/// @return CG_SUCCESS, CG_INVALID_VALUE or another result code.
+library_function int
+cgComputeBlur
+(
+    uintptr_t   context, 
+    cg_handle_t cmd_buffer, 
+    cg_handle_t pipeline, 
+    cg_handle_t src_image, 
+    cg_handle_t dst_image, 
+    float       sigma, 
+    cg_handle_t done_event, 
+    cg_handle_t wait_event
+)
+{
+    cg_compute_pipeline_image_blur_t args;
+    if (!(sigma > 0.0f))
+        return CG_INVALID_VALUE;
+    args.SourceImage = src_image;
+    args.TargetImage = dst_image;
+    args.Sigma       = sigma;
+    args.Reserved    = 0;
+    return cgComputePipelineRecord(context, cmd_buffer, pipeline, CG_COMPUTE_PIPELINE_IMAGE, CG_COMPUTE_IMAGE_CMD_BLUR, &args, sizeof(args), done_event, wait_event);
+}
+
+/// @summary Enqueue a RESIZE command for the IMAGE pipeline in a command buffer. Level 0 of the source image is 
+/// resampled to the dimensions of level 0 of the target image. When minifying, the filter is widened by the scale 
+/// factor so that every source pixel contributes to the result.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param cmd_buffer The handle of the command buffer to update.
+/// @param pipeline The handle of an IMAGE compute pipeline object.
+/// @param src_image The handle of the image to resample.
+/// @param dst_image The handle of the image receiving the result. Must be different from @a src_image.
+/// @param filter One of cg_compute_image_filter_e specifying the resampling filter.
+/// @param done_event The handle of the event to signal when the command has finished executing, or CG_INVALID_HANDLE.
+/// @param wait_event The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+/// @return CG_SUCCESS, CG_INVALID_VALUE or another result code.
+library_function int
+cgComputeResize
+(
+    uintptr_t   context, 
+    cg_handle_t cmd_buffer, 
+    cg_handle_t pipeline, 
+    cg_handle_t src_image, 
+    cg_handle_t dst_image, 
+    int         filter, 
+    cg_handle_t done_event, 
+    cg_handle_t wait_event
+)
+{
+    cg_compute_pipeline_image_resize_t args;
+    if (filter < 0 || filter >= CG_COMPUTE_IMAGE_FILTER_COUNT || src_image == dst_image)
+        return CG_INVALID_VALUE;
+    args.SourceImage = src_image;
+    args.TargetImage = dst_image;
+    args.Filter      = uint32_t(filter);
+    args.Reserved    = 0;
+    return cgComputePipelineRecord(context, cmd_buffer, pipeline, CG_COMPUTE_PIPELINE_IMAGE, CG_COMPUTE_IMAGE_CMD_RESIZE, &args, sizeof(args), done_event, wait_event);
+}
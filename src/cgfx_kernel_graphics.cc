@@ -69,7 +69,92 @@ struct CG_GFX_TEST01_STATE
 {
     int              Viewport[4];               /// The active viewport.
     float            MVP[16];                   /// The active projection matrix.
-    CG_GLSL_UNIFORM *uMSS;                      /// Information about the projection matrix uniform.
+    bool             MVPDirty;                  /// true if MVP has changed since it was last written to the uniform ring.
+    uint64_t         MVPFrame;                  /// The uniform ring frame index at which MVP was last written.
+    GLintptr         MVPOffset;                 /// The byte offset of the most recent copy of MVP in the uniform ring.
+    CG_GLSL_UNIFORM_BLOCK *Transform;           /// Information about the uniform block containing the projection matrix.
+};
+
+/// @summary Define the arguments for the GENERIC SET_VIEWPORT command.
+struct CG_GFX_GENERIC_SET_VIEWPORT
+{
+    int              X;                         /// The x-coordinate of the upper-left corner of the viewing region.
+    int              Y;                         /// The y-coordinate of the upper-left corner of the viewing region.
+    int              Width;                     /// The width of the viewing region, in pixels.
+    int              Height;                    /// The height of the viewing region, in pixels.
+};
+
+/// @summary Define the arguments for the GENERIC DRAW command, which submits one or more instances of a vertex or index range.
+struct CG_GFX_GENERIC_DRAW
+{
+    cg_handle_t      VertexSource;              /// The handle of the vertex data source.
+    int32_t          IndexType;                 /// One of cg_graphics_index_type_e.
+    uint32_t         First;                     /// The zero-based index of the first index or vertex to read.
+    uint32_t         Count;                     /// The number of indices or vertices to read for each instance.
+    int32_t          BaseVertex;                /// The offset value added to each index read from the index buffer.
+    uint32_t         InstanceCount;             /// The number of instances to draw.
+    uint32_t         BaseInstance;              /// The value added to the instance index when reading per-instance attributes.
+};
+
+/// @summary Define the arguments for the GENERIC DRAW_INDIRECT command, which submits a list of draw records stored in a data buffer.
+struct CG_GFX_GENERIC_DRAW_INDIRECT
+{
+    cg_handle_t      VertexSource;              /// The handle of the vertex data source.
+    cg_handle_t      DrawBuffer;                /// The handle of the data buffer containing the draw records.
+    cg_handle_t      CountBuffer;               /// The handle of the data buffer containing the draw count, or CG_INVALID_HANDLE.
+    size_t           DrawOffset;                /// The byte offset of the first draw record.
+    size_t           CountOffset;               /// The byte offset of the 32-bit draw count.
+    int32_t          IndexType;                 /// One of cg_graphics_index_type_e.
+    uint32_t         MaxDrawCount;              /// The maximum number of draw records to read.
+    uint32_t         DrawStride;                /// The number of bytes between draw records. Never zero.
+};
+
+/// @summary Define the arguments for the GENERIC SET_UNIFORM_BLOCK command. The block data immediately follows the 
+/// fixed-size fields, so the command is variable-length.
+struct CG_GFX_GENERIC_SET_UNIFORM_BLOCK
+{
+    uint32_t         BlockName;                 /// The hashed name of the uniform block.
+    uint32_t         DataSize;                  /// The number of bytes of block data.
+    uint8_t          Data[1];                   /// The block data, DataSize bytes.
+};
+
+/// @summary Define the arguments for the GENERIC SET_RENDER_TARGET command.
+struct CG_GFX_GENERIC_SET_RENDER_TARGET
+{
+    cg_handle_t      ColorTarget;               /// The handle of the color image, or CG_INVALID_HANDLE for the default framebuffer.
+    cg_handle_t      DepthTarget;               /// The handle of the depth image, or CG_INVALID_HANDLE.
+    int32_t          Level;                     /// The mipmap level of the images to render into.
+    int32_t          Clear;                     /// Non-zero if the target should be cleared after it is bound.
+    float            ClearColor[4];             /// The RGBA clear color.
+};
+
+/// @summary Define the arguments for the GENERIC READ_PIXELS command, which copies pixels into a data buffer through GL_PIXEL_PACK_BUFFER.
+struct CG_GFX_GENERIC_READ_PIXELS
+{
+    cg_handle_t      SourceImage;               /// The handle of the source image, or CG_INVALID_HANDLE for the current render target.
+    cg_handle_t      TargetBuffer;              /// The handle of the data buffer receiving the pixels.
+    size_t           TargetOffset;              /// The byte offset of the first row in the data buffer.
+    int32_t          Level;                     /// The mipmap level of the source image.
+    int32_t          X;                         /// The x-coordinate of the lower-left corner of the region.
+    int32_t          Y;                         /// The y-coordinate of the lower-left corner of the region.
+    int32_t          Width;                     /// The width of the region, in pixels.
+    int32_t          Height;                    /// The height of the region, in pixels.
+};
+
+/// @summary Define the arguments for the GENERIC UPLOAD_IMAGE command, which copies pixels from a data buffer through GL_PIXEL_UNPACK_BUFFER.
+struct CG_GFX_GENERIC_UPLOAD_IMAGE
+{
+    cg_handle_t      SourceBuffer;              /// The handle of the data buffer containing the pixels.
+    cg_handle_t      TargetImage;               /// The handle of the image being written.
+    size_t           SourceOffset;              /// The byte offset of the first row in the data buffer.
+    size_t           SourceRowPitch;            /// The number of bytes between rows in the data buffer, or 0 if rows are tightly packed.
+    int32_t          Level;                     /// The mipmap level of the target image.
+    int32_t          X;                         /// The x-coordinate of the upper-left corner of the region.
+    int32_t          Y;                         /// The y-coordinate of the upper-left corner of the region.
+    int32_t          Z;                         /// The slice or array index of the first slice of the region.
+    int32_t          Width;                     /// The width of the region, in pixels.
+    int32_t          Height;                    /// The height of the region, in pixels.
+    int32_t          Depth;                     /// The number of slices in the region.
 };
 
 /*///////////////
@@ -127,6 +212,7 @@ cgExecuteGraphicsTest01SetProjection
     UNREFERENCED_PARAMETER(pipeline);
     CG_GFX_TEST01_SET_PROJECTION *ddp = (CG_GFX_TEST01_SET_PROJECTION*) bdp->ArgsData;
     memcpy(state->MVP, ddp->Matrix, sizeof(float) * 16);
+    state->MVPDirty = true;
     return CG_SUCCESS;
 }
 
@@ -155,22 +241,34 @@ cgExecuteGraphicsTest01DrawTriangles
         return CG_INVALID_VALUE;
     }
 
-    // bind the vertex array and shader program objects.
+    // bind the vertex array and shader program objects, and apply the fixed-function 
+    // state. the state cache skips any calls that would not change the current state.
     CG_DISPLAY *display = pipeline->AttachedDisplay;
     glClearColor(0.5f, 0.5f, 0.5f, 1.0f);
     glClearDepth(1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-    glUseProgram(pipeline->ShaderProgram.Program);
-    glBindVertexArray(vds->VertexArray);
-    glViewport(
+    cgGlApplyGraphicsPipeline(display, pipeline);
+    cgGlBindVertexDataSource(display, vds);
+    cgGlViewport(display, 
         GLint  (state->Viewport[0]), GLint  (state->Viewport[1]), 
         GLsizei(state->Viewport[2]), GLsizei(state->Viewport[3]));
 
-    // update uniform values.
-    glUniformMatrix4fv(state->uMSS->Location, 1, GL_FALSE, state->MVP);
+    // update the transform block. ring space is recycled once the submission that 
+    // wrote it completes, so the matrix is written at most once per submission and 
+    // re-binding the same range is skipped by the state cache.
+    CG_GL_UNIFORM_RING *ring = display->UniformRing;
+    int                 res  = CG_SUCCESS;
+    if (state->MVPDirty || ring->Buffer == 0 || state->MVPFrame != ring->FrameIndex)
+    {
+        if ((res = cgGlUniformRingWrite(display, state->MVP, sizeof(float) * 16, state->MVPOffset)) != CG_SUCCESS)
+            return res;
+        state->MVPFrame = ring->FrameIndex;
+        state->MVPDirty = false;
+    }
+    cgGlBindBufferRange(display, GL_UNIFORM_BUFFER, state->Transform->Binding, ring->Buffer, state->MVPOffset, GLsizeiptr(sizeof(float) * 16));
 
     // submit the draw call to the GPU command queue.
-    glDrawRangeElementsBaseVertex(GL_TRIANGLES, ddp->MinIndex, ddp->MaxIndex, ddp->PrimitiveCount * 3, GL_UNSIGNED_SHORT, (GLvoid*) 0, ddp->BaseVertex);
+    glDrawRangeElementsBaseVertex(GL_TRIANGLES, ddp->MinIndex, ddp->MaxIndex, ddp->PrimitiveCount * 3, GL_UNSIGNED_SHORT, CG_GL_BUFFER_OFFSET(vds->IndexOffset), ddp->BaseVertex);
     return CG_SUCCESS;
 }
 
@@ -233,6 +331,612 @@ cgTeardownGraphicsPipelineTest01
     UNREFERENCED_PARAMETER(pipe);
 }
 
+/// @summary Convert a cg_graphics_index_type_e value into the corresponding OpenGL data type.
+/// @param index_type One of cg_graphics_index_type_e.
+/// @param index_size On return, set to the size of a single index value, in bytes.
+/// @return The OpenGL data type, or GL_NONE if @a index_type is CG_GRAPHICS_INDEX_NONE or invalid.
+internal_function inline GLenum
+cgGlIndexType
+(
+    int     index_type, 
+    size_t &index_size
+)
+{
+    switch (index_type)
+    {
+    case CG_GRAPHICS_INDEX_UINT16:
+        index_size = sizeof(uint16_t);
+        return GL_UNSIGNED_SHORT;
+    case CG_GRAPHICS_INDEX_UINT32:
+        index_size = sizeof(uint32_t);
+        return GL_UNSIGNED_INT;
+    default:
+        break;
+    }
+    index_size = 0;
+    return GL_NONE;
+}
+
+/// @summary Bind the program, fixed-function state and vertex data source used by a GENERIC draw command.
+/// @param ctx The CGFX context defining the vertex data source.
+/// @param pipeline The CGFX graphics pipeline being executed.
+/// @param vertex_source The handle of the vertex data source.
+/// @param index_offset On return, set to the byte offset of the first index of the vertex data source.
+/// @return CG_SUCCESS or CG_INVALID_VALUE.
+internal_function int
+cgGraphicsGenericBindState
+(
+    CG_CONTEXT           *ctx, 
+    CG_GRAPHICS_PIPELINE *pipeline, 
+    cg_handle_t           vertex_source, 
+    size_t               &index_offset
+)
+{
+    CG_DISPLAY            *display = pipeline->AttachedDisplay;
+    CG_VERTEX_DATA_SOURCE *vds     = cgObjectTableGet(&ctx->VertexSourceTable, vertex_source);
+    if (vds == NULL || vds->AttachedDisplay == NULL || vds->AttachedDisplay->DisplayRC != display->DisplayRC)
+    {   // the vertex array object doesn't exist in the pipeline's rendering context.
+        return CG_INVALID_VALUE;
+    }
+    cgGlApplyGraphicsPipeline(display, pipeline);
+    cgGlBindVertexDataSource(display, vds);
+    index_offset = vds->IndexOffset;
+    return CG_SUCCESS;
+}
+
+/// @summary Implements the SET_VIEWPORT command for the GENERIC graphics pipeline.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX graphics command queue.
+/// @param pipeline The CGFX pipeline state being updated.
+/// @param bdp The graphics pipeline dispatch command data.
+/// @return CG_SUCCESS.
+internal_function int
+cgExecuteGraphicsGenericSetViewport
+(
+    CG_CONTEXT             *ctx, 
+    CG_QUEUE               *queue, 
+    CG_GRAPHICS_PIPELINE   *pipeline, 
+    cg_pipeline_cmd_data_t *bdp
+)
+{   UNREFERENCED_PARAMETER(ctx);
+    UNREFERENCED_PARAMETER(queue);
+    CG_GFX_GENERIC_SET_VIEWPORT *ddp = (CG_GFX_GENERIC_SET_VIEWPORT*) bdp->ArgsData;
+    cgGlViewport(pipeline->AttachedDisplay, GLint(ddp->X), GLint(ddp->Y), GLsizei(ddp->Width), GLsizei(ddp->Height));
+    return CG_SUCCESS;
+}
+
+/// @summary Implements the DRAW command for the GENERIC graphics pipeline.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX graphics command queue.
+/// @param pipeline The CGFX pipeline state being executed.
+/// @param bdp The graphics pipeline dispatch command data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_UNSUPPORTED or another result code.
+internal_function int
+cgExecuteGraphicsGenericDraw
+(
+    CG_CONTEXT             *ctx, 
+    CG_QUEUE               *queue, 
+    CG_GRAPHICS_PIPELINE   *pipeline, 
+    cg_pipeline_cmd_data_t *bdp
+)
+{   UNREFERENCED_PARAMETER(queue);
+    CG_GFX_GENERIC_DRAW *ddp     = (CG_GFX_GENERIC_DRAW*) bdp->ArgsData;
+    CG_DISPLAY          *display =  pipeline->AttachedDisplay;
+    size_t               isize   =  0;
+    size_t               ibase   =  0;
+    GLenum               itype   =  cgGlIndexType(ddp->IndexType, isize);
+    int                  result  =  CG_SUCCESS;
+
+    if (ddp->BaseInstance != 0 && !GLEW_VERSION_4_2 && !GLEW_ARB_base_instance)
+    {   // a non-zero base instance requires OpenGL 4.2 or GL_ARB_base_instance.
+        return CG_UNSUPPORTED;
+    }
+    if ((result = cgGraphicsGenericBindState(ctx, pipeline, ddp->VertexSource, ibase)) != CG_SUCCESS)
+    {   // the vertex data source is not valid.
+        return result;
+    }
+    if (isize != 0 && (ibase % isize) != 0)
+    {   // the index offset of the data source is not aligned to the index type.
+        return CG_INVALID_VALUE;
+    }
+
+    // a single instance with a zero base instance maps to the draw calls available in every OpenGL 3.2 context.
+    GLsizei count     = GLsizei(ddp->Count);
+    GLsizei instances = GLsizei(ddp->InstanceCount);
+    if (itype != GL_NONE)
+    {
+        GLvoid *offset = CG_GL_BUFFER_OFFSET(ibase + size_t(ddp->First) * isize);
+        if (ddp->BaseInstance != 0)
+            glDrawElementsInstancedBaseVertexBaseInstance(pipeline->Topology, count, itype, offset, instances, ddp->BaseVertex, ddp->BaseInstance);
+        else if (instances > 1)
+            glDrawElementsInstancedBaseVertex(pipeline->Topology, count, itype, offset, instances, ddp->BaseVertex);
+        else
+            glDrawElementsBaseVertex(pipeline->Topology, count, itype, offset, ddp->BaseVertex);
+    }
+    else
+    {
+        if (ddp->BaseInstance != 0)
+            glDrawArraysInstancedBaseInstance(pipeline->Topology, GLint(ddp->First), count, instances, ddp->BaseInstance);
+        else if (instances > 1)
+            glDrawArraysInstanced(pipeline->Topology, GLint(ddp->First), count, instances);
+        else
+            glDrawArrays(pipeline->Topology, GLint(ddp->First), count);
+    }
+    return CG_SUCCESS;
+}
+
+/// @summary Implements the DRAW_INDIRECT command for the GENERIC graphics pipeline. The draw records are consumed by the 
+/// GPU without a round-trip through host memory. If the rendering context cannot read the draw count from a buffer, all 
+/// MaxDrawCount records are submitted, so producers should write zero InstanceCount values into unused records.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX graphics command queue.
+/// @param pipeline The CGFX pipeline state being executed.
+/// @param bdp The graphics pipeline dispatch command data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_UNSUPPORTED or another result code.
+internal_function int
+cgExecuteGraphicsGenericDrawIndirect
+(
+    CG_CONTEXT             *ctx, 
+    CG_QUEUE               *queue, 
+    CG_GRAPHICS_PIPELINE   *pipeline, 
+    cg_pipeline_cmd_data_t *bdp
+)
+{   UNREFERENCED_PARAMETER(queue);
+    CG_GFX_GENERIC_DRAW_INDIRECT *ddp     = (CG_GFX_GENERIC_DRAW_INDIRECT*) bdp->ArgsData;
+    CG_DISPLAY                   *display =  pipeline->AttachedDisplay;
+    CG_BUFFER                    *drawbuf =  cgObjectTableGet(&ctx->BufferTable, ddp->DrawBuffer);
+    CG_BUFFER                    *cntbuf  =  NULL;
+    size_t                        isize   =  0;
+    size_t                        ibase   =  0;
+    GLenum                        itype   =  cgGlIndexType(ddp->IndexType, isize);
+    size_t                        rsize   =  itype != GL_NONE ? sizeof(cg_draw_indexed_indirect_command_t) : sizeof(cg_draw_indirect_command_t);
+    int                           result  =  CG_SUCCESS;
+
+    if (drawbuf == NULL || drawbuf->GraphicsBuffer == 0)
+    {   // the draw records must be stored in a buffer object visible to OpenGL.
+        return CG_INVALID_VALUE;
+    }
+    if (ddp->DrawOffset + size_t(ddp->MaxDrawCount - 1) * ddp->DrawStride + rsize > drawbuf->RequestedSize)
+    {   // the draw records extend past the end of the buffer.
+        return CG_INVALID_VALUE;
+    }
+    if (ddp->CountBuffer != CG_INVALID_HANDLE)
+    {
+        if ((cntbuf = cgObjectTableGet(&ctx->BufferTable, ddp->CountBuffer)) == NULL || cntbuf->GraphicsBuffer == 0)
+            return CG_INVALID_VALUE;
+        if (ddp->CountOffset + sizeof(uint32_t) > cntbuf->RequestedSize)
+            return CG_INVALID_VALUE;
+        if (!GLEW_ARB_indirect_parameters)
+            cntbuf  = NULL; // fall back to submitting every record.
+    }
+    if (!GLEW_VERSION_4_0 && !GLEW_ARB_draw_indirect)
+    {   // indirect drawing requires OpenGL 4.0 or GL_ARB_draw_indirect.
+        return CG_UNSUPPORTED;
+    }
+    if ((result = cgGraphicsGenericBindState(ctx, pipeline, ddp->VertexSource, ibase)) != CG_SUCCESS)
+    {   // the vertex data source is not valid. the index offset does not apply to indirect records.
+        return result;
+    }
+    cgGlBindBuffer(display, GL_DRAW_INDIRECT_BUFFER, drawbuf->GraphicsBuffer);
+
+    GLenum  mode   = pipeline->Topology;
+    GLsizei maxdc  = GLsizei(ddp->MaxDrawCount);
+    GLsizei stride = GLsizei(ddp->DrawStride);
+    if (cntbuf != NULL)
+    {   // the GPU reads the number of records to draw, so culling never requires a readback.
+        cgGlBindBuffer(display, GL_PARAMETER_BUFFER_ARB, cntbuf->GraphicsBuffer);
+        if (itype != GL_NONE)
+            glMultiDrawElementsIndirectCountARB(mode, itype, CG_GL_BUFFER_OFFSET(ddp->DrawOffset), GLintptr(ddp->CountOffset), maxdc, stride);
+        else
+            glMultiDrawArraysIndirectCountARB  (mode,        CG_GL_BUFFER_OFFSET(ddp->DrawOffset), GLintptr(ddp->CountOffset), maxdc, stride);
+    }
+    else if (GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect)
+    {   // submit every record with a single call.
+        if (itype != GL_NONE)
+            glMultiDrawElementsIndirect(mode, itype, CG_GL_BUFFER_OFFSET(ddp->DrawOffset), maxdc, stride);
+        else
+            glMultiDrawArraysIndirect  (mode,        CG_GL_BUFFER_OFFSET(ddp->DrawOffset), maxdc, stride);
+    }
+    else
+    {   // OpenGL 4.0 can only source one record per call, but still avoids the readback.
+        for (size_t i = 0, n = size_t(ddp->MaxDrawCount); i < n; ++i)
+        {
+            GLvoid const *record = CG_GL_BUFFER_OFFSET(ddp->DrawOffset + i * ddp->DrawStride);
+            if (itype != GL_NONE)
+                glDrawElementsIndirect(mode, itype, record);
+            else
+                glDrawArraysIndirect  (mode,        record);
+        }
+    }
+    return CG_SUCCESS;
+}
+
+/// @summary Implements the SET_UNIFORM_BLOCK command for the GENERIC graphics pipeline. The block data is copied into 
+/// the uniform ring of the rendering context and the range is bound to the block's binding point, replacing the 
+/// per-uniform glUniform* calls with a single buffer bind.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX graphics command queue.
+/// @param pipeline The CGFX pipeline state being executed.
+/// @param bdp The graphics pipeline dispatch command data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_OUT_OF_MEMORY or another result code.
+internal_function int
+cgExecuteGraphicsGenericSetUniformBlock
+(
+    CG_CONTEXT             *ctx, 
+    CG_QUEUE               *queue, 
+    CG_GRAPHICS_PIPELINE   *pipeline, 
+    cg_pipeline_cmd_data_t *bdp
+)
+{   UNREFERENCED_PARAMETER(ctx);
+    UNREFERENCED_PARAMETER(queue);
+    CG_GFX_GENERIC_SET_UNIFORM_BLOCK *ddp     = (CG_GFX_GENERIC_SET_UNIFORM_BLOCK*) bdp->ArgsData;
+    CG_DISPLAY                       *display =  pipeline->AttachedDisplay;
+    CG_GLSL_PROGRAM const            &glsl    =  pipeline->ShaderProgram;
+    CG_GLSL_UNIFORM_BLOCK const      *block   =  NULL;
+    GLintptr                          offset  =  0;
+    int                               result  =  CG_SUCCESS;
+
+    for (size_t i = 0, n = glsl.UniformBlockCount; i < n; ++i)
+    {
+        if (glsl.UniformBlockNames[i] == ddp->BlockName)
+        {
+            block = &glsl.UniformBlocks[i];
+            break;
+        }
+    }
+    if (block == NULL || ddp->DataSize < block->DataSize)
+    {   // the program has no such block, or the data would not cover it.
+        return CG_INVALID_VALUE;
+    }
+    if ((result = cgGlUniformRingWrite(display, ddp->Data, ddp->DataSize, offset)) != CG_SUCCESS)
+    {   // the ring could not be created, or the data is larger than the ring.
+        return result;
+    }
+    cgGlBindBufferRange(display, GL_UNIFORM_BUFFER, block->Binding, display->UniformRing->Buffer, offset, GLsizeiptr(ddp->DataSize));
+    return CG_SUCCESS;
+}
+
+/// @summary Implements the SET_RENDER_TARGET command for the GENERIC graphics pipeline. Binding an image also sets the 
+/// viewport to cover the selected level; binding the default framebuffer leaves the viewport unchanged.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX graphics command queue.
+/// @param pipeline The CGFX pipeline state being executed.
+/// @param bdp The graphics pipeline dispatch command data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_INVALID_STATE, CG_BAD_GLCONTEXT or another result code.
+internal_function int
+cgExecuteGraphicsGenericSetRenderTarget
+(
+    CG_CONTEXT             *ctx, 
+    CG_QUEUE               *queue, 
+    CG_GRAPHICS_PIPELINE   *pipeline, 
+    cg_pipeline_cmd_data_t *bdp
+)
+{   UNREFERENCED_PARAMETER(queue);
+    CG_GFX_GENERIC_SET_RENDER_TARGET *ddp     = (CG_GFX_GENERIC_SET_RENDER_TARGET*) bdp->ArgsData;
+    CG_DISPLAY                       *display =  pipeline->AttachedDisplay;
+    CG_GL_STATE_CACHE                *cache   =  display->GLState;
+    CG_IMAGE                         *color   =  NULL;
+    CG_IMAGE                         *depth   =  NULL;
+    GLbitfield                        clear   =  0;
+    int                               result  =  CG_SUCCESS;
+
+    if (ddp->ColorTarget != CG_INVALID_HANDLE && (color = cgObjectTableGet(&ctx->ImageTable, ddp->ColorTarget)) == NULL)
+        return CG_INVALID_VALUE;
+    if (ddp->DepthTarget != CG_INVALID_HANDLE && (depth = cgObjectTableGet(&ctx->ImageTable, ddp->DepthTarget)) == NULL)
+        return CG_INVALID_VALUE;
+    if ((result = cgGlBindRenderTarget(display, color, depth, GLint(ddp->Level))) != CG_SUCCESS)
+        return result;
+    if (color != NULL)
+    {   // cover the entire level being rendered into.
+        size_t w = color->ImageWidth  >> ddp->Level;
+        size_t h = color->ImageHeight >> ddp->Level;
+        cgGlViewport(display, 0, 0, GLsizei(w > 0 ? w : 1), GLsizei(h > 0 ? h : 1));
+    }
+    if (ddp->Clear)
+    {   // depth is only cleared if writes are enabled; force them on and let the next draw restore its state.
+        glClearColor(ddp->ClearColor[0], ddp->ClearColor[1], ddp->ClearColor[2], ddp->ClearColor[3]);
+        clear  = GL_COLOR_BUFFER_BIT;
+        if (color == NULL || depth != NULL)
+        {
+            glDepthMask(GL_TRUE);
+            glClearDepth(1.0);
+            cache->DepthStencilValid = false;
+            clear |= GL_DEPTH_BUFFER_BIT;
+        }
+        glClear(clear);
+    }
+    return CG_SUCCESS;
+}
+
+/// @summary Implements the READ_PIXELS command for the GENERIC graphics pipeline. The pack buffer binding makes 
+/// glReadPixels return as soon as the copy is queued; the host only waits when it maps the buffer, and not at all if 
+/// it maps after the done event has signaled. Rows are tightly packed, as returned by cgImageRowPitch.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX graphics command queue.
+/// @param pipeline The CGFX pipeline state being executed.
+/// @param bdp The graphics pipeline dispatch command data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_UNSUPPORTED, CG_INVALID_STATE or another result code.
+internal_function int
+cgExecuteGraphicsGenericReadPixels
+(
+    CG_CONTEXT             *ctx, 
+    CG_QUEUE               *queue, 
+    CG_GRAPHICS_PIPELINE   *pipeline, 
+    cg_pipeline_cmd_data_t *bdp
+)
+{   UNREFERENCED_PARAMETER(queue);
+    CG_GFX_GENERIC_READ_PIXELS *ddp     = (CG_GFX_GENERIC_READ_PIXELS*) bdp->ArgsData;
+    CG_DISPLAY                 *display =  pipeline->AttachedDisplay;
+    CG_BUFFER                  *target  =  cgObjectTableGet(&ctx->BufferTable, ddp->TargetBuffer);
+    CG_IMAGE                   *source  =  NULL;
+    uint32_t                    format  =  DXGI_FORMAT_R8G8B8A8_UNORM;
+    GLenum                      layout  =  GL_NONE;
+    GLenum                      type    =  GL_NONE;
+    GLenum                      glerr   =  GL_NO_ERROR;
+    int                         result  =  CG_SUCCESS;
+
+    if (target == NULL || target->GraphicsBuffer == 0)
+    {   // the pixels must be written to a buffer object visible to OpenGL.
+        return CG_INVALID_VALUE;
+    }
+    if (ddp->SourceImage != CG_INVALID_HANDLE)
+    {   // pixels are returned in the format of the image.
+        if ((source = cgObjectTableGet(&ctx->ImageTable, ddp->SourceImage)) == NULL)
+            return CG_INVALID_VALUE;
+        if (cgPixelFormatIsBlockCompressed(source->DxgiFormat))
+            return CG_UNSUPPORTED; // glReadPixels cannot return compressed blocks.
+        format = source->DxgiFormat;
+        if (size_t(ddp->X + ddp->Width ) > cgImageLevelDimension(format, source->ImageWidth , size_t(ddp->Level)) || 
+            size_t(ddp->Y + ddp->Height) > cgImageLevelDimension(format, source->ImageHeight, size_t(ddp->Level)))
+            return CG_INVALID_VALUE;
+    }
+    // images and the render target are read with the client format and type that uploads of the same format use.
+    if (!cgGlPixelTransferFormat(format, layout, type))
+    {   // OpenGL cannot transfer pixels of this format.
+        return CG_UNSUPPORTED;
+    }
+    if (ddp->TargetOffset + cgImageSlicePitch(format, size_t(ddp->Width), size_t(ddp->Height)) > target->RequestedSize)
+    {   // the pixels would extend past the end of the buffer.
+        return CG_INVALID_VALUE;
+    }
+    if ((result = cgGlBindReadSource(display, source, GLint(ddp->Level))) != CG_SUCCESS)
+    {   // the image cannot be read, or the level is invalid.
+        return result;
+    }
+    glGetError(); // clear any pending error.
+    glBindBuffer (GL_PIXEL_PACK_BUFFER, target->GraphicsBuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels (GLint(ddp->X), GLint(ddp->Y), GLsizei(ddp->Width), GLsizei(ddp->Height), layout, type, CG_GL_BUFFER_OFFSET(ddp->TargetOffset));
+    glerr = glGetError();
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindBuffer (GL_PIXEL_PACK_BUFFER, 0);
+    switch (glerr)
+    {   // the result is returned along with the completion event, which is not signaled on failure.
+    case GL_NO_ERROR                     : return CG_SUCCESS;
+    case GL_INVALID_OPERATION            : return CG_INVALID_STATE;
+    case GL_INVALID_FRAMEBUFFER_OPERATION: return CG_INVALID_STATE;
+    case GL_OUT_OF_MEMORY                : return CG_OUT_OF_MEMORY;
+    default                              : return CG_INVALID_VALUE;
+    }
+}
+
+/// @summary Implements the UPLOAD_IMAGE command for the GENERIC graphics pipeline. With the data buffer bound as the 
+/// pixel unpack buffer, glTexSubImage and glCompressedTexSubImage only queue the copy, and the driver performs it with 
+/// the DMA engine while subsequent commands execute. Block-compressed images are written in whole 4x4 blocks.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX graphics command queue.
+/// @param pipeline The CGFX pipeline state being executed.
+/// @param bdp The graphics pipeline dispatch command data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_UNSUPPORTED or another result code.
+internal_function int
+cgExecuteGraphicsGenericUploadImage
+(
+    CG_CONTEXT             *ctx, 
+    CG_QUEUE               *queue, 
+    CG_GRAPHICS_PIPELINE   *pipeline, 
+    cg_pipeline_cmd_data_t *bdp
+)
+{   UNREFERENCED_PARAMETER(queue);
+    CG_GFX_GENERIC_UPLOAD_IMAGE *ddp     = (CG_GFX_GENERIC_UPLOAD_IMAGE*) bdp->ArgsData;
+    CG_DISPLAY                  *display =  pipeline->AttachedDisplay;
+    CG_BUFFER                   *source  =  cgObjectTableGet(&ctx->BufferTable, ddp->SourceBuffer);
+    CG_IMAGE                    *target  =  cgObjectTableGet(&ctx->ImageTable , ddp->TargetImage);
+    GLvoid const                *pixels  =  CG_GL_BUFFER_OFFSET(ddp->SourceOffset);
+    size_t                       pitch   =  ddp->SourceRowPitch;
+    size_t                       bpp     =  0;
+    size_t                       level_w =  0;
+    size_t                       level_h =  0;
+    size_t                       level_d =  0;
+    size_t                       nbytes  =  0;
+    uint32_t                     format  =  0;
+    bool                         blocks  =  false;
+
+    if (source == NULL || source->GraphicsBuffer == 0 || target == NULL || target->GraphicsImage == 0)
+    {   // both objects must be visible to OpenGL.
+        return CG_INVALID_VALUE;
+    }
+    if (size_t(ddp->Level) >= target->LevelCount)
+    {   // the mipmap level does not exist.
+        return CG_INVALID_VALUE;
+    }
+    if (target->DefaultTarget != GL_TEXTURE_1D && target->DefaultTarget != GL_TEXTURE_2D && 
+        target->DefaultTarget != GL_TEXTURE_3D && target->DefaultTarget != GL_TEXTURE_2D_ARRAY)
+    {   // 1D array images address their items with the y-coordinate, which this command does not support.
+        return CG_UNSUPPORTED;
+    }
+    format  = target->DxgiFormat;
+    blocks  = cgPixelFormatIsBlockCompressed(format);
+    level_w = cgImageLevelDimension(format, target->ImageWidth , size_t(ddp->Level));
+    level_h = cgImageLevelDimension(format, target->ImageHeight, size_t(ddp->Level));
+    level_d = target->DefaultTarget == GL_TEXTURE_3D ? cgImageLevelDimension(format, target->SliceCount, size_t(ddp->Level)) : target->ArrayCount;
+    if (size_t(ddp->X + ddp->Width) > level_w || size_t(ddp->Y + ddp->Height) > level_h || size_t(ddp->Z + ddp->Depth) > level_d)
+    {   // the region extends past the edge of the level.
+        return CG_INVALID_VALUE;
+    }
+    if (blocks)
+    {   // compressed regions start on a block boundary and cover whole blocks, except at the edge of the level.
+        if ((ddp->X & 3) != 0 || (ddp->Y & 3) != 0)
+            return CG_INVALID_VALUE;
+        if ((ddp->Width  & 3) != 0 && size_t(ddp->X + ddp->Width ) != level_w)
+            return CG_INVALID_VALUE;
+        if ((ddp->Height & 3) != 0 && size_t(ddp->Y + ddp->Height) != level_h)
+            return CG_INVALID_VALUE;
+        if (pitch != 0 && pitch != cgImageRowPitch(format, size_t(ddp->Width)))
+            return CG_INVALID_VALUE; // rows of blocks are always tightly packed.
+        nbytes = cgImageSlicePitch(format, size_t(ddp->Width), size_t(ddp->Height)) * size_t(ddp->Depth);
+    }
+    else
+    {   // uncompressed rows may be padded in the source buffer, but only by whole pixels.
+        bpp    = cgImageRowPitch(format, 1);
+        pitch  = pitch != 0 ? pitch : cgImageRowPitch(format, size_t(ddp->Width));
+        if (bpp == 0 || (pitch % bpp) != 0 || pitch < cgImageRowPitch(format, size_t(ddp->Width)))
+            return CG_INVALID_VALUE;
+        nbytes = pitch * size_t(ddp->Height) * size_t(ddp->Depth);
+    }
+    if (ddp->SourceOffset + nbytes > source->RequestedSize)
+    {   // the pixel data extends past the end of the buffer.
+        return CG_INVALID_VALUE;
+    }
+
+    cgGlBindTexture(display, 0, target->DefaultTarget, target->GraphicsImage);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, source->GraphicsBuffer);
+    if (blocks)
+    {
+        switch (target->DefaultTarget)
+        {
+        case GL_TEXTURE_1D:
+            glCompressedTexSubImage1D(GL_TEXTURE_1D, ddp->Level, ddp->X, ddp->Width, target->InternalFormat, GLsizei(nbytes), pixels);
+            break;
+        case GL_TEXTURE_2D:
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, ddp->Level, ddp->X, ddp->Y, ddp->Width, ddp->Height, target->InternalFormat, GLsizei(nbytes), pixels);
+            break;
+        default:
+            glCompressedTexSubImage3D(target->DefaultTarget, ddp->Level, ddp->X, ddp->Y, ddp->Z, ddp->Width, ddp->Height, ddp->Depth, target->InternalFormat, GLsizei(nbytes), pixels);
+            break;
+        }
+    }
+    else
+    {   // describe the source layout; the pixel store state is restored to the defaults afterwards.
+        glPixelStorei(GL_UNPACK_ALIGNMENT , 1);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, GLint(pitch / bpp));
+        switch (target->DefaultTarget)
+        {
+        case GL_TEXTURE_1D:
+            glTexSubImage1D(GL_TEXTURE_1D, ddp->Level, ddp->X, ddp->Width, target->BaseFormat, target->DataType, pixels);
+            break;
+        case GL_TEXTURE_2D:
+            glTexSubImage2D(GL_TEXTURE_2D, ddp->Level, ddp->X, ddp->Y, ddp->Width, ddp->Height, target->BaseFormat, target->DataType, pixels);
+            break;
+        default:
+            glTexSubImage3D(target->DefaultTarget, ddp->Level, ddp->X, ddp->Y, ddp->Z, ddp->Width, ddp->Height, ddp->Depth, target->BaseFormat, target->DataType, pixels);
+            break;
+        }
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT , 4);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return CG_SUCCESS;
+}
+
+/// @summary Primary command dispatch function for the GENERIC graphics pipeline.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX graphics command queue.
+/// @param cmdbuf The CGFX command buffer being submitted to the command queue.
+/// @param pipeline The CGFX pipeline object being executed.
+/// @param cmd The graphics pipeline dispatch command data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_UNSUPPORTED, CG_BAD_GLCONTEXT, CG_ERROR or another result code.
+internal_function int
+cgExecuteGraphicsPipelineGeneric
+(
+    CG_CONTEXT    *ctx, 
+    CG_QUEUE      *queue, 
+    CG_CMD_BUFFER *cmdbuf,
+    CG_PIPELINE   *pipeline, 
+    cg_command_t  *cmd
+)
+{   UNREFERENCED_PARAMETER(cmdbuf);
+    int                     res =  CG_SUCCESS;
+    cg_pipeline_cmd_data_t *bdp = (cg_pipeline_cmd_data_t*) cmd->Data;
+    CG_GRAPHICS_PIPELINE    *gp = &pipeline->Graphics;
+    if (pipeline->PipelineType != CG_PIPELINE_TYPE_GRAPHICS)
+    {   // the generic pipeline can only execute graphics programs.
+        return CG_INVALID_VALUE;
+    }
+    switch (bdp->PipelineCmd)
+    {
+    case CG_GRAPHICS_GENERIC_CMD_SET_VIEWPORT:
+        res = cgExecuteGraphicsGenericSetViewport(ctx, queue, gp, bdp);
+        break;
+    case CG_GRAPHICS_GENERIC_CMD_DRAW:
+        res = cgExecuteGraphicsGenericDraw(ctx, queue, gp, bdp);
+        break;
+    case CG_GRAPHICS_GENERIC_CMD_DRAW_INDIRECT:
+        res = cgExecuteGraphicsGenericDrawIndirect(ctx, queue, gp, bdp);
+        break;
+    case CG_GRAPHICS_GENERIC_CMD_SET_UNIFORM_BLOCK:
+        res = cgExecuteGraphicsGenericSetUniformBlock(ctx, queue, gp, bdp);
+        break;
+    case CG_GRAPHICS_GENERIC_CMD_SET_RENDER_TARGET:
+        res = cgExecuteGraphicsGenericSetRenderTarget(ctx, queue, gp, bdp);
+        break;
+    case CG_GRAPHICS_GENERIC_CMD_READ_PIXELS:
+        res = cgExecuteGraphicsGenericReadPixels(ctx, queue, gp, bdp);
+        break;
+    case CG_GRAPHICS_GENERIC_CMD_UPLOAD_IMAGE:
+        res = cgExecuteGraphicsGenericUploadImage(ctx, queue, gp, bdp);
+        break;
+    default:
+        res = CG_COMMAND_NOT_IMPLEMENTED;
+        break;
+    }
+    return cgSetupGraphicsCompleteEvent(ctx, queue, gp->AttachedDisplay, bdp->CompleteEvent, res);
+}
+
+/// @summary Reserve space for a GENERIC graphics pipeline command in a command buffer and fill out the common command header.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param cmd_buffer The handle of the command buffer to write to.
+/// @param pipeline The handle of a graphics pipeline object.
+/// @param command_id One of cg_graphics_pipeline_generic_command_id_e.
+/// @param args_size The size of the command arguments, in bytes.
+/// @param done_event The handle of the event to signal when the command has been executed, or CG_INVALID_HANDLE.
+/// @param wait_event The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+/// @param args On return, points to the command argument data to fill out.
+/// @return CG_SUCCESS, CG_BUFFER_TOO_SMALL or another result code.
+internal_function int
+cgGraphicsGenericMapAppend
+(
+    uintptr_t   context, 
+    cg_handle_t cmd_buffer, 
+    cg_handle_t pipeline, 
+    uint16_t    command_id, 
+    size_t      args_size, 
+    cg_handle_t done_event, 
+    cg_handle_t wait_event, 
+    void      **args
+)
+{
+    int           result   = CG_SUCCESS;
+    cg_command_t *cmd      = NULL;
+    size_t const  cmd_size = sizeof(cg_pipeline_cmd_base_t) + args_size;
+    if ((result = cgCommandBufferMapAppend(context, cmd_buffer, cmd_size, &cmd)) != CG_SUCCESS)
+        return result;
+
+    cg_pipeline_cmd_data_t *bdp = (cg_pipeline_cmd_data_t*) cmd->Data;
+    cmd->CommandId     = CG_COMMAND_PIPELINE_DISPATCH;
+    cmd->DataSize      = uint16_t(cmd_size);
+    bdp->PipelineId    = CG_GRAPHICS_PIPELINE_GENERIC;
+    bdp->PipelineCmd   = command_id;
+    bdp->ArgsDataSize  = uint16_t(args_size);
+    bdp->ReservedU16   = 0; // unused
+    bdp->WaitEvent     = wait_event;
+    bdp->CompleteEvent = done_event;
+    bdp->Pipeline      = pipeline;
+   *args               = bdp->ArgsData;
+    // any graphics pipeline can be drawn generically, so register on first use.
+    cgSetGraphicsPipelineCallback(CG_GRAPHICS_PIPELINE_GENERIC, cgExecuteGraphicsPipelineGeneric);
+    return CG_SUCCESS;
+}
+
 /*////////////////////////
 //   Public Functions   //
 ////////////////////////*/
@@ -265,7 +969,9 @@ cgCreateGraphicsPipelineTest01
 
     static char const *vs_code = 
         "#version 150\n"
-        "uniform mat4 uMSS;\n"
+        "layout(std140) uniform Transform {\n"
+        "    mat4 uMSS;\n"
+        "};\n"
         "in      vec3 aPOS;\n"
         "in      vec4 aCLR;\n"
         "out     vec4 vCLR;\n"
@@ -277,6 +983,7 @@ cgCreateGraphicsPipelineTest01
     vss.CodeSize = strlen(vs_code)+1;
     vss.Type     = CG_KERNEL_TYPE_GRAPHICS_VERTEX;
     vss.Flags    = CG_KERNEL_FLAGS_SOURCE;
+    vss.Options  = NULL;
     if ((vs = cgCreateKernel(context, exec_group, &vss, result)) == CG_INVALID_HANDLE)
     {   // unable to compile the vertex shader source code.
         return CG_INVALID_HANDLE;
@@ -293,6 +1000,7 @@ cgCreateGraphicsPipelineTest01
     fss.CodeSize = strlen(fs_code)+1;
     fss.Type     = CG_KERNEL_TYPE_GRAPHICS_FRAGMENT;
     fss.Flags    = CG_KERNEL_FLAGS_SOURCE;
+    fss.Options  = NULL;
     if ((fs = cgCreateKernel(context, exec_group, &fss, result)) == CG_INVALID_HANDLE)
     {   // unable to compiler the fragment shader source code.
         cgDeleteObject(context, vs);
@@ -329,13 +1037,14 @@ cgCreateGraphicsPipelineTest01
     }
     // initialize the viewport to (0, 0)->(0,0).
     // initialize the MVP matrix to identity.
-    // retrieve the uniform record for the MVP matrix.
+    // retrieve the uniform block record for the MVP matrix.
     CG_PIPELINE          *PO = cgObjectTableGet(&ctx->PipelineTable, pipeline);
     CG_GRAPHICS_PIPELINE &PG = PO->Graphics;
     CG_GLSL_PROGRAM      &PS = PG.ShaderProgram;
     memset(state, 0, sizeof(CG_GFX_TEST01_STATE));
     state->MVP[0] =  state->MVP[5] = state->MVP[10] = state->MVP[15] = 1.0f;
-    state->uMSS   =  cgFindItemByName("uMSS", PS.UniformNames, PS.UniformCount, PS.Uniforms);
+    state->MVPDirty = true;
+    state->Transform = cgFindItemByName("Transform", PS.UniformBlockNames, PS.UniformBlockCount, PS.UniformBlocks);
     cgSetGraphicsPipelineCallback(CG_GRAPHICS_PIPELINE_TEST01, cgExecuteGraphicsPipelineTest01);
     return pipeline;
 }
@@ -477,3 +1186,367 @@ cgGraphicsTest01DrawTriangles
     ddp->PrimitiveCount= num_triangles;
     return cgCommandBufferUnmapAppend(context, cmd_buffer, cmd_size);
 }
+
+/// @summary Enqueues a SET_VIEWPORT command for the GENERIC graphics pipeline. Any graphics pipeline can be used; the 
+/// viewport remains in effect for subsequent GENERIC draw commands on the same rendering context.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param cmd_buffer The handle of the command buffer to write to.
+/// @param pipeline The handle of a graphics pipeline object.
+/// @param x The x-coordinate of the upper-left corner of the viewport.
+/// @param y The y-coordinate of the upper-left corner of the viewport.
+/// @param width The width of the viewport, in pixels.
+/// @param height The height of the viewport, in pixels.
+/// @param done_event The handle of the event to signal when the command has been executed, or CG_INVALID_HANDLE.
+/// @param wait_event The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_BUFFER_TOO_SMALL or another result code.
+library_function int 
+cgGraphicsSetViewport
+(
+    uintptr_t   context,
+    cg_handle_t cmd_buffer,
+    cg_handle_t pipeline,
+    int         x,
+    int         y,
+    int         width,
+    int         height,
+    cg_handle_t done_event,
+    cg_handle_t wait_event
+)
+{
+    int                          result = CG_SUCCESS;
+    CG_GFX_GENERIC_SET_VIEWPORT *ddp    = NULL;
+    if (width < 0 || height < 0)
+        return CG_INVALID_VALUE;
+    if ((result = cgGraphicsGenericMapAppend(context, cmd_buffer, pipeline, CG_GRAPHICS_GENERIC_CMD_SET_VIEWPORT, sizeof(CG_GFX_GENERIC_SET_VIEWPORT), done_event, wait_event, (void**) &ddp)) != CG_SUCCESS)
+        return result;
+
+    ddp->X      = x;
+    ddp->Y      = y;
+    ddp->Width  = width;
+    ddp->Height = height;
+    return cgCommandBufferUnmapAppend(context, cmd_buffer, sizeof(cg_pipeline_cmd_base_t) + sizeof(CG_GFX_GENERIC_SET_VIEWPORT));
+}
+
+/// @summary Enqueues a DRAW command for the GENERIC graphics pipeline, which draws one or more instances of a range of 
+/// vertices or indices with a single command and a single OpenGL draw call. Per-instance data can be supplied through 
+/// vertex attributes with a non-zero InstanceDivisor, or indexed in the shader by gl_InstanceID.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param cmd_buffer The handle of the command buffer to write to.
+/// @param pipeline The handle of a graphics pipeline object.
+/// @param data_source The handle of the vertex data source buffers.
+/// @param index_type One of cg_graphics_index_type_e specifying the index data type.
+/// @param first The zero-based index of the first index to read, or of the first vertex if @a index_type is CG_GRAPHICS_INDEX_NONE.
+/// @param count The number of indices or vertices to read for each instance.
+/// @param base_vertex The offset value added to each index read from the index buffer. Ignored for non-indexed draws.
+/// @param instance_count The number of instances to draw.
+/// @param base_instance The value added to the instance index when reading per-instance attributes. Non-zero values require OpenGL 4.2.
+/// @param done_event The handle of the event to signal when the command has been executed, or CG_INVALID_HANDLE.
+/// @param wait_event The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_BUFFER_TOO_SMALL or another result code.
+library_function int 
+cgGraphicsDrawInstanced
+(
+    uintptr_t   context,
+    cg_handle_t cmd_buffer,
+    cg_handle_t pipeline,
+    cg_handle_t data_source, 
+    int         index_type, 
+    uint32_t    first, 
+    uint32_t    count, 
+    int32_t     base_vertex, 
+    uint32_t    instance_count, 
+    uint32_t    base_instance, 
+    cg_handle_t done_event,
+    cg_handle_t wait_event
+)
+{
+    int                  result = CG_SUCCESS;
+    CG_GFX_GENERIC_DRAW *ddp    = NULL;
+    if (index_type < CG_GRAPHICS_INDEX_NONE || index_type > CG_GRAPHICS_INDEX_UINT32 || count == 0 || instance_count == 0)
+        return CG_INVALID_VALUE;
+    if ((result = cgGraphicsGenericMapAppend(context, cmd_buffer, pipeline, CG_GRAPHICS_GENERIC_CMD_DRAW, sizeof(CG_GFX_GENERIC_DRAW), done_event, wait_event, (void**) &ddp)) != CG_SUCCESS)
+        return result;
+
+    ddp->VertexSource  = data_source;
+    ddp->IndexType     = index_type;
+    ddp->First         = first;
+    ddp->Count         = count;
+    ddp->BaseVertex    = index_type != CG_GRAPHICS_INDEX_NONE ? base_vertex : 0;
+    ddp->InstanceCount = instance_count;
+    ddp->BaseInstance  = base_instance;
+    return cgCommandBufferUnmapAppend(context, cmd_buffer, sizeof(cg_pipeline_cmd_base_t) + sizeof(CG_GFX_GENERIC_DRAW));
+}
+
+/// @summary Enqueues a DRAW_INDIRECT command for the GENERIC graphics pipeline. The draw records, and optionally the 
+/// number of records, are read from data buffers by the GPU, so a compute kernel can build the draw list (for example, 
+/// by culling) and the whole list is submitted with one command. Records are cg_draw_indexed_indirect_command_t for 
+/// indexed draws, or cg_draw_indirect_command_t if @a index_type is CG_GRAPHICS_INDEX_NONE. The draw count is read from 
+/// @a count_buffer if GL_ARB_indirect_parameters is available; otherwise @a max_draw_count records are drawn, so kernels 
+/// should write an InstanceCount of zero into unused records. FirstIndex values are relative to the start of the index 
+/// buffer; the index offset of the vertex data source is not applied. When the buffers are written by a compute queue, 
+/// insert a graphics fence linked to the compute completion event before this command.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param cmd_buffer The handle of the command buffer to write to.
+/// @param pipeline The handle of a graphics pipeline object.
+/// @param data_source The handle of the vertex data source buffers.
+/// @param index_type One of cg_graphics_index_type_e specifying the index data type and the draw record layout.
+/// @param draw_buffer The handle of the data buffer containing the draw records.
+/// @param draw_offset The byte offset of the first draw record in @a draw_buffer. Must be a multiple of 4.
+/// @param max_draw_count The maximum number of draw records to read.
+/// @param draw_stride The number of bytes between draw records, or 0 if the records are tightly packed.
+/// @param count_buffer The handle of a data buffer containing a 32-bit draw count, or CG_INVALID_HANDLE.
+/// @param count_offset The byte offset of the draw count within @a count_buffer. Must be a multiple of 4.
+/// @param done_event The handle of the event to signal when the command has been executed, or CG_INVALID_HANDLE.
+/// @param wait_event The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_BUFFER_TOO_SMALL or another result code.
+library_function int 
+cgGraphicsDrawIndirect
+(
+    uintptr_t   context,
+    cg_handle_t cmd_buffer,
+    cg_handle_t pipeline,
+    cg_handle_t data_source, 
+    int         index_type, 
+    cg_handle_t draw_buffer, 
+    size_t      draw_offset, 
+    uint32_t    max_draw_count, 
+    uint32_t    draw_stride, 
+    cg_handle_t count_buffer, 
+    size_t      count_offset, 
+    cg_handle_t done_event,
+    cg_handle_t wait_event
+)
+{
+    int                           result = CG_SUCCESS;
+    CG_GFX_GENERIC_DRAW_INDIRECT *ddp    = NULL;
+    size_t const                  rsize  = index_type != CG_GRAPHICS_INDEX_NONE ? sizeof(cg_draw_indexed_indirect_command_t) : sizeof(cg_draw_indirect_command_t);
+    if (index_type < CG_GRAPHICS_INDEX_NONE || index_type > CG_GRAPHICS_INDEX_UINT32 || draw_buffer == CG_INVALID_HANDLE || max_draw_count == 0)
+        return CG_INVALID_VALUE;
+    if ((draw_offset & 3) != 0 || (count_offset & 3) != 0 || (draw_stride & 3) != 0 || (draw_stride != 0 && draw_stride < rsize))
+        return CG_INVALID_VALUE;
+    if ((result = cgGraphicsGenericMapAppend(context, cmd_buffer, pipeline, CG_GRAPHICS_GENERIC_CMD_DRAW_INDIRECT, sizeof(CG_GFX_GENERIC_DRAW_INDIRECT), done_event, wait_event, (void**) &ddp)) != CG_SUCCESS)
+        return result;
+
+    ddp->VertexSource  = data_source;
+    ddp->DrawBuffer    = draw_buffer;
+    ddp->CountBuffer   = count_buffer;
+    ddp->DrawOffset    = draw_offset;
+    ddp->CountOffset   = count_offset;
+    ddp->IndexType     = index_type;
+    ddp->MaxDrawCount  = max_draw_count;
+    ddp->DrawStride    = draw_stride != 0 ? draw_stride : uint32_t(rsize);
+    return cgCommandBufferUnmapAppend(context, cmd_buffer, sizeof(cg_pipeline_cmd_base_t) + sizeof(CG_GFX_GENERIC_DRAW_INDIRECT));
+}
+
+/// @summary Enqueues a SET_UNIFORM_BLOCK command for the GENERIC graphics pipeline. The data is copied into the command 
+/// buffer; at execution it is written once into a ring buffer shared by the rendering context and bound to the block 
+/// with glBindBufferRange. Per-draw constants should be grouped into a block and updated with this command before each 
+/// draw, rather than set one uniform at a time. The binding remains in effect for subsequent draws using the pipeline 
+/// within the same command buffer submission.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param cmd_buffer The handle of the command buffer to write to.
+/// @param pipeline The handle of a graphics pipeline object.
+/// @param block_name The name of the uniform block, as declared in the pipeline's shaders.
+/// @param data The block data, laid out as declared in the shader. Blocks declared with layout(std140) have a portable layout.
+/// @param data_size The number of bytes of block data. Must be at least the size of the block reported by the driver.
+/// @param done_event The handle of the event to signal when the command has been executed, or CG_INVALID_HANDLE.
+/// @param wait_event The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_BUFFER_TOO_SMALL or another result code.
+library_function int 
+cgGraphicsSetUniformBlock
+(
+    uintptr_t   context,
+    cg_handle_t cmd_buffer,
+    cg_handle_t pipeline,
+    char const *block_name, 
+    void const *data, 
+    size_t      data_size, 
+    cg_handle_t done_event,
+    cg_handle_t wait_event
+)
+{
+    int                               result    = CG_SUCCESS;
+    CG_GFX_GENERIC_SET_UNIFORM_BLOCK *ddp       = NULL;
+    size_t const                      args_size = offsetof(CG_GFX_GENERIC_SET_UNIFORM_BLOCK, Data) + data_size;
+    if (block_name == NULL || data == NULL || data_size == 0)
+        return CG_INVALID_VALUE;
+    if (sizeof(cg_pipeline_cmd_base_t) + args_size > 0xFFFFU)
+        return CG_INVALID_VALUE; // the command size must fit in cg_command_t::DataSize.
+    if ((result = cgGraphicsGenericMapAppend(context, cmd_buffer, pipeline, CG_GRAPHICS_GENERIC_CMD_SET_UNIFORM_BLOCK, args_size, done_event, wait_event, (void**) &ddp)) != CG_SUCCESS)
+        return result;
+
+    ddp->BlockName = cgHashName(block_name);
+    ddp->DataSize  = uint32_t(data_size);
+    memcpy(ddp->Data, data, data_size);
+    return cgCommandBufferUnmapAppend(context, cmd_buffer, sizeof(cg_pipeline_cmd_base_t) + args_size);
+}
+
+/// @summary Enqueues a SET_RENDER_TARGET command for the GENERIC graphics pipeline, which selects the images that 
+/// subsequent draw commands render into. Rendering into images does not require a visible drawable, so this is the 
+/// output path for execution groups created with CG_EXECUTION_GROUP_OFFSCREEN. Images created with graphics access 
+/// and shared with the compute context can be read back with cgMapImageRegion once the done event has signaled.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param cmd_buffer The handle of the command buffer to write to.
+/// @param pipeline The handle of a graphics pipeline object.
+/// @param color_image The handle of the 2D color image to render into, or CG_INVALID_HANDLE to render into the default framebuffer of the current drawable.
+/// @param depth_image The handle of a 2D depth image with the same dimensions as @a color_image, or CG_INVALID_HANDLE.
+/// @param level The mipmap level of the images to render into. The viewport is set to cover the level.
+/// @param clear_rgba The RGBA color the target is cleared to after it is bound, or NULL. Depth is cleared to 1.0 along with color.
+/// @param done_event The handle of the event to signal when the command has been executed, or CG_INVALID_HANDLE.
+/// @param wait_event The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_BUFFER_TOO_SMALL or another result code.
+library_function int 
+cgGraphicsSetRenderTarget
+(
+    uintptr_t   context,
+    cg_handle_t cmd_buffer,
+    cg_handle_t pipeline,
+    cg_handle_t color_image, 
+    cg_handle_t depth_image, 
+    size_t      level, 
+    float const*clear_rgba, 
+    cg_handle_t done_event,
+    cg_handle_t wait_event
+)
+{
+    int                               result = CG_SUCCESS;
+    CG_GFX_GENERIC_SET_RENDER_TARGET *ddp    = NULL;
+    if (color_image == CG_INVALID_HANDLE && (depth_image != CG_INVALID_HANDLE || level != 0))
+        return CG_INVALID_VALUE; // the default framebuffer has a single level and its own depth buffer.
+    if (level > 31)
+        return CG_INVALID_VALUE;
+    if ((result = cgGraphicsGenericMapAppend(context, cmd_buffer, pipeline, CG_GRAPHICS_GENERIC_CMD_SET_RENDER_TARGET, sizeof(CG_GFX_GENERIC_SET_RENDER_TARGET), done_event, wait_event, (void**) &ddp)) != CG_SUCCESS)
+        return result;
+
+    ddp->ColorTarget = color_image;
+    ddp->DepthTarget = depth_image;
+    ddp->Level       = int32_t(level);
+    ddp->Clear       = clear_rgba != NULL ? 1 : 0;
+    for (size_t i = 0; i < 4; ++i)
+        ddp->ClearColor[i] = clear_rgba != NULL ? clear_rgba[i] : 0.0f;
+    return cgCommandBufferUnmapAppend(context, cmd_buffer, sizeof(cg_pipeline_cmd_base_t) + sizeof(CG_GFX_GENERIC_SET_RENDER_TARGET));
+}
+
+/// @summary Enqueues a READ_PIXELS command for the GENERIC graphics pipeline, which copies a region of the current render 
+/// target or of an image level into a data buffer through a pixel pack buffer. The command does not wait for rendering 
+/// to finish; once @a done_event has signaled, mapping the buffer does not block. Rows are tightly packed starting at 
+/// @a target_offset, using the row pitch returned by cgImageRowPitch for the image format, or for DXGI_FORMAT_R8G8B8A8_UNORM 
+/// when reading the render target. Pixels have the same byte order as the data cgGraphicsUploadImage accepts for that 
+/// format. Rows are returned bottom-up, as OpenGL addresses them. Block-compressed images cannot be read. Use one buffer 
+/// per frame in flight to pipeline readback with rendering, for example for video capture.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param cmd_buffer The handle of the command buffer to write to.
+/// @param pipeline The handle of a graphics pipeline object.
+/// @param source_image The handle of the 2D image to read, or CG_INVALID_HANDLE to read the render target selected by cgGraphicsSetRenderTarget.
+/// @param level The mipmap level of the source image. Must be zero when reading the render target.
+/// @param x The x-coordinate of the lower-left corner of the region to read.
+/// @param y The y-coordinate of the lower-left corner of the region to read.
+/// @param width The width of the region to read, in pixels.
+/// @param height The height of the region to read, in pixels.
+/// @param target_buffer The handle of a data buffer created with CG_MEMORY_OBJECT_KERNEL_GRAPHICS that receives the pixels.
+/// @param target_offset The byte offset in @a target_buffer at which the first row is written.
+/// @param done_event The handle of the event to signal when the command has been executed, or CG_INVALID_HANDLE.
+/// @param wait_event The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_BUFFER_TOO_SMALL or another result code.
+library_function int 
+cgGraphicsReadPixels
+(
+    uintptr_t   context,
+    cg_handle_t cmd_buffer,
+    cg_handle_t pipeline,
+    cg_handle_t source_image, 
+    size_t      level, 
+    size_t      x, 
+    size_t      y, 
+    size_t      width, 
+    size_t      height, 
+    cg_handle_t target_buffer, 
+    size_t      target_offset, 
+    cg_handle_t done_event,
+    cg_handle_t wait_event
+)
+{
+    int                         result = CG_SUCCESS;
+    CG_GFX_GENERIC_READ_PIXELS *ddp    = NULL;
+    if (target_buffer == CG_INVALID_HANDLE || width == 0 || height == 0)
+        return CG_INVALID_VALUE;
+    if (source_image == CG_INVALID_HANDLE && level != 0)
+        return CG_INVALID_VALUE; // the render target is read at the level it was bound with.
+    if (level > 31 || x + width > 0x7FFFFFFFU || y + height > 0x7FFFFFFFU)
+        return CG_INVALID_VALUE;
+    if ((result = cgGraphicsGenericMapAppend(context, cmd_buffer, pipeline, CG_GRAPHICS_GENERIC_CMD_READ_PIXELS, sizeof(CG_GFX_GENERIC_READ_PIXELS), done_event, wait_event, (void**) &ddp)) != CG_SUCCESS)
+        return result;
+
+    ddp->SourceImage  = source_image;
+    ddp->TargetBuffer = target_buffer;
+    ddp->TargetOffset = target_offset;
+    ddp->Level        = int32_t(level);
+    ddp->X            = int32_t(x);
+    ddp->Y            = int32_t(y);
+    ddp->Width        = int32_t(width);
+    ddp->Height       = int32_t(height);
+    return cgCommandBufferUnmapAppend(context, cmd_buffer, sizeof(cg_pipeline_cmd_base_t) + sizeof(CG_GFX_GENERIC_READ_PIXELS));
+}
+
+/// @summary Enqueues an UPLOAD_IMAGE command for the GENERIC graphics pipeline, which copies pixel data from a data buffer 
+/// into a region of one level of an image through a pixel unpack buffer. The host fills the buffer, for example with 
+/// cgMapDataBuffer on a pinned buffer, and the copy then runs on the device while later commands render, instead of 
+/// moving through an OpenCL image map. Block-compressed data is passed through unchanged, so the region must start on a 
+/// 4x4 block boundary and cover whole blocks except at the edge of the level. Cube map images are not supported.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param cmd_buffer The handle of the command buffer to write to.
+/// @param pipeline The handle of a graphics pipeline object.
+/// @param source_buffer The handle of a data buffer created with CG_MEMORY_OBJECT_KERNEL_GRAPHICS containing the pixel data.
+/// @param source_offset The byte offset in @a source_buffer of the first row of the first slice.
+/// @param source_row_pitch The number of bytes between rows in @a source_buffer, a multiple of the pixel size, or 0 if rows are tightly packed. Rows of compressed blocks are always tightly packed.
+/// @param target_image The handle of an image created with CG_MEMORY_OBJECT_KERNEL_GRAPHICS.
+/// @param level The mipmap level of the image to write.
+/// @param xyz The x-coordinate, y-coordinate and slice or array index of the upper-left corner of the region to write.
+/// @param whd The width (in pixels), height (in pixels) and depth (in slices) of the region to write.
+/// @param done_event The handle of the event to signal when the command has been executed, or CG_INVALID_HANDLE.
+/// @param wait_event The handle of the event to wait on before executing the command, or CG_INVALID_HANDLE.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_BUFFER_TOO_SMALL or another result code.
+library_function int 
+cgGraphicsUploadImage
+(
+    uintptr_t   context,
+    cg_handle_t cmd_buffer,
+    cg_handle_t pipeline,
+    cg_handle_t source_buffer, 
+    size_t      source_offset, 
+    size_t      source_row_pitch, 
+    cg_handle_t target_image, 
+    size_t      level, 
+    size_t      xyz[3], 
+    size_t      whd[3], 
+    cg_handle_t done_event,
+    cg_handle_t wait_event
+)
+{
+    int                          result = CG_SUCCESS;
+    CG_GFX_GENERIC_UPLOAD_IMAGE *ddp    = NULL;
+    if (source_buffer == CG_INVALID_HANDLE || target_image == CG_INVALID_HANDLE || xyz == NULL || whd == NULL)
+        return CG_INVALID_VALUE;
+    if (whd[0] == 0 || whd[1] == 0 || whd[2] == 0 || level > 31)
+        return CG_INVALID_VALUE;
+    for (size_t i = 0; i < 3; ++i)
+    {   // the region is stored as 32-bit signed values, as OpenGL expects.
+        if (xyz[i] + whd[i] > 0x7FFFFFFFU)
+            return CG_INVALID_VALUE;
+    }
+    if ((result = cgGraphicsGenericMapAppend(context, cmd_buffer, pipeline, CG_GRAPHICS_GENERIC_CMD_UPLOAD_IMAGE, sizeof(CG_GFX_GENERIC_UPLOAD_IMAGE), done_event, wait_event, (void**) &ddp)) != CG_SUCCESS)
+        return result;
+
+    ddp->SourceBuffer   = source_buffer;
+    ddp->TargetImage    = target_image;
+    ddp->SourceOffset   = source_offset;
+    ddp->SourceRowPitch = source_row_pitch;
+    ddp->Level          = int32_t(level);
+    ddp->X              = int32_t(xyz[0]);
+    ddp->Y              = int32_t(xyz[1]);
+    ddp->Z              = int32_t(xyz[2]);
+    ddp->Width          = int32_t(whd[0]);
+    ddp->Height         = int32_t(whd[1]);
+    ddp->Depth          = int32_t(whd[2]);
+    return cgCommandBufferUnmapAppend(context, cmd_buffer, sizeof(cg_pipeline_cmd_base_t) + sizeof(CG_GFX_GENERIC_UPLOAD_IMAGE));
+}
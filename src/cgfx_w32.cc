@@ -55,14 +55,101 @@
 /*/////////////////
 //   Constants   //
 /////////////////*/
+/// @summary The minimum number of destination pixels in a mipmap level, across all items, before the host mipmap generator splits the level across threads.
+#define CG_HOST_MIPMAP_MIN_PARALLEL_PIXELS    (64 * 1024)
+
+/// @summary The number of work items created per thread for each mipmap level, so that threads finishing early can pick up more rows.
+#define CG_HOST_MIPMAP_TASKS_PER_THREAD       (4)
+
+/// @summary The minimum number of blocks in an image before the host block compressor splits the image across threads.
+#define CG_HOST_BC_MIN_PARALLEL_BLOCKS        (1024)
+
+/// @summary The number of work items created per thread by the host block compressor, so that threads finishing early can pick up more rows.
+#define CG_HOST_BC_TASKS_PER_THREAD           (4)
+
+/// @summary The maximum number of passes made by the exhaustive endpoint search at CG_BLOCK_COMPRESSION_QUALITY_HIGH.
+#define CG_BC_SEARCH_ROUNDS                   (8)
 
 /*///////////////////
 //   Local Types   //
 ///////////////////*/
+/// @summary Define the signature for a host mipmap row kernel, which downsamples two source rows into one destination row.
+typedef void (*cgHostMipRow_fn)(uint8_t *dst, uint8_t const *src0, uint8_t const *src1, size_t dst_width, size_t src_width);
+
+/// @summary Describes the generation of one mipmap level by the host mipmap generator. Work items are bands of destination 
+/// rows within a single array item, claimed by incrementing NextTask.
+struct CG_HOST_MIPMAP_JOB
+{
+    cgHostMipRow_fn               RowFunc;             /// The row kernel for the image format.
+    uint8_t                      *ImageData;           /// The start of the image data.
+    size_t                        ItemPitch;           /// The number of bytes between the start of consecutive array items.
+    size_t                        SrcOffset;           /// The byte offset of the source level from the start of an item.
+    size_t                        DstOffset;           /// The byte offset of the destination level from the start of an item.
+    size_t                        SrcWidth;            /// The width of the source level, in pixels.
+    size_t                        SrcHeight;           /// The height of the source level, in pixels.
+    size_t                        SrcRowPitch;         /// The number of bytes per-row in the source level.
+    size_t                        DstWidth;            /// The width of the destination level, in pixels.
+    size_t                        DstHeight;           /// The height of the destination level, in pixels.
+    size_t                        DstRowPitch;         /// The number of bytes per-row in the destination level.
+    size_t                        RowsPerTask;         /// The number of destination rows in each work item.
+    size_t                        TasksPerItem;        /// The number of work items for each array item.
+    LONG                          TaskCount;           /// The total number of work items.
+    LONG volatile                 NextTask;            /// The index of the next work item to claim.
+};
+
+/// @summary Define the ways the host block compressor encodes the color portion of a block.
+enum CG_BC_COLOR_MODE
+{
+    CG_BC_COLOR_MODE_BC1             = 0,              /// BC1 without transparent pixels. The four-color mode is used unless both endpoints are equal.
+    CG_BC_COLOR_MODE_BC1_ALPHA       = 1,              /// BC1 with transparent pixels, which require the three-color mode.
+    CG_BC_COLOR_MODE_BC3             = 2,              /// BC2 or BC3, which always decode the color block in four-color mode.
+};
+
+/// @summary Stores a 4x4 block of pixels being encoded by the host block compressor.
+struct CG_BC_BLOCK
+{
+    float                         Pixels[4][16];       /// The pixel values in [0, 255], indexed by channel and then by pixel.
+    float                         Weight[16];          /// 1 if the pixel contributes to the endpoint fit and the error, or 0.
+    size_t                        FirstChannel;        /// The index of the first channel being encoded.
+    size_t                        ChannelCount;        /// The number of channels being encoded.
+    int                           ColorMode;           /// One of CG_BC_COLOR_MODE, used when encoding BC1 or BC3 color.
+};
+
+/// @summary Define the signature for a function that evaluates a set of quantized endpoints for a block, returning the squared error.
+typedef float (*cgBcEvaluate_fn)(CG_BC_BLOCK const *block, int const *params, uint8_t *indices);
+
+/// @summary Describes the compression of an image by the host block compressor. Work items are bands of block rows, claimed 
+/// by incrementing NextTask.
+struct CG_HOST_BC_JOB
+{
+    uint8_t                      *Dst;                 /// The first block of the destination image.
+    size_t                        DstRowPitch;         /// The number of bytes between rows of blocks in the destination image.
+    uint8_t const                *Src;                 /// The first pixel of the source image.
+    size_t                        SrcRowPitch;         /// The number of bytes per-row in the source image.
+    size_t                        Width;               /// The width of the source image, in pixels.
+    size_t                        Height;              /// The height of the source image, in pixels.
+    size_t                        BlocksX;             /// The number of blocks in each row.
+    size_t                        BlocksY;             /// The number of rows of blocks.
+    size_t                        RowsPerTask;         /// The number of rows of blocks in each work item.
+    uint32_t                      Format;              /// The DXGI_FORMAT of the destination image.
+    int                           Quality;             /// One of cg_block_compression_quality_e.
+    LONG                          TaskCount;           /// The total number of work items.
+    LONG volatile                 NextTask;            /// The index of the next work item to claim.
+    LONG64 volatile               SquaredError;        /// The sum of squared errors of all encoded blocks.
+};
 
 /*///////////////
 //   Globals   //
 ///////////////*/
+/// @summary Maps 8-bit sRGB values to 16-bit linear values. Initialized by cgHostMipmapInitTables.
+global_variable uint32_t  Global_SRGBToLinear16[256];
+
+/// @summary Maps 16-bit linear values to 8-bit sRGB values. Padded so that AVX2 can gather it with 32-bit loads.
+global_variable uint8_t   Global_Linear16ToSRGB[65536 + 4];
+
+/// @summary Ensures that the host mipmap sRGB tables are initialized exactly once.
+global_variable INIT_ONCE Global_HostMipmapTablesInit = INIT_ONCE_STATIC_INIT;
+
 #ifdef _MSC_VER
 /// @summary When using the Microsoft Linker, __ImageBase is set to the base address of the DLL.
 /// This is the same as the HINSTANCE/HMODULE of the DLL passed to DllMain.
@@ -233,6 +320,30 @@ cgDeleteUserHostAllocator
     host->Allocate = cgHostMemAllocNoOp;
     host->Release  = cgHostMemFreeNoOp;
     host->UserData =(uintptr_t) 0;
+    host->ScratchArenas = NULL;
+    host->Counters      = NULL;
+    host->ScratchFlsIndex = FLS_OUT_OF_INDEXES;
+}
+
+/// @summary Release the scratch arena owned by a thread. Called by the system when the thread exits, or for every thread still owning an arena when the context frees its fiber-local storage index.
+/// @param data The CG_SCRATCH_ARENA claimed by the thread.
+internal_function void WINAPI
+cgScratchArenaThreadExit
+(
+    void *data
+)
+{
+    CG_SCRATCH_ARENA  *arena = (CG_SCRATCH_ARENA*) data;
+    CG_HOST_ALLOCATOR *host  =  arena->Host;
+    uint8_t           *base  =  arena->BaseAddress;
+    // detach the memory before releasing the slot so that context teardown does not free it again.
+    arena->BaseAddress = NULL;
+    arena->ArenaSize   = 0;
+    arena->NextOffset  = 0;
+    arena->TopBlock    = CG_SCRATCH_NO_BLOCK;
+    if (base != NULL)
+        host->Release(base, CG_SCRATCH_ARENA_SIZE, CG_SCRATCH_ARENA_ALIGNMENT, CG_ALLOCATION_TYPE_INTERNAL, host->UserData);
+    InterlockedExchange(&arena->OwnerThread, 0);
 }
 
 /// @summary Locate one substring within another, ignoring case.
@@ -432,7 +543,9 @@ cgClFreeString
     int         type
 )
 {
-    cgFreeHostMemory(&ctx->HostAllocator, str, _msize(str), 0, type);
+    // the buffer may come from a scratch arena, so _msize cannot be used.
+    // the string was sized by the OpenCL query to include the terminator.
+    if (str != NULL) cgFreeHostMemory(&ctx->HostAllocator, str, strlen(str) + 1, 0, type);
 }
 
 /// @summary Determine whether an OpenCL platform or device extension is supported.
@@ -647,945 +760,2820 @@ cgClDeviceCapsQuery
     }
 }
 
-/// @summary Frees all resources and releases all references held by a device object.
-/// @param ctx The CGFX context that owns the device object.
-/// @param device The device object to delete.
-internal_function void
-cgDeleteDevice
+/// @summary Retrieve the current value of the high-resolution timer.
+/// @return The current timer value, in ticks.
+internal_function inline int64_t
+cgTimestamp
 (
-    CG_CONTEXT     *ctx,
-    CG_DEVICE      *device
+    void
 )
 {
-    if (device->DisplayRC != NULL)
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart;
+}
+
+/// @summary Calculate the number of nanoseconds elapsed since a timestamp was taken.
+/// @param start The value returned by cgTimestamp at the start of the measured interval.
+/// @return The elapsed time, in nanoseconds.
+internal_function uint64_t
+cgElapsedNanos
+(
+    int64_t start
+)
+{
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter  (&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (uint64_t(counter.QuadPart - start) * 1000000000ULL) / uint64_t(frequency.QuadPart);
+}
+
+/// @summary Compute the on-disk cache key for a compute program built for a single device. The key covers everything 
+/// that can change the generated code: source, build options, the device and platform names, the driver version and the 
+/// device capabilities.
+/// @param device The device the program is built for.
+/// @param code The kernel code description. The code must be supplied as source.
+/// @param options The NULL-terminated build options passed to clBuildProgram, or NULL.
+/// @return The 64-bit cache key.
+internal_function uint64_t
+cgClKernelCacheKey
+(
+    CG_DEVICE              *device, 
+    cg_kernel_code_t const *code, 
+    char const             *options
+)
+{
+    CL_DEVICE_CAPS const &caps = device->Capabilities;
+    uint64_t              hash = CG_FNV1A_64_SEED;
+    hash = cgHashData  (hash, code->Code, code->CodeSize);
+    hash = cgHashString(hash, options);
+    hash = cgHashString(hash, device->Name);
+    hash = cgHashString(hash, device->Platform);
+    hash = cgHashString(hash, device->Version);
+    hash = cgHashString(hash, device->Driver);
+    hash = cgHashString(hash, device->Extensions);
+    // CL_DEVICE_CAPS contains padding and a pointer, so hash it member-wise.
+#define HASH_CAP(field) \
+    hash = cgHashData  (hash, &caps.field, sizeof(caps.field))
+    HASH_CAP(LittleEndian);
+    HASH_CAP(AddressBits);
+    HASH_CAP(MinTypeAlign);
+    HASH_CAP(MaxWorkGroupSize);
+    HASH_CAP(MaxParamSize);
+    HASH_CAP(MaxConstantArgs);
+    HASH_CAP(LocalMemoryType);
+    HASH_CAP(LocalMemorySize);
+    HASH_CAP(ComputeUnits);
+    HASH_CAP(VecWidthChar);
+    HASH_CAP(VecWidthShort);
+    HASH_CAP(VecWidthInt);
+    HASH_CAP(VecWidthLong);
+    HASH_CAP(VecWidthSingle);
+    HASH_CAP(VecWidthDouble);
+    HASH_CAP(FPSingleConfig);
+    HASH_CAP(FPDoubleConfig);
+    HASH_CAP(SupportImage);
+    HASH_CAP(MaxWorkItemDimension);
+#undef  HASH_CAP
+    hash = cgHashData  (hash, caps.MaxWorkItemSizes, caps.MaxWorkItemDimension * sizeof(size_t));
+    return hash;
+}
+
+/// @summary Build the path of a file in the on-disk kernel cache.
+/// @param ctx The CGFX context that owns the kernel cache.
+/// @param key The cache key of the file.
+/// @param ext The file extension, not including the period.
+/// @param path The buffer to receive the NULL-terminated path.
+/// @param max_chars The maximum number of characters that can be written to @a path, including the terminator.
+/// @return true if the cache is enabled and the path fits in the buffer.
+internal_function bool
+cgKernelCachePath
+(
+    CG_CONTEXT *ctx, 
+    uint64_t    key, 
+    char const *ext, 
+    char       *path, 
+    size_t      max_chars
+)
+{
+    if (ctx->KernelCache.Directory == NULL)
+        return false;
+    return _snprintf_s(path, max_chars, _TRUNCATE, "%s\\%016I64x.%s", ctx->KernelCache.Directory, key, ext) > 0;
+}
+
+/// @summary Load a file from the on-disk kernel cache. The file header must match the key and the current format version.
+/// @param ctx The CGFX context that owns the kernel cache.
+/// @param key The cache key of the file to load.
+/// @param ext The file extension, not including the period.
+/// @param data_size On return, set to the number of bytes of data loaded, or zero.
+/// @return The file data, allocated with CG_ALLOCATION_TYPE_TEMP, or NULL if the entry does not exist or is invalid.
+internal_function void*
+cgKernelCacheRead
+(
+    CG_CONTEXT *ctx, 
+    uint64_t    key, 
+    char const *ext, 
+    size_t     &data_size
+)
+{
+    CG_KERNEL_CACHE_HEADER header;
+    char                   path[MAX_PATH];
+    HANDLE                 fd    = INVALID_HANDLE_VALUE;
+    void                  *data  = NULL;
+    DWORD                  nread = 0;
+
+    data_size = 0;
+    if (!cgKernelCachePath(ctx, key, ext, path, MAX_PATH))
+        return NULL;
+    if ((fd = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL)) == INVALID_HANDLE_VALUE)
+        return NULL;
+    if (!ReadFile(fd, &header, sizeof(header), &nread, NULL) || nread != sizeof(header))
+        goto cleanup;
+    if (header.Magic != CG_KERNEL_CACHE_MAGIC || header.Version != CG_KERNEL_CACHE_VERSION || header.Key != key)
+        goto cleanup;
+    if (header.DataSize == 0 || header.DataSize > MAXDWORD)
+        goto cleanup;
+    if ((data = cgAllocateHostMemory(&ctx->HostAllocator, size_t(header.DataSize), 0, CG_ALLOCATION_TYPE_TEMP)) == NULL)
+        goto cleanup;
+    if (!ReadFile(fd, data, DWORD(header.DataSize), &nread, NULL) || nread != DWORD(header.DataSize))
+    {   // the file is truncated; treat it as a miss.
+        cgFreeHostMemory(&ctx->HostAllocator, data, size_t(header.DataSize), 0, CG_ALLOCATION_TYPE_TEMP);
+        data = NULL;
+        goto cleanup;
+    }
+    data_size = size_t(header.DataSize);
+
+cleanup:
+    CloseHandle(fd);
+    return data;
+}
+
+/// @summary Write a file to the on-disk kernel cache. The data is written to a temporary file which is then renamed into 
+/// place, so readers in other processes never observe a partially-written entry.
+/// @param ctx The CGFX context that owns the kernel cache.
+/// @param key The cache key of the file to write.
+/// @param ext The file extension, not including the period.
+/// @param data The data to write.
+/// @param data_size The number of bytes of data to write.
+/// @return true if the cache entry was written.
+internal_function bool
+cgKernelCacheWrite
+(
+    CG_CONTEXT *ctx, 
+    uint64_t    key, 
+    char const *ext, 
+    void const *data, 
+    size_t      data_size
+)
+{
+    CG_KERNEL_CACHE_HEADER header;
+    char                   path[MAX_PATH];
+    char                   temp[MAX_PATH];
+    HANDLE                 fd     = INVALID_HANDLE_VALUE;
+    DWORD                  nwrite = 0;
+    bool                   wrote  = false;
+
+    if (data_size == 0 || data_size > MAXDWORD)
+        return false;
+    if (!cgKernelCachePath(ctx, key, ext, path, MAX_PATH))
+        return false;
+    if (_snprintf_s(temp, MAX_PATH, _TRUNCATE, "%s.%lu.%lu.tmp", path, GetCurrentProcessId(), GetCurrentThreadId()) < 0)
+        return false;
+    if ((fd = CreateFileA(temp, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY, NULL)) == INVALID_HANDLE_VALUE)
+        return false;
+
+    header.Magic    = CG_KERNEL_CACHE_MAGIC;
+    header.Version  = CG_KERNEL_CACHE_VERSION;
+    header.Key      = key;
+    header.DataSize = data_size;
+    wrote = WriteFile(fd, &header, sizeof(header), &nwrite, NULL) && nwrite == sizeof(header) && 
+            WriteFile(fd, data, DWORD(data_size) , &nwrite, NULL) && nwrite == DWORD(data_size);
+    CloseHandle(fd);
+
+    if (wrote && MoveFileExA(temp, path, MOVEFILE_REPLACE_EXISTING))
+        return true;
+    DeleteFileA(temp);
+    return false;
+}
+
+/// @summary Create and build an OpenCL program object from device binaries for every device in an execution group.
+/// @param group The execution group for which the program is being created.
+/// @param binaries An array of group->DeviceCount pointers to the binary for each device, in the order of group->DeviceIds.
+/// @param sizes An array of group->DeviceCount values specifying the size of each binary, in bytes.
+/// @param options The NULL-terminated build options passed to clBuildProgram, or NULL.
+/// @param result On return, set to CG_SUCCESS or the reason for the failure.
+/// @return The OpenCL program object, or NULL.
+internal_function cl_program
+cgClCreateProgramWithBinaries
+(
+    CG_EXEC_GROUP        *group, 
+    unsigned char const **binaries, 
+    size_t               *sizes, 
+    char const           *options, 
+    int                  &result
+)
+{
+    cl_int     clres = CL_SUCCESS;
+    cl_program p     = clCreateProgramWithBinary(group->ComputeContext, cl_uint(group->DeviceCount), group->DeviceIds, sizes, binaries, NULL, &clres);
+    if (p == NULL)
     {
-        wglDeleteContext(device->DisplayRC);
+        switch (clres)
+        {
+        case CL_INVALID_CONTEXT   : result = CG_BAD_CLCONTEXT; break;
+        case CL_INVALID_VALUE     : result = CG_INVALID_VALUE; break;
+        case CL_INVALID_DEVICE    : result = CG_BAD_CLCONTEXT; break;
+        case CL_INVALID_BINARY    : result = CG_INVALID_VALUE; break;
+        case CL_OUT_OF_RESOURCES  : result = CG_OUT_OF_MEMORY; break;
+        case CL_OUT_OF_HOST_MEMORY: result = CG_OUT_OF_MEMORY; break;
+        default                   : result = CG_ERROR;         break;
+        }
+        return NULL;
     }
-    cgClDeviceCapsFree(ctx, &device->Capabilities);
-    cgClFreeString(ctx, device->Extensions, CG_ALLOCATION_TYPE_INTERNAL);
-    cgClFreeString(ctx, device->Driver    , CG_ALLOCATION_TYPE_INTERNAL);
-    cgClFreeString(ctx, device->Version   , CG_ALLOCATION_TYPE_INTERNAL);
-    cgClFreeString(ctx, device->Platform  , CG_ALLOCATION_TYPE_INTERNAL);
-    cgClFreeString(ctx, device->Name      , CG_ALLOCATION_TYPE_INTERNAL);
-    if (device->DeviceId != NULL)
+    // programs created from binaries must still be built, but no compilation is performed.
+    if ((clres = clBuildProgram(p, cl_uint(group->DeviceCount), group->DeviceIds, options, NULL, NULL)) != CL_SUCCESS)
     {
-        clReleaseDevice(device->DeviceId);
+        switch (clres)
+        {
+        case CL_INVALID_PROGRAM       : result = CG_BAD_CLCONTEXT; break;
+        case CL_INVALID_VALUE         : result = CG_INVALID_VALUE; break;
+        case CL_INVALID_DEVICE        : result = CG_BAD_CLCONTEXT; break;
+        case CL_INVALID_BINARY        : result = CG_INVALID_VALUE; break;
+        case CL_INVALID_BUILD_OPTIONS : result = CG_INVALID_VALUE; break;
+        case CL_INVALID_OPERATION     : result = CG_INVALID_STATE; break;
+        case CL_BUILD_PROGRAM_FAILURE : result = CG_COMPILE_FAILED;break;
+        case CL_OUT_OF_HOST_MEMORY    : result = CG_OUT_OF_MEMORY; break;
+        default                       : result = CG_ERROR;         break;
+        }
+        clReleaseProgram(p);
+        return NULL;
     }
-    memset(device, 0, sizeof(CG_DEVICE));
+    result = CG_SUCCESS;
+    return p;
 }
 
-/// @summary Frees all resources and releases all references held by a display object.
-/// @param ctx The CGFX context that owns the display object.
-/// @param display The display object to delete.
-internal_function void
-cgDeleteDisplay
+/// @summary Compute the kernel cache key of a compute program for each device in an execution group.
+/// @param ctx The CGFX context that owns the kernel cache.
+/// @param group The execution group for which the program is being created.
+/// @param code The kernel code description. The code must be supplied as source.
+/// @param options The NULL-terminated build options passed to clBuildProgram, or NULL.
+/// @return An array of group->DeviceCount keys allocated with CG_ALLOCATION_TYPE_TEMP, or NULL if the cache is disabled.
+internal_function uint64_t*
+cgClKernelCacheKeys
 (
-    CG_CONTEXT    *ctx,
-    CG_DISPLAY    *display
+    CG_CONTEXT             *ctx, 
+    CG_EXEC_GROUP          *group, 
+    cg_kernel_code_t const *code, 
+    char const             *options
 )
-{   UNREFERENCED_PARAMETER(ctx);
-    if (display->DisplayDC != NULL)
-    {
-        ReleaseDC(display->DisplayHWND, display->DisplayDC);
-    }
-    if (display->DisplayHWND != NULL)
+{
+    uint64_t *keys = NULL;
+    if (ctx->KernelCache.Directory == NULL)
+        return NULL;
+    if ((keys = (uint64_t*) cgAllocateHostMemory(&ctx->HostAllocator, group->DeviceCount * sizeof(uint64_t), 0, CG_ALLOCATION_TYPE_TEMP)) == NULL)
+        return NULL;
+    for (size_t i = 0, n = group->DeviceCount; i < n; ++i)
     {
-        DestroyWindow(display->DisplayHWND);
+        keys[i] = cgClKernelCacheKey(group->DeviceList[i], code, options);
     }
-    memset(display, 0, sizeof(CG_DISPLAY));
+    return keys;
 }
 
-/// @summary Frees all resources and releases all references held by a queue object.
-/// @param ctx The CGFX context that owns the queue object.
-/// @param queue The queue object to delete.
+/// @summary Free the key list returned by cgClKernelCacheKeys.
+/// @param ctx The CGFX context that owns the kernel cache.
+/// @param group The execution group passed to cgClKernelCacheKeys.
+/// @param keys The key list to free. May be NULL.
 internal_function void
-cgDeleteQueue
+cgClFreeKernelCacheKeys
 (
-    CG_CONTEXT *ctx,
-    CG_QUEUE   *queue
+    CG_CONTEXT    *ctx, 
+    CG_EXEC_GROUP *group, 
+    uint64_t      *keys
 )
-{   UNREFERENCED_PARAMETER(ctx);
-    if (queue->CommandQueue != NULL)
-        clReleaseCommandQueue(queue->CommandQueue);
-    memset(queue, 0, sizeof(CG_QUEUE));
+{
+    if (keys != NULL)
+    {
+        cgFreeHostMemory(&ctx->HostAllocator, keys, group->DeviceCount * sizeof(uint64_t), 0, CG_ALLOCATION_TYPE_TEMP);
+    }
 }
 
-/// @summary Frees all resources associated with a command buffer object.
-/// @param ctx The CGFX context that owns the command buffer object.
-/// @param cmdbuf The command buffer object to delete.
-internal_function void
-cgDeleteCmdBuffer
+/// @summary Attempt to create a compute program from binaries stored in the on-disk kernel cache. Every device in the 
+/// execution group must have a cached binary; a stale or corrupt entry is treated as a miss.
+/// @param ctx The CGFX context that owns the kernel cache.
+/// @param group The execution group for which the program is being created.
+/// @param keys The cache key for each device in the group, returned by cgClKernelCacheKeys.
+/// @param options The NULL-terminated build options passed to clBuildProgram, or NULL.
+/// @return The built OpenCL program object, or NULL if the program must be built from source.
+internal_function cl_program
+cgClLoadCachedProgram
 (
-    CG_CONTEXT    *ctx,
-    CG_CMD_BUFFER *cmdbuf
+    CG_CONTEXT    *ctx, 
+    CG_EXEC_GROUP *group, 
+    uint64_t      *keys, 
+    char const    *options
 )
-{   UNREFERENCED_PARAMETER(ctx);
-    if (cmdbuf->CommandData != NULL)
-        VirtualFree(cmdbuf->CommandData, 0, MEM_RELEASE);
-    cmdbuf->BytesTotal   = 0;
-    cmdbuf->BytesUsed    = 0;
-    cmdbuf->CommandCount = 0;
-    cmdbuf->CommandData  = NULL;
+{
+    size_t          count    = group->DeviceCount;
+    size_t          found    = 0;
+    size_t         *sizes    = NULL;
+    unsigned char **binaries = NULL;
+    cl_program      program  = NULL;
+    int             result   = CG_SUCCESS;
+
+    if ((sizes = (size_t*) cgAllocateHostMemory(&ctx->HostAllocator, count * sizeof(size_t), 0, CG_ALLOCATION_TYPE_TEMP)) == NULL)
+        return NULL;
+    if ((binaries = (unsigned char**) cgAllocateHostMemory(&ctx->HostAllocator, count * sizeof(unsigned char*), 0, CG_ALLOCATION_TYPE_TEMP)) == NULL)
+    {
+        cgFreeHostMemory(&ctx->HostAllocator, sizes, count * sizeof(size_t), 0, CG_ALLOCATION_TYPE_TEMP);
+        return NULL;
+    }
+    for (found = 0; found < count; ++found)
+    {
+        if ((binaries[found] = (unsigned char*) cgKernelCacheRead(ctx, keys[found], "clbin", sizes[found])) == NULL)
+            break;
+    }
+    if (found == count)
+    {   // every device has a cached binary.
+        program = cgClCreateProgramWithBinaries(group, (unsigned char const**) binaries, sizes, options, result);
+    }
+    // free in reverse order of allocation so scratch memory is released.
+    for (size_t i = found; i > 0; --i)
+    {
+        cgFreeHostMemory(&ctx->HostAllocator, binaries[i-1], sizes[i-1], 0, CG_ALLOCATION_TYPE_TEMP);
+    }
+    cgFreeHostMemory(&ctx->HostAllocator, binaries, count * sizeof(unsigned char*), 0, CG_ALLOCATION_TYPE_TEMP);
+    cgFreeHostMemory(&ctx->HostAllocator, sizes   , count * sizeof(size_t)        , 0, CG_ALLOCATION_TYPE_TEMP);
+    return program;
 }
 
-/// @summary Frees all resources and releases all references associated with a kernel object.
-/// @param ctx The CGFX context that owns the kernel object.
-/// @param kernel The kernel object to delete.
+/// @summary Retrieve the device binaries for a program built from source and write them to the on-disk kernel cache.
+/// Failure to write the cache is not an error; the program is simply rebuilt from source next time.
+/// @param ctx The CGFX context that owns the kernel cache.
+/// @param device_count The number of devices the program was built for.
+/// @param device_ids The devices the program was built for, typically the DeviceIds of an execution group.
+/// @param program The OpenCL program object, built for every device in @a device_ids.
+/// @param keys The cache key for each device in @a device_ids, returned by cgClKernelCacheKeys.
 internal_function void
-cgDeleteKernel
+cgClStoreProgramBinaries
 (
-    CG_CONTEXT *ctx,
-    CG_KERNEL  *kernel
+    CG_CONTEXT         *ctx, 
+    size_t              device_count, 
+    cl_device_id const *device_ids, 
+    cl_program          program, 
+    uint64_t const     *keys
 )
-{   UNREFERENCED_PARAMETER(ctx);
-    switch (kernel->KernelType)
+{
+    cl_uint         count    = 0;
+    size_t          nalloc   = 0;
+    cl_device_id   *devices  = NULL;
+    size_t         *sizes    = NULL;
+    unsigned char **binaries = NULL;
+
+    if (clGetProgramInfo(program, CL_PROGRAM_NUM_DEVICES, sizeof(cl_uint), &count, NULL) != CL_SUCCESS || count == 0)
+        return;
+    if ((devices = (cl_device_id*) cgAllocateHostMemory(&ctx->HostAllocator, count * sizeof(cl_device_id), 0, CG_ALLOCATION_TYPE_TEMP)) == NULL)
+        return;
+    if ((sizes = (size_t*) cgAllocateHostMemory(&ctx->HostAllocator, count * sizeof(size_t), 0, CG_ALLOCATION_TYPE_TEMP)) == NULL)
+        goto cleanup;
+    if ((binaries = (unsigned char**) cgAllocateHostMemory(&ctx->HostAllocator, count * sizeof(unsigned char*), 0, CG_ALLOCATION_TYPE_TEMP)) == NULL)
+        goto cleanup;
+    memset(binaries, 0, count * sizeof(unsigned char*));
+
+    // binaries are returned in the order of CL_PROGRAM_DEVICES, which may differ from device_ids.
+    if (clGetProgramInfo(program, CL_PROGRAM_DEVICES     , count * sizeof(cl_device_id), devices, NULL) != CL_SUCCESS)
+        goto cleanup;
+    if (clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, count * sizeof(size_t)      , sizes  , NULL) != CL_SUCCESS)
+        goto cleanup;
+    for (nalloc = 0; nalloc < count; ++nalloc)
     {
-    case CG_KERNEL_TYPE_GRAPHICS_VERTEX:
-    case CG_KERNEL_TYPE_GRAPHICS_FRAGMENT:
-    case CG_KERNEL_TYPE_GRAPHICS_PRIMITIVE:
+        if (sizes[nalloc] == 0)
+            continue;
+        if ((binaries[nalloc] = (unsigned char*) cgAllocateHostMemory(&ctx->HostAllocator, sizes[nalloc], 0, CG_ALLOCATION_TYPE_TEMP)) == NULL)
+            goto cleanup;
+    }
+    if (clGetProgramInfo(program, CL_PROGRAM_BINARIES, count * sizeof(unsigned char*), binaries, NULL) != CL_SUCCESS)
+        goto cleanup;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (binaries[i] == NULL)
+            continue;
+        for (size_t j = 0; j < device_count; ++j)
         {
-            CG_DISPLAY *display = kernel->AttachedDisplay;
-            if (kernel->GraphicsShader != 0)
+            if (device_ids[j] == devices[i])
             {
-                glDeleteShader(kernel->GraphicsShader);
+                if (cgKernelCacheWrite(ctx, keys[j], "clbin", binaries[i], sizes[i]))
+                    InterlockedIncrement64(&ctx->KernelCache.Stats.StoreCount);
+                break;
             }
         }
-        break;
-    case CG_KERNEL_TYPE_COMPUTE:
-        {
-            if (kernel->ComputeProgram != NULL)
-            {
-                clReleaseProgram(kernel->ComputeProgram);
-            }
+    }
+
+cleanup:
+    for (size_t i = nalloc; i > 0; --i)
+    {
+        if (binaries[i-1] != NULL)
+            cgFreeHostMemory(&ctx->HostAllocator, binaries[i-1], sizes[i-1], 0, CG_ALLOCATION_TYPE_TEMP);
+    }
+    if (binaries != NULL) cgFreeHostMemory(&ctx->HostAllocator, binaries, count * sizeof(unsigned char*), 0, CG_ALLOCATION_TYPE_TEMP);
+    if (sizes    != NULL) cgFreeHostMemory(&ctx->HostAllocator, sizes   , count * sizeof(size_t)        , 0, CG_ALLOCATION_TYPE_TEMP);
+    cgFreeHostMemory(&ctx->HostAllocator, devices, count * sizeof(cl_device_id), 0, CG_ALLOCATION_TYPE_TEMP);
+}
+
+/// @summary Publish the result of an asynchronous compute program build. This may be called from the thread pool worker 
+/// and from the OpenCL build notification callback; only the first caller has any effect. The record must not be accessed 
+/// after BuildStatus is published, as the owning thread may free it.
+/// @param build The build state shared with the owning thread.
+internal_function void
+cgClFinishKernelBuild
+(
+    CG_KERNEL_BUILD *build
+)
+{
+    cl_event ready  = build->ReadyEvent;
+    LONG     status = CG_SUCCESS;
+    if (InterlockedCompareExchange(&build->Finishing, 1, 0) != 0)
+    {   // another thread has already observed completion.
+        return;
+    }
+    for (cl_uint i = 0; i < build->DeviceCount; ++i)
+    {
+        cl_build_status device_status = CL_BUILD_ERROR;
+        clGetProgramBuildInfo(build->ComputeProgram, build->DeviceIds[i], CL_PROGRAM_BUILD_STATUS, sizeof(cl_build_status), &device_status, NULL);
+        if (device_status != CL_BUILD_SUCCESS)
+        {   // the program is unusable if it failed to build for any device.
+            status = CG_COMPILE_FAILED;
+            break;
         }
-        break;
-    default:
-        break;
     }
-    memset(kernel, 0, sizeof(CG_KERNEL));
+    // signal the event first, then publish the status; the owning thread polls the status.
+    clSetUserEventStatus(ready, status == CG_SUCCESS ? CL_COMPLETE : CL_BUILD_PROGRAM_FAILURE);
+    InterlockedExchange(&build->BuildStatus, status);
 }
 
-/// @summary Allocate memory for an execution group and initialize the device and display lists.
-/// @param ctx The CGFX context that owns the execution group.
-/// @param group The execution group to initialize.
-/// @param root_device The handle of the device that defines the share group.
-/// @param device_list The list of handles of the devices in the execution group.
-/// @param device_count The number of devices in the execution group.
-/// @return CG_SUCCESS or CG_OUT_OF_MEMORY.
-internal_function int
-cgAllocExecutionGroup
+/// @summary Receives notification from the OpenCL runtime that a program build has completed.
+/// @param program The OpenCL program object that finished building.
+/// @param user_data The CG_KERNEL_BUILD record passed to clBuildProgram.
+internal_function void CL_CALLBACK
+cgClKernelBuildNotify
 (
-    CG_CONTEXT    *ctx,
-    CG_EXEC_GROUP *group,
-    cg_handle_t    root_device,
-    cg_handle_t   *device_list,
-    size_t         device_count
+    cl_program program, 
+    void      *user_data
 )
 {
-    CG_DEVICE        *root             = cgObjectTableGet(&ctx->DeviceTable, root_device);
-    CG_DEVICE       **device_refs      = NULL;
-    cl_device_id     *device_ids       = NULL;
-    CG_QUEUE        **compute_queues   = NULL;
-    CG_QUEUE        **transfer_queues  = NULL;
-    CG_DISPLAY      **display_refs     = NULL;
-    CG_QUEUE        **graphics_queues  = NULL;
-    CG_QUEUE        **queue_refs       = NULL;
-    size_t            display_count    = 0;
-    size_t            queue_count      = 0;
+    cgClFinishKernelBuild((CG_KERNEL_BUILD*) user_data);
+    UNREFERENCED_PARAMETER(program);
+}
 
-    // zero out the execution groupn definition.
-    memset(group, 0, sizeof(CG_EXEC_GROUP));
+/// @summary Implements the thread pool work item that builds a compute program. Drivers that build asynchronously return 
+/// immediately and invoke cgClKernelBuildNotify later; others build on this thread and invoke it before returning.
+/// @param instance The thread pool callback instance. Unused.
+/// @param context The CG_KERNEL_BUILD record describing the build.
+internal_function void CALLBACK
+cgClKernelBuildWorker
+(
+    PTP_CALLBACK_INSTANCE instance, 
+    void                 *context
+)
+{
+    CG_KERNEL_BUILD *build = (CG_KERNEL_BUILD*) context;
+    if (clBuildProgram(build->ComputeProgram, build->DeviceCount, build->DeviceIds, build->Options, cgClKernelBuildNotify, build) != CL_SUCCESS)
+    {   // the build failed to start or failed synchronously; the notification may never arrive.
+        cgClFinishKernelBuild(build);
+    }
+    InterlockedExchange(&build->WorkerActive, 0);
+    UNREFERENCED_PARAMETER(instance);
+}
 
-    // determine the number of attached displays and queues.
-    for (size_t i = 0; i < device_count; ++i)
+/// @summary Free the state associated with an asynchronous compute program build. The build must have completed.
+/// @param ctx The CGFX context that allocated the build record.
+/// @param build The build record to free.
+internal_function void
+cgFreeKernelBuild
+(
+    CG_CONTEXT      *ctx, 
+    CG_KERNEL_BUILD *build
+)
+{
+    if (build->ReadyEvent != NULL)
     {
-        CG_DEVICE *device = cgObjectTableGet(&ctx->DeviceTable, device_list[i]);
-        display_count    += device->DisplayCount;
+        clReleaseEvent(build->ReadyEvent);
     }
-    queue_count += device_count;  // account for compute queues
-    queue_count += device_count;  // account for transfer queues
-    queue_count += display_count; // account for graphics queues
+    cgFreeHostMemory(&ctx->HostAllocator, build->CacheKeys, build->DeviceCount * sizeof(uint64_t), 0, CG_ALLOCATION_TYPE_INTERNAL);
+    cgFreeHostMemory(&ctx->HostAllocator, build->Options  , build->OptionsSize, 0, CG_ALLOCATION_TYPE_INTERNAL);
+    cgFreeHostMemory(&ctx->HostAllocator, build, sizeof(CG_KERNEL_BUILD), 0, CG_ALLOCATION_TYPE_INTERNAL);
+}
 
-    // allocate storage. there's always at least one device, but possibly no attached displays.
-    if (device_count > 0)
-    {   // allocate all of the device list storage.
-        device_refs      = (CG_DEVICE   **) cgAllocateHostMemory(&ctx->HostAllocator, device_count  * sizeof(CG_DEVICE*)  , 0, CG_ALLOCATION_TYPE_OBJECT);
-        device_ids       = (cl_device_id *) cgAllocateHostMemory(&ctx->HostAllocator, device_count  * sizeof(cl_device_id), 0, CG_ALLOCATION_TYPE_OBJECT);
-        compute_queues   = (CG_QUEUE    **) cgAllocateHostMemory(&ctx->HostAllocator, device_count  * sizeof(CG_QUEUE*)   , 0, CG_ALLOCATION_TYPE_OBJECT);
-        transfer_queues  = (CG_QUEUE    **) cgAllocateHostMemory(&ctx->HostAllocator, device_count  * sizeof(CG_QUEUE*)   , 0, CG_ALLOCATION_TYPE_OBJECT);
-        if (device_refs == NULL || device_ids == NULL || transfer_queues == NULL)
-            goto error_cleanup;
-        // populate the device reference list and initialize everything else to NULL.
-        for (size_t device_index = 0; device_index < device_count; ++device_index)
+/// @summary Start building a compute program on the system thread pool.
+/// @param ctx The CGFX context that owns the kernel object.
+/// @param group The execution group the program is being built for.
+/// @param program The OpenCL program object, created from source.
+/// @param keys The kernel cache key for each device in the group, or NULL. The keys are copied.
+/// @param options The NULL-terminated build options passed to clBuildProgram, or NULL. The string is copied.
+/// @param out_build On return, set to the build record to store on the kernel object, or NULL.
+/// @return CG_SUCCESS, CG_OUT_OF_MEMORY, CG_BAD_CLCONTEXT or CG_ERROR.
+internal_function int
+cgClBeginKernelBuild
+(
+    CG_CONTEXT       *ctx, 
+    CG_EXEC_GROUP    *group, 
+    cl_program        program, 
+    uint64_t const   *keys, 
+    char const       *options, 
+    CG_KERNEL_BUILD **out_build
+)
+{
+    CG_KERNEL_BUILD *build = NULL;
+    cl_int           clres = CL_SUCCESS;
+
+    *out_build = NULL;
+    if ((build = (CG_KERNEL_BUILD*) cgAllocateHostMemory(&ctx->HostAllocator, sizeof(CG_KERNEL_BUILD), 0, CG_ALLOCATION_TYPE_INTERNAL)) == NULL)
+        return CG_OUT_OF_MEMORY;
+    memset(build, 0, sizeof(CG_KERNEL_BUILD));
+    build->ComputeProgram = program;
+    build->DeviceCount    = cl_uint(group->DeviceCount);
+    build->DeviceIds      = group->DeviceIds;
+    build->BuildStatus    = CG_NOT_READY;
+    build->WorkerActive   = 1;
+    if (keys != NULL)
+    {   // the caller's key list is scratch memory; keep a copy until the binaries are stored.
+        if ((build->CacheKeys = (uint64_t*) cgAllocateHostMemory(&ctx->HostAllocator, group->DeviceCount * sizeof(uint64_t), 0, CG_ALLOCATION_TYPE_INTERNAL)) == NULL)
         {
-            device_refs[device_index] = cgObjectTableGet(&ctx->DeviceTable, device_list[device_index]);
-            device_ids [device_index] = device_refs[device_index]->DeviceId;
+            cgFreeKernelBuild(ctx, build);
+            return CG_OUT_OF_MEMORY;
         }
-        memset(compute_queues  , 0, device_count * sizeof(CG_QUEUE*));
-        memset(transfer_queues , 0, device_count * sizeof(CG_QUEUE*));
+        memcpy(build->CacheKeys, keys, group->DeviceCount * sizeof(uint64_t));
     }
-    if (display_count > 0)
-    {   // allocate all of the display list storage.
-        display_refs     = (CG_DISPLAY**) cgAllocateHostMemory(&ctx->HostAllocator, display_count * sizeof(CG_DISPLAY*), 0, CG_ALLOCATION_TYPE_OBJECT);
-        graphics_queues  = (CG_QUEUE  **) cgAllocateHostMemory(&ctx->HostAllocator, display_count * sizeof(CG_QUEUE*)  , 0, CG_ALLOCATION_TYPE_OBJECT);
-        if (display_refs == NULL || graphics_queues == NULL)
-            goto error_cleanup;
-        // populate the display list with data.
-        for (size_t device_index = 0; device_index < device_count; ++device_index)
+    if (options != NULL)
+    {   // the caller's options string may not outlive this call.
+        size_t size = strlen(options) + 1;
+        if ((build->Options = (char*) cgAllocateHostMemory(&ctx->HostAllocator, size, 0, CG_ALLOCATION_TYPE_INTERNAL)) == NULL)
         {
-            CG_DEVICE  *device = cgObjectTableGet(&ctx->DeviceTable, device_list[device_index]);
-            for (size_t display_index = 0, num_displays = device->DisplayCount; display_index < num_displays; ++display_index)
-            {
-                display_refs[group->DisplayCount] = device->AttachedDisplays[display_index];
-                group->DisplayCount++;
-            }
+            cgFreeKernelBuild(ctx, build);
+            return CG_OUT_OF_MEMORY;
         }
-        memset(graphics_queues, 0, display_count * sizeof(CG_QUEUE*));
+        memcpy(build->Options, options, size);
+        build->OptionsSize = size;
     }
-    if (queue_count > 0)
-    {   // allocate all of the queue list storage.
-        queue_refs  = (CG_QUEUE**) cgAllocateHostMemory(&ctx->HostAllocator, queue_count * sizeof(CG_QUEUE*), 0, CG_ALLOCATION_TYPE_OBJECT);
-        if (queue_refs == NULL)
-            goto error_cleanup;
-        // NULL out all of the queue references.
-        memset(queue_refs, 0, queue_count * sizeof(CG_QUEUE*));
+    if ((build->ReadyEvent = clCreateUserEvent(group->ComputeContext, &clres)) == NULL)
+    {
+        cgFreeKernelBuild(ctx, build);
+        switch (clres)
+        {
+        case CL_INVALID_CONTEXT   : return CG_BAD_CLCONTEXT;
+        case CL_OUT_OF_RESOURCES  : return CG_OUT_OF_MEMORY;
+        case CL_OUT_OF_HOST_MEMORY: return CG_OUT_OF_MEMORY;
+        default                   : return CG_ERROR;
+        }
     }
-
-    // initialization was successful, save all of the references.
-    group->PlatformId       = root->PlatformId;
-    group->ComputeContext   = NULL;
-    group->RenderingContext = NULL;
-    group->AttachedDisplay  = NULL;
-    group->DeviceCount      = device_count;
-    group->DeviceList       = device_refs;
-    group->DeviceIds        = device_ids;
-    group->ComputeQueues    = compute_queues;
-    group->TransferQueues   = transfer_queues;
-    group->DisplayCount     = display_count;
-    group->AttachedDisplays = display_refs;
-    group->GraphicsQueues   = graphics_queues;
-    group->QueueCount       = queue_count;
-    group->QueueList        = queue_refs;
+    if (!TrySubmitThreadpoolCallback(cgClKernelBuildWorker, build, NULL))
+    {   // the thread pool could not accept the work item.
+        cgFreeKernelBuild(ctx, build);
+        return CG_ERROR;
+    }
+    *out_build = build;
     return CG_SUCCESS;
+}
 
-error_cleanup:
-    cgFreeHostMemory(&ctx->HostAllocator, queue_refs      , queue_count   * sizeof(CG_QUEUE*)   , 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(&ctx->HostAllocator, graphics_queues , display_count * sizeof(CG_QUEUE*)   , 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(&ctx->HostAllocator, display_refs    , display_count * sizeof(CG_DISPLAY*) , 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(&ctx->HostAllocator, transfer_queues , device_count  * sizeof(CG_QUEUE*)   , 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(&ctx->HostAllocator, compute_queues  , device_count  * sizeof(CG_QUEUE*)   , 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(&ctx->HostAllocator, device_ids      , device_count  * sizeof(cl_device_id), 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(&ctx->HostAllocator, device_refs     , device_count  * sizeof(CG_DEVICE*)  , 0, CG_ALLOCATION_TYPE_OBJECT);
-    return CG_OUT_OF_MEMORY;
+/// @summary Check whether an asynchronous compute program build has completed, without blocking.
+/// @param build The build record to check.
+/// @return CG_NOT_READY, CG_SUCCESS or CG_COMPILE_FAILED.
+internal_function int
+cgPollKernelBuild
+(
+    CG_KERNEL_BUILD *build
+)
+{
+    LONG status = build->BuildStatus;
+    if (status == CG_NOT_READY || build->WorkerActive != 0)
+        return CG_NOT_READY;
+    return int(status);
 }
 
-/// @summary Frees all resources and releases all references held by an execution group object.
-/// @param ctx The CGFX context that owns the execution group object.
-/// @param group The execution group object to delete.
+/// @summary Block the calling thread until an asynchronous compute program build has completed.
+/// @param build The build record to wait on.
 internal_function void
-cgDeleteExecutionGroup
+cgWaitKernelBuild
 (
-    CG_CONTEXT    *ctx,
-    CG_EXEC_GROUP *group
+    CG_KERNEL_BUILD *build
 )
-{
-    CG_HOST_ALLOCATOR *host_alloc = &ctx->HostAllocator;
-    // release device references back to the execution group.
-    for (size_t i = 0, n = group->DeviceCount; i < n; ++i)
+{   // the event is signaled slightly before the status is published.
+    clWaitForEvents(1, &build->ReadyEvent);
+    while (cgPollKernelBuild(build) == CG_NOT_READY)
     {
-        group->DeviceList[i]->ExecutionGroup = CG_INVALID_HANDLE;
+        SwitchToThread();
     }
-    if (group->ComputeContext != NULL)
+}
+
+/// @summary Retrieve the build status of a kernel object. When an asynchronous build has completed, the device binaries 
+/// are written to the kernel cache and the build record is freed. Must be called on the thread that owns the kernel.
+/// @param ctx The CGFX context that owns the kernel object.
+/// @param kernel The kernel object to check.
+/// @return CG_SUCCESS, CG_NOT_READY or CG_COMPILE_FAILED.
+internal_function int
+cgResolveKernelBuild
+(
+    CG_CONTEXT *ctx, 
+    CG_KERNEL  *kernel
+)
+{
+    CG_KERNEL_BUILD *build  = kernel->AsyncBuild;
+    int              status = CG_SUCCESS;
+    if (build == NULL)
+        return kernel->BuildStatus;
+    if ((status = cgPollKernelBuild(build)) == CG_NOT_READY)
+        return CG_NOT_READY;
+    if (status == CG_SUCCESS && build->CacheKeys != NULL)
+    {   // write the device binaries so the next run can skip compilation.
+        cgClStoreProgramBinaries(ctx, build->DeviceCount, build->DeviceIds, build->ComputeProgram, build->CacheKeys);
+    }
+#ifdef _DEBUG
+    if (status != CG_SUCCESS)
     {
-        clReleaseContext(group->ComputeContext);
+        size_t log_size = 0;
+        clGetProgramBuildInfo(build->ComputeProgram, build->DeviceIds[0], CL_PROGRAM_BUILD_LOG, 0, NULL, &log_size);
+        size_t len = 0;
+        char  *buf = (char*) cgAllocateHostMemory(&ctx->HostAllocator, log_size+1, 0, CG_ALLOCATION_TYPE_TEMP);
+        clGetProgramBuildInfo(build->ComputeProgram, build->DeviceIds[0], CL_PROGRAM_BUILD_LOG, log_size+1, buf, &len);
+        buf[len]   = '\0';
+        OutputDebugString(_T("OpenCL asynchronous program compilation failed: \n"));
+        OutputDebugString(_T("**** Compile Log: \n"));
+        OutputDebugStringA(buf);
+        OutputDebugString(_T("\n\n"));
+        cgFreeHostMemory(&ctx->HostAllocator, buf, log_size+1, 0, CG_ALLOCATION_TYPE_TEMP);
     }
-    cgFreeHostMemory(host_alloc, group->QueueList       , group->QueueCount   * sizeof(CG_QUEUE*)   , 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(host_alloc, group->GraphicsQueues  , group->DisplayCount * sizeof(CG_QUEUE*)   , 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(host_alloc, group->AttachedDisplays, group->DisplayCount * sizeof(CG_DISPLAY*) , 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(host_alloc, group->TransferQueues  , group->DeviceCount  * sizeof(CG_QUEUE*)   , 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(host_alloc, group->ComputeQueues   , group->DisplayCount * sizeof(CG_QUEUE*)   , 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(host_alloc, group->DeviceIds       , group->DeviceCount  * sizeof(cl_device_id), 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(host_alloc, group->DeviceList      , group->DeviceCount  * sizeof(CG_DEVICE*)  , 0, CG_ALLOCATION_TYPE_OBJECT);
-    memset(group, 0, sizeof(CG_EXEC_GROUP));
+#endif
+    kernel->BuildStatus = status;
+    kernel->AsyncBuild  = NULL;
+    cgFreeKernelBuild(ctx, build);
+    return status;
 }
 
-/// @summary Frees all resources associated with a compute pipeline object.
-/// @param ctx The CGFX context that owns the compute pipeline object.
-/// @param pipeline The compute pipeline object to delete.
-internal_function void
-cgDeleteComputePipeline
+/// @summary Link a CGFX event to the completion of a kernel or pipeline build.
+/// @param ctx The CGFX context that owns the event object.
+/// @param compute_context The OpenCL context of the execution group that owns the kernel or pipeline.
+/// @param done_event The handle of the event to link, or CG_INVALID_HANDLE.
+/// @param ready The user event of an in-progress build, or NULL if the object is already complete.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_BAD_CLCONTEXT or CG_OUT_OF_MEMORY. On failure, the event no longer references any earlier command, so waiting on it fails rather than reporting a stale completion.
+internal_function int
+cgLinkBuildEvent
 (
-    CG_CONTEXT          *ctx,
-    CG_COMPUTE_PIPELINE *pipeline
+    CG_CONTEXT *ctx, 
+    cl_context  compute_context, 
+    cg_handle_t done_event, 
+    cl_event    ready
 )
 {
-    if (pipeline->ComputeKernel != NULL)
-    {
-        clReleaseKernel(pipeline->ComputeKernel);
+    CG_EVENT *evt   = NULL;
+    cl_int    clres = CL_SUCCESS;
+    if (done_event == CG_INVALID_HANDLE)
+        return CG_SUCCESS;
+    if ((evt = cgObjectTableGet(&ctx->EventTable, done_event)) == NULL)
+        return CG_INVALID_VALUE;
+    if (ready != NULL)
+    {   // the CGFX event holds its own reference to the build event.
+        clRetainEvent(ready);
     }
-    cgFreeHostMemory(&ctx->HostAllocator, pipeline->Arguments       , pipeline->ArgumentCount * sizeof(CG_CL_KERNEL_ARG)    , 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(&ctx->HostAllocator, pipeline->ArgumentNames   , pipeline->ArgumentCount * sizeof(uint32_t)            , 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(&ctx->HostAllocator, pipeline->DeviceKernelInfo, pipeline->DeviceCount   * sizeof(CG_CL_WORKGROUP_INFO), 0, CG_ALLOCATION_TYPE_OBJECT);
-    memset(pipeline, 0, sizeof(CG_COMPUTE_PIPELINE));
+    else if ((ready = clCreateUserEvent(compute_context, &clres)) != NULL)
+    {   // the object is already built, so the event is signaled immediately.
+        clSetUserEventStatus(ready, CL_COMPLETE);
+    }
+    else
+    {   // release the event's previous command so it cannot be mistaken for the build.
+        cgSetupExistingEvent(NULL, evt, NULL, NULL, CG_SUCCESS);
+        return (clres == CL_INVALID_CONTEXT) ? CG_BAD_CLCONTEXT : CG_OUT_OF_MEMORY;
+    }
+    return cgSetupExistingEvent(NULL, evt, ready, NULL, CG_SUCCESS);
 }
 
-/// @summary Frees all resources associated with a graphics pipeline object.
-/// @param ctx The CGFX context that owns the graphics pipeline object.
-/// @param pipeline The graphics pipeline object to delete.
-internal_function void
-cgDeleteGraphicsPipeline
+/// @summary Create the OpenCL kernel object for a compute pipeline and retrieve its work group and argument information.
+/// @param ctx The CGFX context that owns the pipeline.
+/// @param cp The compute pipeline state. DeviceKernelInfo must be allocated.
+/// @param program The OpenCL program object, built for every device in the pipeline's execution group.
+/// @param kernel_name The NULL-terminated name of the kernel function within @a program.
+/// @param source_hash The hash of the kernel program source code, used to key persisted work group tuning results.
+/// @return CG_SUCCESS, CG_OUT_OF_MEMORY or CG_ERROR.
+internal_function int
+cgClFinishComputePipeline
 (
-    CG_CONTEXT           *ctx,
-    CG_GRAPHICS_PIPELINE *pipeline
+    CG_CONTEXT          *ctx, 
+    CG_COMPUTE_PIPELINE *cp, 
+    cl_program           program, 
+    char const          *kernel_name, 
+    uint64_t             source_hash
 )
 {
-    CG_DISPLAY   *display = pipeline->AttachedDisplay;
-    CG_GLSL_PROGRAM &glsl = pipeline->ShaderProgram;
-    if (glsl.Program != 0)
+    cl_uint arg_count = 0;
+    cl_int  clres     = CL_SUCCESS;
+    cl_kernel  k      = clCreateKernel(program, kernel_name, &clres);
+    if (k == NULL)
+    {   // the kernel couldn't be created.
+        switch (clres)
+        {
+        case CL_INVALID_PROGRAM           : return CG_ERROR;
+        case CL_INVALID_PROGRAM_EXECUTABLE: return CG_ERROR;
+        case CL_INVALID_KERNEL_NAME       : return CG_ERROR;
+        case CL_INVALID_KERNEL_DEFINITION : return CG_ERROR;
+        case CL_INVALID_VALUE             : return CG_ERROR;
+        case CL_OUT_OF_HOST_MEMORY        : return CG_OUT_OF_MEMORY;
+        default                           : return CG_ERROR;
+        }
+    }
+    // link the kernel to all devices that share the context.
+    for (size_t device_index = 0, device_count = cp->DeviceCount; device_index < device_count; ++device_index)
     {
-        glDeleteProgram(glsl.Program);
+        clGetKernelWorkGroupInfo(k, cp->DeviceIds[device_index], CL_KERNEL_WORK_GROUP_SIZE        , sizeof(size_t) * 1, &cp->DeviceKernelInfo[device_index].WorkGroupSize , NULL);
+        clGetKernelWorkGroupInfo(k, cp->DeviceIds[device_index], CL_KERNEL_COMPILE_WORK_GROUP_SIZE, sizeof(size_t) * 3,  cp->DeviceKernelInfo[device_index].FixedGroupSize, NULL);
+        clGetKernelWorkGroupInfo(k, cp->DeviceIds[device_index], CL_KERNEL_LOCAL_MEM_SIZE         , sizeof(cl_ulong)  , &cp->DeviceKernelInfo[device_index].LocalMemory   , NULL);
     }
-    cgFreeHostMemory(&ctx->HostAllocator, glsl.Samplers      , glsl.SamplerCount   * sizeof(CG_GLSL_SAMPLER)  , 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(&ctx->HostAllocator, glsl.SamplerNames  , glsl.SamplerCount   * sizeof(uint32_t)         , 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(&ctx->HostAllocator, glsl.Attributes    , glsl.AttributeCount * sizeof(CG_GLSL_ATTRIBUTE), 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(&ctx->HostAllocator, glsl.AttributeNames, glsl.AttributeCount * sizeof(uint32_t)         , 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(&ctx->HostAllocator, glsl.Uniforms      , glsl.UniformCount   * sizeof(CG_GLSL_UNIFORM)  , 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(&ctx->HostAllocator, glsl.UniformNames  , glsl.UniformCount   * sizeof(uint32_t)         , 0, CG_ALLOCATION_TYPE_OBJECT);
-    memset(pipeline, 0, sizeof(CG_GRAPHICS_PIPELINE));
+    cp->ComputeKernel = k;
+    cp->TuningKey     = cgHashString(cgHashData(CG_FNV1A_64_SEED, &source_hash, sizeof(source_hash)), kernel_name);
+
+    // retrieve argument information. this is consistent across kernels.
+    clGetKernelInfo(cp->ComputeKernel, CL_KERNEL_NUM_ARGS, sizeof(cl_uint), &arg_count, NULL);
+    cp->ArgumentCount = size_t(arg_count);
+    cp->ArgumentNames =(uint32_t        *) cgAllocateHostMemory(&ctx->HostAllocator, arg_count * sizeof(uint32_t)        , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cp->Arguments     =(CG_CL_KERNEL_ARG*) cgAllocateHostMemory(&ctx->HostAllocator, arg_count * sizeof(CG_CL_KERNEL_ARG), 0, CG_ALLOCATION_TYPE_OBJECT);
+    if (cp->ArgumentNames == NULL || cp->Arguments == NULL)
+    {   // unable to allocate the required memory.
+        return CG_OUT_OF_MEMORY;
+    }
+    for (size_t i = 0; i < size_t(arg_count); ++i)
+    {
+        char           *name = cgClKernelArgName(ctx, cp->ComputeKernel, cl_uint(i), CG_ALLOCATION_TYPE_TEMP);
+        cp->ArgumentNames[i] = cgHashName(name);
+        cp->Arguments[i].Index  = cl_uint(i);
+        clGetKernelArgInfo(cp->ComputeKernel, cl_uint(i), CL_KERNEL_ARG_ACCESS_QUALIFIER , sizeof(cl_kernel_arg_access_qualifier) , &cp->Arguments[i].ImageAccess  , NULL);
+        clGetKernelArgInfo(cp->ComputeKernel, cl_uint(i), CL_KERNEL_ARG_ADDRESS_QUALIFIER, sizeof(cl_kernel_arg_address_qualifier), &cp->Arguments[i].MemoryType   , NULL);
+        clGetKernelArgInfo(cp->ComputeKernel, cl_uint(i), CL_KERNEL_ARG_TYPE_QUALIFIER   , sizeof(cl_kernel_arg_type_qualifier)   , &cp->Arguments[i].TypeQualifier, NULL);
+        cgClFreeString(ctx, name, CG_ALLOCATION_TYPE_TEMP);
+    }
+    return CG_SUCCESS;
 }
 
-/// @summary Frees all resources associated with a pipeline object.
-/// @param ctx The CGFX context that owns the pipeline object.
-/// @param pipeline The pipeline object to delete.
-internal_function void
-cgDeletePipeline
+/// @summary Complete creation of a compute pipeline whose kernel program was still building when the pipeline was 
+/// created. Must be called on the thread that owns the pipeline.
+/// @param ctx The CGFX context that owns the pipeline.
+/// @param cp The compute pipeline state.
+/// @return CG_SUCCESS, CG_NOT_READY if the program is still building, or the reason the pipeline could not be created.
+internal_function int
+cgResolveComputePipeline
 (
-    CG_CONTEXT  *ctx, 
-    CG_PIPELINE *pipeline
+    CG_CONTEXT          *ctx, 
+    CG_COMPUTE_PIPELINE *cp
 )
-{   // clean up the internal pipeline state first:
-    pipeline->DestroyState((uintptr_t) ctx, (uintptr_t) pipeline, pipeline->PrivateState);
-    // then clean up the state common to all implementations:
-    switch (pipeline->PipelineType)
+{
+    CG_KERNEL *kernel = NULL;
+    int        status = CG_SUCCESS;
+    if (cp->BuildStatus != CG_NOT_READY)
+        return cp->BuildStatus;
+    if ((kernel = cgObjectTableGet(&ctx->KernelTable, cp->KernelProgram)) == NULL)
+    {   // the kernel object was deleted before the pipeline was ready.
+        status = CG_INVALID_STATE;
+    }
+    else if ((status = cgResolveKernelBuild(ctx, kernel)) == CG_NOT_READY)
+    {   // the program is still building.
+        return CG_NOT_READY;
+    }
+    else if (status == CG_SUCCESS)
+    {   // the program is ready, so create the kernel and reflect its arguments.
+        status = cgClFinishComputePipeline(ctx, cp, kernel->ComputeProgram, cp->KernelName, kernel->SourceHash);
+    }
+    cp->BuildStatus    = status;
+    return status;
+}
+
+/// @summary Compute the problem-size class of a compute dispatch. Dispatches in the same class share a tuned local work 
+/// size. The class records, for each dimension, the base-2 logarithm of the global size and the number of trailing zero 
+/// bits, so every power-of-two local size valid for one member of the class evenly divides every other member.
+/// @param work_dim The number of work dimensions, in [1, 3].
+/// @param global_size The global work size in each dimension.
+/// @return The 32-bit size class identifier.
+internal_function uint32_t
+cgWorkGroupSizeClass
+(
+    size_t        work_dim, 
+    size_t const *global_size
+)
+{
+    uint32_t size_class = uint32_t(work_dim);
+    for (size_t i = 0; i < work_dim; ++i)
     {
-    case CG_PIPELINE_TYPE_COMPUTE:
-        cgDeleteComputePipeline(ctx, &pipeline->Compute);
-        break;
-    case CG_PIPELINE_TYPE_GRAPHICS:
-        cgDeleteGraphicsPipeline(ctx, &pipeline->Graphics);
-        break;
-    default:
-        break;
-    }
+        size_t   n    = global_size[i];
+        uint32_t lg2  = 0;
+        uint32_t tz   = 0;
+        while ((n >> lg2) > 1 && lg2 < 63) ++lg2;
+        while (n != 0 && tz < 15 && ((n >> tz) & 1) == 0) ++tz;
+        size_class |= ((lg2 << 4) | tz) << (2 + i * 10);
+    }
+    return size_class;
 }
 
-/// @summary Frees all resources associated with a buffer memory object.
-/// @param ctx The CGFX context that owns the buffer object.
-/// @param buffer The buffer object to delete.
+/// @summary Compute the largest power-of-two local size in each dimension that evenly divides the global size and is 
+/// supported by the device.
+/// @param device The device the kernel will execute on.
+/// @param work_dim The number of work dimensions, in [1, 3].
+/// @param global_size The global work size in each dimension.
+/// @param limit On return, the maximum local size in each of the three dimensions.
 internal_function void
-cgDeleteBuffer
+cgWorkGroupSizeLimits
 (
-    CG_CONTEXT *ctx, 
-    CG_BUFFER  *buffer
+    CG_DEVICE    *device, 
+    size_t        work_dim, 
+    size_t const *global_size, 
+    size_t       *limit
 )
-{   UNREFERENCED_PARAMETER(ctx);
-    if (buffer->ComputeBuffer != NULL)
-    {
-        clReleaseMemObject(buffer->ComputeBuffer);
-    }
-    if (buffer->GraphicsBuffer != 0)
+{
+    CL_DEVICE_CAPS const &caps = device->Capabilities;
+    for (size_t i = 0; i < 3; ++i)
     {
-        CG_DISPLAY *display = buffer->AttachedDisplay;
-        glDeleteBuffers(1, &buffer->GraphicsBuffer);
+        size_t n = (i < work_dim) ? global_size[i] : 1;
+        size_t x = 1;
+        while (n != 0 && (n % (x * 2)) == 0 && x < 32768) x *= 2;
+        if (i < caps.MaxWorkItemDimension)
+        {   // clamp to the per-dimension device limit.
+            while (x > caps.MaxWorkItemSizes[i]) x /= 2;
+        }
+        limit[i] = x;
     }
-    memset(buffer, 0, sizeof(CG_BUFFER));
 }
 
-/// @summary Frees all resources associated with a fence object.
-/// @param ctx The CGFX context that owns the fence object.
-/// @param fence The fence object to delete.
+/// @summary Generate the set of candidate local work sizes for a tuning record. Candidates are power-of-two shapes within 
+/// a factor of 16 of the largest work group the kernel supports on the device, largest first, favoring wide X extents.
+/// @param rec The tuning record to populate.
+/// @param max_group The maximum number of work items in a work group for the kernel on the device.
+/// @param limit The maximum local size in each dimension, from cgWorkGroupSizeLimits.
 internal_function void
-cgDeleteFence
+cgWorkGroupCandidates
 (
-    CG_CONTEXT *ctx, 
-    CG_FENCE   *fence
+    CG_CL_WORKGROUP_TUNING *rec, 
+    size_t                  max_group, 
+    size_t const           *limit
 )
-{   UNREFERENCED_PARAMETER(ctx);
-    switch (fence->QueueType)
+{
+    size_t cap = limit[0] * limit[1] * limit[2];
+    if (cap > max_group) cap = max_group;
+    rec->CandidateCount = 0;
+    for (size_t total = cap; total > 0 && total * 16 > cap; total /= 2)
     {
-    case CG_QUEUE_TYPE_COMPUTE:
-    case CG_QUEUE_TYPE_TRANSFER:
-    case CG_QUEUE_TYPE_COMPUTE_OR_TRANSFER:
-        if (fence->ComputeFence != NULL)
-        {
-            clReleaseEvent(fence->ComputeFence);
-        }
-        break;
-    case CG_QUEUE_TYPE_GRAPHICS:
-        if (fence->GraphicsFence != NULL)
+        for (size_t x = limit[0]; x > 0; x /= 2)
         {
-            CG_DISPLAY *display = fence->AttachedDisplay;
-            glDeleteSync(fence->GraphicsFence);
+            for (size_t y = limit[1]; y > 0; y /= 2)
+            {
+                if (total % (x * y) != 0 || total / (x * y) > limit[2])
+                    continue;
+                size_t z = total / (x * y);
+                if ((x < y && x != limit[0]) || (y < z && y != limit[1]))
+                    continue;
+                if (rec->CandidateCount == CG_MAX_WORKGROUP_CANDIDATES)
+                    return;
+                rec->Candidates[rec->CandidateCount][0] = x;
+                rec->Candidates[rec->CandidateCount][1] = y;
+                rec->Candidates[rec->CandidateCount][2] = z;
+                rec->CandidateCount++;
+            }
         }
-        break;
-    default:
-        break;
     }
-    memset(fence, 0, sizeof(CG_FENCE));
 }
 
-/// @summary Frees all resources associated with an event object.
-/// @param ctx The CGFX context that owns the event object.
-/// @param event The event object to delete.
-internal_function void
-cgDeleteEvent
+/// @summary Compute the on-disk cache key of a persisted work group tuning result.
+/// @param pipeline The compute pipeline.
+/// @param rec The tuning record.
+/// @return The 64-bit cache key.
+internal_function uint64_t
+cgWorkGroupTuningCacheKey
 (
-    CG_CONTEXT *ctx, 
-    CG_EVENT   *event
+    CG_COMPUTE_PIPELINE    *pipeline, 
+    CG_CL_WORKGROUP_TUNING *rec
 )
-{   UNREFERENCED_PARAMETER(ctx);
-    if (event->ComputeEvent != NULL)
-    {
-        clReleaseEvent(event->ComputeEvent);
-    }
-    memset(event, 0, sizeof(CG_EVENT));
+{
+    CG_DEVICE *device = pipeline->DeviceList[rec->DeviceIndex];
+    uint64_t   hash   = pipeline->TuningKey;
+    hash = cgHashString(hash, device->Name);
+    hash = cgHashString(hash, device->Platform);
+    hash = cgHashString(hash, device->Driver);
+    hash = cgHashData  (hash, &rec->SizeClass, sizeof(rec->SizeClass));
+    return hash;
 }
 
-/// @summary Frees all resources associated with an image object.
-/// @param ctx The CGFX context that owns the image object.
-/// @param image The image object to delete.
+/// @summary Select the fastest timed candidate of a tuning record and persist the result to the kernel cache, if enabled.
+/// @param ctx The CGFX context that owns the pipeline.
+/// @param pipeline The compute pipeline being tuned.
+/// @param rec The tuning record, with all candidates timed.
 internal_function void
-cgDeleteImage
+cgFinishWorkGroupTuning
 (
-    CG_CONTEXT *ctx, 
-    CG_IMAGE   *image
+    CG_CONTEXT             *ctx, 
+    CG_COMPUTE_PIPELINE    *pipeline, 
+    CG_CL_WORKGROUP_TUNING *rec
 )
-{   UNREFERENCED_PARAMETER(ctx);
-    if (image->ComputeImage != NULL)
+{
+    cl_ulong best_time = ~cl_ulong(0);
+    rec->BestSize[0]   = rec->BestSize[1] = rec->BestSize[2] = 0;
+    for (uint32_t i = 0; i < rec->CandidateCount; ++i)
     {
-        clReleaseMemObject(image->ComputeImage);
+        if (rec->Timings[i] < best_time)
+        {
+            best_time        = rec->Timings[i];
+            rec->BestSize[0] = rec->Candidates[i][0];
+            rec->BestSize[1] = rec->Candidates[i][1];
+            rec->BestSize[2] = rec->Candidates[i][2];
+        }
     }
-    if (image->GraphicsImage != 0)
+    rec->Tuned = true;
+    if (rec->BestSize[0] != 0)
     {
-        CG_DISPLAY *display = image->AttachedDisplay;
-        glDeleteTextures(1, &image->GraphicsImage);
-        UNREFERENCED_PARAMETER(display);
+        uint32_t data[3] = { uint32_t(rec->BestSize[0]), uint32_t(rec->BestSize[1]), uint32_t(rec->BestSize[2]) };
+        cgKernelCacheWrite(ctx, cgWorkGroupTuningCacheKey(pipeline, rec), "wgsize", data, sizeof(data));
     }
-    memset(image, 0, sizeof(CG_IMAGE));
-}
-
-/// @summary Frees all resources associated with an image sampler object.
-/// @param ctx The CGFX context that owns the sampler object.
-/// @param sampler The image sampler object to delete.
-internal_function void
-cgDeleteSampler
-(
-    CG_CONTEXT *ctx, 
-    CG_SAMPLER *sampler
-)
-{   UNREFERENCED_PARAMETER(ctx);
-    CG_DISPLAY *display = sampler->AttachedDisplay;
-    if (sampler->GraphicsSampler != 0 && GLEW_ARB_sampler_objects)
-    {
-        glDeleteSamplers(1, &sampler->GraphicsSampler);
-    }
-    if (sampler->ComputeSampler != NULL)
-    {
-        clReleaseSampler(sampler->ComputeSampler);
-    }
-    memset(sampler, 0, sizeof(CG_SAMPLER));
 }
 
-/// @summary Frees all resources associated with an input assembler configuration object.
-/// @param ctx The CGFX context that owns the vertex data source object.
-/// @param source The input assembler configuration object to delete.
-internal_function void
-cgDeleteVertexDataSource
+/// @summary Create the tuning record for a device and problem-size class. A result persisted in the kernel cache is used 
+/// if it is still valid for the device; otherwise, the set of candidates to time is generated.
+/// @param ctx The CGFX context that owns the pipeline.
+/// @param pipeline The compute pipeline being tuned.
+/// @param device_index The zero-based index of the device within the pipeline's device list.
+/// @param work_dim The number of work dimensions, in [1, 3].
+/// @param global_size The global work size in each dimension.
+/// @param size_class The problem-size class returned by cgWorkGroupSizeClass.
+/// @return The new tuning record, or NULL if memory could not be allocated.
+internal_function CG_CL_WORKGROUP_TUNING*
+cgCreateWorkGroupTuning
 (
-    CG_CONTEXT            *ctx, 
-    CG_VERTEX_DATA_SOURCE *source
+    CG_CONTEXT          *ctx, 
+    CG_COMPUTE_PIPELINE *pipeline, 
+    size_t               device_index, 
+    size_t               work_dim, 
+    size_t const        *global_size, 
+    uint32_t             size_class
 )
 {
-    CG_DISPLAY *display = source->AttachedDisplay;
-    if (source->VertexArray != 0)
-    {
-        glDeleteVertexArrays(1, &source->VertexArray);
+    CG_CL_WORKGROUP_TUNING *rec       = NULL;
+    size_t                  max_group = pipeline->DeviceKernelInfo[device_index].WorkGroupSize;
+    size_t                  limit[3];
+
+    if (pipeline->TuningCount == pipeline->TuningCapacity)
+    {   // grow the tuning record list.
+        size_t                  new_cap = pipeline->TuningCapacity == 0 ? 4 : pipeline->TuningCapacity * 2;
+        CG_CL_WORKGROUP_TUNING *new_rec =(CG_CL_WORKGROUP_TUNING*) cgAllocateHostMemory(&ctx->HostAllocator, new_cap * sizeof(CG_CL_WORKGROUP_TUNING), 0, CG_ALLOCATION_TYPE_OBJECT);
+        if (new_rec == NULL)
+            return NULL;
+        if (pipeline->TuningCount > 0)
+            memcpy(new_rec, pipeline->Tuning, pipeline->TuningCount * sizeof(CG_CL_WORKGROUP_TUNING));
+        cgFreeHostMemory(&ctx->HostAllocator, pipeline->Tuning, pipeline->TuningCapacity * sizeof(CG_CL_WORKGROUP_TUNING), 0, CG_ALLOCATION_TYPE_OBJECT);
+        pipeline->Tuning         = new_rec;
+        pipeline->TuningCapacity = new_cap;
+    }
+    rec = &pipeline->Tuning[pipeline->TuningCount++];
+    memset(rec, 0, sizeof(CG_CL_WORKGROUP_TUNING));
+    rec->SizeClass   = size_class;
+    rec->DeviceIndex = uint32_t(device_index);
+    if (max_group == 0)
+    {   // the kernel work group information is unavailable.
+        max_group = pipeline->DeviceList[device_index]->Capabilities.MaxWorkGroupSize;
+    }
+    cgWorkGroupSizeLimits(pipeline->DeviceList[device_index], work_dim, global_size, limit);
+
+    size_t    data_size = 0;
+    uint32_t *data      =(uint32_t*) cgKernelCacheRead(ctx, cgWorkGroupTuningCacheKey(pipeline, rec), "wgsize", data_size);
+    if (data != NULL)
+    {   // only accept a persisted result that is still valid for this device and size class.
+        if (data_size == 3 * sizeof(uint32_t) && 
+            data[0] >= 1 && data[0] <= limit[0] && 
+            data[1] >= 1 && data[1] <= limit[1] && 
+            data[2] >= 1 && data[2] <= limit[2] && 
+            size_t(data[0]) * data[1] * data[2] <= max_group)
+        {
+            rec->BestSize[0] = data[0];
+            rec->BestSize[1] = data[1];
+            rec->BestSize[2] = data[2];
+            rec->Tuned       = true;
+        }
+        cgFreeHostMemory(&ctx->HostAllocator, data, data_size, 0, CG_ALLOCATION_TYPE_TEMP);
+        if (rec->Tuned) return rec;
     }
-    cgFreeHostMemory(&ctx->HostAllocator, source->AttributeData  , source->AttributeCount * sizeof(CG_VERTEX_ATTRIBUTE), 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(&ctx->HostAllocator, source->ShaderLocations, source->AttributeCount * sizeof(GLuint)             , 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(&ctx->HostAllocator, source->BufferIndices  , source->AttributeCount * sizeof(size_t)             , 0, CG_ALLOCATION_TYPE_OBJECT);
-    cgFreeHostMemory(&ctx->HostAllocator, source->BufferStrides  , source->BufferCount    * sizeof(size_t)             , 0, CG_ALLOCATION_TYPE_OBJECT);
-    memset(source, 0, sizeof(CG_VERTEX_DATA_SOURCE));
-}
 
-/// @summary Allocates memory for and initializes an empty CGFX context object.
-/// @param app_info Information about the application associated with the context.
-/// @param alloc_cb User-supplied host memory allocator callbacks, or NULL.
-/// @param result Set to CG_SUCCESS if the context was created; otherwise, set to the error code.
-/// @return A pointer to the new CGFX context, or NULL.
-internal_function CG_CONTEXT*
-cgCreateContext
-(
-    cg_application_info_t const  *app_info,
-    cg_allocation_callbacks_t    *alloc_cb,
-    int                          &result
-)
-{   UNREFERENCED_PARAMETER(app_info);
-    CG_CONTEXT       *ctx = NULL;
-    CG_HOST_ALLOCATOR host_alloc = CG_HOST_ALLOCATOR_STATIC_INIT;
-    if ((result = cgSetupUserHostAllocator(alloc_cb, &host_alloc)) != CG_SUCCESS)
-    {   // cannot set up user allocator - can't allocate any memory.
-        return NULL;
-    }
-    if ((ctx = (CG_CONTEXT*) cgAllocateHostMemory(&host_alloc, sizeof(CG_CONTEXT), 0, CG_ALLOCATION_TYPE_OBJECT)) == NULL)
-    {   // unable to allocate the core context storage.
-        result = CG_OUT_OF_MEMORY;
-        return NULL;
+    cgWorkGroupCandidates(rec, max_group, limit);
+    if (rec->CandidateCount <= 1)
+    {   // there is nothing to choose between.
+        rec->BestSize[0] = rec->CandidateCount ? rec->Candidates[0][0] : 0;
+        rec->BestSize[1] = rec->CandidateCount ? rec->Candidates[0][1] : 0;
+        rec->BestSize[2] = rec->CandidateCount ? rec->Candidates[0][2] : 0;
+        rec->Tuned       = true;
     }
-    memset(ctx, 0, sizeof(CG_CONTEXT));
-
-    // initialize the various object tables on the context to empty.
-    cgObjectTableInit(&ctx->DeviceTable      , CG_OBJECT_DEVICE            , CG_DEVICE_TABLE_ID);
-    cgObjectTableInit(&ctx->DisplayTable     , CG_OBJECT_DISPLAY           , CG_DISPLAY_TABLE_ID);
-    cgObjectTableInit(&ctx->QueueTable       , CG_OBJECT_QUEUE             , CG_QUEUE_TABLE_ID);
-    cgObjectTableInit(&ctx->CmdBufferTable   , CG_OBJECT_COMMAND_BUFFER    , CG_CMD_BUFFER_TABLE_ID);
-    cgObjectTableInit(&ctx->ExecGroupTable   , CG_OBJECT_EXECUTION_GROUP   , CG_EXEC_GROUP_TABLE_ID);
-    cgObjectTableInit(&ctx->KernelTable      , CG_OBJECT_KERNEL            , CG_KERNEL_TABLE_ID);
-    cgObjectTableInit(&ctx->PipelineTable    , CG_OBJECT_PIPELINE          , CG_PIPELINE_TABLE_ID);
-    cgObjectTableInit(&ctx->BufferTable      , CG_OBJECT_BUFFER            , CG_BUFFER_TABLE_ID);
-    cgObjectTableInit(&ctx->FenceTable       , CG_OBJECT_FENCE             , CG_FENCE_TABLE_ID);
-    cgObjectTableInit(&ctx->EventTable       , CG_OBJECT_EVENT             , CG_EVENT_TABLE_ID);
-    cgObjectTableInit(&ctx->ImageTable       , CG_OBJECT_IMAGE             , CG_IMAGE_TABLE_ID);
-    cgObjectTableInit(&ctx->SamplerTable     , CG_OBJECT_SAMPLER           , CG_SAMPLER_TABLE_ID);
-    cgObjectTableInit(&ctx->VertexSourceTable, CG_OBJECT_VERTEX_DATA_SOURCE, CG_VERTEX_DATA_SOURCE_TABLE_ID);
-
-    // the context has been fully initialized.
-    result             = CG_SUCCESS;
-    ctx->HostAllocator = host_alloc;
-    return ctx;
+    return rec;
 }
 
-/// @summary Frees all resources associated with a CGFX context object.
-/// @param ctx The CGFX context to delete.
-internal_function void
-cgDeleteContext
+/// @summary Select the local work size for a compute dispatch. Kernels declaring a required work group size always use it. 
+/// If autotuning is enabled for the pipeline, the first dispatches of each problem-size class on each device are run with 
+/// successive candidate local sizes and timed using the profiling event of the kernel command. The fastest candidate is 
+/// used for all later dispatches in the class. Timing never blocks; a candidate is retired only once its event completes.
+/// @param ctx The CGFX context that owns the pipeline.
+/// @param queue The CGFX compute queue the kernel will be enqueued on.
+/// @param pipeline The compute pipeline being dispatched.
+/// @param work_dim The number of work dimensions, in [1, 3].
+/// @param global_size The global work size in each dimension.
+/// @param local_size On return, set to the local work size in each of the three dimensions if the function returns true.
+/// @param timing On return, set to the tuning record to pass to cgRecordWorkGroupTiming after the kernel is enqueued, or NULL.
+/// @return true if @a local_size was set, or false to let the runtime select the local work size.
+export_function bool
+cgSelectWorkGroupSize
 (
-    CG_CONTEXT *ctx
+    CG_CONTEXT              *ctx, 
+    CG_QUEUE                *queue, 
+    CG_COMPUTE_PIPELINE     *pipeline, 
+    size_t                   work_dim, 
+    size_t const            *global_size, 
+    size_t                  *local_size, 
+    CG_CL_WORKGROUP_TUNING **timing
 )
 {
-    CG_HOST_ALLOCATOR *host_alloc = &ctx->HostAllocator;
-    // free all vertex layout objects:
-    for (size_t i = 0, n = ctx->VertexSourceTable.ObjectCount; i < n; ++i)
-    {
-        CG_VERTEX_DATA_SOURCE *obj = &ctx->VertexSourceTable.Objects[i];
-        cgDeleteVertexDataSource(ctx, obj);
-    }
-    // free all sampler objects:
-    for (size_t i = 0, n = ctx->SamplerTable.ObjectCount; i < n; ++i)
-    {
-        CG_SAMPLER *obj = &ctx->SamplerTable.Objects[i];
-        cgDeleteSampler(ctx, obj);
-    }
-    // free all image objects:
-    for (size_t i = 0, n = ctx->ImageTable.ObjectCount; i < n; ++i)
-    {
-        CG_IMAGE *obj = &ctx->ImageTable.Objects[i];
-        cgDeleteImage(ctx, obj);
-    }
-    // free all event objects:
-    for (size_t i = 0, n = ctx->EventTable.ObjectCount; i < n; ++i)
+    CG_CL_WORKGROUP_TUNING *rec          = NULL;
+    size_t                  device_index = pipeline->DeviceCount;
+    uint32_t                size_class   = 0;
+
+    *timing = NULL;
+    for (size_t i = 0, n = pipeline->DeviceCount; i < n; ++i)
     {
-        CG_EVENT *obj = &ctx->EventTable.Objects[i];
-        cgDeleteEvent(ctx, obj);
+        if (pipeline->ComputeQueues[i] == queue)
+        {
+            device_index = i;
+            break;
+        }
     }
-    // free all fence objects:
-    for (size_t i = 0, n = ctx->FenceTable.ObjectCount; i < n; ++i)
-    {
-        CG_FENCE *obj = &ctx->FenceTable.Objects[i];
-        cgDeleteFence(ctx, obj);
+    if (device_index == pipeline->DeviceCount)
+    {   // the queue doesn't belong to the pipeline's execution group.
+        return false;
     }
-    // free all buffer objects:
-    for (size_t i = 0, n = ctx->BufferTable.ObjectCount; i < n; ++i)
-    {
-        CG_BUFFER *obj = &ctx->BufferTable.Objects[i];
-        cgDeleteBuffer(ctx, obj);
+    if (pipeline->DeviceKernelInfo[device_index].FixedGroupSize[0] != 0)
+    {   // the kernel declares reqd_work_group_size, which must be used.
+        local_size[0] = pipeline->DeviceKernelInfo[device_index].FixedGroupSize[0];
+        local_size[1] = pipeline->DeviceKernelInfo[device_index].FixedGroupSize[1];
+        local_size[2] = pipeline->DeviceKernelInfo[device_index].FixedGroupSize[2];
+        return true;
     }
-    // free all pipeline objects:
-    for (size_t i = 0, n = ctx->PipelineTable.ObjectCount; i < n; ++i)
+    if (!pipeline->AutoTune)
+        return false;
+
+    size_class = cgWorkGroupSizeClass(work_dim, global_size);
+    for (size_t i = 0, n = pipeline->TuningCount; i < n; ++i)
     {
-        CG_PIPELINE *obj = &ctx->PipelineTable.Objects[i];
-        cgDeletePipeline(ctx, obj);
+        if (pipeline->Tuning[i].SizeClass == size_class && pipeline->Tuning[i].DeviceIndex == uint32_t(device_index))
+        {
+            rec = &pipeline->Tuning[i];
+            break;
+        }
     }
-    // free all kernel objects:
-    for (size_t i = 0, n = ctx->KernelTable.ObjectCount; i < n; ++i)
+    if (rec == NULL && (rec = cgCreateWorkGroupTuning(ctx, pipeline, device_index, work_dim, global_size, size_class)) == NULL)
+        return false;
+
+    if (!rec->Tuned && rec->PendingEvent != NULL)
     {
-        CG_KERNEL *obj = &ctx->KernelTable.Objects[i];
-        cgDeleteKernel(ctx, obj);
+        cl_int   status = CL_QUEUED;
+        cl_ulong t0     = 0;
+        cl_ulong t1     = 0;
+        clGetEventInfo(rec->PendingEvent, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(cl_int), &status, NULL);
+        if (status > CL_COMPLETE)
+        {   // the timed dispatch is still in flight; reuse its candidate without timing.
+            local_size[0] = rec->Candidates[rec->CandidateIndex][0];
+            local_size[1] = rec->Candidates[rec->CandidateIndex][1];
+            local_size[2] = rec->Candidates[rec->CandidateIndex][2];
+            return true;
+        }
+        if (status == CL_COMPLETE && 
+            clGetEventProfilingInfo(rec->PendingEvent, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &t0, NULL) == CL_SUCCESS && 
+            clGetEventProfilingInfo(rec->PendingEvent, CL_PROFILING_COMMAND_END  , sizeof(cl_ulong), &t1, NULL) == CL_SUCCESS && t1 >= t0)
+        {
+            rec->Timings[rec->CandidateIndex] = t1 - t0;
+        }
+        else
+        {   // the dispatch failed or could not be timed; never select this candidate.
+            rec->Timings[rec->CandidateIndex] = ~cl_ulong(0);
+        }
+        clReleaseEvent(rec->PendingEvent);
+        rec->PendingEvent = NULL;
+        rec->CandidateIndex++;
     }
-    // free all command buffer objects:
-    for (size_t i = 0, n = ctx->CmdBufferTable.ObjectCount; i < n; ++i)
-    {
-        CG_CMD_BUFFER *obj = &ctx->CmdBufferTable.Objects[i];
-        cgDeleteCmdBuffer(ctx, obj);
+    if (!rec->Tuned && rec->CandidateIndex >= rec->CandidateCount)
+    {   // all candidates have been timed.
+        cgFinishWorkGroupTuning(ctx, pipeline, rec);
     }
-    // free all command queue objects:
-    for (size_t i = 0, n = ctx->QueueTable.ObjectCount; i < n; ++i)
+    if (rec->Tuned)
     {
-        CG_QUEUE *obj = &ctx->QueueTable.Objects[i];
-        cgDeleteQueue(ctx, obj);
+        local_size[0] = rec->BestSize[0];
+        local_size[1] = rec->BestSize[1];
+        local_size[2] = rec->BestSize[2];
+        return (rec->BestSize[0] != 0);
+    }
+    local_size[0] = rec->Candidates[rec->CandidateIndex][0];
+    local_size[1] = rec->Candidates[rec->CandidateIndex][1];
+    local_size[2] = rec->Candidates[rec->CandidateIndex][2];
+    *timing = rec;
+    return true;
+}
+
+/// @summary Record the kernel command event of a dispatch enqueued with a candidate local work size. The event is retained 
+/// and its profiling information is read by a later call to cgSelectWorkGroupSize once the command has completed.
+/// @param timing The tuning record returned by cgSelectWorkGroupSize.
+/// @param kernel_done The event returned by clEnqueueNDRangeKernel, or NULL if the kernel could not be enqueued with the candidate.
+export_function void
+cgRecordWorkGroupTiming
+(
+    CG_CL_WORKGROUP_TUNING *timing, 
+    cl_event                kernel_done
+)
+{
+    if (timing->Tuned || timing->PendingEvent != NULL || timing->CandidateIndex >= timing->CandidateCount)
+        return;
+    if (kernel_done != NULL)
+    {   // read the timing once the command has completed.
+        clRetainEvent(kernel_done);
+        timing->PendingEvent = kernel_done;
     }
-    // free all execution group objects:
-    for (size_t i = 0, n = ctx->ExecGroupTable.ObjectCount; i < n; ++i)
-    {
-        CG_EXEC_GROUP *obj = &ctx->ExecGroupTable.Objects[i];
-        cgDeleteExecutionGroup(ctx, obj);
+    else
+    {   // the candidate is not usable with this kernel; skip it.
+        timing->Timings[timing->CandidateIndex++] = ~cl_ulong(0);
     }
-    // free all device objects:
-    for (size_t i = 0, n = ctx->DeviceTable.ObjectCount; i < n; ++i)
+}
+
+/// @summary Frees all resources and releases all references held by a device object.
+/// @param ctx The CGFX context that owns the device object.
+/// @param device The device object to delete.
+internal_function void
+cgDeleteDevice
+(
+    CG_CONTEXT     *ctx,
+    CG_DEVICE      *device
+)
+{
+    if (device->DisplayRC != NULL)
     {
-        CG_DEVICE  *obj = &ctx->DeviceTable.Objects[i];
-        cgDeleteDevice(ctx, obj);
+        wglDeleteContext(device->DisplayRC);
     }
-    // free all display objects:
-    for (size_t i = 0, n = ctx->DisplayTable.ObjectCount; i < n; ++i)
+    cgClDeviceCapsFree(ctx, &device->Capabilities);
+    cgClFreeString(ctx, device->Extensions, CG_ALLOCATION_TYPE_INTERNAL);
+    cgClFreeString(ctx, device->Driver    , CG_ALLOCATION_TYPE_INTERNAL);
+    cgClFreeString(ctx, device->Version   , CG_ALLOCATION_TYPE_INTERNAL);
+    cgClFreeString(ctx, device->Platform  , CG_ALLOCATION_TYPE_INTERNAL);
+    cgClFreeString(ctx, device->Name      , CG_ALLOCATION_TYPE_INTERNAL);
+    if (device->DeviceId != NULL)
     {
-        CG_DISPLAY *obj = &ctx->DisplayTable.Objects[i];
-        cgDeleteDisplay(ctx, obj);
+        clReleaseDevice(device->DeviceId);
     }
-    // free heap descriptors:
-    cgFreeHostMemory(host_alloc, ctx->HeapList, ctx->HeapCount * sizeof(CG_HEAP), 0, CG_ALLOCATION_TYPE_OBJECT);
-    // finally, free the memory block for the context structure:
-    cgFreeHostMemory(host_alloc, ctx, sizeof(CG_CONTEXT), 0, CG_ALLOCATION_TYPE_OBJECT);
+    memset(device, 0, sizeof(CG_DEVICE));
 }
 
-/// @summary Determine the number of heaps exposed by the set of devices in the local system.
-/// @param ctx The CGFX context managing the device set.
-/// @return The number of unique heaps in the local system.
-internal_function size_t
-cgClCountUniqueHeaps
+/// @summary Frees all resources and releases all references held by a display object.
+/// The rendering context of the display, if any, must not have been deleted yet.
+/// @param ctx The CGFX context that owns the display object.
+/// @param display The display object to delete.
+internal_function void
+cgDeleteDisplay
 (
-    CG_CONTEXT *ctx
+    CG_CONTEXT    *ctx,
+    CG_DISPLAY    *display
 )
 {
-    size_t cpus_n = 0;
-    size_t heap_n = 0;
-    for (size_t i = 0, n = ctx->DeviceTable.ObjectCount; i < n; ++i)
-    {
-        CG_DEVICE const *dev = &ctx->DeviceTable.Objects[i];
-        if (dev->Type == CL_DEVICE_TYPE_CPU)
-        {   // CPU devices support partitioning. CPUs share a heap.
-            cpus_n++;  // heap_n updated outside of the loop.
-        }
-        else
-        {   // GPU and accelerator devices have two heaps.
-            // the first is the local heap, which is sized to device global memory.
-            // the second is the pinned memory heap, which is sized to the max allocation.
-            heap_n += 2;
+    if (display->FrameTimer != NULL)
+    {   // the fences and queries of frames still in flight can only be deleted while the rendering context is current.
+        CG_GL_FRAME_TIMER *timer = display->FrameTimer;
+        HGLRC              rc    = wglGetCurrentContext();
+        HDC                dc    = wglGetCurrentDC();
+        if (display->DisplayRC != NULL && (rc == display->DisplayRC || wglMakeCurrent(display->DisplayDC, display->DisplayRC) == TRUE))
+        {
+            for (size_t i = 0; i < CG_OPENGL_FRAME_MAX_IN_FLIGHT; ++i)
+            {
+                if (timer->PendingFence[i] != NULL)
+                    glDeleteSync(timer->PendingFence[i]);
+                if (timer->PendingQuery[i] != 0)
+                    glDeleteQueries(1, &timer->PendingQuery[i]);
+            }
+            if (rc != display->DisplayRC)
+            {   // restore the rendering context that was current on entry.
+                wglMakeCurrent(dc, rc);
+            }
         }
+        cgFreeHostMemory(&ctx->HostAllocator, display->FrameTimer, sizeof(CG_GL_FRAME_TIMER), CACHELINE_SIZE, CG_ALLOCATION_TYPE_INTERNAL);
     }
-    if (cpus_n > 0)
+    if (display->DisplayDC != NULL)
     {
-        if (cpus_n >= ctx->CpuInfo.NUMANodes)
-        {   // CPUs have one heap per-NUMA node.
-            heap_n += ctx->CpuInfo.NUMANodes;
-        }
-        else
-        {   // one heap per logical CPU device. 
-            // it's possible that one or more nodes are disabled.
-            heap_n += cpus_n;
-        }
+        ReleaseDC(display->DisplayHWND, display->DisplayDC);
     }
-    return heap_n;
+    if (display->DisplayHWND != NULL)
+    {
+        DestroyWindow(display->DisplayHWND);
+    }
+    memset(display, 0, sizeof(CG_DISPLAY));
 }
 
-/// @summary Determine whether a device heap is already defined. This is necessary for CPU devices that may be partitioned.
-/// @param partition_type One of cl_device_partition_property, or 0, specifying the parition type of the device.
-/// @param heap The heap attributes to search for.
-/// @param heap_list The heap list to search.
-/// @param heap_count The number of heaps currently defined.
-/// @param heap_index If the function returns true, on return, this value contains the zero-based index of the existing heap in @a heap_list.
-/// @return true if the specified heap exists.
-internal_function bool
-cgClHasHeap
+/// @summary Frees all resources and releases all references held by a queue object.
+/// @param ctx The CGFX context that owns the queue object.
+/// @param queue The queue object to delete.
+internal_function void
+cgDeleteQueue
 (
-    intptr_t partition_type,
-    CG_HEAP *heap,
-    CG_HEAP *heap_list, 
-    size_t   heap_count, 
-    size_t  &heap_index
+    CG_CONTEXT *ctx,
+    CG_QUEUE   *queue
+)
+{   UNREFERENCED_PARAMETER(ctx);
+    if (queue->CommandQueue != NULL)
+        clReleaseCommandQueue(queue->CommandQueue);
+    memset(queue, 0, sizeof(CG_QUEUE));
+}
+
+/// @summary Frees all resources associated with a command buffer object.
+/// @param ctx The CGFX context that owns the command buffer object.
+/// @param cmdbuf The command buffer object to delete.
+internal_function void
+cgDeleteCmdBuffer
+(
+    CG_CONTEXT    *ctx,
+    CG_CMD_BUFFER *cmdbuf
+)
+{   UNREFERENCED_PARAMETER(ctx);
+    if (cmdbuf->CommandData != NULL)
+        VirtualFree(cmdbuf->CommandData, 0, MEM_RELEASE);
+    if (cmdbuf->SortEntries != NULL)
+        VirtualFree(cmdbuf->SortEntries, 0, MEM_RELEASE);
+    cmdbuf->BytesTotal     = 0;
+    cmdbuf->BytesUsed      = 0;
+    cmdbuf->CommandCount   = 0;
+    cmdbuf->CommandData    = NULL;
+    cmdbuf->SortBytesTotal = 0;
+    cmdbuf->SortEntries    = NULL;
+}
+
+/// @summary Frees all resources and releases all references associated with a kernel object.
+/// @param ctx The CGFX context that owns the kernel object.
+/// @param kernel The kernel object to delete.
+internal_function void
+cgDeleteKernel
+(
+    CG_CONTEXT *ctx,
+    CG_KERNEL  *kernel
 )
 {
-    if (partition_type == CL_DEVICE_PARTITION_AFFINITY_DOMAIN)
-        return false;
-    for (size_t i = 0; i < heap_count; ++i)
+    switch (kernel->KernelType)
     {
-        if (heap->ParentDeviceId == heap_list[i].ParentDeviceId && 
-            heap->Type           == heap_list[i].Type           && 
-            heap->HeapSizeTotal  == heap_list[i].HeapSizeTotal)
+    case CG_KERNEL_TYPE_GRAPHICS_VERTEX:
+    case CG_KERNEL_TYPE_GRAPHICS_FRAGMENT:
+    case CG_KERNEL_TYPE_GRAPHICS_PRIMITIVE:
         {
-            heap_index = i;
-            return true;
+            CG_DISPLAY *display = kernel->AttachedDisplay;
+            if (kernel->GraphicsShader != 0)
+            {
+                glDeleteShader(kernel->GraphicsShader);
+            }
+        }
+        break;
+    case CG_KERNEL_TYPE_COMPUTE:
+        {
+            if (kernel->AsyncBuild != NULL)
+            {   // the thread pool still references the program; wait for the build to finish.
+                cgWaitKernelBuild(kernel->AsyncBuild);
+                cgFreeKernelBuild(ctx, kernel->AsyncBuild);
+            }
+            if (kernel->ComputeProgram != NULL)
+            {
+                clReleaseProgram(kernel->ComputeProgram);
+            }
         }
+        break;
+    default:
+        break;
     }
-    return false;
+    memset(kernel, 0, sizeof(CG_KERNEL));
 }
 
-/// @summary Retrieve information about the available heaps in the system.
-/// @param ctx The CGFX context defining the device list.
-/// @param heaps An array of @a max_heaps items to populate with data.
-/// @param max_heaps The maximum number of heaps to write to @a heaps.
-/// @return The number of heaps written to @a heaps.
-internal_function size_t
-cgClGetHeapInformation
+/// @summary Add an allocation to the estimate of pinnable memory used on a heap. Safe to call from any thread.
+/// @param heap The heap the memory was allocated from.
+/// @param size The number of bytes allocated.
+internal_function void
+cgHeapAddPinnable
 (
-    CG_CONTEXT *ctx, 
-    CG_HEAP    *heaps, 
-    size_t      max_heaps
+    CG_HEAP  *heap, 
+    cl_ulong  size
 )
 {
-    SYSTEM_INFO  info;
-    size_t heap_count = 0;
-    GetNativeSystemInfo(&info);
-    for (size_t i = 0 , n = ctx->DeviceTable.ObjectCount; i < n && heap_count < max_heaps; ++i)
-    {
-        CG_DEVICE const *dev = &ctx->DeviceTable.Objects[i];
-        cl_device_id     did = NULL;
-
-        clGetDeviceInfo(dev->DeviceId, CL_DEVICE_PARENT_DEVICE, sizeof(cl_device_id), &did, NULL);
-        if (did == NULL)
-        {   // this is a root device; it has no parent.
-            did = dev->DeviceId;
-        }
+    AcquireSRWLockExclusive(&heap->PinnableLock);
+    heap->PinnableUsed += size;
+    ReleaseSRWLockExclusive(&heap->PinnableLock);
+}
 
-        size_t props_size = 0;
-        cl_device_partition_property props[16];
-        memset(props, 0, sizeof(props));
-        clGetDeviceInfo(dev->DeviceId, CL_DEVICE_PARTITION_PROPERTIES, sizeof(props), props, &props_size);
-        if (props_size == 0) props[0] = 0; // terminate the list explicitly
+/// @summary Remove an allocation from the estimate of pinnable memory used on a heap. Safe to call from any thread.
+/// @param heap The heap the memory was allocated from.
+/// @param size The number of bytes freed.
+internal_function void
+cgHeapRemovePinnable
+(
+    CG_HEAP  *heap, 
+    cl_ulong  size
+)
+{
+    AcquireSRWLockExclusive(&heap->PinnableLock);
+    if (heap->PinnableUsed >= size)
+        heap->PinnableUsed -= size;
+    else
+        heap->PinnableUsed  = 0;
+    ReleaseSRWLockExclusive(&heap->PinnableLock);
+}
 
-        // all devices define a local heap.
-        size_t   index        = heap_count;
-        CG_HEAP &local        = heaps[heap_count];
-        local.Ordinal         = index;
-        local.ParentDeviceId  = did;
-        local.Type            = CG_HEAP_TYPE_LOCAL;
-        local.Flags           = 0;
-        local.DeviceType      = dev->Type;
-        local.HeapSizeTotal   = dev->Capabilities.GlobalMemorySize;
-        local.HeapSizeUsed    = 0;
-        local.PinnableTotal   = 0;
-        local.PinnableUsed    = 0;
-        local.DeviceAlignment = dev->Capabilities.AddressAlign;
-        local.UserAlignment   = info.dwPageSize;
-        local.UserSizeAlign   = dev->Capabilities.AddressAlign;
-        if (dev->Type   != CL_DEVICE_TYPE_CPU || dev->Capabilities.UnifiedMemory)
-            local.Flags |= CG_HEAP_GPU_ACCESSIBLE;
-        if (dev->Type   == CL_DEVICE_TYPE_CPU || dev->Capabilities.UnifiedMemory)
-            local.Flags |= CG_HEAP_CPU_ACCESSIBLE;
-        if (dev->Type   != CL_DEVICE_TYPE_CPU)
-        {   // GPU and accelerator devices are typically accessed over PCIe and 
-            // have a portion of address space reserved as pinnable so that data
-            // can be transferred to local device memory via DMA.
-            local.PinnableTotal = dev->Capabilities.MaxMallocSize;
-            local.PinnableUsed  = 0;
-            local.Flags        |= CG_HEAP_HOLDS_PINNED;
-        }
-        if (dev->Capabilities.UnifiedMemory)
-        {   // use the maximum of the system page size and the device alignment.
-            // zero-copy buffers require 4KB alignment and a size multiple of 64KB (Intel and AMD).
-            // https://software.intel.com/en-us/articles/getting-the-most-from-opencl-12-how-to-increase-performance-by-minimizing-buffer-copies-on-intel-processor-graphics
-            local.UserSizeAlign = dev->Capabilities.GlobalCacheLineSize;
+/// @summary Recycle staging pool slices whose retirement events have been signaled. Slices are recycled in allocation order.
+/// The caller must hold the pool lock.
+/// @param pool The staging pool to update.
+internal_function void
+cgStagingPoolReclaim
+(
+    CG_STAGING_POOL *pool
+)
+{
+    while (pool->SliceCount > 0)
+    {
+        CG_STAGING_SLICE *slice = &pool->Slices[pool->SliceHead];
+        if (slice->State != CG_STAGING_SLICE::RELEASED)
+        {   // the oldest slice is still held by the application.
+            break;
         }
-        if (cgClHasHeap(props[0], &local, heaps, heap_count, index))
-        {   // mark the existing heap as being shared.
-            heaps[index].Flags |= CG_HEAP_SHAREABLE;
+        if (slice->RetireEvent != NULL)
+        {   // check the status of the transfer that last referenced the slice.
+            // negative values indicate abnormal termination; the slice can be recycled.
+            cl_int status = CL_COMPLETE;
+            clGetEventInfo(slice->RetireEvent, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(cl_int), &status, NULL);
+            if (status > CL_COMPLETE)
+            {   // the device is still accessing the slice.
+                break;
+            }
+            clReleaseEvent(slice->RetireEvent);
+            slice->RetireEvent = NULL;
         }
-        else heap_count++;
+        pool->ReadOffset = slice->Offset + slice->Size;
+        pool->BytesUsed -= slice->Size;
+        pool->SliceHead  =(pool->SliceHead + 1) % CG_MAX_STAGING_SLICES;
+        pool->SliceCount--;
+    }
+    if (pool->SliceCount == 0)
+    {   // the arena is empty; restart allocation at the beginning.
+        pool->ReadOffset  = 0;
+        pool->WriteOffset = 0;
     }
-    return heap_count;
 }
 
-/// @summary Locate the heap corresponding to a particular memory object placement hint.
-/// @param ctx The CGFX context maintaining the heap list.
-/// @param placement_hint One of cg_memory_object_placement_e specifying the desired location for the memory object.
-/// @return A pointer to the source heap.
-internal_function CG_HEAP*
-cgFindHeapForPlacement
+/// @summary Sub-allocate a slice of a staging arena. Completed slices are reclaimed before the allocation is attempted.
+/// The caller must hold the pool lock.
+/// @param pool The staging pool to allocate from.
+/// @param size The number of bytes requested.
+/// @param offset On return, stores the byte offset of the slice within the staging arena.
+/// @param index On return, stores the index of the slice descriptor.
+/// @return CG_SUCCESS, CG_NOT_READY if there is not enough free space in the arena, or CG_OUT_OF_MEMORY if the request can never be satisfied.
+internal_function int
+cgStagingPoolAllocateLocked
 (
-    CG_CONTEXT *ctx, 
-    int         placement_hint
+    CG_STAGING_POOL *pool,
+    size_t           size,
+    size_t          &offset,
+    size_t          &index
 )
 {
-    for (size_t i = 0, n = ctx->HeapCount; i < n; ++i)
-    {
-        CG_HEAP *heap  = &ctx->HeapList[i];
-        if ((placement_hint == CG_MEMORY_PLACEMENT_PINNED) && (heap->Flags & CG_HEAP_HOLDS_PINNED))
-            return heap;
-        if ((placement_hint == CG_MEMORY_PLACEMENT_HOST  ) && (heap->DeviceType == CL_DEVICE_TYPE_CPU))
-            return heap;
-        if ((placement_hint == CG_MEMORY_PLACEMENT_DEVICE) && (heap->DeviceType != CL_DEVICE_TYPE_CPU))
-            return heap;
+    size_t bytes = align_up(size, pool->Alignment);
+    size_t base  = 0;
+    size_t waste = 0;
+
+    if (bytes > pool->ArenaSize)
+    {   // the request exceeds the size of the entire arena.
+        return CG_OUT_OF_MEMORY;
     }
-    return &ctx->HeapList[0];
+    cgStagingPoolReclaim(pool);
+    if (pool->SliceCount == CG_MAX_STAGING_SLICES)
+    {   // all slice descriptors are in use.
+        return CG_NOT_READY;
+    }
+    if (pool->SliceCount == 0)
+    {   // the arena is empty.
+        base  = 0;
+    }
+    else if (pool->WriteOffset > pool->ReadOffset)
+    {   // the live region does not wrap; try the tail end, then the front.
+        if (pool->WriteOffset + bytes <= pool->ArenaSize)
+        {
+            base  = pool->WriteOffset;
+        }
+        else if (bytes <= pool->ReadOffset)
+        {   // the unused space at the end of the arena is attributed to the new slice.
+            base  = 0;
+            waste = pool->ArenaSize - pool->WriteOffset;
+        }
+        else return CG_NOT_READY;
+    }
+    else if (pool->WriteOffset + bytes <= pool->ReadOffset)
+    {   // the live region wraps, and there's room between the write and read cursors.
+        base  = pool->WriteOffset;
+    }
+    else return CG_NOT_READY;
+
+    CG_STAGING_SLICE *slice = NULL;
+    index  =(pool->SliceHead + pool->SliceCount) % CG_MAX_STAGING_SLICES;
+    slice  =&pool->Slices[index];
+    slice->State       = CG_STAGING_SLICE::ACTIVE;
+    slice->Offset      = base;
+    slice->Size        = bytes;
+    slice->RetireEvent = NULL;
+    if (waste > 0 && pool->SliceCount > 0)
+    {   // extend the previous slice to cover the skipped space at the end of the arena.
+        size_t prev = (index + CG_MAX_STAGING_SLICES - 1) % CG_MAX_STAGING_SLICES;
+        pool->Slices[prev].Size += waste;
+        pool->BytesUsed         += waste;
+    }
+    pool->WriteOffset = base + bytes;
+    pool->BytesUsed  += bytes;
+    pool->SliceCount++;
+    offset = base;
+    return CG_SUCCESS;
 }
 
-/// @summary Locate the heap corresponding to OpenGL buffer usage flags.
-/// @param ctx The CGFX context maintaining the heap list.
-/// @param usage The OpenGL buffer usage hint, for example, GL_STREAM_DRAW.
-/// @return A pointer to the source heap.
-internal_function CG_HEAP*
-cgGlFindHeapForUsage
+/// @summary Sub-allocate a slice of a staging arena for a new staging buffer. On success, the slice is counted as a live 
+/// buffer of the pool and must be returned with cgStagingPoolRelease. Safe to call from any thread.
+/// @param pool The staging pool to allocate from.
+/// @param size The number of bytes requested.
+/// @param offset On return, stores the byte offset of the slice within the staging arena.
+/// @param index On return, stores the index of the slice descriptor.
+/// @return CG_SUCCESS, CG_NOT_READY if there is not enough free space in the arena, or CG_OUT_OF_MEMORY if the request can never be satisfied.
+internal_function int
+cgStagingPoolAllocate
 (
-    CG_CONTEXT *ctx, 
-    GLenum      usage
+    CG_STAGING_POOL *pool,
+    size_t           size,
+    size_t          &offset,
+    size_t          &index
 )
-{   // convert the OpenGL usage hints to a CGFX placement hint.
-    int placement_hint = 0;
-    switch (usage)
+{
+    int result = CG_SUCCESS;
+    AcquireSRWLockExclusive(&pool->Lock);
+    if ((result = cgStagingPoolAllocateLocked(pool, size, offset, index)) == CG_SUCCESS)
+        pool->LiveBuffers++;
+    ReleaseSRWLockExclusive(&pool->Lock);
+    return result;
+}
+
+/// @summary Search the staging pools of a heap for the pool owned by an execution group.
+/// @param heap The heap to search.
+/// @param cl_ctx The OpenCL context of the execution group.
+/// @return The staging pool, or NULL if the execution group has no staging pool on the heap.
+internal_function CG_STAGING_POOL*
+cgFindStagingPool
+(
+    CG_HEAP   *heap,
+    cl_context cl_ctx
+)
+{
+    for (CG_STAGING_POOL *pool = heap->StagingPool; pool != NULL; pool = pool->Next)
     {
-    case GL_STATIC_DRAW:
-        placement_hint = CG_MEMORY_PLACEMENT_DEVICE;
-        break;
-    case GL_STATIC_READ:
-        placement_hint = CG_MEMORY_PLACEMENT_PINNED;
-        break;
-    case GL_STATIC_COPY:
-        placement_hint = CG_MEMORY_PLACEMENT_DEVICE;
-        break;
-    case GL_STREAM_DRAW:
-        placement_hint = CG_MEMORY_PLACEMENT_PINNED;
-        break;
-    case GL_STREAM_READ:
-        placement_hint = CG_MEMORY_PLACEMENT_PINNED;
-        break;
-    case GL_STREAM_COPY:
-        placement_hint = CG_MEMORY_PLACEMENT_DEVICE;
-        break;
-    case GL_DYNAMIC_DRAW:
-        placement_hint = CG_MEMORY_PLACEMENT_PINNED;
-        break;
-    case GL_DYNAMIC_READ:
-        placement_hint = CG_MEMORY_PLACEMENT_PINNED;
-        break;
-    case GL_DYNAMIC_COPY:
-        placement_hint = CG_MEMORY_PLACEMENT_DEVICE;
-        break;
-    default:
-        placement_hint = CG_MEMORY_PLACEMENT_HOST;
-        break;
+        if (pool->ComputeContext == cl_ctx)
+            return pool;
     }
-    return cgFindHeapForPlacement(ctx, placement_hint);
+    return NULL;
 }
 
-/// @summary Populate a cl_image_desc and cl_image_format to describe an image.
-/// @param cl_desc On return, stores the OpenCL image layout descriptor data.
-/// @param cl_format On return, stores the OpenCL pixel layout descriptor data.
-/// @param gl_target On return, stores the OpenGL texture target.
-/// @param pixel_width The image width, in pixels.
-/// @param pixel_height The image height, in pixels.
-/// @param slice_count The number of slices in the image. For 1D and 2D images, specify 1.
-/// @param array_count The number of array elements in the image. For cubemap images, specify 6. For non-array images, specify 1.
-/// @param level_count The number of mipmap levels in the image. For no mipmaps, specify 1. For all mipmaps, specify 0.
-/// @param row_pitch The number of bytes between each row of each slice in the image.
-/// @param slice_pitch The number of bytes between each slice of the image.
-/// @return true if the image attributes describe a logically valid combination. The device may or may not support the specified attributes.
-internal_function bool
-cgClMakeImageDesc
+/// @summary Allocate, pin and map the staging arena for an execution group on a heap, and add it to the staging pools of the heap.
+/// @param ctx The CGFX context that owns the heap.
+/// @param heap The heap for which the staging pool will be created.
+/// @param cl_ctx The OpenCL context of the execution group that will own the staging pool.
+/// @param map_queue The OpenCL command queue used to map the arena into the host address space.
+/// @param arena_size The requested size of the staging arena, in bytes. This value is clamped to the amount of pinnable memory available on the heap.
+/// @return CG_SUCCESS, CG_UNSUPPORTED, CG_OUT_OF_MEMORY, CG_BAD_CLCONTEXT or CG_ERROR.
+internal_function int
+cgCreateStagingPool
 (
-    cl_image_desc   &cl_desc,
-    cl_image_format &cl_format,
-    GLenum          &gl_target,
-    uint32_t         dxgi_format,
-    size_t           pixel_width, 
-    size_t           pixel_height, 
-    size_t           slice_count, 
-    size_t           array_count, 
-    size_t           level_count,
-    size_t           row_pitch, 
-    size_t           slice_pitch
+    CG_CONTEXT      *ctx,
+    CG_HEAP         *heap,
+    cl_context       cl_ctx,
+    cl_command_queue map_queue,
+    size_t           arena_size
 )
-{   UNREFERENCED_PARAMETER(level_count);
-    // populate a cl_image_desc object.
-    if (array_count > 1)
-    {   // this is an array image, which may be 1D or 2D.
-        if (pixel_height > 1)
+{
+    CG_STAGING_POOL *pool      = NULL;
+    cl_mem           arena     = NULL;
+    void            *mapped    = NULL;
+    cl_int           clres     = CL_SUCCESS;
+    size_t           alignment = heap->DeviceAlignment > heap->UserAlignment ? heap->DeviceAlignment : heap->UserAlignment;
+    cl_ulong         available = 0;
+
+    if ((heap->Flags & CG_HEAP_HOLDS_PINNED) == 0)
+    {   // the heap doesn't define any pinnable memory.
+        return CG_UNSUPPORTED;
+    }
+    AcquireSRWLockShared(&heap->PinnableLock);
+    if (heap->PinnableUsed < heap->PinnableTotal)
+    {   // never reserve more than what remains of the pinnable region.
+        available = heap->PinnableTotal - heap->PinnableUsed;
+    }
+    ReleaseSRWLockShared(&heap->PinnableLock);
+    if (arena_size > available)
+    {
+        arena_size = size_t(available);
+    }
+    if ((arena_size = align_up(arena_size, alignment)) > available)
+    {   // not even a single aligned block is available.
+        return CG_OUT_OF_MEMORY;
+    }
+    if ((arena = clCreateBuffer(cl_ctx, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, arena_size, NULL, &clres)) == NULL)
+    {
+        switch (clres)
         {
-            gl_target                 = GL_TEXTURE_2D_ARRAY;
-            cl_desc.image_type        = CL_MEM_OBJECT_IMAGE2D_ARRAY;
-            cl_desc.image_width       = pixel_width;
-            cl_desc.image_height      = pixel_height;
-            cl_desc.image_depth       = 0;
-            cl_desc.image_array_size  = array_count;
-            cl_desc.image_row_pitch   = row_pitch;
-            cl_desc.image_slice_pitch = slice_pitch;
-            cl_desc.num_mip_levels    = 0;
-            cl_desc.num_samples       = 0;
-        }
-        else
+        case CL_INVALID_CONTEXT              : return CG_BAD_CLCONTEXT;
+        case CL_INVALID_BUFFER_SIZE          : return CG_OUT_OF_MEMORY;
+        case CL_MEM_OBJECT_ALLOCATION_FAILURE: return CG_OUT_OF_MEMORY;
+        case CL_OUT_OF_RESOURCES             : return CG_OUT_OF_MEMORY;
+        case CL_OUT_OF_HOST_MEMORY           : return CG_OUT_OF_MEMORY;
+        default                              : return CG_ERROR;
+        }
+    }
+    // the arena remains mapped for its entire lifetime. sub-buffers are only ever 
+    // accessed by the device after the host has finished writing to them, and the 
+    // host only reads from them after the device has signaled completion.
+    if ((mapped = clEnqueueMapBuffer(map_queue, arena, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0, arena_size, 0, NULL, NULL, &clres)) == NULL)
+    {
+        clReleaseMemObject(arena);
+        switch (clres)
         {
-            gl_target                 = GL_TEXTURE_1D_ARRAY;
-            cl_desc.image_type        = CL_MEM_OBJECT_IMAGE1D_ARRAY;
-            cl_desc.image_width       = pixel_width;
-            cl_desc.image_height      = 0;
-            cl_desc.image_depth       = 0;
-            cl_desc.image_array_size  = array_count;
-            cl_desc.image_row_pitch   = row_pitch;
-            cl_desc.image_slice_pitch = slice_pitch;
-            cl_desc.num_mip_levels    = 0;
-            cl_desc.num_samples       = 0;
+        case CL_MEM_OBJECT_ALLOCATION_FAILURE: return CG_OUT_OF_MEMORY;
+        case CL_OUT_OF_RESOURCES             : return CG_OUT_OF_MEMORY;
+        case CL_OUT_OF_HOST_MEMORY           : return CG_OUT_OF_MEMORY;
+        default                              : return CG_ERROR;
         }
     }
-    else
-    {   // this is a non-array 1D, 2D or 3D image.
-        if (slice_count > 1)
+    if ((pool = (CG_STAGING_POOL*) cgAllocateHostMemory(&ctx->HostAllocator, sizeof(CG_STAGING_POOL), 0, CG_ALLOCATION_TYPE_INTERNAL)) == NULL)
+    {
+        clEnqueueUnmapMemObject(map_queue, arena, mapped, 0, NULL, NULL);
+        clFinish(map_queue);
+        clReleaseMemObject(arena);
+        return CG_OUT_OF_MEMORY;
+    }
+    memset(pool, 0, sizeof(CG_STAGING_POOL));
+    clRetainCommandQueue(map_queue);
+    InitializeSRWLock(&pool->Lock);
+    pool->Heap           = heap;
+    pool->Next           = heap->StagingPool;
+    pool->ComputeContext = cl_ctx;
+    pool->MapQueue       = map_queue;
+    pool->ArenaBuffer    = arena;
+    pool->HostAddress    =(uint8_t*) mapped;
+    pool->ArenaSize      = arena_size;
+    pool->Alignment      = alignment;
+    heap->StagingPool    = pool;
+    cgHeapAddPinnable(heap, arena_size);
+    return CG_SUCCESS;
+}
+
+/// @summary Unmap and free a staging arena that has been detached from its heap. Any outstanding transfers are allowed to complete.
+/// @param ctx The CGFX context that owns the heap.
+/// @param pool The staging pool to delete. No staging buffer may reference the pool.
+internal_function void
+cgFreeStagingPool
+(
+    CG_CONTEXT      *ctx,
+    CG_STAGING_POOL *pool
+)
+{
+    CG_HEAP *heap = pool->Heap;
+    for (size_t i = 0; i < pool->SliceCount; ++i)
+    {
+        CG_STAGING_SLICE *slice = &pool->Slices[(pool->SliceHead + i) % CG_MAX_STAGING_SLICES];
+        if (slice->RetireEvent != NULL)
+        {   // wait for the device to finish with the slice.
+            clWaitForEvents(1, &slice->RetireEvent);
+            clReleaseEvent(slice->RetireEvent);
+        }
+    }
+    clEnqueueUnmapMemObject(pool->MapQueue, pool->ArenaBuffer, pool->HostAddress, 0, NULL, NULL);
+    clFinish(pool->MapQueue);
+    clReleaseMemObject(pool->ArenaBuffer);
+    clReleaseCommandQueue(pool->MapQueue);
+    // the last staging buffer may be released on any thread.
+    cgHeapRemovePinnable(heap, pool->ArenaSize);
+    cgFreeHostMemory(&ctx->HostAllocator, pool, sizeof(CG_STAGING_POOL), 0, CG_ALLOCATION_TYPE_INTERNAL);
+}
+
+/// @summary Return the slice held by a staging buffer to its pool. The slice is recycled once its retirement event is signaled.
+/// If the owning execution group has been deleted and this was the last staging buffer, the pool is freed. Safe to call from any thread.
+/// @param ctx The CGFX context that owns the heap.
+/// @param pool The staging pool the buffer was allocated from.
+/// @param index The index of the slice descriptor held by the buffer.
+internal_function void
+cgStagingPoolRelease
+(
+    CG_CONTEXT      *ctx,
+    CG_STAGING_POOL *pool,
+    size_t           index
+)
+{
+    bool free_pool = false;
+    AcquireSRWLockExclusive(&pool->Lock);
+    pool->Slices[index].State = CG_STAGING_SLICE::RELEASED;
+    pool->LiveBuffers--;
+    free_pool = pool->Detached && pool->LiveBuffers == 0;
+    ReleaseSRWLockExclusive(&pool->Lock);
+    if (free_pool)
+    {   // the execution group is gone, and nothing else references the pool.
+        cgFreeStagingPool(ctx, pool);
+    }
+}
+
+/// @summary Detach the staging pool owned by an execution group from a heap. The pool is freed immediately if no staging 
+/// buffer references it; otherwise it is freed when the last staging buffer is deleted.
+/// @param ctx The CGFX context that owns the heap.
+/// @param heap The heap whose staging pools are searched.
+/// @param cl_ctx The OpenCL context of the execution group being deleted.
+internal_function void
+cgDetachStagingPool
+(
+    CG_CONTEXT *ctx,
+    CG_HEAP    *heap,
+    cl_context  cl_ctx
+)
+{
+    CG_STAGING_POOL **link = &heap->StagingPool;
+    CG_STAGING_POOL  *pool = NULL;
+    bool         free_pool = false;
+    while (*link != NULL && (*link)->ComputeContext != cl_ctx)
+    {
+        link = &(*link)->Next;
+    }
+    if ((pool = *link) == NULL)
+        return;
+   *link = pool->Next;
+    AcquireSRWLockExclusive(&pool->Lock);
+    pool->Next     = NULL;
+    pool->Detached = true;
+    free_pool      = pool->LiveBuffers == 0;
+    ReleaseSRWLockExclusive(&pool->Lock);
+    if (free_pool)
+    {   // no staging buffers reference the pool.
+        cgFreeStagingPool(ctx, pool);
+    }
+}
+
+/// @summary Allocate memory for an execution group and initialize the device and display lists.
+/// @param ctx The CGFX context that owns the execution group.
+/// @param group The execution group to initialize.
+/// @param root_device The handle of the device that defines the share group.
+/// @param device_list The list of handles of the devices in the execution group.
+/// @param device_count The number of devices in the execution group.
+/// @return CG_SUCCESS or CG_OUT_OF_MEMORY.
+internal_function int
+cgAllocExecutionGroup
+(
+    CG_CONTEXT    *ctx,
+    CG_EXEC_GROUP *group,
+    cg_handle_t    root_device,
+    cg_handle_t   *device_list,
+    size_t         device_count
+)
+{
+    CG_DEVICE        *root             = cgObjectTableGet(&ctx->DeviceTable, root_device);
+    CG_DEVICE       **device_refs      = NULL;
+    cl_device_id     *device_ids       = NULL;
+    CG_QUEUE        **compute_queues   = NULL;
+    CG_QUEUE        **transfer_queues  = NULL;
+    CG_DISPLAY      **display_refs     = NULL;
+    CG_QUEUE        **graphics_queues  = NULL;
+    CG_QUEUE        **queue_refs       = NULL;
+    size_t            display_count    = 0;
+    size_t            queue_count      = 0;
+
+    // zero out the execution groupn definition.
+    memset(group, 0, sizeof(CG_EXEC_GROUP));
+
+    // determine the number of attached displays and queues.
+    for (size_t i = 0; i < device_count; ++i)
+    {
+        CG_DEVICE *device = cgObjectTableGet(&ctx->DeviceTable, device_list[i]);
+        display_count    += device->DisplayCount;
+    }
+    queue_count += device_count;  // account for compute queues
+    queue_count += device_count;  // account for transfer queues
+    queue_count += display_count; // account for graphics queues
+
+    // allocate storage. there's always at least one device, but possibly no attached displays.
+    if (device_count > 0)
+    {   // allocate all of the device list storage.
+        device_refs      = (CG_DEVICE   **) cgAllocateHostMemory(&ctx->HostAllocator, device_count  * sizeof(CG_DEVICE*)  , 0, CG_ALLOCATION_TYPE_OBJECT);
+        device_ids       = (cl_device_id *) cgAllocateHostMemory(&ctx->HostAllocator, device_count  * sizeof(cl_device_id), 0, CG_ALLOCATION_TYPE_OBJECT);
+        compute_queues   = (CG_QUEUE    **) cgAllocateHostMemory(&ctx->HostAllocator, device_count  * sizeof(CG_QUEUE*)   , 0, CG_ALLOCATION_TYPE_OBJECT);
+        transfer_queues  = (CG_QUEUE    **) cgAllocateHostMemory(&ctx->HostAllocator, device_count  * sizeof(CG_QUEUE*)   , 0, CG_ALLOCATION_TYPE_OBJECT);
+        if (device_refs == NULL || device_ids == NULL || transfer_queues == NULL)
+            goto error_cleanup;
+        // populate the device reference list and initialize everything else to NULL.
+        for (size_t device_index = 0; device_index < device_count; ++device_index)
         {
-            gl_target                 = GL_TEXTURE_3D;
-            cl_desc.image_type        = CL_MEM_OBJECT_IMAGE3D;
-            cl_desc.image_width       = pixel_width;
-            cl_desc.image_height      = pixel_height;
-            cl_desc.image_depth       = slice_count;
-            cl_desc.image_array_size  = 0;
-            cl_desc.image_row_pitch   = row_pitch;
-            cl_desc.image_slice_pitch = slice_pitch;
-            cl_desc.num_mip_levels    = 0;
-            cl_desc.num_samples       = 0;
+            device_refs[device_index] = cgObjectTableGet(&ctx->DeviceTable, device_list[device_index]);
+            device_ids [device_index] = device_refs[device_index]->DeviceId;
         }
-        else if (pixel_height > 1)
+        memset(compute_queues  , 0, device_count * sizeof(CG_QUEUE*));
+        memset(transfer_queues , 0, device_count * sizeof(CG_QUEUE*));
+    }
+    if (display_count > 0)
+    {   // allocate all of the display list storage.
+        display_refs     = (CG_DISPLAY**) cgAllocateHostMemory(&ctx->HostAllocator, display_count * sizeof(CG_DISPLAY*), 0, CG_ALLOCATION_TYPE_OBJECT);
+        graphics_queues  = (CG_QUEUE  **) cgAllocateHostMemory(&ctx->HostAllocator, display_count * sizeof(CG_QUEUE*)  , 0, CG_ALLOCATION_TYPE_OBJECT);
+        if (display_refs == NULL || graphics_queues == NULL)
+            goto error_cleanup;
+        // populate the display list with data.
+        for (size_t device_index = 0; device_index < device_count; ++device_index)
         {
-            gl_target                 = GL_TEXTURE_2D;
-            cl_desc.image_type        = CL_MEM_OBJECT_IMAGE2D;
-            cl_desc.image_width       = pixel_width;
-            cl_desc.image_height      = pixel_height;
-            cl_desc.image_depth       = 0;
-            cl_desc.image_array_size  = 0;
-            cl_desc.image_row_pitch   = row_pitch;
-            cl_desc.image_slice_pitch = slice_pitch;
-            cl_desc.num_mip_levels    = 0;
-            cl_desc.num_samples       = 0;
+            CG_DEVICE  *device = cgObjectTableGet(&ctx->DeviceTable, device_list[device_index]);
+            for (size_t display_index = 0, num_displays = device->DisplayCount; display_index < num_displays; ++display_index)
+            {
+                display_refs[group->DisplayCount] = device->AttachedDisplays[display_index];
+                group->DisplayCount++;
+            }
         }
-        else
+        memset(graphics_queues, 0, display_count * sizeof(CG_QUEUE*));
+    }
+    if (queue_count > 0)
+    {   // allocate all of the queue list storage.
+        queue_refs  = (CG_QUEUE**) cgAllocateHostMemory(&ctx->HostAllocator, queue_count * sizeof(CG_QUEUE*), 0, CG_ALLOCATION_TYPE_OBJECT);
+        if (queue_refs == NULL)
+            goto error_cleanup;
+        // NULL out all of the queue references.
+        memset(queue_refs, 0, queue_count * sizeof(CG_QUEUE*));
+    }
+
+    // initialization was successful, save all of the references.
+    group->PlatformId       = root->PlatformId;
+    group->ComputeContext   = NULL;
+    group->RenderingContext = NULL;
+    group->AttachedDisplay  = NULL;
+    group->DeviceCount      = device_count;
+    group->DeviceList       = device_refs;
+    group->DeviceIds        = device_ids;
+    group->ComputeQueues    = compute_queues;
+    group->TransferQueues   = transfer_queues;
+    group->DisplayCount     = display_count;
+    group->AttachedDisplays = display_refs;
+    group->GraphicsQueues   = graphics_queues;
+    group->QueueCount       = queue_count;
+    group->QueueList        = queue_refs;
+    return CG_SUCCESS;
+
+error_cleanup:
+    cgFreeHostMemory(&ctx->HostAllocator, queue_refs      , queue_count   * sizeof(CG_QUEUE*)   , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, graphics_queues , display_count * sizeof(CG_QUEUE*)   , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, display_refs    , display_count * sizeof(CG_DISPLAY*) , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, transfer_queues , device_count  * sizeof(CG_QUEUE*)   , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, compute_queues  , device_count  * sizeof(CG_QUEUE*)   , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, device_ids      , device_count  * sizeof(cl_device_id), 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, device_refs     , device_count  * sizeof(CG_DEVICE*)  , 0, CG_ALLOCATION_TYPE_OBJECT);
+    return CG_OUT_OF_MEMORY;
+}
+
+/// @summary Frees all resources and releases all references held by an execution group object.
+/// @param ctx The CGFX context that owns the execution group object.
+/// @param group The execution group object to delete.
+internal_function void
+cgDeleteExecutionGroup
+(
+    CG_CONTEXT    *ctx,
+    CG_EXEC_GROUP *group
+)
+{
+    CG_HOST_ALLOCATOR *host_alloc = &ctx->HostAllocator;
+    // release device references back to the execution group.
+    for (size_t i = 0, n = group->DeviceCount; i < n; ++i)
+    {
+        group->DeviceList[i]->ExecutionGroup = CG_INVALID_HANDLE;
+    }
+    if (group->ComputeContext != NULL)
+    {   // detach any staging pools allocated within the group's compute context. 
+        // pools still referenced by staging buffers are freed with the last buffer.
+        for (size_t i = 0, n = ctx->HeapCount; i < n; ++i)
         {
-            gl_target                 = GL_TEXTURE_1D;
-            cl_desc.image_type        = CL_MEM_OBJECT_IMAGE1D;
-            cl_desc.image_width       = pixel_width;
-            cl_desc.image_height      = 0;
-            cl_desc.image_depth       = 0;
-            cl_desc.image_array_size  = 0;
-            cl_desc.image_row_pitch   = row_pitch;
-            cl_desc.image_slice_pitch = slice_pitch;
-            cl_desc.num_mip_levels    = 0;
-            cl_desc.num_samples       = 0;
+            cgDetachStagingPool(ctx, &ctx->HeapList[i], group->ComputeContext);
         }
+        clReleaseContext(group->ComputeContext);
     }
+    cgFreeHostMemory(host_alloc, group->QueueList       , group->QueueCount   * sizeof(CG_QUEUE*)   , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(host_alloc, group->GraphicsQueues  , group->DisplayCount * sizeof(CG_QUEUE*)   , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(host_alloc, group->AttachedDisplays, group->DisplayCount * sizeof(CG_DISPLAY*) , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(host_alloc, group->TransferQueues  , group->DeviceCount  * sizeof(CG_QUEUE*)   , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(host_alloc, group->ComputeQueues   , group->DisplayCount * sizeof(CG_QUEUE*)   , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(host_alloc, group->DeviceIds       , group->DeviceCount  * sizeof(cl_device_id), 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(host_alloc, group->DeviceList      , group->DeviceCount  * sizeof(CG_DEVICE*)  , 0, CG_ALLOCATION_TYPE_OBJECT);
+    memset(group, 0, sizeof(CG_EXEC_GROUP));
+}
 
-    // populate the cl_image_format object.
-    // the following mappings are taken from pp.54-55 of:
-    // https://www.khronos.org/registry/cl/specs/opencl-1.2-extensions.pdf
-    switch (dxgi_format)
-    {
-        case DXGI_FORMAT_UNKNOWN:
-        case DXGI_FORMAT_R32G32B32A32_TYPELESS:
-        case DXGI_FORMAT_R32G32B32_TYPELESS:
+/// @summary Frees all resources associated with a compute pipeline object.
+/// @param ctx The CGFX context that owns the compute pipeline object.
+/// @param pipeline The compute pipeline object to delete.
+internal_function void
+cgDeleteComputePipeline
+(
+    CG_CONTEXT          *ctx,
+    CG_COMPUTE_PIPELINE *pipeline
+)
+{
+    if (pipeline->ComputeKernel != NULL)
+    {
+        clReleaseKernel(pipeline->ComputeKernel);
+    }
+    for (size_t i = 0, n = pipeline->TuningCount; i < n; ++i)
+    {
+        if (pipeline->Tuning[i].PendingEvent != NULL)
+            clReleaseEvent(pipeline->Tuning[i].PendingEvent);
+    }
+    cgFreeHostMemory(&ctx->HostAllocator, pipeline->Tuning          , pipeline->TuningCapacity * sizeof(CG_CL_WORKGROUP_TUNING), 0, CG_ALLOCATION_TYPE_OBJECT);
+    if (pipeline->Throughput != NULL)
+    {
+        for (size_t i = 0, n = pipeline->DeviceCount; i < n; ++i)
+        {
+            if (pipeline->Throughput[i].PendingEvent != NULL)
+                clReleaseEvent(pipeline->Throughput[i].PendingEvent);
+        }
+        cgFreeHostMemory(&ctx->HostAllocator, pipeline->Throughput, pipeline->DeviceCount * sizeof(CG_CL_DEVICE_THROUGHPUT), 0, CG_ALLOCATION_TYPE_OBJECT);
+    }
+    cgFreeHostMemory(&ctx->HostAllocator, pipeline->Arguments       , pipeline->ArgumentCount * sizeof(CG_CL_KERNEL_ARG)    , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, pipeline->ArgumentNames   , pipeline->ArgumentCount * sizeof(uint32_t)            , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, pipeline->DeviceKernelInfo, pipeline->DeviceCount   * sizeof(CG_CL_WORKGROUP_INFO), 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, pipeline->KernelName      , pipeline->KernelNameSize                              , 0, CG_ALLOCATION_TYPE_OBJECT);
+    memset(pipeline, 0, sizeof(CG_COMPUTE_PIPELINE));
+}
+
+/// @summary Frees all resources associated with a graphics pipeline object.
+/// @param ctx The CGFX context that owns the graphics pipeline object.
+/// @param pipeline The graphics pipeline object to delete.
+internal_function void
+cgDeleteGraphicsPipeline
+(
+    CG_CONTEXT           *ctx,
+    CG_GRAPHICS_PIPELINE *pipeline
+)
+{
+    CG_DISPLAY   *display = pipeline->AttachedDisplay;
+    CG_GLSL_PROGRAM &glsl = pipeline->ShaderProgram;
+    if (glsl.Program != 0)
+    {
+        glDeleteProgram(glsl.Program);
+        cgGlStateObjectDeleted(display, GL_PROGRAM, glsl.Program);
+    }
+    cgFreeHostMemory(&ctx->HostAllocator, glsl.Samplers      , glsl.SamplerCount   * sizeof(CG_GLSL_SAMPLER)  , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, glsl.SamplerNames  , glsl.SamplerCount   * sizeof(uint32_t)         , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, glsl.Attributes    , glsl.AttributeCount * sizeof(CG_GLSL_ATTRIBUTE), 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, glsl.AttributeNames, glsl.AttributeCount * sizeof(uint32_t)         , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, glsl.Uniforms      , glsl.UniformCount   * sizeof(CG_GLSL_UNIFORM)  , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, glsl.UniformNames  , glsl.UniformCount   * sizeof(uint32_t)         , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, glsl.UniformBlocks    , glsl.UniformBlockCount * sizeof(CG_GLSL_UNIFORM_BLOCK), 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, glsl.UniformBlockNames, glsl.UniformBlockCount * sizeof(uint32_t)             , 0, CG_ALLOCATION_TYPE_OBJECT);
+    memset(pipeline, 0, sizeof(CG_GRAPHICS_PIPELINE));
+}
+
+/// @summary Frees all resources associated with a pipeline object.
+/// @param ctx The CGFX context that owns the pipeline object.
+/// @param pipeline The pipeline object to delete.
+internal_function void
+cgDeletePipeline
+(
+    CG_CONTEXT  *ctx, 
+    CG_PIPELINE *pipeline
+)
+{   // clean up the internal pipeline state first:
+    pipeline->DestroyState((uintptr_t) ctx, (uintptr_t) pipeline, pipeline->PrivateState);
+    // then clean up the state common to all implementations:
+    switch (pipeline->PipelineType)
+    {
+    case CG_PIPELINE_TYPE_COMPUTE:
+        cgDeleteComputePipeline(ctx, &pipeline->Compute);
+        break;
+    case CG_PIPELINE_TYPE_GRAPHICS:
+        cgDeleteGraphicsPipeline(ctx, &pipeline->Graphics);
+        break;
+    default:
+        break;
+    }
+}
+
+/// @summary Frees all resources associated with a buffer memory object.
+/// @param ctx The CGFX context that owns the buffer object.
+/// @param buffer The buffer object to delete.
+internal_function void
+cgDeleteBuffer
+(
+    CG_CONTEXT *ctx, 
+    CG_BUFFER  *buffer
+)
+{
+    if (buffer->StagingPool != NULL)
+    {   // return the slice to the pool. it's recycled once its retirement event is signaled.
+        cgStagingPoolRelease(ctx, buffer->StagingPool, buffer->StagingSlice);
+    }
+    else if (buffer->GraphicsBuffer == 0 && (buffer->ComputeUsage & CL_MEM_ALLOC_HOST_PTR) && (buffer->SourceHeap->Flags & CG_HEAP_HOLDS_PINNED))
+    {   // the buffer was allocated from pinnable memory.
+        cgHeapRemovePinnable(buffer->SourceHeap, buffer->AllocatedSize);
+    }
+    else if (buffer->Evicted)
+    {   // the buffer contents live in host-backed memory; the heap was already updated.
+        if (ctx->ResidencyStats.NonResidentBytes >= buffer->AllocatedSize)
+            ctx->ResidencyStats.NonResidentBytes -= buffer->AllocatedSize;
+        else
+            ctx->ResidencyStats.NonResidentBytes  = 0;
+    }
+    else
+    {   // the buffer was allocated from device-resident heap memory.
+        if (buffer->SourceHeap->HeapSizeUsed >= buffer->AllocatedSize)
+            buffer->SourceHeap->HeapSizeUsed -= buffer->AllocatedSize;
+        else
+            buffer->SourceHeap->HeapSizeUsed  = 0;
+    }
+    if (buffer->ComputeBuffer != NULL)
+    {
+        clReleaseMemObject(buffer->ComputeBuffer);
+    }
+    if (buffer->GraphicsBuffer != 0)
+    {
+        CG_DISPLAY *display = buffer->AttachedDisplay;
+        glDeleteBuffers(1, &buffer->GraphicsBuffer);
+        cgGlStateObjectDeleted(display, GL_BUFFER, buffer->GraphicsBuffer);
+    }
+    memset(buffer, 0, sizeof(CG_BUFFER));
+}
+
+/// @summary Frees all resources associated with a fence object.
+/// @param ctx The CGFX context that owns the fence object.
+/// @param fence The fence object to delete.
+internal_function void
+cgDeleteFence
+(
+    CG_CONTEXT *ctx, 
+    CG_FENCE   *fence
+)
+{   UNREFERENCED_PARAMETER(ctx);
+    switch (fence->QueueType)
+    {
+    case CG_QUEUE_TYPE_COMPUTE:
+    case CG_QUEUE_TYPE_TRANSFER:
+    case CG_QUEUE_TYPE_COMPUTE_OR_TRANSFER:
+        if (fence->ComputeFence != NULL)
+        {
+            clReleaseEvent(fence->ComputeFence);
+        }
+        break;
+    case CG_QUEUE_TYPE_GRAPHICS:
+        if (fence->GraphicsFence != NULL)
+        {
+            CG_DISPLAY *display = fence->AttachedDisplay;
+            glDeleteSync(fence->GraphicsFence);
+        }
+        break;
+    default:
+        break;
+    }
+    memset(fence, 0, sizeof(CG_FENCE));
+}
+
+/// @summary Frees all resources associated with an event object.
+/// @param ctx The CGFX context that owns the event object.
+/// @param event The event object to delete.
+internal_function void
+cgDeleteEvent
+(
+    CG_CONTEXT *ctx, 
+    CG_EVENT   *event
+)
+{   UNREFERENCED_PARAMETER(ctx);
+    if (event->ComputeEvent != NULL)
+    {
+        clReleaseEvent(event->ComputeEvent);
+    }
+    memset(event, 0, sizeof(CG_EVENT));
+}
+
+/// @summary Frees all resources associated with an image object.
+/// @param ctx The CGFX context that owns the image object.
+/// @param image The image object to delete.
+internal_function void
+cgDeleteImage
+(
+    CG_CONTEXT *ctx, 
+    CG_IMAGE   *image
+)
+{
+    if (image->GraphicsImage == 0 && (image->ComputeUsage & CL_MEM_ALLOC_HOST_PTR) && (image->SourceHeap->Flags & CG_HEAP_HOLDS_PINNED))
+    {   // the image was allocated from pinnable memory.
+        cgHeapRemovePinnable(image->SourceHeap, image->AllocatedSize);
+    }
+    else if (image->Evicted)
+    {   // the image contents live in host-backed memory; the heap was already updated.
+        if (ctx->ResidencyStats.NonResidentBytes >= image->AllocatedSize)
+            ctx->ResidencyStats.NonResidentBytes -= image->AllocatedSize;
+        else
+            ctx->ResidencyStats.NonResidentBytes  = 0;
+    }
+    else
+    {   // the image was allocated from device-resident heap memory.
+        if (image->SourceHeap->HeapSizeUsed >= image->AllocatedSize)
+            image->SourceHeap->HeapSizeUsed -= image->AllocatedSize;
+        else
+            image->SourceHeap->HeapSizeUsed  = 0;
+    }
+    if (image->ComputeImage != NULL)
+    {
+        clReleaseMemObject(image->ComputeImage);
+    }
+    if (image->GraphicsImage != 0)
+    {
+        CG_DISPLAY *display = image->AttachedDisplay;
+        glDeleteTextures(1, &image->GraphicsImage);
+        cgGlStateObjectDeleted(display, GL_TEXTURE, image->GraphicsImage);
+    }
+    memset(image, 0, sizeof(CG_IMAGE));
+}
+
+/// @summary Frees all resources associated with an image sampler object.
+/// @param ctx The CGFX context that owns the sampler object.
+/// @param sampler The image sampler object to delete.
+internal_function void
+cgDeleteSampler
+(
+    CG_CONTEXT *ctx, 
+    CG_SAMPLER *sampler
+)
+{   UNREFERENCED_PARAMETER(ctx);
+    CG_DISPLAY *display = sampler->AttachedDisplay;
+    if (sampler->GraphicsSampler != 0 && GLEW_ARB_sampler_objects)
+    {
+        glDeleteSamplers(1, &sampler->GraphicsSampler);
+        cgGlStateObjectDeleted(display, GL_SAMPLER, sampler->GraphicsSampler);
+    }
+    if (sampler->ComputeSampler != NULL)
+    {
+        clReleaseSampler(sampler->ComputeSampler);
+    }
+    memset(sampler, 0, sizeof(CG_SAMPLER));
+}
+
+/// @summary Drop a reference to a shared vertex layout, deleting its vertex array object when the last reference is released.
+/// @param ctx The CGFX context that owns the shared layout list.
+/// @param display The display attached to the rendering context that owns the vertex array object.
+/// @param layout The shared vertex layout to release.
+internal_function void
+cgReleaseVertexLayout
+(
+    CG_CONTEXT       *ctx, 
+    CG_DISPLAY       *display, 
+    CG_VERTEX_LAYOUT *layout
+)
+{
+    if (--layout->ReferenceCount > 0)
+        return;
+    for (CG_VERTEX_LAYOUT **iter = &ctx->VertexLayouts; *iter != NULL; iter = &(*iter)->Next)
+    {
+        if (*iter == layout)
+        {   // unlink the layout from the list.
+           *iter = layout->Next;
+            break;
+        }
+    }
+    if (layout->VertexArray != 0)
+    {
+        glDeleteVertexArrays(1, &layout->VertexArray);
+        cgGlStateObjectDeleted(display, GL_VERTEX_ARRAY, layout->VertexArray);
+    }
+    cgFreeHostMemory(&ctx->HostAllocator, layout, sizeof(CG_VERTEX_LAYOUT), 0, CG_ALLOCATION_TYPE_OBJECT);
+}
+
+/// @summary Find or create the shared vertex layout for a vertex format on the rendering context of a display. A new 
+/// layout records the attribute formats, buffer binding assignments and instance divisors in a vertex array object; 
+/// buffers are attached later by cgGlBindVertexDataSource.
+/// @param ctx The CGFX context that owns the shared layout list.
+/// @param display The display attached to the rendering context.
+/// @param layout_hash The hash of the vertex format, computed by cgCreateVertexDataSourceWithOffsets.
+/// @param num_buffers The number of vertex buffer binding points.
+/// @param divisors An array of @a num_buffers instance divisors, one per buffer binding point.
+/// @param num_attribs The number of vertex attributes.
+/// @param indices An array of @a num_attribs buffer binding indices.
+/// @param regs An array of @a num_attribs shader attribute locations.
+/// @param attribs An array of @a num_attribs attribute format descriptors.
+/// @param result On return, set to CG_SUCCESS, CG_OUT_OF_MEMORY or CG_BAD_GLCONTEXT.
+/// @return The shared vertex layout, with a reference held by the caller, or NULL.
+internal_function CG_VERTEX_LAYOUT*
+cgAcquireVertexLayout
+(
+    CG_CONTEXT                *ctx, 
+    CG_DISPLAY                *display, 
+    uint64_t                   layout_hash, 
+    size_t                     num_buffers, 
+    GLuint const              *divisors, 
+    size_t                     num_attribs, 
+    size_t const              *indices, 
+    GLuint const              *regs, 
+    CG_VERTEX_ATTRIBUTE const *attribs, 
+    int                       &result
+)
+{
+    CG_VERTEX_LAYOUT *layout = NULL;
+    GLuint            vao    = 0;
+    for (layout = ctx->VertexLayouts; layout != NULL; layout = layout->Next)
+    {
+        if (layout->LayoutHash == layout_hash && layout->RenderingContext == display->DisplayRC)
+        {   // an identical vertex format already exists on this rendering context.
+            layout->ReferenceCount++;
+            result = CG_SUCCESS;
+            return layout;
+        }
+    }
+    if ((layout = (CG_VERTEX_LAYOUT*) cgAllocateHostMemory(&ctx->HostAllocator, sizeof(CG_VERTEX_LAYOUT), 0, CG_ALLOCATION_TYPE_OBJECT)) == NULL)
+    {   // unable to allocate the required memory.
+        result = CG_OUT_OF_MEMORY;
+        return NULL;
+    }
+    glGenVertexArrays(1, &vao);
+    if (vao == 0)
+    {   // unable to allocate a vertex array object name.
+        cgFreeHostMemory(&ctx->HostAllocator, layout, sizeof(CG_VERTEX_LAYOUT), 0, CG_ALLOCATION_TYPE_OBJECT);
+        result = CG_BAD_GLCONTEXT;
+        return NULL;
+    }
+    cgGlBindVertexArray(display, vao);
+    for (size_t i = 0; i < num_attribs; ++i)
+    {
+        glEnableVertexAttribArray(regs[i]);
+        glVertexAttribFormat (regs[i], attribs[i].Dimension, attribs[i].DataType, attribs[i].Normalized, GLuint(attribs[i].ByteOffset));
+        glVertexAttribBinding(regs[i], GLuint(indices[i]));
+    }
+    for (size_t i = 0; i < num_buffers; ++i)
+    {
+        if (divisors[i] != 0)
+            glVertexBindingDivisor(GLuint(i), divisors[i]);
+    }
+    cgGlBindVertexArray(display, 0);
+    layout->Next             = ctx->VertexLayouts;
+    layout->LayoutHash       = layout_hash;
+    layout->RenderingContext = display->DisplayRC;
+    layout->VertexArray      = vao;
+    layout->ReferenceCount   = 1;
+    layout->BoundSource      = 0;
+    ctx->VertexLayouts       = layout;
+    result = CG_SUCCESS;
+    return layout;
+}
+
+/// @summary Frees all resources associated with an input assembler configuration object.
+/// @param ctx The CGFX context that owns the vertex data source object.
+/// @param source The input assembler configuration object to delete.
+internal_function void
+cgDeleteVertexDataSource
+(
+    CG_CONTEXT            *ctx, 
+    CG_VERTEX_DATA_SOURCE *source
+)
+{
+    CG_DISPLAY *display = source->AttachedDisplay;
+    if (source->SharedLayout != NULL)
+    {   // the vertex array object is owned by the shared layout.
+        if (source->SharedLayout->BoundSource == source->ObjectId)
+            source->SharedLayout->BoundSource  = 0;
+        cgReleaseVertexLayout(ctx, display, source->SharedLayout);
+    }
+    else if (source->VertexArray != 0)
+    {
+        glDeleteVertexArrays(1, &source->VertexArray);
+        cgGlStateObjectDeleted(display, GL_VERTEX_ARRAY, source->VertexArray);
+    }
+    cgFreeHostMemory(&ctx->HostAllocator, source->AttributeData  , source->AttributeCount * sizeof(CG_VERTEX_ATTRIBUTE), 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, source->ShaderLocations, source->AttributeCount * sizeof(GLuint)             , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, source->BufferIndices  , source->AttributeCount * sizeof(size_t)             , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, source->BufferStrides  , source->BufferCount    * sizeof(size_t)             , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, source->BufferOffsets  , source->BufferCount    * sizeof(size_t)             , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, source->BufferNames    , source->BufferCount    * sizeof(GLuint)             , 0, CG_ALLOCATION_TYPE_OBJECT);
+    memset(source, 0, sizeof(CG_VERTEX_DATA_SOURCE));
+}
+
+/// @summary Allocates memory for and initializes an empty CGFX context object.
+/// @param app_info Information about the application associated with the context.
+/// @param alloc_cb User-supplied host memory allocator callbacks, or NULL.
+/// @param result Set to CG_SUCCESS if the context was created; otherwise, set to the error code.
+/// @return A pointer to the new CGFX context, or NULL.
+internal_function CG_CONTEXT*
+cgCreateContext
+(
+    cg_application_info_t const  *app_info,
+    cg_allocation_callbacks_t    *alloc_cb,
+    int                          &result
+)
+{   UNREFERENCED_PARAMETER(app_info);
+    CG_CONTEXT       *ctx = NULL;
+    CG_HOST_ALLOCATOR host_alloc = CG_HOST_ALLOCATOR_STATIC_INIT;
+    if ((result = cgSetupUserHostAllocator(alloc_cb, &host_alloc)) != CG_SUCCESS)
+    {   // cannot set up user allocator - can't allocate any memory.
+        return NULL;
+    }
+    if ((ctx = (CG_CONTEXT*) cgAllocateHostMemory(&host_alloc, sizeof(CG_CONTEXT), 0, CG_ALLOCATION_TYPE_OBJECT)) == NULL)
+    {   // unable to allocate the core context storage.
+        result = CG_OUT_OF_MEMORY;
+        return NULL;
+    }
+    memset(ctx, 0, sizeof(CG_CONTEXT));
+
+    // initialize the various object tables on the context to empty.
+    cgObjectTableInit(&ctx->DeviceTable      , CG_OBJECT_DEVICE            , CG_DEVICE_TABLE_ID);
+    cgObjectTableInit(&ctx->DisplayTable     , CG_OBJECT_DISPLAY           , CG_DISPLAY_TABLE_ID);
+    cgObjectTableInit(&ctx->QueueTable       , CG_OBJECT_QUEUE             , CG_QUEUE_TABLE_ID);
+    cgObjectTableInit(&ctx->CmdBufferTable   , CG_OBJECT_COMMAND_BUFFER    , CG_CMD_BUFFER_TABLE_ID);
+    cgObjectTableInit(&ctx->ExecGroupTable   , CG_OBJECT_EXECUTION_GROUP   , CG_EXEC_GROUP_TABLE_ID);
+    cgObjectTableInit(&ctx->KernelTable      , CG_OBJECT_KERNEL            , CG_KERNEL_TABLE_ID);
+    cgObjectTableInit(&ctx->PipelineTable    , CG_OBJECT_PIPELINE          , CG_PIPELINE_TABLE_ID);
+    cgObjectTableInit(&ctx->BufferTable      , CG_OBJECT_BUFFER            , CG_BUFFER_TABLE_ID);
+    cgObjectTableInit(&ctx->FenceTable       , CG_OBJECT_FENCE             , CG_FENCE_TABLE_ID);
+    cgObjectTableInit(&ctx->EventTable       , CG_OBJECT_EVENT             , CG_EVENT_TABLE_ID);
+    cgObjectTableInit(&ctx->ImageTable       , CG_OBJECT_IMAGE             , CG_IMAGE_TABLE_ID);
+    cgObjectTableInit(&ctx->SamplerTable     , CG_OBJECT_SAMPLER           , CG_SAMPLER_TABLE_ID);
+    cgObjectTableInit(&ctx->VertexSourceTable, CG_OBJECT_VERTEX_DATA_SOURCE, CG_VERTEX_DATA_SOURCE_TABLE_ID);
+    InitializeSRWLock(&ctx->ResidencyLock);
+    InitializeSRWLock(&ctx->RestoreLock);
+
+    // the context has been fully initialized.
+    // TEMP and KERNEL allocations are served from per-thread scratch arenas.
+    result             = CG_SUCCESS;
+    ctx->HostAllocator = host_alloc;
+    ctx->HostAllocator.ScratchArenas = ctx->ScratchArenas;
+    ctx->HostAllocator.Counters      = ctx->AllocationStats;
+    ctx->HostAllocator.ScratchFlsIndex = FlsAlloc(cgScratchArenaThreadExit);
+    return ctx;
+}
+
+#if CG_LEAK_REPORT
+/// @summary Write a line to the debugger output for each object type with live objects.
+/// @param ctx The CGFX context being destroyed.
+internal_function void
+cgReportLeakedObjects
+(
+    CG_CONTEXT *ctx
+)
+{
+    struct leak_t { char const *Name; size_t Count; };
+    leak_t list[] = 
+    {
+        { "execution group"   , ctx->ExecGroupTable.ObjectCount    }, 
+        { "command buffer"    , ctx->CmdBufferTable.ObjectCount    }, 
+        { "kernel"            , ctx->KernelTable.ObjectCount       }, 
+        { "pipeline"          , ctx->PipelineTable.ObjectCount     }, 
+        { "buffer"            , ctx->BufferTable.ObjectCount       }, 
+        { "fence"             , ctx->FenceTable.ObjectCount        }, 
+        { "event"             , ctx->EventTable.ObjectCount        }, 
+        { "image"             , ctx->ImageTable.ObjectCount        }, 
+        { "sampler"           , ctx->SamplerTable.ObjectCount      }, 
+        { "vertex data source", ctx->VertexSourceTable.ObjectCount }
+    };
+    char buf[256];
+    for (size_t i = 0, n = sizeof(list) / sizeof(list[0]); i < n; ++i)
+    {
+        if (list[i].Count > 0)
+        {
+            _snprintf_s(buf, sizeof(buf), _TRUNCATE, "CGFX: context destroyed with %Iu live %s object(s).\n", list[i].Count, list[i].Name);
+            OutputDebugStringA(buf);
+        }
+    }
+}
+
+/// @summary Write a line to the debugger output for each allocation type with outstanding host memory.
+/// @param ctx The CGFX context being destroyed. All objects must have been deleted.
+internal_function void
+cgReportLeakedAllocations
+(
+    CG_CONTEXT *ctx
+)
+{
+    char const *names[CG_MAX_ALLOCATION_TYPES] = 
+    {
+        "unknown", "OBJECT", "INTERNAL", "TEMP", "KERNEL", "DEBUG"
+    };
+    char buf[256];
+    for (size_t i = 0; i < CG_MAX_ALLOCATION_TYPES; ++i)
+    {
+        CG_ALLOCATION_COUNTERS *c = &ctx->AllocationStats[i];
+        if (c->LiveCount != 0 || c->LiveBytes != 0)
+        {
+            _snprintf_s(buf, sizeof(buf), _TRUNCATE, "CGFX: %s allocations leaked: %I64d block(s), %I64d byte(s).\n", names[i], c->LiveCount, c->LiveBytes);
+            OutputDebugStringA(buf);
+        }
+    }
+}
+#endif /* CG_LEAK_REPORT */
+
+/// @summary Frees all resources associated with a CGFX context object.
+/// @param ctx The CGFX context to delete.
+internal_function void
+cgDeleteContext
+(
+    CG_CONTEXT *ctx
+)
+{
+    CG_HOST_ALLOCATOR *host_alloc = &ctx->HostAllocator;
+#if CG_LEAK_REPORT
+    // report objects the application never deleted.
+    cgReportLeakedObjects(ctx);
+#endif
+    // free all vertex layout objects:
+    for (size_t i = 0, n = ctx->VertexSourceTable.ObjectCount; i < n; ++i)
+    {
+        CG_VERTEX_DATA_SOURCE *obj = &ctx->VertexSourceTable.Objects[i];
+        cgDeleteVertexDataSource(ctx, obj);
+    }
+    // free all sampler objects:
+    for (size_t i = 0, n = ctx->SamplerTable.ObjectCount; i < n; ++i)
+    {
+        CG_SAMPLER *obj = &ctx->SamplerTable.Objects[i];
+        cgDeleteSampler(ctx, obj);
+    }
+    // free all image objects:
+    for (size_t i = 0, n = ctx->ImageTable.ObjectCount; i < n; ++i)
+    {
+        CG_IMAGE *obj = &ctx->ImageTable.Objects[i];
+        cgDeleteImage(ctx, obj);
+    }
+    // free all event objects:
+    for (size_t i = 0, n = ctx->EventTable.ObjectCount; i < n; ++i)
+    {
+        CG_EVENT *obj = &ctx->EventTable.Objects[i];
+        cgDeleteEvent(ctx, obj);
+    }
+    // free all fence objects:
+    for (size_t i = 0, n = ctx->FenceTable.ObjectCount; i < n; ++i)
+    {
+        CG_FENCE *obj = &ctx->FenceTable.Objects[i];
+        cgDeleteFence(ctx, obj);
+    }
+    // free all buffer objects:
+    for (size_t i = 0, n = ctx->BufferTable.ObjectCount; i < n; ++i)
+    {
+        CG_BUFFER *obj = &ctx->BufferTable.Objects[i];
+        cgDeleteBuffer(ctx, obj);
+    }
+    // free all pipeline objects:
+    for (size_t i = 0, n = ctx->PipelineTable.ObjectCount; i < n; ++i)
+    {
+        CG_PIPELINE *obj = &ctx->PipelineTable.Objects[i];
+        cgDeletePipeline(ctx, obj);
+    }
+    // free all kernel objects:
+    for (size_t i = 0, n = ctx->KernelTable.ObjectCount; i < n; ++i)
+    {
+        CG_KERNEL *obj = &ctx->KernelTable.Objects[i];
+        cgDeleteKernel(ctx, obj);
+    }
+    // free all command buffer objects:
+    for (size_t i = 0, n = ctx->CmdBufferTable.ObjectCount; i < n; ++i)
+    {
+        CG_CMD_BUFFER *obj = &ctx->CmdBufferTable.Objects[i];
+        cgDeleteCmdBuffer(ctx, obj);
+    }
+    // free all command queue objects:
+    for (size_t i = 0, n = ctx->QueueTable.ObjectCount; i < n; ++i)
+    {
+        CG_QUEUE *obj = &ctx->QueueTable.Objects[i];
+        cgDeleteQueue(ctx, obj);
+    }
+    // free all execution group objects:
+    for (size_t i = 0, n = ctx->ExecGroupTable.ObjectCount; i < n; ++i)
+    {
+        CG_EXEC_GROUP *obj = &ctx->ExecGroupTable.Objects[i];
+        cgDeleteExecutionGroup(ctx, obj);
+    }
+    // free all display objects. this must happen before the devices 
+    // are deleted, since the devices own the rendering contexts.
+    for (size_t i = 0, n = ctx->DisplayTable.ObjectCount; i < n; ++i)
+    {
+        CG_DISPLAY *obj = &ctx->DisplayTable.Objects[i];
+        cgDeleteDisplay(ctx, obj);
+    }
+    // free all device objects:
+    for (size_t i = 0, n = ctx->DeviceTable.ObjectCount; i < n; ++i)
+    {
+        CG_DEVICE  *obj = &ctx->DeviceTable.Objects[i];
+        cgDeleteDevice(ctx, obj);
+    }
+    // free scratch arena memory. detach the arenas first so that any 
+    // subsequent TEMP allocations go directly to the host allocator.
+    // freeing the FLS index runs the thread-exit destructor for every 
+    // thread still owning an arena; free whatever the destructor missed.
+    // arena memory is not tracked by the allocation counters.
+    host_alloc->ScratchArenas = NULL;
+    if (host_alloc->ScratchFlsIndex != FLS_OUT_OF_INDEXES)
+    {
+        FlsFree(host_alloc->ScratchFlsIndex);
+        host_alloc->ScratchFlsIndex = FLS_OUT_OF_INDEXES;
+    }
+    for (size_t i = 0; i < CG_MAX_SCRATCH_ARENAS; ++i)
+    {
+        CG_SCRATCH_ARENA *arena = &ctx->ScratchArenas[i];
+        if (arena->BaseAddress != NULL)
+            host_alloc->Release(arena->BaseAddress, CG_SCRATCH_ARENA_SIZE, CG_SCRATCH_ARENA_ALIGNMENT, CG_ALLOCATION_TYPE_INTERNAL, host_alloc->UserData);
+    }
+    // free heap descriptors:
+    cgFreeHostMemory(host_alloc, ctx->HeapList, ctx->HeapCount * sizeof(CG_HEAP), 0, CG_ALLOCATION_TYPE_OBJECT);
+    // free the kernel cache directory path:
+    if (ctx->KernelCache.Directory != NULL)
+        cgFreeHostMemory(host_alloc, ctx->KernelCache.Directory, ctx->KernelCache.DirectorySize, 0, CG_ALLOCATION_TYPE_INTERNAL);
+#if CG_LEAK_REPORT
+    // anything still counted was not released by the matching teardown code.
+    cgReportLeakedAllocations(ctx);
+#endif
+    // the context block itself was allocated before the counters were attached.
+    host_alloc->Counters = NULL;
+    // finally, free the memory block for the context structure:
+    cgFreeHostMemory(host_alloc, ctx, sizeof(CG_CONTEXT), 0, CG_ALLOCATION_TYPE_OBJECT);
+}
+
+/// @summary Determine the number of heaps exposed by the set of devices in the local system.
+/// @param ctx The CGFX context managing the device set.
+/// @return The number of unique heaps in the local system.
+internal_function size_t
+cgClCountUniqueHeaps
+(
+    CG_CONTEXT *ctx
+)
+{
+    size_t cpus_n = 0;
+    size_t heap_n = 0;
+    for (size_t i = 0, n = ctx->DeviceTable.ObjectCount; i < n; ++i)
+    {
+        CG_DEVICE const *dev = &ctx->DeviceTable.Objects[i];
+        if (dev->Type == CL_DEVICE_TYPE_CPU)
+        {   // CPU devices support partitioning. CPUs share a heap.
+            cpus_n++;  // heap_n updated outside of the loop.
+        }
+        else
+        {   // GPU and accelerator devices have two heaps.
+            // the first is the local heap, which is sized to device global memory.
+            // the second is the pinned memory heap, which is sized to the max allocation.
+            heap_n += 2;
+        }
+    }
+    if (cpus_n > 0)
+    {
+        if (cpus_n >= ctx->CpuInfo.NUMANodes)
+        {   // CPUs have one heap per-NUMA node.
+            heap_n += ctx->CpuInfo.NUMANodes;
+        }
+        else
+        {   // one heap per logical CPU device. 
+            // it's possible that one or more nodes are disabled.
+            heap_n += cpus_n;
+        }
+    }
+    return heap_n;
+}
+
+/// @summary Determine whether a device heap is already defined. This is necessary for CPU devices that may be partitioned.
+/// @param partition_type One of cl_device_partition_property, or 0, specifying the parition type of the device.
+/// @param heap The heap attributes to search for.
+/// @param heap_list The heap list to search.
+/// @param heap_count The number of heaps currently defined.
+/// @param heap_index If the function returns true, on return, this value contains the zero-based index of the existing heap in @a heap_list.
+/// @return true if the specified heap exists.
+internal_function bool
+cgClHasHeap
+(
+    intptr_t partition_type,
+    CG_HEAP *heap,
+    CG_HEAP *heap_list, 
+    size_t   heap_count, 
+    size_t  &heap_index
+)
+{
+    if (partition_type == CL_DEVICE_PARTITION_AFFINITY_DOMAIN)
+        return false;
+    for (size_t i = 0; i < heap_count; ++i)
+    {
+        if (heap->ParentDeviceId == heap_list[i].ParentDeviceId && 
+            heap->Type           == heap_list[i].Type           && 
+            heap->HeapSizeTotal  == heap_list[i].HeapSizeTotal  && 
+            heap->NUMANode       == heap_list[i].NUMANode)
+        {
+            heap_index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/// @summary Retrieve information about the available heaps in the system.
+/// @param ctx The CGFX context defining the device list.
+/// @param heaps An array of @a max_heaps items to populate with data.
+/// @param max_heaps The maximum number of heaps to write to @a heaps.
+/// @return The number of heaps written to @a heaps.
+internal_function size_t
+cgClGetHeapInformation
+(
+    CG_CONTEXT *ctx, 
+    CG_HEAP    *heaps, 
+    size_t      max_heaps
+)
+{
+    SYSTEM_INFO  info;
+    size_t heap_count = 0;
+    GetNativeSystemInfo(&info);
+    for (size_t i = 0 , n = ctx->DeviceTable.ObjectCount; i < n && heap_count < max_heaps; ++i)
+    {
+        CG_DEVICE const *dev = &ctx->DeviceTable.Objects[i];
+        cl_device_id     did = NULL;
+
+        clGetDeviceInfo(dev->DeviceId, CL_DEVICE_PARENT_DEVICE, sizeof(cl_device_id), &did, NULL);
+        if (did == NULL)
+        {   // this is a root device; it has no parent.
+            did = dev->DeviceId;
+        }
+
+        size_t props_size = 0;
+        cl_device_partition_property props[16];
+        memset(props, 0, sizeof(props));
+        clGetDeviceInfo(dev->DeviceId, CL_DEVICE_PARTITION_PROPERTIES, sizeof(props), props, &props_size);
+        if (props_size == 0) props[0] = 0; // terminate the list explicitly
+
+        // all devices define a local heap.
+        size_t   index        = heap_count;
+        CG_HEAP &local        = heaps[heap_count];
+        local.Ordinal         = index;
+        local.ParentDeviceId  = did;
+        local.Type            = CG_HEAP_TYPE_LOCAL;
+        local.Flags           = 0;
+        local.DeviceType      = dev->Type;
+        local.HeapSizeTotal   = dev->Capabilities.GlobalMemorySize;
+        local.HeapSizeUsed    = 0;
+        local.PinnableTotal   = 0;
+        local.PinnableUsed    = 0;
+        InitializeSRWLock(&local.PinnableLock);
+        local.DeviceAlignment = dev->Capabilities.AddressAlign;
+        local.UserAlignment   = info.dwPageSize;
+        local.UserSizeAlign   = dev->Capabilities.AddressAlign;
+        local.StagingPool     = NULL;
+        local.ResidencyBudget = 0;
+        local.NUMANode        = dev->NUMANode;
+        if (dev->Type   != CL_DEVICE_TYPE_CPU || dev->Capabilities.UnifiedMemory)
+            local.Flags |= CG_HEAP_GPU_ACCESSIBLE;
+        if (dev->Type   == CL_DEVICE_TYPE_CPU || dev->Capabilities.UnifiedMemory)
+            local.Flags |= CG_HEAP_CPU_ACCESSIBLE;
+        if (dev->Type   != CL_DEVICE_TYPE_CPU)
+        {   // GPU and accelerator devices are typically accessed over PCIe and 
+            // have a portion of address space reserved as pinnable so that data
+            // can be transferred to local device memory via DMA.
+            local.PinnableTotal = dev->Capabilities.MaxMallocSize;
+            local.PinnableUsed  = 0;
+            local.Flags        |= CG_HEAP_HOLDS_PINNED;
+        }
+        if (dev->Capabilities.UnifiedMemory)
+        {   // use the maximum of the system page size and the device alignment.
+            // zero-copy buffers require 4KB alignment and a size multiple of 64KB (Intel and AMD).
+            // https://software.intel.com/en-us/articles/getting-the-most-from-opencl-12-how-to-increase-performance-by-minimizing-buffer-copies-on-intel-processor-graphics
+            local.UserSizeAlign = dev->Capabilities.GlobalCacheLineSize;
+        }
+        if (cgClHasHeap(props[0], &local, heaps, heap_count, index))
+        {   // mark the existing heap as being shared.
+            heaps[index].Flags |= CG_HEAP_SHAREABLE;
+        }
+        else heap_count++;
+    }
+    return heap_count;
+}
+
+/// @summary Locate the heap corresponding to a particular memory object placement hint.
+/// @param ctx The CGFX context maintaining the heap list.
+/// @param placement_hint One of cg_memory_object_placement_e specifying the desired location for the memory object.
+/// @return A pointer to the source heap.
+internal_function CG_HEAP*
+cgFindHeapForPlacement
+(
+    CG_CONTEXT *ctx, 
+    int         placement_hint
+)
+{
+    for (size_t i = 0, n = ctx->HeapCount; i < n; ++i)
+    {
+        CG_HEAP *heap  = &ctx->HeapList[i];
+        if ((placement_hint == CG_MEMORY_PLACEMENT_PINNED) && (heap->Flags & CG_HEAP_HOLDS_PINNED))
+            return heap;
+        if ((placement_hint == CG_MEMORY_PLACEMENT_HOST  ) && (heap->DeviceType == CL_DEVICE_TYPE_CPU))
+            return heap;
+        if ((placement_hint == CG_MEMORY_PLACEMENT_DEVICE) && (heap->DeviceType != CL_DEVICE_TYPE_CPU))
+            return heap;
+    }
+    return &ctx->HeapList[0];
+}
+
+/// @summary Locate the local heap of a particular device.
+/// @param ctx The CGFX context maintaining the heap list.
+/// @param device The device whose heap should be returned. Sub-devices share the heap of their parent device.
+/// @return A pointer to the device heap, or NULL.
+internal_function CG_HEAP*
+cgFindHeapForDevice
+(
+    CG_CONTEXT *ctx, 
+    CG_DEVICE  *device
+)
+{
+    cl_device_id did = NULL;
+    clGetDeviceInfo(device->DeviceId, CL_DEVICE_PARENT_DEVICE, sizeof(cl_device_id), &did, NULL);
+    if (did == NULL)
+    {   // this is a root device; it has no parent.
+        did = device->DeviceId;
+    }
+    for (size_t i = 0, n = ctx->HeapCount; i < n; ++i)
+    {
+        if (ctx->HeapList[i].ParentDeviceId == did && ctx->HeapList[i].Type == CG_HEAP_TYPE_LOCAL && ctx->HeapList[i].NUMANode == device->NUMANode)
+            return &ctx->HeapList[i];
+    }
+    return NULL;
+}
+
+/// @summary Determine whether all of the devices in an execution group are CPU sub-devices restricted to the same NUMA node.
+/// @param group The execution group to inspect.
+/// @return The NUMA node shared by all devices in the group, or CG_NUMA_NODE_ANY.
+internal_function uint32_t
+cgExecutionGroupNumaNode
+(
+    CG_EXEC_GROUP *group
+)
+{
+    if (group->DeviceCount == 0)
+        return CG_NUMA_NODE_ANY;
+    uint32_t node = group->DeviceList[0]->NUMANode;
+    for (size_t i = 0, n = group->DeviceCount; i < n; ++i)
+    {
+        if (group->DeviceList[i]->Type != CL_DEVICE_TYPE_CPU || group->DeviceList[i]->NUMANode != node)
+            return CG_NUMA_NODE_ANY;
+    }
+    return node;
+}
+
+/// @summary Release node-local host memory once the OpenCL runtime has destroyed the memory object that wraps it.
+/// The runtime may still reference the host pointer after clReleaseMemObject returns, so the memory cannot be freed there.
+/// @param mem The OpenCL memory object being destroyed.
+/// @param user_data The address returned by VirtualAllocExNuma.
+internal_function void CL_CALLBACK
+cgClFreeNodeLocalMemory
+(
+    cl_mem mem, 
+    void  *user_data
+)
+{
+    UNREFERENCED_PARAMETER(mem);
+    VirtualFree(user_data, 0, MEM_RELEASE);
+}
+
+/// @summary Locate the heap corresponding to OpenGL buffer usage flags.
+/// @param ctx The CGFX context maintaining the heap list.
+/// @param usage The OpenGL buffer usage hint, for example, GL_STREAM_DRAW.
+/// @return A pointer to the source heap.
+internal_function CG_HEAP*
+cgGlFindHeapForUsage
+(
+    CG_CONTEXT *ctx, 
+    GLenum      usage
+)
+{   // convert the OpenGL usage hints to a CGFX placement hint.
+    int placement_hint = 0;
+    switch (usage)
+    {
+    case GL_STATIC_DRAW:
+        placement_hint = CG_MEMORY_PLACEMENT_DEVICE;
+        break;
+    case GL_STATIC_READ:
+        placement_hint = CG_MEMORY_PLACEMENT_PINNED;
+        break;
+    case GL_STATIC_COPY:
+        placement_hint = CG_MEMORY_PLACEMENT_DEVICE;
+        break;
+    case GL_STREAM_DRAW:
+        placement_hint = CG_MEMORY_PLACEMENT_PINNED;
+        break;
+    case GL_STREAM_READ:
+        placement_hint = CG_MEMORY_PLACEMENT_PINNED;
+        break;
+    case GL_STREAM_COPY:
+        placement_hint = CG_MEMORY_PLACEMENT_DEVICE;
+        break;
+    case GL_DYNAMIC_DRAW:
+        placement_hint = CG_MEMORY_PLACEMENT_PINNED;
+        break;
+    case GL_DYNAMIC_READ:
+        placement_hint = CG_MEMORY_PLACEMENT_PINNED;
+        break;
+    case GL_DYNAMIC_COPY:
+        placement_hint = CG_MEMORY_PLACEMENT_DEVICE;
+        break;
+    default:
+        placement_hint = CG_MEMORY_PLACEMENT_HOST;
+        break;
+    }
+    return cgFindHeapForPlacement(ctx, placement_hint);
+}
+
+/// @summary Populate a cl_image_desc and cl_image_format to describe an image.
+/// @param cl_desc On return, stores the OpenCL image layout descriptor data.
+/// @param cl_format On return, stores the OpenCL pixel layout descriptor data.
+/// @param gl_target On return, stores the OpenGL texture target.
+/// @param pixel_width The image width, in pixels.
+/// @param pixel_height The image height, in pixels.
+/// @param slice_count The number of slices in the image. For 1D and 2D images, specify 1.
+/// @param array_count The number of array elements in the image. For cubemap images, specify 6. For non-array images, specify 1.
+/// @param level_count The number of mipmap levels in the image. For no mipmaps, specify 1. For all mipmaps, specify 0.
+/// @param row_pitch The number of bytes between each row of each slice in the image.
+/// @param slice_pitch The number of bytes between each slice of the image.
+/// @return true if the image attributes describe a logically valid combination. The device may or may not support the specified attributes.
+internal_function bool
+cgClMakeImageDesc
+(
+    cl_image_desc   &cl_desc,
+    cl_image_format &cl_format,
+    GLenum          &gl_target,
+    uint32_t         dxgi_format,
+    size_t           pixel_width, 
+    size_t           pixel_height, 
+    size_t           slice_count, 
+    size_t           array_count, 
+    size_t           level_count,
+    size_t           row_pitch, 
+    size_t           slice_pitch
+)
+{   UNREFERENCED_PARAMETER(level_count);
+    // populate a cl_image_desc object.
+    if (array_count > 1)
+    {   // this is an array image, which may be 1D or 2D.
+        if (pixel_height > 1)
+        {
+            gl_target                 = GL_TEXTURE_2D_ARRAY;
+            cl_desc.image_type        = CL_MEM_OBJECT_IMAGE2D_ARRAY;
+            cl_desc.image_width       = pixel_width;
+            cl_desc.image_height      = pixel_height;
+            cl_desc.image_depth       = 0;
+            cl_desc.image_array_size  = array_count;
+            cl_desc.image_row_pitch   = row_pitch;
+            cl_desc.image_slice_pitch = slice_pitch;
+            cl_desc.num_mip_levels    = 0;
+            cl_desc.num_samples       = 0;
+        }
+        else
+        {
+            gl_target                 = GL_TEXTURE_1D_ARRAY;
+            cl_desc.image_type        = CL_MEM_OBJECT_IMAGE1D_ARRAY;
+            cl_desc.image_width       = pixel_width;
+            cl_desc.image_height      = 0;
+            cl_desc.image_depth       = 0;
+            cl_desc.image_array_size  = array_count;
+            cl_desc.image_row_pitch   = row_pitch;
+            cl_desc.image_slice_pitch = slice_pitch;
+            cl_desc.num_mip_levels    = 0;
+            cl_desc.num_samples       = 0;
+        }
+    }
+    else
+    {   // this is a non-array 1D, 2D or 3D image.
+        if (slice_count > 1)
+        {
+            gl_target                 = GL_TEXTURE_3D;
+            cl_desc.image_type        = CL_MEM_OBJECT_IMAGE3D;
+            cl_desc.image_width       = pixel_width;
+            cl_desc.image_height      = pixel_height;
+            cl_desc.image_depth       = slice_count;
+            cl_desc.image_array_size  = 0;
+            cl_desc.image_row_pitch   = row_pitch;
+            cl_desc.image_slice_pitch = slice_pitch;
+            cl_desc.num_mip_levels    = 0;
+            cl_desc.num_samples       = 0;
+        }
+        else if (pixel_height > 1)
+        {
+            gl_target                 = GL_TEXTURE_2D;
+            cl_desc.image_type        = CL_MEM_OBJECT_IMAGE2D;
+            cl_desc.image_width       = pixel_width;
+            cl_desc.image_height      = pixel_height;
+            cl_desc.image_depth       = 0;
+            cl_desc.image_array_size  = 0;
+            cl_desc.image_row_pitch   = row_pitch;
+            cl_desc.image_slice_pitch = slice_pitch;
+            cl_desc.num_mip_levels    = 0;
+            cl_desc.num_samples       = 0;
+        }
+        else
+        {
+            gl_target                 = GL_TEXTURE_1D;
+            cl_desc.image_type        = CL_MEM_OBJECT_IMAGE1D;
+            cl_desc.image_width       = pixel_width;
+            cl_desc.image_height      = 0;
+            cl_desc.image_depth       = 0;
+            cl_desc.image_array_size  = 0;
+            cl_desc.image_row_pitch   = row_pitch;
+            cl_desc.image_slice_pitch = slice_pitch;
+            cl_desc.num_mip_levels    = 0;
+            cl_desc.num_samples       = 0;
+        }
+    }
+
+    // populate the cl_image_format object.
+    // the following mappings are taken from pp.54-55 of:
+    // https://www.khronos.org/registry/cl/specs/opencl-1.2-extensions.pdf
+    switch (dxgi_format)
+    {
+        case DXGI_FORMAT_UNKNOWN:
+        case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+        case DXGI_FORMAT_R32G32B32_TYPELESS:
         case DXGI_FORMAT_R16G16B16A16_TYPELESS:
         case DXGI_FORMAT_R32G32_TYPELESS:
         case DXGI_FORMAT_R32G8X24_TYPELESS:
@@ -1907,6 +3895,41 @@ cgClDoesDeviceExist
     return false;
 }
 
+/// @summary Map the zero-based index of a NUMA sub-device onto a Windows NUMA node number. OpenCL does not report which 
+/// processors a sub-device runs on, so the mapping assumes CL_DEVICE_AFFINITY_DOMAIN_NUMA partitions are returned in 
+/// ascending node order, skipping nodes with no processors. When the number of sub-devices differs from the number of 
+/// populated nodes the assumption cannot hold, and no node is reported.
+/// @param node_index The zero-based index of the sub-device returned by clCreateSubDevices.
+/// @param node_count The number of sub-devices returned by clCreateSubDevices.
+/// @return The Windows NUMA node number, or CG_NUMA_NODE_ANY if the sub-device cannot be matched to a node.
+internal_function uint32_t
+cgNumaNodeForIndex
+(
+    size_t node_index, 
+    size_t node_count
+)
+{
+    ULONG    highest_node = 0;
+    size_t   populated    = 0;
+    uint32_t result       = CG_NUMA_NODE_ANY;
+    if (!GetNumaHighestNodeNumber(&highest_node))
+        return CG_NUMA_NODE_ANY;
+    for (ULONG node = 0; node <= highest_node; ++node)
+    {
+        GROUP_AFFINITY mask;
+        memset(&mask, 0, sizeof(GROUP_AFFINITY));
+        if (!GetNumaNodeProcessorMaskEx(USHORT(node), &mask) || mask.Mask == 0)
+            continue;
+        if (populated++ == node_index)
+            result = uint32_t(node);
+    }
+    if (populated != node_count)
+    {   // the runtime partitioned the device differently than Windows reports the nodes.
+        return CG_NUMA_NODE_ANY;
+    }
+    return result;
+}
+
 /// @summary Queries the OpenCL runtime to determine whether a device partitioning method is supported.
 /// @param device The OpenCL device being partitioned.
 /// @param partition_type The device partition type to check.
@@ -2282,6 +4305,11 @@ cgClPartitionCpuDevice
         sub_dev.DeviceId       = devid;
         sub_dev.MasterDeviceId = cpu_device;
         sub_dev.Type           = CL_DEVICE_TYPE_CPU;
+        sub_dev.NUMANode       = CG_NUMA_NODE_ANY;
+        if (cpu_partition->PartitionType == CG_CPU_PARTITION_PER_NODE)
+        {   // device_list[i] is the (possibly sub-partitioned) device for the i'th NUMA partition.
+            sub_dev.NUMANode   = cgNumaNodeForIndex(device_index, size_t(num_subdevices));
+        }
 
         sub_dev.Name           = cgClDeviceString  (ctx, devid, CL_DEVICE_NAME      , CG_ALLOCATION_TYPE_INTERNAL);
         sub_dev.Platform       = cgClPlatformString(ctx, pid  , CL_PLATFORM_NAME    , CG_ALLOCATION_TYPE_INTERNAL);
@@ -2421,6 +4449,7 @@ cgClEnumerateDevices
             dev.PlatformId       = platform;
             dev.DeviceId         = device;
             dev.MasterDeviceId   = device;
+            dev.NUMANode         = CG_NUMA_NODE_ANY;
             dev.Name             = cgClDeviceString  (ctx, device  , CL_DEVICE_NAME      , CG_ALLOCATION_TYPE_INTERNAL);
             dev.Platform         = cgClPlatformString(ctx, platform, CL_PLATFORM_NAME    , CG_ALLOCATION_TYPE_INTERNAL);
             dev.Version          = cgClDeviceString  (ctx, device  , CL_DEVICE_VERSION   , CG_ALLOCATION_TYPE_INTERNAL);
@@ -2592,12 +4621,15 @@ cleanup:
 /// @summary Create an OpenGL rendering context for a given display, locate its associated OpenCL device, and setup sharing between OpenGL and OpenCL.
 /// @param ctx The CGFX context that owns the display.
 /// @param display The CGFX display object for which the rendering context is being created.
-/// @return CG_SUCCESS, CG_NO_GLSHARING, CG_NO_OPENGL, CG_NO_PIXELFORMAT, CG_BAD_PIXELFORMAT, CG_NO_GLCONTEXT or CG_BAD_GLCONTEXT.
+/// @param unshared_rc If not NULL, on return this is set to the rendering context created by the call if it could not be 
+/// shared with any OpenCL device, or NULL. That context is current on the calling thread and is owned by the caller.
+/// @return CG_SUCCESS, CG_NO_GLSHARING, CG_NO_OPENGL, CG_NO_PIXELFORMAT, CG_BAD_PIXELFORMAT, CG_NO_GLCONTEXT, CG_BAD_GLCONTEXT or CG_OUT_OF_OBJECTS.
 internal_function int
 cgGlCreateRenderingContext
 (
     CG_CONTEXT *ctx,
-    CG_DISPLAY *display
+    CG_DISPLAY *display, 
+    HGLRC      *unshared_rc
 )
 {
     int x = (int) display->DisplayX;
@@ -2605,6 +4637,9 @@ cgGlCreateRenderingContext
     int w = (int) display->DisplayWidth;
     int h = (int) display->DisplayHeight;
 
+    if (unshared_rc != NULL)
+       *unshared_rc  = NULL;
+
     // if the device already has a rendering context, there's nothing to do.
     if (display->DisplayRC != NULL)
         return CG_SUCCESS;
@@ -2742,6 +4777,11 @@ cgGlCreateRenderingContext
         return CG_BAD_GLCONTEXT;
     }
 
+    // the state of a new rendering context is not known until it is first set.
+    display->GLState = &display->GLStateStorage;
+    display->UniformRing = &display->UniformRingStorage;
+    cgGlStateReset(display);
+
     // enable synchronization with vertical retrace.
     if (WGLEW_EXT_swap_control)
     {
@@ -2795,12 +4835,21 @@ cgGlCreateRenderingContext
         if (device_id != device->DeviceId)
             continue; // no, so keep looking.
 
-        // we've found a match.
+        // we've found a match, but the device may not be able to reference another display.
+        if (device->DisplayCount >= CG_OPENGL_MAX_ATTACHED_DISPLAYS)
+        {   // the display was never attached, so nothing else references the new rendering context.
+            wglMakeCurrent(NULL, NULL);
+            wglDeleteContext(gl_rc);
+            return CG_OUT_OF_OBJECTS;
+        }
         if (device->DisplayRC != NULL)
         {   // delete the RC we just created and use the active device RC.
+            // the state cache and uniform ring belong to the rendering context, so share them too.
             wglMakeCurrent(NULL, NULL);
             wglDeleteContext(gl_rc);
             gl_rc = device->DisplayRC;
+            display->GLState = device->AttachedDisplays[0]->GLState;
+            display->UniformRing = device->AttachedDisplays[0]->UniformRing;
         }
         else
         {   // save the rendering context for use with the device.
@@ -2817,9 +4866,40 @@ cgGlCreateRenderingContext
     }
     // if there's no OpenCL device driving the display, that's fine.
     if (display->DisplayDevice == NULL)
+    {
+        if (unshared_rc != NULL)
+           *unshared_rc  = gl_rc;
         return CG_NO_GLSHARING;
-    else
-        return CG_SUCCESS;
+    }
+    else return CG_SUCCESS;
+}
+
+/// @summary Remove a display from the list of displays attached to a device. The rendering context is not deleted.
+/// @param device The device the display is attached to.
+/// @param display The display to detach.
+internal_function void
+cgGlDetachDisplay
+(
+    CG_DEVICE  *device, 
+    CG_DISPLAY *display
+)
+{
+    for (size_t i = 0, n = device->DisplayCount; i < n; ++i)
+    {
+        if (device->AttachedDisplays[i] == display)
+        {   // shift the remaining displays down to keep the list packed.
+            for (size_t j = i + 1; j < n; ++j)
+            {
+                device->AttachedDisplays[j-1] = device->AttachedDisplays[j];
+                device->DisplayDC[j-1] = device->DisplayDC[j];
+            }
+            device->AttachedDisplays[n-1] = NULL;
+            device->DisplayDC[n-1] = NULL;
+            device->DisplayCount--;
+            break;
+        }
+    }
+    display->DisplayDevice = NULL;
 }
 
 /// @summary Enumerate all enabled display devices on the system. OpenGL contexts are not created.
@@ -2913,6 +4993,8 @@ cgGlEnumerateDisplays
         disp.DisplayHWND   = window;
         disp.DisplayDC     = GetDC(window);
         disp.DisplayRC     = NULL;
+        disp.Headless      = false;
+        disp.FrameTimer    = NULL;
         disp.DisplayX      = x;
         disp.DisplayY      = y;
         disp.DisplayWidth  = size_t(w);
@@ -2933,6 +5015,101 @@ cgGlEnumerateDisplays
     return CG_SUCCESS;
 }
 
+/// @summary Create a headless display for a GPU device that drives no monitor, such as a server GPU used for offscreen 
+/// rendering. The display owns a hidden window that is never shown, which supplies the device context for an OpenGL 
+/// rendering context shared with OpenCL. Headless displays have no position or size and are never the primary display.
+/// A device has at most one headless display; if it already has one, it is reused.
+/// @param ctx The CGFX context that owns the display table.
+/// @param device The GPU device the rendering context must be created on.
+/// @return CG_SUCCESS, CG_NO_OPENGL, CG_NO_GLSHARING, CG_OUT_OF_OBJECTS, or another result of cgGlCreateRenderingContext.
+internal_function int
+cgGlCreateHeadlessDisplay
+(
+    CG_CONTEXT *ctx, 
+    CG_DEVICE  *device
+)
+{
+    HINSTANCE   instance = (HINSTANCE)&__ImageBase;
+    HWND        window   =  NULL;
+    CG_DISPLAY *display  =  NULL;
+    cg_handle_t handle   =  CG_INVALID_HANDLE;
+    HGLRC       gl_rc    =  NULL;
+    int         res      =  CG_SUCCESS;
+
+    for (size_t i = 0, n = device->DisplayCount; i < n; ++i)
+    {   // the device already has a headless display and rendering context.
+        if (device->AttachedDisplays[i]->Headless)
+            return CG_SUCCESS;
+    }
+    if (device->DisplayCount >= CG_OPENGL_MAX_ATTACHED_DISPLAYS)
+    {   // the device cannot reference any more displays.
+        return CG_OUT_OF_OBJECTS;
+    }
+    // the hidden window class is registered by cgGlEnumerateDisplays, even when no monitor is attached.
+    if ((window = CreateWindowEx(0, CG_OPENGL_HIDDEN_WNDCLASS_NAME, _T("CGFX_Headless"), WS_POPUP, 0, 0, 1, 1, NULL, NULL, instance, NULL)) == NULL)
+    {   // unable to create the window, so no device context is available.
+        return CG_NO_OPENGL;
+    }
+
+    CG_DISPLAY           disp;
+    disp.Ordinal       = CG_OPENGL_HEADLESS_ORDINAL;
+    disp.DisplayDevice = NULL;
+    disp.DisplayHWND   = window;
+    disp.DisplayDC     = GetDC(window);
+    disp.DisplayRC     = NULL;
+    disp.Headless      = true;
+    disp.FrameTimer    = NULL;
+    disp.DisplayX      = 0;
+    disp.DisplayY      = 0;
+    disp.DisplayWidth  = 0;
+    disp.DisplayHeight = 0;
+    memset(&disp.DisplayInfo,   0, sizeof(DISPLAY_DEVICE));
+    memset(&disp.DisplayMode,   0, sizeof(DEVMODE));
+    memset(&disp.GLEW       ,   0, sizeof(GLEWContext));
+    memset(&disp.WGLEW      ,   0, sizeof(WGLEWContext));
+    disp.DisplayInfo.cb      = sizeof(DISPLAY_DEVICE);
+    disp.DisplayMode.dmSize  = sizeof(DEVMODE);
+    if ((handle = cgObjectTableAdd(&ctx->DisplayTable, disp)) == CG_INVALID_HANDLE)
+    {   // the display table is full.
+        ReleaseDC(window, disp.DisplayDC);
+        DestroyWindow(window);
+        return CG_OUT_OF_OBJECTS;
+    }
+
+    // the rendering context is created by the driver that owns the window's desktop, 
+    // and attaches itself to whichever OpenCL device it can share resources with.
+    display = cgObjectTableGet(&ctx->DisplayTable, handle);
+    if ((res = cgGlCreateRenderingContext(ctx, display, &gl_rc)) != CG_SUCCESS)
+    {   // there's no usable OpenGL implementation, or it does not share with any OpenCL device.
+        // the display was not attached to any device, so nothing references it and it can be removed.
+        CG_DISPLAY removed;
+        if (gl_rc != NULL)
+        {   // the rendering context is still current, and was not saved by any device.
+            wglMakeCurrent(NULL, NULL);
+            wglDeleteContext(gl_rc);
+        }
+        if (cgObjectTableRemove(&ctx->DisplayTable, handle, removed))
+            cgDeleteDisplay(ctx, &removed);
+        return res;
+    }
+    wglMakeCurrent(NULL, NULL);
+    if (display->DisplayDevice != device)
+    {   // the rendering context was created on a different GPU, which did not request offscreen rendering.
+        CG_DEVICE *other = display->DisplayDevice;
+        CG_DISPLAY removed;
+        cgGlDetachDisplay(other, display);
+        if (other->DisplayCount == 0 && other->DisplayRC == display->DisplayRC)
+        {   // the rendering context was created for the headless display, so nothing else references it.
+            wglDeleteContext(other->DisplayRC);
+            other->DisplayRC = NULL;
+        }
+        if (cgObjectTableRemove(&ctx->DisplayTable, handle, removed))
+            cgDeleteDisplay(ctx, &removed);
+        return CG_NO_GLSHARING;
+    }
+    return CG_SUCCESS;
+}
+
 /// @summary Given an OpenGL data type value, calculates the corresponding size.
 /// @param data_type The OpenGL data type value, for example, GL_UNSIGNED_BYTE.
 /// @return The size of a single element of the specified type, in bytes.
@@ -3979,1767 +6156,3997 @@ cgGlDxgiFormatToGL
         default:
             break;
     }
-    return false;
-}
-
-/// @summary Computes the number of levels in a mipmap chain given the dimensions of the highest resolution level.
-/// @param width The width of the highest resolution level, in pixels.
-/// @param height The height of the highest resolution level, in pixels.
-/// @param slice_count The number of slices of the highest resolution level. For everything except a 3D image, this value should be specified as 1.
-/// @param max_levels The maximum number of levels in the mipmap chain. If there is no limit, this value should be specified as 0.
-internal_function size_t
-cgGlLevelCount
-(
-    size_t width,
-    size_t height,
-    size_t slice_count,
-    size_t max_levels
-)
-{
-    size_t levels = 0;
-    size_t major  = 0;
+    return false;
+}
+
+/// @summary Determine the client pixel format and data type used to transfer pixels of a DXGI format between OpenGL and 
+/// a buffer object. Uploads and reads use the same pair, so pixel data round-trips through OpenGL unchanged.
+/// @param dxgi A value of the DXGI_FORMAT or dxgi_format_e enumeration.
+/// @param out_format On return, stores the OpenGL client pixel format (layout).
+/// @param out_datatype On return, stores the OpenGL client data type.
+/// @return true if the input format could be mapped to OpenGL.
+export_function bool
+cgGlPixelTransferFormat
+(
+    uint32_t dxgi, 
+    GLenum  &out_format, 
+    GLenum  &out_datatype
+)
+{
+    GLenum internal_format = GL_NONE;
+    return cgGlDxgiFormatToGL(dxgi, internal_format, out_format, out_datatype);
+}
+
+/// @summary Computes the number of levels in a mipmap chain given the dimensions of the highest resolution level.
+/// @param width The width of the highest resolution level, in pixels.
+/// @param height The height of the highest resolution level, in pixels.
+/// @param slice_count The number of slices of the highest resolution level. For everything except a 3D image, this value should be specified as 1.
+/// @param max_levels The maximum number of levels in the mipmap chain. If there is no limit, this value should be specified as 0.
+internal_function size_t
+cgGlLevelCount
+(
+    size_t width,
+    size_t height,
+    size_t slice_count,
+    size_t max_levels
+)
+{
+    size_t levels = 0;
+    size_t major  = 0;
+
+    // select the largest of (width, height, slice_count):
+    major = (width > height)      ? width : height;
+    major = (major > slice_count) ? major : slice_count;
+    // calculate the number of levels down to 1 in the largest dimension.
+    while (major > 0)
+    {
+        major >>= 1;
+        levels += 1;
+    }
+    if (max_levels == 0) return levels;
+    else return (max_levels < levels) ? max_levels : levels;
+}
+
+/// @summary Computes the dimension (width, height or number of slices) of a particular level in a mipmap chain given the dimension for the highest resolution image.
+/// @param dimension The dimension in the highest resolution image.
+/// @param level_index The index of the target mip-level, with index 0 representing the highest resolution image.
+/// @return The dimension in the specified mip level.
+internal_function size_t
+cgGlLevelDimension
+(
+    size_t dimension,
+    size_t level_index
+)
+{
+    size_t  l_dimension  = dimension >> level_index;
+    return (l_dimension == 0) ? 1 : l_dimension;
+}
+
+/// @summary Given basic image attributes, builds a complete description of the levels in a mipmap chain.
+/// @param internal_format The OpenGL internal format, for example GL_RGBA. See the documentation for glTexImage2D(), internalFormat argument.
+/// @param data_type The OpenGL data type, for example, GL_UNSIGNED_BYTE.
+/// @param width The width of the highest resolution image, in pixels.
+/// @param height The height of the highest resolution image, in pixels.
+/// @param slice_count The number of slices in the highest resolution image. For all image types other than 3D images, specify 1 for this value.
+/// @param alignment The alignment requirement of the OpenGL implementation, corresponding to the pname of GL_PACK_ALIGNMENT or GL_UNPACK_ALIGNMENT for the glPixelStorei function. The specification default is 4.
+/// @param max_levels The maximum number of levels in the mipmap chain. To describe all possible levels, specify 0 for this value.
+/// @param level_desc The array of level descriptors to populate.
+/*internal_function void
+cgGlDescribeMipmaps
+(
+    GLenum         internal_format,
+    GLenum         data_type,
+    size_t         width,
+    size_t         height,
+    size_t         slice_count,
+    size_t         alignment,
+    size_t         max_levels,
+    CG_LEVEL_DESC *level_desc
+)
+{
+    size_t slices      = slice_count;
+    GLenum type        = data_type;
+    GLenum format      = internal_format;
+    GLenum layout      = cgGlPixelLayout(format);
+    size_t bytes_per_e = cgGlBytesPerElement(format, type);
+    size_t num_levels  = cgGlLevelCount(width, height, slices, max_levels);
+    for (size_t i = 0; i < num_levels; ++i)
+    {
+        size_t lw = cgGlLevelDimension(width,  i);
+        size_t lh = cgGlLevelDimension(height, i);
+        size_t ls = cgGlLevelDimension(slices, i);
+        level_desc[i].Index           = i;
+        level_desc[i].Width           = cgGlImageDimension(format, lw);
+        level_desc[i].Height          = cgGlImageDimension(format, lh);
+        level_desc[i].Slices          = ls;
+        level_desc[i].BytesPerElement = bytes_per_e;
+        level_desc[i].BytesPerRow     = cgGlBytesPerRow(format, type, level_desc[i].Width, alignment);
+        level_desc[i].BytesPerSlice   = level_desc[i].BytesPerRow * level_desc[i].Height;
+        level_desc[i].Layout          = layout;
+        level_desc[i].Format          = internal_format;
+        level_desc[i].DataType        = data_type;
+    }
+}*/
+
+/// @summary Given basic texture attributes, allocates storage for all levels of a texture, such that the texture is said to be complete. This should only be performed once per-texture. After calling this function, the texture object attributes should be considered immutable. Transfer data to the texture using the gl_transfer_pixels_h2d() function. The wrapping modes are always set to GL_CLAMP_TO_EDGE. The caller is responsible for creating and binding the texture object prior to calling this function.
+/// @param display The display managing the rendering context.
+/// @param target The OpenGL texture target, defining the texture type.
+/// @param internal_format The OpenGL internal format, for example GL_RGBA8.
+/// @param data_type The OpenGL data type, for example, GL_UNSIGNED_INT_8_8_8_8_REV.
+/// @param min_filter The minification filter to use.
+/// @param mag_filter The magnification filter to use.
+/// @param width The width of the highest resolution image, in pixels.
+/// @param height The height of the highest resolution image, in pixels.
+/// @param slice_count The number of slices in the highest resolution image. If the @a target argument specifies an array target, this represents the number of items in the texture array. For 3D textures, it represents the number of slices in the image. For all other types, this value must be 1.
+/// @param max_levels The maximum number of levels in the mipmap chain. To define all possible levels, specify 0 for this value.
+internal_function void
+cgGlTextureStorage
+(
+    CG_DISPLAY *display,
+    GLenum      target,
+    GLenum      internal_format,
+    GLenum      data_type,
+    GLenum      min_filter,
+    GLenum      mag_filter,
+    size_t      width,
+    size_t      height,
+    size_t      slice_count,
+    size_t      max_levels
+)
+{
+    GLenum layout = cgGlPixelLayout(internal_format);
+
+    if (max_levels == 0)
+    {
+        // specify mipmaps all the way down to 1x1x1.
+        max_levels  = cgGlLevelCount(width, height, slice_count, max_levels);
+    }
+
+    // make sure that no PBO is bound as the unpack target.
+    // we don't want to copy data to the texture now.
+    glBindBuffer (GL_PIXEL_UNPACK_BUFFER, 0);
+
+    // specify the maximum number of mipmap levels.
+    if (target != GL_TEXTURE_RECTANGLE)
+    {
+        glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL,  GLint(max_levels - 1));
+    }
+    else
+    {
+        // rectangle textures don't support mipmaps.
+        glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL,  0);
+    }
+
+    // specify the filtering and wrapping modes.
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, min_filter);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, mag_filter);
+    glTexParameteri(target, GL_TEXTURE_WRAP_S,     GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T,     GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_WRAP_R,     GL_CLAMP_TO_EDGE);
+
+    // use glTexImage to allocate storage for each mip-level of the texture.
+    switch (target)
+    {
+    case GL_TEXTURE_1D:
+        {
+            for (size_t lod = 0; lod < max_levels; ++lod)
+            {
+                size_t lw = cgGlLevelDimension(width, lod);
+                glTexImage1D(target, GLint(lod), internal_format, GLsizei(lw), 0, layout, data_type, NULL);
+            }
+        }
+        break;
+
+    case GL_TEXTURE_1D_ARRAY:
+        {
+            // 1D array textures specify slice_count for height.
+            for (size_t lod = 0; lod < max_levels; ++lod)
+            {
+                size_t lw = cgGlLevelDimension(width, lod);
+                glTexImage2D(target, GLint(lod), internal_format, GLsizei(lw), GLsizei(slice_count), 0, layout, data_type, NULL);
+            }
+        }
+        break;
+
+    case GL_TEXTURE_RECTANGLE:
+        {
+            // rectangle textures don't support mipmaps.
+            glTexImage2D(target, 0, internal_format, GLsizei(width), GLsizei(height), 0, layout, data_type, NULL);
+        }
+        break;
+
+    case GL_TEXTURE_2D:
+    case GL_TEXTURE_CUBE_MAP_POSITIVE_X:
+    case GL_TEXTURE_CUBE_MAP_NEGATIVE_X:
+    case GL_TEXTURE_CUBE_MAP_POSITIVE_Y:
+    case GL_TEXTURE_CUBE_MAP_NEGATIVE_Y:
+    case GL_TEXTURE_CUBE_MAP_POSITIVE_Z:
+    case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z:
+        {
+            for (size_t lod = 0; lod < max_levels; ++lod)
+            {
+                size_t lw = cgGlLevelDimension(width,  lod);
+                size_t lh = cgGlLevelDimension(height, lod);
+                glTexImage2D(target, GLint(lod), internal_format, GLsizei(lw), GLsizei(lh), 0, layout, data_type, NULL);
+            }
+        }
+        break;
+
+    case GL_TEXTURE_2D_ARRAY:
+    case GL_TEXTURE_CUBE_MAP_ARRAY:
+        {
+            // 2D array texture specify slice_count as the number of
+            // items; the number of items is not decreased with LOD.
+            for (size_t lod = 0; lod < max_levels; ++lod)
+            {
+                size_t lw = cgGlLevelDimension(width,  lod);
+                size_t lh = cgGlLevelDimension(height, lod);
+                glTexImage3D(target, GLint(lod), internal_format, GLsizei(lw), GLsizei(lh), GLsizei(slice_count), 0, layout, data_type, NULL);
+            }
+        }
+        break;
+
+    case GL_TEXTURE_3D:
+        {
+            for (size_t lod = 0; lod < max_levels; ++lod)
+            {
+                size_t lw = cgGlLevelDimension(width,       lod);
+                size_t lh = cgGlLevelDimension(height,      lod);
+                size_t ls = cgGlLevelDimension(slice_count, lod);
+                glTexImage3D(target, GLint(lod), internal_format, GLsizei(lw), GLsizei(lh), GLsizei(ls), 0, layout, data_type, NULL);
+            }
+        }
+        break;
+    }
+}
+/*
+/// @summary Copies pixel data from the device (GPU) to the host (CPU). The pixel data consists of the framebuffer contents, or the contents of a single mip-level of a texture image.
+/// @param display The display managing the rendering context.
+/// @param transfer An object describing the transfer operation to execute.
+internal_function void
+cgGlTransferPixelsDeviceToHost
+(
+    CG_DISPLAY            *display,
+    CG_PIXEL_TRANSFER_D2H *transfer
+)
+{
+    if (transfer->PackBuffer != 0)
+    {
+        // select the PBO as the target of the pack operation.
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, transfer->PackBuffer);
+    }
+    else
+    {
+        // select the client memory as the target of the pack operation.
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+    if (transfer->TargetWidth != transfer->TransferWidth)
+    {
+        // transferring into a sub-rectangle of the image; tell GL how
+        // many pixels are in a single row of the target image.
+        glPixelStorei(GL_PACK_ROW_LENGTH,   GLint(transfer->TargetWidth));
+        glPixelStorei(GL_PACK_IMAGE_HEIGHT, GLint(transfer->TargetHeight));
+    }
+
+    // perform the setup necessary to have GL calculate any byte offsets.
+    if (transfer->TargetX != 0) glPixelStorei(GL_PACK_SKIP_PIXELS, GLint(transfer->TargetX));
+    if (transfer->TargetY != 0) glPixelStorei(GL_PACK_SKIP_ROWS,   GLint(transfer->TargetY));
+    if (transfer->TargetZ != 0) glPixelStorei(GL_PACK_SKIP_IMAGES, GLint(transfer->TargetZ));
+
+    if (cgGlBytesPerBlock(transfer->Format) > 0)
+    {
+        // the texture image is compressed; use glGetCompressedTexImage.
+        switch (transfer->Target)
+        {
+            case GL_TEXTURE_1D:
+            case GL_TEXTURE_2D:
+            case GL_TEXTURE_3D:
+            case GL_TEXTURE_CUBE_MAP_ARRAY:
+            case GL_TEXTURE_CUBE_MAP_POSITIVE_X:
+            case GL_TEXTURE_CUBE_MAP_NEGATIVE_X:
+            case GL_TEXTURE_CUBE_MAP_POSITIVE_Y:
+            case GL_TEXTURE_CUBE_MAP_NEGATIVE_Y:
+            case GL_TEXTURE_CUBE_MAP_POSITIVE_Z:
+            case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z:
+                {
+                    glGetCompressedTexImage(transfer->Target, GLint(transfer->SourceIndex), transfer->TransferBuffer);
+                }
+                break;
+        }
+    }
+    else
+    {
+        // the image is not compressed; read the framebuffer with
+        // glReadPixels or the texture image using glGetTexImage.
+        switch (transfer->Target)
+        {
+            case GL_READ_FRAMEBUFFER:
+                {
+                    // remember, x and y identify the lower-left corner.
+                    glReadPixels(GLint(transfer->TransferX), GLint(transfer->TransferY), GLint(transfer->TransferWidth), GLint(transfer->TransferHeight), transfer->Layout, transfer->DataType, transfer->TransferBuffer);
+                }
+                break;
+
+            case GL_TEXTURE_1D:
+            case GL_TEXTURE_2D:
+            case GL_TEXTURE_3D:
+            case GL_TEXTURE_1D_ARRAY:
+            case GL_TEXTURE_2D_ARRAY:
+            case GL_TEXTURE_RECTANGLE:
+            case GL_TEXTURE_CUBE_MAP_ARRAY:
+            case GL_TEXTURE_CUBE_MAP_POSITIVE_X:
+            case GL_TEXTURE_CUBE_MAP_NEGATIVE_X:
+            case GL_TEXTURE_CUBE_MAP_POSITIVE_Y:
+            case GL_TEXTURE_CUBE_MAP_NEGATIVE_Y:
+            case GL_TEXTURE_CUBE_MAP_POSITIVE_Z:
+            case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z:
+                {
+                    glGetTexImage(transfer->Target, GLint(transfer->SourceIndex), transfer->Layout, transfer->DataType, transfer->TransferBuffer);
+                }
+                break;
+        }
+    }
+
+    // restore the pack state values to their defaults.
+    if (transfer->PackBuffer  != 0)
+        glBindBuffer(GL_PIXEL_PACK_BUFFER,  0);
+    if (transfer->TargetWidth != transfer->TransferWidth)
+    {
+        glPixelStorei(GL_PACK_ROW_LENGTH,   0);
+        glPixelStorei(GL_PACK_IMAGE_HEIGHT, 0);
+    }
+    if (transfer->TargetX != 0) glPixelStorei(GL_PACK_SKIP_PIXELS,  0);
+    if (transfer->TargetY != 0) glPixelStorei(GL_PACK_SKIP_ROWS,    0);
+    if (transfer->TargetZ != 0) glPixelStorei(GL_PACK_SKIP_IMAGES,  0);
+}
+
+/// @summary Copies pixel data from the host (CPU) to the device (GPU). The pixel data is copied to a single mip-level of a texture image.
+/// @param display The display managing the rendering context.
+/// @param transfer An object describing the transfer operation to execute.
+internal_function void
+cgGlPixelTransferHostToDevice
+(
+    CG_DISPLAY            *display,
+    CG_PIXEL_TRANSFER_H2D *transfer
+)
+{
+    if (transfer->UnpackBuffer != 0)
+    {   // select the PBO as the source of the unpack operation.
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, transfer->UnpackBuffer);
+    }
+    else
+    {   // select the client memory as the source of the unpack operation.
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    if (transfer->SourceWidth != transfer->TransferWidth)
+    {   // transferring a sub-rectangle of the image; tell GL how many
+        // pixels are in a single row of the source image.
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, GLint(transfer->SourceWidth));
+    }
+    if (transfer->TransferSlices > 1)
+    {   // transferring an image volume; tell GL how many rows per-slice
+        // in the source image, since we may only be transferring a sub-volume.
+        glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, GLint(transfer->SourceHeight));
+    }
+
+    // perform the setup necessary to have GL calculate any byte offsets.
+    if (transfer->SourceX != 0) glPixelStorei(GL_UNPACK_SKIP_PIXELS, GLint(transfer->SourceX));
+    if (transfer->SourceY != 0) glPixelStorei(GL_UNPACK_SKIP_ROWS,   GLint(transfer->SourceY));
+    if (transfer->SourceZ != 0) glPixelStorei(GL_UNPACK_SKIP_IMAGES, GLint(transfer->SourceZ));
+
+    if (cgGlBytesPerBlock(transfer->Format) > 0)
+    {
+        // the image is compressed; use glCompressedTexSubImage to transfer.
+        switch (transfer->Target)
+        {
+            case GL_TEXTURE_1D:
+                {
+                    glCompressedTexSubImage1D(transfer->Target, GLint(transfer->TargetIndex), GLint(transfer->TargetX), GLsizei(transfer->TransferWidth), transfer->Format, GLsizei(transfer->TransferSize), transfer->TransferBuffer);
+                }
+                break;
+
+            case GL_TEXTURE_2D:
+            case GL_TEXTURE_1D_ARRAY:
+            case GL_TEXTURE_RECTANGLE:
+            case GL_TEXTURE_CUBE_MAP_POSITIVE_X:
+            case GL_TEXTURE_CUBE_MAP_NEGATIVE_X:
+            case GL_TEXTURE_CUBE_MAP_POSITIVE_Y:
+            case GL_TEXTURE_CUBE_MAP_NEGATIVE_Y:
+            case GL_TEXTURE_CUBE_MAP_POSITIVE_Z:
+            case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z:
+                {
+                    glCompressedTexSubImage2D(transfer->Target, GLint(transfer->TargetIndex), GLint(transfer->TargetX), GLint(transfer->TargetY), GLsizei(transfer->TransferWidth), GLsizei(transfer->TransferHeight), transfer->Format, GLsizei(transfer->TransferSize), transfer->TransferBuffer);
+                }
+                break;
+
+            case GL_TEXTURE_3D:
+            case GL_TEXTURE_2D_ARRAY:
+            case GL_TEXTURE_CUBE_MAP_ARRAY:
+                {
+                    glCompressedTexSubImage3D(transfer->Target, GLint(transfer->TargetIndex), GLint(transfer->TargetX), GLint(transfer->TargetY), GLint(transfer->TargetZ), GLsizei(transfer->TransferWidth), GLsizei(transfer->TransferHeight), GLsizei(transfer->TransferSlices), transfer->Format, GLsizei(transfer->TransferSize), transfer->TransferBuffer);
+                }
+                break;
+        }
+    }
+    else
+    {
+        // the image is not compressed, use glTexSubImage to transfer data.
+        switch (transfer->Target)
+        {
+            case GL_TEXTURE_1D:
+                {
+                    glTexSubImage1D(transfer->Target, GLint(transfer->TargetIndex), GLint(transfer->TargetX), GLsizei(transfer->TransferWidth), transfer->Format, transfer->DataType, transfer->TransferBuffer);
+                }
+                break;
+
+            case GL_TEXTURE_2D:
+            case GL_TEXTURE_1D_ARRAY:
+            case GL_TEXTURE_RECTANGLE:
+            case GL_TEXTURE_CUBE_MAP_POSITIVE_X:
+            case GL_TEXTURE_CUBE_MAP_NEGATIVE_X:
+            case GL_TEXTURE_CUBE_MAP_POSITIVE_Y:
+            case GL_TEXTURE_CUBE_MAP_NEGATIVE_Y:
+            case GL_TEXTURE_CUBE_MAP_POSITIVE_Z:
+            case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z:
+                {
+                    glTexSubImage2D(transfer->Target, GLint(transfer->TargetIndex), GLint(transfer->TargetX), GLint(transfer->TargetY), GLsizei(transfer->TransferWidth), GLsizei(transfer->TransferHeight), transfer->Format, transfer->DataType, transfer->TransferBuffer);
+                }
+                break;
+
+            case GL_TEXTURE_3D:
+            case GL_TEXTURE_2D_ARRAY:
+            case GL_TEXTURE_CUBE_MAP_ARRAY:
+                {
+                    glTexSubImage3D(transfer->Target, GLint(transfer->TargetIndex), GLint(transfer->TargetX), GLint(transfer->TargetY), GLint(transfer->TargetZ), GLsizei(transfer->TransferWidth), GLsizei(transfer->TransferHeight), GLsizei(transfer->TransferSlices), transfer->Format, transfer->DataType, transfer->TransferBuffer);
+                }
+                break;
+        }
+    }
+
+    // restore the unpack state values to their defaults.
+    if (transfer->UnpackBuffer  != 0)
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER,  0);
+    if (transfer->SourceWidth   != transfer->TransferWidth)
+        glPixelStorei(GL_UNPACK_ROW_LENGTH,   0);
+    if (transfer->TransferSlices > 1)
+        glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, 0);
+    if (transfer->SourceX != 0)
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS,  0);
+    if (transfer->SourceY != 0)
+        glPixelStorei(GL_UNPACK_SKIP_ROWS,    0);
+    if (transfer->SourceZ != 0)
+        glPixelStorei(GL_UNPACK_SKIP_IMAGES,  0);
+}*/
+
+/// @summary Convert a CGFX blend function value to the corresponding OpenGL enum.
+/// @param factor The CGFX blend function value, one of cg_blend_function_e.
+/// @return The corresponding OpenGL enum value, or GL_INVALID_ENUM.
+internal_function GLenum
+cgGlBlendFunction
+(
+    int func
+)
+{
+    switch (func)
+    {
+        case CG_BLEND_FUNCTION_ADD             : return GL_FUNC_ADD;
+        case CG_BLEND_FUNCTION_SUBTRACT        : return GL_FUNC_SUBTRACT;
+        case CG_BLEND_FUNCTION_REVERSE_SUBTRACT: return GL_FUNC_REVERSE_SUBTRACT;
+        case CG_BLEND_FUNCTION_MIN             : return GL_MIN;
+        case CG_BLEND_FUNCTION_MAX             : return GL_MAX;
+        default: break;
+    }
+    return GL_INVALID_ENUM;
+}
+
+/// @summary Convert a CGFX blend factor value to the corresponding OpenGL enum.
+/// @param factor The CGFX blend factor value, one of cg_blend_factor_e.
+/// @return The corresponding OpenGL enum value, or GL_INVALID_ENUM.
+internal_function GLenum
+cgGlBlendFactor
+(
+    int factor
+)
+{
+    switch (factor)
+    {
+        case CG_BLEND_FACTOR_ZERO           : return GL_ZERO;
+        case CG_BLEND_FACTOR_ONE            : return GL_ONE;
+        case CG_BLEND_FACTOR_SRC_COLOR      : return GL_SRC_COLOR;
+        case CG_BLEND_FACTOR_INV_SRC_COLOR  : return GL_ONE_MINUS_SRC_COLOR;
+        case CG_BLEND_FACTOR_DST_COLOR      : return GL_DST_COLOR;
+        case CG_BLEND_FACTOR_INV_DST_COLOR  : return GL_ONE_MINUS_DST_COLOR;
+        case CG_BLEND_FACTOR_SRC_ALPHA      : return GL_SRC_ALPHA;
+        case CG_BLEND_FACTOR_INV_SRC_ALPHA  : return GL_ONE_MINUS_SRC_ALPHA;
+        case CG_BLEND_FACTOR_DST_ALPHA      : return GL_DST_ALPHA;
+        case CG_BLEND_FACTOR_INV_DST_ALPHA  : return GL_ONE_MINUS_DST_ALPHA;
+        case CG_BLEND_FACTOR_CONST_COLOR    : return GL_CONSTANT_COLOR;
+        case CG_BLEND_FACTOR_INV_CONST_COLOR: return GL_ONE_MINUS_CONSTANT_COLOR;
+        case CG_BLEND_FACTOR_CONST_ALPHA    : return GL_CONSTANT_ALPHA;
+        case CG_BLEND_FACTOR_INV_CONST_ALPHA: return GL_ONE_MINUS_CONSTANT_ALPHA;
+        case CG_BLEND_FACTOR_SRC_ALPHA_SAT  : return GL_SRC_ALPHA_SATURATE;
+        default: break;
+    }
+    return GL_INVALID_ENUM;
+}
+
+/// @summary Convert a CGFX comparison function value to the corresponding OpenGL enum.
+/// @param mode The CGFX comparison function, one of cg_compare_function_e.
+/// @return The corresponding OpenGL enum value, or GL_INVALID_ENUM.
+internal_function GLenum
+cgGlCompareFunction
+(
+    int func
+)
+{
+    switch (func)
+    {
+        case CG_COMPARE_NEVER        : return GL_NEVER;
+        case CG_COMPARE_LESS         : return GL_LESS;
+        case CG_COMPARE_EQUAL        : return GL_EQUAL;
+        case CG_COMPARE_LESS_EQUAL   : return GL_LEQUAL;
+        case CG_COMPARE_GREATER      : return GL_GREATER;
+        case CG_COMPARE_NOT_EQUAL    : return GL_NOTEQUAL;
+        case CG_COMPARE_GREATER_EQUAL: return GL_GEQUAL;
+        case CG_COMPARE_ALWAYS       : return GL_ALWAYS;
+        default: break;
+    }
+    return GL_INVALID_ENUM;
+}
+
+/// @summary Convert a CGFX fill mode value to the corresponding OpenGL enum.
+/// @param mode The CGFX fill mode, one of cg_fill_mode_e.
+/// @return The corresponding OpenGL enum value, or GL_INVALID_ENUM.
+internal_function GLenum
+cgGlFillMode
+(
+    int mode
+)
+{
+    switch (mode)
+    {
+        case CG_FILL_SOLID    : return GL_FILL;
+        case CG_FILL_WIREFRAME: return GL_LINE;
+        default: break;
+    }
+    return GL_INVALID_ENUM;
+}
+
+/// @summary Convert a CGFX cull mode value to the corresponding OpenGL enum.
+/// @param mode The CGFX culling mode, one of cg_cull_mode_e.
+/// @return The corresponding OpenGL enum value, or GL_INVALID_ENUM.
+internal_function GLenum
+cgGlCullMode
+(
+    int mode
+)
+{
+    switch (mode)
+    {
+        case CG_CULL_NONE : return GL_NONE;
+        case CG_CULL_FRONT: return GL_FRONT;
+        case CG_CULL_BACK : return GL_BACK;
+        default: break;
+    }
+    return GL_INVALID_ENUM;
+}
+
+/// @summary Convert a CGFX winding order value to the corresponding OpenGL enum.
+/// @param winding The CGFX winding order value, one of cg_winding_e.
+/// @return The corresponding OpenGL enum value, or GL_INVALID_ENUM.
+internal_function GLenum
+cgGlWindingOrder
+(
+    int winding
+)
+{
+    switch (winding)
+    {
+        case CG_WINDING_CCW: return GL_CCW;
+        case CG_WINDING_CW : return GL_CW;
+        default: break;
+    }
+    return GL_INVALID_ENUM;
+}
+
+/// @summary Convert a CGFX primitive topology value to the corresponding OpenGL enum.
+/// @param topology The CGFX primitive topology value, one of cg_primitive_topology_e.
+/// @return The corresponding OpenGL enum value, or GL_INVALID_ENUM.
+internal_function GLenum
+cgGlPrimitiveTopology
+(
+    int topology
+)
+{
+    switch (topology)
+    {
+        case CG_PRIMITIVE_POINT_LIST    : return GL_POINTS;
+        case CG_PRIMITIVE_LINE_LIST     : return GL_LINES;
+        case CG_PRIMITIVE_LINE_STRIP    : return GL_LINE_STRIP;
+        case CG_PRIMITIVE_TRIANGLE_LIST : return GL_TRIANGLES;
+        case CG_PRIMITIVE_TRIANGLE_STRIP: return GL_TRIANGLE_STRIP;
+        default: break;
+    }
+    return GL_INVALID_ENUM;
+}
+
+/// @summary Convert a CGFX stencil operation value to the corresponding OpenGL enum.
+/// @param op The CGFX stencil operation, one of cg_stencil_operation_e.
+/// @return The corresponding OpenGL enum value, or GL_INVALID_ENUM.
+internal_function GLenum
+cgGlStencilOp
+(
+    int op
+)
+{
+    switch (op)
+    {
+        case CG_STENCIL_OP_KEEP     : return GL_KEEP;
+        case CG_STENCIL_OP_ZERO     : return GL_ZERO;
+        case CG_STENCIL_OP_REPLACE  : return GL_REPLACE;
+        case CG_STENCIL_OP_INC_CLAMP: return GL_INCR;
+        case CG_STENCIL_OP_DEC_CLAMP: return GL_DECR;
+        case CG_STENCIL_OP_INVERT   : return GL_INVERT;
+        case CG_STENCIL_OP_INC_WRAP : return GL_INCR_WRAP;
+        case CG_STENCIL_OP_DEC_WRAP : return GL_DECR_WRAP;
+        default: break;
+    }
+    return GL_INVALID_ENUM;
+}
+
+/// @summary Convert a boolean value into either GL_TRUE or GL_FALSE.
+/// @param value The value to convert.
+/// @return One of GL_TRUE or GL_FALSE.
+internal_function GLboolean
+cgGlBoolean
+(
+    bool value
+)
+{
+    return value ? GL_TRUE : GL_FALSE;
+}
+
+/// @summary Determines whether an identifier would be considered a GLSL built- in value; that is, whether the identifier starts with 'gl_'.
+/// @param name A NULL-terminated ASCII string identifier.
+/// @return true if @a name starts with 'gl_'.
+internal_function bool
+cgGlslBuiltIn
+(
+    char const *name
+)
+{
+    char prefix[4] = {'g','l','_','\0'};
+    return (strncmp(name, prefix, 3) == 0);
+}
+
+/// @summary Counts the number of active vertex attribues, texture samplers, uniform values and uniform blocks defined in a shader program.
+/// @param display The display managing the rendering context.
+/// @param program The OpenGL program object to query.
+/// @param buffer A temporary buffer used to hold attribute and uniform names.
+/// @param buffer_size The maximum number of bytes that can be written to the temporary name buffer.
+/// @param include_builtins Specify true to include GLSL builtin values in the returned vertex attribute count.
+/// @param out_num_attribs On return, this address is updated with the number of active vertex attribute values.
+/// @param out_num_samplers On return, this address is updated with the number of active texture sampler values.
+/// @param out_num_uniforms On return, this address is updated with the number of active uniform values.
+/// @param out_num_blocks On return, this address is updated with the number of active uniform blocks.
+internal_function void
+cgGlslReflectProgramCounts
+(
+    CG_DISPLAY *display,
+    GLuint      program,
+    char       *buffer,
+    size_t      buffer_size,
+    bool        include_builtins,
+    size_t     &out_num_attribs,
+    size_t     &out_num_samplers,
+    size_t     &out_num_uniforms, 
+    size_t     &out_num_blocks
+)
+{
+    size_t  num_attribs  = 0;
+    GLint   attrib_count = 0;
+    GLsizei buf_size     = (GLsizei) buffer_size;
+
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &attrib_count);
+    for (GLint i = 0; i < attrib_count; ++i)
+    {
+        GLenum type = GL_FLOAT;
+        GLuint idx  = (GLuint) i;
+        GLint  len  = 0;
+        GLint  sz   = 0;
+        glGetActiveAttrib(program, idx, buf_size, &len, &sz, &type, buffer);
+        if (cgGlslBuiltIn(buffer) && !include_builtins)
+            continue;
+        num_attribs++;
+    }
+
+    size_t num_samplers  = 0;
+    size_t num_uniforms  = 0;
+    GLint  uniform_count = 0;
+
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniform_count);
+    for (GLint i = 0; i < uniform_count; ++i)
+    {
+        GLenum type = GL_FLOAT;
+        GLuint idx  = (GLuint) i;
+        GLint  len  = 0;
+        GLint  sz   = 0;
+        glGetActiveUniform(program, idx, buf_size, &len, &sz, &type, buffer);
+        if (cgGlslBuiltIn (buffer) && !include_builtins)
+            continue;
+
+        switch (type)
+        {
+            case GL_SAMPLER_1D:
+            case GL_INT_SAMPLER_1D:
+            case GL_UNSIGNED_INT_SAMPLER_1D:
+            case GL_SAMPLER_1D_SHADOW:
+            case GL_SAMPLER_2D:
+            case GL_INT_SAMPLER_2D:
+            case GL_UNSIGNED_INT_SAMPLER_2D:
+            case GL_SAMPLER_2D_SHADOW:
+            case GL_SAMPLER_3D:
+            case GL_INT_SAMPLER_3D:
+            case GL_UNSIGNED_INT_SAMPLER_3D:
+            case GL_SAMPLER_CUBE:
+            case GL_INT_SAMPLER_CUBE:
+            case GL_UNSIGNED_INT_SAMPLER_CUBE:
+            case GL_SAMPLER_CUBE_SHADOW:
+            case GL_SAMPLER_1D_ARRAY:
+            case GL_SAMPLER_1D_ARRAY_SHADOW:
+            case GL_INT_SAMPLER_1D_ARRAY:
+            case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+            case GL_SAMPLER_2D_ARRAY:
+            case GL_SAMPLER_2D_ARRAY_SHADOW:
+            case GL_INT_SAMPLER_2D_ARRAY:
+            case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+            case GL_SAMPLER_BUFFER:
+            case GL_INT_SAMPLER_BUFFER:
+            case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+            case GL_SAMPLER_2D_RECT:
+            case GL_SAMPLER_2D_RECT_SHADOW:
+            case GL_INT_SAMPLER_2D_RECT:
+            case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+            case GL_SAMPLER_2D_MULTISAMPLE:
+            case GL_INT_SAMPLER_2D_MULTISAMPLE:
+            case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+            case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+            case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+            case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+                num_samplers++;
+                break;
+
+            default:
+                num_uniforms++;
+                break;
+        }
+    }
+
+    GLint  block_count   = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &block_count);
+
+    // set the output values for the caller.
+    out_num_attribs  = num_attribs;
+    out_num_samplers = num_samplers;
+    out_num_uniforms = num_uniforms;
+    out_num_blocks   = (size_t) block_count;
+}
+
+/// @summary Retrieve information about the active vertex attribues, texture samplers, uniform values and uniform blocks defined in a shader program.
+/// Uniform blocks are assigned consecutive binding points in block index order; see cgGlslBindUniformBlocks.
+/// @param display The display managing the rendering context.
+/// @param program The OpenGL program object to query.
+/// @param buffer A temporary buffer used to hold attribute and uniform names.
+/// @param buffer_size The maximum number of bytes that can be written to the temporary name buffer.
+/// @param include_builtins Specify true to include GLSL builtin values in the returned vertex attribute count.
+/// @param glsl The GLSL program descriptor to populate with data.
+internal_function void
+cgGlslReflectProgramMetadata
+(
+    CG_DISPLAY      *display,
+    GLuint           program,
+    char            *buffer,
+    size_t           buffer_size,
+    bool             include_builtins,
+    CG_GLSL_PROGRAM *glsl
+)
+{
+    uint32_t          *attrib_names  = glsl->AttributeNames;
+    uint32_t          *sampler_names = glsl->SamplerNames;
+    uint32_t          *uniform_names = glsl->UniformNames;
+    CG_GLSL_ATTRIBUTE *attrib_info   = glsl->Attributes;
+    CG_GLSL_SAMPLER   *sampler_info  = glsl->Samplers;
+    CG_GLSL_UNIFORM   *uniform_info  = glsl->Uniforms;
+    uint32_t          *block_names   = glsl->UniformBlockNames;
+    CG_GLSL_UNIFORM_BLOCK *block_info= glsl->UniformBlocks;
+    size_t             num_attribs   = 0;
+    GLint              attrib_count  = 0;
+    GLsizei            buf_size      =(GLsizei) buffer_size;
+
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &attrib_count);
+    for (GLint i = 0; i < attrib_count; ++i)
+    {
+        GLenum type = GL_FLOAT;
+        GLuint idx  = (GLuint) i;
+        GLint  len  = 0;
+        GLint  loc  = 0;
+        GLint  sz   = 0;
+        glGetActiveAttrib(program, idx, buf_size, &len, &sz, &type, buffer);
+        if (cgGlslBuiltIn(buffer) && !include_builtins)
+            continue;
+
+        CG_GLSL_ATTRIBUTE va;
+        loc             = glGetAttribLocation(program, buffer);
+        va.DataType     =(GLenum)   type;
+        va.Location     =(GLint)    loc;
+        va.DataSize     =(size_t)   cgGlDataSize(type) * sz;
+        va.DataOffset   =(size_t)   0; // for application use only
+        va.Dimension    =(size_t)   sz;
+        attrib_names[num_attribs] = cgHashName(buffer);
+        attrib_info [num_attribs] = va;
+        num_attribs++;
+    }
+
+    size_t num_samplers  = 0;
+    size_t num_uniforms  = 0;
+    GLint  uniform_count = 0;
+    GLint  texture_unit  = 0;
+
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniform_count);
+    for (GLint i = 0; i < uniform_count; ++i)
+    {
+        GLenum type = GL_FLOAT;
+        GLuint idx  = (GLuint) i;
+        GLint  len  = 0;
+        GLint  loc  = 0;
+        GLint  sz   = 0;
+        glGetActiveUniform(program, idx, buf_size, &len, &sz, &type, buffer);
+        if (cgGlslBuiltIn (buffer) && !include_builtins)
+            continue;
+
+        switch (type)
+        {
+            case GL_SAMPLER_1D:
+            case GL_INT_SAMPLER_1D:
+            case GL_UNSIGNED_INT_SAMPLER_1D:
+            case GL_SAMPLER_1D_SHADOW:
+            case GL_SAMPLER_2D:
+            case GL_INT_SAMPLER_2D:
+            case GL_UNSIGNED_INT_SAMPLER_2D:
+            case GL_SAMPLER_2D_SHADOW:
+            case GL_SAMPLER_3D:
+            case GL_INT_SAMPLER_3D:
+            case GL_UNSIGNED_INT_SAMPLER_3D:
+            case GL_SAMPLER_CUBE:
+            case GL_INT_SAMPLER_CUBE:
+            case GL_UNSIGNED_INT_SAMPLER_CUBE:
+            case GL_SAMPLER_CUBE_SHADOW:
+            case GL_SAMPLER_1D_ARRAY:
+            case GL_SAMPLER_1D_ARRAY_SHADOW:
+            case GL_INT_SAMPLER_1D_ARRAY:
+            case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+            case GL_SAMPLER_2D_ARRAY:
+            case GL_SAMPLER_2D_ARRAY_SHADOW:
+            case GL_INT_SAMPLER_2D_ARRAY:
+            case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+            case GL_SAMPLER_BUFFER:
+            case GL_INT_SAMPLER_BUFFER:
+            case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+            case GL_SAMPLER_2D_RECT:
+            case GL_SAMPLER_2D_RECT_SHADOW:
+            case GL_INT_SAMPLER_2D_RECT:
+            case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+            case GL_SAMPLER_2D_MULTISAMPLE:
+            case GL_INT_SAMPLER_2D_MULTISAMPLE:
+            case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+            case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+            case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+            case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+                {
+                    CG_GLSL_SAMPLER  ts;
+                    loc            = glGetUniformLocation(program, buffer);
+                    ts.SamplerType =(GLenum)      type;
+                    ts.BindTarget  =(GLenum)      cgGlTextureTarget(type);
+                    ts.Location    =(GLint)       loc;
+                    ts.ImageUnit   =(GLint)       texture_unit++;
+                    sampler_names[num_samplers] = cgHashName(buffer);
+                    sampler_info [num_samplers] = ts;
+                    num_samplers++;
+                }
+                break;
+
+            default:
+                {
+                    CG_GLSL_UNIFORM  uv;
+                    GLint          block = -1;
+                    GLint          start =  0;
+                    glGetActiveUniformsiv(program, 1, &idx, GL_UNIFORM_BLOCK_INDEX, &block);
+                    if (block >= 0) glGetActiveUniformsiv(program, 1, &idx, GL_UNIFORM_OFFSET, &start);
+                    loc            = block < 0 ? glGetUniformLocation(program, buffer) : -1;
+                    uv.DataType    =(GLenum)      type;
+                    uv.Location    =(GLint)       loc;
+                    uv.BlockIndex  =(GLint)       block;
+                    uv.DataSize    =(size_t)      cgGlDataSize(type) * sz;
+                    uv.DataOffset  =(size_t)      start; // offset within the block, or for application use
+                    uv.Dimension   =(size_t)      sz;
+                    uniform_names[num_uniforms] = cgHashName(buffer);
+                    uniform_info [num_uniforms] = uv;
+                    num_uniforms++;
+                }
+                break;
+        }
+    }
+
+    GLint  block_count   = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &block_count);
+    for (GLint i = 0; i < block_count; ++i)
+    {
+        CG_GLSL_UNIFORM_BLOCK ub;
+        GLuint idx  = (GLuint) i;
+        GLint  len  = 0;
+        GLint  sz   = 0;
+        glGetActiveUniformBlockName(program, idx, buf_size, &len, buffer);
+        glGetActiveUniformBlockiv  (program, idx, GL_UNIFORM_BLOCK_DATA_SIZE, &sz);
+        ub.Binding     =(GLuint) idx;
+        ub.DataSize    =(size_t) sz;
+        block_names[i] = cgHashName(buffer);
+        block_info [i] = ub;
+    }
+}
+
+/// @summary Assign each active uniform block of a linked program to its reflected binding point. Block bindings are 
+/// program object state that is reset by glProgramBinary, so this is called after linking or loading from the cache.
+/// @param display The display managing the rendering context.
+/// @param glsl The GLSL program descriptor, with a valid program object and uniform block reflection data.
+internal_function void
+cgGlslBindUniformBlocks
+(
+    CG_DISPLAY            *display, 
+    CG_GLSL_PROGRAM const *glsl
+)
+{
+    for (size_t i = 0, n = glsl->UniformBlockCount; i < n; ++i)
+    {
+        glUniformBlockBinding(glsl->Program, (GLuint) i, glsl->UniformBlocks[i].Binding);
+    }
+}
+
+/// @summary Compute the on-disk cache key for a linked OpenGL program. The key covers the source code of each attached 
+/// shader, the pre-link attribute and fragment output bindings and the OpenGL driver identification strings.
+/// @param ctx The CGFX context that owns the kernel cache.
+/// @param display The display managing the rendering context the program is linked for.
+/// @param vs_kernel The vertex shader kernel object.
+/// @param gs_kernel The geometry shader kernel object, or NULL.
+/// @param fs_kernel The fragment shader kernel object.
+/// @param create The graphics pipeline description supplying the attribute and output bindings.
+/// @return The 64-bit cache key, or zero if the cache is disabled or the driver cannot retrieve program binaries.
+internal_function uint64_t
+cgGlProgramCacheKey
+(
+    CG_CONTEXT                   *ctx, 
+    CG_DISPLAY                   *display, 
+    CG_KERNEL                    *vs_kernel, 
+    CG_KERNEL                    *gs_kernel, 
+    CG_KERNEL                    *fs_kernel, 
+    cg_graphics_pipeline_t const *create
+)
+{
+    uint64_t hash    = CG_FNV1A_64_SEED;
+    uint64_t gs_hash = gs_kernel != NULL ? gs_kernel->SourceHash : 0;
+    size_t   ptr_size= sizeof(size_t); // the reflection arrays are stored in their in-memory layout.
+    uint32_t version = CG_GLSL_BINARY_VERSION;
+    if (ctx->KernelCache.Directory == NULL)
+        return 0;
+    if (!GLEW_ARB_get_program_binary && !GLEW_VERSION_4_1)
+        return 0;
+    hash = cgHashData  (hash, &vs_kernel->SourceHash, sizeof(uint64_t));
+    hash = cgHashData  (hash, &gs_hash              , sizeof(uint64_t));
+    hash = cgHashData  (hash, &fs_kernel->SourceHash, sizeof(uint64_t));
+    for (size_t i = 0, n = create->AttributeCount; i < n; ++i)
+    {
+        hash = cgHashString(hash, create->AttributeBindings[i].Name);
+        hash = cgHashData  (hash, &create->AttributeBindings[i].Location, sizeof(unsigned int));
+    }
+    for (size_t i = 0, n = create->OutputCount; i < n; ++i)
+    {
+        hash = cgHashString(hash, create->OutputBindings[i].Name);
+        hash = cgHashData  (hash, &create->OutputBindings[i].Location, sizeof(unsigned int));
+    }
+    hash = cgHashString(hash, (char const*) glGetString(GL_VENDOR));
+    hash = cgHashString(hash, (char const*) glGetString(GL_RENDERER));
+    hash = cgHashString(hash, (char const*) glGetString(GL_VERSION));
+    hash = cgHashData  (hash, &ptr_size, sizeof(size_t));
+    hash = cgHashData  (hash, &version , sizeof(uint32_t));
+    return hash;
+}
+
+/// @summary Free the reflection arrays of a GLSL program descriptor and reset its counts to zero.
+/// @param ctx The CGFX context that allocated the reflection arrays.
+/// @param glsl The GLSL program descriptor to reset. The program object is not modified.
+internal_function void
+cgGlslFreeReflection
+(
+    CG_CONTEXT      *ctx, 
+    CG_GLSL_PROGRAM *glsl
+)
+{
+    cgFreeHostMemory(&ctx->HostAllocator, glsl->Samplers      , glsl->SamplerCount   * sizeof(CG_GLSL_SAMPLER)  , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, glsl->SamplerNames  , glsl->SamplerCount   * sizeof(uint32_t)         , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, glsl->Attributes    , glsl->AttributeCount * sizeof(CG_GLSL_ATTRIBUTE), 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, glsl->AttributeNames, glsl->AttributeCount * sizeof(uint32_t)         , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, glsl->Uniforms      , glsl->UniformCount   * sizeof(CG_GLSL_UNIFORM)  , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, glsl->UniformNames  , glsl->UniformCount   * sizeof(uint32_t)         , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, glsl->UniformBlocks    , glsl->UniformBlockCount * sizeof(CG_GLSL_UNIFORM_BLOCK), 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, glsl->UniformBlockNames, glsl->UniformBlockCount * sizeof(uint32_t)             , 0, CG_ALLOCATION_TYPE_OBJECT);
+    glsl->AttributeCount = 0; glsl->AttributeNames = NULL; glsl->Attributes = NULL;
+    glsl->SamplerCount   = 0; glsl->SamplerNames   = NULL; glsl->Samplers   = NULL;
+    glsl->UniformCount   = 0; glsl->UniformNames   = NULL; glsl->Uniforms   = NULL;
+    glsl->UniformBlockCount = 0; glsl->UniformBlockNames = NULL; glsl->UniformBlocks = NULL;
+}
+
+/// @summary Attempt to restore a linked OpenGL program and its reflection data from the on-disk kernel cache. If the 
+/// driver rejects the cached binary, for example after a driver update, the entry is treated as a miss.
+/// @param ctx The CGFX context that owns the kernel cache.
+/// @param display The display managing the rendering context.
+/// @param program The OpenGL program object to load the binary into.
+/// @param key The cache key returned by cgGlProgramCacheKey.
+/// @param glsl The GLSL program descriptor to populate with the cached reflection data.
+/// @return true if the program is linked and the reflection data was restored.
+internal_function bool
+cgGlLoadCachedProgram
+(
+    CG_CONTEXT      *ctx, 
+    CG_DISPLAY      *display, 
+    GLuint           program, 
+    uint64_t         key, 
+    CG_GLSL_PROGRAM *glsl
+)
+{
+    CG_GLSL_BINARY_HEADER header;
+    size_t                data_size = 0;
+    size_t                expect    = sizeof(CG_GLSL_BINARY_HEADER);
+    uint8_t              *data      =(uint8_t*) cgKernelCacheRead(ctx, key, "glbin", data_size);
+    uint8_t              *iter      = data + sizeof(CG_GLSL_BINARY_HEADER);
+    GLint                 linkres   = GL_FALSE;
+    bool                  loaded    = false;
+
+    if (data == NULL)
+        return false;
+    if (data_size < sizeof(CG_GLSL_BINARY_HEADER))
+        goto cleanup;
+    memcpy(&header, data, sizeof(CG_GLSL_BINARY_HEADER));
+    if (header.AttributeCount > data_size || header.SamplerCount > data_size || header.UniformCount > data_size || header.UniformBlockCount > data_size)
+        goto cleanup;
+    expect += header.AttributeCount * (sizeof(uint32_t) + sizeof(CG_GLSL_ATTRIBUTE));
+    expect += header.SamplerCount   * (sizeof(uint32_t) + sizeof(CG_GLSL_SAMPLER));
+    expect += header.UniformCount   * (sizeof(uint32_t) + sizeof(CG_GLSL_UNIFORM));
+    expect += header.UniformBlockCount * (sizeof(uint32_t) + sizeof(CG_GLSL_UNIFORM_BLOCK));
+    expect += header.BinarySize;
+    if (header.BinarySize == 0 || expect != data_size)
+        goto cleanup;
+
+    // the program binary is stored last. an unsupported format generates GL_INVALID_ENUM.
+    glProgramBinary(program, (GLenum) header.BinaryFormat, data + data_size - header.BinarySize, (GLsizei) header.BinarySize);
+    glGetProgramiv (program, GL_LINK_STATUS, &linkres);
+    glGetError();
+    if (linkres != GL_TRUE)
+        goto cleanup;
+
+    // restore the reflection data in the same layout produced by cgGlslReflectProgramMetadata.
+    glsl->AttributeCount = header.AttributeCount;
+    glsl->AttributeNames =(uint32_t         *) cgAllocateHostMemory(&ctx->HostAllocator, glsl->AttributeCount * sizeof(uint32_t)         , 0, CG_ALLOCATION_TYPE_OBJECT);
+    glsl->Attributes     =(CG_GLSL_ATTRIBUTE*) cgAllocateHostMemory(&ctx->HostAllocator, glsl->AttributeCount * sizeof(CG_GLSL_ATTRIBUTE), 0, CG_ALLOCATION_TYPE_OBJECT);
+    glsl->SamplerCount   = header.SamplerCount;
+    glsl->SamplerNames   =(uint32_t         *) cgAllocateHostMemory(&ctx->HostAllocator, glsl->SamplerCount   * sizeof(uint32_t)         , 0, CG_ALLOCATION_TYPE_OBJECT);
+    glsl->Samplers       =(CG_GLSL_SAMPLER  *) cgAllocateHostMemory(&ctx->HostAllocator, glsl->SamplerCount   * sizeof(CG_GLSL_SAMPLER)  , 0, CG_ALLOCATION_TYPE_OBJECT);
+    glsl->UniformCount   = header.UniformCount;
+    glsl->UniformNames   =(uint32_t         *) cgAllocateHostMemory(&ctx->HostAllocator, glsl->UniformCount   * sizeof(uint32_t)         , 0, CG_ALLOCATION_TYPE_OBJECT);
+    glsl->Uniforms       =(CG_GLSL_UNIFORM  *) cgAllocateHostMemory(&ctx->HostAllocator, glsl->UniformCount   * sizeof(CG_GLSL_UNIFORM)  , 0, CG_ALLOCATION_TYPE_OBJECT);
+    glsl->UniformBlockCount = header.UniformBlockCount;
+    glsl->UniformBlockNames =(uint32_t             *) cgAllocateHostMemory(&ctx->HostAllocator, glsl->UniformBlockCount * sizeof(uint32_t)             , 0, CG_ALLOCATION_TYPE_OBJECT);
+    glsl->UniformBlocks     =(CG_GLSL_UNIFORM_BLOCK*) cgAllocateHostMemory(&ctx->HostAllocator, glsl->UniformBlockCount * sizeof(CG_GLSL_UNIFORM_BLOCK), 0, CG_ALLOCATION_TYPE_OBJECT);
+    if (glsl->AttributeNames == NULL || glsl->Attributes == NULL ||
+        glsl->SamplerNames   == NULL || glsl->Samplers   == NULL ||
+        glsl->UniformNames   == NULL || glsl->Uniforms   == NULL ||
+        glsl->UniformBlockNames == NULL || glsl->UniformBlocks == NULL)
+    {   // unable to allocate the required memory; the caller will link from source.
+        cgGlslFreeReflection(ctx, glsl);
+        goto cleanup;
+    }
+    memcpy(glsl->AttributeNames, iter, glsl->AttributeCount * sizeof(uint32_t));          iter += glsl->AttributeCount * sizeof(uint32_t);
+    memcpy(glsl->Attributes    , iter, glsl->AttributeCount * sizeof(CG_GLSL_ATTRIBUTE)); iter += glsl->AttributeCount * sizeof(CG_GLSL_ATTRIBUTE);
+    memcpy(glsl->SamplerNames  , iter, glsl->SamplerCount   * sizeof(uint32_t));          iter += glsl->SamplerCount   * sizeof(uint32_t);
+    memcpy(glsl->Samplers      , iter, glsl->SamplerCount   * sizeof(CG_GLSL_SAMPLER));   iter += glsl->SamplerCount   * sizeof(CG_GLSL_SAMPLER);
+    memcpy(glsl->UniformNames  , iter, glsl->UniformCount   * sizeof(uint32_t));          iter += glsl->UniformCount   * sizeof(uint32_t);
+    memcpy(glsl->Uniforms      , iter, glsl->UniformCount   * sizeof(CG_GLSL_UNIFORM));   iter += glsl->UniformCount   * sizeof(CG_GLSL_UNIFORM);
+    memcpy(glsl->UniformBlockNames, iter, glsl->UniformBlockCount * sizeof(uint32_t));              iter += glsl->UniformBlockCount * sizeof(uint32_t);
+    memcpy(glsl->UniformBlocks    , iter, glsl->UniformBlockCount * sizeof(CG_GLSL_UNIFORM_BLOCK)); iter += glsl->UniformBlockCount * sizeof(CG_GLSL_UNIFORM_BLOCK);
+    loaded = true;
+
+cleanup:
+    cgFreeHostMemory(&ctx->HostAllocator, data, data_size, 0, CG_ALLOCATION_TYPE_TEMP);
+    return loaded;
+}
+
+/// @summary Retrieve the binary of a freshly linked OpenGL program and write it, along with its reflection data, to the 
+/// on-disk kernel cache. Failure to write the cache is not an error; the program is simply linked again next time.
+/// @param ctx The CGFX context that owns the kernel cache.
+/// @param display The display managing the rendering context.
+/// @param program The linked OpenGL program object. GL_PROGRAM_BINARY_RETRIEVABLE_HINT should be set prior to linking.
+/// @param key The cache key returned by cgGlProgramCacheKey.
+/// @param glsl The GLSL program descriptor populated by cgGlslReflectProgramMetadata.
+/// @return true if the cache entry was written.
+internal_function bool
+cgGlStoreProgram
+(
+    CG_CONTEXT            *ctx, 
+    CG_DISPLAY            *display, 
+    GLuint                 program, 
+    uint64_t               key, 
+    CG_GLSL_PROGRAM const *glsl
+)
+{
+    CG_GLSL_BINARY_HEADER header;
+    GLint                 binary_max = 0;
+    GLsizei               binary_len = 0;
+    GLenum                format     = 0;
+    size_t                alloc_size = sizeof(CG_GLSL_BINARY_HEADER);
+    uint8_t              *data       = NULL;
+    uint8_t              *iter       = NULL;
+    bool                  stored     = false;
+
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binary_max);
+    if (binary_max <= 0)
+        return false;
+    alloc_size += glsl->AttributeCount * (sizeof(uint32_t) + sizeof(CG_GLSL_ATTRIBUTE));
+    alloc_size += glsl->SamplerCount   * (sizeof(uint32_t) + sizeof(CG_GLSL_SAMPLER));
+    alloc_size += glsl->UniformCount   * (sizeof(uint32_t) + sizeof(CG_GLSL_UNIFORM));
+    alloc_size += glsl->UniformBlockCount * (sizeof(uint32_t) + sizeof(CG_GLSL_UNIFORM_BLOCK));
+    alloc_size += size_t(binary_max);
+    if ((data = (uint8_t*) cgAllocateHostMemory(&ctx->HostAllocator, alloc_size, 0, CG_ALLOCATION_TYPE_TEMP)) == NULL)
+        return false;
+
+    iter = data + sizeof(CG_GLSL_BINARY_HEADER);
+    memcpy(iter, glsl->AttributeNames, glsl->AttributeCount * sizeof(uint32_t));          iter += glsl->AttributeCount * sizeof(uint32_t);
+    memcpy(iter, glsl->Attributes    , glsl->AttributeCount * sizeof(CG_GLSL_ATTRIBUTE)); iter += glsl->AttributeCount * sizeof(CG_GLSL_ATTRIBUTE);
+    memcpy(iter, glsl->SamplerNames  , glsl->SamplerCount   * sizeof(uint32_t));          iter += glsl->SamplerCount   * sizeof(uint32_t);
+    memcpy(iter, glsl->Samplers      , glsl->SamplerCount   * sizeof(CG_GLSL_SAMPLER));   iter += glsl->SamplerCount   * sizeof(CG_GLSL_SAMPLER);
+    memcpy(iter, glsl->UniformNames  , glsl->UniformCount   * sizeof(uint32_t));          iter += glsl->UniformCount   * sizeof(uint32_t);
+    memcpy(iter, glsl->Uniforms      , glsl->UniformCount   * sizeof(CG_GLSL_UNIFORM));   iter += glsl->UniformCount   * sizeof(CG_GLSL_UNIFORM);
+    memcpy(iter, glsl->UniformBlockNames, glsl->UniformBlockCount * sizeof(uint32_t));              iter += glsl->UniformBlockCount * sizeof(uint32_t);
+    memcpy(iter, glsl->UniformBlocks    , glsl->UniformBlockCount * sizeof(CG_GLSL_UNIFORM_BLOCK)); iter += glsl->UniformBlockCount * sizeof(CG_GLSL_UNIFORM_BLOCK);
+    glGetProgramBinary(program, binary_max, &binary_len, &format, iter);
+    if (glGetError() != GL_NO_ERROR || binary_len <= 0 || binary_len > binary_max)
+        goto cleanup;
+
+    header.BinaryFormat   = (uint32_t) format;
+    header.BinarySize     = (uint32_t) binary_len;
+    header.AttributeCount = (uint32_t) glsl->AttributeCount;
+    header.SamplerCount   = (uint32_t) glsl->SamplerCount;
+    header.UniformCount   = (uint32_t) glsl->UniformCount;
+    header.UniformBlockCount = (uint32_t) glsl->UniformBlockCount;
+    memcpy(data, &header, sizeof(CG_GLSL_BINARY_HEADER));
+    stored = cgKernelCacheWrite(ctx, key, "glbin", data, alloc_size - size_t(binary_max - binary_len));
+
+cleanup:
+    cgFreeHostMemory(&ctx->HostAllocator, data, alloc_size, 0, CG_ALLOCATION_TYPE_TEMP);
+    return stored;
+}
+
+/// @summary Fills a memory buffer with a checkerboard pattern. This is useful for indicating uninitialized textures and for testing. The image internal format is expected to be GL_RGBA, data type GL_UNSIGNED_INT_8_8_8_8_REV, and the data is written using the native system byte ordering (GL_BGRA).
+/// @param width The image width, in pixels.
+/// @param height The image height, in pixels.
+/// @param alpha The value to write to the alpha channel, in [0, 1].
+/// @param buffer The buffer to which image data will be written.
+internal_function void
+cgCheckerFillRGBA
+(
+    size_t width,
+    size_t height,
+    float  alpha,
+    void  *buffer
+)
+{
+    uint8_t  a = (uint8_t)((alpha - 0.5f) * 255.0f);
+    uint8_t *p = (uint8_t*) buffer;
+    for (size_t i = 0;  i < height; ++i)
+    {
+        for (size_t j = 0; j < width; ++j)
+        {
+            uint8_t v = ((((i & 0x8) == 0)) ^ ((j & 0x8) == 0)) ? 1 : 0;
+            *p++  = v * 0xFF;
+            *p++  = v ? 0x00 : 0xFF;
+            *p++  = v * 0xFF;
+            *p++  = a;
+        }
+    }
+}
+
+/// @summary Determine whether a device should be included in the device list for an execution group.
+/// @param root_device A reference to the root device, which defines the share group.
+/// @param check_device A reference to the device to check for inclusion in the device list.
+/// @param check_handle The handle used to refer to @a check_device.
+/// @param create_flags A combination of cg_execution_group_flags_e used to define the devices to include in the implicit device list.
+/// @param device_list A list of handles of devices explicitly specified by the user for inclusion.
+/// @param device_count The number of handles in the explicit device list.
+/// @param explicit_count A counter to increment if @a check_handle appears in @a device_list.
+/// @return true if @a check_device should be included in the device list.
+internal_function bool
+cgShouldIncludeDeviceInGroup
+(
+    CG_DEVICE   *root_device,
+    CG_DEVICE   *check_device,
+    cg_handle_t  check_handle,
+    uint32_t     create_flags,
+    cg_handle_t *device_list,
+    size_t       device_count,
+    size_t      &explicit_count
+)
+{
+    if (check_device->ExecutionGroup != CG_INVALID_HANDLE)
+        return false;    // devices must not already be assigned to an execution group
+    if (check_device == root_device)
+        return true;     // always include the root device
+    if (check_device->PlatformId != root_device->PlatformId)
+        return false;    // devices must be in the same share group
+    for (size_t i = 0; i  < device_count; ++i)
+    {   if (check_handle == device_list[i])
+        {   explicit_count++;
+            return true; // the device is in the explicit device list
+        }
+    }
+    switch (root_device->Type)
+    {
+    case CL_DEVICE_TYPE_CPU:
+        {
+            if (check_device->Type == CL_DEVICE_TYPE_CPU && (create_flags & CG_EXECUTION_GROUP_CPUS))
+                return true; // CPU devices may always be used together.
+            if (check_device->Type == CL_DEVICE_TYPE_GPU && (create_flags & CG_EXECUTION_GROUP_GPUS))
+                return check_device->Capabilities.UnifiedMemory == CL_TRUE; // GPUs can be paired if unified memory.
+            if (check_device->Type == CL_DEVICE_TYPE_ACCELERATOR && (create_flags & CG_EXECUTION_GROUP_ACCELERATORS))
+                return check_device->Capabilities.UnifiedMemory == CL_TRUE; // accelerators can be paired if unified memory.
+        }
+        return false;
+
+    case CL_DEVICE_TYPE_GPU:
+        {
+            if (check_device->Type == CL_DEVICE_TYPE_CPU && (create_flags & CG_EXECUTION_GROUP_CPUS))
+                return (root_device->Capabilities.UnifiedMemory == CL_TRUE); // CPUs can be paired if unified memory.
+            if (check_device->Type == CL_DEVICE_TYPE_GPU && (create_flags & CG_EXECUTION_GROUP_GPUS))
+                return (create_flags & CG_EXECUTION_GROUP_DISPLAY_OUTPUT) == 0; // GPUs can be paired if not used for display output.
+            if (check_device->Type == CL_DEVICE_TYPE_ACCELERATOR && (create_flags & CG_EXECUTION_GROUP_ACCELERATORS))
+                return (root_device->Capabilities.UnifiedMemory == CL_TRUE && check_device->Capabilities.UnifiedMemory == CL_TRUE); // pairing allowed if both devices support unified memory.
+        }
+        return false;
+
+    case CL_DEVICE_TYPE_ACCELERATOR:
+        {
+            if (check_device->Type == CL_DEVICE_TYPE_CPU && (create_flags & CG_EXECUTION_GROUP_CPUS))
+                return (root_device->Capabilities.UnifiedMemory == CL_TRUE); // CPUs can be paired if unified memory.
+            if (check_device->Type == CL_DEVICE_TYPE_GPU && (create_flags & CG_EXECUTION_GROUP_GPUS))
+                return (root_device->Capabilities.UnifiedMemory == CL_TRUE && check_device->Capabilities.UnifiedMemory == CL_TRUE); // pairing allowed if both devices support unified memory.
+            if (check_device->Type == CL_DEVICE_TYPE_ACCELERATOR && (create_flags & CG_EXECUTION_GROUP_ACCELERATORS))
+                return true; // accelerator devices may always be used together.
+        }
+        return false;
+
+    default:
+        return false;
+    }
+}
+
+/// @summary Create a complete list of device handles for an execution group and perform partitioning of any CPU devices.
+/// @param ctx The CGFX context managing the device list.
+/// @param root_device The handle of any device in the share group.
+/// @param create_flags A combination of cg_execution_group_flags_e specifying what to include in the device list.
+/// @param device_list A list of handles of devices explicitly specified by the user for inclusion.
+/// @param device_count The number of handles in the explicit device list.
+/// @param num_devices On return, stores the number of devices in the output device list.
+/// @param result On return, stores CG_SUCCESS or an error code.
+/// @return An array of num_devices handles to the devices used to create the execution group (including the root device), or NULL.
+internal_function cg_handle_t*
+cgCreateExecutionGroupDeviceList
+(
+    CG_CONTEXT  *ctx,
+    cg_handle_t  root_device,
+    uint32_t     create_flags,
+    cg_handle_t *device_list,
+    size_t       device_count,
+    size_t      &num_devices,
+    int         &result
+)
+{
+    CG_DEVICE     *root_dev     = cgObjectTableGet(&ctx->DeviceTable, root_device);
+    cg_handle_t   *devices      = NULL;
+    size_t         num_cpu      = 0; // number of CPU devices
+    size_t         num_gpu      = 0; // number of GPU devices
+    size_t         num_acl      = 0; // number of accelerator devices
+    size_t         num_total    = 0;
+    size_t         num_explicit = 0;
+
+    // initialize output parameters:
+    num_devices = 0;
+    result = CG_SUCCESS;
+
+    // count the number of devices to be included in the list.
+    for (size_t i = 0, n = ctx->DeviceTable.ObjectCount; i < n; ++i)
+    {
+        CG_DEVICE *check =&ctx->DeviceTable.Objects[i];
+        cg_handle_t hand = cgMakeHandle(&ctx->DeviceTable, i);
+        if (cgShouldIncludeDeviceInGroup(root_dev, check, hand, create_flags, device_list, device_count, num_explicit))
+        {   // increment per-type counts:
+            switch (check->Type)
+            {
+            case CL_DEVICE_TYPE_CPU        : num_cpu++; break;
+            case CL_DEVICE_TYPE_GPU        : num_gpu++; break;
+            case CL_DEVICE_TYPE_ACCELERATOR: num_acl++; break;
+            default: break;
+            }
+        }
+    }
+    if (num_explicit != device_count)
+    {   // the explicit device list contains one or more invalid handles.
+        result = CG_INVALID_VALUE;
+        goto error_return;
+    }
+    if (num_gpu > 1 && (create_flags & CG_EXECUTION_GROUP_DISPLAY_OUTPUT))
+    {   // only one GPU device allowed in groups used for display output.
+        result = CG_INVALID_VALUE;
+        goto error_return;
+    }
+
+    // calculate the total number of items in the device list:
+    num_explicit = 0;
+    num_total = num_cpu + num_gpu + num_acl;
+    assert(num_total >= 1);
+
+    // allocate storage for the device handles:
+    if ((devices = (cg_handle_t*) cgAllocateHostMemory(&ctx->HostAllocator, num_total * sizeof(cg_handle_t), 0, CG_ALLOCATION_TYPE_TEMP)) == NULL)
+    {   // unable to allocate the necessary memory.
+        result = CG_OUT_OF_MEMORY;
+        goto error_return;
+    }
 
-    // select the largest of (width, height, slice_count):
-    major = (width > height)      ? width : height;
-    major = (major > slice_count) ? major : slice_count;
-    // calculate the number of levels down to 1 in the largest dimension.
-    while (major > 0)
+    // run through the device table again to populate the device list.
+    for (size_t i = 0, n = ctx->DeviceTable.ObjectCount; i < n; ++i)
     {
-        major >>= 1;
-        levels += 1;
+        CG_DEVICE *check =&ctx->DeviceTable.Objects[i];
+        cg_handle_t hand = cgMakeHandle(&ctx->DeviceTable, i);
+        if (cgShouldIncludeDeviceInGroup(root_dev, check, hand, create_flags, device_list, device_count, num_explicit))
+        {   // save the handle for the caller.
+            devices[num_devices++] = hand;
+        }
     }
-    if (max_levels == 0) return levels;
-    else return (max_levels < levels) ? max_levels : levels;
+    return devices;
+
+error_return:
+    num_devices = 0;
+    return NULL;
 }
 
-/// @summary Computes the dimension (width, height or number of slices) of a particular level in a mipmap chain given the dimension for the highest resolution image.
-/// @param dimension The dimension in the highest resolution image.
-/// @param level_index The index of the target mip-level, with index 0 representing the highest resolution image.
-/// @return The dimension in the specified mip level.
-internal_function size_t
-cgGlLevelDimension
+/// @summary Frees the memory allocated for a device list created with cgCreateExecutionGroupDeviceList.
+/// @param ctx The CGFX context that allocated the device list.
+/// @param devices The device list returned by cgCreateExecutionGroupDeviceList.
+/// @param num_devices The number of devices returned by cgCreateExecutionGroupDeviceList.
+internal_function inline void
+cgFreeExecutionGroupDeviceList
 (
-    size_t dimension,
-    size_t level_index
+    CG_CONTEXT  *ctx,
+    cg_handle_t *devices,
+    size_t       num_devices
 )
 {
-    size_t  l_dimension  = dimension >> level_index;
-    return (l_dimension == 0) ? 1 : l_dimension;
+    cgFreeHostMemory(&ctx->HostAllocator, devices, num_devices * sizeof(cg_handle_t), 0, CG_ALLOCATION_TYPE_TEMP);
 }
 
-/// @summary Given basic image attributes, builds a complete description of the levels in a mipmap chain.
-/// @param internal_format The OpenGL internal format, for example GL_RGBA. See the documentation for glTexImage2D(), internalFormat argument.
-/// @param data_type The OpenGL data type, for example, GL_UNSIGNED_BYTE.
-/// @param width The width of the highest resolution image, in pixels.
-/// @param height The height of the highest resolution image, in pixels.
-/// @param slice_count The number of slices in the highest resolution image. For all image types other than 3D images, specify 1 for this value.
-/// @param alignment The alignment requirement of the OpenGL implementation, corresponding to the pname of GL_PACK_ALIGNMENT or GL_UNPACK_ALIGNMENT for the glPixelStorei function. The specification default is 4.
-/// @param max_levels The maximum number of levels in the mipmap chain. To describe all possible levels, specify 0 for this value.
-/// @param level_desc The array of level descriptors to populate.
-/*internal_function void
-cgGlDescribeMipmaps
+/// @summary Calculate the number of bytes allocated for an image on its associated heap.
+/// @param image The image to query. All image attributes (dimensions, format, etc.) must be set.
+/// @return The number of bytes allocated for image data storage on the image source heap.
+internal_function size_t
+cgCalculateImageAllocatedSize
 (
-    GLenum         internal_format,
-    GLenum         data_type,
-    size_t         width,
-    size_t         height,
-    size_t         slice_count,
-    size_t         alignment,
-    size_t         max_levels,
-    CG_LEVEL_DESC *level_desc
+    CG_IMAGE *image
 )
 {
-    size_t slices      = slice_count;
-    GLenum type        = data_type;
-    GLenum format      = internal_format;
-    GLenum layout      = cgGlPixelLayout(format);
-    size_t bytes_per_e = cgGlBytesPerElement(format, type);
-    size_t num_levels  = cgGlLevelCount(width, height, slices, max_levels);
-    for (size_t i = 0; i < num_levels; ++i)
+    size_t allocated_size = 0;
+    size_t nslice_or_item = image->ArrayCount > 1 ? image->ArrayCount : image->SliceCount;
+    for (size_t i = 0, n  = nslice_or_item; i < n; ++i)
     {
-        size_t lw = cgGlLevelDimension(width,  i);
-        size_t lh = cgGlLevelDimension(height, i);
-        size_t ls = cgGlLevelDimension(slices, i);
-        level_desc[i].Index           = i;
-        level_desc[i].Width           = cgGlImageDimension(format, lw);
-        level_desc[i].Height          = cgGlImageDimension(format, lh);
-        level_desc[i].Slices          = ls;
-        level_desc[i].BytesPerElement = bytes_per_e;
-        level_desc[i].BytesPerRow     = cgGlBytesPerRow(format, type, level_desc[i].Width, alignment);
-        level_desc[i].BytesPerSlice   = level_desc[i].BytesPerRow * level_desc[i].Height;
-        level_desc[i].Layout          = layout;
-        level_desc[i].Format          = internal_format;
-        level_desc[i].DataType        = data_type;
+        for (size_t j = 0; j < image->LevelCount; ++j)
+        {
+            size_t  w = cgGlLevelDimension(image->PaddedWidth , j);
+            size_t  h = cgGlLevelDimension(image->PaddedHeight, j);
+            size_t ss = cgGlBytesPerSlice (image->InternalFormat, image->DataType, w, h, 4);
+            allocated_size += ss;
+        }
     }
-}*/
+    return align_up(allocated_size, image->SourceHeap->DeviceAlignment);
+}
 
-/// @summary Given basic texture attributes, allocates storage for all levels of a texture, such that the texture is said to be complete. This should only be performed once per-texture. After calling this function, the texture object attributes should be considered immutable. Transfer data to the texture using the gl_transfer_pixels_h2d() function. The wrapping modes are always set to GL_CLAMP_TO_EDGE. The caller is responsible for creating and binding the texture object prior to calling this function.
-/// @param display The display managing the rendering context.
-/// @param target The OpenGL texture target, defining the texture type.
-/// @param internal_format The OpenGL internal format, for example GL_RGBA8.
-/// @param data_type The OpenGL data type, for example, GL_UNSIGNED_INT_8_8_8_8_REV.
-/// @param min_filter The minification filter to use.
-/// @param mag_filter The magnification filter to use.
-/// @param width The width of the highest resolution image, in pixels.
-/// @param height The height of the highest resolution image, in pixels.
-/// @param slice_count The number of slices in the highest resolution image. If the @a target argument specifies an array target, this represents the number of items in the texture array. For 3D textures, it represents the number of slices in the image. For all other types, this value must be 1.
-/// @param max_levels The maximum number of levels in the mipmap chain. To define all possible levels, specify 0 for this value.
+/// @summary Provides a default teardown callback for a pipeline that doesn't need to perform any cleanup.
+/// @param ctx A CGFX context returned by cgEnumerateDevices.
+/// @param pipeline A pointer to the CG_PIPELINE object.
+/// @param opaque The opaque state data supplied when the pipeline was created.
 internal_function void
-cgGlTextureStorage
+cgPipelineTeardownNoOp
 (
-    CG_DISPLAY *display,
-    GLenum      target,
-    GLenum      internal_format,
-    GLenum      data_type,
-    GLenum      min_filter,
-    GLenum      mag_filter,
-    size_t      width,
-    size_t      height,
-    size_t      slice_count,
-    size_t      max_levels
+    uintptr_t  ctx, 
+    uintptr_t  pipeline, 
+    void      *opaque
 )
 {
-    GLenum layout = cgGlPixelLayout(internal_format);
-
-    if (max_levels == 0)
-    {
-        // specify mipmaps all the way down to 1x1x1.
-        max_levels  = cgGlLevelCount(width, height, slice_count, max_levels);
-    }
-
-    // make sure that no PBO is bound as the unpack target.
-    // we don't want to copy data to the texture now.
-    glBindBuffer (GL_PIXEL_UNPACK_BUFFER, 0);
-
-    // specify the maximum number of mipmap levels.
-    if (target != GL_TEXTURE_RECTANGLE)
-    {
-        glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
-        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL,  GLint(max_levels - 1));
-    }
-    else
-    {
-        // rectangle textures don't support mipmaps.
-        glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
-        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL,  0);
-    }
-
-    // specify the filtering and wrapping modes.
-    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, min_filter);
-    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, mag_filter);
-    glTexParameteri(target, GL_TEXTURE_WRAP_S,     GL_CLAMP_TO_EDGE);
-    glTexParameteri(target, GL_TEXTURE_WRAP_T,     GL_CLAMP_TO_EDGE);
-    glTexParameteri(target, GL_TEXTURE_WRAP_R,     GL_CLAMP_TO_EDGE);
-
-    // use glTexImage to allocate storage for each mip-level of the texture.
-    switch (target)
-    {
-    case GL_TEXTURE_1D:
-        {
-            for (size_t lod = 0; lod < max_levels; ++lod)
-            {
-                size_t lw = cgGlLevelDimension(width, lod);
-                glTexImage1D(target, GLint(lod), internal_format, GLsizei(lw), 0, layout, data_type, NULL);
-            }
-        }
-        break;
+    UNREFERENCED_PARAMETER(ctx);
+    UNREFERENCED_PARAMETER(pipeline);
+    UNREFERENCED_PARAMETER(opaque);
+}
 
-    case GL_TEXTURE_1D_ARRAY:
-        {
-            // 1D array textures specify slice_count for height.
-            for (size_t lod = 0; lod < max_levels; ++lod)
-            {
-                size_t lw = cgGlLevelDimension(width, lod);
-                glTexImage2D(target, GLint(lod), internal_format, GLsizei(lw), GLsizei(slice_count), 0, layout, data_type, NULL);
-            }
-        }
-        break;
+/// @summary Convert the fixed-function state of a graphics pipeline description from CGFX enums to their OpenGL equivalents.
+/// @param create The graphics pipeline description.
+/// @param gp The graphics pipeline state to update.
+internal_function void
+cgGlPipelineFixedState
+(
+    cg_graphics_pipeline_t const *create, 
+    CG_GRAPHICS_PIPELINE         *gp
+)
+{
+    CG_DEPTH_STENCIL_STATE &dss = gp->DepthStencilState;
+    dss.DepthTestEnable     = cgGlBoolean(create->DepthStencilState.DepthTestEnable);
+    dss.DepthWriteEnable    = cgGlBoolean(create->DepthStencilState.DepthWriteEnable);
+    dss.DepthBoundsEnable   = cgGlBoolean(create->DepthStencilState.DepthBoundsEnable);
+    dss.DepthTestFunction   = cgGlCompareFunction(create->DepthStencilState.DepthTestFunction);
+    dss.DepthMin            = create->DepthStencilState.DepthMin;
+    dss.DepthMax            = create->DepthStencilState.DepthMax;
+    dss.StencilTestEnable   = cgGlBoolean(create->DepthStencilState.StencilTestEnable);
+    dss.StencilTestFunction = cgGlCompareFunction(create->DepthStencilState.StencilTestFunction);
+    dss.StencilFailOp       = cgGlStencilOp(create->DepthStencilState.StencilFailOp);
+    dss.StencilPassZPassOp  = cgGlStencilOp(create->DepthStencilState.StencilPassZPassOp);
+    dss.StencilPassZFailOp  = cgGlStencilOp(create->DepthStencilState.StencilPassZFailOp);
+    dss.StencilReadMask     = create->DepthStencilState.StencilReadMask;
+    dss.StencilWriteMask    = create->DepthStencilState.StencilWriteMask;
+    dss.StencilReference    = create->DepthStencilState.StencilReference;
 
-    case GL_TEXTURE_RECTANGLE:
-        {
-            // rectangle textures don't support mipmaps.
-            glTexImage2D(target, 0, internal_format, GLsizei(width), GLsizei(height), 0, layout, data_type, NULL);
-        }
-        break;
+    CG_RASTER_STATE        &rs = gp->RasterizerState;
+    rs.FillMode             = cgGlFillMode(create->RasterizerState.FillMode);
+    rs.CullMode             = cgGlCullMode(create->RasterizerState.CullMode);
+    rs.FrontFace            = cgGlWindingOrder(create->RasterizerState.FrontFace);
+    rs.DepthBias            = create->RasterizerState.DepthBias;
+    rs.SlopeScaledDepthBias = create->RasterizerState.SlopeScaledDepthBias;
 
-    case GL_TEXTURE_2D:
-    case GL_TEXTURE_CUBE_MAP_POSITIVE_X:
-    case GL_TEXTURE_CUBE_MAP_NEGATIVE_X:
-    case GL_TEXTURE_CUBE_MAP_POSITIVE_Y:
-    case GL_TEXTURE_CUBE_MAP_NEGATIVE_Y:
-    case GL_TEXTURE_CUBE_MAP_POSITIVE_Z:
-    case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z:
-        {
-            for (size_t lod = 0; lod < max_levels; ++lod)
-            {
-                size_t lw = cgGlLevelDimension(width,  lod);
-                size_t lh = cgGlLevelDimension(height, lod);
-                glTexImage2D(target, GLint(lod), internal_format, GLsizei(lw), GLsizei(lh), 0, layout, data_type, NULL);
-            }
-        }
-        break;
+    CG_BLEND_STATE         &bs = gp->BlendState;
+    bs.BlendEnabled         = cgGlBoolean(create->BlendState.BlendEnabled);
+    bs.SrcBlendColor        = cgGlBlendFactor(create->BlendState.SrcBlendColor);
+    bs.DstBlendColor        = cgGlBlendFactor(create->BlendState.DstBlendColor);
+    bs.ColorBlendFunction   = cgGlBlendFunction(create->BlendState.ColorBlendFunction);
+    bs.SrcBlendAlpha        = cgGlBlendFactor(create->BlendState.SrcBlendAlpha);
+    bs.DstBlendAlpha        = cgGlBlendFactor(create->BlendState.DstBlendAlpha);
+    bs.AlphaBlendFunction   = cgGlBlendFunction(create->BlendState.AlphaBlendFunction);
+    bs.ConstantRGBA[0]      = create->BlendState.ConstantRGBA[0];
+    bs.ConstantRGBA[1]      = create->BlendState.ConstantRGBA[1];
+    bs.ConstantRGBA[2]      = create->BlendState.ConstantRGBA[2];
+    bs.ConstantRGBA[3]      = create->BlendState.ConstantRGBA[3];
 
-    case GL_TEXTURE_2D_ARRAY:
-    case GL_TEXTURE_CUBE_MAP_ARRAY:
-        {
-            // 2D array texture specify slice_count as the number of
-            // items; the number of items is not decreased with LOD.
-            for (size_t lod = 0; lod < max_levels; ++lod)
-            {
-                size_t lw = cgGlLevelDimension(width,  lod);
-                size_t lh = cgGlLevelDimension(height, lod);
-                glTexImage3D(target, GLint(lod), internal_format, GLsizei(lw), GLsizei(lh), GLsizei(slice_count), 0, layout, data_type, NULL);
-            }
-        }
-        break;
+    gp->Topology            = cgGlPrimitiveTopology(create->PrimitiveType);
+}
 
-    case GL_TEXTURE_3D:
-        {
-            for (size_t lod = 0; lod < max_levels; ++lod)
-            {
-                size_t lw = cgGlLevelDimension(width,       lod);
-                size_t lh = cgGlLevelDimension(height,      lod);
-                size_t ls = cgGlLevelDimension(slice_count, lod);
-                glTexImage3D(target, GLint(lod), internal_format, GLsizei(lw), GLsizei(lh), GLsizei(ls), 0, layout, data_type, NULL);
-            }
-        }
-        break;
-    }
+/// @summary Compute the content hash used to share a compute pipeline between identical create calls. The key covers 
+/// the execution group, kernel program, kernel function name, opaque state and teardown callback.
+/// @param exec_group The handle of the execution group the pipeline is created for.
+/// @param create The compute pipeline description.
+/// @param opaque The opaque state supplied by the caller.
+/// @param teardown The teardown callback, after substituting cgPipelineTeardownNoOp for NULL.
+/// @return The 64-bit content hash.
+internal_function uint64_t
+cgComputePipelineKey
+(
+    cg_handle_t                  exec_group, 
+    cg_compute_pipeline_t const *create, 
+    void                        *opaque, 
+    cgPipelineTeardown_fn        teardown
+)
+{
+    uint64_t hash = CG_FNV1A_64_SEED;
+    hash = cgHashData  (hash, &exec_group           , sizeof(cg_handle_t));
+    hash = cgHashData  (hash, &create->KernelProgram, sizeof(cg_handle_t));
+    hash = cgHashString(hash,  create->KernelName);
+    hash = cgHashData  (hash, &opaque               , sizeof(void*));
+    hash = cgHashData  (hash, &teardown             , sizeof(cgPipelineTeardown_fn));
+    return hash;
 }
-/*
-/// @summary Copies pixel data from the device (GPU) to the host (CPU). The pixel data consists of the framebuffer contents, or the contents of a single mip-level of a texture image.
-/// @param display The display managing the rendering context.
-/// @param transfer An object describing the transfer operation to execute.
-internal_function void
-cgGlTransferPixelsDeviceToHost
+
+/// @summary Compute the content hash used to share a graphics pipeline between identical create calls. The key covers 
+/// the execution group, the shader kernels, the attribute and output bindings, all fixed-function state, the primitive 
+/// type, opaque state and teardown callback. Fields are hashed individually so structure padding is ignored.
+/// @param exec_group The handle of the execution group the pipeline is created for.
+/// @param create The graphics pipeline description.
+/// @param opaque The opaque state supplied by the caller.
+/// @param teardown The teardown callback, after substituting cgPipelineTeardownNoOp for NULL.
+/// @return The 64-bit content hash.
+internal_function uint64_t
+cgGraphicsPipelineKey
 (
-    CG_DISPLAY            *display,
-    CG_PIXEL_TRANSFER_D2H *transfer
+    cg_handle_t                   exec_group, 
+    cg_graphics_pipeline_t const *create, 
+    void                         *opaque, 
+    cgPipelineTeardown_fn         teardown
 )
 {
-    if (transfer->PackBuffer != 0)
-    {
-        // select the PBO as the target of the pack operation.
-        glBindBuffer(GL_PIXEL_PACK_BUFFER, transfer->PackBuffer);
-    }
-    else
+    cg_depth_stencil_state_t const &dss = create->DepthStencilState;
+    cg_raster_state_t        const &rs  = create->RasterizerState;
+    cg_blend_state_t         const &bs  = create->BlendState;
+    uint64_t                       hash = CG_FNV1A_64_SEED;
+    hash = cgHashData(hash, &exec_group            , sizeof(cg_handle_t));
+    hash = cgHashData(hash, &create->VertexShader  , sizeof(cg_handle_t));
+    hash = cgHashData(hash, &create->GeometryShader, sizeof(cg_handle_t));
+    hash = cgHashData(hash, &create->FragmentShader, sizeof(cg_handle_t));
+    hash = cgHashData(hash, &create->AttributeCount, sizeof(size_t));
+    for (size_t i = 0, n = create->AttributeCount; i < n; ++i)
     {
-        // select the client memory as the target of the pack operation.
-        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        hash = cgHashString(hash, create->AttributeBindings[i].Name);
+        hash = cgHashData  (hash, &create->AttributeBindings[i].Location, sizeof(unsigned int));
     }
-    if (transfer->TargetWidth != transfer->TransferWidth)
+    hash = cgHashData(hash, &create->OutputCount, sizeof(size_t));
+    for (size_t i = 0, n = create->OutputCount; i < n; ++i)
     {
-        // transferring into a sub-rectangle of the image; tell GL how
-        // many pixels are in a single row of the target image.
-        glPixelStorei(GL_PACK_ROW_LENGTH,   GLint(transfer->TargetWidth));
-        glPixelStorei(GL_PACK_IMAGE_HEIGHT, GLint(transfer->TargetHeight));
-    }
+        hash = cgHashString(hash, create->OutputBindings[i].Name);
+        hash = cgHashData  (hash, &create->OutputBindings[i].Location, sizeof(unsigned int));
+    }
+    hash = cgHashData(hash, &dss.DepthTestEnable     , sizeof(bool));
+    hash = cgHashData(hash, &dss.DepthWriteEnable    , sizeof(bool));
+    hash = cgHashData(hash, &dss.DepthBoundsEnable   , sizeof(bool));
+    hash = cgHashData(hash, &dss.DepthTestFunction   , sizeof(int));
+    hash = cgHashData(hash, &dss.DepthMin            , sizeof(float));
+    hash = cgHashData(hash, &dss.DepthMax            , sizeof(float));
+    hash = cgHashData(hash, &dss.StencilTestEnable   , sizeof(bool));
+    hash = cgHashData(hash, &dss.StencilTestFunction , sizeof(int));
+    hash = cgHashData(hash, &dss.StencilFailOp       , sizeof(int));
+    hash = cgHashData(hash, &dss.StencilPassZPassOp  , sizeof(int));
+    hash = cgHashData(hash, &dss.StencilPassZFailOp  , sizeof(int));
+    hash = cgHashData(hash, &dss.StencilReadMask     , sizeof(uint8_t));
+    hash = cgHashData(hash, &dss.StencilWriteMask    , sizeof(uint8_t));
+    hash = cgHashData(hash, &dss.StencilReference    , sizeof(uint8_t));
+    hash = cgHashData(hash, &rs.FillMode             , sizeof(int));
+    hash = cgHashData(hash, &rs.CullMode             , sizeof(int));
+    hash = cgHashData(hash, &rs.FrontFace            , sizeof(int));
+    hash = cgHashData(hash, &rs.DepthBias            , sizeof(int));
+    hash = cgHashData(hash, &rs.SlopeScaledDepthBias , sizeof(float));
+    hash = cgHashData(hash, &bs.BlendEnabled         , sizeof(bool));
+    hash = cgHashData(hash, &bs.SrcBlendColor        , sizeof(int));
+    hash = cgHashData(hash, &bs.DstBlendColor        , sizeof(int));
+    hash = cgHashData(hash, &bs.ColorBlendFunction   , sizeof(int));
+    hash = cgHashData(hash, &bs.SrcBlendAlpha        , sizeof(int));
+    hash = cgHashData(hash, &bs.DstBlendAlpha        , sizeof(int));
+    hash = cgHashData(hash, &bs.AlphaBlendFunction   , sizeof(int));
+    hash = cgHashData(hash,  bs.ConstantRGBA         , sizeof(float) * 4);
+    hash = cgHashData(hash, &create->PrimitiveType   , sizeof(int));
+    hash = cgHashData(hash, &opaque                  , sizeof(void*));
+    hash = cgHashData(hash, &teardown                , sizeof(cgPipelineTeardown_fn));
+    return hash;
+}
 
-    // perform the setup necessary to have GL calculate any byte offsets.
-    if (transfer->TargetX != 0) glPixelStorei(GL_PACK_SKIP_PIXELS, GLint(transfer->TargetX));
-    if (transfer->TargetY != 0) glPixelStorei(GL_PACK_SKIP_ROWS,   GLint(transfer->TargetY));
-    if (transfer->TargetZ != 0) glPixelStorei(GL_PACK_SKIP_IMAGES, GLint(transfer->TargetZ));
+/// @summary Determine whether an existing compute pipeline was created from a description. Used to confirm a content hash match.
+/// @param pipe The existing compute pipeline.
+/// @param create The compute pipeline description.
+/// @return true if the pipeline was created from the same kernel program and function name.
+internal_function bool
+cgComputePipelineMatches
+(
+    CG_PIPELINE                 *pipe, 
+    cg_compute_pipeline_t const *create
+)
+{
+    CG_COMPUTE_PIPELINE *cp = &pipe->Compute;
+    return cp->KernelProgram == create->KernelProgram && strcmp(cp->KernelName, create->KernelName) == 0;
+}
 
-    if (cgGlBytesPerBlock(transfer->Format) > 0)
-    {
-        // the texture image is compressed; use glGetCompressedTexImage.
-        switch (transfer->Target)
-        {
-            case GL_TEXTURE_1D:
-            case GL_TEXTURE_2D:
-            case GL_TEXTURE_3D:
-            case GL_TEXTURE_CUBE_MAP_ARRAY:
-            case GL_TEXTURE_CUBE_MAP_POSITIVE_X:
-            case GL_TEXTURE_CUBE_MAP_NEGATIVE_X:
-            case GL_TEXTURE_CUBE_MAP_POSITIVE_Y:
-            case GL_TEXTURE_CUBE_MAP_NEGATIVE_Y:
-            case GL_TEXTURE_CUBE_MAP_POSITIVE_Z:
-            case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z:
-                {
-                    glGetCompressedTexImage(transfer->Target, GLint(transfer->SourceIndex), transfer->TransferBuffer);
-                }
-                break;
-        }
+/// @summary Determine whether an existing graphics pipeline was created from a description. Used to confirm a content hash 
+/// match. Attribute and output bindings are checked against the locations assigned in the linked program, so bindings of 
+/// variables the program does not use are ignored. The rendering context of the pipeline must be current.
+/// @param pipe The existing graphics pipeline.
+/// @param create The graphics pipeline description.
+/// @return true if the pipeline was linked from the same shader kernels with the same bindings and fixed-function state.
+internal_function bool
+cgGraphicsPipelineMatches
+(
+    CG_PIPELINE                  *pipe, 
+    cg_graphics_pipeline_t const *create
+)
+{
+    CG_GRAPHICS_PIPELINE *gp      = &pipe->Graphics;
+    CG_DISPLAY           *display =  gp->AttachedDisplay;
+    CG_GRAPHICS_PIPELINE  state;
+    if (gp->VertexShader   != create->VertexShader   || 
+        gp->GeometryShader != create->GeometryShader || 
+        gp->FragmentShader != create->FragmentShader)
+    {   // the program was linked from different shader kernels.
+        return false;
     }
-    else
+    // both sets of state are converted into zero-filled structures, so they can be compared directly.
+    memset(&state, 0, sizeof(CG_GRAPHICS_PIPELINE));
+    cgGlPipelineFixedState(create, &state);
+    if (memcmp(&state.DepthStencilState, &gp->DepthStencilState, sizeof(CG_DEPTH_STENCIL_STATE)) != 0 || 
+        memcmp(&state.RasterizerState  , &gp->RasterizerState  , sizeof(CG_RASTER_STATE)) != 0 || 
+        memcmp(&state.BlendState       , &gp->BlendState       , sizeof(CG_BLEND_STATE)) != 0 || 
+        state.Topology != gp->Topology)
+    {   // the fixed-function state differs.
+        return false;
+    }
+    for (size_t i = 0, n = create->AttributeCount; i < n; ++i)
     {
-        // the image is not compressed; read the framebuffer with
-        // glReadPixels or the texture image using glGetTexImage.
-        switch (transfer->Target)
-        {
-            case GL_READ_FRAMEBUFFER:
-                {
-                    // remember, x and y identify the lower-left corner.
-                    glReadPixels(GLint(transfer->TransferX), GLint(transfer->TransferY), GLint(transfer->TransferWidth), GLint(transfer->TransferHeight), transfer->Layout, transfer->DataType, transfer->TransferBuffer);
-                }
-                break;
-
-            case GL_TEXTURE_1D:
-            case GL_TEXTURE_2D:
-            case GL_TEXTURE_3D:
-            case GL_TEXTURE_1D_ARRAY:
-            case GL_TEXTURE_2D_ARRAY:
-            case GL_TEXTURE_RECTANGLE:
-            case GL_TEXTURE_CUBE_MAP_ARRAY:
-            case GL_TEXTURE_CUBE_MAP_POSITIVE_X:
-            case GL_TEXTURE_CUBE_MAP_NEGATIVE_X:
-            case GL_TEXTURE_CUBE_MAP_POSITIVE_Y:
-            case GL_TEXTURE_CUBE_MAP_NEGATIVE_Y:
-            case GL_TEXTURE_CUBE_MAP_POSITIVE_Z:
-            case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z:
-                {
-                    glGetTexImage(transfer->Target, GLint(transfer->SourceIndex), transfer->Layout, transfer->DataType, transfer->TransferBuffer);
-                }
-                break;
-        }
+        cg_shader_binding_t const &binding = create->AttributeBindings[i];
+        GLint location = glGetAttribLocation(gp->ShaderProgram.Program, (GLchar const*) binding.Name);
+        if (location >= 0 && GLuint(location) != GLuint(binding.Location))
+            return false;
     }
-
-    // restore the pack state values to their defaults.
-    if (transfer->PackBuffer  != 0)
-        glBindBuffer(GL_PIXEL_PACK_BUFFER,  0);
-    if (transfer->TargetWidth != transfer->TransferWidth)
+    for (size_t i = 0, n = create->OutputCount; i < n; ++i)
     {
-        glPixelStorei(GL_PACK_ROW_LENGTH,   0);
-        glPixelStorei(GL_PACK_IMAGE_HEIGHT, 0);
+        cg_shader_binding_t const &binding = create->OutputBindings[i];
+        GLint location = glGetFragDataLocation(gp->ShaderProgram.Program, (GLchar const*) binding.Name);
+        if (location >= 0 && GLuint(location) != GLuint(binding.Location))
+            return false;
     }
-    if (transfer->TargetX != 0) glPixelStorei(GL_PACK_SKIP_PIXELS,  0);
-    if (transfer->TargetY != 0) glPixelStorei(GL_PACK_SKIP_ROWS,    0);
-    if (transfer->TargetZ != 0) glPixelStorei(GL_PACK_SKIP_IMAGES,  0);
+    return true;
 }
 
-/// @summary Copies pixel data from the host (CPU) to the device (GPU). The pixel data is copied to a single mip-level of a texture image.
-/// @param display The display managing the rendering context.
-/// @param transfer An object describing the transfer operation to execute.
-internal_function void
-cgGlPixelTransferHostToDevice
+/// @summary Search for a live pipeline object created from an identical description. If one is found, its reference 
+/// count is incremented and its handle is returned; each create call must be balanced by a call to cgDeleteObject.
+/// Pipelines whose per-pipeline state has been changed, for example by cgSetComputePipelineAutotune, are not returned.
+/// @param ctx The CGFX context that owns the pipeline table.
+/// @param pipeline_type One of cg_pipeline_type_e specifying the type of pipeline to find.
+/// @param exec_group The handle of the execution group the pipeline is created for.
+/// @param create The cg_compute_pipeline_t or cg_graphics_pipeline_t description, depending on @a pipeline_type.
+/// @param content_hash The content hash computed by cgComputePipelineKey or cgGraphicsPipelineKey.
+/// @param opaque The opaque state supplied by the caller.
+/// @param teardown The teardown callback, after substituting cgPipelineTeardownNoOp for NULL.
+/// @return The handle of the existing pipeline, or CG_INVALID_HANDLE.
+internal_function cg_handle_t
+cgFindSharedPipeline
 (
-    CG_DISPLAY            *display,
-    CG_PIXEL_TRANSFER_H2D *transfer
+    CG_CONTEXT            *ctx, 
+    int                    pipeline_type, 
+    cg_handle_t            exec_group, 
+    void const            *create, 
+    uint64_t               content_hash, 
+    void                  *opaque, 
+    cgPipelineTeardown_fn  teardown
 )
 {
-    if (transfer->UnpackBuffer != 0)
-    {   // select the PBO as the source of the unpack operation.
-        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, transfer->UnpackBuffer);
-    }
-    else
-    {   // select the client memory as the source of the unpack operation.
-        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
-    }
-    if (transfer->SourceWidth != transfer->TransferWidth)
-    {   // transferring a sub-rectangle of the image; tell GL how many
-        // pixels are in a single row of the source image.
-        glPixelStorei(GL_UNPACK_ROW_LENGTH, GLint(transfer->SourceWidth));
+    for (size_t i = 0, n = ctx->PipelineTable.ObjectCount; i < n; ++i)
+    {
+        CG_PIPELINE *pipe = &ctx->PipelineTable.Objects[i];
+        if (pipe->ContentHash  != content_hash  || 
+            pipe->PipelineType != pipeline_type || 
+            pipe->ExecGroup    != exec_group    || 
+            pipe->PrivateState != opaque        || 
+            pipe->DestroyState != teardown      || 
+            pipe->Shareable    == false)
+        {   // the pipeline cannot be shared with this create call.
+            continue;
+        }
+        if (pipeline_type == CG_PIPELINE_TYPE_COMPUTE && !cgComputePipelineMatches(pipe, (cg_compute_pipeline_t const*) create))
+            continue; // hash collision.
+        if (pipeline_type == CG_PIPELINE_TYPE_GRAPHICS && !cgGraphicsPipelineMatches(pipe, (cg_graphics_pipeline_t const*) create))
+            continue; // hash collision.
+        // return the existing pipeline and its compiled program.
+        pipe->ReferenceCount++;
+        return cgMakeHandle(pipe->ObjectId, CG_OBJECT_PIPELINE, CG_PIPELINE_TABLE_ID);
     }
-    if (transfer->TransferSlices > 1)
-    {   // transferring an image volume; tell GL how many rows per-slice
-        // in the source image, since we may only be transferring a sub-volume.
-        glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, GLint(transfer->SourceHeight));
+    return CG_INVALID_HANDLE;
+}
+
+/// @summary Implements the DEVICE_FENCE command, inserting a fence in an in-order graphics queue or an out-of-order compute or transfer queue.
+/// The fence ensures that some or all of the commands inserted into the queue prior to the fence have completed before executing commands enqueued after the fence.
+/// @param ctx The CGFX context returned by cgEnumerateDevices.
+/// @param queue The command queue into which the fence command is being inserted.
+/// @param cmdbuf The command buffer defining the fence command.
+/// @param cmd The fence command and any associated data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_INVALID_STATE, CG_BAD_CLCONTEXT, CG_UNSUPPORTED, CG_OUT_OF_MEMORY, CG_OUT_OF_OBJECTS or CG_ERROR.
+internal_function int
+cgExecuteDeviceFence
+(
+    CG_CONTEXT    *ctx, 
+    CG_QUEUE      *queue, 
+    CG_CMD_BUFFER *cmdbuf, 
+    cg_command_t  *cmd
+)
+{   UNREFERENCED_PARAMETER(cmdbuf);
+    // proceed with command execution. a fence can either be a graphics 
+    // fence or a compute/transfer fence. a graphics fence could be linked
+    // to an OpenCL event from a clReleaseGLObjects command. since graphics
+    // queues are always in-order, a fence blocks execution until all prior 
+    // commands have completed. a compute or transfer queue fence, on the 
+    // other hand, supports out-of-order execution and can support waiting 
+    // for a specific set of events to become signaled.
+    cg_device_fence_cmd_data_t *ddp = (cg_device_fence_cmd_data_t*) cmd->Data;
+    CG_FENCE *fence = cgObjectTableGet(&ctx->FenceTable, ddp->FenceObject);
+    if (fence == NULL || (queue->QueueType & fence->QueueType) == 0)
+    {   // invalid fence object, or queue type doesn't match fence.
+        return CG_INVALID_VALUE;
     }
 
-    // perform the setup necessary to have GL calculate any byte offsets.
-    if (transfer->SourceX != 0) glPixelStorei(GL_UNPACK_SKIP_PIXELS, GLint(transfer->SourceX));
-    if (transfer->SourceY != 0) glPixelStorei(GL_UNPACK_SKIP_ROWS,   GLint(transfer->SourceY));
-    if (transfer->SourceZ != 0) glPixelStorei(GL_UNPACK_SKIP_IMAGES, GLint(transfer->SourceZ));
+    if (fence->QueueType == CG_QUEUE_TYPE_GRAPHICS)
+    {   // create and enqueue an OpenGL fence sync object.
+        CG_DISPLAY *display = fence->AttachedDisplay;
+        GLsync      sync    = NULL;
 
-    if (cgGlBytesPerBlock(transfer->Format) > 0)
-    {
-        // the image is compressed; use glCompressedTexSubImage to transfer.
-        switch (transfer->Target)
+        // if there's an existing sync object associated with the fence, delete it.
+        if (fence->GraphicsFence != NULL)
         {
-            case GL_TEXTURE_1D:
-                {
-                    glCompressedTexSubImage1D(transfer->Target, GLint(transfer->TargetIndex), GLint(transfer->TargetX), GLsizei(transfer->TransferWidth), transfer->Format, GLsizei(transfer->TransferSize), transfer->TransferBuffer);
-                }
-                break;
+            glDeleteSync(fence->GraphicsFence);
+            fence->GraphicsFence  = NULL;
+        }
 
-            case GL_TEXTURE_2D:
-            case GL_TEXTURE_1D_ARRAY:
-            case GL_TEXTURE_RECTANGLE:
-            case GL_TEXTURE_CUBE_MAP_POSITIVE_X:
-            case GL_TEXTURE_CUBE_MAP_NEGATIVE_X:
-            case GL_TEXTURE_CUBE_MAP_POSITIVE_Y:
-            case GL_TEXTURE_CUBE_MAP_NEGATIVE_Y:
-            case GL_TEXTURE_CUBE_MAP_POSITIVE_Z:
-            case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z:
+        // generate a new sync object and insert the fence command in the OpenGL context's command queue.
+        if (fence->LinkedEvent != CG_INVALID_HANDLE)
+        {   // the fence is linked to an OpenCL event, so use GL_ARB_cl_event.
+            CG_EVENT *event = cgObjectTableGet(&ctx->EventTable, fence->LinkedEvent);
+            if (event == NULL || event->ComputeEvent == NULL)
+            {   // the compute or transfer queue command associated with the event hasn't
+                // yet been submitted to a command queue, so the operation is invalid.
+                return CG_INVALID_STATE;
+            }
+            if (GLEW_ARB_cl_event)
+            {   // create the OpenGL sync object and insert it into the command stream.
+                if ((sync = glCreateSyncFromCLeventARB(queue->ComputeContext, event->ComputeEvent, 0)) == NULL)
                 {
-                    glCompressedTexSubImage2D(transfer->Target, GLint(transfer->TargetIndex), GLint(transfer->TargetX), GLint(transfer->TargetY), GLsizei(transfer->TransferWidth), GLsizei(transfer->TransferHeight), transfer->Format, GLsizei(transfer->TransferSize), transfer->TransferBuffer);
+                    GLenum  glerr = glGetError();
+                    switch (glerr)
+                    {
+                    case GL_INVALID_VALUE    : return CG_BAD_CLCONTEXT;
+                    case GL_INVALID_OPERATION: return CG_INVALID_STATE;
+                    default: break;
+                    }
+                    return CG_ERROR;
                 }
-                break;
-
-            case GL_TEXTURE_3D:
-            case GL_TEXTURE_2D_ARRAY:
-            case GL_TEXTURE_CUBE_MAP_ARRAY:
+            }
+            else
+            {   // GL_ARB_cl_event is not supported by the runtime. fail.
+                return CG_UNSUPPORTED;
+            }
+        }
+        else
+        {   // the fence is not linked to an OpenCL event.
+            if ((sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)) == NULL)
+            {
+                GLenum  glerr = glGetError();
+                switch (glerr)
                 {
-                    glCompressedTexSubImage3D(transfer->Target, GLint(transfer->TargetIndex), GLint(transfer->TargetX), GLint(transfer->TargetY), GLint(transfer->TargetZ), GLsizei(transfer->TransferWidth), GLsizei(transfer->TransferHeight), GLsizei(transfer->TransferSlices), transfer->Format, GLsizei(transfer->TransferSize), transfer->TransferBuffer);
+                case GL_INVALID_ENUM : return CG_INVALID_VALUE;
+                case GL_INVALID_VALUE: return CG_INVALID_VALUE;
+                default              : break;
                 }
-                break;
+                return CG_ERROR;
+            }
         }
+        // insert a wait command to act as a barrier in the GPU command queue.
+        // issue a glFlush prior to the barrier to ensure that the sync object
+        // has been flushed to the GPU command queue by the driver.
+        glFlush();  glWaitSync(sync, 0, GL_TIMEOUT_IGNORED);
+        fence->GraphicsFence = sync;
+        return cgSetupCompleteEvent(ctx, queue, ddp->CompleteEvent, NULL, sync, CG_SUCCESS);
     }
     else
-    {
-        // the image is not compressed, use glTexSubImage to transfer data.
-        switch (transfer->Target)
+    {   // enqueue an OpenCL barrier. there could be a wait list.
+        int       result     = CG_SUCCESS;
+        cl_int    clres      = CL_SUCCESS;
+        cl_uint   wait_count = 0;
+        cl_event  cl_fence   = NULL;
+        cl_event *wait_list  = NULL;
+        bool     *wait_free  = NULL;
+        cl_event  wait_stack[16];
+        bool      free_stack[16];
+
+        // if there's an existing sync object associated with this fence, delete it.
+        if (fence->ComputeFence != NULL)
         {
-            case GL_TEXTURE_1D:
-                {
-                    glTexSubImage1D(transfer->Target, GLint(transfer->TargetIndex), GLint(transfer->TargetX), GLsizei(transfer->TransferWidth), transfer->Format, transfer->DataType, transfer->TransferBuffer);
-                }
-                break;
+            clReleaseEvent(fence->ComputeFence);
+            fence->ComputeFence  = NULL;
+        }
 
-            case GL_TEXTURE_2D:
-            case GL_TEXTURE_1D_ARRAY:
-            case GL_TEXTURE_RECTANGLE:
-            case GL_TEXTURE_CUBE_MAP_POSITIVE_X:
-            case GL_TEXTURE_CUBE_MAP_NEGATIVE_X:
-            case GL_TEXTURE_CUBE_MAP_POSITIVE_Y:
-            case GL_TEXTURE_CUBE_MAP_NEGATIVE_Y:
-            case GL_TEXTURE_CUBE_MAP_POSITIVE_Z:
-            case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z:
-                {
-                    glTexSubImage2D(transfer->Target, GLint(transfer->TargetIndex), GLint(transfer->TargetX), GLint(transfer->TargetY), GLsizei(transfer->TransferWidth), GLsizei(transfer->TransferHeight), transfer->Format, transfer->DataType, transfer->TransferBuffer);
+        // generate the event wait list. it's possible that there is no wait list, 
+        // in which case the fence waits for all prior commands in the queue to be
+        // completed, or it's possible that a specific list of events is specified 
+        // to satisfy the barrier condition.
+        if (ddp->WaitListCount == 0)
+        {   // simple case, this is a fence for all prior commands in the queue.
+            wait_count = 0; wait_list = NULL;
+        }
+        else
+        {   // there is a wait list involved. convert the wait handles into 
+            // an array of cl_event instances to wait on. in most cases we 
+            // should just be able to use stack memory.
+            if (ddp->WaitListCount <= 16)
+            {   // just use the stack arrays; no dynamic allocation.
+                wait_count = 0;
+                wait_list  = wait_stack;
+                wait_free  = free_stack;
+            }
+            else
+            {   // need to wait on many individual events. allocate temporary memory.
+                wait_list  = (cl_event*) cgAllocateHostMemory(&ctx->HostAllocator, ddp->WaitListCount * sizeof(cl_event), 1, CG_ALLOCATION_TYPE_TEMP);
+                wait_free  = (bool    *) cgAllocateHostMemory(&ctx->HostAllocator, ddp->WaitListCount * sizeof(bool)    , 1, CG_ALLOCATION_TYPE_TEMP);
+                if (wait_list == NULL || wait_free == NULL)
+                {   // unable to allocate the required memory.
+                    result = CG_OUT_OF_MEMORY;
+                    goto opencl_cleanup;
                 }
-                break;
-
-            case GL_TEXTURE_3D:
-            case GL_TEXTURE_2D_ARRAY:
-            case GL_TEXTURE_CUBE_MAP_ARRAY:
-                {
-                    glTexSubImage3D(transfer->Target, GLint(transfer->TargetIndex), GLint(transfer->TargetX), GLint(transfer->TargetY), GLint(transfer->TargetZ), GLsizei(transfer->TransferWidth), GLsizei(transfer->TransferHeight), GLsizei(transfer->TransferSlices), transfer->Format, transfer->DataType, transfer->TransferBuffer);
+            }
+            for (size_t i = 0, n = ddp->WaitListCount; i < n; ++i)
+            {
+                if ((result = cgGetWaitEvent(ctx, queue, ddp->WaitList[i], wait_list, wait_count, cl_uint(n), wait_free[wait_count])) != CG_SUCCESS)
+                {   // unable to retrieve the OpenCL event object to wait on.
+                    goto opencl_cleanup;
                 }
-                break;
+            }
         }
-    }
 
-    // restore the unpack state values to their defaults.
-    if (transfer->UnpackBuffer  != 0)
-        glBindBuffer(GL_PIXEL_UNPACK_BUFFER,  0);
-    if (transfer->SourceWidth   != transfer->TransferWidth)
-        glPixelStorei(GL_UNPACK_ROW_LENGTH,   0);
-    if (transfer->TransferSlices > 1)
-        glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, 0);
-    if (transfer->SourceX != 0)
-        glPixelStorei(GL_UNPACK_SKIP_PIXELS,  0);
-    if (transfer->SourceY != 0)
-        glPixelStorei(GL_UNPACK_SKIP_ROWS,    0);
-    if (transfer->SourceZ != 0)
-        glPixelStorei(GL_UNPACK_SKIP_IMAGES,  0);
-}*/
+        // insert the barrier command in the OpenCL command queue.
+        if ((clres = clEnqueueBarrierWithWaitList(queue->CommandQueue, wait_count, wait_list, &cl_fence)) != CL_SUCCESS)
+        {   
+            switch (clres)
+            {
+            case CL_INVALID_COMMAND_QUEUE  : result = CG_BAD_CLCONTEXT; break;
+            case CL_INVALID_EVENT_WAIT_LIST: result = CG_INVALID_VALUE; break;
+            case CL_OUT_OF_RESOURCES       : result = CG_OUT_OF_MEMORY; break;
+            case CL_OUT_OF_HOST_MEMORY     : result = CG_OUT_OF_MEMORY; break;
+            default                        : result = CG_ERROR;         break;
+            }
+            goto opencl_cleanup;
+        }
+        fence->ComputeFence = cl_fence;
+        result = CG_SUCCESS;
+        /* fall through to opencl_cleanup */
 
-/// @summary Convert a CGFX blend function value to the corresponding OpenGL enum.
-/// @param factor The CGFX blend function value, one of cg_blend_function_e.
-/// @return The corresponding OpenGL enum value, or GL_INVALID_ENUM.
-internal_function GLenum
-cgGlBlendFunction
-(
-    int func
-)
-{
-    switch (func)
-    {
-        case CG_BLEND_FUNCTION_ADD             : return GL_FUNC_ADD;
-        case CG_BLEND_FUNCTION_SUBTRACT        : return GL_FUNC_SUBTRACT;
-        case CG_BLEND_FUNCTION_REVERSE_SUBTRACT: return GL_FUNC_REVERSE_SUBTRACT;
-        case CG_BLEND_FUNCTION_MIN             : return GL_MIN;
-        case CG_BLEND_FUNCTION_MAX             : return GL_MAX;
-        default: break;
+    opencl_cleanup:
+        for (size_t wait_i = 0, wait_n = wait_count; wait_i < wait_n; ++wait_i)
+        {   // free temporary event objects.
+            if (wait_free[wait_i])
+                clReleaseEvent(wait_list[wait_i]);
+        }
+        if (wait_list != &wait_stack[0])
+        {   // free the temporary wait list memory.
+            if (wait_free != NULL) cgFreeHostMemory(&ctx->HostAllocator, wait_free, ddp->WaitListCount * sizeof(bool)    , 1, CG_ALLOCATION_TYPE_TEMP);
+            if (wait_list != NULL) cgFreeHostMemory(&ctx->HostAllocator, wait_list, ddp->WaitListCount * sizeof(cl_event), 1, CG_ALLOCATION_TYPE_TEMP);
+        }
+        return cgSetupCompleteEvent(ctx, queue, ddp->CompleteEvent, cl_fence, NULL, result);
     }
-    return GL_INVALID_ENUM;
 }
 
-/// @summary Convert a CGFX blend factor value to the corresponding OpenGL enum.
-/// @param factor The CGFX blend factor value, one of cg_blend_factor_e.
-/// @return The corresponding OpenGL enum value, or GL_INVALID_ENUM.
-internal_function GLenum
-cgGlBlendFactor
+/// @summary Implements the PIPELINE_DISPATCH command for a compute command queue.
+/// @param ctx The CGFX context returned by cgEnumerateDevices.
+/// @param queue The command queue into which the command is being inserted.
+/// @param cmdbuf The command buffer defining the command.
+/// @param cmd The command and any associated data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_INVALID_STATE, CG_BAD_CLCONTEXT, CG_UNSUPPORTED, CG_OUT_OF_MEMORY, CG_OUT_OF_OBJECTS or CG_ERROR.
+internal_function int
+cgExecuteComputePipelineDispatch
 (
-    int factor
+    CG_CONTEXT    *ctx, 
+    CG_QUEUE      *queue, 
+    CG_CMD_BUFFER *cmdbuf, 
+    cg_command_t  *cmd
 )
 {
-    switch (factor)
-    {
-        case CG_BLEND_FACTOR_ZERO           : return GL_ZERO;
-        case CG_BLEND_FACTOR_ONE            : return GL_ONE;
-        case CG_BLEND_FACTOR_SRC_COLOR      : return GL_SRC_COLOR;
-        case CG_BLEND_FACTOR_INV_SRC_COLOR  : return GL_ONE_MINUS_SRC_COLOR;
-        case CG_BLEND_FACTOR_DST_COLOR      : return GL_DST_COLOR;
-        case CG_BLEND_FACTOR_INV_DST_COLOR  : return GL_ONE_MINUS_DST_COLOR;
-        case CG_BLEND_FACTOR_SRC_ALPHA      : return GL_SRC_ALPHA;
-        case CG_BLEND_FACTOR_INV_SRC_ALPHA  : return GL_ONE_MINUS_SRC_ALPHA;
-        case CG_BLEND_FACTOR_DST_ALPHA      : return GL_DST_ALPHA;
-        case CG_BLEND_FACTOR_INV_DST_ALPHA  : return GL_ONE_MINUS_DST_ALPHA;
-        case CG_BLEND_FACTOR_CONST_COLOR    : return GL_CONSTANT_COLOR;
-        case CG_BLEND_FACTOR_INV_CONST_COLOR: return GL_ONE_MINUS_CONSTANT_COLOR;
-        case CG_BLEND_FACTOR_CONST_ALPHA    : return GL_CONSTANT_ALPHA;
-        case CG_BLEND_FACTOR_INV_CONST_ALPHA: return GL_ONE_MINUS_CONSTANT_ALPHA;
-        case CG_BLEND_FACTOR_SRC_ALPHA_SAT  : return GL_SRC_ALPHA_SATURATE;
-        default: break;
+    CG_PIPELINE         *pipeline =  NULL;
+    cg_pipeline_cmd_base_t *cdata = (cg_pipeline_cmd_base_t*) cmd->Data;
+    cgPipelineExecute_fn    cfunc =  cgGetComputePipelineCallback(cdata->PipelineId);
+    int                    status =  CG_SUCCESS;
+    if (cfunc == NULL)
+    {   // this pipeline hasn't been registered yet.
+        return CG_INVALID_VALUE;
     }
-    return GL_INVALID_ENUM;
-}
-
-/// @summary Convert a CGFX comparison function value to the corresponding OpenGL enum.
-/// @param mode The CGFX comparison function, one of cg_compare_function_e.
-/// @return The corresponding OpenGL enum value, or GL_INVALID_ENUM.
-internal_function GLenum
-cgGlCompareFunction
-(
-    int func
-)
-{
-    switch (func)
-    {
-        case CG_COMPARE_NEVER        : return GL_NEVER;
-        case CG_COMPARE_LESS         : return GL_LESS;
-        case CG_COMPARE_EQUAL        : return GL_EQUAL;
-        case CG_COMPARE_LESS_EQUAL   : return GL_LEQUAL;
-        case CG_COMPARE_GREATER      : return GL_GREATER;
-        case CG_COMPARE_NOT_EQUAL    : return GL_NOTEQUAL;
-        case CG_COMPARE_GREATER_EQUAL: return GL_GEQUAL;
-        case CG_COMPARE_ALWAYS       : return GL_ALWAYS;
-        default: break;
+    if ((pipeline = cgObjectTableGet(&ctx->PipelineTable, cdata->Pipeline)) == NULL)
+    {   // the pipeline ID is valid, but the pipeline state handle is not valid.
+        return CG_INVALID_VALUE;
     }
-    return GL_INVALID_ENUM;
-}
-
-/// @summary Convert a CGFX fill mode value to the corresponding OpenGL enum.
-/// @param mode The CGFX fill mode, one of cg_fill_mode_e.
-/// @return The corresponding OpenGL enum value, or GL_INVALID_ENUM.
-internal_function GLenum
-cgGlFillMode
-(
-    int mode
-)
-{
-    switch (mode)
-    {
-        case CG_FILL_SOLID    : return GL_FILL;
-        case CG_FILL_WIREFRAME: return GL_LINE;
-        default: break;
+    if (pipeline->PipelineType == CG_PIPELINE_TYPE_COMPUTE && (status = cgResolveComputePipeline(ctx, &pipeline->Compute)) != CG_SUCCESS)
+    {   // the kernel program is still building (CG_NOT_READY) or failed to build.
+        return status;
     }
-    return GL_INVALID_ENUM;
+    return cfunc(ctx, queue, cmdbuf, pipeline, cmd);
 }
 
-/// @summary Convert a CGFX cull mode value to the corresponding OpenGL enum.
-/// @param mode The CGFX culling mode, one of cg_cull_mode_e.
-/// @return The corresponding OpenGL enum value, or GL_INVALID_ENUM.
-internal_function GLenum
-cgGlCullMode
+/// @summary Implements the PIPELINE_DISPATCH command for a graphics command queue.
+/// @param ctx The CGFX context returned by cgEnumerateDevices.
+/// @param queue The command queue into which the command is being inserted.
+/// @param cmdbuf The command buffer defining the command.
+/// @param cmd The command and any associated data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_INVALID_STATE, CG_BAD_CLCONTEXT, CG_UNSUPPORTED, CG_OUT_OF_MEMORY, CG_OUT_OF_OBJECTS or CG_ERROR.
+internal_function int
+cgExecuteGraphicsPipelineDispatch
 (
-    int mode
+    CG_CONTEXT    *ctx, 
+    CG_QUEUE      *queue, 
+    CG_CMD_BUFFER *cmdbuf, 
+    cg_command_t  *cmd
 )
 {
-    switch (mode)
-    {
-        case CG_CULL_NONE : return GL_NONE;
-        case CG_CULL_FRONT: return GL_FRONT;
-        case CG_CULL_BACK : return GL_BACK;
-        default: break;
+    CG_PIPELINE         *pipeline =  NULL;
+    cg_pipeline_cmd_base_t *cdata = (cg_pipeline_cmd_base_t*) cmd->Data;
+    cgPipelineExecute_fn    cfunc =  cgGetGraphicsPipelineCallback(cdata->PipelineId);
+    if (cfunc == NULL)
+    {   // this pipeline hasn't been registered yet.
+        return CG_INVALID_VALUE;
     }
-    return GL_INVALID_ENUM;
+    if ((pipeline = cgObjectTableGet(&ctx->PipelineTable, cdata->Pipeline)) == NULL)
+    {   // the pipeline ID is valid, but the pipeline state handle is not valid.
+        return CG_INVALID_VALUE;
+    }
+    return cfunc(ctx, queue, cmdbuf, pipeline, cmd);
 }
 
-/// @summary Convert a CGFX winding order value to the corresponding OpenGL enum.
-/// @param winding The CGFX winding order value, one of cg_winding_e.
-/// @return The corresponding OpenGL enum value, or GL_INVALID_ENUM.
-internal_function GLenum
-cgGlWindingOrder
+/// @summary Implements the COPY_BUFFER command, which copies data from one buffer to another.
+/// @param ctx The CGFX context returned by cgEnumerateDevices.
+/// @param queue The command queue into which the command is being inserted.
+/// @param cmdbuf The command buffer defining the command.
+/// @param cmd The command and any associated data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_INVALID_STATE, CG_BAD_CLCONTEXT, CG_UNSUPPORTED, CG_OUT_OF_MEMORY, CG_OUT_OF_OBJECTS or CG_ERROR.
+internal_function int
+cgExecuteCopyBufferRegion
 (
-    int winding
+    CG_CONTEXT    *ctx, 
+    CG_QUEUE      *queue, 
+    CG_CMD_BUFFER *cmdbuf, 
+    cg_command_t  *cmd
 )
-{
-    switch (winding)
+{   UNREFERENCED_PARAMETER(cmdbuf);
+    cg_copy_buffer_cmd_t *ddp  = (cg_copy_buffer_cmd_t*) cmd->Data;
+    CG_BUFFER         *srcbuf  =  cgObjectTableGet(&ctx->BufferTable, ddp->SourceBuffer);
+    CG_BUFFER         *dstbuf  =  cgObjectTableGet(&ctx->BufferTable, ddp->TargetBuffer);
+    int                result  =  CG_SUCCESS;
+    size_t            nmemrefs =  0;
+    cl_uint           nwaitevt =  0;
+    cl_event          acquire  =  NULL;
+    cl_mem            memrefs[2];
+    if ((result = cgMakeBufferResident(ctx, queue, srcbuf)) != CG_SUCCESS)
+        return result;
+    if ((result = cgMakeBufferResident(ctx, queue, dstbuf)) != CG_SUCCESS)
+        return result;
+    cgMemRefListAddBuffer(srcbuf, memrefs, nmemrefs, 2, false);
+    cgMemRefListAddBuffer(dstbuf, memrefs, nmemrefs, 2, false);
+    if ((result = cgAcquireMemoryObjects(ctx, queue, memrefs, nmemrefs, ddp->WaitEvent, &acquire, nwaitevt, 1)) == CL_SUCCESS)
     {
-        case CG_WINDING_CCW: return GL_CCW;
-        case CG_WINDING_CW : return GL_CW;
-        default: break;
+        cl_event  cl_done = NULL;
+        cl_int    cl_res  = clEnqueueCopyBuffer(
+            queue->CommandQueue, 
+            memrefs[0], /* src */
+            memrefs[1], /* dst */
+            ddp->SourceOffset, 
+            ddp->TargetOffset, 
+            ddp->CopyAmount, 
+            nwaitevt, 
+            CG_OPENCL_WAIT_LIST(nwaitevt, &acquire),
+            &cl_done);
+        if  (cl_res != CL_SUCCESS)
+        {
+            switch (cl_res)
+            {
+            case CL_INVALID_COMMAND_QUEUE        : result = CG_BAD_CLCONTEXT; break;
+            case CL_INVALID_CONTEXT              : result = CG_BAD_CLCONTEXT; break;
+            case CL_INVALID_MEM_OBJECT           : result = CG_BAD_CLCONTEXT; break;
+            case CL_INVALID_VALUE                : result = CG_INVALID_VALUE; break;
+            case CL_INVALID_EVENT_WAIT_LIST      : result = CG_INVALID_VALUE; break;
+            case CL_MISALIGNED_SUB_BUFFER_OFFSET : result = CG_INVALID_VALUE; break;
+            case CL_MEM_COPY_OVERLAP             : result = CG_INVALID_VALUE; break;
+            case CL_MEM_OBJECT_ALLOCATION_FAILURE: result = CG_OUT_OF_MEMORY; break;
+            case CL_OUT_OF_RESOURCES             : result = CG_OUT_OF_MEMORY; break;
+            case CL_OUT_OF_HOST_MEMORY           : result = CG_OUT_OF_MEMORY; break;
+            default                              : result = CG_ERROR;         break;
+            }
+            cgReleaseMemoryObjects(ctx, queue, memrefs, nmemrefs, NULL, 0, CG_INVALID_HANDLE);
+            return result;
+        }
+        return cgReleaseMemoryObjects(ctx, queue, memrefs, nmemrefs, &cl_done, 1, ddp->CompleteEvent);
     }
-    return GL_INVALID_ENUM;
+    return result;
 }
 
-/// @summary Convert a CGFX primitive topology value to the corresponding OpenGL enum.
-/// @param topology The CGFX primitive topology value, one of cg_primitive_topology_e.
-/// @return The corresponding OpenGL enum value, or GL_INVALID_ENUM.
-internal_function GLenum
-cgGlPrimitiveTopology
+/// @summary Implements the COPY_IMAGE command, which copies data from one image to another.
+/// @param ctx The CGFX context returned by cgEnumerateDevices.
+/// @param queue The command queue into which the command is being inserted.
+/// @param cmdbuf The command buffer defining the command.
+/// @param cmd The command and any associated data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_INVALID_STATE, CG_BAD_CLCONTEXT, CG_UNSUPPORTED, CG_OUT_OF_MEMORY, CG_OUT_OF_OBJECTS or CG_ERROR.
+internal_function int
+cgExecuteCopyImageRegion
 (
-    int topology
+    CG_CONTEXT    *ctx, 
+    CG_QUEUE      *queue, 
+    CG_CMD_BUFFER *cmdbuf, 
+    cg_command_t  *cmd
 )
-{
-    switch (topology)
+{   UNREFERENCED_PARAMETER(cmdbuf);
+    cg_copy_image_cmd_t  *ddp  = (cg_copy_image_cmd_t*) cmd->Data;
+    CG_IMAGE          *srcimg  =  cgObjectTableGet(&ctx->ImageTable, ddp->SourceImage);
+    CG_IMAGE          *dstimg  =  cgObjectTableGet(&ctx->ImageTable, ddp->TargetImage);
+    int                result  =  CG_SUCCESS;
+    size_t            nmemrefs =  0;
+    cl_uint           nwaitevt =  0;
+    cl_event          acquire  =  NULL;
+    cl_mem            memrefs[2];
+    if ((result = cgMakeImageResident (ctx, queue, srcimg)) != CG_SUCCESS)
+        return result;
+    if ((result = cgMakeImageResident (ctx, queue, dstimg)) != CG_SUCCESS)
+        return result;
+    cgMemRefListAddImage(srcimg, memrefs, nmemrefs, 2, false);
+    cgMemRefListAddImage(dstimg, memrefs, nmemrefs, 2, false);
+    if ((result = cgAcquireMemoryObjects(ctx, queue, memrefs, nmemrefs, ddp->WaitEvent, &acquire, nwaitevt, 1)) == CL_SUCCESS)
     {
-        case CG_PRIMITIVE_POINT_LIST    : return GL_POINTS;
-        case CG_PRIMITIVE_LINE_LIST     : return GL_LINES;
-        case CG_PRIMITIVE_LINE_STRIP    : return GL_LINE_STRIP;
-        case CG_PRIMITIVE_TRIANGLE_LIST : return GL_TRIANGLES;
-        case CG_PRIMITIVE_TRIANGLE_STRIP: return GL_TRIANGLE_STRIP;
-        default: break;
+        cl_event  cl_done = NULL;
+        cl_int    cl_res  = clEnqueueCopyImage(
+            queue->CommandQueue, 
+            memrefs[0], /* src */
+            memrefs[1], /* dst */
+            ddp->SourceOrigin, 
+            ddp->TargetOrigin, 
+            ddp->Dimensions, 
+            nwaitevt, 
+            CG_OPENCL_WAIT_LIST(nwaitevt, &acquire),
+            &cl_done);
+        if  (cl_res != CL_SUCCESS)
+        {
+            switch (cl_res)
+            {
+            case CL_INVALID_COMMAND_QUEUE        : result = CG_BAD_CLCONTEXT; break;
+            case CL_INVALID_CONTEXT              : result = CG_BAD_CLCONTEXT; break;
+            case CL_INVALID_MEM_OBJECT           : result = CG_BAD_CLCONTEXT; break;
+            case CL_IMAGE_FORMAT_MISMATCH        : result = CG_INVALID_VALUE; break;
+            case CL_INVALID_IMAGE_SIZE           : result = CG_INVALID_VALUE; break;
+            case CL_INVALID_VALUE                : result = CG_INVALID_VALUE; break;
+            case CL_INVALID_EVENT_WAIT_LIST      : result = CG_INVALID_VALUE; break;
+            case CL_MEM_COPY_OVERLAP             : result = CG_INVALID_VALUE; break;
+            case CL_MEM_OBJECT_ALLOCATION_FAILURE: result = CG_OUT_OF_MEMORY; break;
+            case CL_OUT_OF_RESOURCES             : result = CG_OUT_OF_MEMORY; break;
+            case CL_OUT_OF_HOST_MEMORY           : result = CG_OUT_OF_MEMORY; break;
+            default                              : result = CG_ERROR;         break;
+            }
+            cgReleaseMemoryObjects(ctx, queue, memrefs, nmemrefs, NULL, 0, CG_INVALID_HANDLE);
+            return result;
+        }
+        return cgReleaseMemoryObjects(ctx, queue, memrefs, nmemrefs, &cl_done, 1, ddp->CompleteEvent);
     }
-    return GL_INVALID_ENUM;
+    return result;
 }
 
-/// @summary Convert a CGFX stencil operation value to the corresponding OpenGL enum.
-/// @param op The CGFX stencil operation, one of cg_stencil_operation_e.
-/// @return The corresponding OpenGL enum value, or GL_INVALID_ENUM.
-internal_function GLenum
-cgGlStencilOp
+/// @summary Implements the COPY_BUFFER_TO_IMAGE command, which copies data from one image to another.
+/// @param ctx The CGFX context returned by cgEnumerateDevices.
+/// @param queue The command queue into which the command is being inserted.
+/// @param cmdbuf The command buffer defining the command.
+/// @param cmd The command and any associated data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_INVALID_STATE, CG_BAD_CLCONTEXT, CG_UNSUPPORTED, CG_OUT_OF_MEMORY, CG_OUT_OF_OBJECTS, CG_UNSUPPORTED or CG_ERROR.
+internal_function int
+cgExecuteCopyBufferToImage
 (
-    int op
+    CG_CONTEXT    *ctx, 
+    CG_QUEUE      *queue, 
+    CG_CMD_BUFFER *cmdbuf, 
+    cg_command_t  *cmd
 )
-{
-    switch (op)
+{   UNREFERENCED_PARAMETER(cmdbuf);
+    cg_copy_buffer_to_image_cmd_t  *ddp  = (cg_copy_buffer_to_image_cmd_t*) cmd->Data;
+    CG_BUFFER         *srcbuf  =  cgObjectTableGet(&ctx->BufferTable, ddp->SourceBuffer);
+    CG_IMAGE          *dstimg  =  cgObjectTableGet(&ctx->ImageTable , ddp->TargetImage);
+    int                result  =  CG_SUCCESS;
+    size_t            nmemrefs =  0;
+    cl_uint           nwaitevt =  0;
+    cl_event          acquire  =  NULL;
+    cl_mem            memrefs[2];
+    if ((result = cgMakeBufferResident(ctx, queue, srcbuf)) != CG_SUCCESS)
+        return result;
+    if ((result = cgMakeImageResident (ctx, queue, dstimg)) != CG_SUCCESS)
+        return result;
+    cgMemRefListAddBuffer(srcbuf, memrefs, nmemrefs, 2, false);
+    cgMemRefListAddImage (dstimg, memrefs, nmemrefs, 2, false);
+    if ((result = cgAcquireMemoryObjects(ctx, queue, memrefs, nmemrefs, ddp->WaitEvent, &acquire, nwaitevt, 1)) == CL_SUCCESS)
     {
-        case CG_STENCIL_OP_KEEP     : return GL_KEEP;
-        case CG_STENCIL_OP_ZERO     : return GL_ZERO;
-        case CG_STENCIL_OP_REPLACE  : return GL_REPLACE;
-        case CG_STENCIL_OP_INC_CLAMP: return GL_INCR;
-        case CG_STENCIL_OP_DEC_CLAMP: return GL_DECR;
-        case CG_STENCIL_OP_INVERT   : return GL_INVERT;
-        case CG_STENCIL_OP_INC_WRAP : return GL_INCR_WRAP;
-        case CG_STENCIL_OP_DEC_WRAP : return GL_DECR_WRAP;
-        default: break;
+        cl_event  cl_done = NULL;
+        cl_int    cl_res  = clEnqueueCopyBufferToImage(
+            queue->CommandQueue, 
+            memrefs[0], /* src */
+            memrefs[1], /* dst */
+            ddp->SourceOffset, 
+            ddp->TargetOrigin, 
+            ddp->Dimensions, 
+            nwaitevt, 
+            CG_OPENCL_WAIT_LIST(nwaitevt, &acquire),
+            &cl_done);
+        if  (cl_res != CL_SUCCESS)
+        {
+            switch (cl_res)
+            {
+            case CL_INVALID_OPERATION            : result = CG_UNSUPPORTED;   break;
+            case CL_INVALID_COMMAND_QUEUE        : result = CG_BAD_CLCONTEXT; break;
+            case CL_INVALID_CONTEXT              : result = CG_BAD_CLCONTEXT; break;
+            case CL_INVALID_MEM_OBJECT           : result = CG_BAD_CLCONTEXT; break;
+            case CL_INVALID_IMAGE_SIZE           : result = CG_UNSUPPORTED;   break;
+            case CL_MISALIGNED_SUB_BUFFER_OFFSET : result = CG_INVALID_VALUE; break;
+            case CL_INVALID_VALUE                : result = CG_INVALID_VALUE; break;
+            case CL_INVALID_EVENT_WAIT_LIST      : result = CG_INVALID_VALUE; break;
+            case CL_MEM_COPY_OVERLAP             : result = CG_INVALID_VALUE; break;
+            case CL_MEM_OBJECT_ALLOCATION_FAILURE: result = CG_OUT_OF_MEMORY; break;
+            case CL_OUT_OF_RESOURCES             : result = CG_OUT_OF_MEMORY; break;
+            case CL_OUT_OF_HOST_MEMORY           : result = CG_OUT_OF_MEMORY; break;
+            default                              : result = CG_ERROR;         break;
+            }
+            cgReleaseMemoryObjects(ctx, queue, memrefs, nmemrefs, NULL, 0, CG_INVALID_HANDLE);
+            return result;
+        }
+        return cgReleaseMemoryObjects(ctx, queue, memrefs, nmemrefs, &cl_done, 1, ddp->CompleteEvent);
     }
-    return GL_INVALID_ENUM;
+    return result;
 }
 
-/// @summary Convert a boolean value into either GL_TRUE or GL_FALSE.
-/// @param value The value to convert.
-/// @return One of GL_TRUE or GL_FALSE.
-internal_function GLboolean
-cgGlBoolean
+/// @summary Implements the COPY_IMAGE_TO_BUFFER command, which copies data from one image to another.
+/// @param ctx The CGFX context returned by cgEnumerateDevices.
+/// @param queue The command queue into which the command is being inserted.
+/// @param cmdbuf The command buffer defining the command.
+/// @param cmd The command and any associated data.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_INVALID_STATE, CG_BAD_CLCONTEXT, CG_UNSUPPORTED, CG_OUT_OF_MEMORY, CG_OUT_OF_OBJECTS, CG_UNSUPPORTED or CG_ERROR.
+internal_function int
+cgExecuteCopyImageToBuffer
 (
-    bool value
+    CG_CONTEXT    *ctx, 
+    CG_QUEUE      *queue, 
+    CG_CMD_BUFFER *cmdbuf, 
+    cg_command_t  *cmd
 )
-{
-    return value ? GL_TRUE : GL_FALSE;
+{   UNREFERENCED_PARAMETER(cmdbuf);
+    cg_copy_image_to_buffer_cmd_t  *ddp  = (cg_copy_image_to_buffer_cmd_t*) cmd->Data;
+    CG_IMAGE          *srcimg  =  cgObjectTableGet(&ctx->ImageTable , ddp->SourceImage);
+    CG_BUFFER         *dstbuf  =  cgObjectTableGet(&ctx->BufferTable, ddp->TargetBuffer);
+    int                result  =  CG_SUCCESS;
+    size_t            nmemrefs =  0;
+    cl_uint           nwaitevt =  0;
+    cl_event          acquire  =  NULL;
+    cl_mem            memrefs[2];
+    if ((result = cgMakeImageResident (ctx, queue, srcimg)) != CG_SUCCESS)
+        return result;
+    if ((result = cgMakeBufferResident(ctx, queue, dstbuf)) != CG_SUCCESS)
+        return result;
+    cgMemRefListAddImage (srcimg, memrefs, nmemrefs, 2, false);
+    cgMemRefListAddBuffer(dstbuf, memrefs, nmemrefs, 2, false);
+    if ((result = cgAcquireMemoryObjects(ctx, queue, memrefs, nmemrefs, ddp->WaitEvent, &acquire, nwaitevt, 1)) == CL_SUCCESS)
+    {
+        cl_event  cl_done = NULL;
+        cl_int    cl_res  = clEnqueueCopyImageToBuffer(
+            queue->CommandQueue, 
+            memrefs[0], /* src */
+            memrefs[1], /* dst */
+            ddp->SourceOrigin, 
+            ddp->Dimensions, 
+            ddp->TargetOffset, 
+            nwaitevt, 
+            CG_OPENCL_WAIT_LIST(nwaitevt, &acquire),
+            &cl_done);
+        if  (cl_res != CL_SUCCESS)
+        {
+            switch (cl_res)
+            {
+            case CL_INVALID_OPERATION            : result = CG_UNSUPPORTED;   break;
+            case CL_INVALID_COMMAND_QUEUE        : result = CG_BAD_CLCONTEXT; break;
+            case CL_INVALID_CONTEXT              : result = CG_BAD_CLCONTEXT; break;
+            case CL_INVALID_MEM_OBJECT           : result = CG_BAD_CLCONTEXT; break;
+            case CL_INVALID_IMAGE_SIZE           : result = CG_UNSUPPORTED;   break;
+            case CL_MISALIGNED_SUB_BUFFER_OFFSET : result = CG_INVALID_VALUE; break;
+            case CL_INVALID_VALUE                : result = CG_INVALID_VALUE; break;
+            case CL_INVALID_EVENT_WAIT_LIST      : result = CG_INVALID_VALUE; break;
+            case CL_MEM_COPY_OVERLAP             : result = CG_INVALID_VALUE; break;
+            case CL_MEM_OBJECT_ALLOCATION_FAILURE: result = CG_OUT_OF_MEMORY; break;
+            case CL_OUT_OF_RESOURCES             : result = CG_OUT_OF_MEMORY; break;
+            case CL_OUT_OF_HOST_MEMORY           : result = CG_OUT_OF_MEMORY; break;
+            default                              : result = CG_ERROR;         break;
+            }
+            cgReleaseMemoryObjects(ctx, queue, memrefs, nmemrefs, NULL, 0, CG_INVALID_HANDLE);
+            return result;
+        }
+        return cgReleaseMemoryObjects(ctx, queue, memrefs, nmemrefs, &cl_done, 1, ddp->CompleteEvent);
+    }
+    return result;
 }
 
-/// @summary Determines whether an identifier would be considered a GLSL built- in value; that is, whether the identifier starts with 'gl_'.
-/// @param name A NULL-terminated ASCII string identifier.
-/// @return true if @a name starts with 'gl_'.
-internal_function bool
-cgGlslBuiltIn
+/// @summary Executes a command buffer against an out-of-order transfer queue.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX command queue, which must be a transfer queue.
+/// @param cmdbuf The CGFX command buffer to submit to the device queue.
+/// @return CG_SUCCESS, CG_COMMAND_NOT_IMPLEMENTED, or another result code.
+internal_function int
+cgExecuteTransferCommandBuffer
 (
-    char const *name
+    CG_CONTEXT    *ctx, 
+    CG_QUEUE      *queue, 
+    CG_CMD_BUFFER *cmdbuf
 )
 {
-    char prefix[4] = {'g','l','_','\0'};
-    return (strncmp(name, prefix, 3) == 0);
+    cg_command_t  *cmd = NULL;
+    size_t         ofs = 0;
+    int            res = CG_SUCCESS;
+
+    while ((cmd = cgCmdBufferCommandAt(cmdbuf, ofs, res)) != NULL && res == CG_SUCCESS)
+    {
+        switch (cmd->CommandId)
+        {
+        case CG_COMMAND_DEVICE_FENCE:
+            res = cgExecuteDeviceFence(ctx, queue, cmdbuf, cmd);
+            break;
+        case CG_COMMAND_COPY_BUFFER:
+            res = cgExecuteCopyBufferRegion(ctx, queue, cmdbuf, cmd);
+            break;
+        case CG_COMMAND_COPY_IMAGE:
+            res = cgExecuteCopyImageRegion(ctx, queue, cmdbuf, cmd);
+            break;
+        case CG_COMMAND_COPY_BUFFER_TO_IMAGE:
+            res = cgExecuteCopyImageToBuffer(ctx, queue, cmdbuf, cmd);
+            break;
+        case CG_COMMAND_COPY_IMAGE_TO_BUFFER:
+            res = cgExecuteCopyBufferToImage(ctx, queue, cmdbuf, cmd);
+            break;
+        default:
+            res = CG_COMMAND_NOT_IMPLEMENTED;
+            break;
+        }
+    }
+    if (res == CG_END_OF_BUFFER)
+        res  = CG_SUCCESS;
+
+    return res;
 }
 
-/// @summary Counts the number of active vertex attribues, texture samplers and uniform values defined in a shader program.
-/// @param display The display managing the rendering context.
-/// @param program The OpenGL program object to query.
-/// @param buffer A temporary buffer used to hold attribute and uniform names.
-/// @param buffer_size The maximum number of bytes that can be written to the temporary name buffer.
-/// @param include_builtins Specify true to include GLSL builtin values in the returned vertex attribute count.
-/// @param out_num_attribs On return, this address is updated with the number of active vertex attribute values.
-/// @param out_num_samplers On return, this address is updated with the number of active texture sampler values.
-/// @param out_num_uniforms On return, this address is updated with the number of active uniform values.
-internal_function void
-cgGlslReflectProgramCounts
+/// @summary Executes a command buffer against an out-of-order compute queue.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX command queue, which must be a compute queue.
+/// @param cmdbuf The CGFX command buffer to submit to the device queue.
+/// @return CG_SUCCESS, CG_COMMAND_NOT_IMPLEMENTED, or another result code.
+internal_function int
+cgExecuteComputeCommandBuffer
 (
-    CG_DISPLAY *display,
-    GLuint      program,
-    char       *buffer,
-    size_t      buffer_size,
-    bool        include_builtins,
-    size_t     &out_num_attribs,
-    size_t     &out_num_samplers,
-    size_t     &out_num_uniforms
+    CG_CONTEXT    *ctx, 
+    CG_QUEUE      *queue, 
+    CG_CMD_BUFFER *cmdbuf
 )
 {
-    size_t  num_attribs  = 0;
-    GLint   attrib_count = 0;
-    GLsizei buf_size     = (GLsizei) buffer_size;
+    cg_command_t *cmd = NULL;
+    size_t        ofs = 0;
+    int           res = CG_SUCCESS;
 
-    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &attrib_count);
-    for (GLint i = 0; i < attrib_count; ++i)
+    while ((cmd = cgCmdBufferCommandAt(cmdbuf, ofs, res)) != NULL && res == CG_SUCCESS)
     {
-        GLenum type = GL_FLOAT;
-        GLuint idx  = (GLuint) i;
-        GLint  len  = 0;
-        GLint  sz   = 0;
-        glGetActiveAttrib(program, idx, buf_size, &len, &sz, &type, buffer);
-        if (cgGlslBuiltIn(buffer) && !include_builtins)
-            continue;
-        num_attribs++;
+        switch (cmd->CommandId)
+        {
+        case CG_COMMAND_DEVICE_FENCE:
+            res = cgExecuteDeviceFence(ctx, queue, cmdbuf, cmd);
+            break;
+        case CG_COMMAND_COPY_BUFFER:
+            res = cgExecuteCopyBufferRegion(ctx, queue, cmdbuf, cmd);
+            break;
+        case CG_COMMAND_COPY_IMAGE:
+            res = cgExecuteCopyImageRegion(ctx, queue, cmdbuf, cmd);
+            break;
+        case CG_COMMAND_COPY_BUFFER_TO_IMAGE:
+            res = cgExecuteCopyImageToBuffer(ctx, queue, cmdbuf, cmd);
+            break;
+        case CG_COMMAND_COPY_IMAGE_TO_BUFFER:
+            res = cgExecuteCopyBufferToImage(ctx, queue, cmdbuf, cmd);
+            break;
+        case CG_COMMAND_PIPELINE_DISPATCH:
+            res = cgExecuteComputePipelineDispatch(ctx, queue, cmdbuf, cmd);
+            break;
+        default:
+            res = CG_COMMAND_NOT_IMPLEMENTED;
+            break;
+        }
     }
+    if (res == CG_END_OF_BUFFER)
+        res  = CG_SUCCESS;
 
-    size_t num_samplers  = 0;
-    size_t num_uniforms  = 0;
-    GLint  uniform_count = 0;
-
-    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniform_count);
-    for (GLint i = 0; i < uniform_count; ++i)
-    {
-        GLenum type = GL_FLOAT;
-        GLuint idx  = (GLuint) i;
-        GLint  len  = 0;
-        GLint  sz   = 0;
-        glGetActiveUniform(program, idx, buf_size, &len, &sz, &type, buffer);
-        if (cgGlslBuiltIn (buffer) && !include_builtins)
-            continue;
-
-        switch (type)
-        {
-            case GL_SAMPLER_1D:
-            case GL_INT_SAMPLER_1D:
-            case GL_UNSIGNED_INT_SAMPLER_1D:
-            case GL_SAMPLER_1D_SHADOW:
-            case GL_SAMPLER_2D:
-            case GL_INT_SAMPLER_2D:
-            case GL_UNSIGNED_INT_SAMPLER_2D:
-            case GL_SAMPLER_2D_SHADOW:
-            case GL_SAMPLER_3D:
-            case GL_INT_SAMPLER_3D:
-            case GL_UNSIGNED_INT_SAMPLER_3D:
-            case GL_SAMPLER_CUBE:
-            case GL_INT_SAMPLER_CUBE:
-            case GL_UNSIGNED_INT_SAMPLER_CUBE:
-            case GL_SAMPLER_CUBE_SHADOW:
-            case GL_SAMPLER_1D_ARRAY:
-            case GL_SAMPLER_1D_ARRAY_SHADOW:
-            case GL_INT_SAMPLER_1D_ARRAY:
-            case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
-            case GL_SAMPLER_2D_ARRAY:
-            case GL_SAMPLER_2D_ARRAY_SHADOW:
-            case GL_INT_SAMPLER_2D_ARRAY:
-            case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
-            case GL_SAMPLER_BUFFER:
-            case GL_INT_SAMPLER_BUFFER:
-            case GL_UNSIGNED_INT_SAMPLER_BUFFER:
-            case GL_SAMPLER_2D_RECT:
-            case GL_SAMPLER_2D_RECT_SHADOW:
-            case GL_INT_SAMPLER_2D_RECT:
-            case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
-            case GL_SAMPLER_2D_MULTISAMPLE:
-            case GL_INT_SAMPLER_2D_MULTISAMPLE:
-            case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
-            case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
-            case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
-            case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
-                num_samplers++;
-                break;
+    return res;
+}
 
-            default:
-                num_uniforms++;
-                break;
-        }
+/// @summary Executes a single command against an in-order graphics queue.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX command queue, which must be a graphics queue.
+/// @param cmdbuf The CGFX command buffer defining the command.
+/// @param cmd The command to execute.
+/// @return CG_SUCCESS, CG_COMMAND_NOT_IMPLEMENTED, or another result code.
+internal_function inline int
+cgExecuteGraphicsCommand
+(
+    CG_CONTEXT    *ctx, 
+    CG_QUEUE      *queue, 
+    CG_CMD_BUFFER *cmdbuf, 
+    cg_command_t  *cmd
+)
+{
+    switch (cmd->CommandId)
+    {
+    case CG_COMMAND_DEVICE_FENCE:
+        return cgExecuteDeviceFence(ctx, queue, cmdbuf, cmd);
+    case CG_COMMAND_PIPELINE_DISPATCH:
+        return cgExecuteGraphicsPipelineDispatch(ctx, queue, cmdbuf, cmd);
+    default:
+        break;
     }
-
-    // set the output values for the caller.
-    out_num_attribs  = num_attribs;
-    out_num_samplers = num_samplers;
-    out_num_uniforms = num_uniforms;
+    return CG_COMMAND_NOT_IMPLEMENTED;
 }
 
-/// @summary Retrieve information about the active vertex attribues, texture samplers and uniform values defined in a shader program.
-/// @param display The display managing the rendering context.
-/// @param program The OpenGL program object to query.
-/// @param buffer A temporary buffer used to hold attribute and uniform names.
-/// @param buffer_size The maximum number of bytes that can be written to the temporary name buffer.
-/// @param include_builtins Specify true to include GLSL builtin values in the returned vertex attribute count.
-/// @param glsl The GLSL program descriptor to populate with data.
+/// @summary Perform a stable least-significant-digit radix sort of command sort entries by key. Passes where every key 
+/// has the same digit are skipped, so keys that only differ in a few bytes cost a few passes.
+/// @param entries The sort entries to sort in place.
+/// @param scratch Temporary storage for at least @a count sort entries.
+/// @param count The number of sort entries.
 internal_function void
-cgGlslReflectProgramMetadata
+cgSortCommandsByKey
 (
-    CG_DISPLAY      *display,
-    GLuint           program,
-    char            *buffer,
-    size_t           buffer_size,
-    bool             include_builtins,
-    CG_GLSL_PROGRAM *glsl
+    CG_CMD_SORT_ENTRY *entries, 
+    CG_CMD_SORT_ENTRY *scratch, 
+    size_t             count
 )
 {
-    uint32_t          *attrib_names  = glsl->AttributeNames;
-    uint32_t          *sampler_names = glsl->SamplerNames;
-    uint32_t          *uniform_names = glsl->UniformNames;
-    CG_GLSL_ATTRIBUTE *attrib_info   = glsl->Attributes;
-    CG_GLSL_SAMPLER   *sampler_info  = glsl->Samplers;
-    CG_GLSL_UNIFORM   *uniform_info  = glsl->Uniforms;
-    size_t             num_attribs   = 0;
-    GLint              attrib_count  = 0;
-    GLsizei            buf_size      =(GLsizei) buffer_size;
+    CG_CMD_SORT_ENTRY *src = entries;
+    CG_CMD_SORT_ENTRY *dst = scratch;
+    size_t             hist[8][256];
 
-    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &attrib_count);
-    for (GLint i = 0; i < attrib_count; ++i)
+    // build the histograms for all eight digits in a single pass.
+    memset(hist, 0, sizeof(hist));
+    for (size_t i = 0; i < count; ++i)
     {
-        GLenum type = GL_FLOAT;
-        GLuint idx  = (GLuint) i;
-        GLint  len  = 0;
-        GLint  loc  = 0;
-        GLint  sz   = 0;
-        glGetActiveAttrib(program, idx, buf_size, &len, &sz, &type, buffer);
-        if (cgGlslBuiltIn(buffer) && !include_builtins)
-            continue;
+        uint64_t key = entries[i].SortKey;
+        for (size_t d = 0; d < 8; ++d)
+            hist[d][(key >> (d * 8)) & 0xFF]++;
+    }
+    for (size_t d = 0; d < 8; ++d)
+    {
+        size_t  *h     = hist[d];
+        size_t   shift = d * 8;
+        if (h[(src[0].SortKey >> shift) & 0xFF] == count)
+            continue; // every key has the same value for this digit.
 
-        CG_GLSL_ATTRIBUTE va;
-        loc             = glGetAttribLocation(program, buffer);
-        va.DataType     =(GLenum)   type;
-        va.Location     =(GLint)    loc;
-        va.DataSize     =(size_t)   cgGlDataSize(type) * sz;
-        va.DataOffset   =(size_t)   0; // for application use only
-        va.Dimension    =(size_t)   sz;
-        attrib_names[num_attribs] = cgHashName(buffer);
-        attrib_info [num_attribs] = va;
-        num_attribs++;
+        // convert the counts to output offsets, then scatter.
+        for (size_t b = 0, sum = 0; b < 256; ++b)
+        {
+            size_t n = h[b]; h[b] = sum; sum += n;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            dst[h[(src[i].SortKey >> shift) & 0xFF]++] = src[i];
+        }
+        CG_CMD_SORT_ENTRY *t = src; src = dst; dst = t;
+    }
+    if (src != entries)
+    {   // an odd number of passes was performed.
+        memcpy(entries, src, count * sizeof(CG_CMD_SORT_ENTRY));
     }
+}
 
-    size_t num_samplers  = 0;
-    size_t num_uniforms  = 0;
-    GLint  uniform_count = 0;
-    GLint  texture_unit  = 0;
+/// @summary Executes a command buffer recorded with CG_COMMAND_BUFFER_FLAG_SORT_BY_KEY against an in-order graphics queue. 
+/// Fences split the command buffer into runs, and the commands within each run are executed in ascending sort key order. 
+/// The sort entries are sorted in place; since fences stay in place and the sort is stable, re-submission produces the same order.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX command queue, which must be a graphics queue.
+/// @param cmdbuf The CGFX command buffer to submit to the device queue.
+/// @return CG_SUCCESS, CG_COMMAND_NOT_IMPLEMENTED, CG_OUT_OF_MEMORY or another result code.
+internal_function int
+cgExecuteSortedGraphicsCommands
+(
+    CG_CONTEXT    *ctx, 
+    CG_QUEUE      *queue, 
+    CG_CMD_BUFFER *cmdbuf
+)
+{
+    CG_CMD_SORT_ENTRY *entries = cmdbuf->SortEntries;
+    CG_CMD_SORT_ENTRY *scratch = NULL;
+    size_t             count   = cmdbuf->CommandCount;
+    int                res     = CG_SUCCESS;
 
-    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniform_count);
-    for (GLint i = 0; i < uniform_count; ++i)
+    if ((scratch = (CG_CMD_SORT_ENTRY*) cgAllocateHostMemory(&ctx->HostAllocator, count * sizeof(CG_CMD_SORT_ENTRY), 0, CG_ALLOCATION_TYPE_TEMP)) == NULL)
+    {   // unable to allocate the radix sort scratch memory.
+        return CG_OUT_OF_MEMORY;
+    }
+    for (size_t i = 0, first = 0; i <= count && res == CG_SUCCESS; ++i)
     {
-        GLenum type = GL_FLOAT;
-        GLuint idx  = (GLuint) i;
-        GLint  len  = 0;
-        GLint  loc  = 0;
-        GLint  sz   = 0;
-        glGetActiveUniform(program, idx, buf_size, &len, &sz, &type, buffer);
-        if (cgGlslBuiltIn (buffer) && !include_builtins)
+        cg_command_t *fence = i < count ? (cg_command_t*) (cmdbuf->CommandData + entries[i].Offset) : NULL;
+        if (fence != NULL && fence->CommandId != CG_COMMAND_DEVICE_FENCE)
             continue;
 
-        switch (type)
-        {
-            case GL_SAMPLER_1D:
-            case GL_INT_SAMPLER_1D:
-            case GL_UNSIGNED_INT_SAMPLER_1D:
-            case GL_SAMPLER_1D_SHADOW:
-            case GL_SAMPLER_2D:
-            case GL_INT_SAMPLER_2D:
-            case GL_UNSIGNED_INT_SAMPLER_2D:
-            case GL_SAMPLER_2D_SHADOW:
-            case GL_SAMPLER_3D:
-            case GL_INT_SAMPLER_3D:
-            case GL_UNSIGNED_INT_SAMPLER_3D:
-            case GL_SAMPLER_CUBE:
-            case GL_INT_SAMPLER_CUBE:
-            case GL_UNSIGNED_INT_SAMPLER_CUBE:
-            case GL_SAMPLER_CUBE_SHADOW:
-            case GL_SAMPLER_1D_ARRAY:
-            case GL_SAMPLER_1D_ARRAY_SHADOW:
-            case GL_INT_SAMPLER_1D_ARRAY:
-            case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
-            case GL_SAMPLER_2D_ARRAY:
-            case GL_SAMPLER_2D_ARRAY_SHADOW:
-            case GL_INT_SAMPLER_2D_ARRAY:
-            case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
-            case GL_SAMPLER_BUFFER:
-            case GL_INT_SAMPLER_BUFFER:
-            case GL_UNSIGNED_INT_SAMPLER_BUFFER:
-            case GL_SAMPLER_2D_RECT:
-            case GL_SAMPLER_2D_RECT_SHADOW:
-            case GL_INT_SAMPLER_2D_RECT:
-            case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
-            case GL_SAMPLER_2D_MULTISAMPLE:
-            case GL_INT_SAMPLER_2D_MULTISAMPLE:
-            case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
-            case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
-            case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
-            case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
-                {
-                    CG_GLSL_SAMPLER  ts;
-                    loc            = glGetUniformLocation(program, buffer);
-                    ts.SamplerType =(GLenum)      type;
-                    ts.BindTarget  =(GLenum)      cgGlTextureTarget(type);
-                    ts.Location    =(GLint)       loc;
-                    ts.ImageUnit   =(GLint)       texture_unit++;
-                    sampler_names[num_samplers] = cgHashName(buffer);
-                    sampler_info [num_samplers] = ts;
-                    num_samplers++;
-                }
-                break;
+        // commands [first, i) are bounded by fences or the ends of the buffer.
+        if (i - first > 1)
+            cgSortCommandsByKey(entries + first, scratch, i - first);
+        for (size_t j = first; j < i && res == CG_SUCCESS; ++j)
+            res = cgExecuteGraphicsCommand(ctx, queue, cmdbuf, (cg_command_t*) (cmdbuf->CommandData + entries[j].Offset));
+        if (fence != NULL && res == CG_SUCCESS)
+            res = cgExecuteGraphicsCommand(ctx, queue, cmdbuf, fence);
+        first = i + 1;
+    }
+    cgFreeHostMemory(&ctx->HostAllocator, scratch, count * sizeof(CG_CMD_SORT_ENTRY), 0, CG_ALLOCATION_TYPE_TEMP);
+    return res;
+}
 
-            default:
-                {
-                    CG_GLSL_UNIFORM  uv;
-                    loc            = glGetUniformLocation(program, buffer);
-                    uv.DataType    =(GLenum)      type;
-                    uv.Location    =(GLint)       loc;
-                    uv.DataSize    =(size_t)      cgGlDataSize(type) * sz;
-                    uv.DataOffset  =(size_t)      0; // for application use only
-                    uv.Dimension   =(size_t)      sz;
-                    uniform_names[num_uniforms] = cgHashName(buffer);
-                    uniform_info [num_uniforms] = uv;
-                    num_uniforms++;
-                }
-                break;
-        }
+/// @summary Executes a command buffer against an in-order graphics queue.
+/// @param ctx The CGFX context defining the command queue.
+/// @param queue The CGFX command queue, which must be a graphics queue.
+/// @param cmdbuf The CGFX command buffer to submit to the device queue.
+/// @return CG_SUCCESS, CG_COMMAND_NOT_IMPLEMENTED, or another result code.
+internal_function int
+cgExecuteGraphicsCommandBuffer
+(
+    CG_CONTEXT    *ctx, 
+    CG_QUEUE      *queue, 
+    CG_CMD_BUFFER *cmdbuf
+)
+{
+    cg_command_t  *cmd = NULL;
+    size_t         ofs = 0;
+    int            res = CG_SUCCESS;
+
+    if (queue->AttachedDisplay != NULL && queue->AttachedDisplay->GLState != NULL)
+    {   // capture the number of state changes made since the previous submission, and fence its uniform data.
+        cgGlStateBeginFrame(queue->AttachedDisplay);
+        cgGlUniformRingBeginFrame(queue->AttachedDisplay);
+    }
+    if ((cmdbuf->Flags & CG_COMMAND_BUFFER_FLAG_SORT_BY_KEY) != 0 && cmdbuf->CommandCount > 1)
+    {   // replay the commands between fences in sort key order.
+        return cgExecuteSortedGraphicsCommands(ctx, queue, cmdbuf);
+    }
+    while ((cmd = cgCmdBufferCommandAt(cmdbuf, ofs, res)) != NULL && res == CG_SUCCESS)
+    {
+        res = cgExecuteGraphicsCommand(ctx, queue, cmdbuf, cmd);
     }
+    if (res == CG_END_OF_BUFFER)
+        res  = CG_SUCCESS;
+
+    return res;
 }
 
-/// @summary Fills a memory buffer with a checkerboard pattern. This is useful for indicating uninitialized textures and for testing. The image internal format is expected to be GL_RGBA, data type GL_UNSIGNED_INT_8_8_8_8_REV, and the data is written using the native system byte ordering (GL_BGRA).
-/// @param width The image width, in pixels.
-/// @param height The image height, in pixels.
-/// @param alpha The value to write to the alpha channel, in [0, 1].
-/// @param buffer The buffer to which image data will be written.
-internal_function void
-cgCheckerFillRGBA
+/// @summary Compute the sRGB conversion tables used by the host mipmap generator. Called once via InitOnceExecuteOnce.
+/// @param once The one-time initialization structure. Unused.
+/// @param param Unused.
+/// @param context Unused.
+/// @return TRUE.
+internal_function BOOL CALLBACK
+cgHostMipmapInitTables
 (
-    size_t width,
-    size_t height,
-    float  alpha,
-    void  *buffer
+    PINIT_ONCE once,
+    void      *param,
+    void     **context
 )
 {
-    uint8_t  a = (uint8_t)((alpha - 0.5f) * 255.0f);
-    uint8_t *p = (uint8_t*) buffer;
-    for (size_t i = 0;  i < height; ++i)
+    for (size_t i = 0; i < 256; ++i)
     {
-        for (size_t j = 0; j < width; ++j)
-        {
-            uint8_t v = ((((i & 0x8) == 0)) ^ ((j & 0x8) == 0)) ? 1 : 0;
-            *p++  = v * 0xFF;
-            *p++  = v ? 0x00 : 0xFF;
-            *p++  = v * 0xFF;
-            *p++  = a;
-        }
+        double c = double(i) / 255.0;
+        double l = c <= 0.04045 ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4);
+        Global_SRGBToLinear16[i] = uint32_t(l * 65535.0 + 0.5);
     }
+    for (size_t i = 0; i < 65536; ++i)
+    {
+        double l = double(i) / 65535.0;
+        double c = l <= 0.0031308 ? l * 12.92 : 1.055 * pow(l, 1.0 / 2.4) - 0.055;
+        Global_Linear16ToSRGB[i] = uint8_t(c * 255.0 + 0.5);
+    }
+    UNREFERENCED_PARAMETER(once);
+    UNREFERENCED_PARAMETER(param);
+    UNREFERENCED_PARAMETER(context);
+    return TRUE;
 }
 
-/// @summary Determine whether a device should be included in the device list for an execution group.
-/// @param root_device A reference to the root device, which defines the share group.
-/// @param check_device A reference to the device to check for inclusion in the device list.
-/// @param check_handle The handle used to refer to @a check_device.
-/// @param create_flags A combination of cg_execution_group_flags_e used to define the devices to include in the implicit device list.
-/// @param device_list A list of handles of devices explicitly specified by the user for inclusion.
-/// @param device_count The number of handles in the explicit device list.
-/// @param explicit_count A counter to increment if @a check_handle appears in @a device_list.
-/// @return true if @a check_device should be included in the device list.
+/// @summary Determine whether the host CPU and operating system support AVX2 and F16C instructions.
+/// @return true if the AVX2 row kernels can be used.
 internal_function bool
-cgShouldIncludeDeviceInGroup
+cgHostCpuSupportsAVX2
 (
-    CG_DEVICE   *root_device,
-    CG_DEVICE   *check_device,
-    cg_handle_t  check_handle,
-    uint32_t     create_flags,
-    cg_handle_t *device_list,
-    size_t       device_count,
-    size_t      &explicit_count
+    void
 )
 {
-    if (check_device->ExecutionGroup != CG_INVALID_HANDLE)
-        return false;    // devices must not already be assigned to an execution group
-    if (check_device == root_device)
-        return true;     // always include the root device
-    if (check_device->PlatformId != root_device->PlatformId)
-        return false;    // devices must be in the same share group
-    for (size_t i = 0; i  < device_count; ++i)
-    {   if (check_handle == device_list[i])
-        {   explicit_count++;
-            return true; // the device is in the explicit device list
-        }
+#if defined(_M_IX86) || defined(_M_X64)
+    int regs[4] = { 0, 0, 0, 0 };
+    __cpuid(regs, 0);
+    if (regs[0] < 7)
+        return false;
+    __cpuid(regs, 1);
+    if ((regs[2] & (1 << 27)) == 0 ||  // OSXSAVE
+        (regs[2] & (1 << 28)) == 0 ||  // AVX
+        (regs[2] & (1 << 29)) == 0)    // F16C
+        return false;
+    if ((_xgetbv(0) & 0x6) != 0x6)
+        return false;                  // the OS does not preserve YMM state
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;  // AVX2
+#else
+    return false;
+#endif
+}
+
+/// @summary Convert an IEEE 754 half-precision value to single-precision.
+/// @param h The half-precision value.
+/// @return The single-precision value.
+internal_function inline float
+cgHalfToFloat
+(
+    uint16_t h
+)
+{
+    union { uint32_t u; float f; } o, magic;
+    magic.u = (254 - 15) << 23;
+    o.u     = uint32_t(h & 0x7FFF) << 13;
+    o.f    *= magic.f;
+    if (o.u >= ((127 + 16) << 23))
+        o.u |= 255 << 23;              // Inf or NaN
+    o.u    |= uint32_t(h & 0x8000) << 16;
+    return o.f;
+}
+
+/// @summary Convert a single-precision value to IEEE 754 half-precision, rounding to nearest-even.
+/// @param f The single-precision value.
+/// @return The half-precision value.
+internal_function inline uint16_t
+cgFloatToHalf
+(
+    float f
+)
+{
+    union { uint32_t u; float f; } fi, magic;
+    uint32_t sign;
+    uint32_t o;
+    fi.f    = f;
+    sign    = fi.u & 0x80000000U;
+    fi.u   ^= sign;
+    if (fi.u >= ((127 + 16) << 23))
+    {   // overflow becomes Inf, NaN stays NaN.
+        o = (fi.u > (255U << 23)) ? 0x7E00 : 0x7C00;
+    }
+    else if (fi.u < ((127 - 14) << 23))
+    {   // the result is denormalized; let the FPU round the mantissa.
+        magic.u = ((127 - 15) + (23 - 10) + 1) << 23;
+        fi.f   += magic.f;
+        o       = fi.u - magic.u;
     }
-    switch (root_device->Type)
+    else
+    {   // rebias the exponent and round the mantissa to nearest-even.
+        uint32_t odd = (fi.u >> 13) & 1;
+        fi.u += (uint32_t(15 - 127) << 23) + 0xFFF + odd;
+        o     = fi.u >> 13;
+    }
+    return uint16_t(o | (sign >> 16));
+}
+
+/// @summary Downsample one row of an R8G8B8A8_UNORM or B8G8R8A8_UNORM image using a 2x2 box filter.
+/// @param dst The first pixel of the destination row.
+/// @param src0 The first pixel of the upper source row.
+/// @param src1 The first pixel of the lower source row. This is the same as @a src0 if the source has a single row.
+/// @param dst_width The number of pixels in the destination row.
+/// @param src_width The number of pixels in the source rows.
+internal_function void
+cgHostMipRowRGBA8_Scalar
+(
+    uint8_t       *dst,
+    uint8_t const *src0,
+    uint8_t const *src1,
+    size_t         dst_width,
+    size_t         src_width
+)
+{
+    for (size_t x = 0; x < dst_width; ++x)
     {
-    case CL_DEVICE_TYPE_CPU:
+        size_t x0 = (x * 2 + 0) * 4;
+        size_t x1 =((x * 2 + 1) < src_width ? (x * 2 + 1) : (src_width - 1)) * 4;
+        for (size_t c = 0; c < 4; ++c)
         {
-            if (check_device->Type == CL_DEVICE_TYPE_CPU && (create_flags & CG_EXECUTION_GROUP_CPUS))
-                return true; // CPU devices may always be used together.
-            if (check_device->Type == CL_DEVICE_TYPE_GPU && (create_flags & CG_EXECUTION_GROUP_GPUS))
-                return check_device->Capabilities.UnifiedMemory == CL_TRUE; // GPUs can be paired if unified memory.
-            if (check_device->Type == CL_DEVICE_TYPE_ACCELERATOR && (create_flags & CG_EXECUTION_GROUP_ACCELERATORS))
-                return check_device->Capabilities.UnifiedMemory == CL_TRUE; // accelerators can be paired if unified memory.
+            dst[x * 4 + c] = uint8_t((src0[x0 + c] + src1[x0 + c] + src0[x1 + c] + src1[x1 + c] + 2) >> 2);
         }
-        return false;
+    }
+}
 
-    case CL_DEVICE_TYPE_GPU:
+/// @summary Downsample one row of an R8G8B8A8_UNORM_SRGB or B8G8R8A8_UNORM_SRGB image using a 2x2 box filter.
+/// Color channels are averaged in linear space using 16-bit fixed point; alpha is averaged directly.
+/// @param dst The first pixel of the destination row.
+/// @param src0 The first pixel of the upper source row.
+/// @param src1 The first pixel of the lower source row.
+/// @param dst_width The number of pixels in the destination row.
+/// @param src_width The number of pixels in the source rows.
+internal_function void
+cgHostMipRowSRGBA8_Scalar
+(
+    uint8_t       *dst,
+    uint8_t const *src0,
+    uint8_t const *src1,
+    size_t         dst_width,
+    size_t         src_width
+)
+{
+    uint32_t const *lin = Global_SRGBToLinear16;
+    uint8_t  const *enc = Global_Linear16ToSRGB;
+    for (size_t x = 0; x < dst_width; ++x)
+    {
+        size_t x0 = (x * 2 + 0) * 4;
+        size_t x1 =((x * 2 + 1) < src_width ? (x * 2 + 1) : (src_width - 1)) * 4;
+        for (size_t c = 0; c < 3; ++c)
         {
-            if (check_device->Type == CL_DEVICE_TYPE_CPU && (create_flags & CG_EXECUTION_GROUP_CPUS))
-                return (root_device->Capabilities.UnifiedMemory == CL_TRUE); // CPUs can be paired if unified memory.
-            if (check_device->Type == CL_DEVICE_TYPE_GPU && (create_flags & CG_EXECUTION_GROUP_GPUS))
-                return (create_flags & CG_EXECUTION_GROUP_DISPLAY_OUTPUT) == 0; // GPUs can be paired if not used for display output.
-            if (check_device->Type == CL_DEVICE_TYPE_ACCELERATOR && (create_flags & CG_EXECUTION_GROUP_ACCELERATORS))
-                return (root_device->Capabilities.UnifiedMemory == CL_TRUE && check_device->Capabilities.UnifiedMemory == CL_TRUE); // pairing allowed if both devices support unified memory.
+            dst[x * 4 + c] = enc[(lin[src0[x0 + c]] + lin[src1[x0 + c]] + lin[src0[x1 + c]] + lin[src1[x1 + c]] + 2) >> 2];
         }
-        return false;
+        dst[x * 4 + 3] = uint8_t((src0[x0 + 3] + src1[x0 + 3] + src0[x1 + 3] + src1[x1 + 3] + 2) >> 2);
+    }
+}
 
-    case CL_DEVICE_TYPE_ACCELERATOR:
+/// @summary Downsample one row of an R16G16B16A16_FLOAT image using a 2x2 box filter.
+/// @param dst The first pixel of the destination row.
+/// @param src0 The first pixel of the upper source row.
+/// @param src1 The first pixel of the lower source row.
+/// @param dst_width The number of pixels in the destination row.
+/// @param src_width The number of pixels in the source rows.
+internal_function void
+cgHostMipRowRGBA16F_Scalar
+(
+    uint8_t       *dst,
+    uint8_t const *src0,
+    uint8_t const *src1,
+    size_t         dst_width,
+    size_t         src_width
+)
+{
+    uint16_t       *d  = (uint16_t      *) dst;
+    uint16_t const *s0 = (uint16_t const*) src0;
+    uint16_t const *s1 = (uint16_t const*) src1;
+    for (size_t x = 0; x < dst_width; ++x)
+    {
+        size_t x0 = (x * 2 + 0) * 4;
+        size_t x1 =((x * 2 + 1) < src_width ? (x * 2 + 1) : (src_width - 1)) * 4;
+        for (size_t c = 0; c < 4; ++c)
         {
-            if (check_device->Type == CL_DEVICE_TYPE_CPU && (create_flags & CG_EXECUTION_GROUP_CPUS))
-                return (root_device->Capabilities.UnifiedMemory == CL_TRUE); // CPUs can be paired if unified memory.
-            if (check_device->Type == CL_DEVICE_TYPE_GPU && (create_flags & CG_EXECUTION_GROUP_GPUS))
-                return (root_device->Capabilities.UnifiedMemory == CL_TRUE && check_device->Capabilities.UnifiedMemory == CL_TRUE); // pairing allowed if both devices support unified memory.
-            if (check_device->Type == CL_DEVICE_TYPE_ACCELERATOR && (create_flags & CG_EXECUTION_GROUP_ACCELERATORS))
-                return true; // accelerator devices may always be used together.
+            float a = cgHalfToFloat(s0[x0 + c]) + cgHalfToFloat(s1[x0 + c]);
+            float b = cgHalfToFloat(s0[x1 + c]) + cgHalfToFloat(s1[x1 + c]);
+            d[x * 4 + c] = cgFloatToHalf((a + b) * 0.25f);
         }
-        return false;
+    }
+}
 
-    default:
-        return false;
+/// @summary Downsample one row of an R32_FLOAT image using a 2x2 box filter.
+/// @param dst The first pixel of the destination row.
+/// @param src0 The first pixel of the upper source row.
+/// @param src1 The first pixel of the lower source row.
+/// @param dst_width The number of pixels in the destination row.
+/// @param src_width The number of pixels in the source rows.
+internal_function void
+cgHostMipRowR32F_Scalar
+(
+    uint8_t       *dst,
+    uint8_t const *src0,
+    uint8_t const *src1,
+    size_t         dst_width,
+    size_t         src_width
+)
+{
+    float       *d  = (float      *) dst;
+    float const *s0 = (float const*) src0;
+    float const *s1 = (float const*) src1;
+    for (size_t x = 0; x < dst_width; ++x)
+    {
+        size_t x0 = (x * 2 + 0);
+        size_t x1 =((x * 2 + 1) < src_width ? (x * 2 + 1) : (src_width - 1));
+        d[x] = ((s0[x0] + s1[x0]) + (s0[x1] + s1[x1])) * 0.25f;
     }
 }
 
-/// @summary Create a complete list of device handles for an execution group and perform partitioning of any CPU devices.
-/// @param ctx The CGFX context managing the device list.
-/// @param root_device The handle of any device in the share group.
-/// @param create_flags A combination of cg_execution_group_flags_e specifying what to include in the device list.
-/// @param device_list A list of handles of devices explicitly specified by the user for inclusion.
-/// @param device_count The number of handles in the explicit device list.
-/// @param num_devices On return, stores the number of devices in the output device list.
-/// @param result On return, stores CG_SUCCESS or an error code.
-/// @return An array of num_devices handles to the devices used to create the execution group (including the root device), or NULL.
-internal_function cg_handle_t*
-cgCreateExecutionGroupDeviceList
+#if defined(_M_IX86) || defined(_M_X64)
+/// @summary Convert four half-precision values, zero-extended to 32 bits, to single-precision using SSE2.
+/// @param h The half-precision values in the low 16 bits of each lane.
+/// @return The single-precision values.
+internal_function inline __m128
+cgHalfToFloat_SSE2
 (
-    CG_CONTEXT  *ctx,
-    cg_handle_t  root_device,
-    uint32_t     create_flags,
-    cg_handle_t *device_list,
-    size_t       device_count,
-    size_t      &num_devices,
-    int         &result
+    __m128i h
 )
 {
-    CG_DEVICE     *root_dev     = cgObjectTableGet(&ctx->DeviceTable, root_device);
-    cg_handle_t   *devices      = NULL;
-    size_t         num_cpu      = 0; // number of CPU devices
-    size_t         num_gpu      = 0; // number of GPU devices
-    size_t         num_acl      = 0; // number of accelerator devices
-    size_t         num_total    = 0;
-    size_t         num_explicit = 0;
+    __m128i expmant = _mm_and_si128(h, _mm_set1_epi32(0x7FFF));
+    __m128i sign    = _mm_slli_epi32(_mm_xor_si128(h, expmant), 16);
+    __m128  scaled  = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expmant, 13)), _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23)));
+    __m128i infnan  = _mm_and_si128(_mm_cmpgt_epi32(expmant, _mm_set1_epi32(0x7BFF)), _mm_set1_epi32(255 << 23));
+    return _mm_or_ps(scaled, _mm_castsi128_ps(_mm_or_si128(sign, infnan)));
+}
 
-    // initialize output parameters:
-    num_devices = 0;
-    result = CG_SUCCESS;
+/// @summary Convert four single-precision values to half-precision using SSE2, rounding to nearest-even.
+/// @param f The single-precision values.
+/// @return The half-precision values, sign-extended to 32 bits so they can be packed with _mm_packs_epi32.
+internal_function inline __m128i
+cgFloatToHalf_SSE2
+(
+    __m128 f
+)
+{
+    __m128i sub_magic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    __m128  justsign  = _mm_and_ps(f, _mm_castsi128_ps(_mm_set1_epi32(int(0x80000000))));
+    __m128  absf      = _mm_xor_ps(f, justsign);
+    __m128i absi      = _mm_castps_si128(absf);
+    __m128i isregular = _mm_cmpgt_epi32(_mm_set1_epi32((127 + 16) << 23), absi);
+    __m128i nanbit    = _mm_and_si128(_mm_castps_si128(_mm_cmpunord_ps(absf, absf)), _mm_set1_epi32(0x200));
+    __m128i infnan    = _mm_or_si128(nanbit, _mm_set1_epi32(0x7C00));
+    __m128i issub     = _mm_cmpgt_epi32(_mm_set1_epi32((127 - 14) << 23), absi);
+    __m128i subnorm   = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absf, _mm_castsi128_ps(sub_magic))), sub_magic);
+    __m128i odd       = _mm_srai_epi32(_mm_slli_epi32(absi, 31 - 13), 31);
+    __m128i normal    = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absi, _mm_set1_epi32(0xFFF - ((127 - 15) << 23))), odd), 13);
+    __m128i finite    = _mm_or_si128(_mm_and_si128(issub, subnorm), _mm_andnot_si128(issub, normal));
+    __m128i joined    = _mm_or_si128(_mm_and_si128(isregular, finite), _mm_andnot_si128(isregular, infnan));
+    return _mm_or_si128(joined, _mm_srai_epi32(_mm_castps_si128(justsign), 16));
+}
 
-    // count the number of devices to be included in the list.
-    for (size_t i = 0, n = ctx->DeviceTable.ObjectCount; i < n; ++i)
-    {
-        CG_DEVICE *check =&ctx->DeviceTable.Objects[i];
-        cg_handle_t hand = cgMakeHandle(&ctx->DeviceTable, i);
-        if (cgShouldIncludeDeviceInGroup(root_dev, check, hand, create_flags, device_list, device_count, num_explicit))
-        {   // increment per-type counts:
-            switch (check->Type)
-            {
-            case CL_DEVICE_TYPE_CPU        : num_cpu++; break;
-            case CL_DEVICE_TYPE_GPU        : num_gpu++; break;
-            case CL_DEVICE_TYPE_ACCELERATOR: num_acl++; break;
-            default: break;
-            }
-        }
-    }
-    if (num_explicit != device_count)
-    {   // the explicit device list contains one or more invalid handles.
-        result = CG_INVALID_VALUE;
-        goto error_return;
-    }
-    if (num_gpu > 1 && (create_flags & CG_EXECUTION_GROUP_DISPLAY_OUTPUT))
-    {   // only one GPU device allowed in groups used for display output.
-        result = CG_INVALID_VALUE;
-        goto error_return;
-    }
+/// @summary Downsample one row of an 8-bit RGBA image using SSE2. See cgHostMipRowRGBA8_Scalar.
+internal_function void
+cgHostMipRowRGBA8_SSE2
+(
+    uint8_t       *dst,
+    uint8_t const *src0,
+    uint8_t const *src1,
+    size_t         dst_width,
+    size_t         src_width
+)
+{
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const bias = _mm_set1_epi16(2);
+    size_t        n    = src_width >= 2 ? dst_width : 0;
+    size_t        x    = 0;
+    for ( ; x + 2 <= n; x += 2)
+    {   // 4 source pixels from each row produce 2 destination pixels.
+        __m128i r0 = _mm_loadu_si128((__m128i const*) (src0 + x * 8));
+        __m128i r1 = _mm_loadu_si128((__m128i const*) (src1 + x * 8));
+        __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(r0, zero), _mm_unpacklo_epi8(r1, zero));
+        __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(r0, zero), _mm_unpackhi_epi8(r1, zero));
+        __m128i ev = _mm_unpacklo_epi64(lo, hi);
+        __m128i od = _mm_unpackhi_epi64(lo, hi);
+        __m128i s  = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(ev, od), bias), 2);
+        _mm_storel_epi64((__m128i*) (dst + x * 4), _mm_packus_epi16(s, s));
+    }
+    if (x < dst_width)
+        cgHostMipRowRGBA8_Scalar(dst + x * 4, src0 + x * 8, src1 + x * 8, dst_width - x, src_width - x * 2);
+}
 
-    // calculate the total number of items in the device list:
-    num_explicit = 0;
-    num_total = num_cpu + num_gpu + num_acl;
-    assert(num_total >= 1);
+/// @summary Downsample one row of an R16G16B16A16_FLOAT image using SSE2. See cgHostMipRowRGBA16F_Scalar.
+internal_function void
+cgHostMipRowRGBA16F_SSE2
+(
+    uint8_t       *dst,
+    uint8_t const *src0,
+    uint8_t const *src1,
+    size_t         dst_width,
+    size_t         src_width
+)
+{
+    __m128i const zero    = _mm_setzero_si128();
+    __m128  const quarter = _mm_set1_ps(0.25f);
+    size_t        n       = src_width >= 2 ? dst_width : 0;
+    size_t        x       = 0;
+    for ( ; x + 2 <= n; x += 2)
+    {   // 4 source pixels from each row produce 2 destination pixels.
+        __m128i a0 = _mm_loadu_si128((__m128i const*) (src0 + x * 16));
+        __m128i a1 = _mm_loadu_si128((__m128i const*) (src0 + x * 16 + 16));
+        __m128i b0 = _mm_loadu_si128((__m128i const*) (src1 + x * 16));
+        __m128i b1 = _mm_loadu_si128((__m128i const*) (src1 + x * 16 + 16));
+        __m128  p0 = _mm_add_ps(cgHalfToFloat_SSE2(_mm_unpacklo_epi16(a0, zero)), cgHalfToFloat_SSE2(_mm_unpacklo_epi16(b0, zero)));
+        __m128  p1 = _mm_add_ps(cgHalfToFloat_SSE2(_mm_unpackhi_epi16(a0, zero)), cgHalfToFloat_SSE2(_mm_unpackhi_epi16(b0, zero)));
+        __m128  p2 = _mm_add_ps(cgHalfToFloat_SSE2(_mm_unpacklo_epi16(a1, zero)), cgHalfToFloat_SSE2(_mm_unpacklo_epi16(b1, zero)));
+        __m128  p3 = _mm_add_ps(cgHalfToFloat_SSE2(_mm_unpackhi_epi16(a1, zero)), cgHalfToFloat_SSE2(_mm_unpackhi_epi16(b1, zero)));
+        __m128i h0 = cgFloatToHalf_SSE2(_mm_mul_ps(_mm_add_ps(p0, p1), quarter));
+        __m128i h1 = cgFloatToHalf_SSE2(_mm_mul_ps(_mm_add_ps(p2, p3), quarter));
+        _mm_storeu_si128((__m128i*) (dst + x * 8), _mm_packs_epi32(h0, h1));
+    }
+    if (x < dst_width)
+        cgHostMipRowRGBA16F_Scalar(dst + x * 8, src0 + x * 16, src1 + x * 16, dst_width - x, src_width - x * 2);
+}
 
-    // allocate storage for the device handles:
-    if ((devices = (cg_handle_t*) cgAllocateHostMemory(&ctx->HostAllocator, num_total * sizeof(cg_handle_t), 0, CG_ALLOCATION_TYPE_TEMP)) == NULL)
-    {   // unable to allocate the necessary memory.
-        result = CG_OUT_OF_MEMORY;
-        goto error_return;
-    }
+/// @summary Downsample one row of an R32_FLOAT image using SSE2. See cgHostMipRowR32F_Scalar.
+internal_function void
+cgHostMipRowR32F_SSE2
+(
+    uint8_t       *dst,
+    uint8_t const *src0,
+    uint8_t const *src1,
+    size_t         dst_width,
+    size_t         src_width
+)
+{
+    float const  *s0      = (float const*) src0;
+    float const  *s1      = (float const*) src1;
+    float        *d       = (float      *) dst;
+    __m128 const  quarter = _mm_set1_ps(0.25f);
+    size_t        n       = src_width >= 2 ? dst_width : 0;
+    size_t        x       = 0;
+    for ( ; x + 4 <= n; x += 4)
+    {   // 8 source pixels from each row produce 4 destination pixels.
+        __m128 a = _mm_add_ps(_mm_loadu_ps(s0 + x * 2 + 0), _mm_loadu_ps(s1 + x * 2 + 0));
+        __m128 b = _mm_add_ps(_mm_loadu_ps(s0 + x * 2 + 4), _mm_loadu_ps(s1 + x * 2 + 4));
+        __m128 e = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 o = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(d + x, _mm_mul_ps(_mm_add_ps(e, o), quarter));
+    }
+    if (x < dst_width)
+        cgHostMipRowR32F_Scalar(dst + x * 4, src0 + x * 8, src1 + x * 8, dst_width - x, src_width - x * 2);
+}
 
-    // run through the device table again to populate the device list.
-    for (size_t i = 0, n = ctx->DeviceTable.ObjectCount; i < n; ++i)
-    {
-        CG_DEVICE *check =&ctx->DeviceTable.Objects[i];
-        cg_handle_t hand = cgMakeHandle(&ctx->DeviceTable, i);
-        if (cgShouldIncludeDeviceInGroup(root_dev, check, hand, create_flags, device_list, device_count, num_explicit))
-        {   // save the handle for the caller.
-            devices[num_devices++] = hand;
-        }
-    }
-    return devices;
+/// @summary Downsample one row of an 8-bit RGBA image using AVX2. See cgHostMipRowRGBA8_Scalar.
+internal_function void
+cgHostMipRowRGBA8_AVX2
+(
+    uint8_t       *dst,
+    uint8_t const *src0,
+    uint8_t const *src1,
+    size_t         dst_width,
+    size_t         src_width
+)
+{
+    __m256i const zero = _mm256_setzero_si256();
+    __m256i const bias = _mm256_set1_epi16(2);
+    size_t        n    = src_width >= 2 ? dst_width : 0;
+    size_t        x    = 0;
+    for ( ; x + 4 <= n; x += 4)
+    {   // 8 source pixels from each row produce 4 destination pixels. unpack and pack operate per 128-bit lane.
+        __m256i r0 = _mm256_loadu_si256((__m256i const*) (src0 + x * 8));
+        __m256i r1 = _mm256_loadu_si256((__m256i const*) (src1 + x * 8));
+        __m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi8(r0, zero), _mm256_unpacklo_epi8(r1, zero));
+        __m256i hi = _mm256_add_epi16(_mm256_unpackhi_epi8(r0, zero), _mm256_unpackhi_epi8(r1, zero));
+        __m256i ev = _mm256_unpacklo_epi64(lo, hi);
+        __m256i od = _mm256_unpackhi_epi64(lo, hi);
+        __m256i s  = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(ev, od), bias), 2);
+        __m256i p  = _mm256_permute4x64_epi64(_mm256_packus_epi16(s, s), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storeu_si128((__m128i*) (dst + x * 4), _mm256_castsi256_si128(p));
+    }
+    if (x < dst_width)
+        cgHostMipRowRGBA8_SSE2(dst + x * 4, src0 + x * 8, src1 + x * 8, dst_width - x, src_width - x * 2);
+}
 
-error_return:
-    num_devices = 0;
-    return NULL;
+/// @summary Downsample one row of an 8-bit sRGB image using AVX2 gathers for the table lookups. See cgHostMipRowSRGBA8_Scalar.
+internal_function void
+cgHostMipRowSRGBA8_AVX2
+(
+    uint8_t       *dst,
+    uint8_t const *src0,
+    uint8_t const *src1,
+    size_t         dst_width,
+    size_t         src_width
+)
+{
+    int     const *lin   = (int const*) Global_SRGBToLinear16;
+    int     const *enc   = (int const*) Global_Linear16ToSRGB;
+    __m256i const  bias  = _mm256_set1_epi32(2);
+    __m256i const  bytes = _mm256_set1_epi32(0xFF);
+    size_t         n     = src_width >= 2 ? dst_width : 0;
+    size_t         x     = 0;
+    for ( ; x + 2 <= n; x += 2)
+    {   // 4 source pixels from each row produce 2 destination pixels; alpha (lanes 3 and 7) is not converted.
+        __m128i r0  = _mm_loadu_si128((__m128i const*) (src0 + x * 8));
+        __m128i r1  = _mm_loadu_si128((__m128i const*) (src1 + x * 8));
+        __m256i a0  = _mm256_cvtepu8_epi32(r0);
+        __m256i a1  = _mm256_cvtepu8_epi32(_mm_srli_si128(r0, 8));
+        __m256i b0  = _mm256_cvtepu8_epi32(r1);
+        __m256i b1  = _mm256_cvtepu8_epi32(_mm_srli_si128(r1, 8));
+        __m256i la0 = _mm256_blend_epi32(_mm256_i32gather_epi32(lin, a0, 4), a0, 0x88);
+        __m256i la1 = _mm256_blend_epi32(_mm256_i32gather_epi32(lin, a1, 4), a1, 0x88);
+        __m256i lb0 = _mm256_blend_epi32(_mm256_i32gather_epi32(lin, b0, 4), b0, 0x88);
+        __m256i lb1 = _mm256_blend_epi32(_mm256_i32gather_epi32(lin, b1, 4), b1, 0x88);
+        __m256i v0  = _mm256_add_epi32(la0, lb0);  // source pixels 0 and 1
+        __m256i v1  = _mm256_add_epi32(la1, lb1);  // source pixels 2 and 3
+        __m256i ev  = _mm256_permute2x128_si256(v0, v1, 0x20);
+        __m256i od  = _mm256_permute2x128_si256(v0, v1, 0x31);
+        __m256i avg = _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(ev, od), bias), 2);
+        __m256i out = _mm256_blend_epi32(_mm256_and_si256(_mm256_i32gather_epi32(enc, avg, 1), bytes), avg, 0x88);
+        __m256i p   = _mm256_packus_epi16(_mm256_packus_epi32(out, out), _mm256_setzero_si256());
+        *(int*) (dst + x * 4 + 0) = _mm_cvtsi128_si32(_mm256_castsi256_si128(p));
+        *(int*) (dst + x * 4 + 4) = _mm_cvtsi128_si32(_mm256_extracti128_si256(p, 1));
+    }
+    if (x < dst_width)
+        cgHostMipRowSRGBA8_Scalar(dst + x * 4, src0 + x * 8, src1 + x * 8, dst_width - x, src_width - x * 2);
 }
 
-/// @summary Frees the memory allocated for a device list created with cgCreateExecutionGroupDeviceList.
-/// @param ctx The CGFX context that allocated the device list.
-/// @param devices The device list returned by cgCreateExecutionGroupDeviceList.
-/// @param num_devices The number of devices returned by cgCreateExecutionGroupDeviceList.
-internal_function inline void
-cgFreeExecutionGroupDeviceList
+/// @summary Downsample one row of an R16G16B16A16_FLOAT image using AVX2 and F16C. See cgHostMipRowRGBA16F_Scalar.
+internal_function void
+cgHostMipRowRGBA16F_AVX2
 (
-    CG_CONTEXT  *ctx,
-    cg_handle_t *devices,
-    size_t       num_devices
+    uint8_t       *dst,
+    uint8_t const *src0,
+    uint8_t const *src1,
+    size_t         dst_width,
+    size_t         src_width
 )
 {
-    cgFreeHostMemory(&ctx->HostAllocator, devices, num_devices * sizeof(cg_handle_t), 0, CG_ALLOCATION_TYPE_TEMP);
+    __m256 const quarter = _mm256_set1_ps(0.25f);
+    size_t       n       = src_width >= 2 ? dst_width : 0;
+    size_t       x       = 0;
+    for ( ; x + 2 <= n; x += 2)
+    {   // 4 source pixels from each row produce 2 destination pixels.
+        __m256 a  = _mm256_cvtph_ps(_mm_loadu_si128((__m128i const*) (src0 + x * 16)));
+        __m256 b  = _mm256_cvtph_ps(_mm_loadu_si128((__m128i const*) (src0 + x * 16 + 16)));
+        __m256 c  = _mm256_cvtph_ps(_mm_loadu_si128((__m128i const*) (src1 + x * 16)));
+        __m256 d  = _mm256_cvtph_ps(_mm_loadu_si128((__m128i const*) (src1 + x * 16 + 16)));
+        __m256 v0 = _mm256_add_ps(a, c);  // source pixels 0 and 1
+        __m256 v1 = _mm256_add_ps(b, d);  // source pixels 2 and 3
+        __m256 ev = _mm256_permute2f128_ps(v0, v1, 0x20);
+        __m256 od = _mm256_permute2f128_ps(v0, v1, 0x31);
+        _mm_storeu_si128((__m128i*) (dst + x * 8), _mm256_cvtps_ph(_mm256_mul_ps(_mm256_add_ps(ev, od), quarter), 0));
+    }
+    if (x < dst_width)
+        cgHostMipRowRGBA16F_Scalar(dst + x * 8, src0 + x * 16, src1 + x * 16, dst_width - x, src_width - x * 2);
 }
 
-/// @summary Calculate the number of bytes allocated for an image on its associated heap.
-/// @param image The image to query. All image attributes (dimensions, format, etc.) must be set.
-/// @return The number of bytes allocated for image data storage on the image source heap.
-internal_function size_t
-cgCalculateImageAllocatedSize
+/// @summary Downsample one row of an R32_FLOAT image using AVX2. See cgHostMipRowR32F_Scalar.
+internal_function void
+cgHostMipRowR32F_AVX2
 (
-    CG_IMAGE *image
+    uint8_t       *dst,
+    uint8_t const *src0,
+    uint8_t const *src1,
+    size_t         dst_width,
+    size_t         src_width
 )
 {
-    size_t allocated_size = 0;
-    size_t nslice_or_item = image->ArrayCount > 1 ? image->ArrayCount : image->SliceCount;
-    for (size_t i = 0, n  = nslice_or_item; i < n; ++i)
-    {
-        for (size_t j = 0; j < image->LevelCount; ++j)
-        {
-            size_t  w = cgGlLevelDimension(image->PaddedWidth , j);
-            size_t  h = cgGlLevelDimension(image->PaddedHeight, j);
-            size_t ss = cgGlBytesPerSlice (image->InternalFormat, image->DataType, w, h, 4);
-            allocated_size += ss;
-        }
-    }
-    return align_up(allocated_size, image->SourceHeap->DeviceAlignment);
+    float const  *s0      = (float const*) src0;
+    float const  *s1      = (float const*) src1;
+    float        *d       = (float      *) dst;
+    __m256 const  quarter = _mm256_set1_ps(0.25f);
+    size_t        n       = src_width >= 2 ? dst_width : 0;
+    size_t        x       = 0;
+    for ( ; x + 8 <= n; x += 8)
+    {   // 16 source pixels from each row produce 8 destination pixels. shuffle_ps operates per 128-bit lane.
+        __m256 a = _mm256_add_ps(_mm256_loadu_ps(s0 + x * 2 + 0), _mm256_loadu_ps(s1 + x * 2 + 0));
+        __m256 b = _mm256_add_ps(_mm256_loadu_ps(s0 + x * 2 + 8), _mm256_loadu_ps(s1 + x * 2 + 8));
+        __m256 e = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 o = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        __m256 r = _mm256_mul_ps(_mm256_add_ps(e, o), quarter);
+        _mm256_storeu_ps(d + x, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(r), _MM_SHUFFLE(3, 1, 2, 0))));
+    }
+    if (x < dst_width)
+        cgHostMipRowR32F_SSE2(dst + x * 4, src0 + x * 8, src1 + x * 8, dst_width - x, src_width - x * 2);
 }
+#endif /* x86 or x64 */
 
-/// @summary Provides a default teardown callback for a pipeline that doesn't need to perform any cleanup.
-/// @param ctx A CGFX context returned by cgEnumerateDevices.
-/// @param pipeline A pointer to the CG_PIPELINE object.
-/// @param opaque The opaque state data supplied when the pipeline was created.
+#if defined(_M_ARM) || defined(_M_ARM64)
+/// @summary Downsample one row of an 8-bit RGBA image using NEON. See cgHostMipRowRGBA8_Scalar.
 internal_function void
-cgPipelineTeardownNoOp
+cgHostMipRowRGBA8_NEON
 (
-    uintptr_t  ctx, 
-    uintptr_t  pipeline, 
-    void      *opaque
+    uint8_t       *dst,
+    uint8_t const *src0,
+    uint8_t const *src1,
+    size_t         dst_width,
+    size_t         src_width
 )
 {
-    UNREFERENCED_PARAMETER(ctx);
-    UNREFERENCED_PARAMETER(pipeline);
-    UNREFERENCED_PARAMETER(opaque);
+    size_t n = src_width >= 2 ? dst_width : 0;
+    size_t x = 0;
+    for ( ; x + 2 <= n; x += 2)
+    {   // 4 source pixels from each row produce 2 destination pixels.
+        uint8x16_t r0 = vld1q_u8(src0 + x * 8);
+        uint8x16_t r1 = vld1q_u8(src1 + x * 8);
+        uint16x8_t lo = vaddl_u8(vget_low_u8 (r0), vget_low_u8 (r1));
+        uint16x8_t hi = vaddl_u8(vget_high_u8(r0), vget_high_u8(r1));
+        uint16x4_t s0 = vadd_u16(vget_low_u16(lo), vget_high_u16(lo));
+        uint16x4_t s1 = vadd_u16(vget_low_u16(hi), vget_high_u16(hi));
+        vst1_u8(dst + x * 4, vrshrn_n_u16(vcombine_u16(s0, s1), 2));
+    }
+    if (x < dst_width)
+        cgHostMipRowRGBA8_Scalar(dst + x * 4, src0 + x * 8, src1 + x * 8, dst_width - x, src_width - x * 2);
 }
 
-/// @summary Implements the DEVICE_FENCE command, inserting a fence in an in-order graphics queue or an out-of-order compute or transfer queue.
-/// The fence ensures that some or all of the commands inserted into the queue prior to the fence have completed before executing commands enqueued after the fence.
-/// @param ctx The CGFX context returned by cgEnumerateDevices.
-/// @param queue The command queue into which the fence command is being inserted.
-/// @param cmdbuf The command buffer defining the fence command.
-/// @param cmd The fence command and any associated data.
-/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_INVALID_STATE, CG_BAD_CLCONTEXT, CG_UNSUPPORTED, CG_OUT_OF_MEMORY, CG_OUT_OF_OBJECTS or CG_ERROR.
-internal_function int
-cgExecuteDeviceFence
+/// @summary Downsample one row of an R16G16B16A16_FLOAT image using NEON half-precision conversions. See cgHostMipRowRGBA16F_Scalar.
+internal_function void
+cgHostMipRowRGBA16F_NEON
 (
-    CG_CONTEXT    *ctx, 
-    CG_QUEUE      *queue, 
-    CG_CMD_BUFFER *cmdbuf, 
-    cg_command_t  *cmd
+    uint8_t       *dst,
+    uint8_t const *src0,
+    uint8_t const *src1,
+    size_t         dst_width,
+    size_t         src_width
 )
-{   UNREFERENCED_PARAMETER(cmdbuf);
-    // proceed with command execution. a fence can either be a graphics 
-    // fence or a compute/transfer fence. a graphics fence could be linked
-    // to an OpenCL event from a clReleaseGLObjects command. since graphics
-    // queues are always in-order, a fence blocks execution until all prior 
-    // commands have completed. a compute or transfer queue fence, on the 
-    // other hand, supports out-of-order execution and can support waiting 
-    // for a specific set of events to become signaled.
-    cg_device_fence_cmd_data_t *ddp = (cg_device_fence_cmd_data_t*) cmd->Data;
-    CG_FENCE *fence = cgObjectTableGet(&ctx->FenceTable, ddp->FenceObject);
-    if (fence == NULL || (queue->QueueType & fence->QueueType) == 0)
-    {   // invalid fence object, or queue type doesn't match fence.
-        return CG_INVALID_VALUE;
+{
+    size_t n = src_width >= 2 ? dst_width : 0;
+    size_t x = 0;
+    for ( ; x < n; ++x)
+    {   // 2 source pixels from each row produce 1 destination pixel.
+        uint16x8_t  r0 = vld1q_u16((uint16_t const*) (src0 + x * 16));
+        uint16x8_t  r1 = vld1q_u16((uint16_t const*) (src1 + x * 16));
+        float32x4_t p0 = vaddq_f32(vcvt_f32_f16(vreinterpret_f16_u16(vget_low_u16 (r0))), vcvt_f32_f16(vreinterpret_f16_u16(vget_low_u16 (r1))));
+        float32x4_t p1 = vaddq_f32(vcvt_f32_f16(vreinterpret_f16_u16(vget_high_u16(r0))), vcvt_f32_f16(vreinterpret_f16_u16(vget_high_u16(r1))));
+        vst1_u16((uint16_t*) (dst + x * 8), vreinterpret_u16_f16(vcvt_f16_f32(vmulq_n_f32(vaddq_f32(p0, p1), 0.25f))));
+    }
+    if (x < dst_width)
+        cgHostMipRowRGBA16F_Scalar(dst + x * 8, src0 + x * 16, src1 + x * 16, dst_width - x, src_width - x * 2);
+}
+
+/// @summary Downsample one row of an R32_FLOAT image using NEON. See cgHostMipRowR32F_Scalar.
+internal_function void
+cgHostMipRowR32F_NEON
+(
+    uint8_t       *dst,
+    uint8_t const *src0,
+    uint8_t const *src1,
+    size_t         dst_width,
+    size_t         src_width
+)
+{
+    size_t n = src_width >= 2 ? dst_width : 0;
+    size_t x = 0;
+    for ( ; x + 4 <= n; x += 4)
+    {   // vld2q splits 8 source pixels into even and odd columns.
+        float32x4x2_t a = vld2q_f32((float const*) src0 + x * 2);
+        float32x4x2_t b = vld2q_f32((float const*) src1 + x * 2);
+        float32x4_t   s = vaddq_f32(vaddq_f32(a.val[0], b.val[0]), vaddq_f32(a.val[1], b.val[1]));
+        vst1q_f32((float*) dst + x, vmulq_n_f32(s, 0.25f));
+    }
+    if (x < dst_width)
+        cgHostMipRowR32F_Scalar(dst + x * 4, src0 + x * 8, src1 + x * 8, dst_width - x, src_width - x * 2);
+}
+#endif /* ARM */
+
+/// @summary Select the row kernel used to downsample images of a given format.
+/// @param format One of dxgi_format_e or DXGI_FORMAT.
+/// @param flags A combination of cg_host_mipmap_flags_e.
+/// @return The row kernel, or NULL if the format is not supported.
+internal_function cgHostMipRow_fn
+cgHostMipmapSelectRowFunc
+(
+    uint32_t format,
+    uint32_t flags
+)
+{
+    bool scalar = (flags & CG_HOST_MIPMAP_FLAG_SCALAR) != 0;
+#if defined(_M_IX86) || defined(_M_X64)
+    bool avx2   = !scalar && cgHostCpuSupportsAVX2();
+#endif
+    switch (format)
+    {
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+        if (scalar) return cgHostMipRowRGBA8_Scalar;
+#if   defined(_M_IX86) || defined(_M_X64)
+        return avx2 ? cgHostMipRowRGBA8_AVX2 : cgHostMipRowRGBA8_SSE2;
+#elif defined(_M_ARM)  || defined(_M_ARM64)
+        return cgHostMipRowRGBA8_NEON;
+#else
+        return cgHostMipRowRGBA8_Scalar;
+#endif
+
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+        // without gathers, the table lookups dominate and the scalar kernel is as fast as SSE2 or NEON.
+#if   defined(_M_IX86) || defined(_M_X64)
+        if (avx2)   return cgHostMipRowSRGBA8_AVX2;
+#endif
+        return cgHostMipRowSRGBA8_Scalar;
+
+    case DXGI_FORMAT_R16G16B16A16_FLOAT:
+        if (scalar) return cgHostMipRowRGBA16F_Scalar;
+#if   defined(_M_IX86) || defined(_M_X64)
+        return avx2 ? cgHostMipRowRGBA16F_AVX2 : cgHostMipRowRGBA16F_SSE2;
+#elif defined(_M_ARM)  || defined(_M_ARM64)
+        return cgHostMipRowRGBA16F_NEON;
+#else
+        return cgHostMipRowRGBA16F_Scalar;
+#endif
+
+    case DXGI_FORMAT_R32_FLOAT:
+        if (scalar) return cgHostMipRowR32F_Scalar;
+#if   defined(_M_IX86) || defined(_M_X64)
+        return avx2 ? cgHostMipRowR32F_AVX2 : cgHostMipRowR32F_SSE2;
+#elif defined(_M_ARM)  || defined(_M_ARM64)
+        return cgHostMipRowR32F_NEON;
+#else
+        return cgHostMipRowR32F_Scalar;
+#endif
+
+    default:
+        break;
+    }
+    return NULL;
+}
+
+/// @summary Downsample the destination rows assigned to host mipmap work items until no work items remain.
+/// @param job The description of the mipmap level being generated.
+internal_function void
+cgHostMipmapRunTasks
+(
+    CG_HOST_MIPMAP_JOB *job
+)
+{
+    LONG task;
+    while ((task = InterlockedIncrement(&job->NextTask) - 1) < job->TaskCount)
+    {
+        size_t   item   = size_t(task) / job->TasksPerItem;
+        size_t   band   = size_t(task) % job->TasksPerItem;
+        size_t   y0     = band * job->RowsPerTask;
+        size_t   y1     =(y0 + job->RowsPerTask) < job->DstHeight ? (y0 + job->RowsPerTask) : job->DstHeight;
+        uint8_t *src    = job->ImageData + item * job->ItemPitch + job->SrcOffset;
+        uint8_t *dst    = job->ImageData + item * job->ItemPitch + job->DstOffset;
+        for (size_t y = y0; y < y1; ++y)
+        {
+            size_t sy0 = (y * 2 + 0);
+            size_t sy1 =((y * 2 + 1) < job->SrcHeight ? (y * 2 + 1) : (job->SrcHeight - 1));
+            job->RowFunc(dst + y * job->DstRowPitch, src + sy0 * job->SrcRowPitch, src + sy1 * job->SrcRowPitch, job->DstWidth, job->SrcWidth);
+        }
     }
+}
 
-    if (fence->QueueType == CG_QUEUE_TYPE_GRAPHICS)
-    {   // create and enqueue an OpenGL fence sync object.
-        CG_DISPLAY *display = fence->AttachedDisplay;
-        GLsync      sync    = NULL;
+/// @summary Thread pool callback used to execute host mipmap work items.
+/// @param instance The thread pool callback instance. Unused.
+/// @param context The CG_HOST_MIPMAP_JOB describing the level being generated.
+/// @param work The thread pool work object. Unused.
+internal_function void CALLBACK
+cgHostMipmapWorker
+(
+    PTP_CALLBACK_INSTANCE instance,
+    void                 *context,
+    PTP_WORK              work
+)
+{
+    cgHostMipmapRunTasks((CG_HOST_MIPMAP_JOB*) context);
+    UNREFERENCED_PARAMETER(instance);
+    UNREFERENCED_PARAMETER(work);
+}
 
-        // if there's an existing sync object associated with the fence, delete it.
-        if (fence->GraphicsFence != NULL)
+/// @summary Load a 4x4 block of R8G8B8A8 pixels for block compression. Pixels beyond the edge of the image replicate
+/// the last row or column, and are given a weight of zero so that they do not contribute to the endpoint fit or the error.
+/// @param block The block to initialize.
+/// @param src The first pixel of the source image.
+/// @param src_row_pitch The number of bytes per-row in the source image.
+/// @param width The width of the source image, in pixels.
+/// @param height The height of the source image, in pixels.
+/// @param bx The zero-based column index of the block.
+/// @param by The zero-based row index of the block.
+internal_function void
+cgBcLoadBlock
+(
+    CG_BC_BLOCK   *block,
+    uint8_t const *src,
+    size_t         src_row_pitch,
+    size_t         width,
+    size_t         height,
+    size_t         bx,
+    size_t         by
+)
+{
+    for (size_t y = 0; y < 4; ++y)
+    {
+        size_t sy = (by * 4 + y) < height ? (by * 4 + y) : (height - 1);
+        for (size_t x = 0; x < 4; ++x)
         {
-            glDeleteSync(fence->GraphicsFence);
-            fence->GraphicsFence  = NULL;
-        }
+            size_t         sx = (bx * 4 + x) < width ? (bx * 4 + x) : (width - 1);
+            uint8_t const *p  =  src + sy * src_row_pitch + sx * 4;
+            size_t         i  =  y  * 4 + x;
+            block->Pixels[0][i] = float(p[0]);
+            block->Pixels[1][i] = float(p[1]);
+            block->Pixels[2][i] = float(p[2]);
+            block->Pixels[3][i] = float(p[3]);
+            block->Weight[i]    =(sx == bx * 4 + x && sy == by * 4 + y) ? 1.0f : 0.0f;
+        }
+    }
+    block->FirstChannel = 0;
+    block->ChannelCount = 4;
+    block->ColorMode    = CG_BC_COLOR_MODE_BC1;
+}
 
-        // generate a new sync object and insert the fence command in the OpenGL context's command queue.
-        if (fence->LinkedEvent != CG_INVALID_HANDLE)
-        {   // the fence is linked to an OpenCL event, so use GL_ARB_cl_event.
-            CG_EVENT *event = cgObjectTableGet(&ctx->EventTable, fence->LinkedEvent);
-            if (event == NULL || event->ComputeEvent == NULL)
-            {   // the compute or transfer queue command associated with the event hasn't
-                // yet been submitted to a command queue, so the operation is invalid.
-                return CG_INVALID_STATE;
-            }
-            if (GLEW_ARB_cl_event)
-            {   // create the OpenGL sync object and insert it into the command stream.
-                if ((sync = glCreateSyncFromCLeventARB(queue->ComputeContext, event->ComputeEvent, 0)) == NULL)
-                {
-                    GLenum  glerr = glGetError();
-                    switch (glerr)
-                    {
-                    case GL_INVALID_VALUE    : return CG_BAD_CLCONTEXT;
-                    case GL_INVALID_OPERATION: return CG_INVALID_STATE;
-                    default: break;
-                    }
-                    return CG_ERROR;
-                }
-            }
-            else
-            {   // GL_ARB_cl_event is not supported by the runtime. fail.
-                return CG_UNSUPPORTED;
+/// @summary Assign each pixel of a block to the nearest entry of a palette. Only the channels in [FirstChannel, FirstChannel+ChannelCount) are compared.
+/// @param block The block being encoded.
+/// @param palette The palette entries, indexed by entry and then by channel.
+/// @param palette_size The number of palette entries, at most 16.
+/// @param indices On return, stores the palette index for each of the 16 pixels.
+/// @return The sum of squared errors over all pixels with a non-zero weight.
+internal_function float
+cgBcFitIndices_Scalar
+(
+    CG_BC_BLOCK const *block,
+    float       const (*palette)[4],
+    size_t             palette_size,
+    uint8_t           *indices
+)
+{
+    size_t c0    = block->FirstChannel;
+    size_t c1    = block->FirstChannel + block->ChannelCount;
+    float  total = 0.0f;
+    for (size_t i = 0; i < 16; ++i)
+    {
+        float  best  = FLT_MAX;
+        size_t index = 0;
+        for (size_t k = 0; k < palette_size; ++k)
+        {
+            float d = 0.0f;
+            for (size_t c = c0; c < c1; ++c)
+            {
+                float t = block->Pixels[c][i] - palette[k][c];
+                d += t * t;
             }
-        }
-        else
-        {   // the fence is not linked to an OpenCL event.
-            if ((sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)) == NULL)
+            if (d < best)
             {
-                GLenum  glerr = glGetError();
-                switch (glerr)
-                {
-                case GL_INVALID_ENUM : return CG_INVALID_VALUE;
-                case GL_INVALID_VALUE: return CG_INVALID_VALUE;
-                default              : break;
-                }
-                return CG_ERROR;
+                best  = d;
+                index = k;
             }
         }
-        // insert a wait command to act as a barrier in the GPU command queue.
-        // issue a glFlush prior to the barrier to ensure that the sync object
-        // has been flushed to the GPU command queue by the driver.
-        glFlush();  glWaitSync(sync, 0, GL_TIMEOUT_IGNORED);
-        fence->GraphicsFence = sync;
-        return cgSetupCompleteEvent(ctx, queue, ddp->CompleteEvent, NULL, sync, CG_SUCCESS);
+        indices[i] = uint8_t(index);
+        total     += best * block->Weight[i];
     }
-    else
-    {   // enqueue an OpenCL barrier. there could be a wait list.
-        int       result     = CG_SUCCESS;
-        cl_int    clres      = CL_SUCCESS;
-        cl_uint   wait_count = 0;
-        cl_event  cl_fence   = NULL;
-        cl_event *wait_list  = NULL;
-        bool     *wait_free  = NULL;
-        cl_event  wait_stack[16];
-        bool      free_stack[16];
+    return total;
+}
 
-        // if there's an existing sync object associated with this fence, delete it.
-        if (fence->ComputeFence != NULL)
+#if defined(_M_IX86) || defined(_M_X64)
+/// @summary Assign each pixel of a block to the nearest entry of a palette using SSE2, four pixels at a time. See cgBcFitIndices_Scalar.
+internal_function float
+cgBcFitIndices_SSE2
+(
+    CG_BC_BLOCK const *block,
+    float       const (*palette)[4],
+    size_t             palette_size,
+    uint8_t           *indices
+)
+{
+    size_t c0  = block->FirstChannel;
+    size_t c1  = block->FirstChannel + block->ChannelCount;
+    __m128 acc = _mm_setzero_ps();
+    for (size_t i = 0; i < 16; i += 4)
+    {
+        __m128  best  = _mm_set1_ps(FLT_MAX);
+        __m128i index = _mm_setzero_si128();
+        for (size_t k = 0; k < palette_size; ++k)
         {
-            clReleaseEvent(fence->ComputeFence);
-            fence->ComputeFence  = NULL;
-        }
-
-        // generate the event wait list. it's possible that there is no wait list, 
-        // in which case the fence waits for all prior commands in the queue to be
-        // completed, or it's possible that a specific list of events is specified 
-        // to satisfy the barrier condition.
-        if (ddp->WaitListCount == 0)
-        {   // simple case, this is a fence for all prior commands in the queue.
-            wait_count = 0; wait_list = NULL;
-        }
-        else
-        {   // there is a wait list involved. convert the wait handles into 
-            // an array of cl_event instances to wait on. in most cases we 
-            // should just be able to use stack memory.
-            if (ddp->WaitListCount <= 16)
-            {   // just use the stack arrays; no dynamic allocation.
-                wait_count = 0;
-                wait_list  = wait_stack;
-                wait_free  = free_stack;
-            }
-            else
-            {   // need to wait on many individual events. allocate temporary memory.
-                wait_list  = (cl_event*) cgAllocateHostMemory(&ctx->HostAllocator, ddp->WaitListCount * sizeof(cl_event), 1, CG_ALLOCATION_TYPE_TEMP);
-                wait_free  = (bool    *) cgAllocateHostMemory(&ctx->HostAllocator, ddp->WaitListCount * sizeof(bool)    , 1, CG_ALLOCATION_TYPE_TEMP);
-                if (wait_list == NULL || wait_free == NULL)
-                {   // unable to allocate the required memory.
-                    result = CG_OUT_OF_MEMORY;
-                    goto opencl_cleanup;
-                }
-            }
-            for (size_t i = 0, n = ddp->WaitListCount; i < n; ++i)
+            __m128 d = _mm_setzero_ps();
+            for (size_t c = c0; c < c1; ++c)
             {
-                if ((result = cgGetWaitEvent(ctx, queue, ddp->WaitList[i], wait_list, wait_count, cl_uint(n), wait_free[wait_count])) != CG_SUCCESS)
-                {   // unable to retrieve the OpenCL event object to wait on.
-                    goto opencl_cleanup;
-                }
+                __m128 t = _mm_sub_ps(_mm_loadu_ps(&block->Pixels[c][i]), _mm_set1_ps(palette[k][c]));
+                d = _mm_add_ps(d, _mm_mul_ps(t, t));
             }
-        }
+            __m128i lt = _mm_castps_si128(_mm_cmplt_ps(d, best));
+            best  = _mm_min_ps(d, best);
+            index = _mm_or_si128(_mm_and_si128(lt, _mm_set1_epi32(int(k))), _mm_andnot_si128(lt, index));
+        }
+        // pack the four 32-bit indices into bytes.
+        index = _mm_packs_epi32(index, index);
+        index = _mm_packus_epi16(index, index);
+        *(int*) (indices + i) = _mm_cvtsi128_si32(index);
+        acc = _mm_add_ps(acc, _mm_mul_ps(best, _mm_loadu_ps(&block->Weight[i])));
+    }
+    // the errors are integers well below 2^24, so the order of summation does not matter.
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(acc);
+}
+#endif
 
-        // insert the barrier command in the OpenCL command queue.
-        if ((clres = clEnqueueBarrierWithWaitList(queue->CommandQueue, wait_count, wait_list, &cl_fence)) != CL_SUCCESS)
-        {   
-            switch (clres)
-            {
-            case CL_INVALID_COMMAND_QUEUE  : result = CG_BAD_CLCONTEXT; break;
-            case CL_INVALID_EVENT_WAIT_LIST: result = CG_INVALID_VALUE; break;
-            case CL_OUT_OF_RESOURCES       : result = CG_OUT_OF_MEMORY; break;
-            case CL_OUT_OF_HOST_MEMORY     : result = CG_OUT_OF_MEMORY; break;
-            default                        : result = CG_ERROR;         break;
-            }
-            goto opencl_cleanup;
-        }
-        fence->ComputeFence = cl_fence;
-        result = CG_SUCCESS;
-        /* fall through to opencl_cleanup */
+/// @summary Assign each pixel of a block to the nearest entry of a palette, using the fastest implementation for the host CPU.
+/// @param block The block being encoded.
+/// @param palette The palette entries, indexed by entry and then by channel.
+/// @param palette_size The number of palette entries, at most 16.
+/// @param indices On return, stores the palette index for each of the 16 pixels.
+/// @return The sum of squared errors over all pixels with a non-zero weight.
+internal_function inline float
+cgBcFitIndices
+(
+    CG_BC_BLOCK const *block,
+    float       const (*palette)[4],
+    size_t             palette_size,
+    uint8_t           *indices
+)
+{
+#if defined(_M_IX86) || defined(_M_X64)
+    return cgBcFitIndices_SSE2  (block, palette, palette_size, indices);
+#else
+    return cgBcFitIndices_Scalar(block, palette, palette_size, indices);
+#endif
+}
 
-    opencl_cleanup:
-        for (size_t wait_i = 0, wait_n = wait_count; wait_i < wait_n; ++wait_i)
-        {   // free temporary event objects.
-            if (wait_free[wait_i])
-                clReleaseEvent(wait_list[wait_i]);
+/// @summary Compute the initial endpoints for a block as the extremes of the pixels projected onto their principal axis.
+/// @param block The block being encoded.
+/// @param e0 On return, stores the endpoint at the low end of the axis. Only the block channels are written.
+/// @param e1 On return, stores the endpoint at the high end of the axis.
+internal_function void
+cgBcPrincipalEndpoints
+(
+    CG_BC_BLOCK const *block,
+    float             *e0,
+    float             *e1
+)
+{
+    size_t c0     = block->FirstChannel;
+    size_t c1     = block->FirstChannel + block->ChannelCount;
+    float  mean[4]= { 0.0f, 0.0f, 0.0f, 0.0f };
+    float  cov[4][4];
+    float  axis[4]= { 0.0f, 0.0f, 0.0f, 0.0f };
+    float  wsum   = 0.0f;
+    float  tmin   = FLT_MAX;
+    float  tmax   =-FLT_MAX;
+    size_t maxc   = c0;
+
+    memset(cov, 0, sizeof(cov));
+    for (size_t i = 0; i < 16; ++i)
+    {
+        for (size_t c = c0; c < c1; ++c)
+            mean[c] += block->Pixels[c][i] * block->Weight[i];
+        wsum += block->Weight[i];
+    }
+    if (wsum == 0.0f)
+    {   // no pixel contributes to the error.
+        for (size_t c = c0; c < c1; ++c)
+            e0[c] = e1[c] = 0.0f;
+        return;
+    }
+    for (size_t c = c0; c < c1; ++c)
+        mean[c] /= wsum;
+    for (size_t i = 0; i < 16; ++i)
+    {
+        for (size_t a = c0; a < c1; ++a)
+        {
+            for (size_t b = c0; b < c1; ++b)
+                cov[a][b] += (block->Pixels[a][i] - mean[a]) * (block->Pixels[b][i] - mean[b]) * block->Weight[i];
         }
-        if (wait_list != &wait_stack[0])
-        {   // free the temporary wait list memory.
-            if (wait_free != NULL) cgFreeHostMemory(&ctx->HostAllocator, wait_free, ddp->WaitListCount * sizeof(bool)    , 1, CG_ALLOCATION_TYPE_TEMP);
-            if (wait_list != NULL) cgFreeHostMemory(&ctx->HostAllocator, wait_list, ddp->WaitListCount * sizeof(cl_event), 1, CG_ALLOCATION_TYPE_TEMP);
+    }
+    // power iteration, starting from the column with the largest variance so the start vector is never orthogonal to the principal axis.
+    for (size_t c = c0; c < c1; ++c)
+    {
+        if (cov[c][c] > cov[maxc][maxc])
+            maxc = c;
+    }
+    for (size_t c = c0; c < c1; ++c)
+        axis[c] = cov[c][maxc];
+    for (size_t iter = 0; iter < 8; ++iter)
+    {
+        float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        float norm    = 0.0f;
+        for (size_t a = c0; a < c1; ++a)
+        {
+            for (size_t b = c0; b < c1; ++b)
+                next[a] += cov[a][b] * axis[b];
+            norm += next[a] * next[a];
         }
-        return cgSetupCompleteEvent(ctx, queue, ddp->CompleteEvent, cl_fence, NULL, result);
+        if (norm < 1.0e-12f)
+            break;
+        norm = 1.0f / sqrtf(norm);
+        for (size_t c = c0; c < c1; ++c)
+            axis[c] = next[c] * norm;
+    }
+    for (size_t i = 0; i < 16; ++i)
+    {
+        float t = 0.0f;
+        if (block->Weight[i] == 0.0f)
+            continue;
+        for (size_t c = c0; c < c1; ++c)
+            t += (block->Pixels[c][i] - mean[c]) * axis[c];
+        if (t < tmin) tmin = t;
+        if (t > tmax) tmax = t;
+    }
+    for (size_t c = c0; c < c1; ++c)
+    {
+        float a = mean[c] + tmin * axis[c];
+        float b = mean[c] + tmax * axis[c];
+        e0[c]   = a < 0.0f ? 0.0f : (a > 255.0f ? 255.0f : a);
+        e1[c]   = b < 0.0f ? 0.0f : (b > 255.0f ? 255.0f : b);
     }
 }
 
-/// @summary Implements the PIPELINE_DISPATCH command for a compute command queue.
-/// @param ctx The CGFX context returned by cgEnumerateDevices.
-/// @param queue The command queue into which the command is being inserted.
-/// @param cmdbuf The command buffer defining the command.
-/// @param cmd The command and any associated data.
-/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_INVALID_STATE, CG_BAD_CLCONTEXT, CG_UNSUPPORTED, CG_OUT_OF_MEMORY, CG_OUT_OF_OBJECTS or CG_ERROR.
-internal_function int
-cgExecuteComputePipelineDispatch
+/// @summary Solve for the endpoints that minimize the squared error of a block given fixed palette indices.
+/// @param block The block being encoded.
+/// @param indices The palette index of each pixel.
+/// @param index_t The position of each palette entry along the line from @a e0 to @a e1, or a negative value for entries that are not on the line.
+/// @param e0 On return, stores the first endpoint. Only the block channels are written.
+/// @param e1 On return, stores the second endpoint.
+/// @return true if the endpoints were updated, or false if the system is degenerate.
+internal_function bool
+cgBcRefineEndpoints
 (
-    CG_CONTEXT    *ctx, 
-    CG_QUEUE      *queue, 
-    CG_CMD_BUFFER *cmdbuf, 
-    cg_command_t  *cmd
+    CG_BC_BLOCK const *block,
+    uint8_t     const *indices,
+    float       const *index_t,
+    float             *e0,
+    float             *e1
 )
 {
-    CG_PIPELINE         *pipeline =  NULL;
-    cg_pipeline_cmd_base_t *cdata = (cg_pipeline_cmd_base_t*) cmd->Data;
-    cgPipelineExecute_fn    cfunc =  cgGetComputePipelineCallback(cdata->PipelineId);
-    if (cfunc == NULL)
-    {   // this pipeline hasn't been registered yet.
-        return CG_INVALID_VALUE;
+    size_t c0   = block->FirstChannel;
+    size_t c1   = block->FirstChannel + block->ChannelCount;
+    float  aa   = 0.0f;
+    float  ab   = 0.0f;
+    float  bb   = 0.0f;
+    float  x0[4]= { 0.0f, 0.0f, 0.0f, 0.0f };
+    float  x1[4]= { 0.0f, 0.0f, 0.0f, 0.0f };
+    float  det;
+    for (size_t i = 0; i < 16; ++i)
+    {
+        float t = index_t[indices[i]];
+        float w = block->Weight[i];
+        if (t < 0.0f || w == 0.0f)
+            continue;
+        aa += w * (1.0f - t) * (1.0f - t);
+        ab += w * (1.0f - t) * t;
+        bb += w * t * t;
+        for (size_t c = c0; c < c1; ++c)
+        {
+            x0[c] += w * (1.0f - t) * block->Pixels[c][i];
+            x1[c] += w * t * block->Pixels[c][i];
+        }
     }
-    if ((pipeline = cgObjectTableGet(&ctx->PipelineTable, cdata->Pipeline)) == NULL)
-    {   // the pipeline ID is valid, but the pipeline state handle is not valid.
-        return CG_INVALID_VALUE;
+    if (fabsf(det = aa * bb - ab * ab) < 1.0e-6f)
+        return false;
+    for (size_t c = c0; c < c1; ++c)
+    {
+        float a = (bb * x0[c] - ab * x1[c]) / det;
+        float b = (aa * x1[c] - ab * x0[c]) / det;
+        e0[c]   = a < 0.0f ? 0.0f : (a > 255.0f ? 255.0f : a);
+        e1[c]   = b < 0.0f ? 0.0f : (b > 255.0f ? 255.0f : b);
     }
-    return cfunc(ctx, queue, cmdbuf, pipeline, cmd);
+    return true;
 }
 
-/// @summary Implements the PIPELINE_DISPATCH command for a graphics command queue.
-/// @param ctx The CGFX context returned by cgEnumerateDevices.
-/// @param queue The command queue into which the command is being inserted.
-/// @param cmdbuf The command buffer defining the command.
-/// @param cmd The command and any associated data.
-/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_INVALID_STATE, CG_BAD_CLCONTEXT, CG_UNSUPPORTED, CG_OUT_OF_MEMORY, CG_OUT_OF_OBJECTS or CG_ERROR.
-internal_function int
-cgExecuteGraphicsPipelineDispatch
+/// @summary Retrieve the number of least-squares endpoint refinement passes performed by the block compressor at a given quality level.
+/// @param quality One of cg_block_compression_quality_e.
+/// @return The maximum number of refinement passes.
+internal_function inline int
+cgBcRefineIterations
 (
-    CG_CONTEXT    *ctx, 
-    CG_QUEUE      *queue, 
-    CG_CMD_BUFFER *cmdbuf, 
-    cg_command_t  *cmd
+    int quality
 )
 {
-    CG_PIPELINE         *pipeline =  NULL;
-    cg_pipeline_cmd_base_t *cdata = (cg_pipeline_cmd_base_t*) cmd->Data;
-    cgPipelineExecute_fn    cfunc =  cgGetGraphicsPipelineCallback(cdata->PipelineId);
-    if (cfunc == NULL)
-    {   // this pipeline hasn't been registered yet.
-        return CG_INVALID_VALUE;
+    switch (quality)
+    {
+    case CG_BLOCK_COMPRESSION_QUALITY_FAST  : return 0;
+    case CG_BLOCK_COMPRESSION_QUALITY_NORMAL: return 2;
+    default                                 : return 4;
     }
-    if ((pipeline = cgObjectTableGet(&ctx->PipelineTable, cdata->Pipeline)) == NULL)
-    {   // the pipeline ID is valid, but the pipeline state handle is not valid.
-        return CG_INVALID_VALUE;
+}
+
+/// @summary Append a value to a block of compressed data, least-significant bit first.
+/// @param out The block data, which must be zero-initialized.
+/// @param pos The bit position at which the value is written. On return, this value is advanced by @a count.
+/// @param count The number of bits to write.
+/// @param value The value to write.
+internal_function inline void
+cgBcPutBits
+(
+    uint8_t  *out,
+    size_t   &pos,
+    size_t    count,
+    uint32_t  value
+)
+{
+    for (size_t i = 0; i < count; ++i, ++pos)
+    {
+        out[pos >> 3] |= uint8_t(((value >> i) & 1) << (pos & 7));
     }
-    return cfunc(ctx, queue, cmdbuf, pipeline, cmd);
 }
 
-/// @summary Implements the COPY_BUFFER command, which copies data from one buffer to another.
-/// @param ctx The CGFX context returned by cgEnumerateDevices.
-/// @param queue The command queue into which the command is being inserted.
-/// @param cmdbuf The command buffer defining the command.
-/// @param cmd The command and any associated data.
-/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_INVALID_STATE, CG_BAD_CLCONTEXT, CG_UNSUPPORTED, CG_OUT_OF_MEMORY, CG_OUT_OF_OBJECTS or CG_ERROR.
-internal_function int
-cgExecuteCopyBufferRegion
+/// @summary Improve quantized endpoints by repeatedly stepping each component by one unit while the error decreases.
+/// @param block The block being encoded.
+/// @param eval The function used to evaluate a set of quantized endpoint parameters.
+/// @param params The quantized endpoint parameters. On return, stores the best parameters found.
+/// @param max_values The maximum value of each parameter.
+/// @param param_count The number of parameters.
+/// @param best_error The error of @a params. On return, stores the error of the best parameters found.
+internal_function void
+cgBcGreedySearch
 (
-    CG_CONTEXT    *ctx, 
-    CG_QUEUE      *queue, 
-    CG_CMD_BUFFER *cmdbuf, 
-    cg_command_t  *cmd
+    CG_BC_BLOCK const *block,
+    cgBcEvaluate_fn    eval,
+    int               *params,
+    int         const *max_values,
+    size_t             param_count,
+    float             &best_error
 )
-{   UNREFERENCED_PARAMETER(cmdbuf);
-    cg_copy_buffer_cmd_t *ddp  = (cg_copy_buffer_cmd_t*) cmd->Data;
-    CG_BUFFER         *srcbuf  =  cgObjectTableGet(&ctx->BufferTable, ddp->SourceBuffer);
-    CG_BUFFER         *dstbuf  =  cgObjectTableGet(&ctx->BufferTable, ddp->TargetBuffer);
-    int                result  =  CG_SUCCESS;
-    size_t            nmemrefs =  0;
-    cl_uint           nwaitevt =  0;
-    cl_event          acquire  =  NULL;
-    cl_mem            memrefs[2];
-    cgMemRefListAddBuffer(srcbuf, memrefs, nmemrefs, 2, false);
-    cgMemRefListAddBuffer(dstbuf, memrefs, nmemrefs, 2, false);
-    if ((result = cgAcquireMemoryObjects(ctx, queue, memrefs, nmemrefs, ddp->WaitEvent, &acquire, nwaitevt, 1)) == CL_SUCCESS)
+{
+    uint8_t indices[16];
+    bool    improved = true;
+    for (size_t round = 0; round < CG_BC_SEARCH_ROUNDS && improved && best_error > 0.0f; ++round)
     {
-        cl_event  cl_done = NULL;
-        cl_int    cl_res  = clEnqueueCopyBuffer(
-            queue->CommandQueue, 
-            memrefs[0], /* src */
-            memrefs[1], /* dst */
-            ddp->SourceOffset, 
-            ddp->TargetOffset, 
-            ddp->CopyAmount, 
-            nwaitevt, 
-            CG_OPENCL_WAIT_LIST(nwaitevt, &acquire),
-            &cl_done);
-        if  (cl_res != CL_SUCCESS)
+        improved = false;
+        for (size_t i = 0; i < param_count; ++i)
         {
-            switch (cl_res)
+            for (int step = -1; step <= 1; step += 2)
             {
-            case CL_INVALID_COMMAND_QUEUE        : result = CG_BAD_CLCONTEXT; break;
-            case CL_INVALID_CONTEXT              : result = CG_BAD_CLCONTEXT; break;
-            case CL_INVALID_MEM_OBJECT           : result = CG_BAD_CLCONTEXT; break;
-            case CL_INVALID_VALUE                : result = CG_INVALID_VALUE; break;
-            case CL_INVALID_EVENT_WAIT_LIST      : result = CG_INVALID_VALUE; break;
-            case CL_MISALIGNED_SUB_BUFFER_OFFSET : result = CG_INVALID_VALUE; break;
-            case CL_MEM_COPY_OVERLAP             : result = CG_INVALID_VALUE; break;
-            case CL_MEM_OBJECT_ALLOCATION_FAILURE: result = CG_OUT_OF_MEMORY; break;
-            case CL_OUT_OF_RESOURCES             : result = CG_OUT_OF_MEMORY; break;
-            case CL_OUT_OF_HOST_MEMORY           : result = CG_OUT_OF_MEMORY; break;
-            default                              : result = CG_ERROR;         break;
+                int   old = params[i];
+                int   val = old + step;
+                float err;
+                if (val < 0 || val > max_values[i])
+                    continue;
+                params[i] = val;
+                if ((err  = eval(block, params, indices)) < best_error)
+                {
+                    best_error = err;
+                    improved   = true;
+                }
+                else params[i] = old;
             }
-            cgReleaseMemoryObjects(ctx, queue, memrefs, nmemrefs, NULL, 0, CG_INVALID_HANDLE);
-            return result;
         }
-        return cgReleaseMemoryObjects(ctx, queue, memrefs, nmemrefs, &cl_done, 1, ddp->CompleteEvent);
     }
-    return result;
 }
 
-/// @summary Implements the COPY_IMAGE command, which copies data from one image to another.
-/// @param ctx The CGFX context returned by cgEnumerateDevices.
-/// @param queue The command queue into which the command is being inserted.
-/// @param cmdbuf The command buffer defining the command.
-/// @param cmd The command and any associated data.
-/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_INVALID_STATE, CG_BAD_CLCONTEXT, CG_UNSUPPORTED, CG_OUT_OF_MEMORY, CG_OUT_OF_OBJECTS or CG_ERROR.
-internal_function int
-cgExecuteCopyImageRegion
+/// @summary Quantize an 8-bit color value to 5 or 6 bits.
+/// @param v The color value in [0, 255].
+/// @param bits The number of bits in the quantized value.
+/// @return The quantized value.
+internal_function inline int
+cgBcQuantize
 (
-    CG_CONTEXT    *ctx, 
-    CG_QUEUE      *queue, 
-    CG_CMD_BUFFER *cmdbuf, 
-    cg_command_t  *cmd
+    float v,
+    int   bits
 )
-{   UNREFERENCED_PARAMETER(cmdbuf);
-    cg_copy_image_cmd_t  *ddp  = (cg_copy_image_cmd_t*) cmd->Data;
-    CG_IMAGE          *srcimg  =  cgObjectTableGet(&ctx->ImageTable, ddp->SourceImage);
-    CG_IMAGE          *dstimg  =  cgObjectTableGet(&ctx->ImageTable, ddp->TargetImage);
-    int                result  =  CG_SUCCESS;
-    size_t            nmemrefs =  0;
-    cl_uint           nwaitevt =  0;
-    cl_event          acquire  =  NULL;
-    cl_mem            memrefs[2];
-    cgMemRefListAddImage(srcimg, memrefs, nmemrefs, 2, false);
-    cgMemRefListAddImage(dstimg, memrefs, nmemrefs, 2, false);
-    if ((result = cgAcquireMemoryObjects(ctx, queue, memrefs, nmemrefs, ddp->WaitEvent, &acquire, nwaitevt, 1)) == CL_SUCCESS)
+{
+    int   max = (1 << bits) - 1;
+    int   q   =  int(v * max / 255.0f + 0.5f);
+    return q  <  0 ? 0 : (q > max ? max : q);
+}
+
+/// @summary Evaluate a BC1 color block. The parameters are the 5:6:5 components of the two endpoints; the order of
+/// the endpoints is chosen by the block color mode, so any parameter values produce a valid block.
+/// @param block The block being encoded.
+/// @param params The endpoint parameters {r0, g0, b0, r1, g1, b1}.
+/// @param indices On return, stores the palette index for each pixel, for the canonical endpoint order.
+/// @return The sum of squared errors over the RGB channels.
+internal_function float
+cgBcEvaluateColor
+(
+    CG_BC_BLOCK const *block,
+    int         const *params,
+    uint8_t           *indices
+)
+{
+    float    palette[4][4];
+    uint16_t q0  = uint16_t((params[0] << 11) | (params[1] << 5) | params[2]);
+    uint16_t q1  = uint16_t((params[3] << 11) | (params[4] << 5) | params[5]);
+    int      lo  = 0;
+    int      hi  = 3;
+    float    err;
+    bool     three = (block->ColorMode == CG_BC_COLOR_MODE_BC1_ALPHA) || (block->ColorMode == CG_BC_COLOR_MODE_BC1 && q0 == q1);
+    if ((three && q0 > q1) || (!three && block->ColorMode == CG_BC_COLOR_MODE_BC1 && q0 < q1))
+    {   // the decoder selects the mode from the endpoint order, so swap them.
+        lo = 3; hi = 0;
+    }
+    for (size_t c = 0; c < 3; ++c)
     {
-        cl_event  cl_done = NULL;
-        cl_int    cl_res  = clEnqueueCopyImage(
-            queue->CommandQueue, 
-            memrefs[0], /* src */
-            memrefs[1], /* dst */
-            ddp->SourceOrigin, 
-            ddp->TargetOrigin, 
-            ddp->Dimensions, 
-            nwaitevt, 
-            CG_OPENCL_WAIT_LIST(nwaitevt, &acquire),
-            &cl_done);
-        if  (cl_res != CL_SUCCESS)
+        static int const bits[3] = { 5, 6, 5 };
+        int a = params[lo + c];
+        int b = params[hi + c];
+        a = (a << (8 - bits[c])) | (a >> (2 * bits[c] - 8));
+        b = (b << (8 - bits[c])) | (b >> (2 * bits[c] - 8));
+        palette[0][c] = float(a);
+        palette[1][c] = float(b);
+        palette[2][c] = three ? float((a + b + 1) / 2) : float((2 * a + b + 1) / 3);
+        palette[3][c] = three ? 0.0f : float((a + 2 * b + 1) / 3);
+    }
+    err = cgBcFitIndices(block, palette, three ? 3 : 4, indices);
+    if (block->ColorMode == CG_BC_COLOR_MODE_BC1_ALPHA)
+    {   // transparent pixels use index 3 and do not contribute to the error.
+        for (size_t i = 0; i < 16; ++i)
         {
-            switch (cl_res)
-            {
-            case CL_INVALID_COMMAND_QUEUE        : result = CG_BAD_CLCONTEXT; break;
-            case CL_INVALID_CONTEXT              : result = CG_BAD_CLCONTEXT; break;
-            case CL_INVALID_MEM_OBJECT           : result = CG_BAD_CLCONTEXT; break;
-            case CL_IMAGE_FORMAT_MISMATCH        : result = CG_INVALID_VALUE; break;
-            case CL_INVALID_IMAGE_SIZE           : result = CG_INVALID_VALUE; break;
-            case CL_INVALID_VALUE                : result = CG_INVALID_VALUE; break;
-            case CL_INVALID_EVENT_WAIT_LIST      : result = CG_INVALID_VALUE; break;
-            case CL_MEM_COPY_OVERLAP             : result = CG_INVALID_VALUE; break;
-            case CL_MEM_OBJECT_ALLOCATION_FAILURE: result = CG_OUT_OF_MEMORY; break;
-            case CL_OUT_OF_RESOURCES             : result = CG_OUT_OF_MEMORY; break;
-            case CL_OUT_OF_HOST_MEMORY           : result = CG_OUT_OF_MEMORY; break;
-            default                              : result = CG_ERROR;         break;
-            }
-            cgReleaseMemoryObjects(ctx, queue, memrefs, nmemrefs, NULL, 0, CG_INVALID_HANDLE);
-            return result;
+            if (block->Pixels[3][i] < 128.0f)
+                indices[i] = 3;
         }
-        return cgReleaseMemoryObjects(ctx, queue, memrefs, nmemrefs, &cl_done, 1, ddp->CompleteEvent);
     }
-    return result;
+    return err;
 }
 
-/// @summary Implements the COPY_BUFFER_TO_IMAGE command, which copies data from one image to another.
-/// @param ctx The CGFX context returned by cgEnumerateDevices.
-/// @param queue The command queue into which the command is being inserted.
-/// @param cmdbuf The command buffer defining the command.
-/// @param cmd The command and any associated data.
-/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_INVALID_STATE, CG_BAD_CLCONTEXT, CG_UNSUPPORTED, CG_OUT_OF_MEMORY, CG_OUT_OF_OBJECTS, CG_UNSUPPORTED or CG_ERROR.
-internal_function int
-cgExecuteCopyBufferToImage
+/// @summary Encode the color portion of a BC1, BC2 or BC3 block.
+/// @param block The block being encoded, with FirstChannel 0 and ChannelCount 3. For BC1, the weight of pixels with alpha below 128 must be zero.
+/// @param quality One of cg_block_compression_quality_e.
+/// @param out The 8 bytes of block data.
+/// @return The sum of squared errors over the RGB channels.
+internal_function float
+cgBcEncodeColor
 (
-    CG_CONTEXT    *ctx, 
-    CG_QUEUE      *queue, 
-    CG_CMD_BUFFER *cmdbuf, 
-    cg_command_t  *cmd
+    CG_BC_BLOCK const *block,
+    int                quality,
+    uint8_t           *out
 )
-{   UNREFERENCED_PARAMETER(cmdbuf);
-    cg_copy_buffer_to_image_cmd_t  *ddp  = (cg_copy_buffer_to_image_cmd_t*) cmd->Data;
-    CG_BUFFER         *srcbuf  =  cgObjectTableGet(&ctx->BufferTable, ddp->SourceBuffer);
-    CG_IMAGE          *dstimg  =  cgObjectTableGet(&ctx->ImageTable , ddp->TargetImage);
-    int                result  =  CG_SUCCESS;
-    size_t            nmemrefs =  0;
-    cl_uint           nwaitevt =  0;
-    cl_event          acquire  =  NULL;
-    cl_mem            memrefs[2];
-    cgMemRefListAddBuffer(srcbuf, memrefs, nmemrefs, 2, false);
-    cgMemRefListAddImage (dstimg, memrefs, nmemrefs, 2, false);
-    if ((result = cgAcquireMemoryObjects(ctx, queue, memrefs, nmemrefs, ddp->WaitEvent, &acquire, nwaitevt, 1)) == CL_SUCCESS)
+{
+    static float const t4[4]  = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+    static float const t3[4]  = { 0.0f, 1.0f, 0.5f, -1.0f };
+    static int   const max[6] = { 31, 63, 31, 31, 63, 31 };
+    uint8_t   indices[16];
+    int       best[6];
+    float     e0[4];
+    float     e1[4];
+    float     best_error;
+    uint16_t  q0, q1;
+    uint32_t  bits = 0;
+
+    cgBcPrincipalEndpoints(block, e0, e1);
+    best[0] = cgBcQuantize(e0[0], 5); best[1] = cgBcQuantize(e0[1], 6); best[2] = cgBcQuantize(e0[2], 5);
+    best[3] = cgBcQuantize(e1[0], 5); best[4] = cgBcQuantize(e1[1], 6); best[5] = cgBcQuantize(e1[2], 5);
+    best_error = cgBcEvaluateColor(block, best, indices);
+    for (int iter = 0; iter < cgBcRefineIterations(quality) && best_error > 0.0f; ++iter)
     {
-        cl_event  cl_done = NULL;
-        cl_int    cl_res  = clEnqueueCopyBufferToImage(
-            queue->CommandQueue, 
-            memrefs[0], /* src */
-            memrefs[1], /* dst */
-            ddp->SourceOffset, 
-            ddp->TargetOrigin, 
-            ddp->Dimensions, 
-            nwaitevt, 
-            CG_OPENCL_WAIT_LIST(nwaitevt, &acquire),
-            &cl_done);
-        if  (cl_res != CL_SUCCESS)
+        int   cand[6];
+        float err;
+        bool  three = (block->ColorMode == CG_BC_COLOR_MODE_BC1_ALPHA) || (block->ColorMode == CG_BC_COLOR_MODE_BC1 && memcmp(best, best + 3, 3 * sizeof(int)) == 0);
+        int   lo    =  0;
+        cgBcEvaluateColor(block, best, indices);
+        q0 = uint16_t((best[0] << 11) | (best[1] << 5) | best[2]);
+        q1 = uint16_t((best[3] << 11) | (best[4] << 5) | best[5]);
+        if ((three && q0 > q1) || (!three && block->ColorMode == CG_BC_COLOR_MODE_BC1 && q0 < q1))
+            lo = 3;  // the indices refer to the swapped endpoints.
+        if (!cgBcRefineEndpoints(block, indices, three ? t3 : t4, lo ? e1 : e0, lo ? e0 : e1))
+            break;
+        cand[0] = cgBcQuantize(e0[0], 5); cand[1] = cgBcQuantize(e0[1], 6); cand[2] = cgBcQuantize(e0[2], 5);
+        cand[3] = cgBcQuantize(e1[0], 5); cand[4] = cgBcQuantize(e1[1], 6); cand[5] = cgBcQuantize(e1[2], 5);
+        if ((err = cgBcEvaluateColor(block, cand, indices)) >= best_error)
+            break;
+        memcpy(best, cand, sizeof(best));
+        best_error = err;
+    }
+    if (quality >= CG_BLOCK_COMPRESSION_QUALITY_HIGH)
+    {
+        cgBcGreedySearch(block, cgBcEvaluateColor, best, max, 6, best_error);
+    }
+
+    // write the endpoints in the order expected by the decoder, with the matching indices.
+    cgBcEvaluateColor(block, best, indices);
+    q0 = uint16_t((best[0] << 11) | (best[1] << 5) | best[2]);
+    q1 = uint16_t((best[3] << 11) | (best[4] << 5) | best[5]);
+    if ((block->ColorMode == CG_BC_COLOR_MODE_BC1_ALPHA || (block->ColorMode == CG_BC_COLOR_MODE_BC1 && q0 == q1)) ? (q0 > q1) : (block->ColorMode == CG_BC_COLOR_MODE_BC1 && q0 < q1))
+    {
+        uint16_t t = q0; q0 = q1; q1 = t;
+    }
+    for (size_t i = 0; i < 16; ++i)
+        bits |= uint32_t(indices[i]) << (i * 2);
+    out[0] = uint8_t(q0); out[1] = uint8_t(q0 >> 8);
+    out[2] = uint8_t(q1); out[3] = uint8_t(q1 >> 8);
+    out[4] = uint8_t(bits); out[5] = uint8_t(bits >> 8); out[6] = uint8_t(bits >> 16); out[7] = uint8_t(bits >> 24);
+    return best_error;
+}
+
+/// @summary Evaluate a BC4 block. The order of the endpoints selects between the 8-value and 6-value modes.
+/// @param block The block being encoded, with ChannelCount 1.
+/// @param params The endpoint parameters {e0, e1}.
+/// @param indices On return, stores the palette index for each pixel.
+/// @return The sum of squared errors for the channel.
+internal_function float
+cgBcEvaluateAlpha
+(
+    CG_BC_BLOCK const *block,
+    int         const *params,
+    uint8_t           *indices
+)
+{
+    float  palette[8][4];
+    size_t c  = block->FirstChannel;
+    int    a  = params[0];
+    int    b  = params[1];
+    palette[0][c] = float(a);
+    palette[1][c] = float(b);
+    if (a > b)
+    {
+        for (int k = 1; k < 7; ++k)
+            palette[k + 1][c] = float(((7 - k) * a + k * b + 3) / 7);
+    }
+    else
+    {
+        for (int k = 1; k < 5; ++k)
+            palette[k + 1][c] = float(((5 - k) * a + k * b + 2) / 5);
+        palette[6][c] =   0.0f;
+        palette[7][c] = 255.0f;
+    }
+    return cgBcFitIndices(block, palette, 8, indices);
+}
+
+/// @summary Encode a single channel of a block as a BC4 block. Used for BC4, both halves of BC5 and the alpha of BC3.
+/// @param block The block being encoded, with ChannelCount 1.
+/// @param quality One of cg_block_compression_quality_e.
+/// @param out The 8 bytes of block data.
+/// @return The sum of squared errors for the channel.
+internal_function float
+cgBcEncodeAlpha
+(
+    CG_BC_BLOCK const *block,
+    int                quality,
+    uint8_t           *out
+)
+{
+    static float const t8[8]  = { 0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f };
+    static float const t6[8]  = { 0.0f, 1.0f, 1.0f / 5.0f, 2.0f / 5.0f, 3.0f / 5.0f, 4.0f / 5.0f, -1.0f, -1.0f };
+    static int   const max[2] = { 255, 255 };
+    size_t   c      = block->FirstChannel;
+    uint8_t  indices[16];
+    int      cand[2][2];
+    int      best[2];
+    float    best_error = FLT_MAX;
+    float    mn  = 255.0f, mx  = 0.0f;
+    float    mn6 = 255.0f, mx6 = 0.0f;
+    uint64_t bits = 0;
+
+    for (size_t i = 0; i < 16; ++i)
+    {
+        float v = block->Pixels[c][i];
+        if (block->Weight[i] == 0.0f)
+            continue;
+        if (v < mn) mn = v;
+        if (v > mx) mx = v;
+        if (v > 0.0f && v < 255.0f)
+        {   // the 6-value mode represents 0 and 255 exactly.
+            if (v < mn6) mn6 = v;
+            if (v > mx6) mx6 = v;
+        }
+    }
+    if (mn > mx)  mn  = mx  = 0.0f;
+    if (mn6> mx6) mn6 = mx6 = 0.0f;
+    // the 8-value mode requires e0 > e1, and the 6-value mode requires e0 <= e1.
+    cand[0][0] = int(mx);  cand[0][1] = int(mn);
+    cand[1][0] = int(mn6); cand[1][1] = int(mx6);
+    for (size_t m = 0; m < (quality >= CG_BLOCK_COMPRESSION_QUALITY_NORMAL ? 2U : 1U); ++m)
+    {
+        float err = cgBcEvaluateAlpha(block, cand[m], indices);
+        for (int iter = 0; iter < cgBcRefineIterations(quality) && err > 0.0f; ++iter)
         {
-            switch (cl_res)
-            {
-            case CL_INVALID_OPERATION            : result = CG_UNSUPPORTED;   break;
-            case CL_INVALID_COMMAND_QUEUE        : result = CG_BAD_CLCONTEXT; break;
-            case CL_INVALID_CONTEXT              : result = CG_BAD_CLCONTEXT; break;
-            case CL_INVALID_MEM_OBJECT           : result = CG_BAD_CLCONTEXT; break;
-            case CL_INVALID_IMAGE_SIZE           : result = CG_UNSUPPORTED;   break;
-            case CL_MISALIGNED_SUB_BUFFER_OFFSET : result = CG_INVALID_VALUE; break;
-            case CL_INVALID_VALUE                : result = CG_INVALID_VALUE; break;
-            case CL_INVALID_EVENT_WAIT_LIST      : result = CG_INVALID_VALUE; break;
-            case CL_MEM_COPY_OVERLAP             : result = CG_INVALID_VALUE; break;
-            case CL_MEM_OBJECT_ALLOCATION_FAILURE: result = CG_OUT_OF_MEMORY; break;
-            case CL_OUT_OF_RESOURCES             : result = CG_OUT_OF_MEMORY; break;
-            case CL_OUT_OF_HOST_MEMORY           : result = CG_OUT_OF_MEMORY; break;
-            default                              : result = CG_ERROR;         break;
-            }
-            cgReleaseMemoryObjects(ctx, queue, memrefs, nmemrefs, NULL, 0, CG_INVALID_HANDLE);
-            return result;
+            float e0[4], e1[4];
+            int   next[2];
+            float next_err;
+            if (!cgBcRefineEndpoints(block, indices, (cand[m][0] > cand[m][1]) ? t8 : t6, e0, e1))
+                break;
+            next[0] = int(e0[c] + 0.5f);
+            next[1] = int(e1[c] + 0.5f);
+            if ((m == 0 && next[0] <= next[1]) || (m == 1 && next[0] > next[1]))
+                break;  // the refined endpoints would switch modes.
+            if ((next_err = cgBcEvaluateAlpha(block, next, indices)) >= err)
+                break;
+            cand[m][0] = next[0];
+            cand[m][1] = next[1];
+            err = next_err;
+        }
+        if (quality >= CG_BLOCK_COMPRESSION_QUALITY_HIGH)
+        {
+            cgBcGreedySearch(block, cgBcEvaluateAlpha, cand[m], max, 2, err);
+        }
+        if (err < best_error)
+        {
+            best[0]    = cand[m][0];
+            best[1]    = cand[m][1];
+            best_error = err;
         }
-        return cgReleaseMemoryObjects(ctx, queue, memrefs, nmemrefs, &cl_done, 1, ddp->CompleteEvent);
     }
-    return result;
+
+    cgBcEvaluateAlpha(block, best, indices);
+    for (size_t i = 0; i < 16; ++i)
+        bits |= uint64_t(indices[i]) << (i * 3);
+    out[0] = uint8_t(best[0]);
+    out[1] = uint8_t(best[1]);
+    for (size_t i = 0; i < 6; ++i)
+        out[i + 2] = uint8_t(bits >> (i * 8));
+    return best_error;
 }
 
-/// @summary Implements the COPY_IMAGE_TO_BUFFER command, which copies data from one image to another.
-/// @param ctx The CGFX context returned by cgEnumerateDevices.
-/// @param queue The command queue into which the command is being inserted.
-/// @param cmdbuf The command buffer defining the command.
-/// @param cmd The command and any associated data.
-/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_INVALID_STATE, CG_BAD_CLCONTEXT, CG_UNSUPPORTED, CG_OUT_OF_MEMORY, CG_OUT_OF_OBJECTS, CG_UNSUPPORTED or CG_ERROR.
-internal_function int
-cgExecuteCopyImageToBuffer
+/// @summary Evaluate a BC7 mode 6 block. The parameters are the 7-bit RGBA components of both endpoints followed by the two p-bits.
+/// @param block The block being encoded, with ChannelCount 4.
+/// @param params The endpoint parameters {r0, g0, b0, a0, r1, g1, b1, a1, p0, p1}.
+/// @param indices On return, stores the palette index for each pixel.
+/// @return The sum of squared errors over the RGBA channels.
+internal_function float
+cgBcEvaluateBC7
 (
-    CG_CONTEXT    *ctx, 
-    CG_QUEUE      *queue, 
-    CG_CMD_BUFFER *cmdbuf, 
-    cg_command_t  *cmd
+    CG_BC_BLOCK const *block,
+    int         const *params,
+    uint8_t           *indices
 )
-{   UNREFERENCED_PARAMETER(cmdbuf);
-    cg_copy_image_to_buffer_cmd_t  *ddp  = (cg_copy_image_to_buffer_cmd_t*) cmd->Data;
-    CG_IMAGE          *srcimg  =  cgObjectTableGet(&ctx->ImageTable , ddp->SourceImage);
-    CG_BUFFER         *dstbuf  =  cgObjectTableGet(&ctx->BufferTable, ddp->TargetBuffer);
-    int                result  =  CG_SUCCESS;
-    size_t            nmemrefs =  0;
-    cl_uint           nwaitevt =  0;
-    cl_event          acquire  =  NULL;
-    cl_mem            memrefs[2];
-    cgMemRefListAddImage (srcimg, memrefs, nmemrefs, 2, false);
-    cgMemRefListAddBuffer(dstbuf, memrefs, nmemrefs, 2, false);
-    if ((result = cgAcquireMemoryObjects(ctx, queue, memrefs, nmemrefs, ddp->WaitEvent, &acquire, nwaitevt, 1)) == CL_SUCCESS)
+{
+    static int const weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+    float palette[16][4];
+    for (size_t c = 0; c < 4; ++c)
     {
-        cl_event  cl_done = NULL;
-        cl_int    cl_res  = clEnqueueCopyImageToBuffer(
-            queue->CommandQueue, 
-            memrefs[0], /* src */
-            memrefs[1], /* dst */
-            ddp->SourceOrigin, 
-            ddp->Dimensions, 
-            ddp->TargetOffset, 
-            nwaitevt, 
-            CG_OPENCL_WAIT_LIST(nwaitevt, &acquire),
-            &cl_done);
-        if  (cl_res != CL_SUCCESS)
-        {
-            switch (cl_res)
-            {
-            case CL_INVALID_OPERATION            : result = CG_UNSUPPORTED;   break;
-            case CL_INVALID_COMMAND_QUEUE        : result = CG_BAD_CLCONTEXT; break;
-            case CL_INVALID_CONTEXT              : result = CG_BAD_CLCONTEXT; break;
-            case CL_INVALID_MEM_OBJECT           : result = CG_BAD_CLCONTEXT; break;
-            case CL_INVALID_IMAGE_SIZE           : result = CG_UNSUPPORTED;   break;
-            case CL_MISALIGNED_SUB_BUFFER_OFFSET : result = CG_INVALID_VALUE; break;
-            case CL_INVALID_VALUE                : result = CG_INVALID_VALUE; break;
-            case CL_INVALID_EVENT_WAIT_LIST      : result = CG_INVALID_VALUE; break;
-            case CL_MEM_COPY_OVERLAP             : result = CG_INVALID_VALUE; break;
-            case CL_MEM_OBJECT_ALLOCATION_FAILURE: result = CG_OUT_OF_MEMORY; break;
-            case CL_OUT_OF_RESOURCES             : result = CG_OUT_OF_MEMORY; break;
-            case CL_OUT_OF_HOST_MEMORY           : result = CG_OUT_OF_MEMORY; break;
-            default                              : result = CG_ERROR;         break;
-            }
-            cgReleaseMemoryObjects(ctx, queue, memrefs, nmemrefs, NULL, 0, CG_INVALID_HANDLE);
-            return result;
+        int a = (params[c + 0] << 1) | params[8];
+        int b = (params[c + 4] << 1) | params[9];
+        for (size_t k = 0; k < 16; ++k)
+            palette[k][c] = float(((64 - weights[k]) * a + weights[k] * b + 32) >> 6);
+    }
+    return cgBcFitIndices(block, palette, 16, indices);
+}
+
+/// @summary Quantize a floating-point BC7 mode 6 endpoint, choosing the p-bit that minimizes the error.
+/// @param e The endpoint, with components in [0, 255].
+/// @param q On return, stores the four 7-bit components.
+/// @param p On return, stores the p-bit.
+internal_function void
+cgBcQuantizeBC7
+(
+    float const *e,
+    int         *q,
+    int         &p
+)
+{
+    float best = FLT_MAX;
+    for (int pbit = 0; pbit < 2; ++pbit)
+    {
+        int   cand[4];
+        float err = 0.0f;
+        for (size_t c = 0; c < 4; ++c)
+        {
+            int   v = int((e[c] - pbit) * 0.5f + 0.5f);
+            float d;
+            cand[c] = v < 0 ? 0 : (v > 127 ? 127 : v);
+            d       = float((cand[c] << 1) | pbit) - e[c];
+            err    += d * d;
+        }
+        if (err < best)
+        {
+            memcpy(q, cand, sizeof(cand));
+            p    = pbit;
+            best = err;
         }
-        return cgReleaseMemoryObjects(ctx, queue, memrefs, nmemrefs, &cl_done, 1, ddp->CompleteEvent);
     }
-    return result;
 }
 
-/// @summary Executes a command buffer against an out-of-order transfer queue.
-/// @param ctx The CGFX context defining the command queue.
-/// @param queue The CGFX command queue, which must be a transfer queue.
-/// @param cmdbuf The CGFX command buffer to submit to the device queue.
-/// @return CG_SUCCESS, CG_COMMAND_NOT_IMPLEMENTED, or another result code.
-internal_function int
-cgExecuteTransferCommandBuffer
+/// @summary Encode a block as BC7 using mode 6, which stores one subset with 7.7.7.7 endpoints, p-bits and 4-bit indices.
+/// @param block The block being encoded, with ChannelCount 4.
+/// @param quality One of cg_block_compression_quality_e.
+/// @param out The 16 bytes of block data.
+/// @return The sum of squared errors over the RGBA channels.
+internal_function float
+cgBcEncodeBC7
 (
-    CG_CONTEXT    *ctx, 
-    CG_QUEUE      *queue, 
-    CG_CMD_BUFFER *cmdbuf
+    CG_BC_BLOCK const *block,
+    int                quality,
+    uint8_t           *out
 )
 {
-    cg_command_t  *cmd = NULL;
-    size_t         ofs = 0;
-    int            res = CG_SUCCESS;
-
-    while ((cmd = cgCmdBufferCommandAt(cmdbuf, ofs, res)) != NULL && res == CG_SUCCESS)
+    static float const t16[16] =
     {
-        switch (cmd->CommandId)
-        {
-        case CG_COMMAND_DEVICE_FENCE:
-            res = cgExecuteDeviceFence(ctx, queue, cmdbuf, cmd);
-            break;
-        case CG_COMMAND_COPY_BUFFER:
-            res = cgExecuteCopyBufferRegion(ctx, queue, cmdbuf, cmd);
-            break;
-        case CG_COMMAND_COPY_IMAGE:
-            res = cgExecuteCopyImageRegion(ctx, queue, cmdbuf, cmd);
-            break;
-        case CG_COMMAND_COPY_BUFFER_TO_IMAGE:
-            res = cgExecuteCopyImageToBuffer(ctx, queue, cmdbuf, cmd);
-            break;
-        case CG_COMMAND_COPY_IMAGE_TO_BUFFER:
-            res = cgExecuteCopyBufferToImage(ctx, queue, cmdbuf, cmd);
+         0.0f / 64.0f,  4.0f / 64.0f,  9.0f / 64.0f, 13.0f / 64.0f, 17.0f / 64.0f, 21.0f / 64.0f, 26.0f / 64.0f, 30.0f / 64.0f,
+        34.0f / 64.0f, 38.0f / 64.0f, 43.0f / 64.0f, 47.0f / 64.0f, 51.0f / 64.0f, 55.0f / 64.0f, 60.0f / 64.0f, 64.0f / 64.0f
+    };
+    static int const max[10] = { 127, 127, 127, 127, 127, 127, 127, 127, 1, 1 };
+    uint8_t indices[16];
+    int     best[10];
+    float   e0[4];
+    float   e1[4];
+    float   best_error;
+    size_t  pos = 0;
+
+    cgBcPrincipalEndpoints(block, e0, e1);
+    cgBcQuantizeBC7(e0, best + 0, best[8]);
+    cgBcQuantizeBC7(e1, best + 4, best[9]);
+    best_error = cgBcEvaluateBC7(block, best, indices);
+    for (int iter = 0; iter < cgBcRefineIterations(quality) && best_error > 0.0f; ++iter)
+    {
+        int   cand[10];
+        float err;
+        if (!cgBcRefineEndpoints(block, indices, t16, e0, e1))
             break;
-        default:
-            res = CG_COMMAND_NOT_IMPLEMENTED;
+        cgBcQuantizeBC7(e0, cand + 0, cand[8]);
+        cgBcQuantizeBC7(e1, cand + 4, cand[9]);
+        if ((err = cgBcEvaluateBC7(block, cand, indices)) >= best_error)
             break;
-        }
+        memcpy(best, cand, sizeof(best));
+        best_error = err;
+    }
+    if (quality >= CG_BLOCK_COMPRESSION_QUALITY_HIGH)
+    {
+        cgBcGreedySearch(block, cgBcEvaluateBC7, best, max, 10, best_error);
     }
-    if (res == CG_END_OF_BUFFER)
-        res  = CG_SUCCESS;
 
-    return res;
+    cgBcEvaluateBC7(block, best, indices);
+    if (indices[0] & 8)
+    {   // the anchor index is stored with an implicit zero high bit; swap the endpoints and invert the indices.
+        for (size_t c = 0; c < 4; ++c)
+        {
+            int t = best[c]; best[c] = best[c + 4]; best[c + 4] = t;
+        }
+        int t = best[8]; best[8] = best[9]; best[9] = t;
+        for (size_t i = 0; i < 16; ++i)
+            indices[i] = uint8_t(15 - indices[i]);
+    }
+    memset(out, 0, 16);
+    cgBcPutBits(out, pos, 7, 0x40);  // mode 6
+    for (size_t c = 0; c < 4; ++c)
+    {
+        cgBcPutBits(out, pos, 7, uint32_t(best[c + 0]));
+        cgBcPutBits(out, pos, 7, uint32_t(best[c + 4]));
+    }
+    cgBcPutBits(out, pos, 1, uint32_t(best[8]));
+    cgBcPutBits(out, pos, 1, uint32_t(best[9]));
+    cgBcPutBits(out, pos, 3, indices[0]);
+    for (size_t i = 1; i < 16; ++i)
+        cgBcPutBits(out, pos, 4, indices[i]);
+    return best_error;
 }
 
-/// @summary Executes a command buffer against an out-of-order compute queue.
-/// @param ctx The CGFX context defining the command queue.
-/// @param queue The CGFX command queue, which must be a compute queue.
-/// @param cmdbuf The CGFX command buffer to submit to the device queue.
-/// @return CG_SUCCESS, CG_COMMAND_NOT_IMPLEMENTED, or another result code.
-internal_function int
-cgExecuteComputeCommandBuffer
+/// @summary Encode one block of the source image in a given block-compressed format.
+/// @param block The block to encode, as returned by cgBcLoadBlock. The block is modified.
+/// @param format One of the supported BC formats.
+/// @param quality One of cg_block_compression_quality_e.
+/// @param out The block data. Either 8 or 16 bytes are written, depending on the format.
+/// @return The sum of squared errors over the channels stored by the format.
+internal_function float
+cgBcEncodeBlock
 (
-    CG_CONTEXT    *ctx, 
-    CG_QUEUE      *queue, 
-    CG_CMD_BUFFER *cmdbuf
+    CG_BC_BLOCK *block,
+    uint32_t     format,
+    int          quality,
+    uint8_t     *out
 )
 {
-    cg_command_t *cmd = NULL;
-    size_t        ofs = 0;
-    int           res = CG_SUCCESS;
-
-    while ((cmd = cgCmdBufferCommandAt(cmdbuf, ofs, res)) != NULL && res == CG_SUCCESS)
+    float weight[16];
+    float err = 0.0f;
+    switch (format)
     {
-        switch (cmd->CommandId)
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+        memcpy(weight, block->Weight, sizeof(weight));
+        block->ColorMode = CG_BC_COLOR_MODE_BC1;
+        for (size_t i = 0; i < 16; ++i)
         {
-        case CG_COMMAND_DEVICE_FENCE:
-            res = cgExecuteDeviceFence(ctx, queue, cmdbuf, cmd);
-            break;
-        case CG_COMMAND_COPY_BUFFER:
-            res = cgExecuteCopyBufferRegion(ctx, queue, cmdbuf, cmd);
-            break;
-        case CG_COMMAND_COPY_IMAGE:
-            res = cgExecuteCopyImageRegion(ctx, queue, cmdbuf, cmd);
-            break;
-        case CG_COMMAND_COPY_BUFFER_TO_IMAGE:
-            res = cgExecuteCopyImageToBuffer(ctx, queue, cmdbuf, cmd);
-            break;
-        case CG_COMMAND_COPY_IMAGE_TO_BUFFER:
-            res = cgExecuteCopyBufferToImage(ctx, queue, cmdbuf, cmd);
-            break;
-        case CG_COMMAND_PIPELINE_DISPATCH:
-            res = cgExecuteComputePipelineDispatch(ctx, queue, cmdbuf, cmd);
-            break;
-        default:
-            res = CG_COMMAND_NOT_IMPLEMENTED;
-            break;
+            if (block->Pixels[3][i] < 128.0f)
+            {   // punch-through alpha requires the three-color mode.
+                block->ColorMode = CG_BC_COLOR_MODE_BC1_ALPHA;
+                block->Weight[i] = 0.0f;
+            }
         }
+        block->FirstChannel = 0;
+        block->ChannelCount = 3;
+        err = cgBcEncodeColor(block, quality, out);
+        memcpy(block->Weight, weight, sizeof(weight));
+        break;
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+        block->FirstChannel = 3;
+        block->ChannelCount = 1;
+        err += cgBcEncodeAlpha(block, quality, out);
+        block->FirstChannel = 0;
+        block->ChannelCount = 3;
+        block->ColorMode    = CG_BC_COLOR_MODE_BC3;
+        err += cgBcEncodeColor(block, quality, out + 8);
+        break;
+    case DXGI_FORMAT_BC4_UNORM:
+        block->FirstChannel = 0;
+        block->ChannelCount = 1;
+        err = cgBcEncodeAlpha(block, quality, out);
+        break;
+    case DXGI_FORMAT_BC5_UNORM:
+        block->FirstChannel = 0;
+        block->ChannelCount = 1;
+        err += cgBcEncodeAlpha(block, quality, out);
+        block->FirstChannel = 1;
+        err += cgBcEncodeAlpha(block, quality, out + 8);
+        break;
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        block->FirstChannel = 0;
+        block->ChannelCount = 4;
+        err = cgBcEncodeBC7(block, quality, out);
+        break;
+    default:
+        break;
     }
-    if (res == CG_END_OF_BUFFER)
-        res  = CG_SUCCESS;
-
-    return res;
+    return err;
 }
 
-/// @summary Executes a command buffer against an in-order graphics queue.
-/// @param ctx The CGFX context defining the command queue.
-/// @param queue The CGFX command queue, which must be a graphics queue.
-/// @param cmdbuf The CGFX command buffer to submit to the device queue.
-/// @return CG_SUCCESS, CG_COMMAND_NOT_IMPLEMENTED, or another result code.
-internal_function int
-cgExecuteGraphicsCommandBuffer
+/// @summary Encode the rows of blocks assigned to block compression work items until no work items remain.
+/// @param job The description of the image being encoded.
+internal_function void
+cgHostCompressRunTasks
 (
-    CG_CONTEXT    *ctx, 
-    CG_QUEUE      *queue, 
-    CG_CMD_BUFFER *cmdbuf
+    CG_HOST_BC_JOB *job
 )
 {
-    cg_command_t  *cmd = NULL;
-    size_t         ofs = 0;
-    int            res = CG_SUCCESS;
-
-    while ((cmd = cgCmdBufferCommandAt(cmdbuf, ofs, res)) != NULL && res == CG_SUCCESS)
+    size_t bpb = cgPixelFormatBytesPerBlock(job->Format);
+    LONG   task;
+    while ((task = InterlockedIncrement(&job->NextTask) - 1) < job->TaskCount)
     {
-        switch (cmd->CommandId)
+        CG_BC_BLOCK block;
+        size_t      y0  = size_t(task) * job->RowsPerTask;
+        size_t      y1  =(y0 + job->RowsPerTask) < job->BlocksY ? (y0 + job->RowsPerTask) : job->BlocksY;
+        double      err = 0.0;
+        for (size_t by = y0; by < y1; ++by)
         {
-        case CG_COMMAND_DEVICE_FENCE:
-            res = cgExecuteDeviceFence(ctx, queue, cmdbuf, cmd);
-            break;
-        case CG_COMMAND_PIPELINE_DISPATCH:
-            res = cgExecuteGraphicsPipelineDispatch(ctx, queue, cmdbuf, cmd);
-            break;
-        default:
-            res = CG_COMMAND_NOT_IMPLEMENTED;
-            break;
+            uint8_t *dst = job->Dst + by * job->DstRowPitch;
+            for (size_t bx = 0; bx < job->BlocksX; ++bx)
+            {
+                cgBcLoadBlock(&block, job->Src, job->SrcRowPitch, job->Width, job->Height, bx, by);
+                err += cgBcEncodeBlock(&block, job->Format, job->Quality, dst + bx * bpb);
+            }
         }
+        InterlockedExchangeAdd64(&job->SquaredError, LONG64(err));
     }
-    if (res == CG_END_OF_BUFFER)
-        res  = CG_SUCCESS;
+}
 
-    return res;
+/// @summary Thread pool callback used to execute block compression work items.
+/// @param instance The thread pool callback instance. Unused.
+/// @param context The CG_HOST_BC_JOB describing the image being encoded.
+/// @param work The thread pool work object. Unused.
+internal_function void CALLBACK
+cgHostCompressWorker
+(
+    PTP_CALLBACK_INSTANCE instance,
+    void                 *context,
+    PTP_WORK              work
+)
+{
+    cgHostCompressRunTasks((CG_HOST_BC_JOB*) context);
+    UNREFERENCED_PARAMETER(instance);
+    UNREFERENCED_PARAMETER(work);
 }
 
 /*////////////////////////
@@ -6045,7 +10452,7 @@ cgEnumerateDevices
     for (size_t i = 0, n = ctx->DisplayTable.ObjectCount; i < n; ++i)
     {   // creating rendering contexts could fail for several reasons.
         // we only care about whether the RC is interoperable with CL.
-        cgGlCreateRenderingContext(ctx, &ctx->DisplayTable.Objects[i]);
+        cgGlCreateRenderingContext(ctx, &ctx->DisplayTable.Objects[i], NULL);
     }
 
     // count device heaps and gather heap information.
@@ -6161,6 +10568,102 @@ cgGetContextInfo
         }
         return CG_SUCCESS;
 
+    case CG_CONTEXT_RESIDENCY_STATS:
+        {   BUFFER_CHECK_TYPE(cg_residency_stats_t);
+            ctx->ResidencyStats.FrameIndex = uint64_t(ctx->FrameIndex);
+            memcpy(buffer, &ctx->ResidencyStats, sizeof(cg_residency_stats_t));
+        }
+        return CG_SUCCESS;
+
+    case CG_CONTEXT_SCRATCH_STATS:
+        {   BUFFER_CHECK_TYPE(cg_scratch_stats_t);
+            cg_scratch_stats_t *stats = (cg_scratch_stats_t*) buffer;
+            memset(stats, 0, sizeof(cg_scratch_stats_t));
+            stats->ArenaSize = CG_SCRATCH_ARENA_SIZE;
+            for (size_t i = 0; i < CG_MAX_SCRATCH_ARENAS; ++i)
+            {
+                CG_SCRATCH_ARENA *arena = &ctx->ScratchArenas[i];
+                // slots released at thread exit keep their counters.
+                if (arena->HighWaterMark > stats->HighWaterMark)
+                    stats->HighWaterMark = arena->HighWaterMark;
+                if (arena->BaseAddress != NULL)
+                    stats->ArenaCount++;
+                stats->AllocationCount += arena->AllocationCount;
+                stats->OverflowCount   += arena->OverflowCount;
+            }
+        }
+        return CG_SUCCESS;
+
+    case CG_CONTEXT_ALLOCATION_STATS:
+        {   BUFFER_CHECK_SIZE(CG_MAX_ALLOCATION_TYPES * sizeof(cg_allocation_stats_t));
+            cg_allocation_stats_t *stats = (cg_allocation_stats_t*) buffer;
+            for (size_t i = 0; i < CG_MAX_ALLOCATION_TYPES; ++i)
+            {
+                CG_ALLOCATION_COUNTERS *c = &ctx->AllocationStats[i];
+                stats[i].LiveBytes        = uint64_t(c->LiveBytes);
+                stats[i].PeakBytes        = uint64_t(c->PeakBytes);
+                stats[i].LiveCount        = uint64_t(c->LiveCount);
+                stats[i].AllocationCount  = uint64_t(c->AllocationCount);
+                stats[i].AllocatedBytes   = uint64_t(c->AllocatedBytes);
+                stats[i].FrameAllocations = uint64_t(c->FrameAllocations);
+            }
+        }
+        return CG_SUCCESS;
+
+    case CG_CONTEXT_OBJECT_STATS:
+        {   BUFFER_CHECK_SIZE(CG_MAX_OBJECT_TYPES * sizeof(cg_object_stats_t));
+            cg_object_stats_t *stats = (cg_object_stats_t*) buffer;
+#define SET_OBJECT_STATS(index, table) \
+            stats[index].ObjectType  = ctx->table.ObjectType; \
+            stats[index].LiveCount   = ctx->table.ObjectCount; \
+            stats[index].PeakCount   = ctx->table.PeakCount; \
+            stats[index].CreateCount = ctx->table.CreateCount; \
+            stats[index].DeleteCount = ctx->table.DeleteCount; \
+            stats[index].RecordSize  = sizeof(ctx->table.Objects[0]); \
+            stats[index].TableBytes  = sizeof(ctx->table); \
+            stats[index].LiveBytes   = 0
+            SET_OBJECT_STATS( 0, DeviceTable);
+            SET_OBJECT_STATS( 1, DisplayTable);
+            SET_OBJECT_STATS( 2, ExecGroupTable);
+            SET_OBJECT_STATS( 3, QueueTable);
+            SET_OBJECT_STATS( 4, CmdBufferTable);
+            SET_OBJECT_STATS( 5, FenceTable);
+            SET_OBJECT_STATS( 6, EventTable);
+            SET_OBJECT_STATS( 7, KernelTable);
+            SET_OBJECT_STATS( 8, PipelineTable);
+            SET_OBJECT_STATS( 9, BufferTable);
+            SET_OBJECT_STATS(10, ImageTable);
+            SET_OBJECT_STATS(11, SamplerTable);
+            SET_OBJECT_STATS(12, VertexSourceTable);
+#undef  SET_OBJECT_STATS
+            for (size_t i = 0, n = ctx->BufferTable.ObjectCount; i < n; ++i)
+            {
+                stats[ 9].LiveBytes += ctx->BufferTable.Objects[i].AllocatedSize;
+            }
+            for (size_t i = 0, n = ctx->ImageTable.ObjectCount; i < n; ++i)
+            {
+                stats[10].LiveBytes += ctx->ImageTable.Objects[i].AllocatedSize;
+            }
+        }
+        return CG_SUCCESS;
+
+    case CG_CONTEXT_KERNEL_CACHE_STATS:
+        {   BUFFER_CHECK_TYPE(cg_kernel_cache_stats_t);
+            cg_kernel_cache_stats_t  *stats = (cg_kernel_cache_stats_t*) buffer;
+            CG_KERNEL_CACHE_COUNTERS *count = &ctx->KernelCache.Stats;
+            stats->LookupCount         = uint64_t(count->LookupCount);
+            stats->HitCount            = uint64_t(count->HitCount);
+            stats->StoreCount          = uint64_t(count->StoreCount);
+            stats->BuildNanos          = uint64_t(count->BuildNanos);
+            stats->LoadNanos           = uint64_t(count->LoadNanos);
+            stats->PipelineLookupCount = uint64_t(count->PipelineLookupCount);
+            stats->PipelineHitCount    = uint64_t(count->PipelineHitCount);
+            stats->PipelineStoreCount  = uint64_t(count->PipelineStoreCount);
+            stats->PipelineBuildNanos  = uint64_t(count->PipelineBuildNanos);
+            stats->PipelineLoadNanos   = uint64_t(count->PipelineLoadNanos);
+        }
+        return CG_SUCCESS;
+
     default:
         {
             if (bytes_needed != NULL) *bytes_needed = 0;
@@ -6217,6 +10720,46 @@ cgGetHeapProperties
     heap_info.DeviceAlignment = ctx->HeapList[heap_ordinal].DeviceAlignment;
     heap_info.UserAlignment   = ctx->HeapList[heap_ordinal].UserAlignment;
     heap_info.UserSizeAlign   = ctx->HeapList[heap_ordinal].UserSizeAlign;
+    AcquireSRWLockShared(&ctx->HeapList[heap_ordinal].PinnableLock);
+    heap_info.PinnableUsed    = ctx->HeapList[heap_ordinal].PinnableUsed;
+    ReleaseSRWLockShared(&ctx->HeapList[heap_ordinal].PinnableLock);
+    for (CG_STAGING_POOL *pool = ctx->HeapList[heap_ordinal].StagingPool; pool != NULL; pool = pool->Next)
+    {   // report the staging arena size and the amount currently outstanding, summed over all execution groups.
+        AcquireSRWLockExclusive(&pool->Lock);
+        cgStagingPoolReclaim(pool);
+        heap_info.StagingSize += pool->ArenaSize;
+        heap_info.StagingUsed += pool->BytesUsed;
+        ReleaseSRWLockExclusive(&pool->Lock);
+    }
+    heap_info.HeapUsed        = ctx->HeapList[heap_ordinal].HeapSizeUsed;
+    heap_info.ResidencyBudget = ctx->HeapList[heap_ordinal].ResidencyBudget;
+    heap_info.NUMANode        = ctx->HeapList[heap_ordinal].NUMANode;
+    return CG_SUCCESS;
+}
+
+/// @summary Set the residency budget for a memory heap. When the number of bytes of device-resident objects allocated from the heap exceeds the budget, the least-recently-used compute-only objects are moved to host-backed memory after the next command buffer submission, and moved back to device memory the next time a command references them.
+/// Eviction waits once per submission for the execution groups to go idle, and submissions and map calls on other threads wait for it to finish; restoring an object is ordered on the device and does not block the submitting thread.
+/// Buffers and images shared with OpenGL are never evicted. Mapped objects are neither evicted nor restored until they are unmapped.
+/// @param context A CGFX context returned by cgEnumerateDevices().
+/// @param heap_ordinal The zero-based ordinal of the heap to update, in [0, cgGetHeapCount(context)).
+/// @param budget The residency budget for the heap, in bytes, or 0 to disable eviction.
+/// @return CG_SUCCESS or CG_INVALID_VALUE.
+library_function int
+cgSetHeapResidencyBudget
+(
+    uintptr_t       context, 
+    size_t          heap_ordinal, 
+    uint64_t        budget
+)
+{
+    CG_CONTEXT  *ctx = (CG_CONTEXT*) context;
+
+    if (heap_ordinal >= ctx->HeapCount)
+        return CG_INVALID_VALUE;
+    if (ctx->HeapList[heap_ordinal].DeviceType == CL_DEVICE_TYPE_CPU)
+        return CG_INVALID_VALUE; // objects in host memory cannot be evicted.
+
+    ctx->HeapList[heap_ordinal].ResidencyBudget = cl_ulong(budget);
     return CG_SUCCESS;
 }
 
@@ -6342,6 +10885,12 @@ cgGetDeviceInfo
         }
         return CG_SUCCESS;
 
+    case CG_DEVICE_NUMA_NODE:
+        {   BUFFER_CHECK_TYPE(uint32_t);
+            BUFFER_SET_SCALAR(uint32_t, device->NUMANode);
+        }
+        return CG_SUCCESS;
+
     default:
         {
             if (bytes_needed != NULL) *bytes_needed = 0;
@@ -6528,6 +11077,31 @@ cgGetDisplayInfo
         }
         return CG_SUCCESS;
 
+    case CG_DISPLAY_GL_STATE_STATS:
+        {   BUFFER_CHECK_TYPE(cg_gl_state_stats_t);
+            cg_gl_state_stats_t *stats = (cg_gl_state_stats_t*) buffer;
+            memset(stats, 0, sizeof(cg_gl_state_stats_t));
+            if (display->GLState != NULL)
+            {
+                stats->CallsIssued      = display->GLState->CallsIssued;
+                stats->CallsElided      = display->GLState->CallsElided;
+                stats->FrameCallsIssued = display->GLState->FrameCallsIssued;
+                stats->FrameCallsElided = display->GLState->FrameCallsElided;
+            }
+            if (display->UniformRing != NULL)
+            {
+                stats->UniformBytesWritten = display->UniformRing->BytesWritten;
+                stats->UniformRingWaits    = display->UniformRing->WaitCount;
+            }
+        }
+        return CG_SUCCESS;
+
+    case CG_DISPLAY_HEADLESS:
+        {   BUFFER_CHECK_TYPE(bool);
+            BUFFER_SET_SCALAR(bool, display->Headless);
+        }
+        return CG_SUCCESS;
+
     default:
         {
             if (bytes_needed != NULL) *bytes_needed = 0;
@@ -6754,6 +11328,21 @@ cgCreateExecutionGroup
         goto error_invalid_value;
     }
 
+    // offscreen rendering on a device that drives no display requires a headless rendering context.
+    // the display must exist before the device list is built, so it is included in the group.
+    if (flags & CG_EXECUTION_GROUP_OFFSCREEN)
+    {
+        CG_DEVICE *root = cgObjectTableGet(&ctx->DeviceTable, config->RootDevice);
+        if (root == NULL || root->Type != CL_DEVICE_TYPE_GPU)
+        {   // offscreen rendering requires a GPU root device.
+            goto error_invalid_value;
+        }
+        if (root->DisplayRC == NULL && (result = cgGlCreateHeadlessDisplay(ctx, root)) != CG_SUCCESS)
+        {   // result has been set to the reason for the failure.
+            return CG_INVALID_HANDLE;
+        }
+    }
+
     // construct the complete list of devices in the execution group.
     if ((devices = cgCreateExecutionGroupDeviceList(ctx, config->RootDevice, flags, config->DeviceList, config->DeviceCount, device_count, result)) == NULL)
     {   // result has been set to the reason for the failure.
@@ -6769,8 +11358,8 @@ cgCreateExecutionGroup
         return CG_INVALID_HANDLE;
     }
 
-    // if the group is to be used for display output, retrieve the rendering context.
-    if (flags & CG_EXECUTION_GROUP_DISPLAY_OUTPUT)
+    // if the group is to be used for display output or offscreen rendering, retrieve the rendering context.
+    if (flags & (CG_EXECUTION_GROUP_DISPLAY_OUTPUT | CG_EXECUTION_GROUP_OFFSCREEN))
     {   // find the GPU device and save off the rendering context.
         for (size_t i = 0; i < device_count; ++i)
         {
@@ -6949,6 +11538,25 @@ cgCreateExecutionGroup
         }
     }
 
+    // reserve a pinned staging arena on each device heap that supports pinning.
+    // the arena is mapped using the device's transfer queue. each execution group 
+    // gets its own arena, since sub-buffers cannot cross OpenCL contexts.
+    if (config->StagingArenaSize > 0)
+    {
+        for (size_t i = 0; i < device_count; ++i)
+        {
+            CG_HEAP *heap = cgFindHeapForDevice(ctx, group.DeviceList[i]);
+            if (heap == NULL || (heap->Flags & CG_HEAP_HOLDS_PINNED) == 0 || cgFindStagingPool(heap, cl_ctx) != NULL)
+                continue;
+            if ((result = cgCreateStagingPool(ctx, heap, cl_ctx, group.TransferQueues[i]->CommandQueue, config->StagingArenaSize)) != CG_SUCCESS)
+            {   // result has been set to the reason for the failure.
+                cgDeleteExecutionGroup(ctx, &group);
+                cgFreeExecutionGroupDeviceList(ctx, devices, device_count);
+                return CG_INVALID_HANDLE;
+            }
+        }
+    }
+
     // create (logical) graphics queues for each attached display.
     for (size_t i = 0; i < group.DisplayCount; ++i)
     {
@@ -7439,10 +12047,12 @@ cgGetQueueForDisplay
     return CG_INVALID_HANDLE;
 }
 
-/// @summary Deletes an object and invalidates its handle.
+/// @summary Deletes an object and invalidates its handle. Pipeline objects shared between identical create calls are 
+/// deleted when the last reference is released. Staging buffers cannot be deleted this way, since the device may still 
+/// be accessing them; return them with cgReleaseStagingBuffer instead.
 /// @param context A CGFX context returned by cgEnumerateDevices.
 /// @param object The handle of the object to delete.
-/// @return CG_SUCCESS or CG_INVALID_VALUE.
+/// @return CG_SUCCESS, CG_INVALID_VALUE or CG_INVALID_STATE if @a object is a staging buffer.
 library_function int
 cgDeleteObject
 (
@@ -7477,7 +12087,13 @@ cgDeleteObject
 
     case CG_OBJECT_PIPELINE:
         {
-            CG_PIPELINE pipeline;
+            CG_PIPELINE  pipeline;
+            CG_PIPELINE *shared = cgObjectTableGet(&ctx->PipelineTable, object);
+            if (shared != NULL && shared->ReferenceCount > 1)
+            {   // other create calls still reference the pipeline.
+                shared->ReferenceCount--;
+                return CG_SUCCESS;
+            }
             if (cgObjectTableRemove(&ctx->PipelineTable, object, pipeline))
             {
                 cgDeletePipeline(ctx, &pipeline);
@@ -7488,7 +12104,12 @@ cgDeleteObject
 
     case CG_OBJECT_BUFFER:
         {
-            CG_BUFFER buffer;
+            CG_BUFFER  buffer;
+            CG_BUFFER *staging = cgObjectTableGet(&ctx->BufferTable, object);
+            if (staging != NULL && staging->StagingPool != NULL)
+            {   // the slice must not be recycled until the device is done with it; use cgReleaseStagingBuffer.
+                return CG_INVALID_STATE;
+            }
             if (cgObjectTableRemove(&ctx->BufferTable, object, buffer))
             {
                 cgDeleteBuffer(ctx, &buffer);
@@ -7577,6 +12198,10 @@ cgCreateCommandBuffer
     buf.BytesTotal       =  0;
     buf.BytesUsed        =  0;
     buf.CommandCount     =  0;
+    buf.Flags            =  CG_COMMAND_BUFFER_FLAGS_NONE;
+    buf.SortKey          =  0;
+    buf.SortBytesTotal   =  0;
+    buf.SortEntries      =  NULL;
     if ((buf.CommandData = (uint8_t*) VirtualAlloc(NULL, CG_CMD_BUFFER::MAX_SIZE, MEM_RESERVE, PAGE_READWRITE)) == NULL)
     {   // unable to reserve the required virtual address space.
         result = CG_OUT_OF_MEMORY;
@@ -7596,8 +12221,8 @@ cgCreateCommandBuffer
 /// @summary Prepares a command buffer for writing.
 /// @param context A CGFX context returned from cgEnumerateDevices.
 /// @param cmd_buffer The handle of the command buffer.
-/// @param flags Flags used to optimize command buffer submission.
-/// @return CG_SUCCESS, CG_INVALID_VALUE or CG_INVALID_STATE.
+/// @param flags One or more of cg_command_buffer_flags_e used to optimize command buffer submission.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_INVALID_STATE or CG_OUT_OF_MEMORY.
 library_function int
 cgBeginCommandBuffer
 (
@@ -7605,7 +12230,7 @@ cgBeginCommandBuffer
     cg_handle_t cmd_buffer,
     uint32_t    flags
 )
-{   UNREFERENCED_PARAMETER(flags);
+{
     CG_CONTEXT    *ctx    =(CG_CONTEXT*) context;
     CG_CMD_BUFFER *cmdbuf = cgObjectTableGet(&ctx->CmdBufferTable, cmd_buffer);
     if (cmdbuf == NULL)
@@ -7618,8 +12243,17 @@ cgBeginCommandBuffer
     {   // the command buffer is in an invalid state for this call.
         return CG_INVALID_STATE;
     }
+    if ((flags & CG_COMMAND_BUFFER_FLAG_SORT_BY_KEY) != 0)
+    {   // only in-order graphics queues can reorder commands between fences.
+        if (cgCmdBufferGetQueueType(cmdbuf) != CG_QUEUE_TYPE_GRAPHICS)
+            return CG_INVALID_VALUE;
+        if (cmdbuf->SortEntries == NULL && (cmdbuf->SortEntries = (CG_CMD_SORT_ENTRY*) VirtualAlloc(NULL, CG_CMD_BUFFER::MAX_SORT_SIZE, MEM_RESERVE, PAGE_READWRITE)) == NULL)
+            return CG_OUT_OF_MEMORY;
+    }
     cmdbuf->BytesUsed     = 0;
     cmdbuf->CommandCount  = 0;
+    cmdbuf->Flags         = flags;
+    cmdbuf->SortKey       = 0;
     cgCmdBufferSetState(cmdbuf, CG_CMD_BUFFER::BUILDING);
     return CG_SUCCESS;
 }
@@ -7643,6 +12277,8 @@ cgResetCommandBuffer
     }
     cmdbuf->BytesUsed     = 0;
     cmdbuf->CommandCount  = 0;
+    cmdbuf->Flags         = CG_COMMAND_BUFFER_FLAGS_NONE;
+    cmdbuf->SortKey       = 0;
     cgCmdBufferSetState(cmdbuf, CG_CMD_BUFFER::UNINITIALIZED);
     return CG_SUCCESS;
 }
@@ -7697,10 +12333,16 @@ cgCommandBufferAppend
         cmdbuf->BytesTotal  =  cs;
         cmdbuf->CommandData = (uint8_t*) buf;
     }
+    if (cgCmdBufferReserveSortEntry(cmdbuf) != CG_SUCCESS)
+    {   // unable to commit space for the sort key.
+        cgCmdBufferSetState(cmdbuf, CG_CMD_BUFFER::INCOMPLETE);
+        return CG_OUT_OF_MEMORY;
+    }
     cg_command_t *cmd  = (cg_command_t*) (cmdbuf->CommandData + cmdbuf->BytesUsed);
     cmd->CommandId     =  cmd_type;
     cmd->DataSize      = (uint16_t) data_size;
     memcpy(cmd->Data, cmd_data, data_size);
+    cgCmdBufferAddSortEntry(cmdbuf);
     cmdbuf->BytesUsed +=  total_size;
     cmdbuf->CommandCount++;
     return CG_SUCCESS;
@@ -7750,6 +12392,11 @@ cgCommandBufferMapAppend
         cmdbuf->BytesTotal  =  cs;
         cmdbuf->CommandData = (uint8_t*) buf;
     }
+    if (cgCmdBufferReserveSortEntry(cmdbuf) != CG_SUCCESS)
+    {   // unable to commit space for the sort key.
+        cgCmdBufferSetState(cmdbuf, CG_CMD_BUFFER::INCOMPLETE);
+        return CG_OUT_OF_MEMORY;
+    }
     cgCmdBufferSetState(cmdbuf, CG_CMD_BUFFER::MAP_APPEND);
     *command = (cg_command_t*) (cmdbuf->CommandData + cmdbuf->BytesUsed);
     return CG_SUCCESS;
@@ -7787,6 +12434,7 @@ cgCommandBufferUnmapAppend
         return CG_BUFFER_TOO_SMALL;
     }
     cgCmdBufferSetState(cmdbuf, CG_CMD_BUFFER::BUILDING);
+    cgCmdBufferAddSortEntry(cmdbuf);
     cmdbuf->BytesUsed += total_size;
     cmdbuf->CommandCount++;
     return CG_SUCCESS;
@@ -7876,6 +12524,37 @@ cgCommandBufferCommandAt
     return cmd;
 }
 
+/// @summary Set the sort key assigned to commands subsequently appended to a command buffer. If the command buffer was 
+/// begun with CG_COMMAND_BUFFER_FLAG_SORT_BY_KEY, the commands between each pair of fences are executed in ascending key 
+/// order, and commands with equal keys execute in the order they were recorded. Fences are never reordered. A typical 
+/// key packs the pipeline ID into the most significant bits, followed by the vertex source and material, so that draws 
+/// sharing state execute together. Commands that set state for later draws should use the same key as those draws.
+/// @param context A CGFX context returned from cgEnumerateDevices.
+/// @param cmd_buffer The handle of the command buffer.
+/// @param sort_key The sort key to assign to subsequent commands.
+/// @return CG_SUCCESS, CG_INVALID_VALUE or CG_INVALID_STATE.
+library_function int
+cgCommandBufferSetSortKey
+(
+    uintptr_t   context,
+    cg_handle_t cmd_buffer,
+    uint64_t    sort_key
+)
+{
+    CG_CONTEXT    *ctx    =(CG_CONTEXT*) context;
+    CG_CMD_BUFFER *cmdbuf = cgObjectTableGet(&ctx->CmdBufferTable, cmd_buffer);
+    if (cmdbuf == NULL)
+    {   // an invalid handle was supplied.
+        return CG_INVALID_VALUE;
+    }
+    if (cgCmdBufferGetState(cmdbuf) != CG_CMD_BUFFER::BUILDING)
+    {   // the command buffer is in an invalid state for this call.
+        return CG_INVALID_STATE;
+    }
+    cmdbuf->SortKey = sort_key;
+    return CG_SUCCESS;
+}
+
 /// @summary Create a new fence object.
 /// @param context A CGFX context returned by cgEnumerateDevices.
 /// @param exec_group The execution group managing the queues that will pass the fence.
@@ -8089,23 +12768,57 @@ cgDeviceFenceWithWaitList
     return cgCommandBufferUnmapAppend(context, cmd_buffer, cmd_size);
 }
 
-/// @summary Create a vertex data source object that can be used to configure the input assembler stage of a graphics pipeline.
+/// @summary Create a vertex data source object that can be used to configure the input assembler stage of a graphics pipeline.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param exec_group The handle of the execution group that owns the layout object.
+/// @param num_buffers The number of data buffers expected to be used for providing vertex data.
+/// @param buffer_list An array of @a num_buffers data buffer object handles specifying the data buffers that contain the vertex data.
+/// @param index_buffer A data buffer object handle specifying the data buffer that contains primitive indices, or CG_INVALID_HANDLE if indexed rendering is not used.
+/// @param attrib_counts An array of @a num_buffers counts, each specifying the number of vertex attributes in each buffer.
+/// @param attrib_data An array of @a num_buffers arrays, each specifying the vertex attribute definitions for the corresponding buffer.
+/// @param result On return, set to CG_SUCCESS, CG_INVALID_VALUE, ...
+library_function cg_handle_t
+cgCreateVertexDataSource
+(
+    uintptr_t                     context,
+    cg_handle_t                   exec_group, 
+    size_t                        num_buffers, 
+    cg_handle_t                  *buffer_list,
+    cg_handle_t                   index_buffer,
+    size_t const                 *attrib_counts, 
+    cg_vertex_attribute_t const **attrib_data,
+    int                          &result
+)
+{
+    return cgCreateVertexDataSourceWithOffsets(context, exec_group, num_buffers, buffer_list, NULL, index_buffer, 0, attrib_counts, attrib_data, result);
+}
+
+/// @summary Create a vertex data source object whose vertex and index data start at byte offsets within their data buffers, 
+/// so many meshes can be sub-allocated from a few large buffers. When the rendering context supports OpenGL 4.3 or 
+/// GL_ARB_vertex_attrib_binding, data sources with the same vertex format share a single vertex array object, and 
+/// binding a data source only attaches its buffers and offsets. Otherwise, each data source owns a vertex array object 
+/// with the offsets baked into its attribute pointers.
 /// @param context A CGFX context returned by cgEnumerateDevices.
 /// @param exec_group The handle of the execution group that owns the layout object.
 /// @param num_buffers The number of data buffers expected to be used for providing vertex data.
 /// @param buffer_list An array of @a num_buffers data buffer object handles specifying the data buffers that contain the vertex data.
+/// @param buffer_offsets An array of @a num_buffers byte offsets of the first vertex within each data buffer, or NULL if all offsets are zero.
 /// @param index_buffer A data buffer object handle specifying the data buffer that contains primitive indices, or CG_INVALID_HANDLE if indexed rendering is not used.
+/// @param index_offset The byte offset of the first index within @a index_buffer. Must be a multiple of the index size used to draw.
 /// @param attrib_counts An array of @a num_buffers counts, each specifying the number of vertex attributes in each buffer.
 /// @param attrib_data An array of @a num_buffers arrays, each specifying the vertex attribute definitions for the corresponding buffer.
-/// @param result On return, set to CG_SUCCESS, CG_INVALID_VALUE, ...
+/// @param result On return, set to CG_SUCCESS, CG_INVALID_VALUE, CG_UNSUPPORTED, CG_OUT_OF_MEMORY, CG_BAD_GLCONTEXT or CG_OUT_OF_OBJECTS.
+/// @return The handle of the vertex data source object, or CG_INVALID_HANDLE.
 library_function cg_handle_t
-cgCreateVertexDataSource
+cgCreateVertexDataSourceWithOffsets
 (
     uintptr_t                     context,
     cg_handle_t                   exec_group, 
     size_t                        num_buffers, 
     cg_handle_t                  *buffer_list,
+    size_t const                 *buffer_offsets, 
     cg_handle_t                   index_buffer,
+    size_t                        index_offset, 
     size_t const                 *attrib_counts, 
     cg_vertex_attribute_t const **attrib_data,
     int                          &result
@@ -8138,6 +12851,16 @@ cgCreateVertexDataSource
             result = CG_INVALID_VALUE;
             return CG_INVALID_HANDLE;
         }
+        if ((index_offset & 1) != 0 || index_offset >= indexbuf->RequestedSize)
+        {   // the offset must address an index within the buffer.
+            result = CG_INVALID_VALUE;
+            return CG_INVALID_HANDLE;
+        }
+    }
+    else if (index_offset != 0)
+    {   // an index offset was specified without an index buffer.
+        result = CG_INVALID_VALUE;
+        return CG_INVALID_HANDLE;
     }
 
     CG_BUFFER *buffers[16];
@@ -8149,6 +12872,11 @@ cgCreateVertexDataSource
             result = CG_INVALID_VALUE;
             return CG_INVALID_HANDLE;
         }
+        if (buffer_offsets != NULL && buffer_offsets[i] >= buffers[i]->RequestedSize)
+        {   // the offset must address a vertex within the buffer.
+            result = CG_INVALID_VALUE;
+            return CG_INVALID_HANDLE;
+        }
     }
 
     // calculate the total number of vertex attributes.
@@ -8176,6 +12904,12 @@ cgCreateVertexDataSource
     // allocate memory for the vertex attribute metadata.
     GLuint                 buf      =  0;
     GLuint                 vao      =  0;
+    GLuint                 divs[16];
+    bool                   shared   =  false;
+    uint64_t               hash     =  CG_FNV1A_64_SEED;
+    CG_VERTEX_LAYOUT      *layout   =  NULL;
+    GLuint                *names    = (GLuint              *) cgAllocateHostMemory(&ctx->HostAllocator, num_buffers * sizeof(GLuint)             , 0, CG_ALLOCATION_TYPE_OBJECT);
+    size_t                *offsets  = (size_t              *) cgAllocateHostMemory(&ctx->HostAllocator, num_buffers * sizeof(size_t)             , 0, CG_ALLOCATION_TYPE_OBJECT);
     size_t                *strides  = (size_t              *) cgAllocateHostMemory(&ctx->HostAllocator, num_buffers * sizeof(size_t)             , 0, CG_ALLOCATION_TYPE_OBJECT);
     size_t                *indices  = (size_t              *) cgAllocateHostMemory(&ctx->HostAllocator, num_attribs * sizeof(size_t)             , 0, CG_ALLOCATION_TYPE_OBJECT);
     GLuint                *regs     = (GLuint              *) cgAllocateHostMemory(&ctx->HostAllocator, num_attribs * sizeof(GLuint)             , 0, CG_ALLOCATION_TYPE_OBJECT);
@@ -8183,16 +12917,16 @@ cgCreateVertexDataSource
     CG_DISPLAY            *display  =  group->AttachedDisplay;
     cg_handle_t            handle   =  CG_INVALID_HANDLE;
     CG_VERTEX_DATA_SOURCE  source;
-    if (strides == NULL || indices == NULL || regs == NULL || attribs == NULL)
+    if (names == NULL || offsets == NULL || strides == NULL || indices == NULL || regs == NULL || attribs == NULL)
     {   // unable to allocate the required memory.
         result = CG_OUT_OF_MEMORY;
         goto error_cleanup;
     }
-    glGenVertexArrays(1, &vao);
-    if (vao == 0)
-    {   // unable to allocate a vertex array object name.
-        result = CG_BAD_GLCONTEXT;
-        goto error_cleanup;
+    for (size_t i = 0; i < num_buffers; ++i)
+    {
+        names  [i] = buffers[i]->GraphicsBuffer;
+        offsets[i] = buffer_offsets != NULL ? buffer_offsets[i] : 0;
+        divs   [i] = 0;
     }
 
     // calculate OpenGL types and compute stride values.
@@ -8295,13 +13029,60 @@ cgCreateVertexDataSource
             attribs[global_attrib].Dimension  = dim;
             attribs[global_attrib].ByteOffset = ofs;
             attribs[global_attrib].Normalized = n;
+            attribs[global_attrib].Divisor    =(GLuint) local_attribs[local_attrib].InstanceDivisor;
+            if (attribs[global_attrib].Divisor != 0 && !GLEW_VERSION_3_3 && !GLEW_ARB_instanced_arrays)
+            {   // per-instance attributes require OpenGL 3.3 or GL_ARB_instanced_arrays.
+                result = CG_UNSUPPORTED;
+                goto error_cleanup;
+            }
+            if (local_attrib == 0) divs[buffer_index] = attribs[global_attrib].Divisor;
+        }
+    }
+
+    // separate vertex formats from buffer bindings where possible, so that data sources with the 
+    // same format share one vertex array object. the divisor belongs to the buffer binding point, 
+    // so every attribute sourced from a buffer must use the same divisor.
+    if (GLEW_VERSION_4_3 || GLEW_ARB_vertex_attrib_binding)
+    {
+        GLint max_offset = 0;
+        glGetIntegerv(GL_MAX_VERTEX_ATTRIB_RELATIVE_OFFSET, &max_offset);
+        shared = true;
+        for (size_t i = 0; i < num_attribs && shared; ++i)
+        {
+            if (attribs[i].Divisor != divs[indices[i]] || attribs[i].ByteOffset > size_t(max_offset))
+                shared = false;
         }
     }
+    if (shared)
+    {   // the buffer strides are supplied with the buffer bindings, so they are not part of the format.
+        hash = cgHashData(hash, &num_buffers, sizeof(size_t));
+        hash = cgHashData(hash, &num_attribs, sizeof(size_t));
+        hash = cgHashData(hash, divs, num_buffers * sizeof(GLuint));
+        for (size_t i = 0; i < num_attribs; ++i)
+        {
+            hash = cgHashData(hash, &regs   [i], sizeof(GLuint));
+            hash = cgHashData(hash, &indices[i], sizeof(size_t));
+            hash = cgHashData(hash, &attribs[i].DataType  , sizeof(GLenum));
+            hash = cgHashData(hash, &attribs[i].Dimension , sizeof(GLsizei));
+            hash = cgHashData(hash, &attribs[i].ByteOffset, sizeof(size_t));
+            hash = cgHashData(hash, &attribs[i].Normalized, sizeof(GLboolean));
+        }
+        if ((layout = cgAcquireVertexLayout(ctx, display, hash, num_buffers, divs, num_attribs, indices, regs, attribs, result)) == NULL)
+            goto error_cleanup;
+        vao = layout->VertexArray;
+        goto layout_ready;
+    }
+    glGenVertexArrays(1, &vao);
+    if (vao == 0)
+    {   // unable to allocate a vertex array object name.
+        result = CG_BAD_GLCONTEXT;
+        goto error_cleanup;
+    }
 
     // set up the OpenGL vertex array object. the VAO stores which attributes 
     // are enabled, where they come from (buffer bindings, types, offsets, strides)
     // and also which index array is active. OpenGL 3.3+ also stores instancing state.
-    glBindVertexArray(vao);
+    cgGlBindVertexArray(display, vao);
     if  (indexbuf != NULL)
     {   // the VAO captures the element array buffer binding immediately.
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexbuf->GraphicsBuffer);
@@ -8322,17 +13103,28 @@ cgCreateVertexDataSource
             attribs[i].DataType, 
             attribs[i].Normalized, 
             strides[indices[i]], 
-            CG_GL_BUFFER_OFFSET(attribs[i].ByteOffset)
+            CG_GL_BUFFER_OFFSET(offsets[indices[i]] + attribs[i].ByteOffset)
         );
+        if (attribs[i].Divisor != 0)
+        {   // the attribute advances once every Divisor instances.
+            if (GLEW_VERSION_3_3) glVertexAttribDivisor   (regs[i], attribs[i].Divisor);
+            else                  glVertexAttribDivisorARB(regs[i], attribs[i].Divisor);
+        }
     }
-    glBindVertexArray(0);
+    cgGlBindVertexArray(display, 0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
+layout_ready:
     // fill out and add the new vertex layout object.
     source.VertexArray    = vao;
+    source.SharedLayout   = layout;
     source.BufferCount    = num_buffers;
     source.AttributeCount = num_attribs;
+    source.BufferNames    = names;
+    source.BufferOffsets  = offsets;
+    source.IndexBuffer    = indexbuf != NULL ? indexbuf->GraphicsBuffer : 0;
+    source.IndexOffset    = index_offset;
     source.BufferStrides  = strides;
     source.BufferIndices  = indices;
     source.ShaderLocations= regs;
@@ -8347,18 +13139,66 @@ cgCreateVertexDataSource
     return handle;
 
 error_cleanup:
-    if (vao != 0)
+    if (layout != NULL)
+    {   // the vertex array object is owned by the shared layout.
+        cgReleaseVertexLayout(ctx, display, layout);
+    }
+    else if (vao != 0)
     {
-        glBindVertexArray(0);
+        cgGlBindVertexArray(display, 0);
         glDeleteVertexArrays(1, &vao);
+        cgGlStateObjectDeleted(display, GL_VERTEX_ARRAY, vao);
     }
     cgFreeHostMemory(&ctx->HostAllocator, attribs, num_attribs * sizeof(CG_VERTEX_ATTRIBUTE), 0, CG_ALLOCATION_TYPE_OBJECT);
     cgFreeHostMemory(&ctx->HostAllocator, regs   , num_attribs * sizeof(GLuint)             , 0, CG_ALLOCATION_TYPE_OBJECT);
     cgFreeHostMemory(&ctx->HostAllocator, indices, num_attribs * sizeof(size_t)             , 0, CG_ALLOCATION_TYPE_OBJECT);
     cgFreeHostMemory(&ctx->HostAllocator, strides, num_buffers * sizeof(size_t)             , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, offsets, num_buffers * sizeof(size_t)             , 0, CG_ALLOCATION_TYPE_OBJECT);
+    cgFreeHostMemory(&ctx->HostAllocator, names  , num_buffers * sizeof(GLuint)             , 0, CG_ALLOCATION_TYPE_OBJECT);
     return CG_INVALID_HANDLE;
 }
 
+/// @summary Enable or disable the on-disk cache of compiled compute program binaries. When enabled, cgCreateKernel loads 
+/// device binaries for compute programs from the cache instead of compiling the source code, and writes binaries for 
+/// programs it compiles. Entries are keyed on the source code, build options, device, driver and device capabilities.
+/// cgCreateGraphicsPipeline also caches linked OpenGL programs along with their reflection data, when the driver supports 
+/// GL_ARB_get_program_binary, keyed on the shader source, attribute and output bindings and the OpenGL driver strings.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param path The path of an existing directory in which to store program binaries, or NULL to disable the cache.
+/// @return CG_SUCCESS, CG_INVALID_VALUE or CG_OUT_OF_MEMORY.
+library_function int
+cgSetKernelCacheDirectory
+(
+    uintptr_t   context, 
+    char const *path
+)
+{
+    CG_CONTEXT *ctx  = (CG_CONTEXT*) context;
+    char       *copy = NULL;
+    size_t      size = 0;
+    if (path != NULL)
+    {   // the directory must already exist; CGFX never creates directories.
+        DWORD attr = GetFileAttributesA(path);
+        if (attr == INVALID_FILE_ATTRIBUTES || (attr & FILE_ATTRIBUTE_DIRECTORY) == 0)
+            return CG_INVALID_VALUE;
+        // strip any trailing separator; cgKernelCachePath adds one.
+        size = strlen(path) + 1;
+        while (size > 2 && (path[size-2] == '\\' || path[size-2] == '/'))
+            size--;
+        if ((copy = (char*) cgAllocateHostMemory(&ctx->HostAllocator, size, 0, CG_ALLOCATION_TYPE_INTERNAL)) == NULL)
+            return CG_OUT_OF_MEMORY;
+        memcpy(copy, path, size - 1);
+        copy[size - 1] = '\0';
+    }
+    if (ctx->KernelCache.Directory != NULL)
+    {   // free the previous directory path.
+        cgFreeHostMemory(&ctx->HostAllocator, ctx->KernelCache.Directory, ctx->KernelCache.DirectorySize, 0, CG_ALLOCATION_TYPE_INTERNAL);
+    }
+    ctx->KernelCache.Directory     = copy;
+    ctx->KernelCache.DirectorySize = size;
+    return CG_SUCCESS;
+}
+
 /// @summary Create a kernel object and load graphics or compute shader code into it.
 /// @param context A CGFX context returned by cgEnumerateDevices.
 /// @param exec_group The handle of the execution group that owns the kernel object.
@@ -8406,6 +13246,9 @@ cgCreateKernel
             kernel.AttachedDisplay  = group->AttachedDisplay;
             kernel.RenderingContext = group->RenderingContext;
             kernel.GraphicsShader   = 0;
+            kernel.SourceHash       = cgHashData(CG_FNV1A_64_SEED, code->Code, code->CodeSize);
+            kernel.BuildStatus      = CG_SUCCESS;
+            kernel.AsyncBuild       = NULL;
 
             // convert from CG_KERNEL_GRAPHICS_xxx => OpenGL shader type.
             GLenum shader_type   = 0;
@@ -8465,12 +13308,33 @@ cgCreateKernel
             kernel.AttachedDisplay  = NULL;
             kernel.RenderingContext = NULL;
             kernel.GraphicsShader   = 0;
+            kernel.SourceHash       = cgHashData(CG_FNV1A_64_SEED, code->Code, code->CodeSize);
+            kernel.BuildStatus      = CG_SUCCESS;
+            kernel.AsyncBuild       = NULL;
 
             // OpenCL drivers support kernel program loading from source or binary.
+            // build options and defines are part of the cache key.
+            char const *options = code->Options;
+            int64_t     start   = cgTimestamp();
             if (code->Flags & CG_KERNEL_FLAGS_SOURCE)
-            {   // load the source code into the program object.
-                cl_int clres = CL_SUCCESS;
-                cl_program p = clCreateProgramWithSource(group->ComputeContext, 1, (char const**) &code->Code, &code->CodeSize, &clres);
+            {   // check the on-disk cache for binaries built from the same source.
+                uint64_t  *keys  = cgClKernelCacheKeys(ctx, group, code, options);
+                cl_program p     = NULL;
+                cl_int     clres = CL_SUCCESS;
+                if (keys != NULL)
+                {
+                    InterlockedIncrement64(&ctx->KernelCache.Stats.LookupCount);
+                    if ((p = cgClLoadCachedProgram(ctx, group, keys, options)) != NULL)
+                    {   // every device had a usable binary; skip compilation entirely.
+                        cgClFreeKernelCacheKeys(ctx, group, keys);
+                        InterlockedIncrement64(&ctx->KernelCache.Stats.HitCount);
+                        InterlockedExchangeAdd64(&ctx->KernelCache.Stats.LoadNanos, LONGLONG(cgElapsedNanos(start)));
+                        kernel.ComputeProgram = p;
+                        break;
+                    }
+                }
+                // load the source code into the program object.
+                p = clCreateProgramWithSource(group->ComputeContext, 1, (char const**) &code->Code, &code->CodeSize, &clres);
                 if (p == NULL)
                 {
                     switch (clres)
@@ -8481,12 +13345,12 @@ cgCreateKernel
                     case CL_OUT_OF_HOST_MEMORY: result = CG_OUT_OF_MEMORY; break;
                     default: result = CG_ERROR; break;
                     }
+                    cgClFreeKernelCacheKeys(ctx, group, keys);
                     cgDeleteKernel(ctx, &kernel);
                     return CG_INVALID_HANDLE;
                 }
                 // compile the program for each device attached to the context.
-                // TODO(rlk): support passing compiler options and defines.
-                if ((clres = clBuildProgram(p, cl_uint(group->DeviceCount), group->DeviceIds, NULL, NULL, NULL)) != CL_SUCCESS)
+                if ((clres = clBuildProgram(p, cl_uint(group->DeviceCount), group->DeviceIds, options, NULL, NULL)) != CL_SUCCESS)
                 {
 #ifdef _DEBUG
                     if (clres == CL_BUILD_PROGRAM_FAILURE)
@@ -8519,19 +13383,61 @@ cgCreateKernel
                     case CL_OUT_OF_HOST_MEMORY    : result = CG_OUT_OF_MEMORY; break;
                     default                       : result = CG_ERROR;         break;
                     }
+                    clReleaseProgram(p);
+                    cgClFreeKernelCacheKeys(ctx, group, keys);
                     cgDeleteKernel(ctx, &kernel);
                     return CG_INVALID_HANDLE;
                 }
 
                 // save the compute kernel handle.
                 kernel.ComputeProgram = p;
+                InterlockedExchangeAdd64(&ctx->KernelCache.Stats.BuildNanos, LONGLONG(cgElapsedNanos(start)));
+                if (keys != NULL)
+                {   // write the device binaries so the next run can skip compilation.
+                    cgClStoreProgramBinaries(ctx, group->DeviceCount, group->DeviceIds, p, keys);
+                    cgClFreeKernelCacheKeys (ctx, group, keys);
+                }
+            }
+            else if (code->Flags & CG_KERNEL_FLAGS_BINARY)
+            {   // a single binary is supplied, so it's used for every device in the group.
+                // groups with different device types should load from source and rely on the cache.
+                size_t          count    = group->DeviceCount;
+                size_t         *sizes    = NULL;
+                unsigned char **binaries = NULL;
+                cl_program      p        = NULL;
+                if ((sizes = (size_t*) cgAllocateHostMemory(&ctx->HostAllocator, count * sizeof(size_t), 0, CG_ALLOCATION_TYPE_TEMP)) == NULL)
+                {
+                    cgDeleteKernel(ctx, &kernel);
+                    result = CG_OUT_OF_MEMORY;
+                    return CG_INVALID_HANDLE;
+                }
+                if ((binaries = (unsigned char**) cgAllocateHostMemory(&ctx->HostAllocator, count * sizeof(unsigned char*), 0, CG_ALLOCATION_TYPE_TEMP)) == NULL)
+                {
+                    cgFreeHostMemory(&ctx->HostAllocator, sizes, count * sizeof(size_t), 0, CG_ALLOCATION_TYPE_TEMP);
+                    cgDeleteKernel(ctx, &kernel);
+                    result = CG_OUT_OF_MEMORY;
+                    return CG_INVALID_HANDLE;
+                }
+                for (size_t i = 0; i < count; ++i)
+                {
+                    binaries[i] = (unsigned char*) code->Code;
+                    sizes[i]    = code->CodeSize;
+                }
+                p = cgClCreateProgramWithBinaries(group, (unsigned char const**) binaries, sizes, options, result);
+                cgFreeHostMemory(&ctx->HostAllocator, binaries, count * sizeof(unsigned char*), 0, CG_ALLOCATION_TYPE_TEMP);
+                cgFreeHostMemory(&ctx->HostAllocator, sizes   , count * sizeof(size_t)        , 0, CG_ALLOCATION_TYPE_TEMP);
+                if (p == NULL)
+                {   // result has been set to the reason for the failure.
+                    cgDeleteKernel(ctx, &kernel);
+                    return CG_INVALID_HANDLE;
+                }
+                kernel.ComputeProgram = p;
+                InterlockedExchangeAdd64(&ctx->KernelCache.Stats.LoadNanos, LONGLONG(cgElapsedNanos(start)));
             }
             else
-            {   // TODO(rlk): support loading of binaries.
-                // this requires having a list of devices per-context.
-                // also, the kernel code structure must store a pointer to the binary for each device.
+            {   // one of CG_KERNEL_FLAGS_SOURCE or CG_KERNEL_FLAGS_BINARY must be set.
                 cgDeleteKernel(ctx, &kernel);
-                result = CG_UNSUPPORTED;
+                result = CG_INVALID_VALUE;
                 return CG_INVALID_HANDLE;
             }
         }
@@ -8549,45 +13455,142 @@ cgCreateKernel
         result = CG_OUT_OF_OBJECTS;
         return CG_INVALID_HANDLE;
     }
+    result = CG_SUCCESS;
     return handle;
 }
 
-/// @summary Create a new compute pipeline object to execute an OpenCL compute kernel.
+/// @summary Create a kernel object, building compute programs from source on the system thread pool so that the calling 
+/// thread is not blocked by the OpenCL compiler. Compute programs found in the kernel cache, compute programs supplied as 
+/// binaries and graphics shaders are created synchronously, since OpenGL shaders must be compiled on the thread that owns 
+/// the rendering context. Use cgGetBuildStatus or the completion event to determine when the kernel is ready.
 /// @param context A CGFX context returned by cgEnumerateDevices.
-/// @param exec_group The handle of the execution group defining the devices the kernel may execute on.
-/// @param create Information about the pipeline configuration.
-/// @param opaque Opaque state internal to the pipeline implementation.
-/// @param teardown The callback function to invoke when the pipeline is destroyed.
-/// @param result On return, set to CG_SUCCESS, ...
-/// @return The handle of the compute pipeline, or CG_INVALID_HANDLE.
+/// @param exec_group The handle of the execution group that owns the kernel object.
+/// @param code A description of the code to load into the kernel object.
+/// @param done_event The handle of an event, created with cgCreateEvent, to signal when the kernel is ready, or CG_INVALID_HANDLE.
+/// @param result On return, set to CG_SUCCESS, CG_NOT_READY if the build is in progress, or any result code returned by cgCreateKernel.
+/// @return The handle of the kernel object, or CG_INVALID_HANDLE.
 library_function cg_handle_t
-cgCreateComputePipeline
+cgCreateKernelAsync
 (
-    uintptr_t                    context,
-    cg_handle_t                  exec_group,
-    cg_compute_pipeline_t const *create,
-    void                        *opaque,
-    cgPipelineTeardown_fn        teardown,
-    int                         &result
+    uintptr_t               context,
+    cg_handle_t             exec_group,
+    cg_kernel_code_t const *code,
+    cg_handle_t             done_event,
+    int                    &result
 )
 {
-    cl_uint    arg_count =  0;
-    cg_handle_t   handle =  CG_INVALID_HANDLE;
     CG_CONTEXT    *ctx   = (CG_CONTEXT*) context;
     CG_EXEC_GROUP *group =  cgObjectTableGet(&ctx->ExecGroupTable, exec_group);
+    cg_handle_t   handle =  CG_INVALID_HANDLE;
     if (group == NULL)
     {   // an invalid execution group was specified.
         result = CG_INVALID_VALUE;
         return CG_INVALID_HANDLE;
     }
-
-    CG_KERNEL *kernel = cgObjectTableGet(&ctx->KernelTable, create->KernelProgram);
-    if (kernel == NULL || kernel->KernelType != CG_KERNEL_TYPE_COMPUTE)
-    {   // an invalid kernel program handle was specified.
+    if (done_event != CG_INVALID_HANDLE && cgObjectTableGet(&ctx->EventTable, done_event) == NULL)
+    {   // an invalid completion event was specified.
         result = CG_INVALID_VALUE;
         return CG_INVALID_HANDLE;
     }
+    if (code->Type != CG_KERNEL_TYPE_COMPUTE || (code->Flags & CG_KERNEL_FLAGS_SOURCE) == 0)
+    {   // nothing to defer; create the kernel now and signal the event immediately.
+        if ((handle = cgCreateKernel(context, exec_group, code, result)) == CG_INVALID_HANDLE)
+            return CG_INVALID_HANDLE;
+        if ((result = cgLinkBuildEvent(ctx, group->ComputeContext, done_event, NULL)) != CG_SUCCESS)
+        {   // the caller would never see the event signaled.
+            cgDeleteObject(context, handle);
+            return CG_INVALID_HANDLE;
+        }
+        return handle;
+    }
+
+    CG_KERNEL kernel;
+    kernel.KernelType       = code->Type;
+    kernel.ComputeContext   = group->ComputeContext;
+    kernel.ComputeProgram   = NULL;
+    kernel.AttachedDisplay  = NULL;
+    kernel.RenderingContext = NULL;
+    kernel.GraphicsShader   = 0;
+    kernel.SourceHash       = cgHashData(CG_FNV1A_64_SEED, code->Code, code->CodeSize);
+    kernel.BuildStatus      = CG_SUCCESS;
+    kernel.AsyncBuild       = NULL;
+
+    // check the on-disk cache first; loading binaries is cheap, so it's done synchronously.
+    char const *options = code->Options;
+    int64_t     start   = cgTimestamp();
+    uint64_t   *keys    = cgClKernelCacheKeys(ctx, group, code, options);
+    cl_program  p       = NULL;
+    cl_int      clres   = CL_SUCCESS;
+    if (keys != NULL)
+    {
+        InterlockedIncrement64(&ctx->KernelCache.Stats.LookupCount);
+        if ((p = cgClLoadCachedProgram(ctx, group, keys, options)) != NULL)
+        {   // every device had a usable binary; the kernel is ready now.
+            InterlockedIncrement64(&ctx->KernelCache.Stats.HitCount);
+            InterlockedExchangeAdd64(&ctx->KernelCache.Stats.LoadNanos, LONGLONG(cgElapsedNanos(start)));
+            kernel.ComputeProgram = p;
+        }
+    }
+    if (kernel.ComputeProgram == NULL)
+    {   // load the source code into the program object and build it on the thread pool.
+        if ((p = clCreateProgramWithSource(group->ComputeContext, 1, (char const**) &code->Code, &code->CodeSize, &clres)) == NULL)
+        {
+            switch (clres)
+            {
+            case CL_INVALID_CONTEXT   : result = CG_BAD_CLCONTEXT; break;
+            case CL_INVALID_VALUE     : result = CG_INVALID_VALUE; break;
+            case CL_OUT_OF_RESOURCES  : result = CG_OUT_OF_MEMORY; break;
+            case CL_OUT_OF_HOST_MEMORY: result = CG_OUT_OF_MEMORY; break;
+            default: result = CG_ERROR; break;
+            }
+            cgClFreeKernelCacheKeys(ctx, group, keys);
+            return CG_INVALID_HANDLE;
+        }
+        kernel.ComputeProgram = p;
+        if ((result = cgClBeginKernelBuild(ctx, group, p, keys, options, &kernel.AsyncBuild)) != CG_SUCCESS)
+        {   // the build could not be queued.
+            cgClFreeKernelCacheKeys(ctx, group, keys);
+            cgDeleteKernel(ctx, &kernel);
+            return CG_INVALID_HANDLE;
+        }
+        kernel.BuildStatus = CG_NOT_READY;
+    }
+    cgClFreeKernelCacheKeys(ctx, group, keys);
+
+    if ((handle = cgObjectTableAdd(&ctx->KernelTable, kernel)) == CG_INVALID_HANDLE)
+    {
+        cgDeleteKernel(ctx, &kernel);
+        result = CG_OUT_OF_OBJECTS;
+        return CG_INVALID_HANDLE;
+    }
+    if ((result = cgLinkBuildEvent(ctx, group->ComputeContext, done_event, kernel.AsyncBuild != NULL ? kernel.AsyncBuild->ReadyEvent : NULL)) != CG_SUCCESS)
+    {   // the caller would never see the event signaled. deleting the kernel waits for any build in progress.
+        cgDeleteObject(context, handle);
+        return CG_INVALID_HANDLE;
+    }
+    result = kernel.BuildStatus;
+    return handle;
+}
 
+/// @summary Initialize the state common to all compute pipelines created for an execution group.
+/// @param ctx The CGFX context that will own the pipeline.
+/// @param group The execution group defining the devices the kernel may execute on.
+/// @param create Information about the pipeline configuration.
+/// @param opaque Opaque state internal to the pipeline implementation.
+/// @param teardown The callback function to invoke when the pipeline is destroyed, or NULL.
+/// @param pipe The pipeline object to initialize.
+/// @return CG_SUCCESS or CG_OUT_OF_MEMORY.
+internal_function int
+cgInitComputePipeline
+(
+    CG_CONTEXT                  *ctx, 
+    CG_EXEC_GROUP               *group, 
+    cg_compute_pipeline_t const *create, 
+    void                        *opaque, 
+    cgPipelineTeardown_fn        teardown, 
+    CG_PIPELINE                 &pipe
+)
+{
     // use the no-op teardown callback if none is supplied.
     if (teardown == NULL)
     {   // using the no-op prevents having to NULL-check.
@@ -8595,14 +13598,19 @@ cgCreateComputePipeline
     }
 
     // allocate resources for the compute pipeline description:
-    CG_PIPELINE          pipe;
     CG_COMPUTE_PIPELINE &cp= pipe.Compute;
     memset(&pipe.Compute, 0, sizeof(CG_COMPUTE_PIPELINE));
     pipe.PipelineType   = CG_PIPELINE_TYPE_COMPUTE;
+    pipe.ContentHash    = 0;
+    pipe.ExecGroup      = CG_INVALID_HANDLE;
+    pipe.Shareable      = true;
+    pipe.ReferenceCount = 1;
     pipe.PrivateState   = opaque;
     pipe.DestroyState   = teardown;
     cp.ComputeContext   = group->ComputeContext;
     cp.ComputeKernel    = NULL;
+    cp.BuildStatus      = CG_SUCCESS;
+    cp.KernelProgram    = create->KernelProgram;
 
     cp.DeviceCount      = group->DeviceCount;
     cp.DeviceList       = group->DeviceList;
@@ -8611,59 +13619,186 @@ cgCreateComputePipeline
     cp.DeviceKernelInfo =(CG_CL_WORKGROUP_INFO*) cgAllocateHostMemory(&ctx->HostAllocator, group->DeviceCount * sizeof(CG_CL_WORKGROUP_INFO), 0, CG_ALLOCATION_TYPE_OBJECT);
     if (cp.DeviceKernelInfo == NULL)
     {   // unable to allocate required memory.
-        result = CG_OUT_OF_MEMORY;
-        goto error_cleanup;
+        return CG_OUT_OF_MEMORY;
     }
     memset(cp.DeviceKernelInfo, 0, group->DeviceCount  * sizeof(CG_CL_WORKGROUP_INFO));
 
-    // create the cl_kernel object for each context:
-    cl_int clres = 0;
-    cl_kernel  k = clCreateKernel(kernel->ComputeProgram, create->KernelName, &clres);
-    if (k == NULL)
+    // save the kernel name, which identifies the pipeline and is needed to finish an asynchronous build.
+    cp.KernelNameSize   = strlen(create->KernelName) + 1;
+    if ((cp.KernelName  = (char*) cgAllocateHostMemory(&ctx->HostAllocator, cp.KernelNameSize, 0, CG_ALLOCATION_TYPE_OBJECT)) == NULL)
+    {   // unable to allocate required memory.
+        cp.KernelNameSize = 0;
+        return CG_OUT_OF_MEMORY;
+    }
+    memcpy(cp.KernelName, create->KernelName, cp.KernelNameSize);
+    return CG_SUCCESS;
+}
+
+/// @summary Create a new compute pipeline object to execute an OpenCL compute kernel. If the kernel was created with 
+/// cgCreateKernelAsync and is still building, the calling thread blocks until the build completes. If a pipeline with an 
+/// identical description, opaque state and teardown callback already exists, its reference count is incremented and its 
+/// handle is returned; each successful call must be balanced by a call to cgDeleteObject. Callers sharing a pipeline also 
+/// share its OpenCL kernel object, so kernel arguments set by one dispatch remain set for the next. Pipelines with 
+/// autotuning enabled are not shared.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param exec_group The handle of the execution group defining the devices the kernel may execute on.
+/// @param create Information about the pipeline configuration.
+/// @param opaque Opaque state internal to the pipeline implementation.
+/// @param teardown The callback function to invoke when the pipeline is destroyed.
+/// @param result On return, set to CG_SUCCESS, ...
+/// @return The handle of the compute pipeline, or CG_INVALID_HANDLE.
+library_function cg_handle_t
+cgCreateComputePipeline
+(
+    uintptr_t                    context,
+    cg_handle_t                  exec_group,
+    cg_compute_pipeline_t const *create,
+    void                        *opaque,
+    cgPipelineTeardown_fn        teardown,
+    int                         &result
+)
+{
+    cg_handle_t   handle =  CG_INVALID_HANDLE;
+    CG_CONTEXT    *ctx   = (CG_CONTEXT*) context;
+    CG_EXEC_GROUP *group =  cgObjectTableGet(&ctx->ExecGroupTable, exec_group);
+    if (group == NULL)
+    {   // an invalid execution group was specified.
+        result = CG_INVALID_VALUE;
+        return CG_INVALID_HANDLE;
+    }
+
+    CG_KERNEL *kernel = cgObjectTableGet(&ctx->KernelTable, create->KernelProgram);
+    if (kernel == NULL || kernel->KernelType != CG_KERNEL_TYPE_COMPUTE)
+    {   // an invalid kernel program handle was specified.
+        result = CG_INVALID_VALUE;
+        return CG_INVALID_HANDLE;
+    }
+    if ((result = cgResolveKernelBuild(ctx, kernel)) == CG_NOT_READY)
+    {   // the program is still building on the thread pool.
+        cgWaitKernelBuild(kernel->AsyncBuild);
+        result = cgResolveKernelBuild(ctx, kernel);
+    }
+    if (result != CG_SUCCESS)
+    {   // the kernel program failed to build.
+        return CG_INVALID_HANDLE;
+    }
+
+    // return the existing pipeline if an identical one has already been created.
+    uint64_t content_hash = cgComputePipelineKey(exec_group, create, opaque, teardown != NULL ? teardown : cgPipelineTeardownNoOp);
+    if ((handle = cgFindSharedPipeline(ctx, CG_PIPELINE_TYPE_COMPUTE, exec_group, create, content_hash, opaque, teardown != NULL ? teardown : cgPipelineTeardownNoOp)) != CG_INVALID_HANDLE)
+    {   // the existing pipeline may have been created asynchronously; make sure it is ready.
+        CG_PIPELINE *existing = cgObjectTableGet(&ctx->PipelineTable, handle);
+        if ((result = cgResolveComputePipeline(ctx, &existing->Compute)) != CG_SUCCESS)
+        {   // the pipeline failed to initialize; drop the reference taken by the search.
+            existing->ReferenceCount--;
+            return CG_INVALID_HANDLE;
+        }
+        return handle;
+    }
+
+    CG_PIPELINE pipe;
+    if ((result = cgInitComputePipeline(ctx, group, create, opaque, teardown, pipe)) != CG_SUCCESS)
+    {   // unable to allocate required memory.
+        goto error_cleanup;
+    }
+    pipe.ContentHash = content_hash;
+    pipe.ExecGroup   = exec_group;
+    // create the cl_kernel object and retrieve argument information.
+    if ((result = cgClFinishComputePipeline(ctx, &pipe.Compute, kernel->ComputeProgram, create->KernelName, kernel->SourceHash)) != CG_SUCCESS)
     {   // the kernel couldn't be created.
-        switch (clres)
-        {
-        case CL_INVALID_PROGRAM           : result = CG_ERROR; break;
-        case CL_INVALID_PROGRAM_EXECUTABLE: result = CG_ERROR; break;
-        case CL_INVALID_KERNEL_NAME       : result = CG_ERROR; break;
-        case CL_INVALID_KERNEL_DEFINITION : result = CG_ERROR; break;
-        case CL_INVALID_VALUE             : result = CG_ERROR; break;
-        case CL_OUT_OF_HOST_MEMORY        : result = CG_OUT_OF_MEMORY; break;
-        default: result = CG_ERROR;  break;
+        goto error_cleanup;
+    }
+
+    // insert the pipeline into the object table.
+    if ((handle = cgObjectTableAdd(&ctx->PipelineTable, pipe)) == CG_INVALID_HANDLE)
+    {   // the object table is full.
+        result = CG_OUT_OF_OBJECTS;
+        goto error_cleanup;
+    }
+    return handle;
+
+error_cleanup:
+    cgDeleteComputePipeline(ctx, &pipe.Compute);
+    return CG_INVALID_HANDLE;
+}
+
+/// @summary Create a new compute pipeline object without waiting for its kernel program to finish building. If the kernel 
+/// is ready, this behaves like cgCreateComputePipeline. Otherwise the pipeline handle is returned immediately, and creation 
+/// of the OpenCL kernel object and argument reflection is completed by the first call to cgGetBuildStatus or dispatch after 
+/// the build finishes. Dispatching the pipeline before then fails with CG_NOT_READY, which stops command buffer execution.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param exec_group The handle of the execution group defining the devices the kernel may execute on.
+/// @param create Information about the pipeline configuration.
+/// @param opaque Opaque state internal to the pipeline implementation.
+/// @param teardown The callback function to invoke when the pipeline is destroyed.
+/// @param done_event The handle of an event, created with cgCreateEvent, to signal when the kernel program is built, or CG_INVALID_HANDLE.
+/// @param result On return, set to CG_SUCCESS, CG_NOT_READY if the kernel is still building, or another result code.
+/// @return The handle of the compute pipeline, or CG_INVALID_HANDLE.
+library_function cg_handle_t
+cgCreateComputePipelineAsync
+(
+    uintptr_t                    context,
+    cg_handle_t                  exec_group,
+    cg_compute_pipeline_t const *create,
+    void                        *opaque,
+    cgPipelineTeardown_fn        teardown,
+    cg_handle_t                  done_event,
+    int                         &result
+)
+{
+    cg_handle_t   handle =  CG_INVALID_HANDLE;
+    CG_CONTEXT    *ctx   = (CG_CONTEXT*) context;
+    CG_EXEC_GROUP *group =  cgObjectTableGet(&ctx->ExecGroupTable, exec_group);
+    CG_KERNEL    *kernel =  cgObjectTableGet(&ctx->KernelTable, create->KernelProgram);
+    if (group == NULL)
+    {   // an invalid execution group was specified.
+        result = CG_INVALID_VALUE;
+        return CG_INVALID_HANDLE;
+    }
+    if (kernel == NULL || kernel->KernelType != CG_KERNEL_TYPE_COMPUTE)
+    {   // an invalid kernel program handle was specified.
+        result = CG_INVALID_VALUE;
+        return CG_INVALID_HANDLE;
+    }
+    if (done_event != CG_INVALID_HANDLE && cgObjectTableGet(&ctx->EventTable, done_event) == NULL)
+    {   // an invalid completion event was specified.
+        result = CG_INVALID_VALUE;
+        return CG_INVALID_HANDLE;
+    }
+    if (cgResolveKernelBuild(ctx, kernel) != CG_NOT_READY)
+    {   // the build has already finished; create the pipeline now and signal the event immediately.
+        if ((handle = cgCreateComputePipeline(context, exec_group, create, opaque, teardown, result)) == CG_INVALID_HANDLE)
+            return CG_INVALID_HANDLE;
+        if ((result = cgLinkBuildEvent(ctx, group->ComputeContext, done_event, NULL)) != CG_SUCCESS)
+        {   // the caller would never see the event signaled.
+            cgDeleteObject(context, handle);
+            return CG_INVALID_HANDLE;
         }
-        goto error_cleanup;
+        return handle;
     }
-    else
-    {   // link the kernel to all devices that share the context.
-        for (size_t device_index = 0, device_count = group->DeviceCount; device_index < device_count; ++device_index)
-        {
-            clGetKernelWorkGroupInfo(k, group->DeviceIds[device_index], CL_KERNEL_WORK_GROUP_SIZE        , sizeof(size_t) * 1, &cp.DeviceKernelInfo[device_index].WorkGroupSize , NULL);
-            clGetKernelWorkGroupInfo(k, group->DeviceIds[device_index], CL_KERNEL_COMPILE_WORK_GROUP_SIZE, sizeof(size_t) * 3,  cp.DeviceKernelInfo[device_index].FixedGroupSize, NULL);
-            clGetKernelWorkGroupInfo(k, group->DeviceIds[device_index], CL_KERNEL_LOCAL_MEM_SIZE         , sizeof(cl_ulong)  , &cp.DeviceKernelInfo[device_index].LocalMemory   , NULL);
+
+    // return the existing pipeline if an identical one has already been created. it is still waiting on the same build.
+    uint64_t content_hash = cgComputePipelineKey(exec_group, create, opaque, teardown != NULL ? teardown : cgPipelineTeardownNoOp);
+    if ((handle = cgFindSharedPipeline(ctx, CG_PIPELINE_TYPE_COMPUTE, exec_group, create, content_hash, opaque, teardown != NULL ? teardown : cgPipelineTeardownNoOp)) != CG_INVALID_HANDLE)
+    {
+        if ((result = cgLinkBuildEvent(ctx, group->ComputeContext, done_event, kernel->AsyncBuild->ReadyEvent)) != CG_SUCCESS)
+        {   // drop the reference taken by cgFindSharedPipeline.
+            cgDeleteObject(context, handle);
+            return CG_INVALID_HANDLE;
         }
-        cp.ComputeKernel = k;
+        result = CG_NOT_READY;
+        return handle;
     }
 
-    // retrieve argument information. this is consistent across kernels.
-    clGetKernelInfo(cp.ComputeKernel, CL_KERNEL_NUM_ARGS, sizeof(cl_uint), &arg_count, NULL);
-    cp.ArgumentCount = size_t(arg_count);
-    cp.ArgumentNames =(uint32_t        *) cgAllocateHostMemory(&ctx->HostAllocator, arg_count * sizeof(uint32_t)        , 0, CG_ALLOCATION_TYPE_OBJECT);
-    cp.Arguments     =(CG_CL_KERNEL_ARG*) cgAllocateHostMemory(&ctx->HostAllocator, arg_count * sizeof(CG_CL_KERNEL_ARG), 0, CG_ALLOCATION_TYPE_OBJECT);
-    if (cp.ArgumentNames == NULL || cp.Arguments == NULL)
-    {   // unable to allocate the required memory.
-        result = CG_OUT_OF_MEMORY;
+    // the kernel object is created from the saved kernel name once the program is ready.
+    CG_PIPELINE pipe;
+    if ((result = cgInitComputePipeline(ctx, group, create, opaque, teardown, pipe)) != CG_SUCCESS)
+    {   // unable to allocate required memory.
         goto error_cleanup;
     }
-    for (size_t i = 0; i < size_t(arg_count); ++i)
-    {
-        char          *name = cgClKernelArgName(ctx, cp.ComputeKernel, cl_uint(i), CG_ALLOCATION_TYPE_TEMP);
-        cp.ArgumentNames[i] = cgHashName(name);
-        cp.Arguments[i].Index  = cl_uint(i);
-        clGetKernelArgInfo(cp.ComputeKernel, cl_uint(i), CL_KERNEL_ARG_ACCESS_QUALIFIER , sizeof(cl_kernel_arg_access_qualifier) , &cp.Arguments[i].ImageAccess  , NULL);
-        clGetKernelArgInfo(cp.ComputeKernel, cl_uint(i), CL_KERNEL_ARG_ADDRESS_QUALIFIER, sizeof(cl_kernel_arg_address_qualifier), &cp.Arguments[i].MemoryType   , NULL);
-        clGetKernelArgInfo(cp.ComputeKernel, cl_uint(i), CL_KERNEL_ARG_TYPE_QUALIFIER   , sizeof(cl_kernel_arg_type_qualifier)   , &cp.Arguments[i].TypeQualifier, NULL);
-        cgClFreeString(ctx, name, CG_ALLOCATION_TYPE_TEMP);
-    }
+    pipe.ContentHash = content_hash;
+    pipe.ExecGroup   = exec_group;
+    pipe.Compute.BuildStatus = CG_NOT_READY;
 
     // insert the pipeline into the object table.
     if ((handle = cgObjectTableAdd(&ctx->PipelineTable, pipe)) == CG_INVALID_HANDLE)
@@ -8671,6 +13806,12 @@ cgCreateComputePipeline
         result = CG_OUT_OF_OBJECTS;
         goto error_cleanup;
     }
+    if ((result = cgLinkBuildEvent(ctx, group->ComputeContext, done_event, kernel->AsyncBuild->ReadyEvent)) != CG_SUCCESS)
+    {   // the caller would never see the event signaled.
+        cgDeleteObject(context, handle);
+        return CG_INVALID_HANDLE;
+    }
+    result = CG_NOT_READY;
     return handle;
 
 error_cleanup:
@@ -8678,7 +13819,81 @@ error_cleanup:
     return CG_INVALID_HANDLE;
 }
 
-/// @summary Create a new graphics pipeline object to execute an OpenGL shader program.
+/// @summary Determine whether a kernel or pipeline object created asynchronously is ready for use. For compute pipelines 
+/// whose kernel program has finished building, this completes creation of the pipeline. Must be called on the thread 
+/// that created the object.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param object The handle of a kernel or pipeline object.
+/// @return CG_SUCCESS if the object is ready, CG_NOT_READY if it is still building, CG_INVALID_VALUE if the handle is invalid, or the reason the build failed.
+library_function int
+cgGetBuildStatus
+(
+    uintptr_t   context, 
+    cg_handle_t object
+)
+{
+    CG_CONTEXT *ctx = (CG_CONTEXT*) context;
+    switch (cgGetObjectType(object))
+    {
+    case CG_OBJECT_KERNEL:
+        {
+            CG_KERNEL *kernel = cgObjectTableGet(&ctx->KernelTable, object);
+            if (kernel == NULL) return CG_INVALID_VALUE;
+            return cgResolveKernelBuild(ctx, kernel);
+        }
+    case CG_OBJECT_PIPELINE:
+        {
+            CG_PIPELINE *pipe = cgObjectTableGet(&ctx->PipelineTable, object);
+            if (pipe == NULL) return CG_INVALID_VALUE;
+            if (pipe->PipelineType != CG_PIPELINE_TYPE_COMPUTE) return CG_SUCCESS;
+            return cgResolveComputePipeline(ctx, &pipe->Compute);
+        }
+    default:
+        break;
+    }
+    return CG_INVALID_VALUE;
+}
+
+/// @summary Enable or disable work group size autotuning for a compute pipeline. When enabled, dispatches recorded with 
+/// cgComputeDispatch that do not specify a local size time a set of candidate local sizes on the first dispatches of each 
+/// problem-size class and device, then use the fastest. If a kernel cache directory is set, results are persisted there.
+/// Once autotuning is enabled, later create calls with the same description return a new pipeline. The setting cannot be 
+/// changed while the pipeline is shared by more than one create call, since it would change the other callers' dispatches.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param pipeline The handle of a compute pipeline object.
+/// @param enable Specify true to enable autotuning, or false to let the runtime select the local size.
+/// @return CG_SUCCESS, CG_INVALID_VALUE or CG_INVALID_STATE if the pipeline is shared.
+library_function int
+cgSetComputePipelineAutotune
+(
+    uintptr_t   context, 
+    cg_handle_t pipeline, 
+    bool        enable
+)
+{
+    CG_CONTEXT  *ctx  = (CG_CONTEXT*) context;
+    CG_PIPELINE *pipe =  cgObjectTableGet(&ctx->PipelineTable, pipeline);
+    if (pipe == NULL || pipe->PipelineType != CG_PIPELINE_TYPE_COMPUTE)
+    {   // an invalid pipeline handle was specified.
+        return CG_INVALID_VALUE;
+    }
+    if (pipe->Compute.AutoTune == enable)
+    {   // nothing to change.
+        return CG_SUCCESS;
+    }
+    if (pipe->ReferenceCount > 1)
+    {   // another create call returned the same pipeline.
+        return CG_INVALID_STATE;
+    }
+    pipe->Compute.AutoTune = enable;
+    pipe->Shareable        = false;
+    return CG_SUCCESS;
+}
+
+/// @summary Create a new graphics pipeline object to execute an OpenGL shader program. If a pipeline with the same shader 
+/// kernels, bindings, fixed-function state, opaque state and teardown callback already exists in the execution group, its 
+/// reference count is incremented and its handle and linked program are returned without linking. Each successful call 
+/// must be balanced by a call to cgDeleteObject.
 /// @param context A CGFX context returned by cgEnumerateDevices.
 /// @param exec_group The handle of the execution group defining the rendering contexts.
 /// @param create Information about the pipeline configuration.
@@ -8742,15 +13957,30 @@ cgCreateGraphicsPipeline
         teardown  = cgPipelineTeardownNoOp;
     }
 
+    // return the existing pipeline and its linked program if an identical one has already been created.
+    uint64_t content_hash   = cgGraphicsPipelineKey(exec_group, create, opaque, teardown);
+    if ((handle = cgFindSharedPipeline(ctx, CG_PIPELINE_TYPE_GRAPHICS, exec_group, create, content_hash, opaque, teardown)) != CG_INVALID_HANDLE)
+    {
+        result = CG_SUCCESS;
+        return handle;
+    }
+
     // allocate resources for the graphics pipeline description:
     CG_DISPLAY      *display= group->AttachedDisplay;
     CG_PIPELINE         pipe;
     CG_GRAPHICS_PIPELINE &gp= pipe.Graphics;
     memset(&pipe.Graphics, 0, sizeof(CG_GRAPHICS_PIPELINE));
     pipe.PipelineType       = CG_PIPELINE_TYPE_GRAPHICS;
+    pipe.ContentHash        = content_hash;
+    pipe.ExecGroup          = exec_group;
+    pipe.Shareable          = true;
+    pipe.ReferenceCount     = 1;
     pipe.PrivateState       = opaque;
     pipe.DestroyState       = teardown;
     gp.AttachedDisplay      = group->AttachedDisplay;
+    gp.VertexShader         = create->VertexShader;
+    gp.GeometryShader       = create->GeometryShader;
+    gp.FragmentShader       = create->FragmentShader;
     gp.DeviceCount          = group->DeviceCount;
     gp.DeviceList           = group->DeviceList;
     gp.DisplayCount         = group->DisplayCount;
@@ -8767,11 +13997,15 @@ cgCreateGraphicsPipeline
     GLsizei       log_size  = 0;
     GLint            a_max  = 0; // length of longest active vertex attribute name
     GLint            u_max  = 0; // length of longest active uniform name
+    GLint            b_max  = 0; // length of longest active uniform block name
     size_t        name_max  = 0; // length of longest string name
     size_t     num_attribs  = 0;
     size_t    num_samplers  = 0;
     size_t    num_uniforms  = 0;
+    size_t      num_blocks  = 0;
     char         *name_buf  = NULL;
+    uint64_t     cache_key  = 0;
+    int64_t          start  = cgTimestamp();
 
     if (program == 0)
     {   // unable to create the program object.
@@ -8785,6 +14019,21 @@ cgCreateGraphicsPipeline
         goto error_cleanup;
     }
 
+    // try to restore the linked program and its reflection data from the on-disk cache.
+    if ((cache_key = cgGlProgramCacheKey(ctx, display, vs_kernel, gs_kernel, fs_kernel, create)) != 0)
+    {
+        InterlockedIncrement64(&ctx->KernelCache.Stats.PipelineLookupCount);
+        if (cgGlLoadCachedProgram(ctx, display, program, cache_key, &glsl))
+        {   // the driver accepted the cached binary; skip linking and reflection.
+            InterlockedIncrement64(&ctx->KernelCache.Stats.PipelineHitCount);
+            InterlockedExchangeAdd64(&ctx->KernelCache.Stats.PipelineLoadNanos, LONGLONG(cgElapsedNanos(start)));
+            goto program_ready;
+        }
+        // ask the driver to retain the binary so it can be written to the cache.
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        start = cgTimestamp();
+    }
+
     // attach the shader objects to the program object.
     if (vs) glAttachShader(program, vs);
     if (gs) glAttachShader(program, gs);
@@ -8829,6 +14078,8 @@ cgCreateGraphicsPipeline
     // we'll use these values to allocate a single temp buffer for strings.
     glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH  , &u_max);
     glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &a_max);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &b_max);
+    if (b_max > u_max) u_max = b_max;
     name_max = (size_t) (u_max > a_max ? u_max + 1 : a_max + 1);
     name_buf = (char *)  cgAllocateHostMemory(&ctx->HostAllocator, name_max, 0, CG_ALLOCATION_TYPE_TEMP);
     if (name_buf == NULL)
@@ -8837,9 +14088,9 @@ cgCreateGraphicsPipeline
         result = CG_OUT_OF_MEMORY;
         goto error_cleanup;
     }
-    cgGlslReflectProgramCounts(display, program, name_buf, name_max, false, num_attribs, num_samplers, num_uniforms);
+    cgGlslReflectProgramCounts(display, program, name_buf, name_max, false, num_attribs, num_samplers, num_uniforms, num_blocks);
 
-    // allocate storage for the attribute, sampler and uniform metadata.
+    // allocate storage for the attribute, sampler, uniform and uniform block metadata.
     glsl.AttributeCount = num_attribs;
     glsl.AttributeNames =(uint32_t         *) cgAllocateHostMemory(&ctx->HostAllocator, num_attribs  * sizeof(uint32_t)         , 0, CG_ALLOCATION_TYPE_OBJECT);
     glsl.Attributes     =(CG_GLSL_ATTRIBUTE*) cgAllocateHostMemory(&ctx->HostAllocator, num_attribs  * sizeof(CG_GLSL_ATTRIBUTE), 0, CG_ALLOCATION_TYPE_OBJECT);
@@ -8849,9 +14100,13 @@ cgCreateGraphicsPipeline
     glsl.UniformCount   = num_uniforms;
     glsl.UniformNames   =(uint32_t         *) cgAllocateHostMemory(&ctx->HostAllocator, num_uniforms * sizeof(uint32_t)         , 0, CG_ALLOCATION_TYPE_OBJECT);
     glsl.Uniforms       =(CG_GLSL_UNIFORM  *) cgAllocateHostMemory(&ctx->HostAllocator, num_uniforms * sizeof(CG_GLSL_UNIFORM)  , 0, CG_ALLOCATION_TYPE_OBJECT);
+    glsl.UniformBlockCount = num_blocks;
+    glsl.UniformBlockNames =(uint32_t             *) cgAllocateHostMemory(&ctx->HostAllocator, num_blocks * sizeof(uint32_t)             , 0, CG_ALLOCATION_TYPE_OBJECT);
+    glsl.UniformBlocks     =(CG_GLSL_UNIFORM_BLOCK*) cgAllocateHostMemory(&ctx->HostAllocator, num_blocks * sizeof(CG_GLSL_UNIFORM_BLOCK), 0, CG_ALLOCATION_TYPE_OBJECT);
     if (glsl.AttributeNames == NULL || glsl.Attributes == NULL ||
         glsl.SamplerNames   == NULL || glsl.Samplers   == NULL ||
-        glsl.UniformNames   == NULL || glsl.Uniforms   == NULL)
+        glsl.UniformNames   == NULL || glsl.Uniforms   == NULL ||
+        glsl.UniformBlockNames == NULL || glsl.UniformBlocks == NULL)
     {   // unable to allocate the required memory.
         cgFreeHostMemory(&ctx->HostAllocator, name_buf, name_max, 0, CG_ALLOCATION_TYPE_TEMP);
         glDeleteProgram(program);
@@ -8860,48 +14115,21 @@ cgCreateGraphicsPipeline
     }
     cgGlslReflectProgramMetadata(display, program, name_buf, name_max, false, &glsl);
     cgFreeHostMemory(&ctx->HostAllocator, name_buf, name_max, 0, CG_ALLOCATION_TYPE_TEMP);
+    InterlockedExchangeAdd64(&ctx->KernelCache.Stats.PipelineBuildNanos, LONGLONG(cgElapsedNanos(start)));
+
+    // write the linked program to the cache so the next run can skip linking and reflection.
+    if (cache_key != 0 && cgGlStoreProgram(ctx, display, program, cache_key, &glsl))
+    {
+        InterlockedIncrement64(&ctx->KernelCache.Stats.PipelineStoreCount);
+    }
 
+program_ready:
     // all data has been retrieved, so store the program reference.
     glsl.Program = program;
+    cgGlslBindUniformBlocks(display, &glsl);
 
     // convert the fixed-function state from CGFX enums to their OpenGL equivalents.
-    CG_DEPTH_STENCIL_STATE &dss = pipe.Graphics.DepthStencilState;
-    dss.DepthTestEnable     = cgGlBoolean(create->DepthStencilState.DepthTestEnable);
-    dss.DepthWriteEnable    = cgGlBoolean(create->DepthStencilState.DepthWriteEnable);
-    dss.DepthBoundsEnable   = cgGlBoolean(create->DepthStencilState.DepthBoundsEnable);
-    dss.DepthTestFunction   = cgGlCompareFunction(create->DepthStencilState.DepthTestFunction);
-    dss.DepthMin            = create->DepthStencilState.DepthMin;
-    dss.DepthMax            = create->DepthStencilState.DepthMax;
-    dss.StencilTestEnable   = cgGlBoolean(create->DepthStencilState.StencilTestEnable);
-    dss.StencilTestFunction = cgGlCompareFunction(create->DepthStencilState.StencilTestFunction);
-    dss.StencilFailOp       = cgGlStencilOp(create->DepthStencilState.StencilFailOp);
-    dss.StencilPassZPassOp  = cgGlStencilOp(create->DepthStencilState.StencilPassZPassOp);
-    dss.StencilPassZFailOp  = cgGlStencilOp(create->DepthStencilState.StencilPassZFailOp);
-    dss.StencilReadMask     = create->DepthStencilState.StencilReadMask;
-    dss.StencilWriteMask    = create->DepthStencilState.StencilWriteMask;
-    dss.StencilReference    = create->DepthStencilState.StencilReference;
-
-    CG_RASTER_STATE        &rs = pipe.Graphics.RasterizerState;
-    rs.FillMode             = cgGlFillMode(create->RasterizerState.FillMode);
-    rs.CullMode             = cgGlCullMode(create->RasterizerState.CullMode);
-    rs.FrontFace            = cgGlWindingOrder(create->RasterizerState.FrontFace);
-    rs.DepthBias            = create->RasterizerState.DepthBias;
-    rs.SlopeScaledDepthBias = create->RasterizerState.SlopeScaledDepthBias;
-
-    CG_BLEND_STATE         &bs = pipe.Graphics.BlendState;
-    bs.BlendEnabled         = cgGlBoolean(create->BlendState.BlendEnabled);
-    bs.SrcBlendColor        = cgGlBlendFactor(create->BlendState.SrcBlendColor);
-    bs.DstBlendColor        = cgGlBlendFactor(create->BlendState.DstBlendColor);
-    bs.ColorBlendFunction   = cgGlBlendFunction(create->BlendState.ColorBlendFunction);
-    bs.SrcBlendAlpha        = cgGlBlendFactor(create->BlendState.SrcBlendAlpha);
-    bs.DstBlendAlpha        = cgGlBlendFactor(create->BlendState.DstBlendAlpha);
-    bs.AlphaBlendFunction   = cgGlBlendFunction(create->BlendState.AlphaBlendFunction);
-    bs.ConstantRGBA[0]      = create->BlendState.ConstantRGBA[0];
-    bs.ConstantRGBA[1]      = create->BlendState.ConstantRGBA[1];
-    bs.ConstantRGBA[2]      = create->BlendState.ConstantRGBA[2];
-    bs.ConstantRGBA[3]      = create->BlendState.ConstantRGBA[3];
-
-    pipe.Graphics.Topology  = cgGlPrimitiveTopology(create->PrimitiveType);
+    cgGlPipelineFixedState(create, &pipe.Graphics);
 
     // insert the pipeline into the object table.
     if ((handle = cgObjectTableAdd(&ctx->PipelineTable, pipe)) == CG_INVALID_HANDLE)
@@ -9034,6 +14262,11 @@ cgCreateDataBuffer
         buffer.ExecutionGroup  = exec_group;
         buffer.GraphicsBuffer  = gl_buffer;
         buffer.GraphicsUsage   = gl_flags;
+        buffer.StagingPool     = NULL;
+        buffer.StagingSlice    = 0;
+        buffer.LastUseFrame    = uint64_t(ctx->FrameIndex);
+        buffer.MapCount        = 0;
+        buffer.Evicted         = false;
 
         // set up OpenCL sharing, if requested.
         if (kernel_types & CG_MEMORY_OBJECT_KERNEL_COMPUTE)
@@ -9081,7 +14314,7 @@ cgCreateDataBuffer
             result = CG_OUT_OF_OBJECTS;
             return CG_INVALID_HANDLE;
         }
-        // TODO(rlk): update CG_HEAP::HeapSizeUsed and CG_HEAP::PinnedUsed.
+        buffer.SourceHeap->HeapSizeUsed += buffer.AllocatedSize;
         result = CG_SUCCESS;
         return handle;
     }
@@ -9091,6 +14324,9 @@ cgCreateDataBuffer
         cl_mem       clmem    = NULL;
         cl_int       clres    = CL_SUCCESS;
         uint32_t     access   =(kernel_access & ~CG_MEMORY_ACCESS_PRESERVE);
+        uint32_t     numa     = cgExecutionGroupNumaNode(group);
+        CG_HEAP     *heap     = NULL;
+        void        *hostmem  = NULL;
 
         // convert kernel access flags into cl_mem_flags.
         // because OpenGL is responsible for allocating the buffer, 
@@ -9103,7 +14339,18 @@ cgCreateDataBuffer
             result = CG_INVALID_VALUE;
             return CG_INVALID_HANDLE;
         }
-        if (placement_hint != CG_MEMORY_PLACEMENT_DEVICE)
+        if (numa != CG_NUMA_NODE_ANY && (heap = cgFindHeapForDevice(ctx, group->DeviceList[0])) != NULL)
+        {   // the group executes on a single NUMA node. commit the backing store on that 
+            // node up-front so that first-touch by the host doesn't decide its placement.
+            // the memory is released by cgClFreeNodeLocalMemory when OpenCL is done with it.
+            size_t commit_size = align_up(buffer_size, heap->UserAlignment);
+            hostmem = VirtualAllocExNuma(GetCurrentProcess(), NULL, commit_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, DWORD(numa));
+        }
+        if (hostmem != NULL)
+        {   // wrap the node-local memory; the CPU device uses it in-place.
+            cl_flags |= CL_MEM_USE_HOST_PTR;
+        }
+        else if (placement_hint != CG_MEMORY_PLACEMENT_DEVICE)
         {   // prefer to allocate the buffer in host or pinned memory.
             // there are limitations on buffer size with pinned memory.
             cl_flags |= CL_MEM_ALLOC_HOST_PTR;
@@ -9112,8 +14359,13 @@ cgCreateDataBuffer
         {   // the host promises not to map the memory. attempts to do so will fail.
             cl_flags |= CL_MEM_HOST_NO_ACCESS;
         }
-        if ((clmem = clCreateBuffer(group->ComputeContext, cl_flags, buffer_size, NULL, &clres)) == NULL)
+        if (hostmem == NULL)
+        {   // not node-local, or the node is out of memory; use the default placement.
+            heap = cgFindHeapForPlacement(ctx, placement_hint);
+        }
+        if ((clmem = clCreateBuffer(group->ComputeContext, cl_flags, buffer_size, hostmem, &clres)) == NULL)
         {
+            if (hostmem != NULL) VirtualFree(hostmem, 0, MEM_RELEASE);
             switch (clres)
             {
             case CL_INVALID_CONTEXT              : result = CG_BAD_CLCONTEXT; break;
@@ -9126,13 +14378,20 @@ cgCreateDataBuffer
             }
             return CG_INVALID_HANDLE;
         }
+        if (hostmem != NULL && clSetMemObjectDestructorCallback(clmem, cgClFreeNodeLocalMemory, hostmem) != CL_SUCCESS)
+        {   // without the callback there's no safe point at which to free the memory.
+            clReleaseMemObject(clmem);
+            VirtualFree(hostmem, 0, MEM_RELEASE);
+            result = CG_ERROR;
+            return CG_INVALID_HANDLE;
+        }
 
         CG_BUFFER   buffer;
         buffer.KernelTypes     = kernel_types;
         buffer.KernelAccess    = kernel_access;
         buffer.HostAccess      = host_access;
         buffer.AttachedDisplay = NULL;
-        buffer.SourceHeap      = cgFindHeapForPlacement(ctx, placement_hint);
+        buffer.SourceHeap      = heap;
         buffer.ComputeContext  = group->ComputeContext;
         buffer.ComputeBuffer   = clmem;
         buffer.ComputeUsage    = cl_flags;
@@ -9141,6 +14400,11 @@ cgCreateDataBuffer
         buffer.ExecutionGroup  = exec_group;
         buffer.GraphicsBuffer  = 0;
         buffer.GraphicsUsage   = 0;
+        buffer.StagingPool     = NULL;
+        buffer.StagingSlice    = 0;
+        buffer.LastUseFrame    = uint64_t(ctx->FrameIndex);
+        buffer.MapCount        = 0;
+        buffer.Evicted         = false;
 
         cg_handle_t handle     = cgObjectTableAdd(&ctx->BufferTable, buffer);
         if (handle == CG_INVALID_HANDLE)
@@ -9149,7 +14413,14 @@ cgCreateDataBuffer
             result = CG_OUT_OF_OBJECTS;
             return CG_INVALID_HANDLE;
         }
-        // TODO(rlk): update CG_HEAP::HeapSizeUsed and CG_HEAP::PinnedUsed.
+        if ((cl_flags & CL_MEM_ALLOC_HOST_PTR) && (buffer.SourceHeap->Flags & CG_HEAP_HOLDS_PINNED))
+        {   // the buffer was allocated from pinnable memory.
+            cgHeapAddPinnable(buffer.SourceHeap, buffer.AllocatedSize);
+        }
+        else
+        {   // the buffer was allocated from device-resident heap memory.
+            buffer.SourceHeap->HeapSizeUsed += buffer.AllocatedSize;
+        }
         result = CG_SUCCESS;
         return handle;
     }
@@ -9300,6 +14571,15 @@ cgMapDataBuffer
             return NULL;
         }
 
+        // count the mapping, so that the buffer is neither evicted nor restored, which would replace its 
+        // cl_mem, until it is unmapped. an eviction already in progress finishes first.
+        AcquireSRWLockShared(&ctx->ResidencyLock);
+        AcquireSRWLockExclusive(&ctx->RestoreLock);
+        InterlockedIncrement(&obj->MapCount);
+        obj->LastUseFrame = uint64_t(ctx->FrameIndex);
+        ReleaseSRWLockExclusive(&ctx->RestoreLock);
+        ReleaseSRWLockShared(&ctx->ResidencyLock);
+
         if (flags & CG_MEMORY_ACCESS_READ)
             map_flags |= CL_MAP_READ;
         if (flags & CG_MEMORY_ACCESS_WRITE)
@@ -9328,6 +14608,7 @@ cgMapDataBuffer
                 {   // release any temporary event object.
                     clReleaseEvent(wait_event);
                 }
+                InterlockedDecrement(&obj->MapCount);
                 return NULL;
             }
             // the acquire request was enqueued successfully. overwrite the wait_event 
@@ -9363,6 +14644,7 @@ cgMapDataBuffer
             {   // release any temporary event object.
                 clReleaseEvent(wait_event);
             }
+            InterlockedDecrement(&obj->MapCount);
             return NULL;
         }
         if (release_ev)
@@ -9433,6 +14715,9 @@ cgUnmapDataBuffer
             return cgSetupNewCompleteEvent(ctx, queue, event_handle, NULL, NULL, result);
         }
 
+        // the mapping has been released, so the object may be evicted or restored again.
+        InterlockedDecrement(&obj->MapCount);
+
         // set the compute event handle to the unmap completion event.
         event = evt_unmap;
 
@@ -9475,6 +14760,186 @@ cgUnmapDataBuffer
     }
 }
 
+/// @summary Sub-allocate a transient data buffer from the pinned staging pool of a heap. The returned buffer can be used as the source or 
+/// target of any cgCopyBuffer* or image upload command, and remains mapped into the host address space for its entire lifetime.
+/// The buffer must be returned with cgReleaseStagingBuffer; cgDeleteObject rejects it with CG_INVALID_STATE.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param exec_group The handle of the execution group that owns the staging pool. The staging pool must have been enabled by specifying a non-zero cg_execution_group_t::StagingArenaSize.
+/// @param heap_ordinal The ordinal of the heap to stage through, or CG_IDEAL_HEAP to use the first heap in the execution group with a staging pool.
+/// @param buffer_size The desired size of the staging buffer, in bytes.
+/// @param host_address On return, stores the host-visible address of the start of the staging buffer.
+/// @param result On return, set to CG_SUCCESS, CG_NOT_READY, CG_UNSUPPORTED, CG_INVALID_VALUE, CG_OUT_OF_MEMORY, CG_OUT_OF_OBJECTS or CG_ERROR. If CG_NOT_READY is returned, the pool is full of in-flight transfers; retry after they complete.
+/// @return A handle to the staging buffer object, or CG_INVALID_HANDLE.
+library_function cg_handle_t
+cgAcquireStagingBuffer
+(
+    uintptr_t    context,
+    cg_handle_t  exec_group,
+    size_t       heap_ordinal,
+    size_t       buffer_size,
+    void       **host_address,
+    int         &result
+)
+{
+    CG_CONTEXT      *ctx   = (CG_CONTEXT*) context;
+    CG_EXEC_GROUP   *group =  cgObjectTableGet(&ctx->ExecGroupTable, exec_group);
+    CG_HEAP         *heap  =  NULL;
+    CG_STAGING_POOL *pool  =  NULL;
+    size_t           index =  0;
+    size_t           offset=  0;
+
+    if (host_address != NULL)
+       *host_address  = NULL;
+    if (group == NULL || host_address == NULL || buffer_size == 0)
+    {   // invalid execution group handle or output parameter.
+        result = CG_INVALID_VALUE;
+        return CG_INVALID_HANDLE;
+    }
+    if (heap_ordinal == CG_IDEAL_HEAP)
+    {   // use the first heap with a staging pool owned by the execution group.
+        for (size_t i = 0, n = ctx->HeapCount; i < n; ++i)
+        {
+            if (cgFindStagingPool(&ctx->HeapList[i], group->ComputeContext) != NULL)
+            {
+                heap = &ctx->HeapList[i];
+                break;
+            }
+        }
+    }
+    else if (heap_ordinal < ctx->HeapCount)
+    {   // use the specific heap requested by the caller.
+        heap = &ctx->HeapList[heap_ordinal];
+    }
+    else
+    {   // the heap ordinal is not valid.
+        result = CG_INVALID_VALUE;
+        return CG_INVALID_HANDLE;
+    }
+    if (heap == NULL || (pool = cgFindStagingPool(heap, group->ComputeContext)) == NULL)
+    {   // the execution group has no staging pool for the heap.
+        result = CG_UNSUPPORTED;
+        return CG_INVALID_HANDLE;
+    }
+    if ((result = cgStagingPoolAllocate(pool, buffer_size, offset, index)) != CG_SUCCESS)
+    {   // result has been set to the reason for the failure.
+        return CG_INVALID_HANDLE;
+    }
+
+    cl_buffer_region region;
+    cl_mem           clmem = NULL;
+    cl_int           clres = CL_SUCCESS;
+    region.origin = offset;
+    region.size   = buffer_size;
+    if ((clmem = clCreateSubBuffer(pool->ArenaBuffer, CL_MEM_READ_WRITE, CL_BUFFER_CREATE_TYPE_REGION, &region, &clres)) == NULL)
+    {
+        switch (clres)
+        {
+        case CL_INVALID_VALUE                : result = CG_INVALID_VALUE; break;
+        case CL_INVALID_BUFFER_SIZE          : result = CG_INVALID_VALUE; break;
+        case CL_MISALIGNED_SUB_BUFFER_OFFSET : result = CG_INVALID_VALUE; break;
+        case CL_MEM_OBJECT_ALLOCATION_FAILURE: result = CG_OUT_OF_MEMORY; break;
+        case CL_OUT_OF_RESOURCES             : result = CG_OUT_OF_MEMORY; break;
+        case CL_OUT_OF_HOST_MEMORY           : result = CG_OUT_OF_MEMORY; break;
+        default                              : result = CG_ERROR;         break;
+        }
+        cgStagingPoolRelease(ctx, pool, index);
+        return CG_INVALID_HANDLE;
+    }
+
+    CG_BUFFER   buffer;
+    buffer.KernelTypes     = CG_MEMORY_OBJECT_KERNEL_COMPUTE;
+    buffer.KernelAccess    = CG_MEMORY_ACCESS_READ_WRITE;
+    buffer.HostAccess      = CG_MEMORY_ACCESS_READ_WRITE;
+    buffer.AttachedDisplay = NULL;
+    buffer.SourceHeap      = heap;
+    buffer.ComputeContext  = pool->ComputeContext;
+    buffer.ComputeBuffer   = clmem;
+    buffer.ComputeUsage    = CL_MEM_READ_WRITE;
+    buffer.AllocatedSize   = align_up(buffer_size, pool->Alignment);
+    buffer.RequestedSize   = buffer_size;
+    buffer.ExecutionGroup  = exec_group;
+    buffer.GraphicsBuffer  = 0;
+    buffer.GraphicsUsage   = 0;
+    buffer.StagingPool     = pool;
+    buffer.StagingSlice    = index;
+    buffer.LastUseFrame    = uint64_t(ctx->FrameIndex);
+    buffer.MapCount        = 0;
+    buffer.Evicted         = false;
+
+    cg_handle_t handle     = cgObjectTableAdd(&ctx->BufferTable, buffer);
+    if (handle == CG_INVALID_HANDLE)
+    {
+        clReleaseMemObject(clmem);
+        cgStagingPoolRelease(ctx, pool, index);
+        result = CG_OUT_OF_OBJECTS;
+        return CG_INVALID_HANDLE;
+    }
+   *host_address = pool->HostAddress + offset;
+    result = CG_SUCCESS;
+    return handle;
+}
+
+/// @summary Return a staging buffer to its pool and invalidate the buffer handle. The underlying memory is recycled once the device has signaled @a retire_handle.
+/// Call this function after the command buffer referencing the staging buffer has been submitted, so that the retirement event refers to the final transfer.
+/// @param context A CGFX context returned by cgEnumerateDevices.
+/// @param buffer_handle The handle of the staging buffer returned by cgAcquireStagingBuffer.
+/// @param retire_handle The handle of an event or compute/transfer fence signaled when the device is done accessing the buffer, or CG_INVALID_HANDLE if the device is not accessing the buffer.
+/// @return CG_SUCCESS, CG_INVALID_VALUE or CG_INVALID_STATE.
+library_function int
+cgReleaseStagingBuffer
+(
+    uintptr_t   context,
+    cg_handle_t buffer_handle,
+    cg_handle_t retire_handle
+)
+{
+    CG_CONTEXT *ctx    = (CG_CONTEXT*) context;
+    CG_BUFFER  *obj    =  cgObjectTableGet(&ctx->BufferTable, buffer_handle);
+    cl_event    retire =  NULL;
+    if (obj == NULL || obj->StagingPool == NULL)
+    {   // the handle does not refer to a staging buffer.
+        return CG_INVALID_VALUE;
+    }
+    if (retire_handle != CG_INVALID_HANDLE)
+    {   // resolve the event or fence to an OpenCL event object.
+        switch (cgGetObjectType(retire_handle))
+        {
+        case CG_OBJECT_EVENT:
+            {
+                CG_EVENT *event = cgObjectTableGet(&ctx->EventTable, retire_handle);
+                if (event == NULL)
+                    return CG_INVALID_VALUE;
+                retire = event->ComputeEvent;
+            }
+            break;
+        case CG_OBJECT_FENCE:
+            {
+                CG_FENCE *fence = cgObjectTableGet(&ctx->FenceTable, retire_handle);
+                if (fence == NULL || fence->QueueType == CG_QUEUE_TYPE_GRAPHICS)
+                    return CG_INVALID_VALUE;
+                retire = fence->ComputeFence;
+            }
+            break;
+        default:
+            return CG_INVALID_VALUE;
+        }
+        if (retire == NULL)
+        {   // the event or fence has not yet been submitted to a command queue.
+            return CG_INVALID_STATE;
+        }
+        // the event object may be re-used by subsequent commands, so hold a reference.
+        clRetainEvent(retire);
+    }
+
+    CG_BUFFER buffer;
+    AcquireSRWLockExclusive(&obj->StagingPool->Lock);
+    obj->StagingPool->Slices[obj->StagingSlice].RetireEvent = retire;
+    ReleaseSRWLockExclusive(&obj->StagingPool->Lock);
+    cgObjectTableRemove(&ctx->BufferTable, buffer_handle, buffer);
+    cgDeleteBuffer(ctx, &buffer);
+    return CG_SUCCESS;
+}
+
 /// @summary Creates a new image object and allocates, but does not initialize, the backing memory.
 /// @param context A CGFX context returned by cgEnumerateDevices.
 /// @param exec_group The execution group that will read or write the image.
@@ -9597,7 +15062,7 @@ cgCreateImage
 
         // bind the texture to the default target, and allocate storage.
         // the texture is always allocated in device memory for OpenGL.
-        glBindTexture(default_target, texture);
+        cgGlBindTexture(display, 0, default_target, texture);
         if (level_count > 1)
         {   // default filtering with mipmaps.
             cgGlTextureStorage(
@@ -9614,7 +15079,7 @@ cgCreateImage
                 GL_LINEAR , /* magnification filter */
                 padded_width, padded_height, nslices, level_count);
         }
-        glBindTexture(default_target, 0);
+        cgGlBindTexture(display, 0, default_target, 0);
 
         // populate the image description with OpenGL data.
         // OpenGL textures are always allocated in device memory.
@@ -9643,6 +15108,10 @@ cgCreateImage
         image.BaseFormat       = base_format;
         image.DataType         = data_type;
         image.DxgiFormat       = pixel_format;
+        image.AllocatedSize    = cgCalculateImageAllocatedSize(&image);
+        image.LastUseFrame     = uint64_t(ctx->FrameIndex);
+        image.MapCount         = 0;
+        image.Evicted          = false;
 
         // set up OpenCL sharing, if requested.
         if (kernel_types & CG_MEMORY_OBJECT_KERNEL_COMPUTE)
@@ -9692,7 +15161,7 @@ cgCreateImage
             result = CG_OUT_OF_OBJECTS;
             return CG_INVALID_HANDLE;
         }
-        // TODO(rlk): update CG_HEAP::HeapSizeUsed.
+        image.SourceHeap->HeapSizeUsed += image.AllocatedSize;
         result = CG_SUCCESS;
         return handle;
     }
@@ -9761,6 +15230,10 @@ cgCreateImage
         image.BaseFormat       = base_format;
         image.DataType         = data_type;
         image.DxgiFormat       = pixel_format;
+        image.AllocatedSize    = cgCalculateImageAllocatedSize(&image);
+        image.LastUseFrame     = uint64_t(ctx->FrameIndex);
+        image.MapCount         = 0;
+        image.Evicted          = false;
 
         cg_handle_t handle     = cgObjectTableAdd(&ctx->ImageTable, image);
         if (handle == CG_INVALID_HANDLE)
@@ -9769,7 +15242,14 @@ cgCreateImage
             result = CG_OUT_OF_OBJECTS;
             return CG_INVALID_HANDLE;
         }
-        // TODO(rlk): update CG_HEAP::HeapSizeUsed.
+        if ((cl_flags & CL_MEM_ALLOC_HOST_PTR) && (image.SourceHeap->Flags & CG_HEAP_HOLDS_PINNED))
+        {   // the image was allocated from pinnable memory.
+            cgHeapAddPinnable(image.SourceHeap, image.AllocatedSize);
+        }
+        else
+        {   // the image was allocated from device-resident heap memory.
+            image.SourceHeap->HeapSizeUsed += image.AllocatedSize;
+        }
         result = CG_SUCCESS;
         return handle;
     }
@@ -9961,6 +15441,15 @@ cgMapImageRegion
             return NULL;
         }
 
+        // count the mapping, so that the image is neither evicted nor restored, which would replace its 
+        // cl_mem, until it is unmapped. an eviction already in progress finishes first.
+        AcquireSRWLockShared(&ctx->ResidencyLock);
+        AcquireSRWLockExclusive(&ctx->RestoreLock);
+        InterlockedIncrement(&obj->MapCount);
+        obj->LastUseFrame = uint64_t(ctx->FrameIndex);
+        ReleaseSRWLockExclusive(&ctx->RestoreLock);
+        ReleaseSRWLockShared(&ctx->ResidencyLock);
+
         if (flags & CG_MEMORY_ACCESS_READ)
             map_flags |= CL_MAP_READ;
         if (flags & CG_MEMORY_ACCESS_WRITE)
@@ -10009,6 +15498,7 @@ cgMapImageRegion
                 {   // release any temporary event object.
                     clReleaseEvent(wait_event);
                 }
+                InterlockedDecrement(&obj->MapCount);
                 return NULL;
             }
             // the acquire request was enqueued successfully. overwrite the wait_event 
@@ -10044,6 +15534,7 @@ cgMapImageRegion
             {   // release any temporary event object.
                 clReleaseEvent(wait_event);
             }
+            InterlockedDecrement(&obj->MapCount);
             return NULL;
         }
         if (release_ev)
@@ -10114,6 +15605,9 @@ cgUnmapImageRegion
             return cgSetupNewCompleteEvent(ctx, queue, event_handle, NULL, NULL, result);
         }
 
+        // the mapping has been released, so the object may be evicted or restored again.
+        InterlockedDecrement(&obj->MapCount);
+
         // set the compute event handle to the unmap completion event.
         event = evt_unmap;
 
@@ -10755,19 +16249,49 @@ cgExecuteCommandBuffer
         return CG_INVALID_STATE;
     }
 
+    // each submission starts a new residency frame. memory objects
+    // referenced by the submitted commands are stamped with this value.
+    // several threads may submit concurrently, so the increment is atomic.
+    InterlockedIncrement64(&ctx->FrameIndex);
+
+    // capture the number of allocations made since the previous submission.
+    for (size_t i = 0; i < CG_MAX_ALLOCATION_TYPES; ++i)
+    {
+        CG_ALLOCATION_COUNTERS *c = &ctx->AllocationStats[i];
+        LONGLONG            count = c->AllocationCount;
+        c->FrameAllocations = count - c->FrameBase;
+        c->FrameBase        = count;
+    }
+
     // submit commands to the associated command queues.
+    // scratch memory used by command executors is reclaimed in bulk on return.
+    size_t scratch = cgScratchScopeBegin(&ctx->HostAllocator);
+    int    result  = CG_UNSUPPORTED;
+    // executors swap the cl_mem of evicted objects they restore, so eviction 
+    // must not run on another thread while the command buffer is executing.
+    AcquireSRWLockShared(&ctx->ResidencyLock);
     switch (queue_type)
     {
     case CG_QUEUE_TYPE_COMPUTE:
-        return cgExecuteComputeCommandBuffer (ctx, fifo, cmdbuf);
+        result = cgExecuteComputeCommandBuffer (ctx, fifo, cmdbuf);
+        break;
     case CG_QUEUE_TYPE_GRAPHICS:
-        return cgExecuteGraphicsCommandBuffer(ctx, fifo, cmdbuf);
+        result = cgExecuteGraphicsCommandBuffer(ctx, fifo, cmdbuf);
+        break;
     case CG_QUEUE_TYPE_TRANSFER:
-        return cgExecuteTransferCommandBuffer(ctx, fifo, cmdbuf);
+        result = cgExecuteTransferCommandBuffer(ctx, fifo, cmdbuf);
+        break;
     default:
         break;
     }
-    return CG_UNSUPPORTED;
+    ReleaseSRWLockShared(&ctx->ResidencyLock);
+
+    // evict least-recently-used objects from any heap over its budget.
+    // eviction failures are not fatal; the objects remain resident.
+    if (result != CG_UNSUPPORTED)
+        cgEnforceResidencyBudget(ctx);
+    cgScratchScopeEnd(&ctx->HostAllocator, scratch);
+    return result;
 }
 
 /// @summary Initialize a blend state descriptor such that alpha blending is disabled.
@@ -11216,6 +16740,223 @@ cgImageSlicePitch
            cgImageDimension(format, pixel_height);
 }
 
+/// @summary Generate the mipmap levels of a 2D image, image array or cubemap stored in host memory, using a 2x2 box filter. 
+/// The image data uses the DDS layout: each array item (or cube face) stores every level in turn, and each level is tightly 
+/// packed using the row and slice pitch returned by cgImageRowPitch and cgImageSlicePitch. Level 0 of each item is read, and 
+/// levels 1 through @a level_count-1 are overwritten. For odd source dimensions, the last row or column is not sampled. 
+/// Kernels are selected at runtime for SSE2, AVX2 and NEON; each level is split into bands of rows, and the bands of all 
+/// items are processed in parallel on the system thread pool.
+/// @param image_data The image data, with level 0 of each item already populated.
+/// @param data_size The number of bytes of image data.
+/// @param format One of dxgi_format_e or DXGI_FORMAT. Must be R8G8B8A8_UNORM[_SRGB], B8G8R8A8_UNORM[_SRGB], R16G16B16A16_FLOAT or R32_FLOAT.
+/// @param width The width of level 0, in pixels.
+/// @param height The height of level 0, in pixels.
+/// @param item_count The number of array items. For cubemaps, this is six times the number of cubes.
+/// @param level_count The number of levels in each item, including level 0.
+/// @param thread_count The maximum number of threads to use, including the calling thread, or 0 to use every logical processor.
+/// @param flags A combination of cg_host_mipmap_flags_e.
+/// @return CG_SUCCESS, CG_INVALID_VALUE or CG_UNSUPPORTED.
+library_function int
+cgGenerateHostMipmaps
+(
+    void     *image_data,
+    size_t    data_size,
+    uint32_t  format,
+    size_t    width,
+    size_t    height,
+    size_t    item_count,
+    size_t    level_count,
+    size_t    thread_count,
+    uint32_t  flags
+)
+{
+    CG_HOST_MIPMAP_JOB job;
+    cgHostMipRow_fn    row_func   = NULL;
+    PTP_WORK           work       = NULL;
+    size_t             max_levels = 1;
+    size_t             item_pitch = 0;
+    size_t             src_offset = 0;
+
+    if (image_data == NULL || width == 0 || height == 0 || item_count == 0 || level_count == 0)
+        return CG_INVALID_VALUE;
+    while ((width >> max_levels) > 0 || (height >> max_levels) > 0)
+        max_levels++;
+    if (level_count > max_levels)
+        return CG_INVALID_VALUE;
+    if ((row_func = cgHostMipmapSelectRowFunc(format, flags)) == NULL)
+        return CG_UNSUPPORTED;
+    for (size_t i = 0; i < level_count; ++i)
+    {
+        item_pitch += cgImageSlicePitch(format, cgImageLevelDimension(format, width, i), cgImageLevelDimension(format, height, i));
+    }
+    if (item_pitch * item_count > data_size)
+        return CG_INVALID_VALUE;
+    if (thread_count == 0)
+    {
+        SYSTEM_INFO sysinfo;
+        GetNativeSystemInfo(&sysinfo);
+        thread_count = size_t(sysinfo.dwNumberOfProcessors);
+    }
+    InitOnceExecuteOnce(&Global_HostMipmapTablesInit, cgHostMipmapInitTables, NULL, NULL);
+    if (thread_count > 1)
+    {   // if the work object cannot be created, all levels are generated on the calling thread.
+        work = CreateThreadpoolWork(cgHostMipmapWorker, &job, NULL);
+    }
+
+    job.RowFunc   = row_func;
+    job.ImageData = (uint8_t*) image_data;
+    job.ItemPitch = item_pitch;
+    for (size_t level = 1; level < level_count; ++level)
+    {
+        size_t src_w = cgImageLevelDimension(format, width , level - 1);
+        size_t src_h = cgImageLevelDimension(format, height, level - 1);
+        size_t dst_w = cgImageLevelDimension(format, width , level);
+        size_t dst_h = cgImageLevelDimension(format, height, level);
+        size_t nrows = dst_h * item_count;
+        size_t nthrd =(work != NULL && dst_w * nrows >= CG_HOST_MIPMAP_MIN_PARALLEL_PIXELS) ? thread_count : 1;
+        size_t bands = nthrd * CG_HOST_MIPMAP_TASKS_PER_THREAD;
+        size_t rpt   =(nrows + bands - 1) / bands;
+
+        job.SrcOffset    = src_offset;
+        job.DstOffset    = src_offset + cgImageSlicePitch(format, src_w, src_h);
+        job.SrcWidth     = src_w;
+        job.SrcHeight    = src_h;
+        job.SrcRowPitch  = cgImageRowPitch(format, src_w);
+        job.DstWidth     = dst_w;
+        job.DstHeight    = dst_h;
+        job.DstRowPitch  = cgImageRowPitch(format, dst_w);
+        job.RowsPerTask  = rpt < dst_h ? rpt : dst_h;
+        job.TasksPerItem =(dst_h + job.RowsPerTask - 1) / job.RowsPerTask;
+        job.TaskCount    = LONG(job.TasksPerItem * item_count);
+        job.NextTask     = 0;
+        for (size_t i = 1; i < nthrd; ++i)
+        {
+            SubmitThreadpoolWork(work);
+        }
+        cgHostMipmapRunTasks(&job);
+        if (nthrd > 1)
+        {   // the next level reads the rows written by the workers.
+            WaitForThreadpoolWorkCallbacks(work, FALSE);
+        }
+        src_offset = job.DstOffset;
+    }
+    if (work != NULL)
+    {
+        CloseThreadpoolWork(work);
+    }
+    return CG_SUCCESS;
+}
+
+/// @summary Encode an R8G8B8A8 image stored in host memory into a block-compressed format, for example directly into an 
+/// image region returned by cgMapImageRegion. BC1 stores RGB with punch-through alpha (alpha below 128 is transparent), 
+/// BC3 stores RGBA, BC4 stores R, BC5 stores R and G, and BC7 stores RGBA using mode 6. Endpoints are taken from the 
+/// principal axis of each block, then refined by least squares and, at the highest quality, by an exhaustive neighborhood 
+/// search. Palette matching uses SSE2 where available, and bands of block rows are encoded in parallel on the system thread pool.
+/// @param dst The first block of the destination image.
+/// @param dst_size The number of bytes available at @a dst.
+/// @param dst_row_pitch The number of bytes between rows of blocks in the destination, or 0 to use cgImageRowPitch.
+/// @param dst_format One of BC1_UNORM[_SRGB], BC3_UNORM[_SRGB], BC4_UNORM, BC5_UNORM or BC7_UNORM[_SRGB]. sRGB data is encoded as stored.
+/// @param src The first pixel of the R8G8B8A8 source image.
+/// @param src_row_pitch The number of bytes per-row in the source image, or 0 if rows are tightly packed.
+/// @param width The width of the image, in pixels.
+/// @param height The height of the image, in pixels.
+/// @param quality One of cg_block_compression_quality_e.
+/// @param thread_count The maximum number of threads to use, including the calling thread, or 0 to use every logical processor.
+/// @param squared_error If non-NULL, on return stores the sum of squared errors of the decoded image over the channels stored by the format.
+/// @return CG_SUCCESS, CG_INVALID_VALUE or CG_UNSUPPORTED.
+library_function int
+cgCompressHostImage
+(
+    void       *dst,
+    size_t      dst_size,
+    size_t      dst_row_pitch,
+    uint32_t    dst_format,
+    void const *src,
+    size_t      src_row_pitch,
+    size_t      width,
+    size_t      height,
+    int         quality,
+    size_t      thread_count,
+    uint64_t   *squared_error
+)
+{
+    CG_HOST_BC_JOB job;
+    PTP_WORK       work     = NULL;
+    size_t         blocks_x =(width  + 3) / 4;
+    size_t         blocks_y =(height + 3) / 4;
+    size_t         nthrd    = 1;
+
+    if (dst == NULL || src == NULL || width == 0 || height == 0)
+        return CG_INVALID_VALUE;
+    if (quality < CG_BLOCK_COMPRESSION_QUALITY_FAST || quality > CG_BLOCK_COMPRESSION_QUALITY_HIGH)
+        return CG_INVALID_VALUE;
+    switch (dst_format)
+    {
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC4_UNORM:
+    case DXGI_FORMAT_BC5_UNORM:
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        break;
+    default:
+        return CG_UNSUPPORTED;
+    }
+    if (dst_row_pitch == 0)
+        dst_row_pitch = cgImageRowPitch(dst_format, width);
+    if (src_row_pitch == 0)
+        src_row_pitch = width * 4;
+    if (dst_row_pitch < cgImageRowPitch(dst_format, width) || src_row_pitch < width * 4)
+        return CG_INVALID_VALUE;
+    if (dst_row_pitch * (blocks_y - 1) + cgImageRowPitch(dst_format, width) > dst_size)
+        return CG_INVALID_VALUE;
+    if (thread_count == 0)
+    {
+        SYSTEM_INFO sysinfo;
+        GetNativeSystemInfo(&sysinfo);
+        thread_count = size_t(sysinfo.dwNumberOfProcessors);
+    }
+    if (thread_count > 1 && blocks_x * blocks_y >= CG_HOST_BC_MIN_PARALLEL_BLOCKS)
+    {   // if the work object cannot be created, the image is encoded on the calling thread.
+        if ((work = CreateThreadpoolWork(cgHostCompressWorker, &job, NULL)) != NULL)
+            nthrd = thread_count;
+    }
+
+    size_t bands      = nthrd * CG_HOST_BC_TASKS_PER_THREAD;
+    size_t rpt        =(blocks_y + bands - 1) / bands;
+    job.Dst           = (uint8_t*) dst;
+    job.DstRowPitch   = dst_row_pitch;
+    job.Src           = (uint8_t const*) src;
+    job.SrcRowPitch   = src_row_pitch;
+    job.Width         = width;
+    job.Height        = height;
+    job.BlocksX       = blocks_x;
+    job.BlocksY       = blocks_y;
+    job.RowsPerTask   = rpt;
+    job.Format        = dst_format;
+    job.Quality       = quality;
+    job.TaskCount     = LONG((blocks_y + rpt - 1) / rpt);
+    job.NextTask      = 0;
+    job.SquaredError  = 0;
+    for (size_t i = 1; i < nthrd; ++i)
+    {
+        SubmitThreadpoolWork(work);
+    }
+    cgHostCompressRunTasks(&job);
+    if (work != NULL)
+    {
+        WaitForThreadpoolWorkCallbacks(work, FALSE);
+        CloseThreadpoolWork(work);
+    }
+    if (squared_error != NULL)
+    {
+        *squared_error = uint64_t(job.SquaredError);
+    }
+    return CG_SUCCESS;
+}
+
 /// @summary Determines if a DDS describes a cubemap surface.
 /// @param header The base surface header of the DDS.
 /// @param header_ex The extended surface header of the DDS, or NULL.
@@ -29,6 +29,13 @@
 /*///////////////////
 //   Local Types   //
 ///////////////////*/
+/// @summary Describes a memory object that may be evicted from a heap to bring the heap back under its residency budget.
+struct CG_RESIDENCY_CANDIDATE
+{
+    uint64_t                     LastUseFrame;         /// The frame index at which the object was last referenced.
+    CG_BUFFER                   *Buffer;               /// The buffer object to evict, or NULL.
+    CG_IMAGE                    *Image;                /// The image object to evict, or NULL.
+};
 
 /*///////////////
 //   Globals   //
@@ -94,6 +101,531 @@ cgReleaseWaitList
     return result;
 }
 
+/// @summary Convert an OpenCL result code returned while creating or copying a memory object into a CGFX result code.
+/// @param clres The OpenCL result code.
+/// @return The corresponding CGFX result code.
+internal_function int
+cgClMemoryResultCode
+(
+    cl_int clres
+)
+{
+    switch (clres)
+    {
+    case CL_SUCCESS                         : return CG_SUCCESS;
+    case CL_INVALID_CONTEXT                 : return CG_BAD_CLCONTEXT;
+    case CL_INVALID_COMMAND_QUEUE           : return CG_BAD_CLCONTEXT;
+    case CL_INVALID_MEM_OBJECT              : return CG_BAD_CLCONTEXT;
+    case CL_INVALID_VALUE                   : return CG_INVALID_VALUE;
+    case CL_INVALID_BUFFER_SIZE             : return CG_INVALID_VALUE;
+    case CL_INVALID_IMAGE_SIZE              : return CG_INVALID_VALUE;
+    case CL_INVALID_IMAGE_DESCRIPTOR        : return CG_INVALID_VALUE;
+    case CL_INVALID_IMAGE_FORMAT_DESCRIPTOR : return CG_INVALID_VALUE;
+    case CL_IMAGE_FORMAT_NOT_SUPPORTED      : return CG_UNSUPPORTED;
+    case CL_MEM_OBJECT_ALLOCATION_FAILURE   : return CG_OUT_OF_MEMORY;
+    case CL_OUT_OF_RESOURCES                : return CG_OUT_OF_MEMORY;
+    case CL_OUT_OF_HOST_MEMORY              : return CG_OUT_OF_MEMORY;
+    default                                 : return CG_ERROR;
+    }
+}
+
+/// @summary Create a new OpenCL buffer object and enqueue a copy of the contents of an existing buffer into it. The function does not wait for the copy.
+/// @param cl_ctx The OpenCL context in which the source buffer was allocated.
+/// @param cl_queue The OpenCL command queue used to perform the copy.
+/// @param src The source buffer object.
+/// @param flags The cl_mem_flags used to create the new buffer object.
+/// @param wait_count The number of events in @a wait_list.
+/// @param wait_list The events that must complete before the copy starts, or NULL.
+/// @param dst On return, stores the new buffer object, or NULL.
+/// @param done On return, stores the event signaled when the copy completes, or NULL. The caller must release the event.
+/// @return CG_SUCCESS or another result code.
+internal_function int
+cgClCloneBuffer
+(
+    cl_context        cl_ctx, 
+    cl_command_queue  cl_queue, 
+    cl_mem            src, 
+    cl_mem_flags      flags, 
+    cl_uint           wait_count, 
+    cl_event const   *wait_list, 
+    cl_mem           &dst, 
+    cl_event         &done
+)
+{
+    cl_int   clres  = CL_SUCCESS;
+    size_t   nbytes = 0;
+
+    dst  = NULL;
+    done = NULL;
+    if ((clres = clGetMemObjectInfo(src, CL_MEM_SIZE, sizeof(size_t), &nbytes, NULL)) != CL_SUCCESS)
+    {   // the source memory object is invalid.
+        return cgClMemoryResultCode(clres);
+    }
+    if ((dst = clCreateBuffer(cl_ctx, flags, nbytes, NULL, &clres)) == NULL)
+    {   // the new buffer could not be allocated.
+        return cgClMemoryResultCode(clres);
+    }
+    if ((clres = clEnqueueCopyBuffer(cl_queue, src, dst, 0, 0, nbytes, wait_count, CG_OPENCL_WAIT_LIST(wait_count, wait_list), &done)) != CL_SUCCESS)
+    {   // the copy command could not be enqueued.
+        clReleaseMemObject(dst); dst = NULL; done = NULL;
+        return cgClMemoryResultCode(clres);
+    }
+    return CG_SUCCESS;
+}
+
+/// @summary Create a new OpenCL image object with the same format and dimensions as an existing image, and enqueue a copy of the contents of the existing image into it. The function does not wait for the copy.
+/// @param cl_ctx The OpenCL context in which the source image was allocated.
+/// @param cl_queue The OpenCL command queue used to perform the copy.
+/// @param src The source image object.
+/// @param flags The cl_mem_flags used to create the new image object.
+/// @param wait_count The number of events in @a wait_list.
+/// @param wait_list The events that must complete before the copy starts, or NULL.
+/// @param dst On return, stores the new image object, or NULL.
+/// @param done On return, stores the event signaled when the copy completes, or NULL. The caller must release the event.
+/// @return CG_SUCCESS or another result code.
+internal_function int
+cgClCloneImage
+(
+    cl_context        cl_ctx, 
+    cl_command_queue  cl_queue, 
+    cl_mem            src, 
+    cl_mem_flags      flags, 
+    cl_uint           wait_count, 
+    cl_event const   *wait_list, 
+    cl_mem           &dst, 
+    cl_event         &done
+)
+{
+    cl_image_format    cl_format;
+    cl_image_desc      cl_desc;
+    cl_mem_object_type cl_type = 0;
+    cl_int             clres   = CL_SUCCESS;
+    size_t             origin[3] = {0, 0, 0};
+    size_t             region[3] = {1, 1, 1};
+
+    dst  = NULL;
+    done = NULL;
+    memset(&cl_format, 0, sizeof(cl_image_format));
+    memset(&cl_desc  , 0, sizeof(cl_image_desc));
+    if ((clres = clGetMemObjectInfo(src, CL_MEM_TYPE, sizeof(cl_mem_object_type), &cl_type, NULL)) != CL_SUCCESS)
+    {   // the source memory object is invalid.
+        return cgClMemoryResultCode(clres);
+    }
+    clGetImageInfo(src, CL_IMAGE_FORMAT    , sizeof(cl_image_format), &cl_format, NULL);
+    clGetImageInfo(src, CL_IMAGE_WIDTH     , sizeof(size_t), &cl_desc.image_width     , NULL);
+    clGetImageInfo(src, CL_IMAGE_HEIGHT    , sizeof(size_t), &cl_desc.image_height    , NULL);
+    clGetImageInfo(src, CL_IMAGE_DEPTH     , sizeof(size_t), &cl_desc.image_depth     , NULL);
+    clGetImageInfo(src, CL_IMAGE_ARRAY_SIZE, sizeof(size_t), &cl_desc.image_array_size, NULL);
+    cl_desc.image_type = cl_type;
+
+    // the copy region is specified in pixels, rows and slices or array items.
+    region[0] = cl_desc.image_width;
+    switch (cl_type)
+    {
+    case CL_MEM_OBJECT_IMAGE1D_ARRAY:
+        region[1] = cl_desc.image_array_size;
+        break;
+    case CL_MEM_OBJECT_IMAGE2D:
+        region[1] = cl_desc.image_height;
+        break;
+    case CL_MEM_OBJECT_IMAGE2D_ARRAY:
+        region[1] = cl_desc.image_height;
+        region[2] = cl_desc.image_array_size;
+        break;
+    case CL_MEM_OBJECT_IMAGE3D:
+        region[1] = cl_desc.image_height;
+        region[2] = cl_desc.image_depth;
+        break;
+    default:
+        break;
+    }
+
+    if ((dst = clCreateImage(cl_ctx, flags, &cl_format, &cl_desc, NULL, &clres)) == NULL)
+    {   // the new image could not be allocated.
+        return cgClMemoryResultCode(clres);
+    }
+    if ((clres = clEnqueueCopyImage(cl_queue, src, dst, origin, origin, region, wait_count, CG_OPENCL_WAIT_LIST(wait_count, wait_list), &done)) != CL_SUCCESS)
+    {   // the copy command could not be enqueued.
+        clReleaseMemObject(dst); dst = NULL; done = NULL;
+        return cgClMemoryResultCode(clres);
+    }
+    return CG_SUCCESS;
+}
+
+/// @summary Determine whether a buffer object can be moved between device memory and host-backed memory.
+/// Buffers shared with OpenGL are managed by the OpenGL driver, and buffers already in host or pinned memory gain nothing from eviction.
+/// @param buffer The buffer object to check.
+/// @return true if the buffer can be evicted.
+internal_function inline bool
+cgBufferIsEvictable
+(
+    CG_BUFFER *buffer
+)
+{
+    return (buffer->ComputeBuffer  != NULL) && 
+           (buffer->GraphicsBuffer == 0   ) && 
+           (buffer->StagingPool    == NULL) && 
+           (buffer->ComputeUsage   & (CL_MEM_ALLOC_HOST_PTR | CL_MEM_USE_HOST_PTR)) == 0;
+}
+
+/// @summary Determine whether an image object can be moved between device memory and host-backed memory.
+/// Images shared with OpenGL are managed by the OpenGL driver, and images already in host or pinned memory gain nothing from eviction.
+/// @param image The image object to check.
+/// @return true if the image can be evicted.
+internal_function inline bool
+cgImageIsEvictable
+(
+    CG_IMAGE *image
+)
+{
+    return (image->ComputeImage  != NULL) && 
+           (image->GraphicsImage == 0   ) && 
+           (image->ComputeUsage  &  CL_MEM_ALLOC_HOST_PTR) == 0;
+}
+
+/// @summary Wait for all commands submitted to the compute and transfer queues of an execution group to complete.
+/// @param group The execution group to drain.
+internal_function void
+cgDrainExecutionGroup
+(
+    CG_EXEC_GROUP *group
+)
+{
+    for (size_t i = 0, n = group->QueueCount; i < n; ++i)
+    {   // the memory objects may be referenced by commands that are still executing.
+        if (group->QueueList[i]->CommandQueue != NULL)
+            clFinish(group->QueueList[i]->CommandQueue);
+    }
+}
+
+/// @summary Enqueue and flush a marker on each compute and transfer queue of an execution group other than @a target, so that 
+/// a command enqueued on @a target can wait on the device for all commands already submitted to the group.
+/// @param ctx The CGFX context that owns the execution group.
+/// @param group The execution group whose queues are marked.
+/// @param target The OpenCL command queue on which the waiting command will be enqueued. Commands on this queue are ordered already.
+/// @param events On return, points to the marker events. Free the list with cgClFreeGroupMarkers.
+/// @param count On return, stores the number of marker events.
+/// @return CG_SUCCESS or CG_OUT_OF_MEMORY.
+internal_function int
+cgClEnqueueGroupMarkers
+(
+    CG_CONTEXT       *ctx, 
+    CG_EXEC_GROUP    *group, 
+    cl_command_queue  target, 
+    cl_event        *&events, 
+    cl_uint          &count
+)
+{
+    events = NULL;
+    count  = 0;
+    if (group->QueueCount == 0)
+        return CG_SUCCESS;
+    if ((events = (cl_event*) cgAllocateHostMemory(&ctx->HostAllocator, group->QueueCount * sizeof(cl_event), 0, CG_ALLOCATION_TYPE_TEMP)) == NULL)
+        return CG_OUT_OF_MEMORY;
+    for (size_t i = 0, n = group->QueueCount; i < n; ++i)
+    {
+        cl_command_queue queue  = group->QueueList[i]->CommandQueue;
+        cl_event         marker = NULL;
+        if (queue == NULL || queue == target)
+            continue;
+        if (clEnqueueMarkerWithWaitList(queue, 0, NULL, &marker) == CL_SUCCESS)
+        {   // flush so that the marker can complete while @a target waits on it.
+            clFlush(queue);
+            events[count++] = marker;
+        }
+        else
+        {   // the marker could not be enqueued; fall back to waiting on the host.
+            clFinish(queue);
+        }
+    }
+    return CG_SUCCESS;
+}
+
+/// @summary Release the marker events returned by cgClEnqueueGroupMarkers.
+/// @param ctx The CGFX context that owns the execution group.
+/// @param group The execution group passed to cgClEnqueueGroupMarkers.
+/// @param events The marker events.
+/// @param count The number of marker events.
+internal_function void
+cgClFreeGroupMarkers
+(
+    CG_CONTEXT    *ctx, 
+    CG_EXEC_GROUP *group, 
+    cl_event      *events, 
+    cl_uint        count
+)
+{
+    if (events == NULL)
+        return;
+    for (cl_uint i = 0; i < count; ++i)
+    {
+        clReleaseEvent(events[i]);
+    }
+    cgFreeHostMemory(&ctx->HostAllocator, events, group->QueueCount * sizeof(cl_event), 0, CG_ALLOCATION_TYPE_TEMP);
+}
+
+/// @summary Order all later commands on the compute and transfer queues of an execution group after a command enqueued on @a source.
+/// The ordering is enforced on the device with barriers; the host only waits if a barrier cannot be enqueued.
+/// @param group The execution group whose queues are ordered.
+/// @param source The OpenCL command queue on which @a done was enqueued.
+/// @param done The event signaled when the command completes.
+internal_function void
+cgClEnqueueGroupBarrier
+(
+    CG_EXEC_GROUP    *group, 
+    cl_command_queue  source, 
+    cl_event          done
+)
+{
+    clFlush(source);
+    for (size_t i = 0, n = group->QueueCount; i < n; ++i)
+    {
+        cl_command_queue queue = group->QueueList[i]->CommandQueue;
+        if (queue == NULL || queue == source)
+            continue;
+        if (clEnqueueBarrierWithWaitList(queue, 1, &done, NULL) != CL_SUCCESS)
+        {   // the barrier could not be enqueued; fall back to waiting on the host.
+            clWaitForEvents(1, &done);
+        }
+    }
+}
+
+/// @summary Move the contents of a buffer from device memory to host-backed memory. The buffer remains usable by commands while evicted.
+/// The execution group must have been drained, so the copy can be enqueued without waiting on earlier commands. The caller holds 
+/// CG_CONTEXT::ResidencyLock exclusively, and the buffer is not mapped.
+/// @param ctx The CGFX context that owns the buffer.
+/// @param group The execution group that owns the buffer.
+/// @param buffer The buffer object to evict.
+/// @return CG_SUCCESS or another result code.
+internal_function int
+cgEvictBuffer
+(
+    CG_CONTEXT    *ctx, 
+    CG_EXEC_GROUP *group, 
+    CG_BUFFER     *buffer
+)
+{
+    cl_command_queue cl_queue = group->TransferQueues[0]->CommandQueue;
+    cl_mem           clmem    = NULL;
+    cl_event         done     = NULL;
+    int              result   = CG_SUCCESS;
+    if ((result = cgClCloneBuffer(buffer->ComputeContext, cl_queue, buffer->ComputeBuffer, buffer->ComputeUsage | CL_MEM_ALLOC_HOST_PTR, 0, NULL, clmem, done)) != CG_SUCCESS)
+        return result;
+
+    // later commands on any queue of the group must see the copied contents.
+    // the device keeps the source alive until the copy has finished reading it.
+    cgClEnqueueGroupBarrier(group, cl_queue, done);
+    clReleaseEvent(done);
+    clReleaseMemObject(buffer->ComputeBuffer);
+    buffer->ComputeBuffer = clmem;
+    buffer->Evicted       = true;
+    if (buffer->SourceHeap->HeapSizeUsed >= buffer->AllocatedSize)
+        buffer->SourceHeap->HeapSizeUsed -= buffer->AllocatedSize;
+    else
+        buffer->SourceHeap->HeapSizeUsed  = 0;
+    ctx->ResidencyStats.EvictionCount++;
+    ctx->ResidencyStats.EvictedBytes     += buffer->AllocatedSize;
+    ctx->ResidencyStats.NonResidentBytes += buffer->AllocatedSize;
+    return CG_SUCCESS;
+}
+
+/// @summary Move the contents of an image from device memory to host-backed memory. The image remains usable by commands while evicted.
+/// The execution group must have been drained, so the copy can be enqueued without waiting on earlier commands. The caller holds 
+/// CG_CONTEXT::ResidencyLock exclusively, and the image is not mapped.
+/// @param ctx The CGFX context that owns the image.
+/// @param group The execution group that owns the image.
+/// @param image The image object to evict.
+/// @return CG_SUCCESS or another result code.
+internal_function int
+cgEvictImage
+(
+    CG_CONTEXT    *ctx, 
+    CG_EXEC_GROUP *group, 
+    CG_IMAGE      *image
+)
+{
+    cl_command_queue cl_queue = group->TransferQueues[0]->CommandQueue;
+    cl_mem           clmem    = NULL;
+    cl_event         done     = NULL;
+    int              result   = CG_SUCCESS;
+    if ((result = cgClCloneImage(image->ComputeContext, cl_queue, image->ComputeImage, image->ComputeUsage | CL_MEM_ALLOC_HOST_PTR, 0, NULL, clmem, done)) != CG_SUCCESS)
+        return result;
+
+    // later commands on any queue of the group must see the copied contents.
+    // the device keeps the source alive until the copy has finished reading it.
+    cgClEnqueueGroupBarrier(group, cl_queue, done);
+    clReleaseEvent(done);
+    clReleaseMemObject(image->ComputeImage);
+    image->ComputeImage = clmem;
+    image->Evicted      = true;
+    if (image->SourceHeap->HeapSizeUsed >= image->AllocatedSize)
+        image->SourceHeap->HeapSizeUsed -= image->AllocatedSize;
+    else
+        image->SourceHeap->HeapSizeUsed  = 0;
+    ctx->ResidencyStats.EvictionCount++;
+    ctx->ResidencyStats.EvictedBytes     += image->AllocatedSize;
+    ctx->ResidencyStats.NonResidentBytes += image->AllocatedSize;
+    return CG_SUCCESS;
+}
+
+/// @summary Compare two eviction candidates by last use, for sorting with qsort. Objects used least recently sort first.
+/// @param a The first CG_RESIDENCY_CANDIDATE.
+/// @param b The second CG_RESIDENCY_CANDIDATE.
+/// @return A negative value if @a a was used before @a b, zero if they were used in the same frame, or a positive value otherwise.
+internal_function int
+cgCompareResidencyCandidates
+(
+    void const *a, 
+    void const *b
+)
+{
+    CG_RESIDENCY_CANDIDATE const *ca = (CG_RESIDENCY_CANDIDATE const*) a;
+    CG_RESIDENCY_CANDIDATE const *cb = (CG_RESIDENCY_CANDIDATE const*) b;
+    if (ca->LastUseFrame < cb->LastUseFrame) return -1;
+    if (ca->LastUseFrame > cb->LastUseFrame) return +1;
+    return 0;
+}
+
+/// @summary Record whether a state-changing OpenGL call was issued or skipped by the state cache.
+/// @param cache The OpenGL state cache to update.
+/// @param issued true if the call was made, or false if it was skipped.
+internal_function inline void
+cgGlStateCount
+(
+    CG_GL_STATE_CACHE *cache, 
+    bool               issued
+)
+{
+    if (issued) cache->CallsIssued++;
+    else        cache->CallsElided++;
+}
+
+/// @summary Enable or disable an OpenGL capability through the state cache.
+/// @param display The display object attached to the OpenGL rendering context.
+/// @param cap The OpenGL capability, for example GL_BLEND.
+/// @param current The cached value of the capability. Updated on return.
+/// @param value The new value of the capability.
+/// @param valid true if @a current matches the rendering context.
+internal_function void
+cgGlStateEnable
+(
+    CG_DISPLAY *display, 
+    GLenum      cap, 
+    GLboolean  &current, 
+    GLboolean   value, 
+    bool        valid
+)
+{
+    if (valid && current == value)
+    {   // the capability is already in the requested state.
+        cgGlStateCount(display->GLState, false);
+        return;
+    }
+    if (value) glEnable (cap);
+    else       glDisable(cap);
+    cgGlStateCount(display->GLState, true);
+    current = value;
+}
+
+/// @summary Create the buffer object backing the uniform ring of a rendering context. Where buffer storage is available, 
+/// the buffer is persistently and coherently mapped so uniform data can be written without calling OpenGL. Otherwise, 
+/// data is written with glBufferSubData.
+/// @param display The display object attached to the OpenGL rendering context.
+/// @param ring The uniform ring to initialize.
+/// @return CG_SUCCESS, CG_BAD_GLCONTEXT or CG_OUT_OF_MEMORY.
+internal_function int
+cgGlUniformRingCreate
+(
+    CG_DISPLAY         *display, 
+    CG_GL_UNIFORM_RING *ring
+)
+{
+    GLsizeiptr size   =(GLsizeiptr) CG_OPENGL_UNIFORM_RING_SIZE;
+    GLbitfield flags  = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    GLint      align  = 0;
+    GLuint     buffer = 0;
+    uint8_t   *host   = NULL;
+
+    glGetError(); // clear any pending error.
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+    if (align <= 0 || (align & (align - 1)) != 0)
+    {   // offsets must be a power-of-two multiple for align_up; 256 satisfies all known implementations.
+        align  = 256;
+    }
+    if (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage)
+    {   // allocate immutable storage that stays mapped for the lifetime of the rendering context.
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferStorage(GL_UNIFORM_BUFFER, size, NULL, flags);
+        host = (uint8_t*) glMapBufferRange(GL_UNIFORM_BUFFER, 0, size, flags);
+        if (host == NULL)
+        {   // immutable storage cannot be respecified, so fall back to a new buffer.
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+            glDeleteBuffers(1, &buffer);
+            buffer = 0;
+        }
+    }
+    if (buffer == 0)
+    {   // allocate mutable storage updated with glBufferSubData.
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    if (buffer == 0)
+        return CG_BAD_GLCONTEXT;
+    if (glGetError() != GL_NO_ERROR)
+    {   // the driver was unable to allocate the storage.
+        glDeleteBuffers(1, &buffer);
+        return CG_OUT_OF_MEMORY;
+    }
+    ring->Buffer      = buffer;
+    ring->HostAddress = host;
+    ring->Size        = size_t(size);
+    ring->Alignment   = size_t(align);
+    ring->Head        = 0;
+    ring->Used        = 0;
+    ring->FrameBytes  = 0;
+    ring->FrameFirst  = 0;
+    ring->FrameCount  = 0;
+    return CG_SUCCESS;
+}
+
+/// @summary Release the ring space used by the oldest graphics submission in flight, if the device has finished with it.
+/// @param display The display object attached to the OpenGL rendering context.
+/// @param ring The uniform ring to update. FrameCount must be greater than zero.
+/// @param wait Specify true to block until the device has finished with the submission.
+/// @return true if the space was released.
+internal_function bool
+cgGlUniformRingRetire
+(
+    CG_DISPLAY         *display, 
+    CG_GL_UNIFORM_RING *ring, 
+    bool                wait
+)
+{
+    CG_GL_UNIFORM_RING_FRAME &frame = ring->Frames[ring->FrameFirst];
+    GLbitfield                flags = wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0;
+    GLuint64                  nanos = wait ? GLuint64(1000000000) : 0;
+    GLenum                    state = GL_TIMEOUT_EXPIRED;
+
+    do
+    {   // a failed wait means the fence can never signal; treat it the same as a signaled fence.
+        state = glClientWaitSync(frame.Fence, flags, nanos);
+    } while (wait && state == GL_TIMEOUT_EXPIRED);
+
+    if (state == GL_TIMEOUT_EXPIRED)
+        return false;
+
+    glDeleteSync(frame.Fence);
+    ring->Used      -= frame.Bytes;
+    ring->FrameFirst = (ring->FrameFirst + 1) % CG_OPENGL_UNIFORM_RING_MAX_FRAMES;
+    ring->FrameCount--;
+    frame.Fence      = NULL;
+    frame.Bytes      = 0;
+    return true;
+}
+
 /*////////////////////////
 //   Public Functions   //
 ////////////////////////*/
@@ -468,6 +1000,825 @@ cgSetupNewCompleteEvent
     return cgSetupExistingEvent(queue, done, cl_sync, gl_sync, result);
 }
 
+/// @summary Mark all state in the OpenGL state cache of a display as unknown, so that the next change to each item is issued.
+/// The call counters are not modified. Call this after OpenGL state is changed without going through the cache.
+/// @param display The display object attached to the OpenGL rendering context.
+export_function void
+cgGlStateReset
+(
+    CG_DISPLAY *display
+)
+{
+    CG_GL_STATE_CACHE *cache = display->GLState;
+    cache->Program           = CG_OPENGL_STATE_UNKNOWN;
+    cache->VertexArray       = CG_OPENGL_STATE_UNKNOWN;
+    cache->ActiveTexture     = CG_OPENGL_STATE_UNKNOWN;
+    for (size_t i = 0; i < CG_OPENGL_MAX_CACHED_TEXTURE_UNITS; ++i)
+    {
+        cache->TextureTargets[i] = GL_NONE;
+        cache->Textures[i]       = CG_OPENGL_STATE_UNKNOWN;
+        cache->Samplers[i]       = CG_OPENGL_STATE_UNKNOWN;
+    }
+    cache->DrawIndirectBuffer= CG_OPENGL_STATE_UNKNOWN;
+    cache->ParameterBuffer   = CG_OPENGL_STATE_UNKNOWN;
+    cache->DrawFramebuffer   = CG_OPENGL_STATE_UNKNOWN;
+    cache->TargetFramebuffer = 0;
+    cache->ColorAttachment   = 0;
+    cache->DepthAttachment   = 0;
+    cache->DepthAttachPoint  = GL_NONE;
+    cache->AttachmentLevel   = 0;
+    cache->ReadFramebuffer   = CG_OPENGL_STATE_UNKNOWN;
+    cache->SourceFramebuffer = 0;
+    cache->SourceAttachment  = 0;
+    cache->SourceLevel       = 0;
+    for (size_t i = 0; i < CG_OPENGL_MAX_CACHED_UNIFORM_BUFFERS; ++i)
+    {
+        cache->UniformBuffers[i] = CG_OPENGL_STATE_UNKNOWN;
+        cache->UniformOffsets[i] = 0;
+        cache->UniformSizes[i]   = 0;
+    }
+    cache->CullFace          = GL_NONE;
+    cache->ViewportValid     = false;
+    cache->BlendValid        = false;
+    cache->RasterValid       = false;
+    cache->DepthStencilValid = false;
+}
+
+/// @summary Capture the number of OpenGL calls issued and elided by the state cache of a display since the previous graphics submission.
+/// @param display The display object attached to the OpenGL rendering context.
+export_function void
+cgGlStateBeginFrame
+(
+    CG_DISPLAY *display
+)
+{
+    CG_GL_STATE_CACHE *cache = display->GLState;
+    cache->FrameCallsIssued  = cache->CallsIssued - cache->FrameBaseIssued;
+    cache->FrameCallsElided  = cache->CallsElided - cache->FrameBaseElided;
+    cache->FrameBaseIssued   = cache->CallsIssued;
+    cache->FrameBaseElided   = cache->CallsElided;
+}
+
+/// @summary Mark the end of the uniform data written by the previous graphics submission and release ring space the 
+/// device has finished reading. Allocations made before this call must not be bound after it.
+/// @param display The display object attached to the OpenGL rendering context.
+export_function void
+cgGlUniformRingBeginFrame
+(
+    CG_DISPLAY *display
+)
+{
+    CG_GL_UNIFORM_RING *ring = display->UniformRing;
+    if (ring == NULL || ring->Buffer == 0)
+        return;
+    while (ring->FrameCount > 0 && cgGlUniformRingRetire(display, ring, false))
+    {   /* release all submissions that have completed */ }
+    if (ring->FrameBytes > 0)
+    {
+        if (ring->FrameCount == CG_OPENGL_UNIFORM_RING_MAX_FRAMES)
+        {   // too many submissions in flight; wait for the oldest.
+            cgGlUniformRingRetire(display, ring, true);
+            ring->WaitCount++;
+        }
+        size_t index = (ring->FrameFirst + ring->FrameCount) % CG_OPENGL_UNIFORM_RING_MAX_FRAMES;
+        ring->Frames[index].Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        ring->Frames[index].Bytes = ring->FrameBytes;
+        ring->FrameBytes = 0;
+        ring->FrameCount++;
+    }
+    ring->FrameIndex++;
+}
+
+/// @summary Copy uniform block data into the uniform ring of a rendering context, creating the ring on first use. If the 
+/// ring is full, the calling thread waits for the device to finish the oldest graphics submission in flight.
+/// @param display The display object attached to the OpenGL rendering context.
+/// @param data The uniform block data to copy.
+/// @param size The number of bytes to copy.
+/// @param out_offset On return, the byte offset of the data within the ring buffer, aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_OUT_OF_MEMORY or CG_BAD_GLCONTEXT.
+export_function int
+cgGlUniformRingWrite
+(
+    CG_DISPLAY *display, 
+    void const *data, 
+    size_t      size, 
+    GLintptr   &out_offset
+)
+{
+    CG_GL_UNIFORM_RING *ring   = display->UniformRing;
+    size_t              offset = 0;
+    size_t              padded = 0;
+    size_t              needed = 0;
+    int                 result = CG_SUCCESS;
+
+    out_offset = 0;
+    if (ring == NULL)
+        return CG_BAD_GLCONTEXT;
+    if (ring->Buffer == 0 && (result = cgGlUniformRingCreate(display, ring)) != CG_SUCCESS)
+        return result;
+    if (size == 0 || size > ring->Size)
+        return CG_INVALID_VALUE;
+
+    // allocations never straddle the end of the ring; the tail is skipped instead.
+    padded = align_up(size, ring->Alignment);
+    offset = ring->Head;
+    needed = padded;
+    if (offset + padded > ring->Size)
+    {
+        needed += ring->Size - offset;
+        offset  = 0;
+    }
+    while (ring->Size - ring->Used < needed)
+    {
+        if (ring->FrameCount == 0)
+        {   // the current submission alone has used the entire ring.
+            return CG_OUT_OF_MEMORY;
+        }
+        cgGlUniformRingRetire(display, ring, true);
+        ring->WaitCount++;
+    }
+    if (ring->HostAddress != NULL)
+    {   // the mapping is coherent, so the write is visible to commands issued after this point.
+        memcpy(ring->HostAddress + offset, data, size);
+    }
+    else
+    {   // the ring space is not in use by the device, but the driver may still synchronize.
+        glBindBuffer   (GL_UNIFORM_BUFFER, ring->Buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, GLintptr(offset), GLsizeiptr(size), data);
+        glBindBuffer   (GL_UNIFORM_BUFFER, 0);
+    }
+    ring->Head         = offset + padded;
+    ring->Used        += needed;
+    ring->FrameBytes  += needed;
+    ring->BytesWritten+= size;
+    out_offset         = GLintptr(offset);
+    return CG_SUCCESS;
+}
+
+/// @summary Update the state cache after an OpenGL object is deleted. OpenGL reverts bindings of a deleted object to zero, 
+/// and the name may be returned again by glGen*, so cached bindings of the name must not be used to skip later calls.
+/// @param display The display object attached to the OpenGL rendering context.
+/// @param type The type of object, one of GL_PROGRAM, GL_VERTEX_ARRAY, GL_BUFFER, GL_TEXTURE or GL_SAMPLER.
+/// @param name The name of the deleted object.
+export_function void
+cgGlStateObjectDeleted
+(
+    CG_DISPLAY *display, 
+    GLenum      type, 
+    GLuint      name
+)
+{
+    CG_GL_STATE_CACHE *cache = display->GLState;
+    if (cache == NULL || name == 0)
+        return;
+    switch (type)
+    {
+    case GL_PROGRAM:
+        {   // a current program is only flagged for deletion, but its name is freed once it is replaced.
+            if (cache->Program == name)
+                cache->Program  = CG_OPENGL_STATE_UNKNOWN;
+        }
+        break;
+    case GL_VERTEX_ARRAY:
+        {
+            if (cache->VertexArray == name)
+                cache->VertexArray  = 0;
+        }
+        break;
+    case GL_BUFFER:
+        {
+            if (cache->DrawIndirectBuffer == name)
+                cache->DrawIndirectBuffer  = 0;
+            if (cache->ParameterBuffer    == name)
+                cache->ParameterBuffer     = 0;
+            for (size_t i = 0; i < CG_OPENGL_MAX_CACHED_UNIFORM_BUFFERS; ++i)
+            {
+                if (cache->UniformBuffers[i] == name)
+                    cache->UniformBuffers[i]  = 0;
+            }
+        }
+        break;
+    case GL_TEXTURE:
+        {
+            for (size_t i = 0; i < CG_OPENGL_MAX_CACHED_TEXTURE_UNITS; ++i)
+            {
+                if (cache->Textures[i] == name)
+                    cache->Textures[i]  = 0;
+            }
+            // the framebuffer keeps the attachment unless it is bound, so force the attachments to be re-issued.
+            if (cache->ColorAttachment == name || cache->DepthAttachment == name)
+            {
+                cache->ColorAttachment = CG_OPENGL_STATE_UNKNOWN;
+                cache->DepthAttachment = CG_OPENGL_STATE_UNKNOWN;
+            }
+            if (cache->SourceAttachment == name)
+                cache->SourceAttachment  = CG_OPENGL_STATE_UNKNOWN;
+        }
+        break;
+    case GL_SAMPLER:
+        {
+            for (size_t i = 0; i < CG_OPENGL_MAX_CACHED_TEXTURE_UNITS; ++i)
+            {
+                if (cache->Samplers[i] == name)
+                    cache->Samplers[i]  = 0;
+            }
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/// @summary Make a program object current through the state cache.
+/// @param display The display object attached to the OpenGL rendering context.
+/// @param program The name of the program object, or 0.
+export_function void
+cgGlUseProgram
+(
+    CG_DISPLAY *display, 
+    GLuint      program
+)
+{
+    CG_GL_STATE_CACHE *cache = display->GLState;
+    if (cache->Program != program)
+    {
+        glUseProgram(program);
+        cache->Program = program;
+        cgGlStateCount(cache, true);
+    }
+    else cgGlStateCount(cache, false);
+}
+
+/// @summary Bind a vertex array object through the state cache.
+/// @param display The display object attached to the OpenGL rendering context.
+/// @param vao The name of the vertex array object, or 0.
+export_function void
+cgGlBindVertexArray
+(
+    CG_DISPLAY *display, 
+    GLuint      vao
+)
+{
+    CG_GL_STATE_CACHE *cache = display->GLState;
+    if (cache->VertexArray != vao)
+    {
+        glBindVertexArray(vao);
+        cache->VertexArray = vao;
+        cgGlStateCount(cache, true);
+    }
+    else cgGlStateCount(cache, false);
+}
+
+/// @summary Bind the vertex array object of a vertex data source through the state cache. Data sources that share a 
+/// vertex layout also attach their vertex buffers, offsets and index buffer, unless the shared vertex array object 
+/// already references them, so switching between meshes sub-allocated from the same buffers costs one multi-bind.
+/// @param display The display object attached to the OpenGL rendering context.
+/// @param source The vertex data source to bind.
+export_function void
+cgGlBindVertexDataSource
+(
+    CG_DISPLAY                  *display, 
+    CG_VERTEX_DATA_SOURCE const *source
+)
+{
+    CG_GL_STATE_CACHE *cache  = display->GLState;
+    CG_VERTEX_LAYOUT  *layout = source->SharedLayout;
+    cgGlBindVertexArray(display, source->VertexArray);
+    if (layout == NULL)
+    {   // the vertex array object captured the buffer bindings at creation time.
+        return;
+    }
+    if (layout->BoundSource == source->ObjectId)
+    {   // the buffers of this data source are still attached to the shared vertex array object.
+        cgGlStateCount(cache, false);
+        return;
+    }
+    if (GLEW_VERSION_4_4 || GLEW_ARB_multi_bind)
+    {   // attach all of the vertex buffers with a single call.
+        GLintptr offsets[16];
+        GLsizei  strides[16];
+        for (size_t i = 0, n = source->BufferCount; i < n; ++i)
+        {
+            offsets[i] = GLintptr(source->BufferOffsets[i]);
+            strides[i] = GLsizei (source->BufferStrides[i]);
+        }
+        glBindVertexBuffers(0, GLsizei(source->BufferCount), source->BufferNames, offsets, strides);
+    }
+    else
+    {
+        for (size_t i = 0, n = source->BufferCount; i < n; ++i)
+        {
+            glBindVertexBuffer(GLuint(i), source->BufferNames[i], GLintptr(source->BufferOffsets[i]), GLsizei(source->BufferStrides[i]));
+        }
+    }
+    // the element array buffer binding is also vertex array object state.
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, source->IndexBuffer);
+    layout->BoundSource = source->ObjectId;
+    cgGlStateCount(cache, true);
+}
+
+/// @summary Bind a buffer object to one of the indirect command targets through the state cache. Other buffer targets 
+/// are captured by vertex array objects or rebound around each transfer, so they are not cached.
+/// @param display The display object attached to the OpenGL rendering context.
+/// @param target The buffer target, GL_DRAW_INDIRECT_BUFFER or GL_PARAMETER_BUFFER_ARB.
+/// @param buffer The name of the buffer object, or 0.
+export_function void
+cgGlBindBuffer
+(
+    CG_DISPLAY *display, 
+    GLenum      target, 
+    GLuint      buffer
+)
+{
+    CG_GL_STATE_CACHE *cache = display->GLState;
+    GLuint           *current= NULL;
+    switch (target)
+    {
+    case GL_DRAW_INDIRECT_BUFFER:
+        current = &cache->DrawIndirectBuffer;
+        break;
+    case GL_PARAMETER_BUFFER_ARB:
+        current = &cache->ParameterBuffer;
+        break;
+    default:
+        break;
+    }
+    if (current == NULL || *current != buffer)
+    {
+        glBindBuffer(target, buffer);
+        if (current != NULL) *current = buffer;
+        cgGlStateCount(cache, true);
+    }
+    else cgGlStateCount(cache, false);
+}
+
+/// @summary Bind a range of a buffer object to an indexed binding point through the state cache. Only uniform buffer 
+/// binding points below CG_OPENGL_MAX_CACHED_UNIFORM_BUFFERS are cached; other bindings are always issued.
+/// @param display The display object attached to the OpenGL rendering context.
+/// @param target The indexed buffer target, for example GL_UNIFORM_BUFFER.
+/// @param index The zero-based index of the binding point.
+/// @param buffer The name of the buffer object, or 0.
+/// @param offset The byte offset of the start of the range. Must be a multiple of GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.
+/// @param size The size of the range, in bytes.
+export_function void
+cgGlBindBufferRange
+(
+    CG_DISPLAY *display, 
+    GLenum      target, 
+    GLuint      index, 
+    GLuint      buffer, 
+    GLintptr    offset, 
+    GLsizeiptr  size
+)
+{
+    CG_GL_STATE_CACHE *cache = display->GLState;
+    if (target == GL_UNIFORM_BUFFER && index < CG_OPENGL_MAX_CACHED_UNIFORM_BUFFERS)
+    {
+        if (cache->UniformBuffers[index] == buffer && 
+            cache->UniformOffsets[index] == offset && 
+            cache->UniformSizes  [index] == size)
+        {   // the same range is already bound.
+            cgGlStateCount(cache, false);
+            return;
+        }
+        cache->UniformBuffers[index] = buffer;
+        cache->UniformOffsets[index] = offset;
+        cache->UniformSizes  [index] = size;
+    }
+    glBindBufferRange(target, index, buffer, offset, size);
+    cgGlStateCount(cache, true);
+}
+
+/// @summary Bind a texture to a texture unit through the state cache. The active texture unit is changed only if necessary.
+/// @param display The display object attached to the OpenGL rendering context.
+/// @param unit The zero-based index of the texture unit.
+/// @param target The texture target, for example GL_TEXTURE_2D.
+/// @param texture The name of the texture object, or 0.
+export_function void
+cgGlBindTexture
+(
+    CG_DISPLAY *display, 
+    GLuint      unit, 
+    GLenum      target, 
+    GLuint      texture
+)
+{
+    CG_GL_STATE_CACHE *cache = display->GLState;
+    if (unit < CG_OPENGL_MAX_CACHED_TEXTURE_UNITS && cache->Textures[unit] == texture && cache->TextureTargets[unit] == target)
+    {   // the texture is already bound to this target on the unit.
+        cgGlStateCount(cache, false);
+        return;
+    }
+    if (cache->ActiveTexture != unit)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        cache->ActiveTexture = unit;
+        cgGlStateCount(cache, true);
+    }
+    else cgGlStateCount(cache, false);
+    glBindTexture(target, texture);
+    cgGlStateCount(cache, true);
+    if (unit < CG_OPENGL_MAX_CACHED_TEXTURE_UNITS)
+    {
+        cache->TextureTargets[unit] = target;
+        cache->Textures[unit] = texture;
+    }
+}
+
+/// @summary Bind a sampler object to a texture unit through the state cache. Requires ARB_sampler_objects.
+/// @param display The display object attached to the OpenGL rendering context.
+/// @param unit The zero-based index of the texture unit.
+/// @param sampler The name of the sampler object, or 0.
+export_function void
+cgGlBindSampler
+(
+    CG_DISPLAY *display, 
+    GLuint      unit, 
+    GLuint      sampler
+)
+{
+    CG_GL_STATE_CACHE *cache = display->GLState;
+    if (unit < CG_OPENGL_MAX_CACHED_TEXTURE_UNITS && cache->Samplers[unit] == sampler)
+    {   // the sampler is already bound to the unit.
+        cgGlStateCount(cache, false);
+        return;
+    }
+    glBindSampler(unit, sampler);
+    cgGlStateCount(cache, true);
+    if (unit < CG_OPENGL_MAX_CACHED_TEXTURE_UNITS)
+    {
+        cache->Samplers[unit] = sampler;
+    }
+}
+
+/// @summary Select the framebuffer that subsequent draw commands render into. The default framebuffer belongs to the 
+/// drawable made current with the rendering context. Images are rendered into through a single framebuffer object per 
+/// rendering context, created on first use; attachments are only re-specified when they change, and completeness is 
+/// only checked after a change.
+/// @param display The display object attached to the OpenGL rendering context.
+/// @param color The 2D color image to render into, or NULL to bind the default framebuffer.
+/// @param depth The 2D depth or depth-stencil image with the same dimensions as @a color, or NULL.
+/// @param level The mipmap level of the images to render into.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_INVALID_STATE if the images cannot be rendered into, or CG_BAD_GLCONTEXT.
+export_function int
+cgGlBindRenderTarget
+(
+    CG_DISPLAY *display, 
+    CG_IMAGE   *color, 
+    CG_IMAGE   *depth, 
+    GLint       level
+)
+{
+    CG_GL_STATE_CACHE *cache = display->GLState;
+    GLuint             dtex  = 0;
+    GLenum             dpoint= GL_NONE;
+    if (color == NULL)
+    {   // render into the drawable.
+        if (depth != NULL)
+            return CG_INVALID_VALUE;
+        if (cache->DrawFramebuffer != 0)
+        {
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+            cache->DrawFramebuffer = 0;
+            cgGlStateCount(cache, true);
+        }
+        else cgGlStateCount(cache, false);
+        return CG_SUCCESS;
+    }
+    if (color->GraphicsImage == 0 || color->DefaultTarget != GL_TEXTURE_2D || level < 0 || size_t(level) >= color->LevelCount)
+    {   // only a single level of a 2D texture can be rendered into.
+        return CG_INVALID_VALUE;
+    }
+    if (depth != NULL)
+    {
+        if (depth->GraphicsImage == 0 || depth->DefaultTarget != GL_TEXTURE_2D || size_t(level) >= depth->LevelCount)
+            return CG_INVALID_VALUE;
+        if (depth->ImageWidth != color->ImageWidth || depth->ImageHeight != color->ImageHeight)
+            return CG_INVALID_VALUE;
+        if (depth->BaseFormat != GL_DEPTH_COMPONENT && depth->BaseFormat != GL_DEPTH_STENCIL)
+            return CG_INVALID_VALUE;
+        dtex   = depth->GraphicsImage;
+        dpoint = depth->BaseFormat == GL_DEPTH_STENCIL ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+    }
+    if (cache->TargetFramebuffer == 0)
+    {   // create the framebuffer object on first use.
+        glGenFramebuffers(1, &cache->TargetFramebuffer);
+        if (cache->TargetFramebuffer == 0)
+            return CG_BAD_GLCONTEXT;
+        cache->ColorAttachment  = 0;
+        cache->DepthAttachment  = 0;
+        cache->DepthAttachPoint = GL_NONE;
+        cache->AttachmentLevel  = 0;
+    }
+    if (cache->DrawFramebuffer != cache->TargetFramebuffer)
+    {
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, cache->TargetFramebuffer);
+        cache->DrawFramebuffer = cache->TargetFramebuffer;
+        cgGlStateCount(cache, true);
+    }
+    else cgGlStateCount(cache, false);
+
+    if (cache->ColorAttachment  == color->GraphicsImage && 
+        cache->DepthAttachment  == dtex   && 
+        cache->DepthAttachPoint == dpoint && 
+        cache->AttachmentLevel  == level)
+    {   // the images are already attached.
+        cgGlStateCount(cache, false);
+        return CG_SUCCESS;
+    }
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color->GraphicsImage, level);
+    if (cache->DepthAttachPoint != GL_NONE && cache->DepthAttachPoint != dpoint)
+    {   // detach the previous depth image from the attachment point that is no longer used.
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, cache->DepthAttachPoint, GL_TEXTURE_2D, 0, 0);
+    }
+    if (dpoint != GL_NONE)
+    {
+        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, dpoint, GL_TEXTURE_2D, dtex, level);
+    }
+    cgGlStateCount(cache, true);
+    if (glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {   // the image formats cannot be rendered into. re-specify everything next time.
+        cache->ColorAttachment  = CG_OPENGL_STATE_UNKNOWN;
+        cache->DepthAttachment  = CG_OPENGL_STATE_UNKNOWN;
+        cache->DepthAttachPoint = dpoint;
+        return CG_INVALID_STATE;
+    }
+    cache->ColorAttachment  = color->GraphicsImage;
+    cache->DepthAttachment  = dtex;
+    cache->DepthAttachPoint = dpoint;
+    cache->AttachmentLevel  = level;
+    return CG_SUCCESS;
+}
+
+/// @summary Select the framebuffer that glReadPixels reads from. Reading from an image attaches one level of it to a 
+/// second framebuffer object owned by the rendering context, so the draw framebuffer and its attachments are unaffected. 
+/// Reading from the draw framebuffer reads whatever the most recent SET_RENDER_TARGET selected.
+/// @param display The display object attached to the OpenGL rendering context.
+/// @param image The 2D image to read from, or NULL to read from the current draw framebuffer.
+/// @param level The mipmap level of the image to read from.
+/// @return CG_SUCCESS, CG_INVALID_VALUE, CG_INVALID_STATE if the image cannot be read as a color attachment, or CG_BAD_GLCONTEXT.
+export_function int
+cgGlBindReadSource
+(
+    CG_DISPLAY *display, 
+    CG_IMAGE   *image, 
+    GLint       level
+)
+{
+    CG_GL_STATE_CACHE *cache = display->GLState;
+    GLuint             fbo   = 0;
+    if (image == NULL)
+    {   // read from whatever draws currently render into.
+        if (cache->DrawFramebuffer == CG_OPENGL_STATE_UNKNOWN)
+        {
+            GLint current = 0;
+            glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &current);
+            cache->DrawFramebuffer = GLuint(current);
+        }
+        fbo = cache->DrawFramebuffer;
+    }
+    else
+    {
+        if (image->GraphicsImage == 0 || image->DefaultTarget != GL_TEXTURE_2D || level < 0 || size_t(level) >= image->LevelCount)
+        {   // only a single level of a 2D texture can be read.
+            return CG_INVALID_VALUE;
+        }
+        if (cache->SourceFramebuffer == 0)
+        {   // create the framebuffer object on first use.
+            glGenFramebuffers(1, &cache->SourceFramebuffer);
+            if (cache->SourceFramebuffer == 0)
+                return CG_BAD_GLCONTEXT;
+            cache->SourceAttachment = 0;
+            cache->SourceLevel      = 0;
+        }
+        fbo = cache->SourceFramebuffer;
+    }
+    if (cache->ReadFramebuffer != fbo)
+    {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+        cache->ReadFramebuffer = fbo;
+        cgGlStateCount(cache, true);
+    }
+    else cgGlStateCount(cache, false);
+
+    if (image == NULL)
+        return CG_SUCCESS;
+    if (cache->SourceAttachment == image->GraphicsImage && cache->SourceLevel == level)
+    {   // the image is already attached.
+        cgGlStateCount(cache, false);
+        return CG_SUCCESS;
+    }
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, image->GraphicsImage, level);
+    cgGlStateCount(cache, true);
+    if (glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {   // the image format cannot be read as a color attachment.
+        cache->SourceAttachment = CG_OPENGL_STATE_UNKNOWN;
+        return CG_INVALID_STATE;
+    }
+    cache->SourceAttachment = image->GraphicsImage;
+    cache->SourceLevel      = level;
+    return CG_SUCCESS;
+}
+
+/// @summary Set the viewport rectangle through the state cache.
+/// @param display The display object attached to the OpenGL rendering context.
+/// @param x The x-coordinate of the lower-left corner of the viewport.
+/// @param y The y-coordinate of the lower-left corner of the viewport.
+/// @param width The width of the viewport, in pixels.
+/// @param height The height of the viewport, in pixels.
+export_function void
+cgGlViewport
+(
+    CG_DISPLAY *display, 
+    GLint       x, 
+    GLint       y, 
+    GLsizei     width, 
+    GLsizei     height
+)
+{
+    CG_GL_STATE_CACHE *cache = display->GLState;
+    if (cache->ViewportValid  && 
+        cache->Viewport[0] == x     && cache->Viewport[1] == y && 
+        cache->Viewport[2] == width && cache->Viewport[3] == height)
+    {
+        cgGlStateCount(cache, false);
+        return;
+    }
+    glViewport(x, y, width, height);
+    cache->Viewport[0]   = x;
+    cache->Viewport[1]   = y;
+    cache->Viewport[2]   = width;
+    cache->Viewport[3]   = height;
+    cache->ViewportValid = true;
+    cgGlStateCount(cache, true);
+}
+
+/// @summary Apply fixed-function blending state through the state cache. Only the parts of the state that differ from the current state are issued.
+/// @param display The display object attached to the OpenGL rendering context.
+/// @param state The blend state to apply.
+export_function void
+cgGlApplyBlendState
+(
+    CG_DISPLAY           *display, 
+    CG_BLEND_STATE const *state
+)
+{
+    CG_GL_STATE_CACHE *cache = display->GLState;
+    CG_BLEND_STATE    &cur   = cache->BlendState;
+    bool               valid = cache->BlendValid;
+    cgGlStateEnable(display, GL_BLEND, cur.BlendEnabled, state->BlendEnabled, valid);
+    if (!valid || 
+        cur.SrcBlendColor != state->SrcBlendColor || cur.DstBlendColor != state->DstBlendColor || 
+        cur.SrcBlendAlpha != state->SrcBlendAlpha || cur.DstBlendAlpha != state->DstBlendAlpha)
+    {
+        glBlendFuncSeparate(state->SrcBlendColor, state->DstBlendColor, state->SrcBlendAlpha, state->DstBlendAlpha);
+        cgGlStateCount(cache, true);
+    }
+    else cgGlStateCount(cache, false);
+    if (!valid || cur.ColorBlendFunction != state->ColorBlendFunction || cur.AlphaBlendFunction != state->AlphaBlendFunction)
+    {
+        glBlendEquationSeparate(state->ColorBlendFunction, state->AlphaBlendFunction);
+        cgGlStateCount(cache, true);
+    }
+    else cgGlStateCount(cache, false);
+    if (!valid || memcmp(cur.ConstantRGBA, state->ConstantRGBA, sizeof(cur.ConstantRGBA)) != 0)
+    {
+        glBlendColor(state->ConstantRGBA[0], state->ConstantRGBA[1], state->ConstantRGBA[2], state->ConstantRGBA[3]);
+        cgGlStateCount(cache, true);
+    }
+    else cgGlStateCount(cache, false);
+    cur = *state;
+    cache->BlendValid = true;
+}
+
+/// @summary Apply fixed-function rasterizer state through the state cache. Only the parts of the state that differ from the current state are issued.
+/// @param display The display object attached to the OpenGL rendering context.
+/// @param state The rasterizer state to apply.
+export_function void
+cgGlApplyRasterState
+(
+    CG_DISPLAY            *display, 
+    CG_RASTER_STATE const *state
+)
+{
+    CG_GL_STATE_CACHE *cache = display->GLState;
+    CG_RASTER_STATE   &cur   = cache->RasterState;
+    bool               valid = cache->RasterValid;
+    GLboolean          cull  =(cur.CullMode  != GL_NONE) ? GL_TRUE : GL_FALSE;
+    GLboolean          bias  =(cur.DepthBias != 0 || cur.SlopeScaledDepthBias != 0.0f) ? GL_TRUE : GL_FALSE;
+    if (!valid || cur.FillMode != state->FillMode)
+    {
+        glPolygonMode(GL_FRONT_AND_BACK, state->FillMode);
+        cgGlStateCount(cache, true);
+    }
+    else cgGlStateCount(cache, false);
+    cgGlStateEnable(display, GL_CULL_FACE, cull, (state->CullMode != GL_NONE) ? GL_TRUE : GL_FALSE, valid);
+    if (state->CullMode != GL_NONE)
+    {   // the cull face is tracked separately, since it is retained while culling is disabled.
+        if (cache->CullFace != state->CullMode)
+        {
+            glCullFace(state->CullMode);
+            cache->CullFace = state->CullMode;
+            cgGlStateCount(cache, true);
+        }
+        else cgGlStateCount(cache, false);
+    }
+    if (!valid || cur.FrontFace != state->FrontFace)
+    {
+        glFrontFace(state->FrontFace);
+        cgGlStateCount(cache, true);
+    }
+    else cgGlStateCount(cache, false);
+    cgGlStateEnable(display, GL_POLYGON_OFFSET_FILL, bias, (state->DepthBias != 0 || state->SlopeScaledDepthBias != 0.0f) ? GL_TRUE : GL_FALSE, valid);
+    if (!valid || cur.DepthBias != state->DepthBias || cur.SlopeScaledDepthBias != state->SlopeScaledDepthBias)
+    {
+        glPolygonOffset(state->SlopeScaledDepthBias, GLfloat(state->DepthBias));
+        cgGlStateCount(cache, true);
+    }
+    else cgGlStateCount(cache, false);
+    cur = *state;
+    cache->RasterValid = true;
+}
+
+/// @summary Apply fixed-function depth and stencil testing state through the state cache. Only the parts of the state that differ from the current state are issued.
+/// @param display The display object attached to the OpenGL rendering context.
+/// @param state The depth-stencil state to apply.
+export_function void
+cgGlApplyDepthStencilState
+(
+    CG_DISPLAY                   *display, 
+    CG_DEPTH_STENCIL_STATE const *state
+)
+{
+    CG_GL_STATE_CACHE      *cache  = display->GLState;
+    CG_DEPTH_STENCIL_STATE &cur    = cache->DepthStencilState;
+    bool                    valid  = cache->DepthStencilValid;
+    GLboolean               bounds = cur.DepthBoundsEnable;
+    cgGlStateEnable(display, GL_DEPTH_TEST, cur.DepthTestEnable, state->DepthTestEnable, valid);
+    if (!valid || cur.DepthWriteEnable != state->DepthWriteEnable)
+    {
+        glDepthMask(state->DepthWriteEnable);
+        cgGlStateCount(cache, true);
+    }
+    else cgGlStateCount(cache, false);
+    if (!valid || cur.DepthTestFunction != state->DepthTestFunction)
+    {
+        glDepthFunc(state->DepthTestFunction);
+        cgGlStateCount(cache, true);
+    }
+    else cgGlStateCount(cache, false);
+    if (GLEW_EXT_depth_bounds_test)
+    {   // the bounds are only set while the test is enabled, so they are re-issued whenever the test is turned on.
+        cgGlStateEnable(display, GL_DEPTH_BOUNDS_TEST_EXT, cur.DepthBoundsEnable, state->DepthBoundsEnable, valid);
+        if (state->DepthBoundsEnable)
+        {
+            if (!valid || !bounds || cur.DepthMin != state->DepthMin || cur.DepthMax != state->DepthMax)
+            {
+                glDepthBoundsEXT(state->DepthMin, state->DepthMax);
+                cgGlStateCount(cache, true);
+            }
+            else cgGlStateCount(cache, false);
+        }
+    }
+    cgGlStateEnable(display, GL_STENCIL_TEST, cur.StencilTestEnable, state->StencilTestEnable, valid);
+    if (!valid || cur.StencilTestFunction != state->StencilTestFunction || cur.StencilReference != state->StencilReference || cur.StencilReadMask != state->StencilReadMask)
+    {
+        glStencilFunc(state->StencilTestFunction, GLint(state->StencilReference), GLuint(state->StencilReadMask));
+        cgGlStateCount(cache, true);
+    }
+    else cgGlStateCount(cache, false);
+    if (!valid || cur.StencilFailOp != state->StencilFailOp || cur.StencilPassZFailOp != state->StencilPassZFailOp || cur.StencilPassZPassOp != state->StencilPassZPassOp)
+    {
+        glStencilOp(state->StencilFailOp, state->StencilPassZFailOp, state->StencilPassZPassOp);
+        cgGlStateCount(cache, true);
+    }
+    else cgGlStateCount(cache, false);
+    if (!valid || cur.StencilWriteMask != state->StencilWriteMask)
+    {
+        glStencilMask(GLuint(state->StencilWriteMask));
+        cgGlStateCount(cache, true);
+    }
+    else cgGlStateCount(cache, false);
+    cur = *state;
+    cache->DepthStencilValid = true;
+}
+
+/// @summary Apply the program and fixed-function state of a graphics pipeline through the state cache.
+/// @param display The display object attached to the OpenGL rendering context.
+/// @param pipeline The graphics pipeline whose state is applied.
+export_function void
+cgGlApplyGraphicsPipeline
+(
+    CG_DISPLAY                 *display, 
+    CG_GRAPHICS_PIPELINE const *pipeline
+)
+{
+    cgGlUseProgram(display, pipeline->ShaderProgram.Program);
+    cgGlApplyBlendState(display, &pipeline->BlendState);
+    cgGlApplyRasterState(display, &pipeline->RasterizerState);
+    cgGlApplyDepthStencilState(display, &pipeline->DepthStencilState);
+}
+
 /// @summary Add a memory object reference to a memref list.
 /// @param memref The OpenCL memory object reference to add.
 /// @param memref_list The memory object reference list to update. The memref will be appended to the list.
@@ -707,3 +2058,261 @@ cgReleaseMemoryObjects
     }
     return cgSetupCompleteEventWithWaitList(ctx, queue, done_event, wait_events, wait_count, CG_SUCCESS);
 }
+
+/// @summary Enqueue a copy of the contents of an evicted buffer back into device memory on @a queue. The caller holds 
+/// CG_CONTEXT::RestoreLock, and CG_CONTEXT::ResidencyLock in shared mode.
+/// @param ctx The CGFX context that owns the buffer.
+/// @param queue The CGFX compute or transfer queue that will reference the buffer.
+/// @param buffer The evicted buffer object, which is not mapped.
+/// @return CG_SUCCESS or another result code. If the buffer cannot be restored, it remains usable from host-backed memory.
+internal_function int
+cgRestoreBuffer
+(
+    CG_CONTEXT *ctx, 
+    CG_QUEUE   *queue, 
+    CG_BUFFER  *buffer
+)
+{
+    CG_EXEC_GROUP *group   = NULL;
+    cl_event      *markers = NULL;
+    cl_uint        nmarker = 0;
+    cl_mem         clmem   = NULL;
+    cl_event       done    = NULL;
+    int            result  = CG_SUCCESS;
+
+    if ((group = cgObjectTableGet(&ctx->ExecGroupTable, buffer->ExecutionGroup)) == NULL || group->DeviceCount == 0)
+        return CG_INVALID_STATE;
+
+    // the copy must follow earlier commands that reference the host-backed buffer.
+    if ((result = cgClEnqueueGroupMarkers(ctx, group, queue->CommandQueue, markers, nmarker)) != CG_SUCCESS)
+        return result;
+    result = cgClCloneBuffer(buffer->ComputeContext, queue->CommandQueue, buffer->ComputeBuffer, buffer->ComputeUsage, nmarker, markers, clmem, done);
+    cgClFreeGroupMarkers(ctx, group, markers, nmarker);
+    if (result != CG_SUCCESS)
+    {   // device memory is exhausted; keep using the host-backed copy.
+        return result == CG_OUT_OF_MEMORY ? CG_SUCCESS : result;
+    }
+    cgClEnqueueGroupBarrier(group, queue->CommandQueue, done);
+    clReleaseEvent(done);
+    clReleaseMemObject(buffer->ComputeBuffer);
+    buffer->ComputeBuffer = clmem;
+    buffer->Evicted       = false;
+    buffer->SourceHeap->HeapSizeUsed += buffer->AllocatedSize;
+    if (ctx->ResidencyStats.NonResidentBytes >= buffer->AllocatedSize)
+        ctx->ResidencyStats.NonResidentBytes -= buffer->AllocatedSize;
+    else
+        ctx->ResidencyStats.NonResidentBytes  = 0;
+    ctx->ResidencyStats.UploadCount++;
+    ctx->ResidencyStats.UploadedBytes += buffer->AllocatedSize;
+    return CG_SUCCESS;
+}
+
+/// @summary Mark a buffer as referenced by the current frame. If the buffer was evicted to host-backed memory, a copy of its contents back into device memory is enqueued on @a queue.
+/// The copy waits on the device for commands already submitted to the execution group, and later commands on the group's other queues wait on the copy, so the host never blocks.
+/// Call this function from command executors, which hold CG_CONTEXT::ResidencyLock in shared mode, before the buffer's cl_mem is referenced.
+/// @param ctx The CGFX context that owns the buffer.
+/// @param queue The CGFX compute or transfer queue that will reference the buffer.
+/// @param buffer The buffer object being referenced.
+/// @return CG_SUCCESS or another result code. If the buffer cannot be restored, it remains usable from host-backed memory.
+export_function int
+cgMakeBufferResident
+(
+    CG_CONTEXT *ctx, 
+    CG_QUEUE   *queue, 
+    CG_BUFFER  *buffer
+)
+{
+    int result = CG_SUCCESS;
+    buffer->LastUseFrame = uint64_t(ctx->FrameIndex);
+    if (buffer->Evicted == false)
+        return CG_SUCCESS;
+
+    // another submitting thread may be restoring or mapping the buffer.
+    // a mapped buffer stays in host-backed memory until it is unmapped.
+    AcquireSRWLockExclusive(&ctx->RestoreLock);
+    if (buffer->Evicted && buffer->MapCount == 0)
+        result = cgRestoreBuffer(ctx, queue, buffer);
+    ReleaseSRWLockExclusive(&ctx->RestoreLock);
+    return result;
+}
+
+/// @summary Enqueue a copy of the contents of an evicted image back into device memory on @a queue. The caller holds 
+/// CG_CONTEXT::RestoreLock, and CG_CONTEXT::ResidencyLock in shared mode.
+/// @param ctx The CGFX context that owns the image.
+/// @param queue The CGFX compute or transfer queue that will reference the image.
+/// @param image The evicted image object, which is not mapped.
+/// @return CG_SUCCESS or another result code. If the image cannot be restored, it remains usable from host-backed memory.
+internal_function int
+cgRestoreImage
+(
+    CG_CONTEXT *ctx, 
+    CG_QUEUE   *queue, 
+    CG_IMAGE   *image
+)
+{
+    CG_EXEC_GROUP *group   = NULL;
+    cl_event      *markers = NULL;
+    cl_uint        nmarker = 0;
+    cl_mem         clmem   = NULL;
+    cl_event       done    = NULL;
+    int            result  = CG_SUCCESS;
+
+    if ((group = cgObjectTableGet(&ctx->ExecGroupTable, image->ExecutionGroup)) == NULL || group->DeviceCount == 0)
+        return CG_INVALID_STATE;
+
+    // the copy must follow earlier commands that reference the host-backed image.
+    if ((result = cgClEnqueueGroupMarkers(ctx, group, queue->CommandQueue, markers, nmarker)) != CG_SUCCESS)
+        return result;
+    result = cgClCloneImage(image->ComputeContext, queue->CommandQueue, image->ComputeImage, image->ComputeUsage, nmarker, markers, clmem, done);
+    cgClFreeGroupMarkers(ctx, group, markers, nmarker);
+    if (result != CG_SUCCESS)
+    {   // device memory is exhausted; keep using the host-backed copy.
+        return result == CG_OUT_OF_MEMORY ? CG_SUCCESS : result;
+    }
+    cgClEnqueueGroupBarrier(group, queue->CommandQueue, done);
+    clReleaseEvent(done);
+    clReleaseMemObject(image->ComputeImage);
+    image->ComputeImage = clmem;
+    image->Evicted      = false;
+    image->SourceHeap->HeapSizeUsed += image->AllocatedSize;
+    if (ctx->ResidencyStats.NonResidentBytes >= image->AllocatedSize)
+        ctx->ResidencyStats.NonResidentBytes -= image->AllocatedSize;
+    else
+        ctx->ResidencyStats.NonResidentBytes  = 0;
+    ctx->ResidencyStats.UploadCount++;
+    ctx->ResidencyStats.UploadedBytes += image->AllocatedSize;
+    return CG_SUCCESS;
+}
+
+/// @summary Mark an image as referenced by the current frame. If the image was evicted to host-backed memory, a copy of its contents back into device memory is enqueued on @a queue.
+/// The copy waits on the device for commands already submitted to the execution group, and later commands on the group's other queues wait on the copy, so the host never blocks.
+/// Call this function from command executors, which hold CG_CONTEXT::ResidencyLock in shared mode, before the image's cl_mem is referenced.
+/// @param ctx The CGFX context that owns the image.
+/// @param queue The CGFX compute or transfer queue that will reference the image.
+/// @param image The image object being referenced.
+/// @return CG_SUCCESS or another result code. If the image cannot be restored, it remains usable from host-backed memory.
+export_function int
+cgMakeImageResident
+(
+    CG_CONTEXT *ctx, 
+    CG_QUEUE   *queue, 
+    CG_IMAGE   *image
+)
+{
+    int result = CG_SUCCESS;
+    image->LastUseFrame = uint64_t(ctx->FrameIndex);
+    if (image->Evicted == false)
+        return CG_SUCCESS;
+
+    // another submitting thread may be restoring or mapping the image.
+    // a mapped image stays in host-backed memory until it is unmapped.
+    AcquireSRWLockExclusive(&ctx->RestoreLock);
+    if (image->Evicted && image->MapCount == 0)
+        result = cgRestoreImage(ctx, queue, image);
+    ReleaseSRWLockExclusive(&ctx->RestoreLock);
+    return result;
+}
+
+/// @summary Evict the least-recently-used memory objects from each heap whose device-resident usage exceeds its residency budget.
+/// Objects referenced by the current frame and mapped objects are never evicted, so a heap may remain over budget if the working set of a single submission exceeds it.
+/// Eviction holds CG_CONTEXT::ResidencyLock exclusively, so it waits for command buffers being executed and objects being mapped by other threads, and blocks them until it completes.
+/// @param ctx The CGFX context to update.
+/// @return CG_SUCCESS, CG_OUT_OF_MEMORY or another result code.
+export_function int
+cgEnforceResidencyBudget
+(
+    CG_CONTEXT *ctx
+)
+{
+    CG_RESIDENCY_CANDIDATE *list    = NULL;
+    size_t                  nmax    = 0;
+    uint64_t                frame   = 0;
+    bool                    over    = false;
+    bool                    drained = false;
+    int                     result  = CG_SUCCESS;
+
+    // most submissions leave every heap within its budget; don't block other threads in that case.
+    // the check is repeated for each heap once the lock is held.
+    for (size_t i = 0, n = ctx->HeapCount; i < n && over == false; ++i)
+    {
+        CG_HEAP *heap  = &ctx->HeapList[i];
+        over = heap->ResidencyBudget != 0 && heap->HeapSizeUsed > heap->ResidencyBudget;
+    }
+    if (over == false)
+        return CG_SUCCESS;
+
+    AcquireSRWLockExclusive(&ctx->ResidencyLock);
+    nmax  = ctx->BufferTable.ObjectCount + ctx->ImageTable.ObjectCount;
+    frame = uint64_t(ctx->FrameIndex);
+    for (size_t i = 0, n = ctx->HeapCount; i < n; ++i)
+    {
+        CG_HEAP *heap  = &ctx->HeapList[i];
+        size_t   count = 0;
+
+        if (heap->ResidencyBudget == 0 || heap->HeapSizeUsed <= heap->ResidencyBudget)
+            continue;
+        if (list == NULL && (list = (CG_RESIDENCY_CANDIDATE*) cgAllocateHostMemory(&ctx->HostAllocator, nmax * sizeof(CG_RESIDENCY_CANDIDATE), 0, CG_ALLOCATION_TYPE_TEMP)) == NULL)
+        {   // unable to allocate the candidate list.
+            result = CG_OUT_OF_MEMORY;
+            break;
+        }
+
+        // gather the resident, unmapped objects on this heap not referenced by the current frame.
+        for (size_t j = 0, m = ctx->BufferTable.ObjectCount; j < m; ++j)
+        {
+            CG_BUFFER *buffer = &ctx->BufferTable.Objects[j];
+            if (buffer->SourceHeap == heap && buffer->Evicted == false && buffer->MapCount == 0 && buffer->LastUseFrame < frame && cgBufferIsEvictable(buffer))
+            {
+                list[count].LastUseFrame = buffer->LastUseFrame;
+                list[count].Buffer       = buffer;
+                list[count].Image        = NULL;
+                count++;
+            }
+        }
+        for (size_t j = 0, m = ctx->ImageTable.ObjectCount; j < m; ++j)
+        {
+            CG_IMAGE  *image  = &ctx->ImageTable.Objects[j];
+            if (image->SourceHeap == heap && image->Evicted == false && image->MapCount == 0 && image->LastUseFrame < frame && cgImageIsEvictable(image))
+            {
+                list[count].LastUseFrame = image->LastUseFrame;
+                list[count].Buffer       = NULL;
+                list[count].Image        = image;
+                count++;
+            }
+        }
+        if (count == 0)
+            continue;
+        qsort(list, count, sizeof(CG_RESIDENCY_CANDIDATE), cgCompareResidencyCandidates);
+
+        // wait once per pass for commands that may reference the candidates.
+        // after this, each eviction copy is only ordered against the device.
+        if (drained == false)
+        {
+            for (size_t j = 0, m = ctx->ExecGroupTable.ObjectCount; j < m; ++j)
+            {
+                cgDrainExecutionGroup(&ctx->ExecGroupTable.Objects[j]);
+            }
+            drained = true;
+        }
+
+        // evict in least-recently-used order until the heap is back under budget.
+        for (size_t j = 0; j < count && heap->HeapSizeUsed > heap->ResidencyBudget; ++j)
+        {
+            CG_EXEC_GROUP *group = NULL;
+            cg_handle_t    owner = list[j].Buffer != NULL ? list[j].Buffer->ExecutionGroup : list[j].Image->ExecutionGroup;
+            int            res   = CG_SUCCESS;
+            if ((group = cgObjectTableGet(&ctx->ExecGroupTable, owner)) == NULL || group->DeviceCount == 0)
+                res = CG_INVALID_STATE;
+            else
+                res = list[j].Buffer != NULL ? cgEvictBuffer(ctx, group, list[j].Buffer) : cgEvictImage(ctx, group, list[j].Image);
+            if (res != CG_SUCCESS && result == CG_SUCCESS)
+                result  = res;
+        }
+    }
+    ReleaseSRWLockExclusive(&ctx->ResidencyLock);
+    if (list != NULL)
+    {
+        cgFreeHostMemory(&ctx->HostAllocator, list, nmax * sizeof(CG_RESIDENCY_CANDIDATE), 0, CG_ALLOCATION_TYPE_TEMP);
+    }
+    return result;
+}
@@ -83,6 +83,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <stdio.h>
+#include <math.h>
 
 #include "cgfx.h"
 #include "cgfx_ext_win.h"
@@ -496,6 +497,650 @@ internal_function void cgfx_teardown(cgfx_state_t *cgfx)
     memset(cgfx, 0, sizeof(cgfx_state_t));
 }
 
+/// @summary Measure host memory read bandwidth between each pair of populated NUMA nodes. For each source 
+/// node, a buffer is committed on that node and then read by the calling thread while it is restricted to 
+/// the processors of each destination node in turn. Results are written to the debug output channel.
+/// @param buffer_size The number of bytes read on each pass.
+/// @param pass_count The number of passes over the buffer for each node pair.
+internal_function void numa_bandwidth_benchmark(size_t buffer_size, size_t pass_count)
+{
+    HANDLE         thread       = GetCurrentThread();
+    HANDLE         process      = GetCurrentProcess();
+    GROUP_AFFINITY old_affinity = {};
+    ULONG          highest_node = 0;
+    size_t         word_count   = buffer_size / sizeof(uint64_t);
+
+    if (!GetNumaHighestNodeNumber(&highest_node) || highest_node == 0)
+    {
+        dbg_printf("NUMA: Single-node system; no cross-node bandwidth to measure.\n");
+        return;
+    }
+    GetThreadGroupAffinity(thread, &old_affinity);
+    for (ULONG src_node = 0; src_node <= highest_node; ++src_node)
+    {
+        GROUP_AFFINITY src_mask = {};
+        uint64_t      *data     = NULL;
+        if (!GetNumaNodeProcessorMaskEx(USHORT(src_node), &src_mask) || src_mask.Mask == 0)
+            continue;
+        if ((data = (uint64_t*) VirtualAllocExNuma(process, NULL, buffer_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, src_node)) == NULL)
+        {
+            dbg_printf("NUMA: Unable to commit %Iu bytes on node %u.\n", buffer_size, src_node);
+            continue;
+        }
+        // fault the pages in from the source node, so placement doesn't rely on the preferred node alone.
+        SetThreadGroupAffinity(thread, &src_mask, NULL);
+        memset(data, 1, word_count * sizeof(uint64_t));
+
+        for (ULONG dst_node = 0; dst_node <= highest_node; ++dst_node)
+        {
+            GROUP_AFFINITY dst_mask = {};
+            uint64_t       checksum = 0;
+            if (!GetNumaNodeProcessorMaskEx(USHORT(dst_node), &dst_mask) || dst_mask.Mask == 0)
+                continue;
+
+            SetThreadGroupAffinity(thread, &dst_mask, NULL);
+            int64_t start = ticktime();
+            for (size_t pass = 0; pass < pass_count; ++pass)
+            {
+                for (size_t i = 0; i < word_count; ++i)
+                    checksum += data[i];
+            }
+            float   secs  = ticks_to_seconds(elapsed_ticks(start, ticktime()));
+            double  gbps  =(double(word_count * sizeof(uint64_t)) * double(pass_count)) / (double(secs) * 1.0e9);
+            dbg_printf("NUMA: Memory on node %u read from node %u: %6.2f GB/s%s (checksum %I64u)\n", src_node, dst_node, gbps, (src_node == dst_node) ? " [local]" : "", checksum);
+        }
+        VirtualFree(data, 0, MEM_RELEASE);
+    }
+    SetThreadGroupAffinity(thread, &old_affinity, NULL);
+}
+
+/// @summary Measure graphics pipeline creation time with the on-disk program cache disabled, cold (empty cache) and 
+/// warm (populated cache). The TEST01 pipeline is created and destroyed repeatedly; the cache directory is a folder 
+/// under the user temp directory which is emptied first. Results are written to the debug output channel.
+/// @param cgfx The CGFX state, with the rendering context current on the calling thread.
+/// @param pass_count The number of pipelines to create for the uncached and warm measurements.
+internal_function void pipeline_cache_benchmark(cgfx_state_t *cgfx, size_t pass_count)
+{
+    WIN32_FIND_DATAA        entry    = {};
+    cg_kernel_cache_stats_t stats    = {};
+    HANDLE                  find     = INVALID_HANDLE_VALUE;
+    char                    dir[MAX_PATH];
+    char                    pattern[MAX_PATH];
+    char                    path[MAX_PATH];
+    int                     res      = CG_SUCCESS;
+    int64_t                 start    = 0;
+    int64_t                 uncached = 0;
+    int64_t                 cold     = 0;
+    int64_t                 warm     = 0;
+
+    if (GetTempPathA(MAX_PATH, dir) == 0)
+        return;
+    strcat_s(dir, MAX_PATH, "cgfx_pipeline_cache");
+    CreateDirectoryA(dir, NULL);
+    // remove entries left behind by a previous run so the first cached pass is cold.
+    _snprintf_s(pattern, MAX_PATH, _TRUNCATE, "%s\\*.glbin", dir);
+    if ((find = FindFirstFileA(pattern, &entry)) != INVALID_HANDLE_VALUE)
+    {
+        do
+        {
+            _snprintf_s(path, MAX_PATH, _TRUNCATE, "%s\\%s", dir, entry.cFileName);
+            DeleteFileA(path);
+        } while (FindNextFileA(find, &entry));
+        FindClose(find);
+    }
+
+    // baseline: every pass links and reflects the program.
+    cgSetKernelCacheDirectory(cgfx->Context, NULL);
+    for (size_t i = 0; i < pass_count; ++i)
+    {
+        start = ticktime();
+        cg_handle_t gp = cgCreateGraphicsPipelineTest01(cgfx->Context, cgfx->GPUGroup, res);
+        uncached += elapsed_ticks(start, ticktime());
+        cgDeleteObject(cgfx->Context, gp);
+    }
+    if ((res = cgSetKernelCacheDirectory(cgfx->Context, dir)) != CG_SUCCESS)
+    {
+        dbg_printf("PIPELINE: Unable to enable the program cache in %s (%d).\n", dir, res);
+        return;
+    }
+    // the first cached pass misses and writes the entry; the remaining passes load it.
+    start = ticktime();
+    cgDeleteObject(cgfx->Context, cgCreateGraphicsPipelineTest01(cgfx->Context, cgfx->GPUGroup, res));
+    cold  = elapsed_ticks(start, ticktime());
+    for (size_t i = 0; i < pass_count; ++i)
+    {
+        start = ticktime();
+        cg_handle_t gp = cgCreateGraphicsPipelineTest01(cgfx->Context, cgfx->GPUGroup, res);
+        warm += elapsed_ticks(start, ticktime());
+        cgDeleteObject(cgfx->Context, gp);
+    }
+    cgGetContextInfo(cgfx->Context, CG_CONTEXT_KERNEL_CACHE_STATS, &stats, sizeof(stats), NULL);
+    cgSetKernelCacheDirectory(cgfx->Context, NULL);
+
+    dbg_printf("PIPELINE: Uncached: %8.3fms per pipeline (%Iu passes)\n", 1000.0f * ticks_to_seconds(uncached) / pass_count, pass_count);
+    dbg_printf("PIPELINE: Cold    : %8.3fms per pipeline (1 pass)\n"    , 1000.0f * ticks_to_seconds(cold));
+    dbg_printf("PIPELINE: Warm    : %8.3fms per pipeline (%Iu passes)\n", 1000.0f * ticks_to_seconds(warm) / pass_count, pass_count);
+    dbg_printf("PIPELINE: Cache   : %I64u lookups, %I64u hits, %I64u stores\n", stats.PipelineLookupCount, stats.PipelineHitCount, stats.PipelineStoreCount);
+    dbg_printf("PIPELINE: Link+reflect %8.3fms total, binary load %8.3fms total (shader compilation excluded)\n", stats.PipelineBuildNanos / 1.0e6, stats.PipelineLoadNanos / 1.0e6);
+}
+
+/// @summary Measure image upload throughput through an OpenCL image map and through a pixel unpack buffer on the graphics 
+/// queue, for an uncompressed and a block-compressed format. Each pass writes level 0 of the image in full and waits for 
+/// the copy to complete. Results are written to the debug output channel.
+/// @param cgfx The CGFX state, with the rendering context current on the calling thread.
+/// @param width The width of the image, in pixels.
+/// @param height The height of the image, in pixels.
+/// @param pass_count The number of timed uploads for each path and format.
+internal_function void upload_benchmark(cgfx_state_t *cgfx, size_t width, size_t height, size_t pass_count)
+{
+    static uint32_t    const formats[2]      = { DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_BC1_UNORM };
+    static char const *const format_names[2] = { "RGBA8", "BC1" };
+    uintptr_t   ctx      = cgfx->Context;
+    int         res      = CG_SUCCESS;
+    cg_handle_t pipeline = cgCreateGraphicsPipelineTest01(ctx, cgfx->GPUGroup, res);
+    cg_handle_t done     = cgCreateEvent(ctx, cgfx->GPUGroup, res);
+    cg_handle_t cb       = cgCreateCommandBuffer(ctx, CG_QUEUE_TYPE_GRAPHICS, res);
+    if (pipeline == CG_INVALID_HANDLE || done == CG_INVALID_HANDLE || cb == CG_INVALID_HANDLE)
+    {
+        dbg_printf("UPLOAD: Unable to create the pipeline (%d).\n", res);
+        return;
+    }
+    for (size_t f = 0; f < 2; ++f)
+    {
+        size_t      nbytes = cgImageSlicePitch(formats[f], width, height);
+        size_t      xyz[3] = { 0, 0, 0 };
+        size_t      whd[3] = { width, height, 1 };
+        size_t      row    = 0;
+        size_t      slice  = 0;
+        cg_handle_t image  = cgCreateImage(ctx, cgfx->GPUGroup, width, height, 1, 1, 1, formats[f], CG_MEMORY_OBJECT_KERNEL_GRAPHICS | CG_MEMORY_OBJECT_KERNEL_COMPUTE, CG_MEMORY_ACCESS_READ, CG_MEMORY_ACCESS_WRITE, CG_MEMORY_PLACEMENT_DEVICE, CG_MEMORY_UPDATE_PER_FRAME, res);
+        cg_handle_t pbo    = cgCreateDataBuffer(ctx, cgfx->GPUGroup, nbytes, CG_MEMORY_OBJECT_KERNEL_GRAPHICS | CG_MEMORY_OBJECT_KERNEL_COMPUTE, CG_MEMORY_ACCESS_READ, CG_MEMORY_ACCESS_WRITE, CG_MEMORY_PLACEMENT_PINNED, CG_MEMORY_UPDATE_PER_FRAME, res);
+        float       secs[2]= { 0.0f, 0.0f };
+        bool        valid  = true;
+        if (image == CG_INVALID_HANDLE || pbo == CG_INVALID_HANDLE)
+        {
+            dbg_printf("UPLOAD: %s: Unable to create the image and buffer (%d).\n", format_names[f], res);
+            cgDeleteObject(ctx, pbo);
+            cgDeleteObject(ctx, image);
+            continue;
+        }
+        cgBeginCommandBuffer(ctx, cb, 0);
+        cgGraphicsUploadImage(ctx, cb, pipeline, pbo, 0, 0, image, 0, xyz, whd, done, CG_INVALID_HANDLE);
+        cgEndCommandBuffer(ctx, cb);
+
+        // path 0 maps the image through OpenCL; path 1 fills the pinned buffer and copies on the graphics queue.
+        for (size_t path = 0; path < 2 && valid; ++path)
+        {
+            int64_t start = ticktime();
+            for (size_t pass = 0; pass < pass_count; ++pass)
+            {
+                cg_handle_t xfer = CG_INVALID_HANDLE;
+                void       *data = NULL;
+                if (path == 0)
+                    data = cgMapImageRegion(ctx, cgfx->GPUTransferQueue, image, CG_INVALID_HANDLE, xyz, whd, CG_MEMORY_ACCESS_WRITE, row, slice, res);
+                else
+                    data = cgMapDataBuffer (ctx, cgfx->GPUTransferQueue, pbo  , CG_INVALID_HANDLE, 0, nbytes, CG_MEMORY_ACCESS_WRITE, res);
+                if (data == NULL)
+                {
+                    dbg_printf("UPLOAD: %s: Map failed (%d).\n", format_names[f], res);
+                    valid = false;
+                    break;
+                }
+                // the image map may pad rows; rows of BC blocks cover four rows of pixels.
+                memset(data, int(pass & 0xFF), path == 0 ? row * (nbytes / cgImageRowPitch(formats[f], width)) : nbytes);
+                if (path == 0)
+                    cgUnmapImageRegion(ctx, cgfx->GPUTransferQueue, image, data, &xfer);
+                else
+                    cgUnmapDataBuffer (ctx, cgfx->GPUTransferQueue, pbo  , data, &xfer);
+                if (xfer != CG_INVALID_HANDLE)
+                {
+                    cgHostWaitForEvent(ctx, xfer);
+                    cgDeleteObject(ctx, xfer);
+                }
+                if (path == 1)
+                {
+                    cgExecuteCommandBuffer(ctx, cgfx->GPUGraphicsQueue, cb);
+                    cgHostWaitForEvent(ctx, done);
+                }
+            }
+            secs[path] = ticks_to_seconds(elapsed_ticks(start, ticktime())) / pass_count;
+        }
+        if (valid)
+        {
+            dbg_printf("UPLOAD: %-5s %Iux%Iu map  : %8.3fms, %8.2f MB/s\n", format_names[f], width, height, 1000.0f * secs[0], (nbytes / (1024.0 * 1024.0)) / secs[0]);
+            dbg_printf("UPLOAD: %-5s %Iux%Iu PBO  : %8.3fms, %8.2f MB/s\n", format_names[f], width, height, 1000.0f * secs[1], (nbytes / (1024.0 * 1024.0)) / secs[1]);
+        }
+        cgDeleteObject(ctx, pbo);
+        cgDeleteObject(ctx, image);
+    }
+    cgDeleteObject(ctx, cb);
+    cgDeleteObject(ctx, done);
+    cgDeleteObject(ctx, pipeline);
+}
+
+/// @summary Measure the throughput of the PRIMITIVES compute pipeline on the devices of one execution group. Each 
+/// primitive is run on 32-bit data sets from 64K to 16M elements; throughput is reported as input bytes processed per 
+/// second (keys and values for SORT, values and flags for COMPACT). Results are written to the debug output channel.
+/// @param cgfx The CGFX state.
+/// @param name A short name identifying the execution group in the output.
+/// @param group The handle of the execution group to run on.
+/// @param compute_queue The handle of the compute queue used to execute the primitives.
+/// @param transfer_queue The handle of the transfer queue used to initialize the input data.
+/// @param pass_count The number of timed executions of each primitive at each size.
+internal_function void primitives_benchmark_group(cgfx_state_t *cgfx, char const *name, cg_handle_t group, cg_handle_t compute_queue, cg_handle_t transfer_queue, size_t pass_count)
+{
+    static char const *op_names[4] = { "SCAN", "REDUCE", "COMPACT", "SORT" };
+    uintptr_t   ctx      = cgfx->Context;
+    int         res      = CG_SUCCESS;
+    cg_handle_t pipeline = cgCreateComputePipelinePrimitives(ctx, group, res);
+    cg_handle_t done     = cgCreateEvent(ctx, group, res);
+    if (pipeline == CG_INVALID_HANDLE || done == CG_INVALID_HANDLE)
+    {
+        dbg_printf("PRIMITIVES: %s: Unable to create the pipeline (%d).\n", name, res);
+        cgDeleteObject(ctx, done);
+        cgDeleteObject(ctx, pipeline);
+        return;
+    }
+    for (size_t log2n = 16; log2n <= 24; log2n += 2)
+    {
+        size_t const count  = size_t(1) << log2n;
+        size_t const nbytes = count * sizeof(uint32_t);
+        cg_handle_t  keys   = cgCreateDataBuffer(ctx, group, nbytes, CG_MEMORY_OBJECT_KERNEL_COMPUTE, CG_MEMORY_ACCESS_READ_WRITE, CG_MEMORY_ACCESS_WRITE, CG_MEMORY_PLACEMENT_DEVICE, CG_MEMORY_UPDATE_ONCE, res);
+        cg_handle_t  flags  = cgCreateDataBuffer(ctx, group, nbytes, CG_MEMORY_OBJECT_KERNEL_COMPUTE, CG_MEMORY_ACCESS_READ      , CG_MEMORY_ACCESS_WRITE, CG_MEMORY_PLACEMENT_DEVICE, CG_MEMORY_UPDATE_ONCE, res);
+        cg_handle_t  values = cgCreateDataBuffer(ctx, group, nbytes, CG_MEMORY_OBJECT_KERNEL_COMPUTE, CG_MEMORY_ACCESS_READ_WRITE, CG_MEMORY_ACCESS_WRITE, CG_MEMORY_PLACEMENT_DEVICE, CG_MEMORY_UPDATE_ONCE, res);
+        cg_handle_t  output = cgCreateDataBuffer(ctx, group, nbytes, CG_MEMORY_OBJECT_KERNEL_COMPUTE, CG_MEMORY_ACCESS_READ_WRITE, CG_MEMORY_ACCESS_NONE , CG_MEMORY_PLACEMENT_DEVICE, CG_MEMORY_UPDATE_ONCE, res);
+        cg_handle_t  total  = cgCreateDataBuffer(ctx, group, sizeof(uint32_t), CG_MEMORY_OBJECT_KERNEL_COMPUTE, CG_MEMORY_ACCESS_WRITE, CG_MEMORY_ACCESS_NONE, CG_MEMORY_PLACEMENT_DEVICE, CG_MEMORY_UPDATE_ONCE, res);
+        cg_handle_t  inputs[3] = { keys, flags, values };
+        uint32_t     seed   = 0x9E3779B9U;
+        bool         valid  = true;
+
+        if (keys == CG_INVALID_HANDLE || flags == CG_INVALID_HANDLE || values == CG_INVALID_HANDLE || output == CG_INVALID_HANDLE || total == CG_INVALID_HANDLE)
+        {
+            dbg_printf("PRIMITIVES: %s: Unable to allocate buffers for %Iu elements (%d).\n", name, count, res);
+            valid = false;
+        }
+        for (size_t b = 0; b < 3 && valid; ++b)
+        {   // keys are random, flags keep about half of the values and values are the element index.
+            cg_handle_t xfer = CG_INVALID_HANDLE;
+            uint32_t   *data = (uint32_t*) cgMapDataBuffer(ctx, transfer_queue, inputs[b], CG_INVALID_HANDLE, 0, nbytes, CG_MEMORY_ACCESS_WRITE, res);
+            if (data == NULL)
+            {
+                valid = false;
+                break;
+            }
+            for (size_t i = 0; i < count; ++i)
+            {
+                seed   ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+                data[i] = (b == 0) ? seed : ((b == 1) ? (seed & 1) : uint32_t(i));
+            }
+            cgUnmapDataBuffer(ctx, transfer_queue, inputs[b], data, &xfer);
+            if (xfer != CG_INVALID_HANDLE)
+            {
+                cgHostWaitForEvent(ctx, xfer);
+                cgDeleteObject(ctx, xfer);
+            }
+        }
+        // SORT runs last because it modifies the keys in-place.
+        for (int op = 0; op < 4 && valid; ++op)
+        {
+            cg_handle_t cb    = cgCreateCommandBuffer(ctx, CG_QUEUE_TYPE_COMPUTE, res);
+            size_t      bytes = nbytes;
+            int64_t     start = 0;
+            float       secs  = 0.0f;
+
+            cgBeginCommandBuffer(ctx, cb, 0);
+            switch (op)
+            {
+            case 0: res = cgComputeScan   (ctx, cb, pipeline, keys, output, count, false, done, CG_INVALID_HANDLE); break;
+            case 1: res = cgComputeReduce (ctx, cb, pipeline, keys, count, CG_COMPUTE_PRIMITIVE_UINT32, CG_COMPUTE_PRIMITIVE_MAX, total, 0, done, CG_INVALID_HANDLE); break;
+            case 2: res = cgComputeCompact(ctx, cb, pipeline, values, flags, count, output, total, done, CG_INVALID_HANDLE); bytes *= 2; break;
+            case 3: res = cgComputeSort   (ctx, cb, pipeline, keys, values, count, 32, done, CG_INVALID_HANDLE); bytes *= 2; break;
+            }
+            cgEndCommandBuffer(ctx, cb);
+            if (res != CG_SUCCESS)
+            {
+                dbg_printf("PRIMITIVES: %s: Unable to record %s (%d).\n", name, op_names[op], res);
+                cgDeleteObject(ctx, cb);
+                continue;
+            }
+            // the first execution grows the scratch buffer and is not timed.
+            cgExecuteCommandBuffer(ctx, compute_queue, cb);
+            cgHostWaitForEvent(ctx, done);
+            start = ticktime();
+            for (size_t pass = 0; pass < pass_count; ++pass)
+            {
+                cgExecuteCommandBuffer(ctx, compute_queue, cb);
+                cgHostWaitForEvent(ctx, done);
+            }
+            secs = ticks_to_seconds(elapsed_ticks(start, ticktime()));
+            dbg_printf("PRIMITIVES: %s %-7s %9Iu elements (%7.2f MB): %8.3fms, %7.2f GB/s\n", name, op_names[op], count, bytes / (1024.0 * 1024.0), 1000.0f * secs / pass_count, (double(bytes) * double(pass_count)) / (double(secs) * 1.0e9));
+            cgDeleteObject(ctx, cb);
+        }
+        cgDeleteObject(ctx, total);
+        cgDeleteObject(ctx, output);
+        cgDeleteObject(ctx, values);
+        cgDeleteObject(ctx, flags);
+        cgDeleteObject(ctx, keys);
+    }
+    cgDeleteObject(ctx, done);
+    cgDeleteObject(ctx, pipeline);
+}
+
+/// @summary Measure host mipmap generation for each supported format, comparing the scalar kernels on one thread with 
+/// the SIMD kernels on one thread and on every logical processor. A full mip chain is generated for a 2D image with 
+/// @a item_count array items on each pass. Results are written to the debug output channel.
+/// @param width The width of level 0, in pixels.
+/// @param height The height of level 0, in pixels.
+/// @param item_count The number of array items.
+/// @param pass_count The number of timed passes for each configuration.
+internal_function void mipmap_benchmark(size_t width, size_t height, size_t item_count, size_t pass_count)
+{
+    static uint32_t    const formats[4]      = { DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_R16G16B16A16_FLOAT, DXGI_FORMAT_R32_FLOAT };
+    static char const *const format_names[4] = { "RGBA8", "RGBA8_SRGB", "RGBA16F", "R32F" };
+    static char const *const config_names[3] = { "Scalar x1", "SIMD   x1", "SIMD   xN" };
+    size_t level_count = 1;
+    while ((width >> level_count) > 0 || (height >> level_count) > 0)
+        level_count++;
+
+    for (size_t f = 0; f < 4; ++f)
+    {
+        uint8_t *data       = NULL;
+        size_t   item_pitch = 0;
+        size_t   data_size  = 0;
+        size_t   pixels     = 0;
+        float    base_secs  = 0.0f;
+        for (size_t i = 0; i < level_count; ++i)
+        {
+            size_t w = cgImageLevelDimension(formats[f], width , i);
+            size_t h = cgImageLevelDimension(formats[f], height, i);
+            item_pitch += cgImageSlicePitch(formats[f], w, h);
+            pixels     += (i > 0) ? w * h * item_count : 0;
+        }
+        data_size = item_pitch * item_count;
+        if ((data = (uint8_t*) VirtualAlloc(NULL, data_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE)) == NULL)
+        {
+            dbg_printf("MIPMAP: Unable to allocate %Iu bytes.\n", data_size);
+            return;
+        }
+        for (size_t i = 0; i < data_size; ++i)
+        {   // fill with finite values for every format; the high byte of each float and half stays small.
+            data[i] = uint8_t((i * 2654435761U) >> 24) & ((i & 1) ? 0x3B : 0xFF);
+        }
+        for (size_t c = 0; c < 3; ++c)
+        {
+            size_t   threads = (c == 2) ? 0 : 1;
+            uint32_t flags   = (c == 0) ? CG_HOST_MIPMAP_FLAG_SCALAR : CG_HOST_MIPMAP_FLAGS_NONE;
+            int      res     =  cgGenerateHostMipmaps(data, data_size, formats[f], width, height, item_count, level_count, threads, flags);
+            if (res != CG_SUCCESS)
+            {
+                dbg_printf("MIPMAP: %-10s %s: Failed (%d).\n", format_names[f], config_names[c], res);
+                continue;
+            }
+            int64_t start = ticktime();
+            for (size_t pass = 0; pass < pass_count; ++pass)
+            {
+                cgGenerateHostMipmaps(data, data_size, formats[f], width, height, item_count, level_count, threads, flags);
+            }
+            float secs = ticks_to_seconds(elapsed_ticks(start, ticktime())) / pass_count;
+            if (c == 0) base_secs = secs;
+            dbg_printf("MIPMAP: %-10s %Iux%Iu x%Iu %s: %8.3fms, %8.2f MPixel/s, %5.2fx\n", format_names[f], width, height, item_count, config_names[c], 1000.0f * secs, (double(pixels) / double(secs)) / 1.0e6, base_secs / secs);
+        }
+        VirtualFree(data, 0, MEM_RELEASE);
+    }
+}
+
+/// @summary Measure host block compression throughput and quality for each supported format and quality level, on one 
+/// thread and on every logical processor. The source is a synthetic RGBA image with smooth gradients, hard edges and 
+/// punch-through alpha. Quality is reported as PSNR over the channels stored by each format. Results are written to the 
+/// debug output channel.
+/// @param width The width of the image, in pixels.
+/// @param height The height of the image, in pixels.
+/// @param pass_count The number of timed passes for each configuration.
+internal_function void bc_benchmark(size_t width, size_t height, size_t pass_count)
+{
+    static uint32_t    const formats[5]       = { DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC3_UNORM, DXGI_FORMAT_BC4_UNORM, DXGI_FORMAT_BC5_UNORM, DXGI_FORMAT_BC7_UNORM };
+    static char const *const format_names[5]  = { "BC1", "BC3", "BC4", "BC5", "BC7" };
+    static size_t      const channels[5]      = { 3, 4, 1, 2, 4 };
+    static char const *const quality_names[3] = { "fast  ", "normal", "high  " };
+    size_t   src_size = width * height * 4;
+    size_t   dst_size = cgImageSlicePitch(DXGI_FORMAT_BC7_UNORM, width, height);
+    uint8_t *src      = (uint8_t*) VirtualAlloc(NULL, src_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    uint8_t *dst      = (uint8_t*) VirtualAlloc(NULL, dst_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (src == NULL || dst == NULL)
+    {
+        dbg_printf("BC: Unable to allocate %Iu bytes.\n", src_size + dst_size);
+        if (dst != NULL) VirtualFree(dst, 0, MEM_RELEASE);
+        if (src != NULL) VirtualFree(src, 0, MEM_RELEASE);
+        return;
+    }
+    for (size_t y = 0; y < height; ++y)
+    {
+        for (size_t x = 0; x < width; ++x)
+        {
+            uint8_t *p  = src + (y * width + x) * 4;
+            float    fx = float(x) / float(width);
+            float    fy = float(y) / float(height);
+            p[0] = uint8_t(255.0f * (0.5f + 0.5f * sinf(fx * 20.0f + fy * 3.0f)));
+            p[1] = uint8_t(255.0f * fy);
+            p[2] = uint8_t(255.0f * (0.5f + 0.5f * cosf(fx * fy * 40.0f)));
+            p[3] = (((x / 64) + (y / 64)) % 7 == 3) ? (((x ^ y) & 8) ? 0 : 255) : uint8_t(255.0f * fx);
+        }
+    }
+    for (size_t f = 0; f < 5; ++f)
+    {
+        for (int q = CG_BLOCK_COMPRESSION_QUALITY_FAST; q <= CG_BLOCK_COMPRESSION_QUALITY_HIGH; ++q)
+        {
+            float base_secs = 0.0f;
+            for (size_t c = 0; c < 2; ++c)
+            {
+                size_t   threads = (c == 0) ? 1 : 0;
+                uint64_t sse     =  0;
+                int      res     =  cgCompressHostImage(dst, dst_size, 0, formats[f], src, 0, width, height, q, threads, &sse);
+                if (res != CG_SUCCESS)
+                {
+                    dbg_printf("BC: %s %s: Failed (%d).\n", format_names[f], quality_names[q], res);
+                    break;
+                }
+                int64_t start = ticktime();
+                for (size_t pass = 0; pass < pass_count; ++pass)
+                {
+                    cgCompressHostImage(dst, dst_size, 0, formats[f], src, 0, width, height, q, threads, NULL);
+                }
+                float  secs = ticks_to_seconds(elapsed_ticks(start, ticktime())) / pass_count;
+                double mse  = double(sse) / double(width * height * channels[f]);
+                double psnr = mse > 0.0 ? 10.0 * log10((255.0 * 255.0) / mse) : 99.0;
+                if (c == 0) base_secs = secs;
+                dbg_printf("BC: %s %s %Iux%Iu x%s: %8.3fms, %8.2f MPixel/s, %5.2fx, PSNR %6.2fdB\n", format_names[f], quality_names[q], width, height, (c == 0) ? "1" : "N", 1000.0f * secs, (double(width * height) / double(secs)) / 1.0e6, base_secs / secs, psnr);
+            }
+        }
+    }
+    VirtualFree(dst, 0, MEM_RELEASE);
+    VirtualFree(src, 0, MEM_RELEASE);
+}
+
+/// @summary Measure offscreen rendering and readback throughput on each GPU, as done by a server-side render worker 
+/// with no monitor attached. Each GPU is placed in its own execution group created with CG_EXECUTION_GROUP_OFFSCREEN. 
+/// Every frame renders a quad into a shared image and the result is read back to the host, first by mapping the image 
+/// after each frame, then by reading into one of two pixel pack buffers while the next frame renders. Results are 
+/// written to the debug output channel.
+/// @param width The width of the render target, in pixels.
+/// @param height The height of the render target, in pixels.
+/// @param frame_count The number of timed frames rendered by each worker.
+internal_function void headless_render_benchmark(size_t width, size_t height, size_t frame_count)
+{
+    cg_application_info_t  app           = {};
+    cg_cpu_partition_t     cpu_partition = {};
+    cg_handle_t            gpus[8];
+    uintptr_t              ctx           = 0;
+    size_t                 num_devices   = 0;
+    size_t                 num_gpus      = 0;
+    int                    res           = CG_SUCCESS;
+
+    app.AppName        = "cgfxTest";
+    app.AppVersion     =  CG_MAKE_VERSION(1, 0, 0);
+    app.DriverName     = "cgfxTest Driver";
+    app.DriverVersion  =  CG_MAKE_VERSION(1, 0, 0);
+    app.ApiVersion     =  CG_API_VERSION;
+    cpu_partition.PartitionType = CG_CPU_PARTITION_NONE;
+    if ((res = cgEnumerateDevices(&app, NULL, &cpu_partition, num_devices, NULL, 0, ctx)) != CG_SUCCESS)
+    {
+        dbg_printf("HEADLESS: Unable to enumerate devices (%d).\n", res);
+        return;
+    }
+    cgGetGPUDevices(ctx, num_gpus, 8, gpus);
+    for (size_t g = 0; g < num_gpus && g < 8; ++g)
+    {
+        cg_execution_group_t   group_def        = {};
+        size_t                 attrib_counts[1] = { 2 };
+        cg_vertex_attribute_t  attrib_pos       = { 0, 0, CG_ATTRIBUTE_FORMAT_FLOAT32, 3,  0, false };
+        cg_vertex_attribute_t  attrib_clr       = { 0, 1, CG_ATTRIBUTE_FORMAT_UINT8  , 4, 12, true  };
+        cg_vertex_attribute_t  attrib_buf0[2]   = { attrib_pos, attrib_clr };
+        cg_vertex_attribute_t *attrib_data[1]   = { attrib_buf0 };
+        cg_handle_t            display          = CG_INVALID_HANDLE;
+        cg_handle_t            group            = CG_INVALID_HANDLE;
+        bool                   headless         = false;
+
+        group_def.RootDevice      = gpus[g];
+        group_def.CreateFlags     = CG_EXECUTION_GROUP_OFFSCREEN;
+        if ((group = cgCreateExecutionGroup(ctx, &group_def, res)) == CG_INVALID_HANDLE)
+        {
+            dbg_printf("HEADLESS: GPU %Iu: Unable to create an offscreen execution group (%s).\n", g, cgResultString(res));
+            continue;
+        }
+        cgGetExecutionGroupInfo(ctx, group, CG_EXEC_GROUP_ATTACHED_DISPLAYS, &display, sizeof(cg_handle_t), NULL);
+        cgGetDisplayInfo(ctx, display, CG_DISPLAY_HEADLESS, &headless, sizeof(bool), NULL);
+        cgSetDisplayDrawableEXT(ctx, display, NULL);
+
+        cg_handle_t gfx_queue = cgGetQueueForDevice(ctx, gpus[g], CG_QUEUE_TYPE_GRAPHICS, res);
+        cg_handle_t xfer_queue= cgGetQueueForDevice(ctx, gpus[g], CG_QUEUE_TYPE_TRANSFER, res);
+        cg_handle_t target    = cgCreateImage(ctx, group, width, height, 1, 1, 1, DXGI_FORMAT_R8G8B8A8_UNORM, CG_MEMORY_OBJECT_KERNEL_GRAPHICS | CG_MEMORY_OBJECT_KERNEL_COMPUTE, CG_MEMORY_ACCESS_READ_WRITE, CG_MEMORY_ACCESS_READ, CG_MEMORY_PLACEMENT_DEVICE, CG_MEMORY_UPDATE_PER_FRAME, res);
+        cg_handle_t vb        = cgCreateDataBuffer(ctx, group, sizeof(CG_GFX_TEST01_VERTEX) * 4, CG_MEMORY_OBJECT_KERNEL_GRAPHICS | CG_MEMORY_OBJECT_KERNEL_COMPUTE, CG_MEMORY_ACCESS_READ, CG_MEMORY_ACCESS_WRITE, CG_MEMORY_PLACEMENT_DEVICE, CG_MEMORY_UPDATE_ONCE, res);
+        cg_handle_t ib        = cgCreateDataBuffer(ctx, group, sizeof(uint16_t) * 6, CG_MEMORY_OBJECT_KERNEL_GRAPHICS | CG_MEMORY_OBJECT_KERNEL_COMPUTE, CG_MEMORY_ACCESS_READ, CG_MEMORY_ACCESS_WRITE, CG_MEMORY_PLACEMENT_DEVICE, CG_MEMORY_UPDATE_ONCE, res);
+        cg_handle_t vs        = cgCreateVertexDataSource(ctx, group, 1, &vb, ib, attrib_counts, (cg_vertex_attribute_t const**) attrib_data, res);
+        cg_handle_t gp        = cgCreateGraphicsPipelineTest01(ctx, group, res);
+        cg_handle_t cb        = cgCreateCommandBuffer(ctx, CG_QUEUE_TYPE_GRAPHICS, res);
+        cg_handle_t done      = cgCreateEvent(ctx, group, res);
+        size_t      nbytes    = cgImageSlicePitch(DXGI_FORMAT_R8G8B8A8_UNORM, width, height);
+        cg_handle_t pbo[2];
+        cg_handle_t pbo_cb[2];
+        cg_handle_t pbo_done[2];
+        for (size_t i = 0; i < 2; ++i)
+        {
+            pbo[i]      = cgCreateDataBuffer(ctx, group, nbytes, CG_MEMORY_OBJECT_KERNEL_GRAPHICS | CG_MEMORY_OBJECT_KERNEL_COMPUTE, CG_MEMORY_ACCESS_WRITE, CG_MEMORY_ACCESS_READ, CG_MEMORY_PLACEMENT_PINNED, CG_MEMORY_UPDATE_PER_FRAME, res);
+            pbo_cb[i]   = cgCreateCommandBuffer(ctx, CG_QUEUE_TYPE_GRAPHICS, res);
+            pbo_done[i] = cgCreateEvent(ctx, group, res);
+        }
+        if (target == CG_INVALID_HANDLE || vs == CG_INVALID_HANDLE || gp == CG_INVALID_HANDLE || done == CG_INVALID_HANDLE)
+        {
+            dbg_printf("HEADLESS: GPU %Iu: Unable to create rendering resources (%s).\n", g, cgResultString(res));
+            cgSetDisplayDrawableEXT(ctx, CG_INVALID_HANDLE, NULL);
+            continue;
+        }
+
+        // a quad covering the middle of the target, in pixel coordinates with the origin at the upper-left.
+        CG_GFX_TEST01_VERTEX *vtx = (CG_GFX_TEST01_VERTEX*) cgMapDataBuffer(ctx, xfer_queue, vb, CG_INVALID_HANDLE, 0, sizeof(CG_GFX_TEST01_VERTEX) * 4, CG_MEMORY_ACCESS_WRITE, res);
+        if (vtx != NULL)
+        {
+            float const x0 = width * 0.25f, x1 = width * 0.75f;
+            float const y0 = height* 0.25f, y1 = height* 0.75f;
+            vtx[0].Position[0] = x0; vtx[0].Position[1] = y0; vtx[0].Position[2] = 0.0f; vtx[0].RGBA = 0xFF0000FF;
+            vtx[1].Position[0] = x1; vtx[1].Position[1] = y0; vtx[1].Position[2] = 0.0f; vtx[1].RGBA = 0xFFFF00FF;
+            vtx[2].Position[0] = x1; vtx[2].Position[1] = y1; vtx[2].Position[2] = 0.0f; vtx[2].RGBA = 0xFF00FFFF;
+            vtx[3].Position[0] = x0; vtx[3].Position[1] = y1; vtx[3].Position[2] = 0.0f; vtx[3].RGBA = 0xFFFFFFFF;
+            cgUnmapDataBuffer(ctx, xfer_queue, vb, vtx, NULL);
+        }
+        uint16_t *idx = (uint16_t*) cgMapDataBuffer(ctx, xfer_queue, ib, CG_INVALID_HANDLE, 0, sizeof(uint16_t) * 6, CG_MEMORY_ACCESS_WRITE, res);
+        if (idx != NULL)
+        {
+            idx[0] = 0; idx[1] = 3; idx[2] = 2;
+            idx[3] = 0; idx[4] = 2; idx[5] = 1;
+            cgUnmapDataBuffer(ctx, xfer_queue, ib, idx, NULL);
+        }
+
+        float mvp[16];
+        memset(mvp, 0, sizeof(mvp));
+        mvp[ 0] = 2.0f / float(width);
+        mvp[ 5] =-2.0f / float(height);
+        mvp[10] = 1.0f; mvp[12] =-1.0f; mvp[13] = 1.0f; mvp[15] = 1.0f;
+        cgBeginCommandBuffer(ctx, cb, 0);
+        cgGraphicsSetRenderTarget(ctx, cb, gp, target, CG_INVALID_HANDLE, 0, NULL, CG_INVALID_HANDLE, CG_INVALID_HANDLE);
+        cgGraphicsTest01SetViewport(ctx, cb, gp, 0, 0, int(width), int(height), CG_INVALID_HANDLE, CG_INVALID_HANDLE);
+        cgGraphicsTest01SetProjection(ctx, cb, gp, mvp, CG_INVALID_HANDLE, CG_INVALID_HANDLE);
+        cgGraphicsTest01DrawTriangles(ctx, cb, gp, vs, 0, 5, 0, 2, done, CG_INVALID_HANDLE);
+        cgEndCommandBuffer(ctx, cb);
+        for (size_t i = 0; i < 2; ++i)
+        {
+            cgBeginCommandBuffer(ctx, pbo_cb[i], 0);
+            cgGraphicsSetRenderTarget(ctx, pbo_cb[i], gp, target, CG_INVALID_HANDLE, 0, NULL, CG_INVALID_HANDLE, CG_INVALID_HANDLE);
+            cgGraphicsTest01SetViewport(ctx, pbo_cb[i], gp, 0, 0, int(width), int(height), CG_INVALID_HANDLE, CG_INVALID_HANDLE);
+            cgGraphicsTest01SetProjection(ctx, pbo_cb[i], gp, mvp, CG_INVALID_HANDLE, CG_INVALID_HANDLE);
+            cgGraphicsTest01DrawTriangles(ctx, pbo_cb[i], gp, vs, 0, 5, 0, 2, CG_INVALID_HANDLE, CG_INVALID_HANDLE);
+            cgGraphicsReadPixels(ctx, pbo_cb[i], gp, CG_INVALID_HANDLE, 0, 0, 0, width, height, pbo[i], 0, pbo_done[i], CG_INVALID_HANDLE);
+            cgEndCommandBuffer(ctx, pbo_cb[i]);
+        }
+
+        // each frame is rendered, then read back in full before the next frame starts, as a thumbnail worker would.
+        size_t  xyz[3]  = { 0, 0, 0 };
+        size_t  whd[3]  = { width, height, 1 };
+        size_t  row     = 0;
+        size_t  slice   = 0;
+        size_t  frames  = 0;
+        int64_t start   = ticktime();
+        for (size_t frame = 0; frame < frame_count; ++frame)
+        {
+            cg_handle_t xfer = CG_INVALID_HANDLE;
+            void       *px   = NULL;
+            if ((res = cgExecuteCommandBuffer(ctx, gfx_queue, cb)) != CG_SUCCESS)
+                break;
+            if ((px = cgMapImageRegion(ctx, xfer_queue, target, done, xyz, whd, CG_MEMORY_ACCESS_READ, row, slice, res)) == NULL)
+                break;
+            cgUnmapImageRegion(ctx, xfer_queue, target, px, &xfer);
+            if (xfer != CG_INVALID_HANDLE)
+            {
+                cgHostWaitForEvent(ctx, xfer);
+                cgDeleteObject(ctx, xfer);
+            }
+            frames++;
+        }
+        float secs = ticks_to_seconds(elapsed_ticks(start, ticktime()));
+        if (frames == frame_count && secs > 0.0f)
+            dbg_printf("HEADLESS: GPU %Iu (%s) %Iux%Iu: %8.3fms per frame, %8.2f frames/s, %8.2f MPixel/s read back\n", g, headless ? "headless" : "display", width, height, 1000.0f * secs / frames, frames / secs, (double(width * height) * frames / double(secs)) / 1.0e6);
+        else
+            dbg_printf("HEADLESS: GPU %Iu: Frame %Iu failed (%s).\n", g, frames, cgResultString(res));
+
+        // frame N+1 renders while the pixels of frame N are copied into the other pack buffer.
+        frames = 0;
+        start  = ticktime();
+        for (size_t frame = 0; frame <= frame_count; ++frame)
+        {
+            if (frame < frame_count && (res = cgExecuteCommandBuffer(ctx, gfx_queue, pbo_cb[frame & 1])) != CG_SUCCESS)
+                break;
+            if (frame > 0)
+            {
+                size_t      slot = (frame - 1) & 1;
+                cg_handle_t xfer = CG_INVALID_HANDLE;
+                void       *px   = cgMapDataBuffer(ctx, xfer_queue, pbo[slot], pbo_done[slot], 0, nbytes, CG_MEMORY_ACCESS_READ, res);
+                if (px == NULL)
+                    break;
+                cgUnmapDataBuffer(ctx, xfer_queue, pbo[slot], px, &xfer);
+                if (xfer != CG_INVALID_HANDLE)
+                {
+                    cgHostWaitForEvent(ctx, xfer);
+                    cgDeleteObject(ctx, xfer);
+                }
+                frames++;
+            }
+        }
+        secs = ticks_to_seconds(elapsed_ticks(start, ticktime()));
+        if (frames == frame_count && secs > 0.0f)
+            dbg_printf("HEADLESS: GPU %Iu (%s) %Iux%Iu PBOx2: %8.3fms per frame, %8.2f frames/s, %8.2f MPixel/s read back\n", g, headless ? "headless" : "display", width, height, 1000.0f * secs / frames, frames / secs, (double(width * height) * frames / double(secs)) / 1.0e6);
+        else
+            dbg_printf("HEADLESS: GPU %Iu: PBO frame %Iu failed (%s).\n", g, frames, cgResultString(res));
+        cgSetDisplayDrawableEXT(ctx, CG_INVALID_HANDLE, NULL);
+    }
+    // destroying the context frees every group and the objects created in them.
+    cgDestroyContext(ctx);
+}
+
 /*////////////////////////
 //   Public Functions   //
 ////////////////////////*/
@@ -514,7 +1159,6 @@ int CALLBACK WinMain(HINSTANCE hInstance, HINSTANCE hPrev, LPSTR lpCmdLine, int
     int cgres  = CG_SUCCESS;
     int result = 0; // return zero if the message loop isn't entered.
     UNREFERENCED_PARAMETER(hPrev);
-    UNREFERENCED_PARAMETER(lpCmdLine);
     UNREFERENCED_PARAMETER(nCmdShow);
 
     // query the clock frequency of the high-resolution timer.
@@ -522,6 +1166,30 @@ int CALLBACK WinMain(HINSTANCE hInstance, HINSTANCE hPrev, LPSTR lpCmdLine, int
     QueryPerformanceFrequency(&clock_frequency);
     Global_ClockFrequency = clock_frequency.QuadPart;
 
+    // benchmark modes run to completion and exit without creating a window.
+    if (lpCmdLine != NULL && strstr(lpCmdLine, "--bench-numa") != NULL)
+    {   // 256MB per node, enough to defeat the last-level cache.
+        numa_bandwidth_benchmark(256 * 1024 * 1024, 8);
+        return 0;
+    }
+    if (lpCmdLine != NULL && strstr(lpCmdLine, "--bench-mipmap") != NULL)
+    {   // a single large image, then a texture array with more items than threads.
+        mipmap_benchmark(4096, 4096, 1 , 8);
+        mipmap_benchmark(1024, 1024, 32, 8);
+        return 0;
+    }
+    if (lpCmdLine != NULL && strstr(lpCmdLine, "--bench-bc") != NULL)
+    {
+        bc_benchmark(2048, 2048, 4);
+        return 0;
+    }
+    if (lpCmdLine != NULL && strstr(lpCmdLine, "--bench-headless") != NULL)
+    {   // a thumbnail-sized and a full HD target.
+        headless_render_benchmark(256 , 256 , 256);
+        headless_render_benchmark(1920, 1080, 64);
+        return 0;
+    }
+
     // set the scheduler granularity to 1ms for more accurate Sleep.
     UINT desired_granularity = 1; // millisecond
     BOOL sleep_is_granular   =(timeBeginPeriod(desired_granularity) == TIMERR_NOERROR);
@@ -533,6 +1201,30 @@ int CALLBACK WinMain(HINSTANCE hInstance, HINSTANCE hPrev, LPSTR lpCmdLine, int
         return 0;
     }
 
+    // benchmark modes that need a rendering context run after setup.
+    if (lpCmdLine != NULL && strstr(lpCmdLine, "--bench-pipeline") != NULL)
+    {
+        cgSetActiveDrawableEXT(Global_CGFX.Context, Global_CGFX.Drawable);
+        pipeline_cache_benchmark(&Global_CGFX, 16);
+        cgfx_teardown(&Global_CGFX);
+        return 0;
+    }
+    if (lpCmdLine != NULL && strstr(lpCmdLine, "--bench-upload") != NULL)
+    {
+        cgSetActiveDrawableEXT(Global_CGFX.Context, Global_CGFX.Drawable);
+        upload_benchmark(&Global_CGFX, 4096, 4096, 8);
+        cgfx_teardown(&Global_CGFX);
+        return 0;
+    }
+    if (lpCmdLine != NULL && strstr(lpCmdLine, "--bench-primitives") != NULL)
+    {
+        primitives_benchmark_group(&Global_CGFX, "GPU", Global_CGFX.GPUGroup, Global_CGFX.GPUComputeQueue, Global_CGFX.GPUTransferQueue, 10);
+        if (Global_CGFX.CPUGroup != CG_INVALID_HANDLE)
+            primitives_benchmark_group(&Global_CGFX, "CPU", Global_CGFX.CPUGroup, Global_CGFX.CPUComputeQueue, Global_CGFX.CPUTransferQueue, 10);
+        cgfx_teardown(&Global_CGFX);
+        return 0;
+    }
+
     cg_handle_t vb = CG_INVALID_HANDLE;
     cg_handle_t ib = CG_INVALID_HANDLE;
     cg_handle_t vs = CG_INVALID_HANDLE;
@@ -614,11 +1306,14 @@ int CALLBACK WinMain(HINSTANCE hInstance, HINSTANCE hPrev, LPSTR lpCmdLine, int
 
     // initialize timer snapshots used to throttle update rate.
     int64_t last_clock     =  ticktime();
-    int64_t flip_clock     =  ticktime();
 
     int64_t frame_update_time = ticktime();
     size_t  frame_index = 0;
 
+    // allow one frame to be rendered while the next is being built; the display 
+    // extension records frame timing and input latency for each present.
+    cgSetFramePacingEXT(Global_CGFX.Context, Global_CGFX.Display, 1);
+
     // run the main window message pump and user interface loop.
     while (Global_IsRunning)
     {   // dispatch Windows messages while messages are waiting.
@@ -634,6 +1329,11 @@ int CALLBACK WinMain(HINSTANCE hInstance, HINSTANCE hPrev, LPSTR lpCmdLine, int
                 Global_IsRunning = false;
                 break;
             default:
+                if ((msg.message >= WM_KEYFIRST   && msg.message <= WM_KEYLAST) || 
+                    (msg.message >= WM_MOUSEFIRST && msg.message <= WM_MOUSELAST))
+                {   // the next frame is the first that can reflect this input.
+                    cgMarkFrameInputEXT(Global_CGFX.Context, Global_CGFX.Display);
+                }
                 TranslateMessage(&msg);
                 DispatchMessage (&msg);
                 break;
@@ -667,13 +1367,23 @@ int CALLBACK WinMain(HINSTANCE hInstance, HINSTANCE hPrev, LPSTR lpCmdLine, int
         // queued command buffers to construct the current frame.
         cgSetActiveDrawableEXT(Global_CGFX.Context, Global_CGFX.Drawable);
         cgExecuteCommandBuffer(Global_CGFX.Context, Global_CGFX.GPUGraphicsQueue, cb);
-        cgPresentDrawableEXT(Global_CGFX.Drawable);
+        cgPresentDisplayEXT(Global_CGFX.Context, Global_CGFX.Display, Global_CGFX.Drawable);
 
-        // update timestamps to calculate the total presentation time.
-        int64_t present_ticks = elapsed_ticks(flip_clock, ticktime());
-        float   present_secs  = ticks_to_seconds(present_ticks);
-        flip_clock = ticktime();
-        result     = 1;
+        // periodically report frame pacing and latency.
+        if ((++frame_index % 256) == 0)
+        {
+            cg_frame_stats_ext_t stats;
+            if (cgGetFrameStatsEXT(Global_CGFX.Context, Global_CGFX.Display, &stats) == CG_SUCCESS)
+            {
+                dbg_printf("FRAME: %I64u presented: frame p50 %.3fms p99 %.3fms, device p50 %.3fms p99 %.3fms, input p50 %.3fms p99 %.3fms (%Iu samples), %Iu in flight, %I64u waits.\n", 
+                    stats.FrameCount, 
+                    stats.FrameTimeP50  / 1000000.0, stats.FrameTimeP99  / 1000000.0, 
+                    stats.DeviceTimeP50 / 1000000.0, stats.DeviceTimeP99 / 1000000.0, 
+                    stats.InputTimeP50  / 1000000.0, stats.InputTimeP99  / 1000000.0, 
+                    stats.InputSamples, stats.FramesInFlight, stats.PacingWaits);
+            }
+        }
+        result = 1;
     }
 
     // clean up application resources, and exit.